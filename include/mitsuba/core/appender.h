@@ -2,6 +2,7 @@
 
 #include <mitsuba/core/object.h>
 #include <iosfwd>
+#include <memory>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -75,4 +76,66 @@ private:
     bool m_last_message_was_progress;
 };
 
+/** \brief %Appender decorator that delivers log messages to a nested
+ * appender from a dedicated writer thread
+ *
+ * Messages are pushed onto a bounded lock-free multi-producer queue, which
+ * removes console/file I/O and its serializing mutex from the calling
+ * threads. This matters when verbose per-block logging is enabled during
+ * parallel rendering, where many workers would otherwise contend for the
+ * output stream.
+ *
+ * Warnings and errors bypass the queue: the pending backlog is first
+ * drained and the message is then delivered synchronously, so that
+ * important output is neither lost nor reordered. When the queue fills up,
+ * the appender either blocks the producer or drops the message depending on
+ * the chosen overflow policy; dropped messages are accounted for and
+ * reported once the writer catches up.
+ */
+class MTS_EXPORT_CORE AsyncAppender : public Appender {
+public:
+    /**
+     * \brief Create a new asynchronous appender
+     *
+     * \param nested
+     *     Appender that receives the messages on the writer thread
+     * \param capacity
+     *     Size of the bounded message queue (rounded up to the next power
+     *     of two)
+     * \param block_on_overflow
+     *     When set to \c true, a full queue causes the producing thread to
+     *     wait until space becomes available; otherwise, the message is
+     *     dropped. (Default: \c false)
+     */
+    AsyncAppender(Appender *nested, size_t capacity = 4096,
+                  bool block_on_overflow = false);
+
+    /// Enqueue a line of text (warnings and errors are delivered synchronously)
+    void append(LogLevel level, const std::string &text) override;
+
+    /// Forwarded synchronously to the nested appender
+    void log_progress(float progress, const std::string &name,
+        const std::string &formatted, const std::string &eta,
+        const void *ptr) override;
+
+    /// Block until all queued messages have been delivered
+    void flush();
+
+    /// Return the nested appender
+    Appender *nested() { return m_nested; }
+
+    /// Return a string representation
+    std::string to_string() const override;
+
+    MTS_DECLARE_CLASS()
+protected:
+    /// Protected destructor -- stops the writer thread after a final drain
+    virtual ~AsyncAppender();
+
+protected:
+    struct AsyncAppenderPrivate;
+    ref<Appender> m_nested;
+    std::unique_ptr<AsyncAppenderPrivate> d;
+};
+
 NAMESPACE_END(mitsuba)
@@ -13,10 +13,19 @@ NAMESPACE_BEGIN(mitsuba)
  * possible with the existing overloads provided by <tt>std::atomic</tt>). It
  * internally casts floating point values to an integer storage format and uses
  * atomic integer compare and exchange operations to perform changes.
+ *
+ * When the standard library provides native atomic floating point support
+ * (C++20, \c __cpp_lib_atomic_float), additions and subtractions are instead
+ * forwarded to <tt>std::atomic::fetch_add/fetch_sub</tt>, which lowers to a
+ * hardware atomic instruction on targets that have one.
  */
 template <typename Type = float> class AtomicFloat {
 private:
+#if defined(__cpp_lib_atomic_float)
+    using Storage = Type;
+#else
     using Storage = std::conditional_t<sizeof(Type) == 4, uint32_t, uint64_t>;
+#endif
 
 public:
     /// Initialize the AtomicFloat with a given floating point value
@@ -28,11 +37,19 @@ public:
     /// Overwrite the AtomicFloat with a floating point value
     AtomicFloat &operator=(Type v) { m_bits = memcpy_cast<Storage>(v); return *this; }
 
+#if defined(__cpp_lib_atomic_float)
+    /// Atomically add a floating point value
+    AtomicFloat &operator+=(Type arg) { m_bits.fetch_add(arg, std::memory_order_relaxed); return *this; }
+
+    /// Atomically subtract a floating point value
+    AtomicFloat &operator-=(Type arg) { m_bits.fetch_sub(arg, std::memory_order_relaxed); return *this; }
+#else
     /// Atomically add a floating point value
     AtomicFloat &operator+=(Type arg) { return do_atomic([arg](Type value) { return value + arg; }); }
 
     /// Atomically subtract a floating point value
     AtomicFloat &operator-=(Type arg) { return do_atomic([arg](Type value) { return value - arg; }); }
+#endif
 
     /// Atomically multiply by a floating point value
     AtomicFloat &operator*=(Type arg) { return do_atomic([arg](Type value) { return value * arg; }); }
@@ -54,4 +71,56 @@ protected:
     std::atomic<Storage> m_bits;
 };
 
+/**
+ * \brief Contention-striped atomic floating point accumulator
+ *
+ * The plain \ref AtomicFloat degrades badly when many threads hammer the
+ * same counter: on targets without a native atomic float instruction, every
+ * collision restarts the compare-and-exchange loop. This variant maintains
+ * \c StripeCount shadow copies on separate cache lines and hashes each
+ * thread to one of them, so that concurrent writers rarely touch the same
+ * line. Reads reduce over all copies and are correspondingly more expensive
+ * -- the intended use are write-mostly accumulators such as shared image
+ * sample weights or profiler counters.
+ */
+template <typename Type = float, size_t StripeCount = 8> class StripedAtomicFloat {
+public:
+    /// Initialize the accumulator with a given floating point value
+    explicit StripedAtomicFloat(Type v = 0.f) { *this = v; }
+
+    /// Reduce over all shadow copies and return the accumulated value
+    operator Type() const {
+        Type result = 0.f;
+        for (size_t i = 0; i < StripeCount; ++i)
+            result += (Type) m_stripes[i].value;
+        return result;
+    }
+
+    /// Overwrite the accumulator with a floating point value
+    StripedAtomicFloat &operator=(Type v) {
+        for (size_t i = 0; i < StripeCount; ++i)
+            m_stripes[i].value = (i == 0) ? v : Type(0);
+        return *this;
+    }
+
+    /// Atomically add a floating point value
+    StripedAtomicFloat &operator+=(Type arg) { stripe().value += arg; return *this; }
+
+    /// Atomically subtract a floating point value
+    StripedAtomicFloat &operator-=(Type arg) { stripe().value -= arg; return *this; }
+
+private:
+    /// Pad each shadow copy to a separate cache line to avoid false sharing
+    struct alignas(64) Stripe { AtomicFloat<Type> value; };
+
+    /// Returns the shadow copy associated with the calling thread
+    Stripe &stripe() {
+        static std::atomic<uint32_t> counter { 0 };
+        static thread_local uint32_t index = counter++;
+        return m_stripes[index % StripeCount];
+    }
+
+    Stripe m_stripes[StripeCount];
+};
+
 NAMESPACE_END(mitsuba)
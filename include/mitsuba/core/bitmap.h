@@ -162,6 +162,52 @@ public:
         Auto
     };
 
+    /**
+     * \brief Compression schemes supported by the OpenEXR file format
+     *
+     * All schemes are lossless except for \ref B44, \ref B44A, \ref DWAA,
+     * and \ref DWAB. The \c zstd codec of OpenEXR 3 is not available in the
+     * bundled OpenEXR library.
+     */
+    enum class Compression {
+        /**
+         * \brief Default behavior: wavelet compression (\ref PIZ), or
+         * \ref DWAB when a positive quality level is specified in
+         * \ref write()
+         */
+        Default,
+
+        /// Store the pixel data without compression
+        None,
+
+        /// Run-length encoding
+        RLE,
+
+        /// ZLIB compression of individual scanlines
+        ZIPS,
+
+        /// ZLIB compression of blocks of 16 scanlines
+        ZIP,
+
+        /// Wavelet compression with Huffman encoding
+        PIZ,
+
+        /// Lossy 24-bit float conversion followed by ZLIB compression
+        PXR24,
+
+        /// Lossy 4-by-4 pixel block compression with a fixed rate
+        B44,
+
+        /// Like \ref B44, but flat fields are compressed more aggressively
+        B44A,
+
+        /// Lossy DCT-based compression of blocks of 32 scanlines
+        DWAA,
+
+        /// Lossy DCT-based compression of blocks of 256 scanlines
+        DWAB
+    };
+
 
     // ======================================================================
     //! @{ \name Constructors
@@ -322,9 +368,17 @@ public:
      *            The default argument (-1) causes the implementation to switch
      *            to the lossless PIZ compressor.</li>
      *    </ul>
+     *
+     * \param compression
+     *    OpenEXR images: selects a specific compression scheme (see \ref
+     *    Compression). The default argument preserves the behavior described
+     *    under \c quality above; explicitly selecting \ref Compression::DWAA
+     *    or \ref Compression::DWAB uses \c quality as the DWA compression
+     *    level (45 unless specified). Ignored by the other file formats.
      */
     void write(Stream *stream, FileFormat format = FileFormat::Auto,
-               int quality = -1) const;
+               int quality = -1,
+               Compression compression = Compression::Default) const;
 
     /**
      * Write an encoded form of the bitmap to a file using the specified file format
@@ -352,13 +406,22 @@ public:
      *            The default argument (-1) causes the implementation to switch
      *            to the lossless PIZ compressor.</li>
      *    </ul>
+     *
+     * \param compression
+     *    OpenEXR images: selects a specific compression scheme (see \ref
+     *    Compression). The default argument preserves the behavior described
+     *    under \c quality above; explicitly selecting \ref Compression::DWAA
+     *    or \ref Compression::DWAB uses \c quality as the DWA compression
+     *    level (45 unless specified). Ignored by the other file formats.
      */
     void write(const fs::path &path, FileFormat format = FileFormat::Auto,
-               int quality = -1) const;
+               int quality = -1,
+               Compression compression = Compression::Default) const;
 
     /// Equivalent to \ref write(), but executes asynchronously on a different thread
     void write_async(const fs::path &path, FileFormat format = FileFormat::Auto,
-                     int quality = -1) const;
+                     int quality = -1,
+                     Compression compression = Compression::Default) const;
 
     /**
      * \brief Up- or down-sample this image to a different resolution
@@ -573,7 +636,8 @@ public:
      void read_openexr(Stream *stream);
 
      /// Write a file using the OpenEXR file format
-     void write_openexr(Stream *stream, int compression = -1) const;
+     void write_openexr(Stream *stream, int quality = -1,
+                        Compression compression = Compression::Default) const;
 
      /// Read a file encoded using the JPEG file format
      void read_jpeg(Stream *stream);
@@ -622,6 +686,127 @@ public:
 };
 
 
+/**
+ * \brief Incremental writer for tiled OpenEXR images
+ *
+ * This class exposes the tiled mode of the OpenEXR file format: the image is
+ * created up front with a fixed tile size, after which finished tiles can be
+ * submitted in arbitrary order and immediately released from memory. This
+ * makes it possible to write images that are considerably larger than the
+ * available amount of RAM, e.g. when rendering very high-resolution output
+ * with the block-based rendering mode of \ref SamplingIntegrator.
+ *
+ * Calls to \ref put() are serialized internally, hence finished tiles may be
+ * submitted concurrently from multiple threads.
+ */
+class MTS_EXPORT_CORE TiledBitmapWriter : public Object {
+public:
+    using Float = float;
+    MTS_IMPORT_CORE_TYPES()
+
+    /**
+     * \brief Create a tiled OpenEXR image at the given location
+     *
+     * \param path
+     *    Destination file name (the extension should be ".exr")
+     *
+     * \param size
+     *    Total size of the image in pixels
+     *
+     * \param tile_size
+     *    Side length of the square tiles, which must evenly partition the
+     *    image except possibly at its right and bottom edges
+     *
+     * \param fields
+     *    Structure describing the pixel layout. The field names become EXR
+     *    channel names, and the field types (which must be \c Float16,
+     *    \c Float32, or \c UInt32) determine the stored representation.
+     *
+     * \param compression
+     *    Compression scheme applied to the tiles (see \ref
+     *    Bitmap::Compression). The default argument selects the lossless
+     *    PIZ compressor.
+     */
+    TiledBitmapWriter(const fs::path &path, const Vector2u &size,
+                      uint32_t tile_size, const Struct *fields,
+                      Bitmap::Compression compression = Bitmap::Compression::Default);
+
+    /**
+     * \brief Convert and write one finished tile
+     *
+     * The given offset must be a multiple of the tile size, and the bitmap
+     * must exactly cover the corresponding tile of the image (i.e. it is
+     * smaller than <tt>tile_size</tt> only at the right and bottom edges).
+     * Its pixel layout must match the \c fields structure supplied to the
+     * constructor. Each tile may only be written once.
+     */
+    void put(const Point2u &offset, const Bitmap *tile);
+
+    /**
+     * \brief Finalize the image and close the underlying file
+     *
+     * This is called automatically when the instance is destructed; further
+     * \ref put() calls will raise an exception.
+     */
+    void close();
+
+    /// Return the total size of the image in pixels
+    const Vector2u &size() const { return m_size; }
+
+    /// Return the side length of the square tiles
+    uint32_t tile_size() const { return m_tile_size; }
+
+    MTS_DECLARE_CLASS()
+protected:
+    /// Protected destructor
+    virtual ~TiledBitmapWriter();
+
+protected:
+    struct EXRData;
+    std::unique_ptr<EXRData> m_data;
+    Vector2u m_size;
+    uint32_t m_tile_size;
+    ref<Struct> m_struct;
+};
+
+
+/**
+ * \brief Add \c n contiguous entries of \c source onto \c target, optionally
+ * scaling them by \c scale
+ *
+ * For single and double precision data, the bulk of the work is performed
+ * with SIMD packets: a few scalar iterations peel off entries until \c target
+ * is packet-aligned, followed by aligned vector stores and a scalar tail.
+ * Other component types fall back to a scalar loop.
+ */
+template <typename Value>
+void accumulate_1d(const Value *source, Value *target, size_t n,
+                   Value scale = Value(1)) {
+    size_t i = 0;
+
+    if constexpr (std::is_floating_point_v<Value>) {
+        using Packet = enoki::Packet<Value>;
+
+        if (n >= 2 * Packet::Size) {
+            while (((uintptr_t) (target + i)) % alignof(Packet) != 0) {
+                target[i] += scale * source[i];
+                ++i;
+            }
+
+            Packet scale_p(scale);
+            for (; i + Packet::Size <= n; i += Packet::Size)
+                enoki::store(
+                    target + i,
+                    enoki::fmadd(enoki::load_unaligned<Packet>(source + i),
+                                 scale_p, enoki::load<Packet>(target + i)));
+        }
+    }
+
+    for (; i < n; ++i)
+        target[i] += scale * source[i];
+}
+
+
 /**
  * \brief Accumulate the contents of a source bitmap into a
  * target bitmap with specified offsets for both.
@@ -663,11 +848,11 @@ void accumulate_2d(ConstT source,
         target += (target_offset.x() + target_offset.y() * (size_t) target_size.x()) * channel_count;
 
         for (int y = 0; y < size.y(); ++y) {
-            for (int i = 0; i < n; ++i) {
-                if constexpr (std::is_integral_v<Value>)
+            if constexpr (std::is_integral_v<Value>) {
+                for (int i = 0; i < n; ++i)
                     target[i] = (Value) max(maxval, source[i] + target[i]);
-                else
-                    target[i] += source[i];
+            } else {
+                accumulate_1d(source, target, (size_t) n);
             }
 
             source += source_size.x() * channel_count;
@@ -695,5 +880,6 @@ void accumulate_2d(ConstT source,
 
 extern MTS_EXPORT_CORE std::ostream &operator<<(std::ostream &os, Bitmap::PixelFormat value);
 extern MTS_EXPORT_CORE std::ostream &operator<<(std::ostream &os, Bitmap::FileFormat value);
+extern MTS_EXPORT_CORE std::ostream &operator<<(std::ostream &os, Bitmap::Compression value);
 
 NAMESPACE_END(mitsuba)
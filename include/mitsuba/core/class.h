@@ -203,12 +203,25 @@ public:                                             \
 
 
 /// Instantiate and export a Mitsuba plugin
+#if defined(MTS_STATIC_PLUGINS)
+/* Plugins are compiled directly into the Mitsuba libraries. A global
+   constructor records each plugin in a registry consulted by the plugin
+   manager, which then bypasses the dynamic loader entirely. The
+   user-visible plugin name is derived from the name of the translation
+   unit invoking the macro, which matches the file name of the shared
+   object that a dynamic build would produce. */
+#define MTS_EXPORT_PLUGIN(Name, Descr)                                                             \
+    static ::mitsuba::detail::StaticPluginRegistrar                                                \
+        plugin_registrar_##Name(__FILE__, #Name, Descr);                                           \
+    MTS_INSTANTIATE_CLASS(Name)
+#else
 #define MTS_EXPORT_PLUGIN(Name, Descr)                                                             \
     extern "C" {                                                                                   \
         MTS_EXPORT const char *plugin_name() { return #Name; }                                     \
         MTS_EXPORT const char *plugin_descr() { return Descr; }                                    \
     }                                                                                              \
     MTS_INSTANTIATE_CLASS(Name)
+#endif
 
 // This macro is needed to get this to compile across all compilers
 #define MTS_IMPORT_BASE_HELPER(...) Base, ##__VA_ARGS__
@@ -237,6 +250,16 @@ public:                                             \
     ENOKI_USING_MEMBERS(MTS_IMPORT_BASE_HELPER(__VA_ARGS__))
 
 NAMESPACE_BEGIN(detail)
+/**
+ * \brief Records a statically linked plugin (see \ref MTS_EXPORT_PLUGIN)
+ *
+ * The registry itself lives in the plugin manager, which resolves entries
+ * registered here without involving the dynamic loader.
+ */
+struct MTS_EXPORT_CORE StaticPluginRegistrar {
+    StaticPluginRegistrar(const char *file, const char *name, const char *descr);
+};
+
 template <typename, typename Arg, typename = void>
 struct is_constructiblee : std::false_type { };
 
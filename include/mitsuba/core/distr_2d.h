@@ -2,6 +2,9 @@
 
 #include <mitsuba/core/warp.h>
 #include <mitsuba/core/util.h>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -219,7 +222,7 @@ public:
                    const std::array<const ScalarFloat *, Dimension> &param_values = { },
                    bool normalize = true,
                    bool enable_sampling = true)
-        : Base(size, param_res, param_values) {
+        : Base(size, param_res, param_values), m_normalized(normalize) {
 
         // The linear interpolant has 'size-1' patches
         ScalarVector2u n_patches = size - 1;
@@ -228,24 +231,31 @@ public:
         uint32_t max_level = math::log2i_ceil(hmax(n_patches));
 
         m_max_patch_index = n_patches - 1;
+        m_slice_sum.resize(m_slices, 0.0);
 
         if (!enable_sampling) {
             m_levels.reserve(1);
             m_levels.emplace_back(size, m_slices);
 
-            for (uint32_t slice = 0; slice < m_slices; ++slice) {
-                uint32_t offset = m_levels[0].size * slice;
-
-                ScalarFloat scale = 1.f;
-                if (normalize) {
-                    double sum = 0.0;
+            tbb::parallel_for(
+                tbb::blocked_range<uint32_t>(0u, m_slices, 1),
+                [&](const tbb::blocked_range<uint32_t> &slice_range) {
+                for (uint32_t slice = slice_range.begin();
+                     slice != slice_range.end(); ++slice) {
+                    uint32_t offset = m_levels[0].size * slice;
+
+                    ScalarFloat scale = 1.f;
+                    if (normalize) {
+                        double sum = 0.0;
+                        for (uint32_t i = 0; i < m_levels[0].size; ++i)
+                            sum += (double) data[offset + i];
+                        m_slice_sum[slice] = sum;
+                        scale = hprod(n_patches) / (ScalarFloat) sum;
+                    }
                     for (uint32_t i = 0; i < m_levels[0].size; ++i)
-                        sum += (double) data[offset + i];
-                    scale = hprod(n_patches) / (ScalarFloat) sum;
+                        m_levels[0].data_ptr[offset + i] = data[offset + i] * scale;
                 }
-                for (uint32_t i = 0; i < m_levels[0].size; ++i)
-                    m_levels[0].data_ptr[offset + i] = data[offset + i] * scale;
-            }
+            });
 
             return;
         }
@@ -261,48 +271,218 @@ public:
             level_size = sr<1>(level_size);
         }
 
-        for (uint32_t slice = 0; slice < m_slices; ++slice) {
-            uint32_t offset0 = m_levels[0].size * slice,
-                     offset1 = m_levels[1].size * slice;
-
-            // Integrate linear interpolant
-            const ScalarFloat *in = data + offset0;
-
-            double sum = 0.0;
-            for (uint32_t y = 0; y < n_patches.y(); ++y) {
-                for (uint32_t x = 0; x < n_patches.x(); ++x) {
-                    ScalarFloat avg = (in[0] + in[1] + in[size.x()] +
-                                 in[size.x() + 1]) * .25f;
-                    sum += (double) avg;
-                    *(m_levels[1].ptr(ScalarVector2u(x, y)) + offset1) = avg;
-                    ++in;
+        /* Each slice builds independently, and within a slice the row
+           integration and the MIP reduction parallelize over rows. Nested
+           TBB parallelism composes, so this covers both the many-slice
+           (measured BSDF) and the single-slice high-resolution (environment
+           map) cases. */
+        tbb::parallel_for(
+            tbb::blocked_range<uint32_t>(0u, m_slices, 1),
+            [&](const tbb::blocked_range<uint32_t> &slice_range) {
+            for (uint32_t slice = slice_range.begin();
+                 slice != slice_range.end(); ++slice) {
+                uint32_t offset0 = m_levels[0].size * slice,
+                         offset1 = m_levels[1].size * slice;
+
+                /* Integrate the linear interpolant, one row of bilinear
+                   patches at a time. The deterministic reduction keeps the
+                   normalization (and hence every sample drawn later)
+                   independent of the thread count. */
+                double sum = tbb::parallel_deterministic_reduce(
+                    tbb::blocked_range<uint32_t>(0u, n_patches.y(), 64), 0.0,
+                    [&](const tbb::blocked_range<uint32_t> &range, double accum) {
+                        for (uint32_t y = range.begin(); y != range.end(); ++y) {
+                            const ScalarFloat *in = data + offset0 + y * size.x();
+                            for (uint32_t x = 0; x < n_patches.x(); ++x, ++in) {
+                                ScalarFloat avg = (in[0] + in[1] + in[size.x()] +
+                                             in[size.x() + 1]) * .25f;
+                                accum += (double) avg;
+                                *(m_levels[1].ptr(ScalarVector2u(x, y)) + offset1) = avg;
+                            }
+                        }
+                        return accum;
+                    },
+                    std::plus<double>());
+
+                m_slice_sum[slice] = sum;
+
+                // Copy and normalize fine resolution interpolant
+                ScalarFloat scale = normalize ? (ScalarFloat) (hprod(n_patches) / sum) : 1.f;
+                tbb::parallel_for(
+                    tbb::blocked_range<uint32_t>(0u, m_levels[0].size, 4096),
+                    [&](const tbb::blocked_range<uint32_t> &range) {
+                        for (uint32_t i = range.begin(); i != range.end(); ++i)
+                            m_levels[0].data_ptr[offset0 + i] = data[offset0 + i] * scale;
+                    });
+                tbb::parallel_for(
+                    tbb::blocked_range<uint32_t>(0u, m_levels[1].size, 4096),
+                    [&](const tbb::blocked_range<uint32_t> &range) {
+                        for (uint32_t i = range.begin(); i != range.end(); ++i)
+                            m_levels[1].data_ptr[offset1 + i] *= scale;
+                    });
+
+                // Build a MIP hierarchy
+                ScalarVector2u l_size = n_patches;
+                for (uint32_t level = 2; level <= max_level + 1; ++level) {
+                    const Level &l0 = m_levels[level - 1];
+                    Level &l1 = m_levels[level];
+                    uint32_t off0 = l0.size * slice,
+                             off1 = l1.size * slice;
+                    l_size = sr<1>(l_size + 1u);
+
+                    // Downsample (rows are independent)
+                    tbb::parallel_for(
+                        tbb::blocked_range<uint32_t>(0u, l_size.y(), 64),
+                        [&, off0, off1, l_size](const tbb::blocked_range<uint32_t> &range) {
+                            for (uint32_t y = range.begin(); y != range.end(); ++y) {
+                                for (uint32_t x = 0; x < l_size.x(); ++x) {
+                                    ScalarFloat *d1 = l1.ptr(ScalarVector2u(x, y)) + off1;
+                                    const ScalarFloat *d0 = l0.ptr(ScalarVector2u(x*2, y*2)) + off0;
+                                    *d1 = d0[0] + d0[1] + d0[2] + d0[3];
+                                }
+                            }
+                        });
                 }
-                ++in;
             }
+        });
+    }
+
+    /**
+     * \brief Selectively rebuild the warp after rows <tt>[y_begin, y_end)</tt>
+     * of the input array changed
+     *
+     * Hot-reload workflows (e.g. painting into an environment map) typically
+     * modify a small band of the input; re-running the full constructor then
+     * wastes almost all of its work. This entry point recomputes only the
+     * bilinear patch rows that depend on the changed input rows and their
+     * ancestors in the MIP hierarchy. When the distribution is normalized,
+     * the remaining entries are rescaled to the new total, which is a simple
+     * sweep rather than a rebuild.
+     *
+     * \param data
+     *    Pointer to the <em>full</em> slice data, using the same layout as
+     *    the constructor
+     */
+    void update(const ScalarFloat *data, uint32_t y_begin, uint32_t y_end,
+                uint32_t slice = 0) {
+        if (slice >= m_slices)
+            Throw("Hierarchical2D::update(): slice index %u out of range!", slice);
+
+        ScalarVector2u n_patches = m_max_patch_index + 1,
+                       size      = n_patches + 1;
+        y_end = std::min(y_end, size.y());
+        if (y_begin >= y_end)
+            return;
 
-            // Copy and normalize fine resolution interpolant
-            ScalarFloat scale = normalize ? (ScalarFloat) (hprod(n_patches) / sum) : 1.f;
-            for (uint32_t i = 0; i < m_levels[0].size; ++i)
-                m_levels[0].data_ptr[offset0 + i] = data[offset0 + i] * scale;
-            for (uint32_t i = 0; i < m_levels[1].size; ++i)
-                m_levels[1].data_ptr[offset1 + i] *= scale;
-
-            // Build a MIP hierarchy
-            level_size = n_patches;
-            for (uint32_t level = 2; level <= max_level + 1; ++level) {
-                const Level &l0 = m_levels[level - 1];
-                Level &l1 = m_levels[level];
-                offset0 = l0.size * slice;
-                offset1 = l1.size * slice;
-                level_size = sr<1>(level_size + 1u);
-
-                // Downsample
-                for (uint32_t y = 0; y < level_size.y(); ++y) {
-                    for (uint32_t x = 0; x < level_size.x(); ++x) {
-                        ScalarFloat *d1 = l1.ptr(ScalarVector2u(x, y)) + offset1;
-                        const ScalarFloat *d0 = l0.ptr(ScalarVector2u(x*2, y*2)) + offset0;
-                        *d1 = d0[0] + d0[1] + d0[2] + d0[3];
+        ScalarFloat scale_old = m_normalized
+            ? (ScalarFloat) (hprod(n_patches) / m_slice_sum[slice]) : 1.f;
+
+        if (m_levels.size() == 1) {
+            // Constructed with enable_sampling=false: plain data table
+            uint32_t offset = m_levels[0].size * slice;
+            if (m_normalized) {
+                double sum = m_slice_sum[slice];
+                for (uint32_t i = y_begin * size.x(); i < y_end * size.x(); ++i)
+                    sum += (double) data[offset + i] -
+                           (double) m_levels[0].data_ptr[offset + i] / (double) scale_old;
+                m_slice_sum[slice] = sum;
+            }
+            ScalarFloat scale = m_normalized
+                ? (ScalarFloat) (hprod(n_patches) / m_slice_sum[slice]) : 1.f,
+                        ratio = scale / scale_old;
+            tbb::parallel_for(
+                tbb::blocked_range<uint32_t>(0u, m_levels[0].size, 4096),
+                [&](const tbb::blocked_range<uint32_t> &range) {
+                    for (uint32_t i = range.begin(); i != range.end(); ++i) {
+                        uint32_t y = i / size.x();
+                        m_levels[0].data_ptr[offset + i] =
+                            (y >= y_begin && y < y_end)
+                                ? data[offset + i] * scale
+                                : m_levels[0].data_ptr[offset + i] * ratio;
                     }
+                });
+            return;
+        }
+
+        // Bilinear patch rows that reference the changed input rows
+        uint32_t py0 = y_begin > 0 ? y_begin - 1 : 0,
+                 py1 = std::min(y_end, n_patches.y());
+
+        uint32_t offset0 = m_levels[0].size * slice,
+                 offset1 = m_levels[1].size * slice;
+
+        // Update the integral: swap the affected patch rows' contributions
+        double sum = m_slice_sum[slice];
+        for (uint32_t y = py0; y < py1; ++y) {
+            const ScalarFloat *in = data + offset0 + y * size.x();
+            for (uint32_t x = 0; x < n_patches.x(); ++x, ++in) {
+                ScalarFloat avg = (in[0] + in[1] + in[size.x()] +
+                             in[size.x() + 1]) * .25f;
+                ScalarFloat *out = m_levels[1].ptr(ScalarVector2u(x, y)) + offset1;
+                sum += (double) avg - (double) *out / (double) scale_old;
+                *out = avg; // rescaled below
+            }
+        }
+        m_slice_sum[slice] = sum;
+
+        ScalarFloat scale = m_normalized
+            ? (ScalarFloat) (hprod(n_patches) / sum) : 1.f,
+                    ratio = scale / scale_old;
+
+        // Refresh the fine level and rescale everything else to the new total
+        tbb::parallel_for(
+            tbb::blocked_range<uint32_t>(0u, m_levels[0].size, 4096),
+            [&](const tbb::blocked_range<uint32_t> &range) {
+                for (uint32_t i = range.begin(); i != range.end(); ++i) {
+                    uint32_t y = i / size.x();
+                    m_levels[0].data_ptr[offset0 + i] =
+                        (y >= y_begin && y < y_end)
+                            ? data[offset0 + i] * scale
+                            : m_levels[0].data_ptr[offset0 + i] * ratio;
+                }
+            });
+        tbb::parallel_for(
+            tbb::blocked_range<uint32_t>(0u, m_levels[1].size, 4096),
+            [&](const tbb::blocked_range<uint32_t> &range) {
+                /* The 2x2-interleaved layout (see \ref Level::index()) stores
+                   each pair of rows in one block of '2 * width' entries, with
+                   bit 1 of the intra-block index holding the row parity */
+                uint32_t w2 = 2 * m_levels[1].width;
+                for (uint32_t i = range.begin(); i != range.end(); ++i) {
+                    uint32_t y = (i / w2) * 2 + ((i >> 1) & 1u);
+                    m_levels[1].data_ptr[offset1 + i] *=
+                        (y >= py0 && y < py1) ? scale : ratio;
+                }
+            });
+        if (m_normalized && ratio != 1.f) {
+            for (size_t level = 2; level < m_levels.size(); ++level) {
+                Level &l = m_levels[level];
+                uint32_t offset = l.size * slice;
+                tbb::parallel_for(
+                    tbb::blocked_range<uint32_t>(0u, l.size, 4096),
+                    [&](const tbb::blocked_range<uint32_t> &range) {
+                        for (uint32_t i = range.begin(); i != range.end(); ++i)
+                            l.data_ptr[offset + i] *= ratio;
+                    });
+            }
+        }
+
+        // Propagate the affected rows up the MIP hierarchy
+        ScalarVector2u l_size = n_patches;
+        for (uint32_t level = 2; level < (uint32_t) m_levels.size(); ++level) {
+            const Level &l0 = m_levels[level - 1];
+            Level &l1 = m_levels[level];
+            uint32_t off0 = l0.size * slice,
+                     off1 = l1.size * slice;
+            l_size = sr<1>(l_size + 1u);
+            py0 = py0 >> 1;
+            py1 = std::min((py1 + 1) >> 1, l_size.y());
+
+            for (uint32_t y = py0; y < py1; ++y) {
+                for (uint32_t x = 0; x < l_size.x(); ++x) {
+                    ScalarFloat *d1 = l1.ptr(ScalarVector2u(x, y)) + off1;
+                    const ScalarFloat *d0 = l0.ptr(ScalarVector2u(x*2, y*2)) + off0;
+                    *d1 = d0[0] + d0[1] + d0[2] + d0[3];
                 }
             }
         }
@@ -620,6 +800,12 @@ protected:
 
     /// Number of bilinear patches in the X/Y dimension - 1
     ScalarVector2u m_max_patch_index;
+
+    /// Unnormalized integral of each slice (needed by \ref update())
+    std::vector<double> m_slice_sum;
+
+    /// Are the probability values normalized?
+    bool m_normalized = true;
 };
 
 /**
@@ -704,6 +890,8 @@ public:
         m_data = empty<FloatStorage>(m_slices * n_data);
         m_data.managed();
 
+        m_slice_integral.resize(m_slices, 0.0);
+
         if (enable_sampling) {
             m_marg_cdf = empty<FloatStorage>(m_slices * n_marg);
             m_marg_cdf.managed();
@@ -711,98 +899,253 @@ public:
             m_cond_cdf = empty<FloatStorage>(m_slices * n_cond);
             m_cond_cdf.managed();
 
-            ScalarFloat *marg_cdf = m_marg_cdf.data(),
-                        *cond_cdf = m_cond_cdf.data(),
-                        *data_out = m_data.data();
-
-            std::unique_ptr<double[]> cond_cdf_sum(new double[h]);
-
-            for (uint32_t slice = 0; slice < m_slices; ++slice) {
-                ScalarFloat norm = 1.f;
-
-                /* The marginal/probability distribution computation
-                   differs for the Continuous=false/true cases */
-                if constexpr (Continuous) {
-                    // Construct conditional CDF
-                    for (uint32_t y = 0; y < h; ++y) {
-                        double accum = 0.0;
-                        uint32_t i = y * w, j = y * (w - 1);
-                        for (uint32_t x = 0; x < w - 1; ++x, ++i, ++j) {
-                            accum += scale_x * ((double) data[i] +
-                                                (double) data[i + 1]);
-                            cond_cdf[j] = (ScalarFloat) accum;
-                        }
-                        cond_cdf_sum[y] = accum;
-                    }
-
-                    // Construct marginal CDF
+            ScalarFloat *marg_cdf_p = m_marg_cdf.data(),
+                        *cond_cdf_p = m_cond_cdf.data(),
+                        *data_out_p = m_data.data();
+
+            /* Slices build independently; within a slice, the conditional
+               CDF rows are independent of each other and parallelize as
+               well, so that a single high-resolution distribution (e.g. an
+               8K environment map) also occupies all cores. Only the short
+               marginal scan over rows is inherently serial. */
+            tbb::parallel_for(
+                tbb::blocked_range<uint32_t>(0u, m_slices, 1),
+                [&](const tbb::blocked_range<uint32_t> &slice_range) {
+                for (uint32_t slice = slice_range.begin();
+                     slice != slice_range.end(); ++slice) {
+                    const ScalarFloat *in = data + slice * (size_t) n_data;
+                    ScalarFloat *marg_cdf = marg_cdf_p + slice * (size_t) n_marg,
+                                *cond_cdf = cond_cdf_p + slice * (size_t) n_cond,
+                                *data_out = data_out_p + slice * (size_t) n_data;
+
+                    std::unique_ptr<double[]> cond_cdf_sum(new double[h]);
+
+                    /* The marginal/probability distribution computation
+                       differs for the Continuous=false/true cases */
                     double accum = 0.0;
-                    for (uint32_t y = 0; y < h - 1; ++y) {
-                        accum += scale_y * (cond_cdf_sum[y] + cond_cdf_sum[y + 1]);
-                        marg_cdf[y] = (ScalarFloat) accum;
-                    }
-
-                    if (normalize)
-                        norm = ScalarFloat(1.0 / accum);
-                } else {
-                    double scale = scale_x * scale_y;
-
-                    // Construct conditional CDF
-                    for (uint32_t y = 0; y < h - 1; ++y) {
-                        double accum = 0.0;
-                        uint32_t i = y * w, j = y * (w - 1);
-                        for (uint32_t x = 0; x < w - 1; ++x, ++i, ++j) {
-                            accum += scale * ((double) data[i] +
-                                              (double) data[i + 1] +
-                                              (double) data[i + w] +
-                                              (double) data[i + w + 1]);
-                            cond_cdf[j] = (ScalarFloat) accum;
+                    if constexpr (Continuous) {
+                        // Construct conditional CDF
+                        tbb::parallel_for(
+                            tbb::blocked_range<uint32_t>(0u, h, 64),
+                            [&](const tbb::blocked_range<uint32_t> &range) {
+                                for (uint32_t y = range.begin(); y != range.end(); ++y) {
+                                    double row_accum = 0.0;
+                                    uint32_t i = y * w, j = y * (w - 1);
+                                    for (uint32_t x = 0; x < w - 1; ++x, ++i, ++j) {
+                                        row_accum += scale_x * ((double) in[i] +
+                                                                (double) in[i + 1]);
+                                        cond_cdf[j] = (ScalarFloat) row_accum;
+                                    }
+                                    cond_cdf_sum[y] = row_accum;
+                                }
+                            });
+
+                        // Construct marginal CDF
+                        for (uint32_t y = 0; y < h - 1; ++y) {
+                            accum += scale_y * (cond_cdf_sum[y] + cond_cdf_sum[y + 1]);
+                            marg_cdf[y] = (ScalarFloat) accum;
+                        }
+                    } else {
+                        double scale = scale_x * scale_y;
+
+                        // Construct conditional CDF
+                        tbb::parallel_for(
+                            tbb::blocked_range<uint32_t>(0u, h - 1, 64),
+                            [&](const tbb::blocked_range<uint32_t> &range) {
+                                for (uint32_t y = range.begin(); y != range.end(); ++y) {
+                                    double row_accum = 0.0;
+                                    uint32_t i = y * w, j = y * (w - 1);
+                                    for (uint32_t x = 0; x < w - 1; ++x, ++i, ++j) {
+                                        row_accum += scale * ((double) in[i] +
+                                                              (double) in[i + 1] +
+                                                              (double) in[i + w] +
+                                                              (double) in[i + w + 1]);
+                                        cond_cdf[j] = (ScalarFloat) row_accum;
+                                    }
+                                    cond_cdf_sum[y] = row_accum;
+                                }
+                            });
+
+                        // Construct marginal CDF
+                        for (uint32_t y = 0; y < h - 1; ++y) {
+                            accum += cond_cdf_sum[y];
+                            marg_cdf[y] = (ScalarFloat) accum;
                         }
-                        cond_cdf_sum[y] = accum;
-                    }
-
-                    // Construct marginal CDF
-                    double accum = 0.0;
-                    for (uint32_t y = 0; y < h - 1; ++y) {
-                        accum += cond_cdf_sum[y];
-                        marg_cdf[y] = (ScalarFloat) accum;
                     }
 
-                    if (normalize)
-                        norm = ScalarFloat(1.0 / accum);
+                    m_slice_integral[slice] = accum;
+                    ScalarFloat norm = normalize ? ScalarFloat(1.0 / accum) : 1.f;
+
+                    tbb::parallel_for(
+                        tbb::blocked_range<uint32_t>(0u, n_cond, 4096),
+                        [&](const tbb::blocked_range<uint32_t> &range) {
+                            for (uint32_t i = range.begin(); i != range.end(); ++i)
+                                cond_cdf[i] *= norm;
+                        });
+                    for (size_t i = 0; i < n_marg; ++i)
+                        marg_cdf[i] *= norm;
+                    tbb::parallel_for(
+                        tbb::blocked_range<uint32_t>(0u, n_data, 4096),
+                        [&](const tbb::blocked_range<uint32_t> &range) {
+                            for (uint32_t i = range.begin(); i != range.end(); ++i)
+                                data_out[i] = in[i] * norm;
+                        });
                 }
-
-                for (size_t i = 0; i < n_cond; ++i)
-                    *cond_cdf++ *= norm;
-                for (size_t i = 0; i < n_marg; ++i)
-                    *marg_cdf++ *= norm;
-                for (size_t i = 0; i < n_data; ++i)
-                    *data_out++ = *data++ * norm;
-            }
+            });
         } else {
-            ScalarFloat *data_out = m_data.data();
-
-            for (uint32_t slice = 0; slice < m_slices; ++slice) {
-                ScalarFloat norm = 1.f;
-
-                if (normalize) {
-                    double sum = 0.0;
-                    for (uint32_t y = 0; y < h - 1; ++y) {
-                        size_t i = y * w;
-                        for (uint32_t x = 0; x < w - 1; ++x, ++i) {
-                            sum += (double) data[i] +
-                                   (double) data[i + 1] +
-                                   (double) data[i + w] +
-                                   (double) data[i + w + 1];
+            ScalarFloat *data_out_p = m_data.data();
+
+            tbb::parallel_for(
+                tbb::blocked_range<uint32_t>(0u, m_slices, 1),
+                [&](const tbb::blocked_range<uint32_t> &slice_range) {
+                for (uint32_t slice = slice_range.begin();
+                     slice != slice_range.end(); ++slice) {
+                    const ScalarFloat *in = data + slice * (size_t) n_data;
+                    ScalarFloat *data_out = data_out_p + slice * (size_t) n_data;
+
+                    ScalarFloat norm = 1.f;
+                    if (normalize) {
+                        double sum = 0.0;
+                        for (uint32_t y = 0; y < h - 1; ++y) {
+                            size_t i = y * w;
+                            for (uint32_t x = 0; x < w - 1; ++x, ++i) {
+                                sum += (double) in[i] +
+                                       (double) in[i + 1] +
+                                       (double) in[i + w] +
+                                       (double) in[i + w + 1];
+                            }
                         }
+                        m_slice_integral[slice] = scale_x * scale_y * sum;
+                        norm = ScalarFloat(1.0 / m_slice_integral[slice]);
                     }
-                    norm = ScalarFloat(1.0 / (scale_x * scale_y * sum));
+
+                    for (uint32_t k = 0; k < n_data; ++k)
+                        data_out[k] = in[k] * norm;
                 }
+            });
+        }
+    }
 
-                for (uint32_t k = 0; k < n_data; ++k)
-                    *data_out++ = *data++ * norm;
+    /**
+     * \brief Selectively rebuild the warp after rows <tt>[y_begin, y_end)</tt>
+     * of the input array changed
+     *
+     * Hot-reload workflows typically modify a small band of the input;
+     * re-running the full constructor then wastes almost all of its work.
+     * This entry point recomputes only the conditional CDF rows that depend
+     * on the changed input rows, re-runs the (cheap) marginal scan, and
+     * rescales the remaining tables to the new normalization.
+     *
+     * \param data
+     *    Pointer to the <em>full</em> slice data, using the same layout as
+     *    the constructor
+     */
+    void update(const ScalarFloat *data, uint32_t y_begin, uint32_t y_end,
+                uint32_t slice = 0) {
+        if (slice >= m_slices)
+            Throw("Marginal2D::update(): slice index %u out of range!", slice);
+        if (m_marg_cdf.empty())
+            Throw("Marginal2D::update(): requires enable_sampling=true!");
+
+        uint32_t w      = m_size.x(),
+                 h      = m_size.y(),
+                 n_data = w * h,
+                 n_marg = h - 1,
+                 n_cond = (w - 1) * (Continuous ? h : (h - 1));
+
+        double scale_x = .5 / (w - 1),
+               scale_y = .5 / (h - 1);
+
+        y_end = std::min(y_end, h);
+        if (y_begin >= y_end)
+            return;
+
+        // Conditional CDF rows that reference the changed input rows
+        uint32_t cy0, cy1;
+        if constexpr (Continuous) {
+            cy0 = y_begin;
+            cy1 = y_end;
+        } else {
+            cy0 = y_begin > 0 ? y_begin - 1 : 0;
+            cy1 = std::min(y_end, h - 1);
+        }
+
+        ScalarFloat *marg_cdf = m_marg_cdf.data() + slice * (size_t) n_marg,
+                    *cond_cdf = m_cond_cdf.data() + slice * (size_t) n_cond,
+                    *data_out = m_data.data() + slice * (size_t) n_data;
+
+        double norm_old = m_normalized ? 1.0 / m_slice_integral[slice] : 1.0;
+
+        /* Per-row integrals: recomputed for the affected rows (which also
+           refreshes their raw CDF entries), recovered from the stored last
+           CDF entry everywhere else */
+        std::unique_ptr<double[]> cond_cdf_sum(new double[h]);
+        uint32_t n_rows = Continuous ? h : h - 1;
+        for (uint32_t y = 0; y < n_rows; ++y) {
+            if (y < cy0 || y >= cy1) {
+                cond_cdf_sum[y] =
+                    (double) cond_cdf[y * (w - 1) + w - 2] / norm_old;
+                continue;
             }
+
+            double row_accum = 0.0;
+            uint32_t i = y * w, j = y * (w - 1);
+            if constexpr (Continuous) {
+                for (uint32_t x = 0; x < w - 1; ++x, ++i, ++j) {
+                    row_accum += scale_x * ((double) data[i] +
+                                            (double) data[i + 1]);
+                    cond_cdf[j] = (ScalarFloat) row_accum;
+                }
+            } else {
+                double scale = scale_x * scale_y;
+                for (uint32_t x = 0; x < w - 1; ++x, ++i, ++j) {
+                    row_accum += scale * ((double) data[i] +
+                                          (double) data[i + 1] +
+                                          (double) data[i + w] +
+                                          (double) data[i + w + 1]);
+                    cond_cdf[j] = (ScalarFloat) row_accum;
+                }
+            }
+            cond_cdf_sum[y] = row_accum;
+        }
+
+        // Re-run the marginal scan
+        double accum = 0.0;
+        for (uint32_t y = 0; y < h - 1; ++y) {
+            if constexpr (Continuous)
+                accum += scale_y * (cond_cdf_sum[y] + cond_cdf_sum[y + 1]);
+            else
+                accum += cond_cdf_sum[y];
+            marg_cdf[y] = (ScalarFloat) accum;
         }
+
+        m_slice_integral[slice] = accum;
+
+        double norm  = m_normalized ? 1.0 / accum : 1.0,
+               ratio = norm / norm_old;
+
+        // Rescale all tables to the new normalization
+        for (size_t i = 0; i < n_marg; ++i)
+            marg_cdf[i] = (ScalarFloat) ((double) marg_cdf[i] * norm);
+        tbb::parallel_for(
+            tbb::blocked_range<uint32_t>(0u, n_cond, 4096),
+            [&](const tbb::blocked_range<uint32_t> &range) {
+                for (uint32_t i = range.begin(); i != range.end(); ++i) {
+                    uint32_t y = i / (w - 1);
+                    cond_cdf[i] = (ScalarFloat) ((double) cond_cdf[i] *
+                        ((y >= cy0 && y < cy1) ? norm : ratio));
+                }
+            });
+        tbb::parallel_for(
+            tbb::blocked_range<uint32_t>(0u, n_data, 4096),
+            [&](const tbb::blocked_range<uint32_t> &range) {
+                for (uint32_t i = range.begin(); i != range.end(); ++i) {
+                    uint32_t y = i / w;
+                    data_out[i] = (y >= y_begin && y < y_end)
+                        ? (ScalarFloat) ((double) data[i] * norm)
+                        : (ScalarFloat) ((double) data_out[i] * ratio);
+                }
+            });
     }
 
     /**
@@ -859,16 +1202,10 @@ public:
         if (Dimension != 0)
             index += slice_offset * size;
 
-        Float v00 = lookup(m_data.data(), index,
-                           size, param_weight, active),
-              v10 = lookup(m_data.data() + 1, index,
-                           size, param_weight, active),
-              v01 = lookup(m_data.data() + m_size.x(), index,
-                           size, param_weight, active),
-              v11 = lookup(m_data.data() + m_size.x() + 1, index,
-                           size, param_weight, active);
+        Array<Float, 4> v =
+            lookup_bilinear(m_data.data(), index, size, param_weight, active);
 
-        return warp::square_to_bilinear_pdf(v00, v10, v01, v11, pos);
+        return warp::square_to_bilinear_pdf(v[0], v[1], v[2], v[3], pos);
     }
 
     std::string to_string() const {
@@ -922,6 +1259,43 @@ protected:
         }
     }
 
+    /**
+     * \brief Fetch the four corners (v00, v10, v01, v11) of a bilinear patch,
+     * accounting for the parameter interpolation
+     *
+     * In contrast to four separate \ref lookup() invocations, this fused
+     * version computes each conditional slice offset only once and issues the
+     * four gathers targeting neighboring memory locations back to back.
+     */
+    template <size_t Dim = Dimension>
+    MTS_INLINE Array<Float, 4> lookup_bilinear(const ScalarFloat *data,
+                                               UInt32 i0,
+                                               uint32_t size,
+                                               const Float *param_weight,
+                                               Mask active) const {
+        if constexpr (Dim != 0) {
+            UInt32 i1 = i0 + m_param_strides[Dim - 1] * size;
+
+            Float w0 = param_weight[2 * Dim - 2],
+                  w1 = param_weight[2 * Dim - 1];
+
+            Array<Float, 4> v0 = lookup_bilinear<Dim - 1>(data, i0, size,
+                                                          param_weight, active),
+                            v1 = lookup_bilinear<Dim - 1>(data, i1, size,
+                                                          param_weight, active);
+
+            return fmadd(v0, w0, v1 * w1);
+        } else {
+            ENOKI_MARK_USED(param_weight);
+            ENOKI_MARK_USED(size);
+            return Array<Float, 4>(
+                gather<Float>(data, i0, active),
+                gather<Float>(data + 1, i0, active),
+                gather<Float>(data + m_size.x(), i0, active),
+                gather<Float>(data + m_size.x() + 1, i0, active));
+        }
+    }
+
     MTS_INLINE
     std::pair<Point2f, Float> sample_discrete(Point2f sample,
                                               const Float *param,
@@ -990,18 +1364,12 @@ protected:
 
         // Sample a position on the bilinear patch
         UInt32 offset_data = slice_offset * n_data + row * m_size.x() + col;
-        Float v00 = lookup(m_data.data(), offset_data, n_data,
-                           param_weight, active),
-              v10 = lookup(m_data.data() + 1, offset_data, n_data,
-                           param_weight, active),
-              v01 = lookup(m_data.data() + m_size.x(), offset_data,
-                           n_data, param_weight, active),
-              v11 = lookup(m_data.data() + m_size.x() + 1, offset_data,
-                           n_data, param_weight, active);
+        Array<Float, 4> v = lookup_bilinear(m_data.data(), offset_data, n_data,
+                                            param_weight, active);
 
         Float pdf;
         std::tie(sample, pdf) =
-            warp::square_to_bilinear(v00, v10, v01, v11, sample);
+            warp::square_to_bilinear(v[0], v[1], v[2], v[3], sample);
 
         return { (Point2i(Point2u(col, row)) + sample) * m_patch_size, pdf };
     }
@@ -1030,17 +1398,11 @@ protected:
         UInt32 index = offset.x() + offset.y() * m_size.x() + slice_offset * n_data;
         sample -= Point2f(Point2i(offset));
 
-        Float v00 = lookup(m_data.data(), index,
-                           n_data, param_weight, active),
-              v10 = lookup(m_data.data() + 1, index,
-                           n_data, param_weight, active),
-              v01 = lookup(m_data.data() + m_size.x(), index,
-                           n_data, param_weight, active),
-              v11 = lookup(m_data.data() + m_size.x() + 1, index,
-                           n_data, param_weight, active);
+        Array<Float, 4> v =
+            lookup_bilinear(m_data.data(), index, n_data, param_weight, active);
 
         Float pdf;
-        std::tie(sample, pdf) = warp::bilinear_to_square(v00, v10, v01, v11, sample);
+        std::tie(sample, pdf) = warp::bilinear_to_square(v[0], v[1], v[2], v[3], sample);
 
         UInt32 offset_cond = slice_offset * n_cond + offset.y() * (m_size.x() - 1),
                offset_marg = slice_offset * n_marg;
@@ -1144,16 +1506,11 @@ protected:
 
         UInt32 offset_data = slice_offset * n_data + row * m_size.x() + col;
 
-        Float v00 = lookup(m_data.data(), offset_data, n_data,
-                           param_weight, active),
-              v10 = lookup(m_data.data() + 1, offset_data, n_data,
-                           param_weight, active),
-              v01 = lookup(m_data.data() + m_size.x(), offset_data,
-                           n_data, param_weight, active),
-              v11 = lookup(m_data.data() + m_size.x() + 1, offset_data,
-                           n_data, param_weight, active),
-              c0  = lerp(v00, v01, sample.y()),
-              c1  = lerp(v10, v11, sample.y());
+        Array<Float, 4> v = lookup_bilinear(m_data.data(), offset_data, n_data,
+                                            param_weight, active);
+
+        Float c0 = lerp(v[0], v[2], sample.y()),
+              c1 = lerp(v[1], v[3], sample.y());
 
         sample.x() = sample_segment(sample.x(), m_inv_patch_size.x(), c0, c1);
 
@@ -1190,17 +1547,11 @@ protected:
             slice_offset * n_data + pos.y() * m_size.x() + pos.x();
 
         // Invert the X component
-        Float v00 = lookup(m_data.data(), offset_data, n_data,
-                           param_weight, active),
-              v10 = lookup(m_data.data() + 1, offset_data, n_data,
-                           param_weight, active),
-              v01 = lookup(m_data.data() + m_size.x(), offset_data,
-                           n_data, param_weight, active),
-              v11 = lookup(m_data.data() + m_size.x() + 1, offset_data,
-                           n_data, param_weight, active);
-
-        Float c0  = lerp(v00, v01, sample.y()),
-              c1  = lerp(v10, v11, sample.y()),
+        Array<Float, 4> v = lookup_bilinear(m_data.data(), offset_data, n_data,
+                                            param_weight, active);
+
+        Float c0  = lerp(v[0], v[2], sample.y()),
+              c1  = lerp(v[1], v[3], sample.y()),
               pdf = lerp(c0, c1, sample.x());
 
         sample.x() = invert_segment(sample.x(), m_patch_size.x(), c0, c1);
@@ -1267,6 +1618,9 @@ protected:
     FloatStorage m_marg_cdf;
     FloatStorage m_cond_cdf;
 
+    /// Unnormalized integral of each slice (needed by \ref update())
+    std::vector<double> m_slice_integral;
+
     /// Are the probability values normalized?
     bool m_normalized;
 };
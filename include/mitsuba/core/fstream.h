@@ -50,6 +50,17 @@ public:
      */
     FileStream(const fs::path &p, EMode mode = ERead);
 
+    /** \brief Ask the operating system to begin loading the given file into
+     * its page cache.
+     *
+     * Issues a non-blocking readahead hint (e.g. \c posix_fadvise) where the
+     * platform provides one; elsewhere, the file contents are read once and
+     * discarded, which warms the cache but occupies the calling thread. The
+     * scene loader uses this to hide the first-byte latency of network file
+     * systems. Failures are silently ignored.
+     */
+    static void prefetch(const fs::path &p);
+
     /** \brief Closes the stream and the underlying file.
      * No further read or write operations are permitted.
      *
@@ -33,6 +33,17 @@ public:
      */
     MemoryStream(void *ptr, size_t size);
 
+    /**
+     * \brief Creates a read-only memory stream that provides a non-owning
+     * view of an external buffer (e.g. a memory-mapped scene cache).
+     *
+     * No data is copied; the caller must guarantee that the buffer remains
+     * valid for the lifetime of the stream. Write operations throw.
+     *
+     * \remark This constructor is not available in the python bindings.
+     */
+    MemoryStream(const void *ptr, size_t size);
+
     /// Returns a string representation
     std::string to_string() const override;
 
@@ -98,8 +109,8 @@ public:
     /// No-op since all writes are made directly to memory
     virtual void flush() override { };
 
-    /// Always returns true, except if the stream is closed.
-    virtual bool can_write() const override { return !is_closed(); }
+    /// Returns true, except for closed or read-only (view) streams.
+    virtual bool can_write() const override { return !m_read_only && !is_closed(); }
 
     /// Always returns true, except if the stream is closed.
     virtual bool can_read() const override { return !is_closed(); }
@@ -110,6 +121,33 @@ public:
     /// Return whether or not the memory stream owns the underlying buffer
     bool owns_buffer() const { return m_owns_buffer; }
 
+    /** \brief Pre-allocate memory for at least <tt>capacity</tt> bytes
+     *
+     * The capacity grows by the same doubling schedule that \ref write()
+     * uses, so interleaved calls never degrade to quadratic copying. The
+     * stream's size and position are unaffected. Use this when the final
+     * size of the contents is known in advance (e.g. when serializing a
+     * large mesh) to avoid repeated reallocation copies.
+     */
+    void reserve(size_t capacity);
+
+    /// Return a pointer to the underlying memory buffer
+    uint8_t *raw_buffer() { return m_data; }
+
+    /// Return a pointer to the underlying memory buffer (const version)
+    const uint8_t *raw_buffer() const { return m_data; }
+
+    /** \brief Relinquish ownership of the underlying buffer and return it
+     *
+     * Stores the number of bytes written so far in <tt>size_out</tt> and
+     * leaves the stream in the state of a freshly constructed empty
+     * instance, so no copy is made when handing the serialized contents to
+     * another consumer. The caller assumes ownership and must eventually
+     * release the buffer with <tt>std::free()</tt>. Throws when the stream
+     * does not own its buffer.
+     */
+    uint8_t *release_buffer(size_t &size_out);
+
     //! @}
     // =========================================================================
 
@@ -130,6 +168,8 @@ private:
     size_t m_pos;
     /// False if the MemoryStream was created from a pre-allocated buffer
     bool m_owns_buffer;
+    /// True if the MemoryStream is a read-only view of an external buffer
+    bool m_read_only;
     /// Pointer to the memory buffer (might not be owned)
     uint8_t *m_data;
     /// Whether the stream has been closed.
@@ -39,8 +39,14 @@ public:
     /// Return the current reference count
     int ref_count() const { return m_ref_count; };
 
-    /// Increase the object's reference count by one
-    void inc_ref() const { ++m_ref_count; }
+    /** \brief Increase the object's reference count by one
+     *
+     * Uses a relaxed atomic increment: the reference count is not used to
+     * synchronize any other memory, so no ordering is needed here. This
+     * avoids needless cache-line synchronization when many threads briefly
+     * reference a shared object (e.g. the scene or film during a render).
+     */
+    void inc_ref() const { m_ref_count.fetch_add(1, std::memory_order_relaxed); }
 
     /** \brief Decrease the reference count of the object and possibly
      * deallocate it.
@@ -245,6 +251,73 @@ private:
     T *m_ptr = nullptr;
 };
 
+/**
+ * \brief Non-owning borrowed reference
+ *
+ * The \a borrow template provides the accessor interface of \ref ref without
+ * touching the object's reference count. It is intended for hot loops that
+ * repeatedly access an object whose lifetime is already guaranteed by an
+ * owning \ref ref further up the call stack (e.g. per-sample accesses to the
+ * scene, film or sampler during rendering): a single owning reference is
+ * taken once per scope, and all inner uses borrow it for free. On heavily
+ * contended objects, this removes the cache-line ping-pong that per-use
+ * atomic increments and decrements of the reference count would cause.
+ *
+ * The caller is responsible for ensuring that the owner outlives the borrow.
+ */
+template <typename T> class borrow {
+public:
+    /// Create a <tt>nullptr</tt>-valued borrowed reference
+    borrow() { }
+
+    /// Borrow a plain pointer (whose owner must outlive this instance)
+    borrow(T *ptr) : m_ptr(ptr) { }
+
+    /// Borrow from an owning reference (which must outlive this instance)
+    borrow(const ref<T> &r) : m_ptr((T *) r.get()) { }
+
+    /// Compare this borrow to another borrow
+    bool operator==(const borrow &b) const { return m_ptr == b.m_ptr; }
+
+    /// Compare this borrow to another borrow
+    bool operator!=(const borrow &b) const { return m_ptr != b.m_ptr; }
+
+    /// Compare this borrow to a pointer
+    bool operator==(const T *ptr) const { return m_ptr == ptr; }
+
+    /// Compare this borrow to a pointer
+    bool operator!=(const T *ptr) const { return m_ptr != ptr; }
+
+    /// Access the borrowed object
+    T* operator->() { return m_ptr; }
+
+    /// Access the borrowed object
+    const T* operator->() const { return m_ptr; }
+
+    /// Return a C++ reference to the borrowed object
+    T& operator*() { return *m_ptr; }
+
+    /// Return a const C++ reference to the borrowed object
+    const T& operator*() const { return *m_ptr; }
+
+    /// Return a pointer to the borrowed object
+    operator T* () { return m_ptr; }
+
+    /// Return a pointer to the borrowed object
+    operator const T* () const { return m_ptr; }
+
+    /// Return a pointer to the borrowed object
+    T* get() { return m_ptr; }
+
+    /// Return a pointer to the borrowed object
+    const T* get() const { return m_ptr; }
+
+    /// Check if the object is defined
+    operator bool() const { return m_ptr != nullptr; }
+private:
+    T *m_ptr = nullptr;
+};
+
 /**
  * \brief Abstract class providing an interface for traversing scene graphs
  *
@@ -284,5 +357,7 @@ std::ostream& operator<<(std::ostream &os, const ref<T> &object) {
 // underlying pointer type.
 static_assert(sizeof(ref<Object>) == sizeof(Object *),
               "ref<T> must be reinterpretable as a T*.");
+static_assert(sizeof(borrow<Object>) == sizeof(Object *),
+              "borrow<T> must be reinterpretable as a T*.");
 
 NAMESPACE_END(mitsuba)
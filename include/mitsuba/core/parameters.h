@@ -0,0 +1,113 @@
+#pragma once
+
+#include <mitsuba/core/object.h>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Table of named parameters exposed by an object graph
+ *
+ * The table is built by recursively invoking \ref Object::traverse() and maps
+ * dotted names such as <tt>"my_shape.bsdf.reflectance.value"</tt> to the
+ * memory locations reported via \ref TraversalCallback::put_parameter().
+ * After modifying entries through \ref set(), a call to \ref update() re-runs
+ * \ref Object::parameters_changed() on the affected objects and their
+ * ancestors (children first), so that derived state---precomputed sampling
+ * tables, sRGB upsampling coefficients, the ray intersection acceleration
+ * data structure, etc.---is recomputed without re-loading the scene.
+ *
+ * Objects that are referenced from multiple places in the graph (e.g. a
+ * shared BSDF) are registered under the first path in traversal order.
+ */
+class MTS_EXPORT_CORE ParameterTable : public TraversalCallback {
+public:
+    struct Entry {
+        /// Run-time type of the parameter
+        const std::type_info *type = nullptr;
+
+        /// Memory location of the parameter within its owning object
+        void *ptr = nullptr;
+
+        /// Objects whose state depends on the parameter, from root to owner
+        std::vector<Object *> path;
+    };
+
+    ParameterTable() = default;
+
+    /// (Re-)build the table by traversing the graph rooted at \c root
+    void build(Object *root);
+
+    /// Return the number of registered parameters
+    size_t size() const { return m_names.size(); }
+
+    /// Does the table contain a parameter with the given name?
+    bool contains(const std::string &name) const;
+
+    /// Return the names of all parameters in traversal order
+    const std::vector<std::string> &names() const { return m_names; }
+
+    /**
+     * \brief Type-checked mutable access to a parameter
+     *
+     * The parameter is marked as modified; invoke \ref update() once all
+     * desired changes have been applied.
+     */
+    template <typename T> T &get(const std::string &name) {
+        Entry &entry = lookup(name, typeid(T));
+        m_dirty.insert(name);
+        return *((T *) entry.ptr);
+    }
+
+    /// Type-checked read-only access to a parameter
+    template <typename T> const T &get(const std::string &name) const {
+        return *((const T *) lookup(name, typeid(T)).ptr);
+    }
+
+    /// Overwrite a parameter and mark it as modified
+    template <typename T> void set(const std::string &name, const T &value) {
+        get<T>(name) = value;
+    }
+
+    /**
+     * \brief Mark a parameter as modified without accessing it
+     *
+     * Useful when the parameter contents were mutated through a previously
+     * obtained reference.
+     */
+    void set_dirty(const std::string &name);
+
+    /**
+     * \brief Re-propagate all changes since the last call
+     *
+     * Invokes \ref Object::parameters_changed() once on every object that
+     * (transitively) depends on a modified parameter, visiting children
+     * before their parents.
+     */
+    void update();
+
+protected:
+    void put_object(const std::string &name, Object *obj) override;
+    void put_parameter_impl(const std::string &name,
+                            const std::type_info &type, void *ptr) override;
+
+    Entry &lookup(const std::string &name, const std::type_info &type);
+    const Entry &lookup(const std::string &name,
+                        const std::type_info &type) const;
+
+private:
+    std::unordered_map<std::string, Entry> m_entries;
+    std::vector<std::string> m_names;
+    std::unordered_set<std::string> m_dirty;
+
+    /* Traversal state used while the table is being built */
+    std::string m_prefix;
+    std::vector<Object *> m_path;
+    std::unordered_set<const Object *> m_visited;
+};
+
+NAMESPACE_END(mitsuba)
@@ -26,11 +26,35 @@ public:
     /// Ensure that a plugin is loaded and ready
     void ensure_plugin_loaded(const std::string &name);
 
+    /**
+     * \brief Load a batch of plugins ahead of time
+     *
+     * Pulls the shared objects of all not-yet-loaded plugins in \c names
+     * into the page cache in parallel before handing them to the dynamic
+     * loader, which avoids the serial cold-start latency of loading many
+     * plugins from slow storage (e.g. a network-mounted installation).
+     * Entries that cannot be resolved are skipped without raising an error,
+     * since instantiation reports missing plugins with proper context.
+     */
+    void preload(const std::vector<std::string> &names);
+
     /// Return the list of loaded plugins
     std::vector<std::string> loaded_plugins() const;
 
     void register_python_plugin(const std::string &plugin_name);
 
+    /**
+     * \brief Return the class corresponding to a plugin for a specific
+     * variant, loading the plugin if necessary
+     *
+     * This is useful to determine the interface implemented by a plugin
+     * (e.g. whether \c diffuse is a BSDF or an emitter) before
+     * instantiating it, as done by the dictionary-based scene construction
+     * API in the Python bindings.
+     */
+    const Class *get_plugin_class(const std::string &name,
+                                  const std::string &variant);
+
     /**
      * \brief Instantiate a plugin, verify its type, and return the newly
      * created object instance.
@@ -3,11 +3,20 @@
 #pragma once
 
 #include <mitsuba/core/object.h>
+#include <atomic>
+#include <cstring>
+#include <utility>
+#include <vector>
 
 #if !defined(MTS_PROFILE_HASH_SIZE)
 #  define MTS_PROFILE_HASH_SIZE 256
 #endif
 
+/// Maximum nesting depth of profiled phases that is recorded per sample
+#if !defined(MTS_PROFILE_STACK_DEPTH)
+#  define MTS_PROFILE_STACK_DEPTH 8
+#endif
+
 NAMESPACE_BEGIN(mitsuba)
 
 /**
@@ -78,34 +87,154 @@ static_assert(std::extent_v<decltype(profiler_phase_id)> ==
                   int(ProfilerPhase::ProfilerPhaseCount),
               "Profiler phases and descriptions don't have matching length!");
 
+// =============================================================
+//  Always-on render statistics
+// =============================================================
+
+/**
+ * \brief Counters tracked by the always-on statistics subsystem
+ *
+ * In contrast to the sampling profiler below (which requires \c
+ * MTS_ENABLE_PROFILER and answers "where does the time go?"), these event
+ * counters are available in every build and answer "how much work was
+ * done?" -- e.g. the number of shadow rays cast, or the average number of
+ * intersection queries per camera ray.
+ */
+enum class StatsCounter : int {
+    CameraRays = 0,        /* Camera rays generated by the integrators */
+    IntersectRays,         /* Scene::ray_intersect() queries */
+    ShadowRays,            /* Scene::ray_test() queries */
+    EmitterSamples,        /* Scene::sample_emitter_direction() queries */
+    BSDFSamples,           /* BSDF::sample() invocations */
+    MediumSamples,         /* Medium::sample_interaction() invocations */
+
+    StatsCounterCount
+};
+
+constexpr const char
+    *stats_counter_id[int(StatsCounter::StatsCounterCount)] = {
+        "Camera rays",
+        "Intersection rays",
+        "Shadow rays",
+        "Emitter samples",
+        "BSDF samples",
+        "Medium samples"
+    };
+
+/**
+ * \brief Always-on render statistics
+ *
+ * Threads increment disjoint cache-line-padded counter stripes, hence the
+ * hot-path cost of \ref add() is a single uncontended relaxed atomic
+ * addition; the stripes are only aggregated at reporting time. \ref
+ * SamplingIntegrator::render() prints a summary at the end of each render
+ * job, and \ref write_json() exports the counters for machine-readable
+ * consumers.
+ */
+class MTS_EXPORT_CORE Statistics {
+public:
+    /// Add \c amount to the given counter (thread-safe, wait-free)
+    static void add(StatsCounter counter, uint64_t amount = 1);
+
+    /// Return the aggregated value of a single counter
+    static uint64_t value(StatsCounter counter);
+
+    /// Return aggregated name/value pairs of all counters
+    static std::vector<std::pair<std::string, uint64_t>> counters();
+
+    /// Log a human-readable summary of all counters
+    static void print_report();
+
+    /// Write the aggregated counters to a JSON file
+    static void write_json(const std::string &filename);
+
+    /// Reset all counters to zero
+    static void clear();
+
+private:
+    Statistics() = delete;
+};
+
+/**
+ * \brief Increment a render statistics counter by \c amount
+ *
+ * Packet variants should pass the number of active lanes (e.g. via
+ * <tt>count(active)</tt>). Defining \c MTS_DISABLE_STATISTICS compiles all
+ * increments out.
+ */
+#if !defined(MTS_DISABLE_STATISTICS)
+#  define MTS_STAT_ADD(counter, amount)                                        \
+      ::mitsuba::Statistics::add(::mitsuba::StatsCounter::counter,             \
+                                 (uint64_t) (amount))
+#else
+#  define MTS_STAT_ADD(counter, amount) do { } while (0)
+#endif
+
 #if defined(MTS_ENABLE_PROFILER)
+
+/**
+ * \brief Per-thread state accessed by \ref ScopedPhase and the sampling
+ * signal handler
+ *
+ * In addition to the historical bitmask of active phases (used for cheap
+ * re-entrancy detection), each thread maintains an explicit stack of phase
+ * identifiers so that samples record the true call path rather than a mere
+ * bitmask occupancy. The stack is updated write-before-depth (with signal
+ * fences) so that the handler always observes a consistent prefix.
+ */
+struct ProfilerState {
+    uint64_t flags = 0;
+    uint32_t depth = 0;
+    uint8_t  stack[MTS_PROFILE_STACK_DEPTH];
+};
+
 /* Inlining the access to a thread_local variable produces *awful* machine code
    with Clang on OSX. The combination of weak and noinline is needed to prevent
    the compiler from inlining it (just noinline does not seem to be enough). It
    is marked as 'const' because separate function calls always produce the same
    pointer. */
-extern MTS_EXPORT_CORE uint64_t *profiler_flags()
+extern MTS_EXPORT_CORE ProfilerState *profiler_state()
     __attribute__((noinline, weak, const));
 
+/// Replace the calling thread's profiler state (used when migrating work between threads)
+inline void profiler_set_state(const ProfilerState &value) {
+    ProfilerState *state = profiler_state();
+    state->depth = 0;
+    std::atomic_signal_fence(std::memory_order_release);
+    state->flags = value.flags;
+    memcpy(state->stack, value.stack, sizeof(value.stack));
+    std::atomic_signal_fence(std::memory_order_release);
+    state->depth = value.depth;
+}
+
 struct ScopedPhase {
     ScopedPhase(ProfilerPhase phase)
-        : m_target(profiler_flags()), m_flag(1ull << int(phase)) {
-        if ((*m_target & m_flag) == 0)
-            *m_target |= m_flag;
-        else
+        : m_state(profiler_state()), m_flag(1ull << int(phase)) {
+        if ((m_state->flags & m_flag) == 0 &&
+            m_state->depth < MTS_PROFILE_STACK_DEPTH) {
+            m_state->flags |= m_flag;
+            m_state->stack[m_state->depth] = (uint8_t) phase;
+            std::atomic_signal_fence(std::memory_order_release);
+            m_state->depth++;
+        } else {
             m_flag = 0;
+        }
     }
 
     ~ScopedPhase() {
-        *m_target &= ~m_flag;
+        if (m_flag != 0) {
+            m_state->depth--;
+            std::atomic_signal_fence(std::memory_order_release);
+            m_state->flags &= ~m_flag;
+        }
     }
 
     ScopedPhase(const ScopedPhase &) = delete;
     ScopedPhase &operator=(const ScopedPhase &) = delete;
 
 private:
-    uint64_t* m_target;
-    uint64_t  m_flag;
+    ProfilerState *m_state;
+    uint64_t      m_flag;
 };
 
 class MTS_EXPORT_CORE Profiler : public Object {
@@ -113,6 +242,32 @@ public:
     static void static_initialization();
     static void static_shutdown();
     static void print_report();
+
+    /**
+     * \brief Return the flat (leaf) sample counts recorded so far
+     *
+     * Each entry maps a phase name (or \c "Idle") to the number of timer
+     * samples attributed to it. Useful for machine-readable consumers such
+     * as the \c mitsuba-bench tool; \ref print_report() remains the
+     * human-readable counterpart.
+     */
+    static std::vector<std::pair<std::string, uint64_t>> flat_profile();
+
+    /**
+     * \brief Export all collected samples to a trace file in the
+     * <tt>chrome://tracing</tt> JSON format
+     *
+     * Each thread appears as a separate timeline; runs of consecutive
+     * samples with the same call path are merged into duration events, which
+     * makes it possible to correlate rendering phases with block scheduling
+     * across workers. Open the resulting file in the tracing viewer of a
+     * Chromium-based browser (or <tt>https://ui.perfetto.dev</tt>).
+     */
+    static void write_trace(const std::string &filename);
+
+    /// Discard all samples collected so far
+    static void clear();
+
     MTS_DECLARE_CLASS()
 private:
     Profiler() = delete;
@@ -127,6 +282,9 @@ public:
     static void static_initialization() { }
     static void static_shutdown() { }
     static void print_report() { }
+    static std::vector<std::pair<std::string, uint64_t>> flat_profile() { return { }; }
+    static void write_trace(const std::string &) { }
+    static void clear() { }
 };
 
 #endif
@@ -2,18 +2,36 @@
 
 #include <mitsuba/core/timer.h>
 #include <mitsuba/core/object.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
 
 NAMESPACE_BEGIN(mitsuba)
 
+class Logger;
+
 /**
  * \brief General-purpose progress reporter
  *
  * This class is used to track the progress of various operations that might
  * take longer than a second or so. It provides interactive feedback when
  * Mitsuba is run on the console, via the OpenGL GUI, or in Jupyter Notebook.
+ *
+ * Calls to \ref update() merely store the new value in a relaxed atomic and
+ * return immediately, hence many worker threads can report progress at block
+ * (or finer) granularity without contending on a lock. All formatting and
+ * output happens on an internal helper thread that wakes up at a fixed rate
+ * (10 Hz), which makes the redraw cost independent of how often \ref
+ * update() is invoked.
  */
 class MTS_EXPORT_CORE ProgressReporter : public Object {
 public:
+    /// Signature of the observer installed via \ref set_callback()
+    using Callback = std::function<void(float /* progress */,
+                                        size_t /* elapsed time in ms */)>;
+
     /**
      * \brief Construct a new progress reporter.
      * \param label
@@ -26,10 +44,45 @@ public:
     /// Update the progress to \c progress (which should be in the range [0, 1])
     void update(float progress);
 
+    /**
+     * \brief Install a callback observing the rate-limited progress
+     *
+     * The callback runs on the reporter's helper thread at the same gated
+     * rate as the console redraw and is guaranteed to observe the final
+     * value when the operation completes. This provides a machine-readable
+     * channel for consumers (e.g. a job scheduler or GUI) that should not
+     * have to parse terminal escape sequences.
+     */
+    void set_callback(Callback callback);
+
+    /**
+     * \brief Additionally emit machine-readable progress on the standard
+     * output?
+     *
+     * When enabled, every rate-limited progress tick writes one JSON object
+     * per line of the form
+     *
+     * \code
+     * {"type": "progress", "label": "..", "progress": .., "elapsed": .., "eta": ..}
+     * \endcode
+     *
+     * to \c stdout (times in seconds), allowing external schedulers to
+     * track long-running operations without parsing terminal escape codes.
+     * The flag applies to subsequently created reporters.
+     */
+    static void set_machine_readable(bool value);
+
     MTS_DECLARE_CLASS()
 protected:
+    /// Stop the helper thread, emitting a final update if one is pending
     ~ProgressReporter();
 
+    /// Entry point of the formatting/output helper thread
+    void run();
+
+    /// Format and emit the state given by \c progress and \c elapsed (in ms)
+    void emit(float progress, size_t elapsed);
+
 protected:
     Timer m_timer;
     std::string m_label;
@@ -39,6 +92,20 @@ protected:
     size_t m_last_update;
     float m_last_progress;
     void *m_payload;
+
+    /// Most recent value passed to \ref update()
+    std::atomic<float> m_progress;
+    /// Logger of the thread that created the reporter
+    ref<Logger> m_logger;
+    /// Observer installed via \ref set_callback(), protected by \ref m_mutex
+    Callback m_callback;
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_done = false;
+
+    static bool m_machine_readable;
 };
 
 NAMESPACE_END(mitsuba)
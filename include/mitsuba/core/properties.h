@@ -98,6 +98,17 @@ public:
      */
     bool mark_queried(const std::string &name) const;
 
+    /**
+     * \brief Mark all of the given properties as queried in a single pass
+     *
+     * Plugins with many optional parameters can consume their full key set
+     * at once (e.g. together with \ref unqueried()) instead of performing
+     * one lookup per parameter.
+     *
+     * \return The number of properties that were found
+     */
+    size_t mark_queried(const std::vector<std::string> &names) const;
+
     /// Check if a certain property was queried
     bool was_queried(const std::string &name) const;
 
@@ -115,6 +126,16 @@ public:
     /// Return an array containing the names of all stored properties
     std::vector<std::string> property_names() const;
 
+    /**
+     * \brief Return the values of all string-typed properties
+     *
+     * Unlike the regular accessors, this does not mark the visited
+     * properties as queried; it exists so that the scene loader can scan
+     * for referenced files without interfering with the unused-parameter
+     * detection of the plugins instantiated later.
+     */
+    std::vector<std::string> string_values() const;
+
     /// Return an array containing all named references and their destinations
     std::vector<std::pair<std::string, NamedReference>> named_references() const;
 
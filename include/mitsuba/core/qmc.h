@@ -68,25 +68,7 @@ public:
         if (unlikely(base_index >= m_base_count))
             Throw("eval(): out of bounds (prime base too large)");
 
-        const PrimeBase base = m_base[base_index];
-
-        UInt64 value(zero<UInt64>()),
-                divisor((uint64_t) base.value);
-        Float factor = Float(1.f),
-            recip(base.recip);
-
-        auto active = neq(index, enoki::zero<UInt64>());
-
-        while (any(active)) {
-            auto active_f = reinterpret_array<mask_t<Float>>(active);
-            UInt64 next = base.divisor(index);
-            masked(factor, active_f) = factor * recip;
-            masked(value, active) = (value - next) * divisor + index;
-            index = next;
-            active = neq(index, enoki::zero<UInt64>());
-        }
-
-        return min(math::OneMinusEpsilon<Float>, Float(value) * factor);
+        return eval_impl<Float>(m_base[base_index], index);
     }
 
     /**
@@ -102,30 +84,79 @@ public:
         if (unlikely(base_index >= m_base_count))
             Throw("eval(): out of bounds (prime base too large)");
 
-        const PrimeBase base = m_base[base_index];
-        const uint16_t *perm = m_permutations[base_index];
+        return eval_scrambled_impl<Float>(m_base[base_index],
+                                          m_permutations[base_index], index);
+    }
 
-        UInt64 value(zero<UInt64>()),
-                divisor((uint64_t) base.value),
-                mask(0xffffu);
-        Float factor(1.f),
-            recip(base.recip);
+    /**
+     * \brief Evaluate a range of dimensions of the (optionally scrambled)
+     * radical inverse function for a batch of points in one call
+     *
+     * Fills in <tt>out[point * dim_count + dim]</tt> for every combination of
+     * the \c point_count point indices and the \c dim_count consecutive prime
+     * bases starting at \c dim_offset. Compared to looping over \ref eval()
+     * or \ref eval_scrambled(), iterating dimension-major keeps the
+     * fixed-point division constants of each base in registers and its
+     * permutation table in cache while they are reused for the entire batch.
+     * When instantiated with a scalar \c Float type, the points of each
+     * dimension are additionally swept in native SIMD packets (with gathered
+     * permutation lookups) rather than one at a time.
+     *
+     * \param dim_offset
+     *     Index of the prime base that provides the first output dimension
+     *
+     * \param dim_count
+     *     Number of consecutive dimensions to fill in
+     *
+     * \param index
+     *     Pointer to \c point_count point indices
+     *
+     * \param point_count
+     *     Number of points in the batch
+     *
+     * \param out
+     *     Output array with space for <tt>point_count * dim_count</tt>
+     *     entries, laid out point-major
+     *
+     * \param scrambled
+     *     Run every digit through the scrambling permutation as in
+     *     \ref eval_scrambled()?
+     */
+    template <typename Float, typename UInt64 = uint64_array_t<Float>>
+    void eval_n(size_t dim_offset, size_t dim_count, const UInt64 *index,
+                size_t point_count, Float *out, bool scrambled = false) const {
+        if (unlikely(dim_offset + dim_count > m_base_count))
+            Throw("eval_n(): out of bounds (prime base too large)");
 
-        auto active = neq(index, enoki::zero<UInt64>());
+        for (size_t d = 0; d < dim_count; ++d) {
+            const PrimeBase base = m_base[dim_offset + d];
+            const uint16_t *perm = m_permutations[dim_offset + d];
+            Float *out_d = out + d;
+            size_t i = 0;
 
-        while (any(active)) {
-            auto active_f = reinterpret_array<mask_t<Float>>(active);
-            UInt64 next = base.divisor(index);
-            masked(factor, active_f) = factor * recip;
-            UInt64 digit = index - next * divisor;
-            masked(value, active) =
-                value * divisor + (enoki::gather<UInt64, 2>(perm, digit, active) & mask);
-            index = next;
-            active = neq(index, enoki::zero<UInt64>());
-        }
+            if constexpr (!is_array_v<Float>) {
+                /* Scalar callers: sweep the batch in native packets */
+                using FloatP  = enoki::Packet<Float>;
+                using UInt64P = uint64_array_t<FloatP>;
 
-        Float correction(base.recip * (Float) perm[0] / ((Float) 1 - base.recip));
-        return min(math::OneMinusEpsilon<Float>, (Float(value) + correction) * factor);
+                for (; i + FloatP::Size <= point_count; i += FloatP::Size) {
+                    UInt64P index_p =
+                        enoki::load_unaligned<UInt64P>(index + i);
+                    FloatP value =
+                        scrambled
+                            ? eval_scrambled_impl<FloatP>(base, perm, index_p)
+                            : eval_impl<FloatP>(base, index_p);
+                    enoki::scatter(out_d + i * dim_count, value,
+                                   enoki::arange<uint32_array_t<FloatP>>() *
+                                       (uint32_t) dim_count);
+                }
+            }
+
+            for (; i < point_count; ++i)
+                out_d[i * dim_count] =
+                    scrambled ? eval_scrambled_impl<Float>(base, perm, index[i])
+                              : eval_impl<Float>(base, index[i]);
+        }
     }
 
     /// Return the permutation corresponding to the given prime number basis
@@ -174,6 +205,55 @@ private:
 #  pragma pack(pop)
 #endif
 
+    /// Digit loop of \ref eval() with hoisted per-base constants
+    template <typename Float, typename UInt64 = uint64_array_t<Float>>
+    static Float eval_impl(const PrimeBase &base, UInt64 index) {
+        UInt64 value(zero<UInt64>()),
+                divisor((uint64_t) base.value);
+        Float factor = Float(1.f),
+            recip(base.recip);
+
+        auto active = neq(index, enoki::zero<UInt64>());
+
+        while (any(active)) {
+            auto active_f = reinterpret_array<mask_t<Float>>(active);
+            UInt64 next = base.divisor(index);
+            masked(factor, active_f) = factor * recip;
+            masked(value, active) = (value - next) * divisor + index;
+            index = next;
+            active = neq(index, enoki::zero<UInt64>());
+        }
+
+        return min(math::OneMinusEpsilon<Float>, Float(value) * factor);
+    }
+
+    /// Digit loop of \ref eval_scrambled() with hoisted per-base constants
+    template <typename Float, typename UInt64 = uint64_array_t<Float>>
+    static Float eval_scrambled_impl(const PrimeBase &base,
+                                     const uint16_t *perm, UInt64 index) {
+        UInt64 value(zero<UInt64>()),
+                divisor((uint64_t) base.value),
+                mask(0xffffu);
+        Float factor(1.f),
+            recip(base.recip);
+
+        auto active = neq(index, enoki::zero<UInt64>());
+
+        while (any(active)) {
+            auto active_f = reinterpret_array<mask_t<Float>>(active);
+            UInt64 next = base.divisor(index);
+            masked(factor, active_f) = factor * recip;
+            UInt64 digit = index - next * divisor;
+            masked(value, active) =
+                value * divisor + (enoki::gather<UInt64, 2>(perm, digit, active) & mask);
+            index = next;
+            active = neq(index, enoki::zero<UInt64>());
+        }
+
+        Float correction(base.recip * (Float) perm[0] / ((Float) 1 - base.recip));
+        return min(math::OneMinusEpsilon<Float>, (Float(value) + correction) * factor);
+    }
+
     size_t m_base_count = 0;
     std::unique_ptr<PrimeBase[]> m_base;
     std::unique_ptr<uint16_t[]> m_permutation_storage;
@@ -171,4 +171,23 @@ auto sample_tea_float(UInt v0, UInt v1, int rounds = 4) {
         return sample_tea_float64(v0, v1, rounds);
 }
 
+/**
+ * \brief 256x256 forced-random dither matrix
+ *
+ * The array stores a permutation of the integers in <tt>[0, 65536)</tt> that
+ * was optimized so that nearby entries are as different as possible, rescaled
+ * to the interval <tt>[-0.5, 0.5)</tt>. It tiles seamlessly with period 256
+ * in both dimensions and has a blue-noise spectrum, which makes it useful
+ * both for dithered image quantization and for decorrelating per-pixel
+ * sampling decisions.
+ *
+ * The binary only embeds the 16-bit integer ranks; they are expanded once at
+ * load time into the aligned 65536-entry float buffer that this pointer
+ * refers to (see <tt>dither-matrix256.cpp</tt>).
+ *
+ * Based on W. Purgathofer, R. F. Tobler, and M. Geiler, "Forced random
+ * dithering: improved threshold matrices for ordered dithering" (ICIP 1994).
+ */
+extern MTS_EXPORT_CORE const float *dither_matrix256;
+
 NAMESPACE_END(mitsuba)
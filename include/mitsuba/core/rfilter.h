@@ -60,8 +60,9 @@ public:
 
     /// Evaluate a discretized version of the filter (generally faster than 'eval')
     MTS_INLINE Float eval_discretized(Float x, Mask active = true) const {
-        Int32 index = min(Int32(abs(x * m_scale_factor)), MTS_FILTER_RESOLUTION);
-        return gather<Float>(m_values.data(), index, active);
+        UInt32 index = min(UInt32(abs(x * m_scale_factor)),
+                           (uint32_t) MTS_FILTER_RESOLUTION);
+        return gather<Float>(m_values, index, active);
     }
 
     MTS_DECLARE_CLASS()
@@ -77,7 +78,8 @@ protected:
 
 protected:
     ScalarFloat m_radius, m_scale_factor;
-    std::vector<ScalarFloat> m_values;
+    /// Filter discretization (resides on the GPU in CUDA variants)
+    DynamicBuffer<Float> m_values;
     uint32_t m_border_size;
 };
 
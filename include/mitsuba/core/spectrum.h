@@ -131,11 +131,19 @@ struct Spectrum<enoki::detail::MaskedArray<Value_>, Size_>
 #define MTS_CIE_MAX           830.f
 #define MTS_CIE_SAMPLES       95
 
+/* Sample count of the precomputed response tables backing \ref cie1931_xyz
+   and \ref cie1931_y (~0.5nm spacing over the active wavelength range) */
+#define MTS_CIE_RESPONSE_SAMPLES 941
+
 /* Scaling the CIE curves by the following constant ensures that
    a unit-valued spectrum integrates to a luminance of 1.0 */
 #define MTS_CIE_Y_NORMALIZATION float(1.0 / 106.7502593994140625)
 
-/// Table with fits for \ref cie1931_xyz and \ref cie1931_y
+/** Dense response tables for \ref cie1931_xyz and \ref cie1931_y, resampled
+ * from the 5nm CIE fits onto a grid aligned with the
+ * <tt>[MTS_WAVELENGTH_MIN, MTS_WAVELENGTH_MAX]</tt> range sampled by the
+ * sensors. The interpolation of the fits happens once at table build time,
+ * so lookups reduce to a single gather per curve. */
 extern MTS_EXPORT_CORE const float *cie1931_x_data;
 extern MTS_EXPORT_CORE const float *cie1931_y_data;
 extern MTS_EXPORT_CORE const float *cie1931_z_data;
@@ -143,6 +151,18 @@ extern MTS_EXPORT_CORE const float *cie1931_z_data;
 /// Allocate GPU memory for the CIE 1931 tables
 extern MTS_EXPORT_CORE void cie_alloc();
 
+/* Scaling the D65 table by the following constant ensures that integrating
+   the spectrum against the CIE curves & converting to sRGB yields a pixel
+   value of (1, 1, 1) */
+#define MTS_D65_NORMALIZATION float(1.0 / 10568.0)
+
+/** Relative spectral power distribution of the CIE Standard Illuminant D65,
+ * normalized relative to the power at 560nm and tabulated at the same 5nm
+ * spacing as the color matching curves above (\ref MTS_CIE_SAMPLES entries
+ * over <tt>[MTS_CIE_MIN, MTS_CIE_MAX]</tt>). Shared by the \c d65 and
+ * \c srgb_d65 spectrum plugins. */
+extern MTS_EXPORT_CORE const float d65_table[MTS_CIE_SAMPLES];
+
 /**
  * \brief Evaluate the CIE 1931 XYZ color matching functions given a wavelength
  * in nanometers
@@ -151,28 +171,23 @@ template <typename Float, typename Result = Color<Float, 3>>
 Result cie1931_xyz(Float wavelength, mask_t<Float> active = true) {
     using Int32 = int32_array_t<Float>;
 
-    Float t = (wavelength - MTS_CIE_MIN) *
-             ((MTS_CIE_SAMPLES - 1) / (MTS_CIE_MAX - MTS_CIE_MIN));
-
-    active &= wavelength >= MTS_CIE_MIN &&
-              wavelength <= MTS_CIE_MAX;
+    /* The response tables are dense enough for nearest-neighbor lookups,
+       which reduces the former six gathers plus interpolation to one
+       gather per curve */
+    Float t = (wavelength - MTS_WAVELENGTH_MIN) *
+             ((MTS_CIE_RESPONSE_SAMPLES - 1) /
+              (MTS_WAVELENGTH_MAX - MTS_WAVELENGTH_MIN));
 
-    Int32 i0 = clamp(Int32(t), zero<Int32>(), Int32(MTS_CIE_SAMPLES - 2)),
-          i1 = i0 + 1;
+    active &= wavelength >= MTS_WAVELENGTH_MIN &&
+              wavelength <= MTS_WAVELENGTH_MAX;
 
-    Float v0_x = gather<Float>(cie1931_x_data, i0, active),
-          v1_x = gather<Float>(cie1931_x_data, i1, active),
-          v0_y = gather<Float>(cie1931_y_data, i0, active),
-          v1_y = gather<Float>(cie1931_y_data, i1, active),
-          v0_z = gather<Float>(cie1931_z_data, i0, active),
-          v1_z = gather<Float>(cie1931_z_data, i1, active);
+    Int32 i = clamp(Int32(t + .5f), zero<Int32>(),
+                    Int32(MTS_CIE_RESPONSE_SAMPLES - 1));
 
-    Float w1 = t - Float(i0),
-          w0 = 1.f - w1;
-
-    return Result(fmadd(w0, v0_x, w1 * v1_x),
-                  fmadd(w0, v0_y, w1 * v1_y),
-                  fmadd(w0, v0_z, w1 * v1_z)) & mask_t<Result>(active);
+    return Result(gather<Float>(cie1931_x_data, i, active),
+                  gather<Float>(cie1931_y_data, i, active),
+                  gather<Float>(cie1931_z_data, i, active)) &
+           mask_t<Result>(active);
 }
 
 /**
@@ -184,22 +199,17 @@ template <typename Float>
 Float cie1931_y(Float wavelength, mask_t<Float> active = true) {
     using Int32 = int32_array_t<Float>;
 
-    Float t = (wavelength - MTS_CIE_MIN) *
-             ((MTS_CIE_SAMPLES - 1) / (MTS_CIE_MAX - MTS_CIE_MIN));
-
-    active &= wavelength >= MTS_CIE_MIN &&
-              wavelength <= MTS_CIE_MAX;
-
-    Int32 i0 = clamp(Int32(t), zero<Int32>(), Int32(MTS_CIE_SAMPLES - 2)),
-          i1 = i0 + 1;
+    Float t = (wavelength - MTS_WAVELENGTH_MIN) *
+             ((MTS_CIE_RESPONSE_SAMPLES - 1) /
+              (MTS_WAVELENGTH_MAX - MTS_WAVELENGTH_MIN));
 
-    Float v0 = gather<Float>(cie1931_y_data, i0, active),
-          v1 = gather<Float>(cie1931_y_data, i1, active);
+    active &= wavelength >= MTS_WAVELENGTH_MIN &&
+              wavelength <= MTS_WAVELENGTH_MAX;
 
-    Float w1 = t - Float(i0),
-          w0 = 1.f - w1;
+    Int32 i = clamp(Int32(t + .5f), zero<Int32>(),
+                    Int32(MTS_CIE_RESPONSE_SAMPLES - 1));
 
-    return select(active, fmadd(w0, v0, w1 * v1), 0.f);
+    return select(active, gather<Float>(cie1931_y_data, i, active), 0.f);
 }
 
 /// Spectral responses to XYZ.
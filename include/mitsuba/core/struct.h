@@ -395,6 +395,31 @@ public:
                     void *dest) const;
 #endif
 
+    /**
+     * \brief Convert \c count elements using all available processor cores
+     *
+     * Identical to \ref convert except that large inputs are split into
+     * batches that are processed in parallel.
+     *
+     * \return \c true upon success
+     */
+    bool convert_parallel(size_t count, const void *src, void *dest) const {
+        return convert_2d_parallel(count, 1, src, dest);
+    }
+
+    /**
+     * \brief Convert a 2D image using all available processor cores
+     *
+     * Identical to \ref convert_2d except that large inputs are split into
+     * batches that are processed in parallel. The batch boundaries are
+     * aligned to the period of the dither matrix, hence the result matches
+     * the serial implementation bit for bit (also when dithering is enabled).
+     *
+     * \return \c true upon success
+     */
+    bool convert_2d_parallel(size_t width, size_t height, const void *src,
+                             void *dest) const;
+
     /// Return the source \c Struct descriptor
     const Struct *source() const { return m_source.get(); }
 
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <mitsuba/core/object.h>
+#include <mitsuba/core/profiler.h>
+#include <tbb/task_arena.h>
 #include <memory>
 
 NAMESPACE_BEGIN(mitsuba)
@@ -146,6 +148,52 @@ public:
     /// Unregister a thread (e.g. TBB, Python) from Mitsuba's thread system.
     static bool unregister_external_thread();
 
+    // =========================================================================
+    //! @{ \name NUMA-aware worker pinning
+    // =========================================================================
+
+    /**
+     * \brief Enable or disable NUMA-aware pinning of worker threads
+     *
+     * When enabled, TBB worker threads are distributed round-robin over the
+     * machine's NUMA nodes and pinned to the cores of their assigned node
+     * (the calling thread is pinned to node 0). Read-only rendering data
+     * structures can then be replicated per node and queried via \ref
+     * numa_node(), so that the traversal-heavy inner loops never touch
+     * remote-socket memory.
+     *
+     * Must be called before the TBB scheduler spawns its workers to be
+     * fully effective. Currently only implemented on Linux; on other
+     * platforms the machine is treated as a single node.
+     */
+    static void set_numa_pinning(bool enable);
+
+    /// Is NUMA-aware worker pinning enabled?
+    static bool numa_pinning();
+
+    /// Return the number of NUMA nodes of the machine (1 when unknown)
+    static int numa_node_count();
+
+    /**
+     * \brief Return the NUMA node that the calling thread is pinned to
+     *
+     * Returns 0 for threads that have not been pinned (e.g. when pinning
+     * is disabled), which makes the value safe to use as a replica index.
+     */
+    static int numa_node();
+
+    /**
+     * \brief Pin the calling thread to the cores of the given NUMA node
+     *
+     * Subsequent memory allocated and first touched by the thread is then
+     * placed on that node by the operating system. Returns \c true upon
+     * success.
+     */
+    static bool pin_to_numa_node(int node);
+
+    //! @}
+    // =========================================================================
+
     MTS_DECLARE_CLASS()
 protected:
     /// Protected destructor
@@ -186,7 +234,7 @@ private:
     ref<Logger> m_logger;
     ref<FileResolver> m_file_resolver;
 #if defined(MTS_ENABLE_PROFILER)
-    uint64_t m_profiler_flags;
+    ProfilerState m_profiler_state;
 #endif
 };
 
@@ -203,10 +251,35 @@ private:
     ref<Logger> m_logger;
     ref<FileResolver> m_file_resolver;
 #if defined(MTS_ENABLE_PROFILER)
-    uint64_t m_profiler_flags;
+    ProfilerState m_profiler_state;
 #endif
 };
 
 extern MTS_EXPORT_CORE size_t __global_thread_count;
 
+/**
+ * \brief Return the task arena that hosts all of Mitsuba's parallel work
+ *
+ * Rendering, Embree BVH builds (via \c rtcJoinCommitScene), kd-tree
+ * construction, image decoding, and parallel scene instantiation all execute
+ * inside this single arena, so that concurrent or nested parallel phases
+ * share one pool of workers instead of stacking their own pools on top of
+ * each other. The arena is created lazily with \ref __global_thread_count
+ * slots (one per core by default) and can be resized via
+ * \ref set_global_thread_count().
+ */
+extern MTS_EXPORT_CORE tbb::task_arena &global_task_arena();
+
+/**
+ * \brief Cap the total number of worker threads used by Mitsuba
+ *
+ * Resizes the arena returned by \ref global_task_arena() and updates
+ * \ref __global_thread_count, which also bounds the OpenEXR thread pool
+ * the next time it is used. Passing \c 0 restores the default of one
+ * worker per core (\ref util::core_count()). Intended for job wrappers
+ * that must reliably limit the concurrency of a rendering process on
+ * shared machines.
+ */
+extern MTS_EXPORT_CORE void set_global_thread_count(size_t count = 0);
+
 NAMESPACE_END(mitsuba)
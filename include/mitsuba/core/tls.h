@@ -2,7 +2,10 @@
 
 #include <mitsuba/mitsuba.h>
 #include <mitsuba/core/object.h>
+#include <algorithm>
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -25,8 +28,10 @@ NAMESPACE_BEGIN(mitsuba)
  *
  * The implementation is designed to make the ``get()`` operation as fast as as
  * possible at the cost of more involved locking when creating or destroying
- * threads and TLS objects. To actually instantiate a TLS object with a
- * specific type, use the \ref ThreadLocal class.
+ * threads and TLS objects: repeated accesses to the same object resolve
+ * through a small direct-mapped cache held in native \c thread_local storage
+ * and don't touch the lock-protected registry at all. To actually instantiate
+ * a TLS object with a specific type, use the \ref ThreadLocal class.
  *
  * \sa ThreadLocal
  */
@@ -147,4 +152,129 @@ public:
     }
 };
 
+/**
+ * \brief Monotonic memory arena for per-thread scratch allocations
+ *
+ * The rendering worker threads repeatedly acquire short-lived scratch
+ * buffers (AOV sample arrays, path state queues, etc.). Requesting them
+ * from the general-purpose allocator causes measurable lock contention at
+ * high thread counts, hence this class hands out memory from a set of
+ * geometrically growing chunks that are owned by a single thread and
+ * recycled wholesale.
+ *
+ * Allocation simply bumps a pointer; there is no per-allocation release.
+ * Instead, a \ref Rewind guard records the arena state at a given point and
+ * restores it when leaving the corresponding scope, freeing everything
+ * allocated within (guards may be nested, following stack discipline). The
+ * class is not thread-safe by design -- instantiate it through \ref
+ * ThreadLocal to obtain one arena per worker thread.
+ */
+class ScratchArena {
+public:
+    /// RAII guard that releases all allocations made during its lifetime
+    struct Rewind {
+        Rewind(ScratchArena &arena)
+            : m_arena(arena), m_index(arena.m_index),
+              m_offset(arena.m_offset) { }
+        ~Rewind() {
+            m_arena.m_index = m_index;
+            m_arena.m_offset = m_offset;
+        }
+    private:
+        ScratchArena &m_arena;
+        size_t m_index, m_offset;
+    };
+
+    ScratchArena() { }
+
+    // Chunk ownership must not be shared or duplicated
+    ScratchArena(const ScratchArena &) = delete;
+    ScratchArena &operator=(const ScratchArena &) = delete;
+
+    /// Allocate \c size bytes of storage with the given alignment
+    void *alloc(size_t size, size_t align = alignof(std::max_align_t)) {
+        while (true) {
+            if (m_index < m_chunks.size()) {
+                Chunk &chunk = m_chunks[m_index];
+
+                uintptr_t base    = (uintptr_t) chunk.data.get() + m_offset,
+                          aligned = (base + align - 1) & ~(uintptr_t) (align - 1);
+
+                size_t offset = m_offset + (size_t) (aligned - base) + size;
+                if (offset <= chunk.size) {
+                    m_offset = offset;
+                    return (void *) aligned;
+                }
+
+                // Chunk exhausted -- advance (possibly into a recycled one)
+                m_index++;
+                m_offset = 0;
+                continue;
+            }
+
+            size_t chunk_size =
+                std::max(m_chunks.empty() ? InitialChunkSize
+                                          : m_chunks.back().size * 2,
+                         size + align);
+
+            m_chunks.push_back(Chunk {
+                std::unique_ptr<uint8_t[]>(new uint8_t[chunk_size]),
+                chunk_size
+            });
+        }
+    }
+
+    /// Allocate uninitialized storage for \c count values of type \c T
+    template <typename T> T *alloc(size_t count) {
+        return (T *) alloc(sizeof(T) * count, alignof(T));
+    }
+
+private:
+    static constexpr size_t InitialChunkSize = 1024 * 1024;
+
+    struct Chunk {
+        std::unique_ptr<uint8_t[]> data;
+        size_t size;
+    };
+
+    std::vector<Chunk> m_chunks;
+    size_t m_index = 0, m_offset = 0;
+};
+
+/**
+ * \brief Minimal allocator adapter so that STL containers can draw their
+ * storage from a \ref ScratchArena
+ *
+ * Deallocation is a no-op -- the memory is reclaimed wholesale when the
+ * enclosing \ref ScratchArena::Rewind guard goes out of scope.
+ */
+template <typename T> class ScratchAllocator {
+public:
+    using value_type = T;
+
+    ScratchAllocator(ScratchArena &arena) : m_arena(&arena) { }
+
+    template <typename T2>
+    ScratchAllocator(const ScratchAllocator<T2> &other)
+        : m_arena(other.arena()) { }
+
+    T *allocate(size_t count) { return m_arena->template alloc<T>(count); }
+    void deallocate(T *, size_t) { }
+
+    ScratchArena *arena() const { return m_arena; }
+
+    template <typename T2>
+    bool operator==(const ScratchAllocator<T2> &other) const {
+        return m_arena == other.arena();
+    }
+
+    template <typename T2>
+    bool operator!=(const ScratchAllocator<T2> &other) const {
+        return m_arena != other.arena();
+    }
+
+private:
+    ScratchArena *m_arena;
+};
+
 NAMESPACE_END(mitsuba)
@@ -2,6 +2,7 @@
 
 #include <mitsuba/core/ray.h>
 #include <enoki/transform.h>
+#include <atomic>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -474,6 +475,87 @@ public:
         }
     }
 
+    /**
+     * \brief Batched evaluation for time-coherent packets
+     *
+     * Rays generated by a sensor for a single image block usually carry very
+     * similar time values, hence entire packets tend to fall into the same
+     * keyframe interval. This variant exploits that: it checks whether all
+     * active lanes of \c time lie within one interval (starting from the
+     * interval found by the previous call, which is cached), and if so loads
+     * the two bracketing keyframes with ordinary scalar reads instead of
+     * per-lane gathers. The interpolation itself—including the quaternion
+     * slerp—still runs vectorized across the packet. Packets that straddle
+     * a keyframe boundary fall back to \ref eval().
+     */
+    template <typename T>
+    Transform<Point<T, 4>> eval_coherent(T time, mask_t<T> active = true) const {
+        if constexpr (!is_array_v<T> || is_diff_array_v<T>) {
+            return eval(time, active);
+        } else {
+            using Value        = replace_scalar_t<T, Float>;
+            using Matrix3f     = Matrix<Value, 3>;
+            using Quaternion4f = Quaternion<Value>;
+            using Vector3f     = Vector<Value, 3>;
+
+            // Perhaps the transformation isn't animated
+            if (likely(size() <= 1))
+                return Transform<Point<T, 4>>(m_transform.matrix);
+
+            uint32_t n_intervals = (uint32_t) size() - 1;
+
+            /* Test whether the packet is contained in the interval found by
+               the previous call. A relaxed read/write suffices here: the hint
+               only affects performance, never the result. */
+            uint32_t idx0 = m_cached_interval.load(std::memory_order_relaxed);
+            if (unlikely(idx0 >= n_intervals))
+                idx0 = 0;
+
+            auto contained = [&](uint32_t idx) {
+                Float t_lo = m_keyframes[idx].time,
+                      t_hi = m_keyframes[idx + 1].time;
+                mask_t<T> inside = time >= t_lo && time <= t_hi;
+                /* Out-of-range times clamp to the first/last keyframe */
+                if (idx == 0)
+                    inside |= time < t_lo;
+                if (idx == n_intervals - 1)
+                    inside |= time > t_hi;
+                return all(inside || !active);
+            };
+
+            if (!contained(idx0)) {
+                /* Cache miss: rerun the search once for the smallest active
+                   time value and update the hint */
+                scalar_t<T> t_min =
+                    hmin(select(active, time, math::Infinity<T>));
+                idx0 = math::find_interval(
+                    (uint32_t) size(),
+                    [&](uint32_t idx) { return m_keyframes[idx].time <= t_min; });
+                m_cached_interval.store(idx0, std::memory_order_relaxed);
+
+                /* The packet straddles a keyframe boundary */
+                if (!contained(idx0))
+                    return eval(time, active);
+            }
+
+            const Keyframe &k0 = m_keyframes[idx0],
+                           &k1 = m_keyframes[idx0 + 1];
+
+            // Compute the relative time value in [0, 1]
+            Value t = min(max((time - k0.time) / (k1.time - k0.time), 0.f), 1.f);
+
+            Matrix3f scale     = Matrix3f(k0.scale) * (1 - t) + Matrix3f(k1.scale) * t;
+            Quaternion4f quat  = enoki::slerp(Quaternion4f(k0.quat),
+                                              Quaternion4f(k1.quat), t);
+            Vector3f trans     = Vector3f(k0.trans) * (1 - t) + Vector3f(k1.trans) * t;
+
+            return Transform<Point<T, 4>>(
+                enoki::transform_compose(scale, quat, trans),
+                enoki::transform_compose_inverse(scale, quat, trans)
+            );
+        }
+    }
+
     /**
      * \brief Return an axis-aligned box bounding the amount of translation
      * throughout the animation sequence
@@ -513,6 +595,9 @@ public:
 private:
     Transform4f m_transform;
     std::vector<Keyframe> m_keyframes;
+
+    /// Keyframe interval found by the last \ref eval_coherent() call (a hint)
+    mutable std::atomic<uint32_t> m_cached_interval { 0 };
 };
 
 // -----------------------------------------------------------------------
@@ -28,6 +28,64 @@ extern MTS_EXPORT_CORE std::string time_string(float time, bool precise = false)
 /// Turn a memory size into a human-readable string
 extern MTS_EXPORT_CORE std::string mem_string(size_t size, bool precise = false);
 
+/**
+ * \brief Record a large allocation in the central memory registry
+ *
+ * The registry tracks the current and peak number of bytes held by each
+ * subsystem (mesh geometry, kd-tree, film storage, memory-mapped files, ...),
+ * which makes it possible to determine which data structure is responsible
+ * for the application's memory footprint (see \ref memory_usage_string()).
+ * Each update locks a mutex, hence only allocations on the order of megabytes
+ * should be tracked.
+ */
+extern MTS_EXPORT_CORE void track_memory(const char *category, size_t size);
+
+/// Undo a \ref track_memory() call when the allocation is released
+extern MTS_EXPORT_CORE void untrack_memory(const char *category, size_t size);
+
+/**
+ * \brief Return a human-readable table listing the current and peak memory
+ * usage of every subsystem registered via \ref track_memory()
+ */
+extern MTS_EXPORT_CORE std::string memory_usage_string();
+
+/**
+ * \brief Advise the kernel to back an allocation with transparent huge pages
+ *
+ * Large data structures (multi-gigabyte kd-trees, films, vertex buffers)
+ * span millions of standard 4 KiB pages, and random accesses during
+ * rendering then compete for the limited number of TLB entries. Backing
+ * them with 2 MiB huge pages removes most of this pressure.
+ *
+ * The given range is rounded inwards to page boundaries; the call is a
+ * no-op when the remainder spans less than one huge page or when the
+ * platform lacks the facility (non-Linux). Failures are ignored, as the
+ * advice is purely an optimization hint.
+ */
+extern MTS_EXPORT_CORE void advise_huge_pages(void *ptr, size_t size);
+
+#if defined(MTS_ENABLE_OPTIX)
+/**
+ * \brief Should a GPU scene buffer of the given size be placed in CUDA
+ * managed (unified) memory rather than plain device memory?
+ *
+ * Device memory is faster but hard-fails once a scene outgrows the card;
+ * managed memory lets the driver page individual buffers in and out on
+ * demand, so that oversized scenes degrade gracefully instead of aborting.
+ * Allocation sites for long-lived scene data (vertex buffers, texture
+ * pyramids) consult this predicate and allocate via \c cuda_managed_malloc()
+ * when it returns \c true.
+ *
+ * The policy can be forced via the environment variable
+ * <tt>MTS_CUDA_MANAGED</tt> (0: never, 1: always). By default, buffers are
+ * allocated directly on the device while the scene comfortably fits, and the
+ * function permanently switches to managed memory as soon as an allocation
+ * would crowd out the headroom needed by the acceleration structure build
+ * and the wavefront buffers.
+ */
+extern MTS_EXPORT_CORE bool cuda_prefer_managed(size_t size);
+#endif
+
 /// Returns 'true' if the application is running inside a debugger
 extern MTS_EXPORT_CORE bool detect_debugger();
 
@@ -49,5 +107,23 @@ extern MTS_EXPORT_CORE std::string info_copyright();
 /// Return human-readable information about the enabled processor features
 extern MTS_EXPORT_CORE std::string info_features();
 
+/** \brief Return human-readable information about the instruction sets
+ * supported by the processor executing this binary
+ *
+ * In contrast to \ref info_features(), which reports the features the binary
+ * was <em>compiled</em> for, this queries the host CPU at runtime.
+ */
+extern MTS_EXPORT_CORE std::string info_host_features();
+
+/** \brief Verify that the host processor supports the instruction sets that
+ * this binary was compiled for
+ *
+ * Throws with a descriptive message when the binary requires an instruction
+ * set (e.g. AVX-512) that the current machine lacks, which turns an eventual
+ * illegal-instruction fault in the packet kernels into an actionable error
+ * at startup. A no-op on architectures without runtime feature detection.
+ */
+extern MTS_EXPORT_CORE void check_host_features();
+
 NAMESPACE_END(util)
 NAMESPACE_END(mitsuba)
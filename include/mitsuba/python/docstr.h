@@ -426,6 +426,16 @@ Parameter ``si``:
 Parameter ``wo``:
     The outgoing direction)doc";
 
+static const char *__doc_mitsuba_BSDF_eval_batch =
+R"doc(Evaluate the BSDF for an arbitrary number of direction pairs given as
+dynamic (SoA) arrays
+
+Unlike eval(), which processes one native-width packet per call, this
+entry point accepts inputs of any length, chunks them into native-
+width packets that are evaluated in parallel across all cores, and
+returns the results as a dynamic array. Only available in the packet
+variants.)doc";
+
 static const char *__doc_mitsuba_BSDF_eval_null_transmission =
 R"doc(Evaluate un-scattered transmission component of the BSDF
 
@@ -494,6 +504,14 @@ Parameter ``si``:
 Parameter ``wo``:
     The outgoing direction)doc";
 
+static const char *__doc_mitsuba_BSDF_pdf_batch =
+R"doc(Compute sampling densities for an arbitrary number of direction pairs
+given as dynamic (SoA) arrays
+
+The inputs are chunked into native-width packets that are evaluated in
+parallel across all cores; the densities come back as a dynamic array.
+Only available in the packet variants.)doc";
+
 static const char *__doc_mitsuba_BSDF_sample =
 R"doc(Importance sample the BSDF model
 
@@ -539,6 +557,15 @@ value: The BSDF value (multiplied by the cosine foreshortening factor
 when a non-delta component is sampled). A zero spectrum indicates that
 sampling failed.)doc";
 
+static const char *__doc_mitsuba_BSDF_sample_batch =
+R"doc(Importance sample the BSDF model for an arbitrary number of
+interactions given as dynamic (SoA) arrays
+
+The inputs are chunked into native-width packets that are sampled in
+parallel across all cores; the resulting sampling records and BSDF
+values come back as dynamic arrays. Only available in the packet
+variants.)doc";
+
 static const char *__doc_mitsuba_BSDF_to_string = R"doc(Return a human-readable representation of the BSDF)doc";
 
 static const char *__doc_mitsuba_Bitmap =
@@ -598,6 +625,37 @@ static const char *__doc_mitsuba_Bitmap_Bitmap_4 = R"doc(Copy constructor (copie
 
 static const char *__doc_mitsuba_Bitmap_Bitmap_5 = R"doc(Move constructor)doc";
 
+static const char *__doc_mitsuba_Bitmap_Compression =
+R"doc(Compression schemes supported by the OpenEXR file format
+
+All schemes are lossless except for B44, B44A, DWAA, and DWAB. The
+``zstd`` codec of OpenEXR 3 is not available in the bundled OpenEXR
+library.)doc";
+
+static const char *__doc_mitsuba_Bitmap_Compression_B44 = R"doc(Lossy 4-by-4 pixel block compression with a fixed rate)doc";
+
+static const char *__doc_mitsuba_Bitmap_Compression_B44A = R"doc(Like B44, but flat fields are compressed more aggressively)doc";
+
+static const char *__doc_mitsuba_Bitmap_Compression_DWAA = R"doc(Lossy DCT-based compression of blocks of 32 scanlines)doc";
+
+static const char *__doc_mitsuba_Bitmap_Compression_DWAB = R"doc(Lossy DCT-based compression of blocks of 256 scanlines)doc";
+
+static const char *__doc_mitsuba_Bitmap_Compression_Default =
+R"doc(Default behavior: wavelet compression (PIZ), or DWAB when a positive
+quality level is specified in write())doc";
+
+static const char *__doc_mitsuba_Bitmap_Compression_None = R"doc(Store the pixel data without compression)doc";
+
+static const char *__doc_mitsuba_Bitmap_Compression_PIZ = R"doc(Wavelet compression with Huffman encoding)doc";
+
+static const char *__doc_mitsuba_Bitmap_Compression_PXR24 = R"doc(Lossy 24-bit float conversion followed by ZLIB compression)doc";
+
+static const char *__doc_mitsuba_Bitmap_Compression_RLE = R"doc(Run-length encoding)doc";
+
+static const char *__doc_mitsuba_Bitmap_Compression_ZIP = R"doc(ZLIB compression of blocks of 16 scanlines)doc";
+
+static const char *__doc_mitsuba_Bitmap_Compression_ZIPS = R"doc(ZLIB compression of individual scanlines)doc";
+
 static const char *__doc_mitsuba_Bitmap_FileFormat = R"doc(Supported image file formats)doc";
 
 static const char *__doc_mitsuba_Bitmap_FileFormat_Auto =
@@ -981,7 +1039,14 @@ default argument (-1) uses the highest quality (100).
 with higher values corresponding to a lower quality. A value of 45 is
 recommended as the default for lossy compression. The default argument
 (-1) causes the implementation to switch to the lossless PIZ
-compressor.)doc";
+compressor.
+
+Parameter ``compression``:
+    OpenEXR images: selects a specific compression scheme (see
+    Compression). The default argument preserves the behavior described
+    under ``quality`` above; explicitly selecting Compression::DWAA or
+    Compression::DWAB uses ``quality`` as the DWA compression level (45
+    unless specified). Ignored by the other file formats.)doc";
 
 static const char *__doc_mitsuba_Bitmap_write_2 =
 R"doc(Write an encoded form of the bitmap to a file using the specified file
@@ -1009,7 +1074,14 @@ default argument (-1) uses the highest quality (100).
 with higher values corresponding to a lower quality. A value of 45 is
 recommended as the default for lossy compression. The default argument
 (-1) causes the implementation to switch to the lossless PIZ
-compressor.)doc";
+compressor.
+
+Parameter ``compression``:
+    OpenEXR images: selects a specific compression scheme (see
+    Compression). The default argument preserves the behavior described
+    under ``quality`` above; explicitly selecting Compression::DWAA or
+    Compression::DWAB uses ``quality`` as the DWA compression level (45
+    unless specified). Ignored by the other file formats.)doc";
 
 static const char *__doc_mitsuba_Bitmap_write_async =
 R"doc(Equivalent to write(), but executes asynchronously on a different
@@ -1669,6 +1741,18 @@ static const char *__doc_mitsuba_DiscreteDistribution_sum = R"doc(Return the ori
 
 static const char *__doc_mitsuba_DiscreteDistribution_update = R"doc(Update the internal state. Must be invoked when changing the pmf.)doc";
 
+static const char *__doc_mitsuba_DiscreteDistribution_update_2 =
+R"doc(Partially update the internal state after changing a subrange of PMF
+entries
+
+Repairs the prefix sum over the half-open index range ``[begin, end)``
+and shifts the unchanged suffix by the resulting difference rather
+than re-accumulating the entire table, which turns localized edits
+(e.g. adjusting the emission of a few primitives interactively) into
+work proportional to the touched range plus one addition per suffix
+entry. Note that the alias table is a global structure and is rebuilt
+from scratch when alias-based sampling is enabled.)doc";
+
 static const char *__doc_mitsuba_Distribution2D = R"doc(Base class of Hierarchical2D and Marginal2D with common functionality)doc";
 
 static const char *__doc_mitsuba_Distribution2D_Distribution2D = R"doc()doc";
@@ -2478,6 +2562,14 @@ static const char *__doc_mitsuba_ImageBlock_data = R"doc(Return the underlying p
 
 static const char *__doc_mitsuba_ImageBlock_data_2 = R"doc(Return the underlying pixel buffer (const version))doc";
 
+static const char *__doc_mitsuba_ImageBlock_error_estimate =
+R"doc(Return the maximum relative per-pixel error of the block contents
+
+Computes, for every pixel with at least two samples, the relative
+standard error of the luminance mean, and returns the maximum over the
+block. Only available when variance tracking is enabled, and currently
+unsupported in GPU modes.)doc";
+
 static const char *__doc_mitsuba_ImageBlock_height = R"doc(Return the bitmap's height in pixels)doc";
 
 static const char *__doc_mitsuba_ImageBlock_m_border_size = R"doc()doc";
@@ -2560,6 +2652,15 @@ instance.)doc";
 
 static const char *__doc_mitsuba_ImageBlock_set_size = R"doc(Set the block size. This potentially destroys the block's content.)doc";
 
+static const char *__doc_mitsuba_ImageBlock_set_track_variance =
+R"doc(Track per-pixel luminance statistics alongside the main channels?
+
+When enabled, put() additionally accumulates the luminance, squared
+luminance, and sample count of each sample into a separate per-pixel
+buffer (using nearest-pixel binning, i.e. unaffected by the
+reconstruction filter). This information is used by adaptive sampling
+to decide which blocks warrant additional passes.)doc";
+
 static const char *__doc_mitsuba_ImageBlock_set_warn_invalid = R"doc(Warn when writing invalid (NaN, +/- infinity) sample values?)doc";
 
 static const char *__doc_mitsuba_ImageBlock_set_warn_negative = R"doc(Warn when writing negative sample values?)doc";
@@ -2568,6 +2669,8 @@ static const char *__doc_mitsuba_ImageBlock_size = R"doc(Return the current bloc
 
 static const char *__doc_mitsuba_ImageBlock_to_string = R"doc(//! @})doc";
 
+static const char *__doc_mitsuba_ImageBlock_track_variance = R"doc(Is per-pixel variance tracking enabled?)doc";
+
 static const char *__doc_mitsuba_ImageBlock_warn_invalid = R"doc(Warn when writing invalid (NaN, +/- infinity) sample values?)doc";
 
 static const char *__doc_mitsuba_ImageBlock_warn_negative = R"doc(Warn when writing negative sample values?)doc";
@@ -2608,6 +2711,41 @@ static const char *__doc_mitsuba_Integrator_class = R"doc()doc";
 
 static const char *__doc_mitsuba_Integrator_render = R"doc(Perform the main rendering job. Returns ``True`` upon success)doc";
 
+static const char *__doc_mitsuba_Integrator_render_async =
+R"doc(Launch the main rendering job on a background thread
+
+Returns an AsyncRenderJob handle immediately, leaving the interpreter
+free while the render proceeds. An optional ``progress_callback`` is
+invoked from the render thread with the current progress in [0, 1] and
+a formatted ETA string.)doc";
+
+static const char *__doc_mitsuba_AsyncRenderJob =
+R"doc(Handle to a rendering job running on a background thread
+
+Returned by ``Integrator.render_async()``. The job can be polled,
+waited upon, or canceled, and the partially rendered film can be
+developed mid-render for live preview purposes.)doc";
+
+static const char *__doc_mitsuba_AsyncRenderJob_wait =
+R"doc(Wait until the job has finished, or for at most ``timeout`` seconds
+when a non-negative value is given. Returns whether the job has
+finished.)doc";
+
+static const char *__doc_mitsuba_AsyncRenderJob_done = R"doc(Has the rendering job finished (successfully or not)?)doc";
+
+static const char *__doc_mitsuba_AsyncRenderJob_result =
+R"doc(Return the value of ``render()`` -- only valid once the job has
+finished. Exceptions raised during the render are re-raised here.)doc";
+
+static const char *__doc_mitsuba_AsyncRenderJob_cancel = R"doc(Request that the render winds down at the next opportunity)doc";
+
+static const char *__doc_mitsuba_AsyncRenderJob_film_snapshot =
+R"doc(Develop a copy of the current film contents
+
+May be invoked while the render is still in progress; blocks that are
+being merged concurrently may only be partially visible in the
+returned bitmap.)doc";
+
 static const char *__doc_mitsuba_Interaction = R"doc(Generic surface interaction data structure)doc";
 
 static const char *__doc_mitsuba_Interaction_Interaction = R"doc()doc";
@@ -3024,6 +3162,24 @@ depend on the wavelength.
 Returns:
     This method returns a pair of (Transmittance, PDF).)doc";
 
+static const char *__doc_mitsuba_Medium_eval_transmittance =
+R"doc(Stochastically estimate the transmittance along a ray segment
+
+Estimates the transmittance over the portion of ``[ray.mint,
+ray.maxt]`` that overlaps the medium. In contrast to repeatedly
+invoking sample_interaction() and accumulating null-collision weights,
+this entry point lets a medium consume the entire segment at once with
+a dedicated estimator. Integrators should prefer it for shadow rays
+whenever has_dedicated_transmittance() is set.
+
+The default implementation performs classic ratio tracking against the
+majorant returned by get_combined_extinction().)doc";
+
+static const char *__doc_mitsuba_Medium_has_dedicated_transmittance =
+R"doc(Returns whether this medium provides a dedicated transmittance
+estimator that integrators should prefer over collision-by-collision
+tracking along shadow rays (see eval_transmittance()))doc";
+
 static const char *__doc_mitsuba_Medium_get_combined_extinction = R"doc(Returns the medium's majorant used for delta tracking)doc";
 
 static const char *__doc_mitsuba_Medium_get_scattering_coefficients =
@@ -3412,6 +3568,11 @@ Normals" by Eric Heitz)doc";
 
 static const char *__doc_mitsuba_MicrofacetDistribution_G = R"doc(Smith's separable shadowing-masking approximation)doc";
 
+static const char *__doc_mitsuba_MicrofacetDistribution_G_batch =
+R"doc(Batched version of G() for arbitrary-length dynamic (SoA) inputs,
+evaluated in parallel across all cores with the GIL released. Only
+available in the packet variants.)doc";
+
 static const char *__doc_mitsuba_MicrofacetDistribution_MicrofacetDistribution =
 R"doc(Create an isotropic microfacet distribution of the specified type
 
@@ -3449,6 +3610,11 @@ R"doc(Evaluate the microfacet distribution function
 Parameter ``m``:
     The microfacet normal)doc";
 
+static const char *__doc_mitsuba_MicrofacetDistribution_eval_batch =
+R"doc(Batched version of eval() for arbitrary-length dynamic (SoA) inputs,
+evaluated in parallel across all cores with the GIL released. Only
+available in the packet variants.)doc";
+
 static const char *__doc_mitsuba_MicrofacetDistribution_is_anisotropic = R"doc(Is this an anisotropic microfacet distribution?)doc";
 
 static const char *__doc_mitsuba_MicrofacetDistribution_is_isotropic = R"doc(Is this an isotropic microfacet distribution?)doc";
@@ -3471,6 +3637,11 @@ Parameter ``wi``:
 Parameter ``m``:
     The microfacet normal)doc";
 
+static const char *__doc_mitsuba_MicrofacetDistribution_pdf_batch =
+R"doc(Batched version of pdf() for arbitrary-length dynamic (SoA) inputs,
+evaluated in parallel across all cores with the GIL released. Only
+available in the packet variants.)doc";
+
 static const char *__doc_mitsuba_MicrofacetDistribution_project_roughness_2 = R"doc(Compute the squared 1D roughness along direction ``v``)doc";
 
 static const char *__doc_mitsuba_MicrofacetDistribution_sample =
@@ -3483,6 +3654,11 @@ Parameter ``sample``:
 Parameter ``pdf``:
     The probability density wrt. solid angles)doc";
 
+static const char *__doc_mitsuba_MicrofacetDistribution_sample_batch =
+R"doc(Batched version of sample() for arbitrary-length dynamic (SoA) inputs,
+evaluated in parallel across all cores with the GIL released. Only
+available in the packet variants.)doc";
+
 static const char *__doc_mitsuba_MicrofacetDistribution_sample_visible = R"doc(Return whether or not only visible normals are sampled?)doc";
 
 static const char *__doc_mitsuba_MicrofacetDistribution_sample_visible_11 = R"doc(Visible normal sampling code for the alpha=1 case)doc";
@@ -3498,6 +3674,11 @@ Parameter ``v``:
 Parameter ``m``:
     The microfacet normal)doc";
 
+static const char *__doc_mitsuba_MicrofacetDistribution_smith_g1_batch =
+R"doc(Batched version of smith_g1() for arbitrary-length dynamic (SoA)
+inputs, evaluated in parallel across all cores with the GIL released.
+Only available in the packet variants.)doc";
+
 static const char *__doc_mitsuba_MicrofacetDistribution_type = R"doc(Return the distribution type)doc";
 
 static const char *__doc_mitsuba_MicrofacetType = R"doc(Supported normal distribution functions)doc";
@@ -3904,6 +4085,15 @@ static const char *__doc_mitsuba_PositionSample_p = R"doc(Sampled position)doc";
 
 static const char *__doc_mitsuba_PositionSample_pdf = R"doc(Probability density at the sample)doc";
 
+static const char *__doc_mitsuba_PositionSample_prim_index =
+R"doc(Optional: index of the primitive (e.g. the mesh face) on which the
+sampled position lies
+
+Sampling techniques whose density is not uniform over the underlying
+shape (such as the luminance-weighted sampling of textured area
+emitters) require this information to evaluate the density of a
+position obtained by other means, e.g. via standard ray tracing.)doc";
+
 static const char *__doc_mitsuba_PositionSample_time = R"doc(Associated time value)doc";
 
 static const char *__doc_mitsuba_PositionSample_uv =
@@ -4614,6 +4804,14 @@ static const char *__doc_mitsuba_Sampler_3 = R"doc()doc";
 
 static const char *__doc_mitsuba_Sampler_Sampler = R"doc()doc";
 
+static const char *__doc_mitsuba_Sampler_advance =
+R"doc(Advance to the next sample
+
+Stateless pseudorandom samplers ignore this call. Stateful low-
+discrepancy samplers use it to increment their sample index and rewind
+the dimension counter, so it must be invoked exactly once per pixel
+sample. The default implementation does nothing.)doc";
+
 static const char *__doc_mitsuba_Sampler_class = R"doc()doc";
 
 static const char *__doc_mitsuba_Sampler_clone =
@@ -4686,6 +4884,22 @@ Specified in seconds. A negative values indicates no timeout.)doc";
 
 static const char *__doc_mitsuba_SamplingIntegrator_render = R"doc(//! @{ \name Integrator interface implementation)doc";
 
+static const char *__doc_mitsuba_SamplingIntegrator_set_preview_callback =
+R"doc(Install a callback that receives developed preview tiles
+
+When a callback is registered, render() prepends a preview pass that
+covers the entire frame at one sample per pixel using enlarged blocks
+and delivers every finished tile immediately, so that a viewer can
+display a complete (if noisy) image long before the full sample budget
+is spent. The regular and adaptive passes then refine the image as
+usual and re-deliver the affected tiles as they complete.
+
+The callback receives the tile's offset within the film, its developed
+RGBA contents, and a pass index (0 for the initial preview pass,
+increasing values for refinements). It may be invoked concurrently
+from multiple worker threads and must be thread-safe. Only supported
+in the CPU rendering modes and for integrators without AOVs.)doc";
+
 static const char *__doc_mitsuba_SamplingIntegrator_render_block = R"doc()doc";
 
 static const char *__doc_mitsuba_SamplingIntegrator_render_sample = R"doc()doc";
@@ -4726,6 +4940,36 @@ Remark:
     argument as an additional return value. In other words: `` (spec,
     mask, aov) = integrator.sample(scene, sampler, ray, active) ``)doc";
 
+static const char *__doc_mitsuba_SamplingIntegrator_sample_adjoint =
+R"doc(Propagate adjoint radiance along a ray (differentiable rendering)
+
+Differentiation-aware integrators (such as the ``rb`` plugin) override
+this method to implement the second phase of radiative
+backpropagation: given the gradient of the objective with respect to
+the radiance estimate of a camera sample (the ``adjoint`` parameter),
+they trace a path starting at ``ray`` and scatter this gradient
+towards the differentiable scene parameters encountered along the
+way. This avoids recording a transcript of the full forward
+computation, whose size would grow with the sample count.
+
+The default implementation throws an exception.
+
+Parameter ``scene``:
+    The underlying scene in which gradients should be propagated
+
+Parameter ``sampler``:
+    A source of (pseudo-/quasi-) random numbers
+
+Parameter ``ray``:
+    A ray, optionally with differentials
+
+Parameter ``adjoint``:
+    Gradient of the objective with respect to the radiance estimate
+    associated with this camera sample
+
+Parameter ``active``:
+    A mask that indicates which SIMD lanes are active)doc";
+
 static const char *__doc_mitsuba_SamplingIntegrator_should_stop =
 R"doc(Indicates whether cancel() or a timeout have occured. Should be
 checked regularly in the integrator's main loop so that timeouts are
@@ -4808,6 +5052,15 @@ Returns:
     A detailed surface interaction record. Query its ``is_valid()``
     method to determine whether an intersection was actually found.)doc";
 
+static const char *__doc_mitsuba_Scene_ray_intersect_batch =
+R"doc(Intersect an arbitrary number of rays given as dynamic (SoA) arrays
+
+Unlike ray_intersect(), which processes one native-width packet per
+call, this entry point accepts dynamic ray arrays of any length,
+chunks them into native-width packets that are traced in parallel
+across all cores, and returns the resulting surface interaction
+fields as dynamic arrays. Only available in the packet variants.)doc";
+
 static const char *__doc_mitsuba_Scene_ray_intersect_cpu = R"doc(Trace a ray)doc";
 
 static const char *__doc_mitsuba_Scene_ray_intersect_gpu = R"doc()doc";
@@ -4837,6 +5090,15 @@ Parameter ``ray``:
 Returns:
     ``True`` if an intersection was found)doc";
 
+static const char *__doc_mitsuba_Scene_ray_test_batch =
+R"doc(Occlusion-test an arbitrary number of rays given as dynamic (SoA)
+arrays
+
+The counterpart of ray_intersect_batch() for shadow/visibility
+queries; chunks the input into native-width packets traced in
+parallel and returns a dynamic mask. Only available in the packet
+variants.)doc";
+
 static const char *__doc_mitsuba_Scene_ray_test_cpu = R"doc(Trace a shadow ray)doc";
 
 static const char *__doc_mitsuba_Scene_ray_test_gpu = R"doc()doc";
@@ -6822,6 +7084,71 @@ static const char *__doc_mitsuba_Thread_unregister_external_thread = R"doc(Unreg
 
 static const char *__doc_mitsuba_Thread_yield = R"doc(Yield to another processor)doc";
 
+static const char *__doc_mitsuba_TiledBitmapWriter =
+R"doc(Incremental writer for tiled OpenEXR images
+
+This class exposes the tiled mode of the OpenEXR file format: the
+image is created up front with a fixed tile size, after which finished
+tiles can be submitted in arbitrary order and immediately released
+from memory. This makes it possible to write images that are
+considerably larger than the available amount of RAM, e.g. when
+rendering very high-resolution output with the block-based rendering
+mode of SamplingIntegrator.
+
+Calls to put() are serialized internally, hence finished tiles may be
+submitted concurrently from multiple threads.)doc";
+
+static const char *__doc_mitsuba_TiledBitmapWriter_TiledBitmapWriter =
+R"doc(Create a tiled OpenEXR image at the given location
+
+Parameter ``path``:
+    Destination file name (the extension should be ".exr")
+
+Parameter ``size``:
+    Total size of the image in pixels
+
+Parameter ``tile_size``:
+    Side length of the square tiles, which must evenly partition the
+    image except possibly at its right and bottom edges
+
+Parameter ``fields``:
+    Structure describing the pixel layout. The field names become EXR
+    channel names, and the field types (which must be ``Float16``,
+    ``Float32``, or ``UInt32``) determine the stored representation.
+
+Parameter ``compression``:
+    Compression scheme applied to the tiles (see Bitmap::Compression).
+    The default argument selects the lossless PIZ compressor.)doc";
+
+static const char *__doc_mitsuba_TiledBitmapWriter_class = R"doc()doc";
+
+static const char *__doc_mitsuba_TiledBitmapWriter_close =
+R"doc(Finalize the image and close the underlying file
+
+This is called automatically when the instance is destructed; further
+put() calls will raise an exception.)doc";
+
+static const char *__doc_mitsuba_TiledBitmapWriter_m_data = R"doc()doc";
+
+static const char *__doc_mitsuba_TiledBitmapWriter_m_size = R"doc()doc";
+
+static const char *__doc_mitsuba_TiledBitmapWriter_m_struct = R"doc()doc";
+
+static const char *__doc_mitsuba_TiledBitmapWriter_m_tile_size = R"doc()doc";
+
+static const char *__doc_mitsuba_TiledBitmapWriter_put =
+R"doc(Convert and write one finished tile
+
+The given offset must be a multiple of the tile size, and the bitmap
+must exactly cover the corresponding tile of the image (i.e. it is
+smaller than ``tile_size`` only at the right and bottom edges). Its
+pixel layout must match the ``fields`` structure supplied to the
+constructor. Each tile may only be written once.)doc";
+
+static const char *__doc_mitsuba_TiledBitmapWriter_size = R"doc(Return the total size of the image in pixels)doc";
+
+static const char *__doc_mitsuba_TiledBitmapWriter_tile_size = R"doc(Return the side length of the square tiles)doc";
+
 static const char *__doc_mitsuba_Timer = R"doc()doc";
 
 static const char *__doc_mitsuba_Timer_Timer = R"doc()doc";
@@ -7085,6 +7412,8 @@ static const char *__doc_mitsuba_ZStream_EStreamType_EDeflateStream = R"doc(< A
 
 static const char *__doc_mitsuba_ZStream_EStreamType_EGZipStream = R"doc(< A gzip-compatible stream)doc";
 
+static const char *__doc_mitsuba_ZStream_EStreamType_EZstdStream = R"doc(< A zstd stream (requires MTS_ENABLE_ZSTD))doc";
+
 static const char *__doc_mitsuba_ZStream_ZStream =
 R"doc(Creates a new compression stream with the given underlying stream.
 This new instance takes ownership of the child stream. The child
@@ -9084,6 +9413,19 @@ R"doc(Turn a spectrum into a Mueller matrix representation that only has a
 non-zero (1,1) entry. For all non-polarized modes, this is the
 identity function.)doc";
 
+static const char *__doc_mitsuba_util_advise_huge_pages =
+R"doc(Advise the kernel to back an allocation with transparent huge pages
+
+Large data structures (multi-gigabyte kd-trees, films, vertex buffers)
+span millions of standard 4 KiB pages, and random accesses during
+rendering then compete for the limited number of TLB entries. Backing
+them with 2 MiB huge pages removes most of this pressure.
+
+The given range is rounded inwards to page boundaries; the call is a
+no-op when the remainder spans less than one huge page or when the
+platform lacks the facility (non-Linux). Failures are ignored, as the
+advice is purely an optimization hint.)doc";
+
 static const char *__doc_mitsuba_util_core_count = R"doc(Determine the number of available CPU cores (including virtual cores))doc";
 
 static const char *__doc_mitsuba_util_detect_debugger = R"doc(Returns 'true' if the application is running inside a debugger)doc";
@@ -9098,6 +9440,10 @@ static const char *__doc_mitsuba_util_library_path = R"doc(Return the absolute p
 
 static const char *__doc_mitsuba_util_mem_string = R"doc(Turn a memory size into a human-readable string)doc";
 
+static const char *__doc_mitsuba_util_memory_usage_string =
+R"doc(Return a human-readable table listing the current and peak memory
+usage of every subsystem registered via track_memory())doc";
+
 static const char *__doc_mitsuba_util_terminal_width = R"doc(Determine the width of the terminal window that is used to run Mitsuba)doc";
 
 static const char *__doc_mitsuba_util_time_string =
@@ -9110,10 +9456,22 @@ Parameter ``precise``:
     When set to true, a higher-precision string representation is
     generated.)doc";
 
+static const char *__doc_mitsuba_util_track_memory =
+R"doc(Record a large allocation in the central memory registry
+
+The registry tracks the current and peak number of bytes held by each
+subsystem (mesh geometry, kd-tree, film storage, memory-mapped files,
+...), which makes it possible to determine which data structure is
+responsible for the application's memory footprint (see
+memory_usage_string()). Each update locks a mutex, hence only
+allocations on the order of megabytes should be tracked.)doc";
+
 static const char *__doc_mitsuba_util_trap_debugger =
 R"doc(Generate a trap instruction if running in a debugger; otherwise,
 return.)doc";
 
+static const char *__doc_mitsuba_util_untrack_memory = R"doc(Undo a track_memory() call when the allocation is released)doc";
+
 static const char *__doc_mitsuba_variant = R"doc()doc";
 
 static const char *__doc_mitsuba_variant_data = R"doc()doc";
@@ -393,6 +393,35 @@ public:
                       const Vector3f &wo,
                       Mask active = true) const = 0;
 
+    /**
+     * \brief Jointly evaluate the BSDF and the probability per unit solid
+     * angle of sampling the given direction
+     *
+     * Multiple importance sampling requires both \ref eval() and \ref pdf()
+     * for the same pair of directions; for microfacet-type materials, the
+     * two computations share the half-vector, normal distribution, and
+     * shadow-masking terms. This entry point lets implementations compute
+     * the pair in one pass. The results are identical to calling \ref
+     * eval() and \ref pdf() separately, which is also what the default
+     * implementation does.
+     *
+     * \param ctx
+     *     A context data structure describing which lobes to evalute,
+     *     and whether radiance or importance are being transported.
+     *
+     * \param si
+     *     A surface interaction data structure describing the underlying
+     *     surface position. The incident direction is obtained from
+     *     the field <tt>si.wi</tt>.
+     *
+     * \param wo
+     *     The outgoing direction
+     */
+    virtual std::pair<Spectrum, Float> eval_pdf(const BSDFContext &ctx,
+                                                const SurfaceInteraction3f &si,
+                                                const Vector3f &wo,
+                                                Mask active = true) const;
+
     /**
      * \brief Evaluate un-scattered transmission component of the BSDF
      *
@@ -523,6 +552,7 @@ ENOKI_CALL_SUPPORT_TEMPLATE_BEGIN(mitsuba::BSDF)
     ENOKI_CALL_SUPPORT_METHOD(eval)
     ENOKI_CALL_SUPPORT_METHOD(eval_null_transmission)
     ENOKI_CALL_SUPPORT_METHOD(pdf)
+    ENOKI_CALL_SUPPORT_METHOD(eval_pdf)
     ENOKI_CALL_SUPPORT_GETTER(flags, m_flags)
 
     auto needs_differentials() const {
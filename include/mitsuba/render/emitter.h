@@ -70,6 +70,17 @@ public:
     /// Flags for all components combined.
     uint32_t flags(mask_t<Float> /*active*/ = true) const { return m_flags; }
 
+    /**
+     * \brief Return an estimate of this emitter's total radiant power (in
+     * arbitrary but mutually consistent units)
+     *
+     * The estimate drives the relative selection probabilities within the
+     * light hierarchy underlying \ref Scene::sample_emitter_direction().
+     * The default implementation returns 1, which corresponds to uniform
+     * emitter selection.
+     */
+    virtual scalar_t<Float> power_estimate() const;
+
 
     ENOKI_CALL_SUPPORT_FRIEND()
     MTS_DECLARE_CLASS()
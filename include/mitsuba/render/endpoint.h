@@ -130,6 +130,32 @@ public:
                                 const DirectionSample3f &ds,
                                 Mask active = true) const;
 
+    /**
+     * \brief Evaluate the probability density of the ray sampling method
+     * implemented by \ref sample_ray()
+     *
+     * The returned densities are needed by bidirectional techniques, which
+     * must be able to re-evaluate the density of paths that were generated
+     * by another sampling strategy. The default implementation throws an
+     * exception.
+     *
+     * \param ray
+     *    A ray whose origin lies on the endpoint
+     *
+     * \param n
+     *    The surface normal of the endpoint at the ray origin (only
+     *    relevant for endpoints attached to a surface)
+     *
+     * \return
+     *    The density of sampling the ray origin (expressed in the area
+     *    measure, or as a discrete probability for endpoints without spatial
+     *    extent) and the density of sampling the ray direction given the
+     *    origin (expressed in the solid angle measure)
+     */
+    virtual std::pair<Float, Float> pdf_ray(const Ray3f &ray,
+                                            const Vector3f &n,
+                                            Mask active = true) const;
+
     //! @}
     // =============================================================
 
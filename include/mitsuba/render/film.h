@@ -7,6 +7,7 @@
 #include <mitsuba/core/vector.h>
 #include <mitsuba/render/sampler.h>
 #include <mitsuba/render/fwd.h>
+#include <functional>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -28,6 +29,83 @@ public:
     /// Merge an image block into the film
     virtual void put(const ImageBlock *block) = 0;
 
+    /**
+     * \brief Splat a sample into the film, bypassing the per-thread image
+     * blocks
+     *
+     * Light transport techniques that trace paths starting from the emitters
+     * (e.g. the light-tracing strategies of a bidirectional path tracer)
+     * produce contributions at arbitrary film positions, which cannot be
+     * routed through the image block owned by the current worker thread.
+     * Films supporting such techniques accumulate these samples into a
+     * separate film-sized buffer using atomic additions (see \ref
+     * ImageBlock::set_atomic()) and add it to the developed image, scaled by
+     * the factor given to \ref set_splat_scale(). The default implementation
+     * throws an exception.
+     *
+     * \param pos
+     *    Sample position in fractional pixel coordinates
+     *
+     * \param wavelengths
+     *    Sample wavelengths in nanometers
+     *
+     * \param value
+     *    Sample value associated with the specified wavelengths
+     */
+    virtual void put_splat(const Point2f &pos,
+                           const Wavelength &wavelengths,
+                           const Spectrum &value,
+                           Mask active = true) const;
+
+    /**
+     * \brief Set the factor applied to splatted contributions when the film
+     * is developed (typically the reciprocal of the sample count)
+     */
+    virtual void set_splat_scale(ScalarFloat scale);
+
+    /**
+     * \brief Append one unfiltered sample record per active SIMD lane to
+     * the film's sample stream
+     *
+     * Films can optionally record the raw per-sample stream whose filtered
+     * sums they normally accumulate, so that reconstruction filtering,
+     * exposure, or deep-compositing decisions can be revisited after the
+     * render without tracing any new paths (see the \c sample_stream
+     * parameter of the \c hdrfilm plugin). The default implementation
+     * discards the samples.
+     *
+     * \param pos
+     *    Sample position in fractional pixel coordinates
+     *
+     * \param values
+     *    One entry per film channel (see \ref prepare())
+     */
+    virtual void put_sample(const Point2f &pos, const Float *values,
+                            Mask active = true) const;
+
+    /// Does this film record a per-sample stream? (see \ref put_sample())
+    virtual bool has_sample_stream() const;
+
+    /**
+     * \brief Reset a rectangular region of the film to an unrendered state
+     *
+     * Zeroes the accumulated sample sums (including the sample weights) of
+     * all pixels inside the given rectangle, so that the region can
+     * subsequently be re-rendered and merged via \ref put() without mixing
+     * in stale contributions. Used by \ref
+     * SamplingIntegrator::render_region() for incremental re-renders after
+     * localized scene edits. The default implementation throws an exception.
+     *
+     * \param offset
+     *    Top-left corner of the region, in the same overall pixel
+     *    coordinates used by the image blocks passed to \ref put()
+     *
+     * \param size
+     *    Extents of the region (in pixels); must lie within the crop window
+     */
+    virtual void clear_region(const ScalarPoint2i &offset,
+                              const ScalarVector2i &size);
+
     /// Develop the film and write the result to the previously specified filename
     virtual void develop() = 0;
 
@@ -87,6 +165,29 @@ public:
     //! @}
     // =============================================================
 
+    // =============================================================
+    //! @{ \name Post-processing stages
+    // =============================================================
+
+    /**
+     * \brief Bitmap-space post-processing stage
+     *
+     * A stage receives the developed image (already converted to the film's
+     * output pixel format) and modifies it in place. Stages are invoked by
+     * \ref develop() in registration order, right before the image is
+     * written to disk. This is e.g. used to run a denoiser over the final
+     * rendering.
+     */
+    using PostProcessStage = std::function<void(Bitmap *)>;
+
+    /// Append a post-processing stage to be applied by \ref develop()
+    void add_post_process(PostProcessStage stage) {
+        m_post_process.push_back(std::move(stage));
+    }
+
+    //! @}
+    // =============================================================
+
     virtual std::string to_string() const override;
 
     MTS_DECLARE_CLASS()
@@ -97,12 +198,19 @@ protected:
     /// Virtual destructor
     virtual ~Film();
 
+    /// Run all registered post-processing stages on a developed image
+    void run_post_process(Bitmap *bitmap) const {
+        for (auto &stage : m_post_process)
+            stage(bitmap);
+    }
+
 protected:
     ScalarVector2i m_size;
     ScalarVector2i m_crop_size;
     ScalarPoint2i m_crop_offset;
     bool m_high_quality_edges;
     ref<ReconstructionFilter> m_filter;
+    std::vector<PostProcessStage> m_post_process;
 };
 
 MTS_EXTERN_CLASS_RENDER(Film)
@@ -8,6 +8,8 @@
 NAMESPACE_BEGIN(mitsuba)
 
 class DifferentiableParameters;
+class RayStreamRecorder;
+class RayStreamReader;
 struct BSDFContext;
 template <typename Float, typename Spectrum> class BSDF;
 template <typename Float, typename Spectrum> class Emitter;
@@ -17,6 +19,7 @@ template <typename Float, typename Spectrum> class ImageBlock;
 template <typename Float, typename Spectrum> class Integrator;
 template <typename Float, typename Spectrum> class SamplingIntegrator;
 template <typename Float, typename Spectrum> class MonteCarloIntegrator;
+template <typename Float, typename Spectrum> class WavefrontIntegrator;
 template <typename Float, typename Spectrum> class Medium;
 template <typename Float, typename Spectrum> class Mesh;
 template <typename Float, typename Spectrum> class MicrofacetDistribution;
@@ -28,6 +31,8 @@ template <typename Float, typename Spectrum> class PhaseFunction;
 template <typename Float, typename Spectrum> class ProjectiveCamera;
 template <typename Float, typename Spectrum> class Shape;
 template <typename Float, typename Spectrum> class ShapeKDTree;
+template <typename Float, typename Spectrum> class LightBVH;
+template <typename Float, typename Spectrum> class VisibilityCache;
 template <typename Float, typename Spectrum> class Texture;
 template <typename Float, typename Spectrum> class Volume;
 
@@ -39,6 +44,8 @@ template <typename Float, typename Spectrum> struct MediumInteraction;
 template <typename Float, typename Spectrum> struct BSDFSample3;
 template <typename Float, typename Spectrum> struct PhaseFunctionContext;
 
+template <typename Record> class SoARecordBuffer;
+
 
 template <typename Float_, typename Spectrum_> struct RenderAliases {
     using Float                  = Float_;
@@ -74,6 +81,7 @@ template <typename Float_, typename Spectrum_> struct RenderAliases {
     using Integrator             = mitsuba::Integrator<FloatU, SpectrumU>;
     using SamplingIntegrator     = mitsuba::SamplingIntegrator<FloatU, SpectrumU>;
     using MonteCarloIntegrator   = mitsuba::MonteCarloIntegrator<FloatU, SpectrumU>;
+    using WavefrontIntegrator    = mitsuba::WavefrontIntegrator<FloatU, SpectrumU>;
     using BSDF                   = mitsuba::BSDF<FloatU, SpectrumU>;
     using Sensor                 = mitsuba::Sensor<FloatU, SpectrumU>;
     using ProjectiveCamera       = mitsuba::ProjectiveCamera<FloatU, SpectrumU>;
@@ -128,6 +136,7 @@ template <typename Float_, typename Spectrum_> struct RenderAliases {
     using Integrator             = typename RenderAliases::Integrator;                             \
     using SamplingIntegrator     = typename RenderAliases::SamplingIntegrator;                     \
     using MonteCarloIntegrator   = typename RenderAliases::MonteCarloIntegrator;                   \
+    using WavefrontIntegrator    = typename RenderAliases::WavefrontIntegrator;                    \
     using BSDF                   = typename RenderAliases::BSDF;                                   \
     using Sensor                 = typename RenderAliases::Sensor;                                 \
     using ProjectiveCamera       = typename RenderAliases::ProjectiveCamera;                       \
@@ -4,6 +4,8 @@
 #include <mitsuba/core/object.h>
 #include <mitsuba/core/vector.h>
 #include <mitsuba/render/fwd.h>
+#include <tbb/spin_mutex.h>
+#include <memory>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -141,6 +143,187 @@ public:
     /// Clear everything to zero.
     void clear();
 
+    // =============================================================
+    //! @{ \name Atomic cross-block splatting
+    // =============================================================
+
+    /**
+     * \brief Accumulate samples written via \ref put() using atomic additions
+     *
+     * By default, each worker thread splats into a block that it exclusively
+     * owns, and synchronization only takes place when finished blocks are
+     * merged into the film (see \ref put(const ImageBlock *)). Techniques
+     * whose contributions can land anywhere on the film -- such as the
+     * light-tracing connections of a bidirectional path tracer -- instead
+     * share a single film-sized block across all threads. Enabling atomic
+     * mode makes the per-sample \ref put() variants safe for this kind of
+     * concurrent cross-block splatting. Only supported in the CPU rendering
+     * modes.
+     */
+    void set_atomic(bool value);
+
+    /// Are samples accumulated using atomic additions?
+    bool atomic() const { return m_atomic; }
+
+    //! @}
+    // =============================================================
+
+    // =============================================================
+    //! @{ \name Variance tracking
+    // =============================================================
+
+    /**
+     * \brief Track per-pixel luminance statistics alongside the main channels?
+     *
+     * When enabled, \ref put() additionally accumulates the luminance, squared
+     * luminance, and sample count of each sample into a separate per-pixel
+     * buffer (using nearest-pixel binning, i.e. unaffected by the
+     * reconstruction filter). This information is used by adaptive sampling to
+     * decide which blocks warrant additional passes.
+     */
+    void set_track_variance(bool value);
+
+    /// Is per-pixel variance tracking enabled?
+    bool track_variance() const { return m_track_variance; }
+
+    /**
+     * \brief Return the maximum relative per-pixel error of the block contents
+     *
+     * Computes, for every pixel with at least two samples, the relative
+     * standard error of the luminance mean, and returns the maximum over the
+     * block. Only available when variance tracking is enabled, and currently
+     * unsupported in GPU modes.
+     */
+    ScalarFloat error_estimate() const;
+
+    /**
+     * \brief Return the summed sample luminance of the block contents and
+     * the number of contributing samples
+     *
+     * Like \ref error_estimate(), this reads the per-pixel variance
+     * buffers and therefore requires variance tracking; it is currently
+     * unsupported in GPU modes.
+     */
+    std::pair<double, size_t> luminance_accum() const;
+
+    //! @}
+    // =============================================================
+
+    // =============================================================
+    //! @{ \name Outlier-aware accumulation
+    // =============================================================
+
+    /**
+     * \brief Defer extreme "firefly" samples into a secondary buffer?
+     *
+     * When enabled, \ref put() compares each sample's luminance against a
+     * robust per-pixel threshold derived from the streaming statistics
+     * collected by variance tracking (which must also be enabled). Samples
+     * exceeding the threshold are split: the portion up to the threshold is
+     * splatted through the reconstruction filter as usual, while the excess
+     * energy is recorded in a per-pixel residual buffer together with an
+     * outlier count. Call \ref merge_outliers() before merging the block
+     * into the film to re-add the deferred energy with density-based
+     * reweighting. Only supported in the CPU rendering modes.
+     */
+    void set_outlier_rejection(bool value);
+
+    /// Is outlier-aware accumulation enabled?
+    bool outlier_rejection() const { return m_outlier_rejection; }
+
+    /**
+     * \brief Re-merge deferred outlier energy into the main channels
+     *
+     * Each pixel's residual is scaled by <tt>(n - 1) / n</tt>, where
+     * <tt>n</tt> is the number of outlier samples recorded at the pixel:
+     * energy observed by only a single sample -- the classic firefly -- is
+     * rejected outright, while energy confirmed by repeated samples is
+     * almost fully restored. The residual is deposited at the pixel center,
+     * bypassing the reconstruction filter, which is imperceptible at the
+     * involved sample densities. The outlier buffer is cleared afterwards.
+     * Must not run concurrently with \ref put().
+     */
+    void merge_outliers();
+
+    //! @}
+    // =============================================================
+
+    // =============================================================
+    //! @{ \name Channel-planar (structure-of-arrays) storage
+    // =============================================================
+
+    /**
+     * \brief Store each channel in a separate contiguous plane?
+     *
+     * By default, the channels of a pixel are interleaved in memory, which
+     * keeps the footprint of a single sample compact but strides badly when
+     * many AOV channels are enabled: per-channel passes (e.g. the
+     * develop-time format conversion) then touch only a few bytes out of
+     * every pixel record. In planar mode, the buffer instead holds one
+     * contiguous plane per channel, so that each channel of the image can
+     * be streamed sequentially.
+     *
+     * Planar blocks are filled via \ref put(const ImageBlock *) merges,
+     * which deposit each source channel into its plane in one strided
+     * sweep, or via the per-sample \ref put() variants. Use \ref unpack()
+     * to read back the contents in interleaved form. Incompatible with
+     * half-precision channel storage (see \ref set_half_channels()) and
+     * only supported in the CPU rendering modes.
+     */
+    void set_planar(bool value);
+
+    /// Is each channel stored in a separate contiguous plane?
+    bool planar() const { return m_planar; }
+
+    //! @}
+    // =============================================================
+
+    // =============================================================
+    //! @{ \name Half-precision channel storage
+    // =============================================================
+
+    /**
+     * \brief Store the flagged channels in half precision (float16)
+     *
+     * Films with many AOV channels at high resolutions are dominated by the
+     * memory footprint of the accumulation buffer, although most auxiliary
+     * channels (positions, normals, UVs) don't benefit from full single
+     * precision. This function switches the flagged channels of the block to
+     * a packed float16 representation, halving their storage cost.
+     *
+     * Sample accumulation continues to take place in single precision within
+     * the (small) per-thread render blocks; rounding to half precision only
+     * happens when a finished block is merged via \ref put(const
+     * ImageBlock *), which bounds the error to one rounding step per merge.
+     * Consequently, a block with half-precision channels can only be filled
+     * through block merges -- the per-sample \ref put() variants and \ref
+     * data() are unavailable, and the contents must be read back using \ref
+     * unpack(). Only supported in the CPU rendering modes.
+     *
+     * \param half
+     *    Flags denoting the channels to store in half precision; the vector
+     *    must match the length given by \ref channel_count(). Passing a
+     *    vector of zeros restores the default full-precision storage.
+     */
+    void set_half_channels(const std::vector<bool> &half);
+
+    /// Are any channels stored in half precision?
+    bool has_half_channels() const { return (bool) m_packed; }
+
+    /**
+     * \brief Expand the packed mixed-precision or channel-planar contents
+     * into an interleaved single-precision buffer with \ref channel_count()
+     * entries per pixel
+     *
+     * Only relevant when half-precision channels (see \ref
+     * set_half_channels()) or planar storage (see \ref set_planar()) are
+     * enabled.
+     */
+    void unpack(ScalarFloat *target) const;
+
+    //! @}
+    // =============================================================
+
     // =============================================================
     //! @{ \name Accesors
     // =============================================================
@@ -200,17 +383,59 @@ public:
 protected:
     /// Virtual destructor
     virtual ~ImageBlock();
+
+    /// Re-register the storage buffers with the memory registry
+    void update_memory_tracking();
+
+    /**
+     * \brief Filtered splatting kernel used by \ref put()
+     *
+     * When \c N is nonzero, the reconstruction filter footprint covers a
+     * compile-time constant \c N x \c N pixel region, and the weight and
+     * deposition loops are fully unrolled. \c N == 0 selects the generic
+     * fallback with runtime loop bounds. The appropriate instantiation is
+     * chosen once at construction time based on the filter radius (see
+     * \ref m_filter_taps).
+     */
+    template <uint32_t N>
+    Mask put_filtered(const Point2f &pos, const Float *value, Mask active);
+
+    /// Deposit a single filter tap, atomically if the block is shared (see \ref set_atomic())
+    void deposit(const Float &value, const UInt32 &offset, const Mask &enabled);
 protected:
     ScalarPoint2i m_offset;
     ScalarVector2i m_size;
     uint32_t m_channel_count;
     int m_border_size;
     DynamicBuffer<Float> m_data;
+    /// Luminance, squared luminance & sample count per pixel (3 entries each)
+    DynamicBuffer<Float> m_var_data;
+    /// Deferred outlier energy (XYZ) & outlier count per pixel (4 entries each)
+    DynamicBuffer<Float> m_outlier_data;
+    /// Scratch space holding the soft-clamped sample in \ref put()
+    std::unique_ptr<Float[]> m_outlier_scratch;
+    /// Mixed-precision storage (replaces \ref m_data, see \ref set_half_channels())
+    std::unique_ptr<uint8_t[]> m_packed;
+    /// Per-channel half-precision flags and byte offsets within a pixel record
+    std::vector<bool> m_half_channels;
+    std::vector<uint32_t> m_channel_offset;
+    /// Size of a packed mixed-precision pixel record in bytes
+    uint32_t m_pixel_stride = 0;
+    /// Bytes currently registered with the memory registry
+    size_t m_tracked_bytes = 0;
+    /// Serializes concurrent block merges into the packed representation
+    mutable tbb::spin_mutex m_mutex;
     const ReconstructionFilter *m_filter;
+    /// Number of filter taps per axis, used to select a \ref put_filtered() kernel
+    uint32_t m_filter_taps = 0;
     Float *m_weights_x, *m_weights_y;
     bool m_warn_negative;
     bool m_warn_invalid;
     bool m_normalize;
+    bool m_track_variance;
+    bool m_outlier_rejection = false;
+    bool m_atomic = false;
+    bool m_planar = false;
 };
 
 MTS_EXTERN_CLASS_RENDER(ImageBlock)
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <atomic>
+#include <functional>
+
+#include <mitsuba/core/filesystem.h>
 #include <mitsuba/core/fwd.h>
 #include <mitsuba/core/object.h>
 #include <mitsuba/core/properties.h>
@@ -112,6 +116,61 @@ public:
                                              Float *aovs = nullptr,
                                              Mask active = true) const;
 
+    /**
+     * \brief Variant of \ref sample() that starts from a precomputed first
+     * intersection
+     *
+     * The sorted block mode (see \ref render_block_sorted()) traces all
+     * camera rays of a block in a single batch and hands the resulting
+     * interactions to this function, so that the integrator does not need to
+     * find the first surface again. The default implementation simply
+     * discards \c si and forwards to \ref sample(); integrators should
+     * override it to benefit from the presorted shading order.
+     */
+    virtual std::pair<Spectrum, Mask> sample(const Scene *scene,
+                                             Sampler *sampler,
+                                             const RayDifferential3f &ray,
+                                             const SurfaceInteraction3f &si,
+                                             Float *aovs = nullptr,
+                                             Mask active = true) const;
+
+    /**
+     * \brief Propagate adjoint radiance along a ray (differentiable
+     * rendering)
+     *
+     * Differentiation-aware integrators (such as the \c rb plugin) override
+     * this method to implement the second phase of radiative
+     * backpropagation: given the gradient of the objective with respect to
+     * the radiance estimate of a camera sample (the \c adjoint parameter),
+     * they trace a path starting at \c ray and scatter this gradient towards
+     * the differentiable scene parameters encountered along the way. This
+     * avoids recording a transcript of the full forward computation, whose
+     * size would grow with the sample count.
+     *
+     * The default implementation throws an exception.
+     *
+     * \param scene
+     *    The underlying scene in which gradients should be propagated
+     *
+     * \param sampler
+     *    A source of (pseudo-/quasi-) random numbers
+     *
+     * \param ray
+     *    A ray, optionally with differentials
+     *
+     * \param adjoint
+     *    Gradient of the objective with respect to the radiance estimate
+     *    associated with this camera sample
+     *
+     * \param active
+     *    A mask that indicates which SIMD lanes are active
+     */
+    virtual void sample_adjoint(const Scene *scene,
+                                Sampler *sampler,
+                                const RayDifferential3f &ray,
+                                const Spectrum &adjoint,
+                                Mask active = true) const;
+
     /**
      * For integrators that return one or more arbitrary output variables
      * (AOVs), this function specifies a list of associated channel names. The
@@ -126,6 +185,41 @@ public:
     bool render(Scene *scene, Sensor *sensor) override;
     void cancel() override;
 
+    /**
+     * \brief Incrementally re-render a rectangular film region
+     *
+     * Intended for interactive look-dev: after a localized scene edit (e.g.
+     * a material tweak), only the film pixels inside the user-marked dirty
+     * rectangle need to be recomputed. The affected region is reset via
+     * \ref Film::clear_region() and re-rendered using a region-restricted
+     * block schedule in place of the \ref Spiral, compositing the result
+     * into the existing film; the cost is proportional to the region area
+     * rather than the frame size.
+     *
+     * To account for the reconstruction filter, the cleared region is grown
+     * by the filter border, and one further border of margin samples around
+     * it is re-rendered so that pixels at the edge of the region receive
+     * full filter support. Contributions that margin samples deposit
+     * outside of the cleared region are discarded, since the film already
+     * accounts for them.
+     *
+     * The film must still hold the result of a preceding \ref render() call
+     * with this integrator (in particular, it is not re-prepared). Only
+     * supported in the CPU rendering modes.
+     *
+     * \param offset
+     *    Top-left corner of the dirty rectangle, in the same overall pixel
+     *    coordinates used by \ref Film::crop_offset()
+     *
+     * \param size
+     *    Extents of the dirty rectangle (in pixels)
+     *
+     * \return \c true upon success
+     */
+    bool render_region(Scene *scene, Sensor *sensor,
+                       const ScalarPoint2i &offset,
+                       const ScalarVector2i &size);
+
     /**
      * Indicates whether \ref cancel() or a timeout have occured. Should be
      * checked regularly in the integrator's main loop so that timeouts are
@@ -139,6 +233,97 @@ public:
                           m_render_timer.value() > 1000.f * m_timeout);
     }
 
+    /**
+     * \brief Configure render checkpointing
+     *
+     * Overrides the \c checkpoint and \c resume integrator parameters, e.g.
+     * based on command line arguments.
+     *
+     * \param path
+     *     File that periodic snapshots are written to (ignored when empty)
+     * \param resume
+     *     Continue from the file's contents before rendering, if it exists
+     */
+    void set_checkpoint(const fs::path &path, bool resume) {
+        if (!path.empty())
+            m_checkpoint_path = path;
+        m_resume = resume;
+    }
+
+    /**
+     * \brief Callback type used to deliver developed preview tiles, see
+     * \ref set_preview_callback()
+     *
+     * The arguments are the tile's offset within the film, its developed
+     * RGBA contents, and a pass index (0 for the initial preview pass,
+     * increasing values for refinements). The callback may be invoked
+     * concurrently from multiple worker threads and must be thread-safe.
+     */
+    using PreviewCallback = std::function<void(const ScalarPoint2i &offset,
+                                               const Bitmap *tile,
+                                               size_t pass)>;
+
+    /**
+     * \brief Install a callback that receives developed preview tiles
+     *
+     * When a callback is registered, \ref render() prepends a preview pass
+     * that covers the entire frame at one sample per pixel using enlarged
+     * blocks and delivers every finished tile immediately, so that a viewer
+     * can display a complete (if noisy) image long before the full sample
+     * budget is spent. The regular and adaptive passes then refine the
+     * image as usual and re-deliver the affected tiles as they complete.
+     *
+     * The preview pass adds a single extra sample per pixel on top of the
+     * configured budget; the film's weight normalization blends it in
+     * seamlessly. Only supported in the CPU rendering modes and for
+     * integrators without AOVs.
+     */
+    void set_preview_callback(PreviewCallback callback) {
+        m_preview_callback = std::move(callback);
+    }
+
+#if defined(MTS_ENABLE_DISTRIBUTED)
+    /**
+     * \brief Coordinate a distributed rendering job
+     *
+     * Shards the image blocks produced by the \ref Spiral scheduler across a
+     * pool of worker processes started with <tt>mitsuba --serve</tt> and
+     * merges the (compressed) results into the film, so that a single frame
+     * can occupy multiple machines. Straggling blocks are re-dispatched to
+     * idle workers near the end of the job; block seeds are deterministic,
+     * hence duplicated work yields bit-identical results and the first copy
+     * to arrive wins.
+     *
+     * Workers load the scene themselves from \c scene_file, which must
+     * therefore resolve to the same scene on every machine (e.g. via a
+     * shared file system). They stay resident across jobs, so an animation
+     * pays the scene loading cost only once per node. Only supported in the
+     * CPU rendering modes.
+     *
+     * \param workers
+     *     Worker endpoints, e.g. <tt>tcp://node17:7554</tt> (the
+     *     <tt>tcp://</tt> prefix may be omitted)
+     * \param parameters
+     *     Scene constants, forwarded to the workers (as with \c -D)
+     */
+    bool render_distributed(Scene *scene, Sensor *sensor,
+                            const std::vector<std::string> &workers,
+                            const std::string &scene_file,
+                            const std::vector<std::pair<std::string, std::string>> &parameters,
+                            size_t sensor_index, const std::string &mode);
+
+    /**
+     * \brief Run a worker process serving block rendering requests
+     *
+     * Binds a socket on \c bind_address (e.g. <tt>tcp://*:7554</tt>) and
+     * serves scene setup and block rendering requests issued by \ref
+     * render_distributed() until the process is interrupted. \c mode must
+     * match the variant that the coordinator renders in.
+     */
+    static void serve_blocks(const std::string &bind_address,
+                             const std::string &mode);
+#endif
+
     //! @}
     // =========================================================================
 
@@ -154,6 +339,30 @@ protected:
                               Float *aovs,
                               size_t sample_count = size_t(-1)) const;
 
+    /**
+     * \brief Two-phase (trace-then-shade) implementation of \ref
+     * render_block()
+     *
+     * Used when the \c sort_block parameter is set: all camera rays of the
+     * block are generated and submitted to \ref Scene::ray_intersect_n() as
+     * one coherent stream, and the resulting hits are then distributed into
+     * per-BSDF buckets before shading. In the packet variants, lanes are
+     * additionally regrouped so that every shaded packet invokes a single
+     * BSDF, which removes the incoherent virtual dispatch that otherwise
+     * dominates lane divergence at the first bounce. Shading starts from the
+     * already-known interactions via the \ref sample() overload above.
+     *
+     * Since samples are shaded out of their generation order, this mode
+     * (like the wavefront scheduler) is intended for stateless samplers.
+     */
+    void render_block_sorted(const Scene *scene,
+                             const Sensor *sensor,
+                             Sampler *sampler,
+                             ImageBlock *block,
+                             Float *aovs,
+                             uint32_t sample_count,
+                             ScalarFloat diff_scale_factor) const;
+
     void render_sample(const Scene *scene,
                        const Sensor *sensor,
                        Sampler *sampler,
@@ -163,13 +372,88 @@ protected:
                        ScalarFloat diff_scale_factor,
                        Mask active = true) const;
 
+    /**
+     * \brief Serialize a film snapshot to \ref m_checkpoint_path
+     *
+     * The raw film contents (including the accumulated sample weights) are
+     * written together with the pass counter and the sampler seed offset of
+     * a potential follow-up run. The file is written to a temporary location
+     * and atomically renamed, so that a preemption mid-write cannot clobber
+     * the previous snapshot.
+     */
+    void write_checkpoint(const ScalarVector2i &size, uint32_t channel_count,
+                          const std::vector<ScalarFloat> &data,
+                          size_t passes_done, size_t seed_offset) const;
+
+    /**
+     * \brief Restore a snapshot written by \ref write_checkpoint
+     *
+     * Accumulates the stored contents onto the (freshly prepared) film and
+     * updates \c seed_offset so that the resumed run does not reuse the
+     * random number sequences of its predecessors.
+     *
+     * \return The number of already completed passes
+     */
+    size_t load_checkpoint(Film *film, uint32_t channel_count,
+                           size_t &seed_offset) const;
+
+    /**
+     * \brief Fold the luminance statistics of a completed image block into
+     * the running image-wide mean
+     *
+     * The estimate is fed from the per-pixel variance buffers that blocks
+     * already maintain, so this costs a single atomic update per block. It
+     * drives the efficiency-aware russian roulette of \ref
+     * MonteCarloIntegrator.
+     */
+    void update_luminance_estimate(const ImageBlock *block) const;
+
+    /// Current estimate of the mean sample luminance (0 if nothing rendered yet)
+    ScalarFloat luminance_estimate() const;
+
+    /**
+     * \brief Splat reprojected samples from the temporal cache onto the film
+     *
+     * Projects every first-hit point cached by the previous frame through
+     * the current camera transform, verifies with a primary ray that the
+     * same shape is still visible at (almost) the same depth, and deposits
+     * the cached pixel value at the reprojected film position.
+     *
+     * \return A per-pixel coverage map of the current frame, or an empty
+     *     vector when the cache is missing or incompatible. Blocks whose
+     *     pixels are all covered can skip path sampling entirely.
+     */
+    std::vector<uint8_t> temporal_reproject(const Scene *scene,
+                                            const Sensor *sensor, Film *film);
+
+    /**
+     * \brief Capture the film contents and per-pixel first-hit data for
+     * reuse by the next frame (see \ref m_temporal_reuse)
+     *
+     * The film channels are stored in weight-normalized form, so a
+     * reprojected pixel later re-enters the film as a single unit-weight
+     * sample regardless of how many samples originally produced it.
+     */
+    void temporal_capture(const Scene *scene, const Sensor *sensor,
+                          Film *film);
+
 protected:
     /// Integrators should stop all work when this flag is set to true.
     bool m_stop;
 
+    /// Running sum of sample luminances and number of contributing samples
+    mutable std::atomic<double> m_lum_accum { 0.0 };
+    mutable std::atomic<size_t> m_lum_count { 0 };
+
     /// Size of (square) image blocks to render per core.
     uint32_t m_block_size;
 
+    /// Adapt the block granularity to the image contents via a cheap prepass?
+    bool m_adaptive_block_size;
+
+    /// Trace each block as one ray stream and shade hits sorted by BSDF
+    bool m_sort_block;
+
     /**
      * \brief Number of samples to compute for each pass over the image blocks.
      *
@@ -178,6 +462,20 @@ protected:
      */
     uint32_t m_samples_per_pass;
 
+    /**
+     * \brief Number of sample passes traced between kernel flushes in the
+     * CUDA variants.
+     *
+     * The GPU render loop normally flushes the queued computation after
+     * every pass, which produces many small kernel launches with
+     * synchronization gaps in between on small frames. Values > 1 queue
+     * up several independent passes before each flush, so that enoki
+     * fuses them into one batch of wider launches, at the cost of a
+     * proportionally larger kernel trace and intermediate storage.
+     * Ignored in the CPU variants.
+     */
+    uint32_t m_fuse_passes;
+
     /**
      * \brief Maximum amount of time to spend rendering (excluding scene parsing).
      *
@@ -185,8 +483,88 @@ protected:
      */
     float m_timeout;
 
+    /**
+     * \brief Maximum tolerated relative per-pixel error for adaptive sampling.
+     *
+     * When set to a positive value, image blocks whose estimated relative
+     * pixel error still exceeds this threshold after the regular passes are
+     * re-enqueued for additional sampling passes. Zero (the default) disables
+     * adaptive sampling.
+     */
+    float m_error_threshold;
+
+    /// Upper bound on the number of adaptive refinement passes
+    uint32_t m_max_refinement_passes;
+
+    /**
+     * \brief Defer extreme "firefly" samples during block rendering?
+     *
+     * When enabled, image blocks soft-clamp samples whose luminance is a
+     * statistical outlier with respect to their pixel and re-merge the
+     * deferred energy with density-based reweighting before the block is
+     * accumulated onto the film (see \ref ImageBlock::set_outlier_rejection()).
+     * Disabled by default; only available in the CPU rendering modes.
+     */
+    bool m_outlier_rejection;
+
+    /**
+     * \brief Reuse the previous frame of an animation via temporal
+     * reprojection?
+     *
+     * When enabled, every completed render caches the film contents along
+     * with per-pixel first-hit data (shape pointer, world-space position).
+     * The next render reprojects the cached pixels through the updated
+     * camera transform, accepts them wherever the first-visible shape and
+     * depth still match, and only spends path samples on blocks containing
+     * disoccluded pixels. Intended for playblast-quality previews of
+     * camera animations over otherwise static scene content; the cache is
+     * rebuilt from scratch whenever the film size or channel layout
+     * changes. Disabled by default; only available in the CPU rendering
+     * modes.
+     */
+    bool m_temporal_reuse;
+
+    /// Previous-frame data cached for reuse (see \ref m_temporal_reuse)
+    struct TemporalCache {
+        bool valid = false;
+        ScalarVector2i size = 0;
+        uint32_t channel_count = 0;
+        /// Weight-normalized film channel values of each pixel
+        std::vector<ScalarFloat> values;
+        /// First-hit world-space positions (3 floats per pixel)
+        std::vector<ScalarFloat> positions;
+        /// First-hit shape of each pixel (null: miss or invalid pixel)
+        std::vector<const void *> shapes;
+    } m_temporal_cache;
+
+    /**
+     * \brief File that periodic snapshots of the partially completed render
+     * are written to (for crash/preemption recovery).
+     *
+     * An empty path (the default) disables checkpointing. Snapshots record
+     * whole completed passes, hence the feature is only useful when
+     * \c samples_per_pass splits the rendering into multiple passes. Only
+     * supported in the CPU rendering modes.
+     */
+    fs::path m_checkpoint_path;
+
+    /// Seconds between two checkpoint snapshots
+    float m_checkpoint_interval;
+
+    /// Continue from \ref m_checkpoint_path before rendering, if it exists
+    bool m_resume;
+
+    /// Sampler seed offset carried across resumed runs
+    size_t m_seed_offset;
+
+    /// Recipient of developed preview tiles (optional)
+    PreviewCallback m_preview_callback;
+
     /// Timer used to enforce the timeout.
     Timer m_render_timer;
+
+    /// Per-thread monotonic arena for block rendering scratch state
+    mutable ThreadLocal<ScratchArena> m_scratch;
 };
 
 /*
@@ -206,14 +584,140 @@ protected:
     /// Virtual destructor
     virtual ~MonteCarloIntegrator();
 
+    /**
+     * \brief Raw efficiency factor used by adaptive russian roulette
+     *
+     * When \c adaptive_rr is enabled, the classic throughput heuristic is
+     * normalized by the running image-wide mean sample luminance: paths
+     * whose potential contribution exceeds the mean yield factors above
+     * one (worth splitting), dim paths yield proportionally smaller
+     * survival probabilities. Falls back to the plain throughput value
+     * while no estimate is available yet or when the feature is disabled.
+     */
+    MTS_INLINE Float rr_factor(const Float &throughput_max) const {
+        if (!m_adaptive_rr)
+            return throughput_max;
+        ScalarFloat ref = this->luminance_estimate();
+        return ref > 0.f ? throughput_max * (1.f / ref) : throughput_max;
+    }
+
+    /**
+     * \brief Russian roulette survival probability for a path with the
+     * given maximal throughput component (premultiplied by eta^2)
+     *
+     * Reproduces the classic heuristic exactly when \c adaptive_rr is
+     * disabled; otherwise clamps the efficiency factor of \ref rr_factor
+     * from both sides to bound the weight of surviving paths.
+     */
+    MTS_INLINE Float rr_prob(const Float &throughput_max) const {
+        if (!m_adaptive_rr)
+            return min(throughput_max, ScalarFloat(.95f));
+        return clamp(rr_factor(throughput_max), ScalarFloat(.05f),
+                     ScalarFloat(.95f));
+    }
+
     MTS_DECLARE_CLASS()
 protected:
     int m_max_depth;
     int m_rr_depth;
     bool m_hide_emitters;
+
+    /// Drive russian roulette by the running pixel luminance estimate?
+    bool m_adaptive_rr;
+
+    /// Maximum number of additional emitter samples granted to strong paths
+    int m_rr_split_max;
+};
+
+/**
+ * \brief Wavefront-style Monte Carlo integrator
+ *
+ * Instead of tracing each pixel sample to completion using one deep recursive
+ * \ref sample() invocation, integrators derived from this class advance all
+ * paths of an image block together, one bounce at a time. Paths of equal depth
+ * are queued contiguously, terminated entries are compacted away between
+ * bounces, and scene/BSDF/emitter queries consequently operate on large
+ * coherent batches. This primarily benefits the packet variants, where lane
+ * divergence after a few bounces would otherwise leave most of a SIMD register
+ * idle.
+ */
+template <typename Float, typename Spectrum>
+class MTS_EXPORT_RENDER WavefrontIntegrator : public MonteCarloIntegrator<Float, Spectrum> {
+public:
+    MTS_IMPORT_BASE(MonteCarloIntegrator, should_stop, aov_names, m_block_size,
+                    m_max_depth, m_scratch)
+    MTS_IMPORT_TYPES(Scene, Sensor, Film, ImageBlock, Sampler)
+
+    /// State of a (scalar or packet of) camera path(s) advanced bounce by bounce
+    struct PathState {
+        /// Next ray segment to be traced
+        RayDifferential3f ray;
+        /// Path throughput at the current vertex, including the sensor weight
+        Spectrum throughput;
+        /// Accumulated radiance estimate
+        Spectrum result;
+        /// Sample position on the film plane
+        Vector2f pos;
+        /// Lanes whose paths are still alive
+        Mask active;
+        /// Lanes that sampled a surface or medium interaction (alpha channel)
+        Mask valid;
+        /// Lanes that correspond to a real film sample (constant over the path)
+        Mask mask;
+    };
+
+    /// Path state queue backed by the per-thread scratch arena
+    using PathQueue = std::vector<PathState, ScratchAllocator<PathState>>;
+
+    /**
+     * \brief Advance a queue of equal-depth paths by a single bounce
+     *
+     * The implementation should intersect the \c ray member of every state,
+     * add emitted and direct radiance into \c result, sample the next ray
+     * segment, update \c throughput, and clear \c active for paths that
+     * terminate. All states in the queue are at the same path depth, which
+     * makes this the natural place for batched scene traversal and shading
+     * (e.g. \ref Scene::sample_emitter_direction_n() performs next-event
+     * estimation for the whole queue with emitter-sorted shadow ray
+     * streams).
+     */
+    virtual void trace_wavefront(const Scene *scene, Sampler *sampler,
+                                 PathQueue &states,
+                                 uint32_t depth) const = 0;
+
+    MTS_DECLARE_CLASS()
+protected:
+    WavefrontIntegrator(const Properties &props);
+    virtual ~WavefrontIntegrator();
+
+    void render_block(const Scene *scene,
+                      const Sensor *sensor,
+                      Sampler *sampler,
+                      ImageBlock *block,
+                      Float *aovs,
+                      size_t sample_count = size_t(-1)) const override;
+
+    /// Convert a finished path state into XYZAW samples and splat it
+    void develop(const PathState &state, ImageBlock *block, Float *aovs) const;
+
+    /**
+     * \brief Develop finished paths and densely repack the queue
+     *
+     * In the packet variants, paths terminate at different depths and a
+     * masked-out lane would otherwise stay idle for the remainder of its
+     * packet's lifetime, leaving later bounces at a fraction of the SIMD
+     * width. This routine splats the contributions of terminated lanes into
+     * the image block and gathers the surviving lanes of partially occupied
+     * packets into full ones, so that every bounce processed by \ref
+     * trace_wavefront() runs at full occupancy. In the scalar variants it
+     * simply removes finished states from the queue.
+     */
+    void compact_wavefront(PathQueue &queue, ImageBlock *block,
+                           Float *aovs) const;
 };
 
 MTS_EXTERN_CLASS_RENDER(Integrator)
 MTS_EXTERN_CLASS_RENDER(SamplingIntegrator)
 MTS_EXTERN_CLASS_RENDER(MonteCarloIntegrator)
+MTS_EXTERN_CLASS_RENDER(WavefrontIntegrator)
 NAMESPACE_END(mitsuba)
@@ -8,6 +8,42 @@
 
 NAMESPACE_BEGIN(mitsuba)
 
+/**
+ * \brief This list of flags is used to request only a subset of the fields of
+ * a \ref SurfaceInteraction from \ref Scene::ray_intersect()
+ *
+ * Shape implementations currently compute the surface parameterization,
+ * normals, and position partials jointly, hence the main benefit lies in the
+ * \ref HitFlags::Minimal fast path, which skips this computation entirely.
+ * Records created this way can be expanded on demand via \ref
+ * SurfaceInteraction::finalize_surface_interaction().
+ */
+enum class HitFlags : uint32_t {
+    /// Distance, position, shape pointer, and primitive index only
+    Minimal      = 0x00000,
+
+    /// Geometric normal and shading frame
+    ShadingFrame = 0x00001,
+
+    /// UV surface coordinates
+    UV           = 0x00002,
+
+    /// Position partials wrt. the UV parameterization
+    dPdUV        = 0x00004,
+
+    /// All of the above (default)
+    All          = ShadingFrame | UV | dPdUV,
+};
+
+constexpr uint32_t operator |(HitFlags f1, HitFlags f2)  { return (uint32_t) f1 | (uint32_t) f2; }
+constexpr uint32_t operator |(uint32_t f1, HitFlags f2)  { return f1 | (uint32_t) f2; }
+constexpr uint32_t operator &(HitFlags f1, HitFlags f2)  { return (uint32_t) f1 & (uint32_t) f2; }
+constexpr uint32_t operator &(uint32_t f1, HitFlags f2)  { return f1 & (uint32_t) f2; }
+constexpr uint32_t operator ~(HitFlags f1)               { return ~(uint32_t) f1; }
+constexpr uint32_t operator +(HitFlags e)                { return (uint32_t) e; }
+template <typename UInt32>
+constexpr auto has_flag(UInt32 flags, HitFlags f)        { return neq(flags & (uint32_t) f, 0u); }
+
 /// Generic surface interaction data structure
 template <typename Float_, typename Spectrum_>
 struct Interaction {
@@ -244,6 +280,39 @@ struct SurfaceInteraction : Interaction<Float_, Spectrum_> {
                           fmsub(a00, b1y, a01 * b0y) * inv_det);
     }
 
+    /**
+     * \brief Expand a record created by a lazy scene intersection
+     *
+     * When \ref Scene::ray_intersect() is invoked with \ref
+     * HitFlags::Minimal, the returned record only specifies the hit
+     * distance, position, shape pointer and primitive index, and \c uv
+     * temporarily stores the shape-local hit coordinates produced by the
+     * intersection backend. Calling this method with the original ray
+     * computes the deferred fields in place: it runs \ref
+     * Shape::fill_surface_interaction() to obtain the UV coordinates,
+     * normals and position partials, orthogonalizes the shading frame, and
+     * expresses the incident direction \c wi in it.
+     *
+     * \remark Hits involving instanced shape groups are always expanded
+     * eagerly and never produce a lazy record.
+     */
+    void finalize_surface_interaction(const Ray3f &ray, Mask active = true) {
+        active &= is_valid();
+        if (none(active))
+            return;
+
+        Float cache[3] = { uv.x(), uv.y(), 0.f };
+        shape->fill_surface_interaction(ray, cache, *this, active);
+
+        // Gram-schmidt orthogonalization to compute local shading frame
+        sh_frame.s = normalize(
+            fnmadd(sh_frame.n, dot(sh_frame.n, dp_du), dp_du));
+        sh_frame.t = cross(sh_frame.n, sh_frame.s);
+
+        // Incident direction in local coordinates
+        wi = select(active, to_local(-ray.d), -ray.d);
+    }
+
     /**
      * \brief Converts a Mueller matrix defined in a local frame to world space
      *
@@ -4,6 +4,9 @@
 #include <mitsuba/core/logger.h>
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/string.h>
+#include <mitsuba/render/fresnel.h>
+#include <mitsuba/render/fwd.h>
+#include <vector>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -140,4 +143,88 @@ std::pair<ref<Texture>, ref<Texture>> complex_ior_from_file(const std::string &m
     return { eta, k };
 }
 
+/**
+ * \brief Precomputed conductor reflectance curves
+ *
+ * For conductors whose complex index of refraction does not vary across the
+ * surface, the unpolarized Fresnel reflectance of each color channel is a
+ * fixed function of the incident cosine. This class tabulates these curves
+ * once at scene load time so that the per-sample complex arithmetic in
+ * \ref fresnel_conductor() collapses into a gather-lerp table lookup.
+ *
+ * The curves are resolved per color channel, hence this optimization only
+ * applies to the monochromatic and RGB modes: in spectral modes, the active
+ * wavelengths (and with them eta/k) change from sample to sample, and
+ * polarized modes require the full Mueller matrix. In these cases (or when
+ * eta/k are textured) the constructor leaves the instance \ref empty() and
+ * callers must fall back to \ref fresnel_conductor().
+ */
+template <typename Float, typename Spectrum>
+class ConductorReflectanceCurve {
+public:
+    using ScalarFloat          = scalar_t<Float>;
+    using UInt32               = uint32_array_t<Float>;
+    using Mask                 = mask_t<Float>;
+    using UnpolarizedSpectrum  = depolarize_t<Spectrum>;
+
+    /// Number of tabulated incident cosines per channel
+    static constexpr uint32_t Resolution = 256;
+
+    /// Number of color channels that are tabulated
+    static constexpr size_t Channels = array_size_v<UnpolarizedSpectrum>;
+
+    ConductorReflectanceCurve() = default;
+
+    /// Tabulate reflectance curves for the given complex IOR textures
+    template <typename Texture>
+    ConductorReflectanceCurve(const Texture *eta, const Texture *k) {
+        if constexpr (!is_polarized_v<Spectrum> && !is_spectral_v<Spectrum>) {
+            if (eta->is_spatially_varying() || k->is_spatially_varying())
+                return;
+
+            /* Uniform textures ignore the surface position entirely */
+            using SurfaceInteraction3f = SurfaceInteraction<Float, Spectrum>;
+            SurfaceInteraction3f si = zero<SurfaceInteraction3f>();
+            auto eta_v = enoki::slice(eta->eval(si, true), 0);
+            auto k_v   = enoki::slice(k->eval(si, true), 0);
+
+            m_data.resize(Channels * Resolution);
+            for (size_t c = 0; c < Channels; ++c) {
+                Complex<ScalarFloat> eta_c(eta_v[c], k_v[c]);
+                ScalarFloat *ptr = m_data.data() + c * Resolution;
+                for (uint32_t i = 0; i < Resolution; ++i)
+                    ptr[i] = fresnel_conductor(
+                        ScalarFloat(i) / ScalarFloat(Resolution - 1), eta_c);
+            }
+        } else {
+            ENOKI_MARK_USED(eta);
+            ENOKI_MARK_USED(k);
+        }
+    }
+
+    /// Was precomputation possible in the constructor?
+    bool empty() const { return m_data.empty(); }
+
+    /// Evaluate the reflectance curves using a fused gather-lerp per channel
+    UnpolarizedSpectrum eval(Float cos_theta_i, Mask active) const {
+        Assert(!empty());
+
+        Float u = clamp(cos_theta_i, 0.f, 1.f) * ScalarFloat(Resolution - 1);
+        UInt32 index = min(UInt32(u), uint32_t(Resolution - 2));
+        Float t = u - Float(index);
+
+        UnpolarizedSpectrum result;
+        for (size_t c = 0; c < Channels; ++c) {
+            const ScalarFloat *ptr = m_data.data() + c * Resolution;
+            Float v0 = enoki::gather<Float>(ptr, index, active),
+                  v1 = enoki::gather<Float>(ptr, index + 1, active);
+            result[c] = fmadd(v1 - v0, t, v0);
+        }
+        return result;
+    }
+
+private:
+    std::vector<ScalarFloat> m_data;
+};
+
 NAMESPACE_END(mitsuba)
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <unordered_set>
 #include <mitsuba/core/bbox.h>
 #include <mitsuba/core/fwd.h>
@@ -7,6 +11,7 @@
 #include <mitsuba/core/math.h>
 #include <mitsuba/core/object.h>
 #include <mitsuba/core/ray.h>
+#include <mitsuba/core/thread.h>
 #include <mitsuba/core/timer.h>
 #include <mitsuba/core/tls.h>
 #include <mitsuba/core/util.h>
@@ -26,6 +31,16 @@
 /// Grain size for TBB parallelization
 #define MTS_KD_GRAIN_SIZE 10240u
 
+/**
+ * Number of compressed entries in the short-stack packet traversal
+ * (see \ref ShapeKDTree::ray_intersect_packet_shortstack()). Set to 0 to
+ * traverse with full per-lane stacks in the packet variants instead.
+ */
+#define MTS_KD_SHORT_STACK_SIZE 12
+
+/// Number of root restarts after which the short-stack traversal bails out
+#define MTS_KD_MAX_RESTARTS 16u
+
 /**
  * Temporary scratch space that is used to cache intersection information
  * (# of floats)
@@ -116,6 +131,19 @@ public:
 
     TShapeKDTree(const CostModel &model) : m_cost_model(model) { }
 
+    /// Release the tree storage and balance the memory registry
+    virtual ~TShapeKDTree() {
+        if (m_nodes || m_indices)
+            util::untrack_memory("kd-tree", storage_size() *
+                                 (1 + m_numa_replicas.size()));
+    }
+
+    /// Return the size of the node and primitive index arrays in bytes
+    size_t storage_size() const {
+        return m_node_count * (size_t) sizeof(KDNode) +
+               m_index_count * (size_t) sizeof(Index);
+    }
+
     /// Return the cost model used by the tree construction algorithm
     CostModel cost_model() const { return m_cost_model; }
 
@@ -183,6 +211,12 @@ public:
         m_exact_prim_threshold = value;
     }
 
+    /// Return whether the node array is re-packed for traversal locality after construction
+    bool compact_tree() const { return m_compact_tree; }
+
+    /// Set whether the node array is re-packed for traversal locality after construction
+    void set_compact_tree(bool compact) { m_compact_tree = compact; }
+
     /// Return the log level of kd-tree status messages
     LogLevel log_level() const { return m_log_level; }
 
@@ -675,6 +709,14 @@ protected:
      */
     class MinMaxBins {
     public:
+        /// Packet types used by the vectorized binning & cost scan kernels
+        using ScalarP      = Packet<Scalar>;
+        using IndexP       = Packet<Index, ScalarP::Size>;
+        using PacketVector = mitsuba::Vector<ScalarP, Dimension>;
+
+        /// Number of primitives handled by one \ref put_packet() call
+        static constexpr size_t PacketSize = ScalarP::Size;
+
         MinMaxBins(Size bin_count, const BoundingBox &bbox)
             : m_bins(bin_count * Dimension * 2, Size(0)), m_bin_count(bin_count),
               m_inv_bin_size(1 / (bbox.extents() / (Scalar) bin_count)),
@@ -742,60 +784,121 @@ protected:
             scatter(ptr, maxCounts + 1, index_max);
         }
 
+        /**
+         * \brief Vectorized variant of \ref put() that bins a full packet of
+         * primitive bounding boxes at once
+         *
+         * The relative bin coordinates of all packet lanes are computed with
+         * fused packet arithmetic across the three axes; only the final
+         * counter increments execute one lane at a time, since multiple
+         * lanes may land in the same bin.
+         */
+        MTS_INLINE void put_packet(const PacketVector &min_,
+                                   const PacketVector &max_) {
+            Index *ptr = m_bins.data();
+
+            for (size_t axis = 0; axis < Dimension; ++axis) {
+                ScalarP rel_min = (min_[axis] - m_bbox.min[axis]) * m_inv_bin_size[axis],
+                        rel_max = (max_[axis] - m_bbox.min[axis]) * m_inv_bin_size[axis];
+
+                rel_min = min(max(rel_min, zero<ScalarP>()), ScalarP(m_max_bin[axis]));
+                rel_max = min(max(rel_max, zero<ScalarP>()), ScalarP(m_max_bin[axis]));
+
+                IndexP index_min = IndexP(rel_min) * 2u + 2u * (Index) axis * m_bin_count,
+                       index_max = IndexP(rel_max) * 2u + (2u * (Index) axis * m_bin_count + 1u);
+
+                for (size_t l = 0; l < PacketSize; ++l) {
+                    ptr[index_min.coeff(l)]++;
+                    ptr[index_max.coeff(l)]++;
+                }
+            }
+        }
+
         SplitCandidate best_candidate(Size prim_count, const CostModel &model) const {
             const Index *bin = m_bins.data();
             SplitCandidate best;
 
             Vector step = m_bbox.extents() / Scalar(m_bin_count);
 
+            /* Per-candidate primitive counts, padded with zeros so that the
+               vectorized cost scan below can safely load full packets */
+            Size n        = m_bin_count + 1,
+                 n_padded = (n + (Size) PacketSize - 1) /
+                            (Size) PacketSize * (Size) PacketSize;
+            std::vector<Size> left_counts(n_padded, 0),
+                              right_counts(n_padded, 0);
+
             for (Index axis = 0; axis < Dimension; ++axis) {
-                SplitCandidate candidate;
-
-                /* Initially: all primitives to the right, none on the left */
-                candidate.left_count = 0;
-                candidate.right_count = prim_count;
-                candidate.right_bin = 0;
-                candidate.axis = axis;
-                candidate.split = m_bbox.min[axis];
-
-                for (Index i = 0; i < m_bin_count; ++i) {
-                    /* Evaluate the cost model and keep the best candidate */
-                    candidate.cost = model.inner_cost(
-                        axis, candidate.split,
-                        model.leaf_cost(candidate.left_count),
-                        model.leaf_cost(candidate.right_count));
-
-                    if (candidate.cost < best.cost)
-                        best = candidate;
-
-                    /* Move one bin to the right and
-
-                       1. Increase left_count by the number of primitives which
-                          started in the bin (thus they at least overlap with
-                          the left interval). This information is stored in the MIN
-                          bin.
-
-                       2. Reduce right_count by the number of primitives which
-                          ended (thus they are entirely on the left). This
-                          information is stored in the MAX bin.
-                    */
-                    candidate.left_count  += *bin++; /* MIN-bin */
-                    candidate.right_count -= *bin++; /* MAX-bin */
-                    candidate.right_bin++;
-                    candidate.split += step[axis];
+                /* Split candidate i lies between bins i-1 and i. Moving one
+                   bin to the right
+
+                   1. increases left_count by the number of primitives which
+                      started in the bin (thus they at least overlap with the
+                      left interval). This information is stored in the MIN
+                      bin.
+
+                   2. reduces right_count by the number of primitives which
+                      ended (thus they are entirely on the left). This
+                      information is stored in the MAX bin.
+                */
+                Size left_count = 0, right_count = prim_count;
+                for (Index i = 0; i < n; ++i) {
+                    left_counts[i]  = left_count;
+                    right_counts[i] = right_count;
+                    if (i < m_bin_count) {
+                        left_count  += bin[0]; /* MIN-bin */
+                        right_count -= bin[1]; /* MAX-bin */
+                        bin += 2;
+                    }
                 }
 
-                /* Evaluate the cost model and keep the best candidate */
-                candidate.cost = model.inner_cost(
-                    axis, candidate.split,
-                    model.leaf_cost(candidate.left_count),
-                    model.leaf_cost(candidate.right_count));
+                Assert(left_count == prim_count);
+                Assert(right_count == 0);
+
+                /* Evaluate the cost model for all split candidates of this
+                   axis, one packet at a time */
+                ScalarP best_cost_p(math::Infinity<Scalar>);
+                IndexP  best_index_p(0);
+
+                for (Size i = 0; i < n_padded; i += (Size) PacketSize) {
+                    IndexP index = arange<IndexP>() + i;
+
+                    ScalarP left_cost = model.leaf_cost(
+                                ScalarP(load_unaligned<IndexP>(left_counts.data() + i))),
+                            right_cost = model.leaf_cost(
+                                ScalarP(load_unaligned<IndexP>(right_counts.data() + i))),
+                            split = m_bbox.min[axis] + ScalarP(index) * step[axis];
+
+                    ScalarP cost = model.inner_cost(axis, split,
+                                                    left_cost, right_cost);
+
+                    /* Disable the padding lanes past the last candidate */
+                    cost = select(index < n, cost,
+                                  ScalarP(math::Infinity<Scalar>));
 
-                if (candidate.cost < best.cost)
-                    best = candidate;
+                    auto better  = cost < best_cost_p;
+                    best_cost_p  = select(better, cost, best_cost_p);
+                    best_index_p = select(better, index, best_index_p);
+                }
+
+                /* Horizontal reduction; ties resolve in favor of the
+                   smallest candidate index, like the scalar scan */
+                Scalar axis_cost  = hmin(best_cost_p);
+                Index  axis_index = (Index) -1;
+                for (size_t l = 0; l < PacketSize; ++l) {
+                    if (best_cost_p.coeff(l) == axis_cost)
+                        axis_index = std::min(axis_index,
+                                              (Index) best_index_p.coeff(l));
+                }
 
-                Assert(candidate.left_count == prim_count);
-                Assert(candidate.right_count == 0);
+                if (axis_cost < best.cost) {
+                    best.cost        = axis_cost;
+                    best.axis        = axis;
+                    best.right_bin   = axis_index;
+                    best.left_count  = left_counts[axis_index];
+                    best.right_count = right_counts[axis_index];
+                    best.split       = m_bbox.min[axis] + axis_index * step[axis];
+                }
             }
 
             Assert(bin == m_bins.data() + m_bins.size());
@@ -1030,8 +1133,29 @@ protected:
 
                 /* MAP: Bin a number of shapes and return the resulting 'MinMaxBins' data structure */
                 [&](const tbb::blocked_range<Index> &range, MinMaxBins bins) {
-                    for (Index i = range.begin(); i != range.end(); ++i)
+                    /* Transpose packets of primitive bounding boxes into SoA
+                       form and bin them with fused packet arithmetic; any
+                       remainder at the end of the range takes the scalar path */
+                    using PacketVector = typename MinMaxBins::PacketVector;
+                    constexpr Index P = (Index) MinMaxBins::PacketSize;
+
+                    Index i = range.begin();
+                    for (; i + P <= range.end(); i += P) {
+                        PacketVector p_min, p_max;
+                        for (Index l = 0; l < P; ++l) {
+                            BoundingBox prim_bbox = derived.bbox(m_indices[i + l]);
+                            Assert(prim_bbox.valid());
+                            for (size_t a = 0; a < Dimension; ++a) {
+                                p_min[a].coeff(l) = prim_bbox.min[a];
+                                p_max[a].coeff(l) = prim_bbox.max[a];
+                            }
+                        }
+                        bins.put_packet(p_min, p_max);
+                    }
+
+                    for (; i != range.end(); ++i)
                         bins.put(derived.bbox(m_indices[i]));
+
                     return bins;
                 },
 
@@ -1107,9 +1231,12 @@ protected:
                 m_bad_refines, &right_cost);
 
             set_ref_count(3);
-            spawn(left_task);
             spawn(right_task);
-            wait_for_all();
+            /* Scheduler bypass: execute the left subtree directly on this
+               thread instead of round-tripping it through the task queue.
+               The right subtree remains available for stealing, so the
+               top-of-tree splits still fan out across all cores. */
+            spawn_and_wait_for_all(left_task);
 
             /* ==================================================================== */
             /*                           Final decision                             */
@@ -1812,6 +1939,34 @@ protected:
         m_bbox.min -= extra;
         m_bbox.max += extra;
 
+        /* ==================================================================== */
+        /*        Optionally re-pack the node array for traversal locality      */
+        /* ==================================================================== */
+
+        if (m_compact_tree)
+            compact();
+
+        /* ==================================================================== */
+        /*     Replicate the tree on every NUMA node when pinning is active     */
+        /* ==================================================================== */
+
+        replicate_numa();
+
+        /* ==================================================================== */
+        /*    Register the final storage and request huge page backing for it   */
+        /* ==================================================================== */
+
+        util::track_memory("kd-tree",
+                           storage_size() * (1 + m_numa_replicas.size()));
+        util::advise_huge_pages(m_nodes.get(), m_node_count * sizeof(KDNode));
+        util::advise_huge_pages(m_indices.get(), m_index_count * sizeof(Index));
+        for (NumaReplica &replica : m_numa_replicas) {
+            util::advise_huge_pages(replica.nodes.get(),
+                                    m_node_count * sizeof(KDNode));
+            util::advise_huge_pages(replica.indices.get(),
+                                    m_index_count * sizeof(Index));
+        }
+
         /* ==================================================================== */
         /*         Print various tree statistics if requested by the user       */
         /* ==================================================================== */
@@ -1880,9 +2035,185 @@ protected:
         }
     }
 
+protected:
+    /// Per-NUMA-node copy of the node and index arrays (see \ref build())
+    struct NumaReplica {
+        std::unique_ptr<KDNode[]> nodes;
+        std::unique_ptr<Index[]> indices;
+    };
+
+    /// Return the node array copy that is local to the calling thread
+    MTS_INLINE const KDNode *local_nodes() const {
+        if (likely(m_numa_replicas.empty()))
+            return m_nodes.get();
+        return m_numa_replicas[Thread::numa_node()].nodes.get();
+    }
+
+    /// Return the index array copy that is local to the calling thread
+    MTS_INLINE const Index *local_indices() const {
+        if (likely(m_numa_replicas.empty()))
+            return m_indices.get();
+        return m_numa_replicas[Thread::numa_node()].indices.get();
+    }
+
+    /**
+     * \brief Re-pack the node and primitive index arrays for traversal
+     * locality (see \ref set_compact_tree())
+     *
+     * The builder stores sibling pairs adjacently, but a pair and its
+     * descendants end up scattered over the node array by the parallel
+     * construction. This pass rewrites the nodes so that the top levels of
+     * every subtree form a contiguous cache-line-sized cluster
+     * (breadth-first within a cluster, depth-first across clusters) and
+     * re-orders the per-leaf primitive index lists to match the new leaf
+     * order. The 8-byte node format and the uncompressed index lists are
+     * unchanged, so the traversal kernels apply as-is.
+     */
+    void compact() {
+        if (m_node_count <= 1)
+            return;
+
+        Timer timer;
+
+        /* Number of nodes that fit into one cache line (a pair of siblings
+           must always remain adjacent) */
+        constexpr Size ClusterSize =
+            sizeof(KDNode) < 32 ? Size(64 / sizeof(KDNode)) : Size(2);
+
+        const KDNode *src = m_nodes.get();
+
+        /* Pass 1: assign a new position to every node. The stack holds left
+           children of pairs that did not fit into their parent's cluster;
+           each such pair jointly seeds a cluster of its own. */
+        std::unique_ptr<Size[]> remap(new Size[m_node_count]);
+        std::vector<Size> stack;
+        Size cursor = 0;
+
+        auto emit_cluster = [&](Size root, bool pair) {
+            Size queue[ClusterSize];
+            Size queue_start = 0, queue_end = 0, emitted = pair ? 2 : 1;
+
+            remap[root] = cursor++;
+            queue[queue_end++] = root;
+            if (pair) {
+                remap[root + 1] = cursor++;
+                queue[queue_end++] = root + 1;
+            }
+
+            while (queue_start < queue_end) {
+                Size index = queue[queue_start++];
+                const KDNode &node = src[index];
+                if (node.leaf())
+                    continue;
+
+                Size left = index + node.left_offset();
+                if (emitted + 2 <= ClusterSize) {
+                    remap[left]        = cursor++;
+                    remap[left + 1]    = cursor++;
+                    queue[queue_end++] = left;
+                    queue[queue_end++] = left + 1;
+                    emitted += 2;
+                } else {
+                    stack.push_back(left);
+                }
+            }
+        };
+
+        emit_cluster(0, false);
+        while (!stack.empty()) {
+            Size left = stack.back();
+            stack.pop_back();
+            emit_cluster(left, true);
+        }
+        Assert(cursor == m_node_count);
+
+        /* Pass 2: move each node to its new position; leaves additionally
+           receive a freshly packed primitive list so that the index array is
+           visited sequentially during traversal */
+        std::unique_ptr<Size[]> order(new Size[m_node_count]);
+        for (Size i = 0; i < m_node_count; ++i)
+            order[remap[i]] = i;
+
+        std::unique_ptr<KDNode[]> nodes(new KDNode[m_node_count]);
+        std::unique_ptr<Index[]> indices(new Index[m_index_count]);
+        Size index_pos = 0;
+
+        for (Size i = 0; i < m_node_count; ++i) {
+            const KDNode &node = src[order[i]];
+            bool valid;
+            if (node.leaf()) {
+                Size count = node.primitive_count();
+                valid = nodes[i].set_leaf_node(index_pos, count);
+                memcpy(indices.get() + index_pos,
+                       m_indices.get() + node.primitive_offset(),
+                       count * sizeof(Index));
+                index_pos += count;
+            } else {
+                Size left = remap[order[i] + node.left_offset()];
+                valid = nodes[i].set_inner_node(node.axis(), node.split(),
+                                                left - i);
+            }
+            if (unlikely(!valid))
+                Throw("Internal error while compacting the kd-tree!");
+        }
+        Assert(index_pos == m_index_count);
+
+        m_nodes   = std::move(nodes);
+        m_indices = std::move(indices);
+
+        Log(m_log_level, "Re-packed kd-tree nodes into cache-line-sized "
+            "clusters (took %s)", util::time_string(timer.value()));
+    }
+
+    /**
+     * \brief (Re-)create the per-NUMA-node copies of the node and index
+     * arrays. Called at the end of \ref build() and again when the tree
+     * contents change in place (see \ref ShapeKDTree::update()). Does
+     * nothing unless NUMA pinning is active on a multi-node machine.
+     */
+    void replicate_numa() {
+        if (!Thread::numa_pinning() || Thread::numa_node_count() <= 1)
+            return;
+
+        int numa_nodes = Thread::numa_node_count();
+        m_numa_replicas.clear();
+        m_numa_replicas.resize(numa_nodes);
+
+        /* Each replica is copied by a thread pinned to its target node,
+           so that the operating system's first-touch policy places the
+           replica's pages in node-local memory. Node offsets are
+           relative, hence the copies are valid trees by themselves. */
+        std::vector<std::thread> copiers;
+        for (int numa_node = 0; numa_node < numa_nodes; ++numa_node) {
+            copiers.emplace_back([this, numa_node]() {
+                Thread::register_external_thread("numa");
+                Thread::pin_to_numa_node(numa_node);
+
+                NumaReplica &replica = m_numa_replicas[numa_node];
+                replica.nodes.reset(new KDNode[m_node_count]);
+                replica.indices.reset(new Index[m_index_count]);
+                memcpy(replica.nodes.get(), m_nodes.get(),
+                       m_node_count * sizeof(KDNode));
+                memcpy(replica.indices.get(), m_indices.get(),
+                       m_index_count * sizeof(Index));
+
+                Thread::unregister_external_thread();
+            });
+        }
+        for (std::thread &copier : copiers)
+            copier.join();
+
+        Log(m_log_level, "Replicated the kd-tree on %i NUMA nodes (%s)",
+            numa_nodes,
+            util::mem_string(numa_nodes *
+                             (m_node_count * sizeof(KDNode) +
+                              m_index_count * sizeof(Index))));
+    }
+
 protected:
     std::unique_ptr<KDNode[]> m_nodes;
     std::unique_ptr<Index[]> m_indices;
+    std::vector<NumaReplica> m_numa_replicas;
     Size m_node_count = 0;
     Size m_index_count = 0;
 
@@ -1894,6 +2225,7 @@ protected:
     Size m_max_bad_refines = 0;
     Size m_exact_prim_threshold = 65536;
     Size m_min_max_bins = 128;
+    bool m_compact_tree = false;
     LogLevel m_log_level = Debug;
     BoundingBox m_bbox;
 };
@@ -1965,6 +2297,12 @@ public:
         return m_query_cost * nelem;
     }
 
+    /// Vectorized variant of \ref leaf_cost() used by the binned cost scan
+    template <typename Value, enable_if_array_t<Value> = 0>
+    Value leaf_cost(const Value &nelem) const {
+        return nelem * m_query_cost;
+    }
+
     /**
      * \brief Evaluate the surface area heuristic
      *
@@ -1986,6 +2324,22 @@ public:
         return cost;
     }
 
+    /// Vectorized variant of \ref inner_cost() used by the binned cost scan
+    template <typename Value, enable_if_array_t<Value> = 0>
+    Value inner_cost(Index axis, const Value &split, const Value &left_cost,
+                     const Value &right_cost) const {
+        Value left_prob  = m_temp0[axis] + m_temp2[axis] * split;
+        Value right_prob = m_temp1[axis] - m_temp2[axis] * split;
+
+        Value cost = m_traversal_cost +
+            (left_prob * left_cost + right_prob * right_cost);
+
+        masked(cost, eq(left_cost, 0.f) || eq(right_cost, 0.f)) *=
+            m_empty_space_bonus;
+
+        return cost;
+    }
+
     static Float eval(const BoundingBox3f &bbox) {
         return bbox.surface_area();
     }
@@ -2019,6 +2373,14 @@ public:
     using Base = TShapeKDTree<ScalarBoundingBox3f, uint32_t, SurfaceAreaHeuristic3f, ShapeKDTree>;
     using typename Base::KDNode;
     using Base::ready;
+    using Base::cost_model;
+    using Base::max_depth;
+    using Base::min_max_bins;
+    using Base::clip_primitives;
+    using Base::retract_bad_splits;
+    using Base::stop_primitives;
+    using Base::exact_primitive_threshold;
+    using Base::set_log_level;
     using Base::set_clip_primitives;
     using Base::set_exact_primitive_threshold;
     using Base::set_max_depth;
@@ -2031,16 +2393,44 @@ public:
     using Base::m_indices;
     using Base::m_index_count;
     using Base::m_node_count;
+    using Base::local_nodes;
+    using Base::local_indices;
+    using Base::replicate_numa;
+    using Base::m_numa_replicas;
 
     /// Create an empty kd-tree and take build-related parameters from \c props.
     ShapeKDTree(const Properties &props);
 
+    /// Create an empty kd-tree with the given cost model (used for subtrees)
+    ShapeKDTree(const SurfaceAreaHeuristic3f &model);
+
     /// Register a new shape with the kd-tree (to be called before \ref build())
     void add_shape(Shape *shape);
 
     /// Build the kd-tree
     void build();
 
+    /**
+     * \brief Update the kd-tree after the geometry of one or more shapes
+     * was modified (e.g. by an animated vertex position update)
+     *
+     * Shapes flag such modifications via \ref Shape::mark_dirty(). When only
+     * a small fraction of the scene moved, the tree structure (i.e. the
+     * split planes chosen by the SAH builder) is kept, and merely the
+     * primitives of the modified shapes are re-binned into the existing
+     * leaves -- considerably cheaper than construction from scratch, at the
+     * cost of a gradual loss of tree quality under large motion. When the
+     * majority of the scene moved, the function falls back to a full
+     * rebuild. The per-shape primitive counts must remain unchanged.
+     */
+    void update();
+
+    /// Precompute per-triangle intersection data for all meshes? (see \c kd_precompute_triangles)
+    bool precompute_triangles() const { return m_precompute_triangles; }
+
+    /// Set whether the build precomputes per-triangle intersection data
+    void set_precompute_triangles(bool value) { m_precompute_triangles = value; }
+
     /// Return the number of registered shapes
     Size shape_count() const { return Size(m_shapes.size()); }
 
@@ -2070,10 +2460,17 @@ public:
                                                     Float *cache,
                                                     Mask active) const {
         ENOKI_MARK_USED(active);
-        if constexpr (!is_array_v<Float>)
+        if (unlikely(m_two_level))
+            return ray_intersect_two_level<ShadowRay>(ray, cache, active);
+        if constexpr (!is_array_v<Float>) {
             return ray_intersect_scalar<ShadowRay>(ray, cache);
-        else
+        } else {
+#if MTS_KD_SHORT_STACK_SIZE > 0
+            return ray_intersect_packet_shortstack<ShadowRay>(ray, cache, active);
+#else
             return ray_intersect_packet<ShadowRay>(ray, cache, active);
+#endif
+        }
     }
 
     template <bool ShadowRay>
@@ -2100,7 +2497,9 @@ public:
         Float mint = std::max(ray.mint, std::get<1>(bbox_result));
         Float maxt = std::min(ray.maxt, std::get<2>(bbox_result));
 
-        const KDNode *node = m_nodes.get();
+        // Traverse the NUMA-local copy of the tree, if one exists
+        const KDNode *node = local_nodes();
+        const Index *indices = local_indices();
         while (mint <= maxt) {
             if (likely(!node->leaf())) { // Inner node
                 const Float split   = node->split();
@@ -2142,7 +2541,7 @@ public:
                 Index prim_start = node->primitive_offset();
                 Index prim_end = prim_start + node->primitive_count();
                 for (Index i = prim_start; i < prim_end; i++) {
-                    Index prim_index = m_indices[i];
+                    Index prim_index = indices[i];
 
                     bool prim_hit;
                     Float prim_t;
@@ -2194,7 +2593,9 @@ public:
         // True if an intersection has been found
         Mask hit = false;
 
-        const KDNode *node = m_nodes.get();
+        // Traverse the NUMA-local copy of the tree, if one exists
+        const KDNode *node = local_nodes();
+        const Index *indices = local_indices();
 
         /* Intersect against the scene bounding box */
         auto bbox_result = m_bbox.ray_intersect(ray);
@@ -2268,7 +2669,7 @@ public:
                     Index prim_start = node->primitive_offset();
                     Index prim_end = prim_start + node->primitive_count();
                     for (Index i = prim_start; i < prim_end; i++) {
-                        Index prim_index = m_indices[i];
+                        Index prim_index = indices[i];
 
                         Mask prim_hit;
                         Float prim_t;
@@ -2299,6 +2700,201 @@ public:
         return { hit, select(hit, ray.maxt, math::Infinity<Float>) };
     }
 
+    /**
+     * \brief Short-stack variant of \ref ray_intersect_packet()
+     *
+     * The full per-lane traversal stack of \ref ray_intersect_packet()
+     * occupies several kilobytes, and incoherent rays (e.g. path segments
+     * past the second bounce) push and pop deep enough that the resulting
+     * spill traffic dominates the traversal cost. This variant bounds the
+     * stack to \ref MTS_KD_SHORT_STACK_SIZE compressed entries, each
+     * storing only a conservative scalar entry/exit interval bracketing
+     * all lanes plus the lane mask. When the stack overflows, the oldest
+     * (farthest) entry is merged into a restart record; once the stack
+     * runs dry, traversal re-enters the tree from the root restricted to
+     * the recorded interval. Conservative intervals can only add node
+     * visits, never drop any, so the result matches the full-stack
+     * traversal exactly. Pathological rays that keep triggering restarts
+     * (more than \ref MTS_KD_MAX_RESTARTS times) complete their remaining
+     * work using the full-stack routine instead.
+     */
+    template <bool ShadowRay>
+    MTS_INLINE std::pair<Mask, Float> ray_intersect_packet_shortstack(
+            Ray3f ray, Float *cache, Mask active) const {
+        /// Compressed ray traversal stack entry
+        struct KDStackEntry {
+            // Conservative scalar interval bracketing all lanes' entry/exit distances
+            ScalarFloat mint, maxt;
+            // Lanes that still need to visit 'node'
+            Mask active;
+            // Pointer to the far child
+            const KDNode *node;
+        };
+
+        // Allocate the compressed node stack
+        KDStackEntry stack[MTS_KD_SHORT_STACK_SIZE];
+        int32_t stack_index = 0;
+
+        // Subtrees evicted from the short stack, awaiting a root restart
+        ScalarFloat restart_mint =  math::Infinity<ScalarFloat>,
+                    restart_maxt = -math::Infinity<ScalarFloat>;
+        Mask restart_active = false;
+        uint32_t restarts = 0;
+
+        // True if an intersection has been found
+        Mask hit = false;
+
+        // Traverse the NUMA-local copy of the tree, if one exists
+        const KDNode *root = local_nodes(), *node = root;
+        const Index *indices = local_indices();
+
+        /* Intersect against the scene bounding box */
+        auto bbox_result = m_bbox.ray_intersect(ray);
+        Float mint = enoki::max(ray.mint, std::get<1>(bbox_result));
+        Float maxt = enoki::min(ray.maxt, std::get<2>(bbox_result));
+
+        while (true) {
+            active = active && (maxt >= mint);
+            if (ShadowRay)
+                active = active && !hit;
+
+            if (likely(any(active))) {
+                if (likely(!node->leaf())) { // Inner node
+                    const scalar_t<Float> split = node->split();
+                    const uint32_t axis = node->axis();
+
+                    // Compute parametric distance along the rays to the split plane
+                    Float t_plane          = (split - ray.o[axis]) * ray.d_rcp[axis];
+                    Mask left_first        = (ray.o[axis] < split) ||
+                                              (eq(ray.o[axis], split) && ray.d[axis] >= 0.f),
+                         start_after       = t_plane < mint,
+                         end_before        = t_plane > maxt || t_plane < 0.f || !enoki::isfinite(t_plane),
+                         single_node       = start_after || end_before,
+                         visit_left        = eq(end_before, left_first),
+                         visit_only_left   = single_node &&  visit_left,
+                         visit_only_right  = single_node && !visit_left;
+
+                    bool all_visit_only_left  = all(visit_only_left || !active),
+                         all_visit_only_right = all(visit_only_right || !active),
+                         all_visit_same_node  = all_visit_only_left || all_visit_only_right;
+
+                    /* If we only need to visit one node, just pick the correct one and continue */
+                    if (all_visit_same_node) {
+                        node = node->left() + (all_visit_only_left ? 0 : 1);
+                        continue;
+                    }
+
+                    size_t left_votes  = count(left_first && active),
+                           right_votes = count(!left_first && active);
+
+                    bool go_left = left_votes >= right_votes;
+
+                    Mask go_left_bcast = Mask(go_left),
+                         correct_order = eq(left_first, go_left_bcast),
+                         visit_both    = !single_node,
+                         visit_cur     = visit_both || eq (visit_left, go_left_bcast),
+                         visit_next    = visit_both || neq(visit_left, go_left_bcast);
+
+                    /* Visit both child nodes in the right order */
+                    Index node_offset = go_left ? 0 : 1;
+                    const KDNode *left   = node->left(),
+                                 *n_cur  = left + node_offset,
+                                 *n_next = left + (1 - node_offset);
+
+                    Mask sel0 =  correct_order && visit_both,
+                         sel1 = !correct_order && visit_both;
+
+                    /* Per-lane interval of the postponed visit to 'n_next' */
+                    Float entry_mint = select(sel0, t_plane, mint),
+                          entry_maxt = select(sel1, t_plane, maxt);
+                    Mask  entry_active = active && visit_next;
+
+                    if (unlikely(stack_index == MTS_KD_SHORT_STACK_SIZE)) {
+                        /* Overflow: evict the oldest (farthest) entry into
+                           the restart record */
+                        restart_mint   = std::min(restart_mint, stack[0].mint);
+                        restart_maxt   = std::max(restart_maxt, stack[0].maxt);
+                        restart_active = restart_active || stack[0].active;
+                        for (int32_t k = 1; k < MTS_KD_SHORT_STACK_SIZE; ++k)
+                            stack[k - 1] = stack[k];
+                        --stack_index;
+                    }
+
+                    /* Postpone visit to 'n_next' with a compressed entry */
+                    KDStackEntry& entry = stack[stack_index++];
+                    entry.mint = hmin(select(entry_active, entry_mint,
+                                             math::Infinity<Float>));
+                    entry.maxt = hmax(select(entry_active, entry_maxt,
+                                             -math::Infinity<Float>));
+                    entry.active = entry_active;
+                    entry.node = n_next;
+
+                    /* Visit 'n_cur' now */
+                    mint = select(sel1, t_plane, mint);
+                    maxt = select(sel0, t_plane, maxt);
+                    active = active && visit_cur;
+                    node = n_cur;
+                    continue;
+                } else if (node->primitive_count() > 0) { // Arrived at a leaf node
+                    Index prim_start = node->primitive_offset();
+                    Index prim_end = prim_start + node->primitive_count();
+                    for (Index i = prim_start; i < prim_end; i++) {
+                        Index prim_index = indices[i];
+
+                        Mask prim_hit;
+                        Float prim_t;
+                        std::tie(prim_hit, prim_t) =
+                            intersect_prim<ShadowRay>(prim_index, ray, cache, active);
+
+                        if (!ShadowRay) {
+                            Assert(all(!prim_hit || (prim_t >= ray.mint && prim_t <= ray.maxt)));
+                            masked(ray.maxt, prim_hit) = prim_t;
+                        }
+                        hit |= prim_hit;
+                    }
+                }
+            }
+
+            if (likely(stack_index > 0)) {
+                --stack_index;
+                KDStackEntry& entry = stack[stack_index];
+                /* The conservative scalar interval re-activates at most a
+                   superset of the lanes that originally postponed this
+                   node; the primitive tests remain exact */
+                mint = Float(entry.mint);
+                maxt = enoki::min(Float(entry.maxt), ray.maxt);
+                active = entry.active;
+                node = entry.node;
+            } else if (any(restart_active)) {
+                if (unlikely(++restarts > MTS_KD_MAX_RESTARTS)) {
+                    /* Pathological case: finish the remaining work with the
+                       full-stack routine */
+                    auto [rest_hit, rest_t] =
+                        ray_intersect_packet<ShadowRay>(ray, cache, restart_active);
+                    if (!ShadowRay)
+                        masked(ray.maxt, rest_hit) = enoki::min(ray.maxt, rest_t);
+                    hit |= rest_hit;
+                    break;
+                }
+
+                /* Re-enter the tree from the root, restricted to the
+                   interval and lanes of the evicted entries */
+                mint = Float(restart_mint);
+                maxt = enoki::min(Float(restart_maxt), ray.maxt);
+                active = restart_active;
+                node = root;
+
+                restart_mint   =  math::Infinity<ScalarFloat>;
+                restart_maxt   = -math::Infinity<ScalarFloat>;
+                restart_active = false;
+            } else {
+                break;
+            }
+        }
+
+        return { hit, select(hit, ray.maxt, math::Infinity<Float>) };
+    }
+
     /// Brute force intersection routine for debugging purposes
     template <bool ShadowRay>
     MTS_INLINE std::pair<Mask, Float> ray_intersect_naive(Ray3f ray,
@@ -2327,6 +2923,345 @@ public:
         return { hit, hit_t };
     }
 
+    /**
+     * \brief Dedicated any-hit traversal for occlusion (shadow) rays
+     *
+     * Unlike \ref ray_intersect() with \c ShadowRay set, this routine does
+     * not maintain any nearest-hit state or return a distance: it merely
+     * reports whether an occluder exists along the ray segment. The whole
+     * traversal terminates (without unwinding the node stack) as soon as
+     * every lane has found an occluder.
+     */
+    MTS_INLINE Mask ray_test(const Ray3f &ray, Mask active) const {
+        ENOKI_MARK_USED(active);
+        if (unlikely(m_two_level))
+            return ray_intersect_two_level<true>(ray, nullptr, active).first;
+        if constexpr (!is_array_v<Float>)
+            return ray_test_scalar(ray);
+        else
+            return ray_test_packet(ray, active);
+    }
+
+    MTS_INLINE bool ray_test_scalar(const Ray3f &ray) const {
+        /// Ray traversal stack entry
+        struct KDStackEntry {
+            // Ray distance associated with the node entry and exit point
+            Float mint, maxt;
+            // Pointer to the far child
+            const KDNode *node;
+        };
+
+        // Allocate the node stack
+        KDStackEntry stack[MTS_KD_MAXDEPTH];
+        int32_t stack_index = 0;
+
+        // Intersect against the scene bounding box
+        auto bbox_result = m_bbox.ray_intersect(ray);
+
+        Float mint = std::max(ray.mint, std::get<1>(bbox_result));
+        Float maxt = std::min(ray.maxt, std::get<2>(bbox_result));
+
+        // Traverse the NUMA-local copy of the tree, if one exists
+        const KDNode *node = local_nodes();
+        const Index *indices = local_indices();
+        while (mint <= maxt) {
+            if (likely(!node->leaf())) { // Inner node
+                const Float split   = node->split();
+                const uint32_t axis = node->axis();
+
+                /* Compute parametric distance along the rays to the split plane.
+                   Any-hit queries do not require a strict front-to-back order,
+                   but the near child is still visited first: an occluder close
+                   to the origin terminates the traversal soonest. */
+                Float t_plane = (split - ray.o[axis]) * ray.d_rcp[axis];
+
+                bool left_first  = (ray.o[axis] < split) ||
+                                   (ray.o[axis] == split && ray.d[axis] >= 0.f),
+                     start_after = t_plane < mint,
+                     end_before  = t_plane > maxt || t_plane < 0.f || !std::isfinite(t_plane),
+                     single_node = start_after || end_before;
+
+                /* If we only need to visit one node, just pick the correct one and continue */
+                if (likely(single_node)) {
+                    bool visit_left = end_before == left_first;
+                    node = node->left() + (visit_left ? 0 : 1);
+                    continue;
+                }
+
+                /* Visit both child nodes in the right order */
+                Index node_offset = left_first ? 0 : 1;
+                const KDNode *left   = node->left(),
+                             *n_cur  = left + node_offset,
+                             *n_next = left + (1 - node_offset);
+
+                /* Postpone visit to 'n_next' */
+                KDStackEntry& entry = stack[stack_index++];
+                entry.mint = t_plane;
+                entry.maxt = maxt;
+                entry.node = n_next;
+
+                /* Visit 'n_cur' now */
+                node = n_cur;
+                maxt = t_plane;
+                continue;
+            } else if (node->primitive_count() > 0) { // Arrived at a leaf node
+                Index prim_start = node->primitive_offset();
+                Index prim_end = prim_start + node->primitive_count();
+                for (Index i = prim_start; i < prim_end; i++) {
+                    Index prim_index = indices[i];
+                    if (unlikely(intersect_prim_shadow(prim_index, ray, true)))
+                        return true;
+                }
+            }
+
+            if (likely(stack_index > 0)) {
+                --stack_index;
+                KDStackEntry& entry = stack[stack_index];
+                mint = entry.mint;
+                maxt = entry.maxt;
+                node = entry.node;
+            } else {
+                break;
+            }
+        }
+        return false;
+    }
+
+    MTS_INLINE Mask ray_test_packet(const Ray3f &ray, Mask active) const {
+        /// Ray traversal stack entry
+        struct KDStackEntry {
+            // Ray distance associated with the node entry and exit point
+            Float mint, maxt;
+            // Is the corresponding SIMD lane enabled?
+            Mask active;
+            // Pointer to the far child
+            const KDNode *node;
+        };
+
+        // Allocate the node stack
+        KDStackEntry stack[MTS_KD_MAXDEPTH];
+        int32_t stack_index = 0;
+
+        // True if an intersection has been found
+        Mask hit = false;
+
+        // Lanes that are looking for an occluder in the first place
+        const Mask active_orig = active;
+
+        // Traverse the NUMA-local copy of the tree, if one exists
+        const KDNode *node = local_nodes();
+        const Index *indices = local_indices();
+
+        /* Intersect against the scene bounding box */
+        auto bbox_result = m_bbox.ray_intersect(ray);
+        Float mint = enoki::max(ray.mint, std::get<1>(bbox_result));
+        Float maxt = enoki::min(ray.maxt, std::get<2>(bbox_result));
+
+        while (true) {
+            active = active && (maxt >= mint) && !hit;
+
+            if (likely(any(active))) {
+                if (likely(!node->leaf())) { // Inner node
+                    const scalar_t<Float> split = node->split();
+                    const uint32_t axis = node->axis();
+
+                    // Compute parametric distance along the rays to the split plane
+                    Float t_plane          = (split - ray.o[axis]) * ray.d_rcp[axis];
+                    Mask left_first        = (ray.o[axis] < split) ||
+                                              (eq(ray.o[axis], split) && ray.d[axis] >= 0.f),
+                         start_after       = t_plane < mint,
+                         end_before        = t_plane > maxt || t_plane < 0.f || !enoki::isfinite(t_plane),
+                         single_node       = start_after || end_before,
+                         visit_left        = eq(end_before, left_first),
+                         visit_only_left   = single_node &&  visit_left,
+                         visit_only_right  = single_node && !visit_left;
+
+                    bool all_visit_only_left  = all(visit_only_left || !active),
+                         all_visit_only_right = all(visit_only_right || !active),
+                         all_visit_same_node  = all_visit_only_left || all_visit_only_right;
+
+                    /* If we only need to visit one node, just pick the correct one and continue */
+                    if (all_visit_same_node) {
+                        node = node->left() + (all_visit_only_left ? 0 : 1);
+                        continue;
+                    }
+
+                    size_t left_votes  = count(left_first && active),
+                           right_votes = count(!left_first && active);
+
+                    bool go_left = left_votes >= right_votes;
+
+                    Mask go_left_bcast = Mask(go_left),
+                         correct_order = eq(left_first, go_left_bcast),
+                         visit_both    = !single_node,
+                         visit_cur     = visit_both || eq (visit_left, go_left_bcast),
+                         visit_next    = visit_both || neq(visit_left, go_left_bcast);
+
+                    /* Visit both child nodes in the right order */
+                    Index node_offset = go_left ? 0 : 1;
+                    const KDNode *left   = node->left(),
+                                 *n_cur  = left + node_offset,
+                                 *n_next = left + (1 - node_offset);
+
+                    /* Postpone visit to 'n_next' */
+                    Mask sel0 =  correct_order && visit_both,
+                         sel1 = !correct_order && visit_both;
+                    KDStackEntry& entry = stack[stack_index++];
+                    entry.mint = select(sel0, t_plane, mint);
+                    entry.maxt = select(sel1, t_plane, maxt);
+                    entry.active = active && visit_next;
+                    entry.node = n_next;
+
+                    /* Visit 'n_cur' now */
+                    mint = select(sel1, t_plane, mint);
+                    maxt = select(sel0, t_plane, maxt);
+                    active = active && visit_cur;
+                    node = n_cur;
+                    continue;
+                } else if (node->primitive_count() > 0) { // Arrived at a leaf node
+                    Index prim_start = node->primitive_offset();
+                    Index prim_end = prim_start + node->primitive_count();
+                    for (Index i = prim_start; i < prim_end; i++) {
+                        Index prim_index = indices[i];
+                        hit |= intersect_prim_shadow(prim_index, ray,
+                                                     active && !hit);
+                        if (all(hit || !active))
+                            break;
+                    }
+
+                    /* Every lane is occluded -- no need to unwind the stack */
+                    if (all(hit || !active_orig))
+                        break;
+                }
+            }
+
+            if (likely(stack_index > 0)) {
+                --stack_index;
+                KDStackEntry& entry = stack[stack_index];
+                mint = entry.mint;
+                maxt = entry.maxt;
+                active = entry.active;
+                node = entry.node;
+            } else {
+                break;
+            }
+        }
+
+        return hit;
+    }
+
+    /**
+     * \brief Two-level traversal (see \c kd_two_level)
+     *
+     * Traverses the top-level BVH over shape bounding boxes and intersects
+     * per-shape kd-trees (resp. the analytic shapes themselves) in the
+     * leaves. The subtree of a mesh is built on its first hit, so expensive
+     * per-shape builds are deferred until a shape is actually visible and
+     * naturally run concurrently on the rendering worker threads. The cache
+     * layout matches the monolithic traversal, hence \ref
+     * create_surface_interaction() can be used unchanged.
+     */
+    template <bool ShadowRay>
+    MTS_INLINE std::pair<Mask, Float>
+    ray_intersect_two_level(Ray3f ray, Float *cache, Mask active) const {
+        /// Top-level traversal stack entry
+        struct BVHStackEntry {
+            /// Index of the node to be visited
+            Index index;
+            /// Lanes for which the node bounding box was hit (at push time)
+            Mask active;
+            /// Entry distance into the node bounding box
+            Float mint;
+        };
+
+        BVHStackEntry stack[2 * MTS_KD_MAXDEPTH];
+        int32_t stack_index = 0;
+
+        Mask hit = false;
+        Float hit_t = math::Infinity<Float>;
+
+        if (unlikely(m_top_shapes.empty()))
+            return { hit, hit_t };
+
+        stack[stack_index++] = BVHStackEntry{ Index(0), active, Float(ray.mint) };
+
+        while (stack_index > 0) {
+            BVHStackEntry entry = stack[--stack_index];
+
+            /* Cull nodes that lie entirely behind the closest hits found in
+               the meantime (the mask was computed against a larger ray.maxt
+               and is therefore conservative) */
+            Mask node_active = entry.active && entry.mint <= ray.maxt;
+            if (ShadowRay)
+                node_active = node_active && !hit;
+            if (none(node_active))
+                continue;
+
+            const BVHNode &node = m_top_nodes[entry.index];
+            if (node.count == 0) { // Internal node -- children are adjacent
+                const BVHNode &left  = m_top_nodes[node.offset],
+                              &right = m_top_nodes[node.offset + 1];
+
+                auto [valid_l, mint_l, maxt_l] = left.bbox.ray_intersect(ray);
+                auto [valid_r, mint_r, maxt_r] = right.bbox.ray_intersect(ray);
+
+                Mask active_l = node_active && valid_l &&
+                                mint_l <= ray.maxt && maxt_l >= ray.mint,
+                     active_r = node_active && valid_r &&
+                                mint_r <= ray.maxt && maxt_r >= ray.mint;
+
+                /* Visit the child that is entered first by more lanes
+                   before its sibling */
+                Mask left_near = mint_l <= mint_r;
+                bool left_first;
+                if constexpr (!is_array_v<Float>)
+                    left_first = left_near;
+                else
+                    left_first = count(left_near && node_active) * 2 >=
+                                 count(node_active);
+
+                Index near_offset = left_first ? 0 : 1;
+                Mask active_near = left_first ? active_l : active_r,
+                     active_far  = left_first ? active_r : active_l;
+                Float mint_near  = left_first ? mint_l : mint_r,
+                      mint_far   = left_first ? mint_r : mint_l;
+
+                if (any(active_far))
+                    stack[stack_index++] = BVHStackEntry{
+                        node.offset + (1 - near_offset), active_far,
+                        max(mint_far, Float(ray.mint)) };
+                if (any(active_near))
+                    stack[stack_index++] = BVHStackEntry{
+                        node.offset + near_offset, active_near,
+                        max(mint_near, Float(ray.mint)) };
+            } else { // Leaf node -- intersect the referenced shapes
+                for (Index i = 0; i < node.count; ++i) {
+                    Index shape_index = m_top_shapes[node.offset + i];
+
+                    Mask prim_hit;
+                    Float prim_t;
+                    std::tie(prim_hit, prim_t) = intersect_shape<ShadowRay>(
+                        shape_index, ray, cache, node_active);
+
+                    if constexpr (is_array_v<Float>) {
+                        if (!ShadowRay) {
+                            masked(ray.maxt, prim_hit) = prim_t;
+                            masked(hit_t, prim_hit) = prim_t;
+                        }
+                    } else if (!ShadowRay && prim_hit) {
+                        hit_t = ray.maxt = prim_t;
+                    }
+
+                    hit |= prim_hit;
+                    if (ShadowRay && all(hit || !active))
+                        return { hit, hit_t };
+                }
+            }
+        }
+
+        return { hit, hit_t };
+    }
+
     /**
      * \brief Create a \ref SurfaceInteraction data structure by expanding the
      * temporary information collected during \ref intersect_ray().
@@ -2425,9 +3360,9 @@ protected:
             std::tie(hit, u, v, t) = ((const Mesh *) shape)
                     ->ray_intersect_triangle(prim_index, ray, active);
         else if (ShadowRay)
-            hit = shape->ray_test(ray, active);
+            hit = shape->ray_test(prim_index, ray, active);
         else
-            std::tie(hit, t) = shape->ray_intersect(ray, cache + 2, active);
+            std::tie(hit, t) = shape->ray_intersect(prim_index, ray, cache + 2, active);
 
         if (!ShadowRay && any(hit)) {
             Float shape_index_v = reinterpret_array<Float>(UInt(shape_index));
@@ -2455,9 +3390,148 @@ protected:
         return { hit, t };
     }
 
+    /**
+     * \brief Variant of \ref intersect_prim() for occlusion queries
+     *
+     * Only reports whether the primitive is intersected and skips the
+     * bookkeeping that would later allow recreating a detailed hit record.
+     */
+    MTS_INLINE Mask intersect_prim_shadow(Index prim_index, const Ray3f &ray,
+                                          Mask active) const {
+        Index shape_index  = find_shape(prim_index);
+        const Shape *shape = this->shape(shape_index);
+
+        if (shape->is_mesh())
+            return std::get<0>(((const Mesh *) shape)
+                    ->ray_intersect_triangle(prim_index, ray, active));
+        else
+            return shape->ray_test(prim_index, ray, active);
+    }
+
+    /// Node of the top-level BVH over shape bounding boxes (two-level mode)
+    struct BVHNode {
+        /// Bounds of all shapes below this node
+        ScalarBoundingBox3f bbox;
+        /// Left child (internal nodes) or first entry in \ref m_top_shapes (leaves)
+        Index offset;
+        /// Number of referenced shapes, or 0 for internal nodes
+        Index count;
+    };
+
+    /**
+     * \brief Check whether a top-level shape is intersected by the given ray
+     *
+     * Mesh shapes are intersected through their (lazily built) dedicated
+     * kd-tree, other shapes directly. On a hit, the cache entries of the
+     * affected lanes are overwritten with the same layout that \ref
+     * intersect_prim() produces for the monolithic tree.
+     */
+    template <bool ShadowRay>
+    MTS_INLINE std::pair<Mask, Float>
+    intersect_shape(Index shape_index, const Ray3f &ray, Float *cache,
+                    Mask active) const {
+        using UInt = uint_array_t<Float>;
+
+        const Shape *shape = m_shapes[shape_index];
+
+        Mask hit;
+        Float t = 0.f;
+        Float local[MTS_KD_INTERSECTION_CACHE_SIZE];
+
+        if (shape->is_mesh() || shape->primitive_count() > 1) {
+            const ShapeKDTree *tree = subtree(shape_index);
+            if (ShadowRay)
+                return { tree->ray_test(ray, active), t };
+            std::tie(hit, t) =
+                tree->template ray_intersect<ShadowRay>(ray, local, active);
+        } else if (ShadowRay) {
+            return { shape->ray_test(ray, active), t };
+        } else {
+            std::tie(hit, t) = shape->ray_intersect(ray, local + 2, active);
+            local[1] = reinterpret_array<Float>(UInt(0));
+        }
+
+        if (any(hit)) {
+            Float shape_index_v = reinterpret_array<Float>(UInt(shape_index));
+            if constexpr (!is_array_v<Float>) {
+                cache[0] = shape_index_v;
+                for (int i = 1; i < MTS_KD_INTERSECTION_CACHE_SIZE; ++i)
+                    cache[i] = local[i];
+            } else {
+                masked(cache[0], hit) = shape_index_v;
+                for (int i = 1; i < MTS_KD_INTERSECTION_CACHE_SIZE; ++i)
+                    masked(cache[i], hit) = local[i];
+            }
+        }
+
+        return { hit, t };
+    }
+
+    /**
+     * \brief Return the kd-tree of an individual mesh, building it on the
+     * first request (two-level mode)
+     *
+     * Builds of distinct shapes may proceed concurrently; a per-shape mutex
+     * merely serializes requests for the same not-yet-built tree.
+     */
+    const ShapeKDTree *subtree(Index shape_index) const {
+        ShapeKDTree *tree =
+            m_subtrees[shape_index].load(std::memory_order_acquire);
+        if (likely(tree))
+            return tree;
+
+        std::lock_guard<std::mutex> guard(m_subtree_mutexes[shape_index]);
+        tree = m_subtrees[shape_index].load(std::memory_order_relaxed);
+        if (tree)
+            return tree;
+
+        ref<ShapeKDTree> result = new ShapeKDTree(cost_model());
+        result->set_max_depth(max_depth());
+        result->set_min_max_bins(min_max_bins());
+        result->set_clip_primitives(clip_primitives());
+        result->set_retract_bad_splits(retract_bad_splits());
+        result->set_stop_primitives(stop_primitives());
+        result->set_exact_primitive_threshold(exact_primitive_threshold());
+        result->set_compact_tree(compact_tree());
+        result->set_log_level(Trace);
+        result->add_shape(m_shapes[shape_index]);
+        result->Base::build();
+
+        Log(Debug, "Built kd-tree over shape %i (%i primitives)", shape_index,
+            result->primitive_count());
+
+        result->inc_ref();
+        m_subtrees[shape_index].store(result.get(), std::memory_order_release);
+        return result.get();
+    }
+
+    /// Release all per-shape subtrees (two-level mode)
+    void clear_subtrees();
+
+    /// Construct the top-level BVH over the current shape bounding boxes
+    void build_top_level();
+
+    /// Release the per-shape subtrees, if any
+    virtual ~ShapeKDTree();
+
 protected:
     std::vector<ref<Shape>> m_shapes;
     std::vector<Size> m_primitive_map;
+
+    /// Run in two-level mode? (see \c kd_two_level)
+    bool m_two_level;
+    /// Construct all per-shape kd-trees up front? (see \c kd_eager_build)
+    bool m_eager_build;
+    /// Precompute per-triangle intersection data? (see \c kd_precompute_triangles)
+    bool m_precompute_triangles;
+    /// Flattened nodes of the top-level BVH (two-level mode)
+    std::vector<BVHNode> m_top_nodes;
+    /// Shape indices referenced by the leaves of the top-level BVH
+    std::vector<Index> m_top_shapes;
+    /// Lazily built per-mesh kd-trees, referenced manually (two-level mode)
+    mutable std::unique_ptr<std::atomic<ShapeKDTree *>[]> m_subtrees;
+    /// Guards the lazy construction of the corresponding subtree
+    mutable std::unique_ptr<std::mutex[]> m_subtree_mutexes;
 };
 
 MTS_EXTERN_CLASS_RENDER(ShapeKDTree)
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <mitsuba/core/bbox.h>
+#include <mitsuba/core/object.h>
+#include <mitsuba/render/fwd.h>
+#include <unordered_map>
+#include <vector>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Hierarchical data structure for importance sampling collections of
+ * many light sources
+ *
+ * Uniformly picking an emitter becomes hopelessly noisy once scenes contain
+ * thousands of light sources, since most of them contribute nothing to any
+ * given shading point. This class arranges the scene's emitters into a binary
+ * bounding volume hierarchy whose nodes store the spatial extent and total
+ * radiant power (see \ref Emitter::power_estimate()) of the contained lights.
+ * Sampling stochastically descends the tree, choosing between the two
+ * children in proportion to their power divided by the squared distance to
+ * the reference point, which concentrates samples on nearby and bright
+ * sources.
+ *
+ * The tree is stored in flat arrays so that packet variants can traverse it
+ * with a handful of gather operations per level rather than per-lane pointer
+ * chasing. Emitters without a spatial extent (e.g. environment maps) are
+ * represented by the scene bounding box, which makes their importance
+ * effectively position-independent.
+ *
+ * \remark The hierarchy is traversed on the host and is therefore only
+ * available in scalar and packet variants.
+ */
+template <typename Float, typename Spectrum>
+class MTS_EXPORT_RENDER LightBVH : public Object {
+public:
+    MTS_IMPORT_TYPES(Emitter, EmitterPtr)
+
+    /**
+     * \brief Construct a light hierarchy over the given list of emitters
+     *
+     * \param emitters
+     *    The scene's emitters. Their indices within this list are the ones
+     *    returned by \ref sample_emitter().
+     *
+     * \param scene_bbox
+     *    Bounding box of the entire scene, which serves as a spatial proxy
+     *    for emitters without a finite extent
+     */
+    LightBVH(const host_vector<ref<Emitter>, Float> &emitters,
+             const ScalarBoundingBox3f &scene_bbox);
+
+    /**
+     * \brief Refresh the cached per-node powers and bounding volumes
+     * without rebuilding the tree topology
+     *
+     * Parameter updates that change emitter brightness (interactive
+     * relighting in particular) invalidate the power estimates baked into
+     * the hierarchy, but rarely move lights far enough to degrade the
+     * quality of the existing splits. This bottom-up pass recomputes all
+     * node data in a single linear sweep, which is considerably cheaper
+     * than reconstructing the tree. The emitter list must be the one the
+     * hierarchy was built over.
+     */
+    void refit(const host_vector<ref<Emitter>, Float> &emitters,
+               const ScalarBoundingBox3f &scene_bbox);
+
+    /**
+     * \brief Importance sample an emitter as seen from a reference point
+     *
+     * \param p
+     *    The reference position within the scene
+     *
+     * \param sample
+     *    A uniformly distributed random variate on [0, 1)
+     *
+     * \return
+     *    A tuple consisting of the index of the chosen emitter, the discrete
+     *    probability of having selected it, and the input variate re-scaled
+     *    to [0, 1) for reuse.
+     */
+    std::tuple<UInt32, Float, Float>
+    sample_emitter(const Point3f &p, Float sample, Mask active = true) const;
+
+    /**
+     * \brief Evaluate the discrete probability of selecting the given
+     * emitter from the reference point \c p via \ref sample_emitter()
+     */
+    Float pdf_emitter(const Point3f &p, const EmitterPtr &emitter,
+                      Mask active = true) const;
+
+    /// Return a human-readable string representation
+    virtual std::string to_string() const override;
+
+    MTS_DECLARE_CLASS()
+protected:
+    /// Virtual destructor
+    virtual ~LightBVH();
+
+    struct BuildPrim;
+
+    /// Recursively build the subtree with index \c node over <tt>[begin, end)</tt>
+    void build_node(uint32_t node, BuildPrim *begin, BuildPrim *end,
+                    uint32_t depth, uint32_t trail);
+
+    /// Importance of node \c index as seen from the reference point \c p
+    Float node_importance(const Point3f &p, const UInt32 &index,
+                          const Mask &active) const;
+
+    /// Bounding box and clamped power estimate of a single emitter
+    void emitter_extents(const Emitter *emitter,
+                         const ScalarBoundingBox3f &scene_bbox,
+                         ScalarBoundingBox3f &bbox, ScalarFloat &power) const;
+
+protected:
+    /// Number of entries of \ref m_node_data per node (bbox, power, padding)
+    static constexpr uint32_t NodeStride = 8;
+    /// Maximum number of emitters referenced by a leaf node
+    static constexpr uint32_t LeafSize = 4;
+    /// Maximum tree depth (limited by the 32-bit trail encoding)
+    static constexpr uint32_t MaxDepth = 32;
+
+    /// Bounding box and power of each node, \ref NodeStride entries per node
+    std::vector<ScalarFloat> m_node_data;
+    /// Index of each node's left child (the right child is adjacent), 0 = leaf
+    std::vector<uint32_t> m_node_child;
+    /// First entry of \ref m_prim_index covered by each leaf node
+    std::vector<uint32_t> m_node_offset;
+    /// Number of emitters referenced by each leaf node
+    std::vector<uint32_t> m_node_count;
+
+    /// Emitter indices, reordered so that each leaf covers a contiguous range
+    std::vector<uint32_t> m_prim_index;
+    /// Power estimate corresponding to each entry of \ref m_prim_index
+    std::vector<ScalarFloat> m_prim_power;
+
+    /// Per-emitter sequence of left/right decisions leading to its leaf
+    std::vector<uint32_t> m_trail;
+    /// Maps emitter instances back to their index within the scene
+    std::unordered_map<const Object *, uint32_t> m_emitter_index;
+};
+
+MTS_EXTERN_CLASS_RENDER(LightBVH)
+NAMESPACE_END(mitsuba)
@@ -46,8 +46,42 @@ public:
      *                 The MediumInteraction will always be valid,
      *                 except if the ray missed the Medium's bounding box.
      */
-    MediumInteraction3f sample_interaction(const Ray3f &ray, Float sample,
-                                           UInt32 channel, Mask active) const;
+    virtual MediumInteraction3f sample_interaction(const Ray3f &ray, Float sample,
+                                                   UInt32 channel, Mask active) const;
+
+    /**
+     * \brief Sample a distance in the medium using the equi-angular
+     * distribution anchored at a pivot position
+     *
+     * In contrast to \ref sample_interaction(), the returned distance is
+     * distributed proportional to the inverse squared distance to \c pivot
+     * (typically a position sampled on an emitter), which importance-samples
+     * the geometry term of single scattering towards a light embedded in the
+     * medium. The distribution covers the entire overlap of the ray segment
+     * with the medium, hence the resulting interaction is always valid on
+     * active lanes; integrators must combine this strategy with
+     * transmittance sampling (see \ref pdf_equiangular()) to remain
+     * unbiased.
+     *
+     * \param ray     Ray, along which a distance should be sampled
+     * \param pivot   Anchor position of the equi-angular distribution
+     * \param sample  A uniformly distributed random sample
+     */
+    virtual MediumInteraction3f
+    sample_interaction_equiangular(const Ray3f &ray, const Point3f &pivot,
+                                   Float sample, Mask active) const;
+
+    /**
+     * \brief Evaluate the density of \ref sample_interaction_equiangular()
+     *
+     * Returns the density per unit distance at \c t and the probability of
+     * sampling a distance beyond \c t, both with respect to the overlap of
+     * the ray segment with the medium. The latter weights "escape" events
+     * of a competing distance sampling strategy in an MIS combination.
+     */
+    virtual std::pair<Float, Float>
+    pdf_equiangular(const Ray3f &ray, const Point3f &pivot, Float t,
+                    Mask active) const;
 
     /**
      * \brief Compute the transmittance and PDF
@@ -64,10 +98,37 @@ public:
      * \return   This method returns a pair of (Transmittance, PDF).
      *
      */
-    std::pair<UnpolarizedSpectrum, UnpolarizedSpectrum>
+    virtual std::pair<UnpolarizedSpectrum, UnpolarizedSpectrum>
     eval_tr_and_pdf(const MediumInteraction3f &mi,
                     const SurfaceInteraction3f &si, Mask active) const;
 
+    /**
+     * \brief Stochastically estimate the transmittance along a ray segment
+     *
+     * Estimates the transmittance over the portion of <tt>[ray.mint,
+     * ray.maxt]</tt> that overlaps the medium. In contrast to repeatedly
+     * invoking \ref sample_interaction() and accumulating null-collision
+     * weights, this entry point lets a medium consume the entire segment at
+     * once with a dedicated estimator. Integrators should prefer it for
+     * shadow rays whenever \ref has_dedicated_transmittance() is set.
+     *
+     * The default implementation performs classic ratio tracking against the
+     * majorant returned by \ref get_combined_extinction().
+     */
+    virtual UnpolarizedSpectrum eval_transmittance(const Ray3f &ray,
+                                                   Sampler *sampler,
+                                                   UInt32 channel,
+                                                   Mask active) const;
+
+    /**
+     * \brief Returns whether this medium provides a dedicated transmittance
+     * estimator that integrators should prefer over collision-by-collision
+     * tracking along shadow rays (see \ref eval_transmittance())
+     */
+    MTS_INLINE bool has_dedicated_transmittance() const {
+        return m_dedicated_transmittance;
+    }
+
     /// Return the phase function of this medium
     MTS_INLINE const PhaseFunction *phase_function() const {
         return m_phase_function.get();
@@ -101,6 +162,9 @@ protected:
     ref<PhaseFunction> m_phase_function;
     bool m_sample_emitters, m_is_homogeneous, m_has_spectral_extinction;
 
+    /// Set by subclasses that implement a preferable \ref eval_transmittance()
+    bool m_dedicated_transmittance = false;
+
     /// Identifier (if available)
     std::string m_id;
 };
@@ -121,7 +185,11 @@ ENOKI_CALL_SUPPORT_TEMPLATE_BEGIN(mitsuba::Medium)
     ENOKI_CALL_SUPPORT_METHOD(get_combined_extinction)
     ENOKI_CALL_SUPPORT_METHOD(intersect_aabb)
     ENOKI_CALL_SUPPORT_METHOD(sample_interaction)
+    ENOKI_CALL_SUPPORT_METHOD(sample_interaction_equiangular)
+    ENOKI_CALL_SUPPORT_METHOD(pdf_equiangular)
     ENOKI_CALL_SUPPORT_METHOD(eval_tr_and_pdf)
+    ENOKI_CALL_SUPPORT_METHOD(eval_transmittance)
+    ENOKI_CALL_SUPPORT_METHOD(has_dedicated_transmittance)
     ENOKI_CALL_SUPPORT_METHOD(get_scattering_coefficients)
 ENOKI_CALL_SUPPORT_TEMPLATE_END(mitsuba::Medium)
 
@@ -2,18 +2,48 @@
 
 #include <mitsuba/render/interaction.h>
 #include <mitsuba/render/shape.h>
+#include <mitsuba/core/filesystem.h>
+#include <mitsuba/core/mmap.h>
 #include <mitsuba/core/struct.h>
 #include <mitsuba/core/transform.h>
 #include <mitsuba/core/distr_1d.h>
+#include <mitsuba/core/util.h>
 #include <tbb/spin_mutex.h>
 
 NAMESPACE_BEGIN(mitsuba)
 
+NAMESPACE_BEGIN(detail)
+/** \brief Deleter for mesh geometry buffers, which either own heap memory or
+ * alias a read-only memory mapping (see \ref Mesh::read_cache). Owned buffers
+ * record their size so that their release balances the memory registry. */
+struct MeshBufferDeleter {
+    bool owned = true;
+    size_t size = 0;
+    void operator()(uint8_t *ptr) const {
+        if (owned) {
+            util::untrack_memory("Mesh geometry", size);
+            delete[] ptr;
+        }
+    }
+};
+
+/** \brief Allocate an owning mesh geometry buffer that is registered with
+ * the memory registry and advised to use transparent huge pages */
+inline std::unique_ptr<uint8_t[], MeshBufferDeleter>
+alloc_mesh_buffer(size_t size) {
+    std::unique_ptr<uint8_t[], MeshBufferDeleter> result(
+        new uint8_t[size], MeshBufferDeleter{ true, size });
+    util::track_memory("Mesh geometry", size);
+    util::advise_huge_pages(result.get(), size);
+    return result;
+}
+NAMESPACE_END(detail)
+
 template <typename Float, typename Spectrum>
 class MTS_EXPORT_RENDER Mesh : public Shape<Float, Spectrum> {
 public:
     MTS_IMPORT_TYPES()
-    MTS_IMPORT_BASE(Shape, m_mesh)
+    MTS_IMPORT_BASE(Shape, m_mesh, mark_dirty)
 
     using InputFloat = float;
     using InputPoint3f  = Point<InputFloat, 3>;
@@ -24,8 +54,8 @@ public:
     using typename Base::ScalarSize;
     using typename Base::ScalarIndex;
 
-    using FaceHolder   = std::unique_ptr<uint8_t[]>;
-    using VertexHolder = std::unique_ptr<uint8_t[]>;
+    using FaceHolder   = std::unique_ptr<uint8_t[], detail::MeshBufferDeleter>;
+    using VertexHolder = std::unique_ptr<uint8_t[], detail::MeshBufferDeleter>;
 
     /// Create a new mesh with the given vertex and face data structures
     Mesh(const std::string &name,
@@ -121,16 +151,54 @@ public:
 #endif
     }
 
+    /** \brief Returns the shutter-close position of the vertex with index
+     * \c index (only valid when \ref has_vertex_motion() is set)
+     */
+    template <typename Index>
+    MTS_INLINE auto vertex_position_end(Index index, mask_t<Index> active = true) const {
+        using Index3 = Array<Index, 3>;
+        using Result = Point<replace_scalar_t<Index, InputFloat>, 3>;
+        ENOKI_MARK_USED(active);
+
+        const InputFloat *base = (const InputFloat *) m_vertex_positions_end.get();
+        if constexpr (!is_array_v<Index>) {
+            return load_unaligned<Result>(base + 3 * (size_t) index);
+        } else {
+            // Deformation motion blur is restricted to the CPU rendering modes
+            index *= 3u;
+            return gather<Result, sizeof(InputFloat)>(
+                base, Index3(index, index + 1u, index + 2u), active);
+        }
+    }
+
+    /** \brief Map a ray time to the interpolation weight between the two
+     * vertex motion samples (clamped outside of the sampled interval)
+     */
+    template <typename Value>
+    MTS_INLINE Value motion_weight(const Value &time) const {
+        return clamp((time - m_motion_time_begin) * m_inv_motion_span, 0.f, 1.f);
+    }
+
     /// Returns the normal direction of the vertex with index \c index
     template <typename Index>
     MTS_INLINE auto vertex_normal(Index index, mask_t<Index> active = true) const {
         using Index3 = Array<Index, 3>;
+        using UInt32 = uint32_array_t<Index>;
         using Result = Normal<replace_scalar_t<Index, InputFloat>, 3>;
         ENOKI_MARK_USED(active);
 
         if constexpr (!is_array_v<Index>) {
+            if (unlikely(m_compressed_normals))
+                return Result(octahedral_decode(
+                    load_unaligned<UInt32>(vertex(index) + m_normal_offset)));
             return load_unaligned<Result>(vertex(index) + m_normal_offset);
         } else if constexpr (!is_cuda_array_v<Index>) {
+            if (unlikely(m_compressed_normals)) {
+                UInt32 bits = gather<UInt32, sizeof(uint32_t)>(
+                    m_vertices.get() + m_normal_offset,
+                    index * (m_vertex_size / ScalarSize(sizeof(uint32_t))), active);
+                return Result(octahedral_decode(bits));
+            }
             index *= m_vertex_size / ScalarSize(sizeof(InputFloat));
             return gather<Result, sizeof(InputFloat)>(
                 m_vertices.get() + m_normal_offset, Index3(index, index + 1u, index + 2u), active);
@@ -145,12 +213,22 @@ public:
     /// Returns the UV texture coordinates of the vertex with index \c index
     template <typename Index>
     MTS_INLINE auto vertex_texcoord(Index index, mask_t<Index> active = true) const {
+        using UInt32 = uint32_array_t<Index>;
         using Result = Point<replace_scalar_t<Index, InputFloat>, 2>;
         ENOKI_MARK_USED(active);
 
         if constexpr (!is_array_v<Index>) {
+            if (unlikely(m_compressed_texcoords))
+                return Result(float16_decode(
+                    load_unaligned<UInt32>(vertex(index) + m_texcoord_offset)));
             return load_unaligned<Result>(vertex(index) + m_texcoord_offset);
         } else if constexpr (!is_cuda_array_v<Index>) {
+            if (unlikely(m_compressed_texcoords)) {
+                UInt32 bits = gather<UInt32, sizeof(uint32_t)>(
+                    m_vertices.get() + m_texcoord_offset,
+                    index * (m_vertex_size / ScalarSize(sizeof(uint32_t))), active);
+                return Result(float16_decode(bits));
+            }
             index *= m_vertex_size / ScalarSize(sizeof(InputFloat));
             return gather<Result, sizeof(InputFloat)>(
                 m_vertices.get() + m_texcoord_offset, Array<Index, 2>(index, index + 1u), active);
@@ -183,18 +261,173 @@ public:
     /// Does this mesh have per-vertex texture colors?
     bool has_vertex_colors() const { return m_color_offset != 0; }
 
+    /// Is this mesh displaced by a displacement map? (see \ref m_displacement)
+    bool has_displacement() const { return (bool) m_displacement; }
+
+    /// Does this mesh carry a second vertex position sample for deformation motion blur?
+    bool has_vertex_motion() const { return (bool) m_vertex_positions_end; }
+
+    /// @}
+    // =========================================================================
+
+    // =========================================================================
+    //! @{ \name Compressed vertex attribute storage
+    // =========================================================================
+
+    /**
+     * \brief Re-encode vertex normals and texture coordinates in a compact
+     * in-memory representation
+     *
+     * Vertex normals are mapped to two 16-bit integers using an octahedral
+     * parameterization, and texture coordinates are stored in half precision.
+     * This shrinks a vertex carrying both attributes from 32 to 20 bytes,
+     * which reduces resident memory and improves the cache behavior of
+     * traversal-heavy workloads on large meshes. The \ref vertex_normal()
+     * and \ref vertex_texcoord() accessors decode the representation on the
+     * fly; other vertex fields (positions, colors) are left untouched.
+     *
+     * Invoked by the mesh loaders when the \c compress_attributes property
+     * is set. Not supported in GPU modes.
+     */
+    void compress_vertex_attributes();
+
+    /// Are vertex normals stored in the compressed representation?
+    bool has_compressed_normals() const { return m_compressed_normals; }
+
+    /// Are texture coordinates stored in the compressed representation?
+    bool has_compressed_texcoords() const { return m_compressed_texcoords; }
+
+    /// Decode an octahedral-mapped unit vector stored as two 16-bit integers
+    template <typename UInt32>
+    static MTS_INLINE auto octahedral_decode(UInt32 bits) {
+        using Value = replace_scalar_t<UInt32, InputFloat>;
+
+        Value u = fmadd(Value(bits & 0xFFFFu), 2.f / 65535.f, -1.f),
+              v = fmadd(Value(bits >> 16),     2.f / 65535.f, -1.f),
+              z = 1.f - abs(u) - abs(v),
+              t = max(-z, 0.f);
+
+        // Undo the fold that mapped the lower hemisphere to the outer triangles
+        u -= copysign(t, u);
+        v -= copysign(t, v);
+
+        return normalize(Normal<Value, 3>(u, v, z));
+    }
+
+    /// Decode a pair of half precision values stored in a 32-bit word
+    template <typename UInt32>
+    static MTS_INLINE auto float16_decode(UInt32 bits) {
+        using Value = replace_scalar_t<UInt32, InputFloat>;
+
+        auto single = [](UInt32 h) {
+            /* Move the exponent/mantissa bits into place and rescale to
+               account for the different exponent bias; subnormal halves
+               become normal single precision values in the process */
+            Value f = reinterpret_array<Value>((h & 0x7FFFu) << 13) *
+                      Value(0x1p+112f);
+            return reinterpret_array<Value>(reinterpret_array<UInt32>(f) |
+                                            ((h & 0x8000u) << 16));
+        };
+
+        return Point<Value, 2>(single(bits & 0xFFFFu), single(bits >> 16));
+    }
+
     /// @}
     // =========================================================================
 
     /// Export mesh using the file format implemented by the subclass
     virtual void write(Stream *stream) const;
 
+    // =========================================================================
+    //! @{ \name Binary mesh cache
+    // =========================================================================
+
+    /**
+     * \brief Attempt to initialize the mesh from a binary cache file
+     *
+     * Mesh loaders (OBJ, PLY) can optionally snapshot their vertex and face
+     * buffers in the final \c Struct layout after the first load, so that
+     * subsequent invocations skip parsing entirely. The cache is versioned
+     * and keyed by \c source_hash, which must cover the source file contents
+     * and any loader settings that affect the in-memory layout.
+     *
+     * \return \c true if the cache file exists, matches \c source_hash, and
+     *    was read successfully
+     */
+    bool read_cache(const fs::path &path, size_t source_hash);
+
+    /// Write a binary snapshot of the mesh for use with \ref read_cache()
+    void write_cache(const fs::path &path, size_t source_hash) const;
+
+    /**
+     * \brief Drop resident pages of out-of-core geometry
+     *
+     * When the mesh was loaded with the \c out_of_core property, the vertex
+     * and face buffers alias a read-only mapping of the binary cache file
+     * and page in lazily on first access. This function advises the OS that
+     * the resident pages are no longer needed; subsequent accesses fault
+     * them back in transparently. A no-op for regular heap-backed meshes.
+     */
+    void evict_geometry() const;
+
+    /// Content hash used to key binary mesh cache files
+    static size_t cache_hash(const uint8_t *data, size_t size);
+
+    /// @}
+    // =========================================================================
+
     /// Compute smooth vertex normals and replace the current normal values
     void recompute_vertex_normals();
 
     /// Recompute the bounding box (e.g. after modifying the vertex positions)
     void recompute_bbox();
 
+    /**
+     * \brief Reorder faces and vertices for traversal locality
+     *
+     * Sorts the faces along a Morton curve over their centroids, so that
+     * triangles that are close in space -- and hence end up in nearby
+     * acceleration structure leaves -- are also close in memory, and then
+     * re-indexes the vertices in first-use order of the clustered face
+     * sequence, so that neighboring triangles reference neighboring vertex
+     * records. Requested at load time via the ``reorder`` mesh property.
+     */
+    void reorder_layout();
+
+    // =========================================================================
+    //! @{ \name Deformation motion blur
+    // =========================================================================
+
+    /**
+     * \brief Attach a second vertex position sample for deformation motion blur
+     *
+     * Copies the vertex positions of \c end_state, which must have the same
+     * vertex and face counts (and ordering) as this mesh, into a packed
+     * shutter-close position buffer. Intersections then interpolate the two
+     * samples by the ray time, mapped to <tt>[time_begin, time_end]</tt> and
+     * clamped outside of it, and the bounds reported to the acceleration
+     * data structures are expanded over both samples. Unlike the rigid
+     * motion expressible with \ref AnimatedTransform, this supports
+     * per-vertex deformation (e.g. baked character animation).
+     */
+    void attach_vertex_motion(const Mesh *end_state, ScalarFloat time_begin,
+                              ScalarFloat time_end);
+
+    /**
+     * \brief Load the shutter-close motion sample requested by the mesh
+     * properties, if any
+     *
+     * Invoked by the mesh loaders at the end of construction: when the
+     * \c filename_end property is set, the referenced file is loaded through
+     * the same plugin and handed to \ref attach_vertex_motion() together
+     * with the \c motion_time_begin / \c motion_time_end properties.
+     * Not supported in GPU modes.
+     */
+    void load_vertex_motion(const Properties &props);
+
+    /// @}
+    // =========================================================================
+
     // =============================================================
     //! @{ \name Shape interface implementation
     // =============================================================
@@ -215,6 +448,34 @@ public:
 
     virtual Float pdf_position(const PositionSample3f &ps, Mask active = true) const override;
 
+    /** \brief Solid-angle direction sampling (see \c solid_angle_sampling)
+     *
+     * When the \c solid_angle_sampling property is set, this selects a
+     * triangle proportional to surface area and then samples a direction
+     * uniformly within its subtended solid angle using the stratified
+     * spherical triangle warp of Arvo (SIGGRAPH 1995), which avoids the
+     * <tt>distance^2 / cos</tt> variance of area sampling for emitters close
+     * to the receiver. Falls back to the default area sampling of \ref
+     * Shape::sample_direction() when the property is not set, or per-lane
+     * when the spherical triangle degenerates (reference point close to the
+     * triangle plane).
+     */
+    virtual DirectionSample3f sample_direction(const Interaction3f &it,
+                                               const Point2f &sample,
+                                               Mask active = true) const override;
+
+    /** \brief Density of \ref sample_direction() in the solid angle measure
+     *
+     * A direction can lie within the solid angle of several triangles (e.g.
+     * the front and back side of a closed fixture), whose densities must be
+     * accumulated for consistent multiple importance sampling -- the
+     * evaluation therefore visits every face, restricting the feature to
+     * small emissive meshes.
+     */
+    virtual Float pdf_direction(const Interaction3f &it,
+                                const DirectionSample3f &ds,
+                                Mask active = true) const override;
+
     virtual void fill_surface_interaction(const Ray3f &ray,
                                           const Float *cache,
                                           SurfaceInteraction3f &si,
@@ -243,12 +504,25 @@ public:
     MTS_INLINE std::tuple<Mask, Float, Float, Float>
     ray_intersect_triangle(const ScalarIndex &index, const Ray3f &ray,
                            identity_t<Mask> active = true) const {
+        if (unlikely(has_displacement()))
+            return ray_intersect_triangle_displaced(index, ray, active);
+
+        if (has_intersection_data())
+            return ray_intersect_triangle_precomputed(index, ray, active);
+
         auto fi = face_indices(index);
 
         Point3f p0 = vertex_position(fi[0]),
                 p1 = vertex_position(fi[1]),
                 p2 = vertex_position(fi[2]);
 
+        if (unlikely(has_vertex_motion())) {
+            Float w = motion_weight(ray.time);
+            p0 += (Point3f(vertex_position_end(fi[0])) - p0) * w;
+            p1 += (Point3f(vertex_position_end(fi[1])) - p1) * w;
+            p2 += (Point3f(vertex_position_end(fi[2])) - p2) * w;
+        }
+
         Vector3f e1 = p1 - p0, e2 = p2 - p0;
 
         Vector3f pvec = cross(ray.d, e2);
@@ -268,6 +542,70 @@ public:
         return { active, u, v, t };
     }
 
+    /** \brief Ray intersection against the displaced version of a triangle
+     *
+     * Intersects the ray against an on-the-fly micro-tessellation of the base
+     * triangle, whose grid vertices are offset along the interpolated shading
+     * normal by the \c displacement texture (see \ref m_displacement). The
+     * returned \c u and \c v are barycentric coordinates with respect to the
+     * base triangle, so that downstream attribute interpolation works
+     * unchanged. Micro-tessellations are cached in a bounded LRU cache.
+     */
+    std::tuple<Mask, Float, Float, Float>
+    ray_intersect_triangle_displaced(const ScalarIndex &index, const Ray3f &ray,
+                                     Mask active = true) const;
+
+    /** \brief Ray-triangle intersection test using precomputed plane and
+     * edge equations (see \ref build_intersection_data)
+     *
+     * Evaluates the stored triangle plane to obtain \c t and then two
+     * barycentric edge equations at the plane hit point, replacing the two
+     * cross products of the Moeller-Trumbore test in \ref
+     * ray_intersect_triangle with dot products against precomputed rows.
+     * Since \c u and \c v are computed with inclusive comparisons from the
+     * exact plane hit point rather than through a rounded reciprocal
+     * determinant, rays that graze a shared edge are accepted instead of
+     * falling through the crack between the adjacent triangles.
+     */
+    MTS_INLINE std::tuple<Mask, Float, Float, Float>
+    ray_intersect_triangle_precomputed(const ScalarIndex &index, const Ray3f &ray,
+                                       identity_t<Mask> active = true) const {
+        const InputFloat *data = (const InputFloat *) m_intersection_data.get()
+                                 + 12 * (size_t) index;
+
+        Vector3f n(data[0], data[1], data[2]);
+        Float t = (data[3] - dot(n, Vector3f(ray.o))) * rcp(dot(n, ray.d));
+        active &= t >= ray.mint && t <= ray.maxt;
+
+        Point3f p = ray(t);
+        Float u = dot(Vector3f(data[4], data[5], data[6]),  Vector3f(p)) + data[7],
+              v = dot(Vector3f(data[8], data[9], data[10]), Vector3f(p)) + data[11];
+        active &= u >= 0.f && v >= 0.f && u + v <= 1.f;
+
+        return { active, u, v, t };
+    }
+
+    /**
+     * \brief Precompute per-triangle intersection data
+     *
+     * Stores a plane equation and two barycentric edge equations (12 floats,
+     * i.e. 48 bytes per triangle) so that candidate tests during traversal
+     * (see \ref ray_intersect_triangle_precomputed) avoid re-deriving edge
+     * vectors and cross products from the indexed vertex buffers. Candidate
+     * testing is the hottest part of traversal after node stepping, making
+     * the extra memory a worthwhile trade on most scenes; the table is
+     * therefore opt-in via the \c kd_precompute_triangles scene property.
+     *
+     * A no-op for displaced meshes, which are intersected through their
+     * micro-tessellations, and for meshes with deformation motion blur,
+     * whose vertex positions are time-dependent. Rebuilt automatically when
+     * the vertex positions change (see \ref parameters_changed).
+     */
+    void build_intersection_data();
+
+    /// Was \ref build_intersection_data() invoked on this mesh?
+    bool has_intersection_data() const { return (bool) m_intersection_data; }
+
     void traverse(TraversalCallback *callback) override;
 
     void parameters_changed() override;
@@ -308,6 +646,28 @@ protected:
             const_cast<Mesh *>(this)->area_distr_build();
     }
 
+    /**
+     * \brief Micro-tessellation of a displaced base triangle
+     *
+     * Stores the displaced positions of a triangular grid with
+     * <tt>res + 1</tt> vertices per edge, laid out row by row: vertex
+     * <tt>(i, j)</tt> corresponds to barycentric coordinates
+     * <tt>(i / res, j / res)</tt> with <tt>i + j <= res</tt>.
+     */
+    struct MicroMesh {
+        uint32_t res;
+        std::vector<ScalarPoint3f> vertices;
+    };
+
+    /// Bounded LRU cache of micro-tessellations (defined in mesh.cpp)
+    struct DisplacementCache;
+
+    /// Return the micro-tessellation of the given triangle, building it if needed
+    std::shared_ptr<const MicroMesh> micro_mesh(ScalarIndex index) const;
+
+    /// Evaluate the displacement map at the given surface position
+    ScalarFloat eval_displacement(const ScalarPoint2f &uv) const;
+
     MTS_DECLARE_CLASS()
 protected:
     VertexHolder m_vertices;
@@ -355,6 +715,79 @@ protected:
     /// Flag that can be set by the user to disable loading/computation of vertex normals
     bool m_disable_vertex_normals = false;
 
+    /// Request from the user to invoke \ref compress_vertex_attributes() after loading
+    bool m_compress_attributes = false;
+
+    /// Request from the user to invoke \ref reorder_layout() after loading
+    bool m_reorder = false;
+
+    /// Sample emitted directions by solid angle? (see \ref sample_direction)
+    bool m_solid_angle_sampling = false;
+
+    /// Back the geometry buffers by a mapping of the binary cache file
+    bool m_out_of_core = false;
+
+    /// Keeps the cache file mapping alive when loaded out of core
+    ref<MemoryMappedFile> m_mmap;
+
+    /// Normals are stored octahedral-encoded (see \ref compress_vertex_attributes)
+    bool m_compressed_normals = false;
+
+    /// Texture coordinates are stored in half precision
+    bool m_compressed_texcoords = false;
+
+    /** \brief Optional shutter-close vertex positions for deformation motion
+     * blur (packed, 3 floats per vertex)
+     *
+     * When present, the positions stored in \ref m_vertices correspond to
+     * \ref m_motion_time_begin and this buffer to \ref m_motion_time_end;
+     * intersections interpolate linearly in between. See \ref
+     * attach_vertex_motion().
+     */
+    VertexHolder m_vertex_positions_end;
+
+    /// Time associated with the vertex positions in \ref m_vertices
+    ScalarFloat m_motion_time_begin = 0.f;
+
+    /// Time associated with the positions in \ref m_vertex_positions_end
+    ScalarFloat m_motion_time_end = 0.f;
+
+    /// Precomputed reciprocal of the motion time span
+    ScalarFloat m_inv_motion_span = 0.f;
+
+    /** \brief Optional precomputed triangle intersection data
+     *
+     * Packed array of 12 floats per triangle -- the plane equation
+     * <tt>(n, d)</tt> followed by two rows <tt>(a, b)</tt> that evaluate the
+     * barycentric coordinates as <tt>dot(a, p) + b</tt> at a point \c p on
+     * the plane. See \ref build_intersection_data().
+     */
+    VertexHolder m_intersection_data;
+
+    /**
+     * \brief Optional displacement map
+     *
+     * When set, rays are intersected against an on-the-fly micro-tessellation
+     * of each triangle that is offset along the interpolated shading normal
+     * by <tt>m_displacement_scale</tt> times the texture value, rather than
+     * against the flat base triangle. Bounding boxes reported to the
+     * acceleration data structures are padded conservatively by the maximum
+     * displacement magnitude.
+     */
+    ref<Texture> m_displacement;
+
+    /// Scale factor applied to values of \ref m_displacement
+    ScalarFloat m_displacement_scale = 1.f;
+
+    /// Micro-tessellation grid resolution per triangle edge
+    uint32_t m_displacement_res = 8;
+
+    /// Maximum number of cached micro-tessellations
+    size_t m_displacement_cache_capacity = 65536;
+
+    /// Bounded LRU cache of micro-tessellations (lazily initialized)
+    mutable std::unique_ptr<DisplacementCache> m_displacement_cache;
+
     /* Surface area distribution -- generated on demand when \ref
        prepare_area_distr() is first called. */
     DiscreteDistribution<Float> m_area_distr;
@@ -37,6 +37,133 @@ MTS_INLINE std::ostream &operator<<(std::ostream &os, MicrofacetType tp) {
     return os;
 }
 
+/**
+ * \brief Visible normal sampling inversion for the Beckmann distribution
+ * (alpha=1 configuration)
+ *
+ * The original inversion routine from the paper contained discontinuities,
+ * which causes issues for QMC integration and techniques like Kelemen-style
+ * MLT. The following code performs a numerical inversion with better behavior.
+ */
+template <typename Value>
+Vector<Value, 2> beckmann_sample_visible_11(Value cos_theta_i,
+                                            Point<Value, 2> sample) {
+    constexpr auto InvSqrtPi = math::InvSqrtPi<scalar_t<Value>>;
+
+    Value tan_theta_i =
+        safe_sqrt(fnmadd(cos_theta_i, cos_theta_i, 1.f)) /
+        cos_theta_i;
+    Value cot_theta_i = rcp(tan_theta_i);
+
+    /* Search interval -- everything is parameterized
+       in the erf() domain */
+    Value maxval = erf(cot_theta_i);
+
+    /* Start with a good initial guess (analytic solution for
+       theta_i = pi/2, which is the most nonlinear case) */
+    sample = max(min(sample, 1.f - 1e-6f), 1e-6f);
+    Value x = maxval - (maxval + 1.f) * erf(sqrt(-log(sample.x())));
+
+    // Normalization factor for the CDF
+    sample.x() *= 1.f + maxval + InvSqrtPi *
+                  tan_theta_i * exp(-sqr(cot_theta_i));
+
+    // Three Newton iterations
+    ENOKI_NOUNROLL for (size_t i = 0; i < 3; ++i) {
+        Value slope = erfinv(x),
+              value = 1.f + x + InvSqrtPi * tan_theta_i *
+                      exp(-sqr(slope)) - sample.x(),
+              derivative = 1.f - slope * tan_theta_i;
+
+        x -= value / derivative;
+    }
+
+    // Now convert back into a slope value
+    return erfinv(Vector<Value, 2>(x, fmsub(2.f, sample.y(), 1.f)));
+}
+
+/**
+ * \brief Precomputed inversion table for Beckmann visible normal sampling
+ *
+ * The numerical inversion performed by \ref beckmann_sample_visible_11()
+ * evaluates several erf/erfinv calls per sample. This table discretizes the
+ * resulting slopes over the incidence angle and the two sample dimensions,
+ * replacing the inversion by a bilinear fetch (resp. a linear fetch for the
+ * second slope component, which only depends on one sample dimension).
+ *
+ * Since the inversion operates in the stretched configuration (alpha=1), the
+ * table is independent of the surface roughness and can be shared by all
+ * lookups of a plugin -- including spatially varying roughness values.
+ */
+template <typename Float> struct BeckmannVisibleTable {
+    using ScalarFloat = scalar_t<Float>;
+    using UInt32      = uint32_array_t<Float>;
+    using Vector2f    = Vector<Float, 2>;
+    using Point2f     = Point<Float, 2>;
+
+    /// Table resolution along the incidence angle and sample dimensions
+    static constexpr uint32_t CosRes = 64, SampleRes = 64;
+
+    BeckmannVisibleTable() {
+        using ScalarPoint2f = Point<ScalarFloat, 2>;
+
+        m_slope_x.resize(CosRes * SampleRes);
+        m_slope_y.resize(SampleRes);
+
+        for (uint32_t i = 0; i < CosRes; ++i) {
+            /* Nudge the most grazing node away from zero, where the
+               inversion degenerates */
+            ScalarFloat cos_theta =
+                max(i / ScalarFloat(CosRes - 1), ScalarFloat(1e-2f));
+
+            for (uint32_t j = 0; j < SampleRes; ++j) {
+                ScalarFloat u = j / ScalarFloat(SampleRes - 1);
+                m_slope_x[i * SampleRes + j] =
+                    beckmann_sample_visible_11(cos_theta,
+                                               ScalarPoint2f(u, .5f)).x();
+            }
+        }
+
+        for (uint32_t j = 0; j < SampleRes; ++j) {
+            ScalarFloat u = clamp(j / ScalarFloat(SampleRes - 1),
+                                  ScalarFloat(1e-6f),
+                                  ScalarFloat(1.f - 1e-6f));
+            m_slope_y[j] = erfinv(fmsub(ScalarFloat(2), u, ScalarFloat(1)));
+        }
+    }
+
+    /// Interpolated table fetch replacing the two slope inversions
+    Vector2f sample(Float cos_theta_i, const Point2f &sample) const {
+        Float ct = clamp(cos_theta_i, 0.f, 1.f) * ScalarFloat(CosRes - 1),
+              ux = sample.x() * ScalarFloat(SampleRes - 1),
+              uy = sample.y() * ScalarFloat(SampleRes - 1);
+
+        UInt32 ct0 = min(UInt32(ct), uint32_t(CosRes - 2)),
+               ux0 = min(UInt32(ux), uint32_t(SampleRes - 2)),
+               uy0 = min(UInt32(uy), uint32_t(SampleRes - 2));
+
+        Float wct = ct - Float(ct0),
+              wux = ux - Float(ux0),
+              wuy = uy - Float(uy0);
+
+        UInt32 index = ct0 * uint32_t(SampleRes) + ux0;
+
+        Float v00 = gather<Float>(m_slope_x.data(), index),
+              v01 = gather<Float>(m_slope_x.data(), index + 1u),
+              v10 = gather<Float>(m_slope_x.data(), index + uint32_t(SampleRes)),
+              v11 = gather<Float>(m_slope_x.data(), index + uint32_t(SampleRes + 1));
+
+        Float slope_x = lerp(lerp(v00, v01, wux), lerp(v10, v11, wux), wct),
+              slope_y = lerp(gather<Float>(m_slope_y.data(), uy0),
+                             gather<Float>(m_slope_y.data(), uy0 + 1u), wuy);
+
+        return Vector2f(slope_x, slope_y);
+    }
+
+private:
+    std::vector<ScalarFloat> m_slope_x, m_slope_y;
+};
+
 /**
  * \brief Implementation of the Beckman and GGX / Trowbridge-Reitz microfacet
  * distributions and various useful sampling routines
@@ -357,41 +484,12 @@ public:
     /// \brief Visible normal sampling code for the alpha=1 case
     Vector2f sample_visible_11(Float cos_theta_i, Point2f sample) const {
         if (m_type == MicrofacetType::Beckmann) {
-            /* The original inversion routine from the paper contained
-               discontinuities, which causes issues for QMC integration
-               and techniques like Kelemen-style MLT. The following code
-               performs a numerical inversion with better behavior */
-
-            Float tan_theta_i =
-                safe_sqrt(fnmadd(cos_theta_i, cos_theta_i, 1.f)) /
-                cos_theta_i;
-            Float cot_theta_i = rcp(tan_theta_i);
-
-            /* Search interval -- everything is parameterized
-               in the erf() domain */
-            Float maxval = erf(cot_theta_i);
-
-            /* Start with a good initial guess (analytic solution for
-               theta_i = pi/2, which is the most nonlinear case) */
-            sample = max(min(sample, 1.f - 1e-6f), 1e-6f);
-            Float x = maxval - (maxval + 1.f) * erf(sqrt(-log(sample.x())));
-
-            // Normalization factor for the CDF
-            sample.x() *= 1.f + maxval + InvSqrtPi *
-                          tan_theta_i * exp(-sqr(cot_theta_i));
-
-            // Three Newton iterations
-            ENOKI_NOUNROLL for (size_t i = 0; i < 3; ++i) {
-                Float slope = erfinv(x),
-                      value = 1.f + x + InvSqrtPi * tan_theta_i *
-                              exp(-sqr(slope)) - sample.x(),
-                      derivative = 1.f - slope * tan_theta_i;
-
-                x -= value / derivative;
-            }
+            /* An optional precomputed inversion table replaces the
+               erfinv-heavy numerical inversion */
+            if (unlikely(m_visible_table))
+                return m_visible_table->sample(cos_theta_i, sample);
 
-            // Now convert back into a slope value
-            return erfinv(Vector2f(x, fmsub(2.f, sample.y(), 1.f)));
+            return beckmann_sample_visible_11(cos_theta_i, sample);
         } else {
             // Choose a projection direction and re-scale the sample
             Point2f p = warp::square_to_uniform_disk_concentric(sample);
@@ -411,6 +509,18 @@ public:
     }
 
 
+    /**
+     * \brief Use a precomputed inversion table for Beckmann visible normal
+     * sampling (see \ref BeckmannVisibleTable)
+     *
+     * The caller retains ownership of the table, which must outlive this
+     * instance. Ignored for the GGX distribution, whose sampling routine is
+     * already branch-free and cheap.
+     */
+    void set_visible_table(const BeckmannVisibleTable<Float> *table) {
+        m_visible_table = table;
+    }
+
 protected:
     void configure() {
         m_alpha_u = max(m_alpha_u, 1e-4f);
@@ -432,6 +542,7 @@ protected:
     MicrofacetType m_type;
     Float m_alpha_u, m_alpha_v;
     bool  m_sample_visible;
+    const BeckmannVisibleTable<Float> *m_visible_table = nullptr;
 };
 
 template <typename Float, typename Spectrum>
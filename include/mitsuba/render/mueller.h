@@ -38,6 +38,23 @@ template <typename Float> MuellerMatrix<Float> depolarizer(Float value = 1.f) {
     return result;
 }
 
+/**
+ * \brief Check whether the given Mueller matrix only scales the first Stokes
+ * component, i.e. whether it acts as an ideal depolarizer
+ *
+ * Most non-specular BSDFs produce matrices of this form, which are invariant
+ * under a change of Stokes bases -- the rotation kernels below use this
+ * property as a fast path.
+ */
+template <typename Float>
+auto is_depolarizer(const MuellerMatrix<Float> &M) {
+    auto result = eq(M(0, 1), 0.f) && eq(M(0, 2), 0.f) && eq(M(0, 3), 0.f);
+    for (size_t i = 1; i < 4; ++i)
+        for (size_t j = 0; j < 4; ++j)
+            result = result && eq(M(i, j), 0.f);
+    return result;
+}
+
 /**
 * \brief Constructs the Mueller matrix of an ideal absorber
 *
@@ -135,26 +152,58 @@ template <typename Float> MuellerMatrix<Float> rotator(Float theta) {
 /**
   * \brief Applies a counter-clockwise rotation to the mueller matrix
   * of a given element.
+  *
+  * The two dense 4x4 multiplies of <tt>Rt * M * R</tt> are fused into a
+  * handful of 2-element linear combinations by exploiting the sparsity of
+  * the rotator (only the second and third row/column mix).
   */
 template <typename Float>
 MuellerMatrix<Float> rotated_element(Float theta,
                                      const MuellerMatrix<Float> &M) {
-    MuellerMatrix<Float> R = rotator(theta), Rt = transpose(R);
-    return Rt * M * R;
+    using Vector4 = value_t<MuellerMatrix<Float>>;
+
+    Float s, c;
+    std::tie(s, c) = sincos(2.f * theta);
+
+    // A = M * R
+    Vector4 a0 = M.coeff(0),
+            a1 = c * M.coeff(1) - s * M.coeff(2),
+            a2 = s * M.coeff(1) + c * M.coeff(2),
+            a3 = M.coeff(3);
+
+    // Rt * A, applied row-wise to each column
+    auto rotate_rows = [](Float s_, Float c_, const Vector4 &a) {
+        return Vector4(a.x(),
+                       c_ * a.y() - s_ * a.z(),
+                       s_ * a.y() + c_ * a.z(),
+                       a.w());
+    };
+
+    MuellerMatrix<Float> result;
+    result.coeff(0) = rotate_rows(s, c, a0);
+    result.coeff(1) = rotate_rows(s, c, a1);
+    result.coeff(2) = rotate_rows(s, c, a2);
+    result.coeff(3) = rotate_rows(s, c, a3);
+    return result;
 }
 
 /**
  * \brief Reverse direction of propagation of the electric field. Also used for
  * reflecting reference frames.
+ *
+ * Equivalent to multiplication by <tt>diag(1, 1, -1, -1)</tt> from the left,
+ * i.e. a negation of the third and fourth row.
  */
 template <typename Float>
 MuellerMatrix<Float> reverse(const MuellerMatrix<Float> &M) {
-    return MuellerMatrix<Float>(
-        1, 0,  0,  0,
-        0, 1,  0,  0,
-        0, 0, -1,  0,
-        0, 0,  0, -1
-    ) * M;
+    using Vector4 = value_t<MuellerMatrix<Float>>;
+
+    MuellerMatrix<Float> result;
+    for (size_t j = 0; j < 4; ++j) {
+        Vector4 m = M.coeff(j);
+        result.coeff(j) = Vector4(m.x(), m.y(), -m.z(), -m.w());
+    }
+    return result;
 }
 
 /**
@@ -261,6 +310,33 @@ Vector3 stokes_basis(const Vector3 &w) {
     return s;
 }
 
+/**
+ * \brief Computes the signed rotation angle between two Stokes bases
+ *
+ * This is the angle used by \ref rotate_stokes_basis(); it is exposed
+ * separately so that the fused rotation kernels below can evaluate the
+ * rotator entries directly instead of forming sparse 4x4 matrices.
+ *
+ * \param forward
+ *      Direction of travel for Stokes vector (normalized)
+ *
+ * \param basis_current
+ *      Current (normalized) Stokes basis. Must be orthogonal to \c forward.
+ *
+ * \param basis_target
+ *      Target (normalized) Stokes basis. Must be orthogonal to \c forward.
+ */
+template <typename Vector3, typename Float = value_t<Vector3>>
+Float stokes_basis_angle(const Vector3 &forward,
+                         const Vector3 &basis_current,
+                         const Vector3 &basis_target) {
+    Float theta = unit_angle(normalize(basis_current),
+                             normalize(basis_target));
+
+    masked(theta, dot(forward, cross(basis_current, basis_target)) < 0) *= -1.f;
+    return theta;
+}
+
 /**
  * \brief Gives the Mueller matrix that alignes the reference frames (defined by
  * their respective basis vectors) of two collinear stokes vectors.
@@ -290,11 +366,7 @@ template <typename Vector3,
 MuellerMatrix rotate_stokes_basis(const Vector3 &forward,
                                   const Vector3 &basis_current,
                                   const Vector3 &basis_target) {
-    Float theta = unit_angle(normalize(basis_current),
-                             normalize(basis_target));
-
-    masked(theta, dot(forward, cross(basis_current, basis_target)) < 0) *= -1.f;
-    return rotator(theta);
+    return rotator(stokes_basis_angle(forward, basis_current, basis_target));
 }
 
 /**
@@ -340,9 +412,42 @@ MuellerMatrix rotate_mueller_basis(const MuellerMatrix &M,
                                    const Vector3 &out_forward,
                                    const Vector3 &out_basis_current,
                                    const Vector3 &out_basis_target) {
-    MuellerMatrix R_in  = rotate_stokes_basis(in_forward, in_basis_current, in_basis_target);
-    MuellerMatrix R_out = rotate_stokes_basis(out_forward, out_basis_current, out_basis_target);
-    return R_out * M * transpose(R_in);
+    // Depolarizing matrices are invariant under a change of Stokes bases
+    if (all_nested(is_depolarizer(M)))
+        return M;
+
+    using Vector4 = value_t<MuellerMatrix>;
+
+    Float s_in,  c_in,  s_out, c_out;
+    std::tie(s_in, c_in) = sincos(
+        2.f * stokes_basis_angle(in_forward, in_basis_current, in_basis_target));
+    std::tie(s_out, c_out) = sincos(
+        2.f * stokes_basis_angle(out_forward, out_basis_current, out_basis_target));
+
+    /* Fused evaluation of R_out * M * transpose(R_in), exploiting the
+       sparsity of the two rotators (only the second and third row/column
+       mix) instead of performing two dense 4x4 multiplies */
+
+    // A = M * transpose(R_in)
+    Vector4 a0 = M.coeff(0),
+            a1 =  c_in * M.coeff(1) + s_in * M.coeff(2),
+            a2 = -s_in * M.coeff(1) + c_in * M.coeff(2),
+            a3 = M.coeff(3);
+
+    // R_out * A, applied row-wise to each column
+    auto rotate_rows = [](Float s, Float c, const Vector4 &a) {
+        return Vector4(a.x(),
+                        c * a.y() + s * a.z(),
+                       -s * a.y() + c * a.z(),
+                       a.w());
+    };
+
+    MuellerMatrix result;
+    result.coeff(0) = rotate_rows(s_out, c_out, a0);
+    result.coeff(1) = rotate_rows(s_out, c_out, a1);
+    result.coeff(2) = rotate_rows(s_out, c_out, a2);
+    result.coeff(3) = rotate_rows(s_out, c_out, a3);
+    return result;
 }
 
 /**
@@ -376,8 +481,35 @@ MuellerMatrix rotate_mueller_basis_collinear(const MuellerMatrix &M,
                                              const Vector3 &forward,
                                              const Vector3 &basis_current,
                                              const Vector3 &basis_target) {
-    MuellerMatrix R = rotate_stokes_basis(forward, basis_current, basis_target);
-    return R * M * transpose(R);
+    // Depolarizing matrices are invariant under a change of Stokes bases
+    if (all_nested(is_depolarizer(M)))
+        return M;
+
+    using Vector4 = value_t<MuellerMatrix>;
+
+    Float s, c;
+    std::tie(s, c) = sincos(
+        2.f * stokes_basis_angle(forward, basis_current, basis_target));
+
+    // Fused evaluation of R * M * transpose(R), see rotate_mueller_basis()
+    Vector4 a0 = M.coeff(0),
+            a1 =  c * M.coeff(1) + s * M.coeff(2),
+            a2 = -s * M.coeff(1) + c * M.coeff(2),
+            a3 = M.coeff(3);
+
+    auto rotate_rows = [](Float s_, Float c_, const Vector4 &a) {
+        return Vector4(a.x(),
+                        c_ * a.y() + s_ * a.z(),
+                       -s_ * a.y() + c_ * a.z(),
+                       a.w());
+    };
+
+    MuellerMatrix result;
+    result.coeff(0) = rotate_rows(s, c, a0);
+    result.coeff(1) = rotate_rows(s, c, a1);
+    result.coeff(2) = rotate_rows(s, c, a2);
+    result.coeff(3) = rotate_rows(s, c, a3);
+    return result;
 }
 
 NAMESPACE_END(mueller)
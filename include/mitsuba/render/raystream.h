@@ -0,0 +1,108 @@
+#pragma once
+
+#include <mitsuba/core/object.h>
+#include <mitsuba/core/filesystem.h>
+#include <mitsuba/core/zstream.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/spin_mutex.h>
+#include <atomic>
+#include <vector>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Records a compressed stream of rays to disk
+ *
+ * Enabled via the (undocumented) scene property <tt>capture_rays</tt>, this
+ * class logs every ray that passes through \ref Scene::ray_intersect() so
+ * that acceleration structure changes (kd-tree builder parameters, traversal
+ * cost constants) can later be evaluated against real production ray
+ * distributions without re-rendering -- see the <tt>--replay</tt> option of
+ * the <tt>mitsuba-bench</tt> tool.
+ *
+ * The file starts with an 8-byte magic string and a version number, followed
+ * by a deflate-compressed sequence of chunks, each a 64-bit record count and
+ * that many \ref Record entries; a chunk with a zero count terminates the
+ * stream. Rays are stored in single precision regardless of the variant that
+ * produced them. Recording is thread-safe: rays accumulate into per-thread
+ * buffers that are flushed to the compressor under a lock when full.
+ *
+ * \ingroup librender
+ */
+class MTS_EXPORT_RENDER RayStreamRecorder : public Object {
+public:
+    /// One captured ray: origin, direction, and time
+    struct Record {
+        float o[3];
+        float d[3];
+        float time;
+    };
+
+    /// Magic string identifying a captured ray stream
+    static constexpr const char *Magic = "MTSRAYS";
+
+    /// Version number associated with the current file format
+    static constexpr uint32_t Version = 1;
+
+    /// Create a recorder writing to the given file (truncates existing content)
+    RayStreamRecorder(const fs::path &filename);
+
+    /// Append a single ray (thread-safe)
+    void record(const Record &rec);
+
+    /// Return the number of rays recorded so far
+    size_t ray_count() const { return m_ray_count.load(std::memory_order_relaxed); }
+
+    /**
+     * \brief Flush all thread-local buffers and finalize the file
+     *
+     * No further calls to \ref record() are permitted afterwards. This
+     * function is idempotent and called automatically by the destructor.
+     */
+    void close();
+
+    MTS_DECLARE_CLASS()
+protected:
+    /// Protected destructor (finalizes the file via \ref close())
+    virtual ~RayStreamRecorder();
+
+    /// Write one buffer to the compressor. Must hold \ref m_mutex.
+    void flush(std::vector<Record> &buffer);
+
+    ref<ZStream> m_stream;
+    tbb::enumerable_thread_specific<std::vector<Record>> m_buffers;
+    std::atomic<size_t> m_ray_count;
+    tbb::spin_mutex m_mutex;
+};
+
+/**
+ * \brief Reads back a ray stream captured by \ref RayStreamRecorder
+ *
+ * \ingroup librender
+ */
+class MTS_EXPORT_RENDER RayStreamReader : public Object {
+public:
+    using Record = RayStreamRecorder::Record;
+
+    /// Open the given capture file, validating its header
+    RayStreamReader(const fs::path &filename);
+
+    /**
+     * \brief Read the next chunk of rays into \c records
+     *
+     * Returns \c false (leaving \c records empty) once the terminating
+     * chunk has been reached.
+     */
+    bool next_chunk(std::vector<Record> &records);
+
+    /// Convenience function that reads the remainder of the stream at once
+    std::vector<Record> read_all();
+
+    MTS_DECLARE_CLASS()
+protected:
+    virtual ~RayStreamReader() = default;
+
+    ref<ZStream> m_stream;
+};
+
+NAMESPACE_END(mitsuba)
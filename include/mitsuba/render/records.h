@@ -25,6 +25,7 @@ struct PositionSample {
     using Float    = Float_;
     using Spectrum = Spectrum_;
     MTS_IMPORT_RENDER_BASIC_TYPES()
+    using Index                = typename CoreAliases::UInt32;
     using ObjectPtr            = typename RenderAliases::ObjectPtr;
     using SurfaceInteraction3f = typename RenderAliases::SurfaceInteraction3f;
 
@@ -75,6 +76,17 @@ struct PositionSample {
       */
     ObjectPtr object = nullptr;
 
+    /**
+     * \brief Optional: index of the primitive (e.g. the mesh face) on which
+     * the sampled position lies
+     *
+     * Sampling techniques whose density is not uniform over the underlying
+     * shape (such as the luminance-weighted sampling of textured area
+     * emitters) require this information to evaluate the density of a
+     * position obtained by other means, e.g. via standard ray tracing.
+     */
+    Index prim_index = 0;
+
     //! @}
     // =============================================================
 
@@ -91,12 +103,14 @@ struct PositionSample {
      */
     PositionSample(const SurfaceInteraction3f &si)
         : p(si.p), n(si.sh_frame.n), uv(si.uv), time(si.time), pdf(0.f),
-          delta(false), object(reinterpret_array<ObjectPtr>(si.shape)) { }
+          delta(false), object(reinterpret_array<ObjectPtr>(si.shape)),
+          prim_index(si.prim_index) { }
 
     //! @}
     // =============================================================
 
-    ENOKI_STRUCT(PositionSample, p, n, uv, time, pdf, delta, object)
+    ENOKI_STRUCT(PositionSample, p, n, uv, time, pdf, delta, object,
+                 prim_index)
 };
 
 // -----------------------------------------------------------------------------
@@ -124,7 +138,8 @@ struct DirectionSample : public PositionSample<Float_, Spectrum_> {
     // =============================================================
     using Float    = Float_;
     using Spectrum = Spectrum_;
-    MTS_IMPORT_BASE(PositionSample, p, n, uv, time, pdf, delta, object)
+    MTS_IMPORT_BASE(PositionSample, p, n, uv, time, pdf, delta, object,
+                    prim_index)
     MTS_IMPORT_RENDER_BASIC_TYPES()
     using Interaction3f        = typename RenderAliases::Interaction3f;
     using SurfaceInteraction3f = typename RenderAliases::SurfaceInteraction3f;
@@ -177,7 +192,7 @@ struct DirectionSample : public PositionSample<Float_, Spectrum_> {
     DirectionSample(const Point3f &p, const Normal3f &n, const Point2f &uv,
                     const Float &time, const Float &pdf, const Mask &delta,
                     const ObjectPtr &object, const Vector3f &d, const Float &dist)
-        : Base(p, n, uv, time, pdf, delta, object), d(d), dist(dist) { }
+        : Base(p, n, uv, time, pdf, delta, object, 0u), d(d), dist(dist) { }
 
     /// Construct from a position sample
     DirectionSample(const Base &base) : Base(base) { }
@@ -203,7 +218,7 @@ struct DirectionSample : public PositionSample<Float_, Spectrum_> {
     // =============================================================
 
     ENOKI_DERIVED_STRUCT(DirectionSample, Base,
-        ENOKI_BASE_FIELDS(p, n, uv, time, pdf, delta, object),
+        ENOKI_BASE_FIELDS(p, n, uv, time, pdf, delta, object, prim_index),
         ENOKI_DERIVED_FIELDS(d, dist)
     )
 };
@@ -220,7 +235,8 @@ std::ostream &operator<<(std::ostream &os,
        << "  time = " << ps.time << "," << std::endl
        << "  pdf = " << ps.pdf << "," << std::endl
        << "  delta = " << ps.delta << "," << std::endl
-       << "  object = " << string::indent(ps.object) << std::endl
+       << "  object = " << string::indent(ps.object) << "," << std::endl
+       << "  prim_index = " << ps.prim_index << std::endl
        <<  "]";
     return os;
 }
@@ -236,6 +252,7 @@ std::ostream &operator<<(std::ostream &os,
        << "  pdf = " << ds.pdf << "," << std::endl
        << "  delta = " << ds.delta << "," << std::endl
        << "  object = " << string::indent(ds.object) << "," << std::endl
+       << "  prim_index = " << ds.prim_index << "," << std::endl
        << "  d = " << string::indent(ds.d, 6) << "," << std::endl
        << "  dist = " << ds.dist << std::endl
        << "]";
@@ -249,10 +266,10 @@ NAMESPACE_END(mitsuba)
 // -----------------------------------------------------------------------
 
 ENOKI_STRUCT_SUPPORT(mitsuba::PositionSample, p, n, uv, time,
-                     pdf, delta, object)
+                     pdf, delta, object, prim_index)
 
 ENOKI_STRUCT_SUPPORT(mitsuba::DirectionSample, p, n, uv, time, pdf,
-                     delta, object, d, dist)
+                     delta, object, prim_index, d, dist)
 
 //! @}
 // -----------------------------------------------------------------------
@@ -34,6 +34,28 @@ public:
      */
     virtual void seed(UInt64 seed_value);
 
+    /**
+     * \brief Inform the sampler about the pixel that is being rendered
+     *
+     * The block renderer invokes this function with the absolute image
+     * coordinates of each pixel before generating its samples. The default
+     * implementation ignores the call; samplers that decorrelate neighboring
+     * pixels in a structured way (e.g. using a blue-noise permutation)
+     * override it to update their per-pixel state. In the context of
+     * wavefront ray tracing & dynamic arrays, this function is not used.
+     */
+    virtual void set_pixel(const Point2u &pos);
+
+    /**
+     * \brief Advance to the next sample
+     *
+     * Stateless pseudorandom samplers ignore this call. Stateful
+     * low-discrepancy samplers use it to increment their sample index and
+     * rewind the dimension counter, so it must be invoked exactly once per
+     * pixel sample. The default implementation does nothing.
+     */
+    virtual void advance();
+
     /// Retrieve the next component value from the current sample
     virtual Float next_1d(Mask active = true);
 
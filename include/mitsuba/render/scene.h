@@ -1,8 +1,10 @@
 #pragma once
 
+#include <mitsuba/core/parameters.h>
 #include <mitsuba/core/spectrum.h>
 #include <mitsuba/render/emitter.h>
 #include <mitsuba/render/fwd.h>
+#include <mitsuba/render/interaction.h>
 #include <mitsuba/render/sensor.h>
 
 NAMESPACE_BEGIN(mitsuba)
@@ -35,6 +37,32 @@ public:
      */
     SurfaceInteraction3f ray_intersect(const Ray3f &ray, Mask active = true) const;
 
+    /**
+     * \brief Intersect a ray against all primitives stored in the scene,
+     * populating only the requested interaction fields
+     *
+     * \param ray
+     *    A 3-dimensional ray data structure with minimum/maximum
+     *    extent information, as well as a time value (which matters
+     *    when the shapes are in motion)
+     *
+     * \param hit_flags
+     *    Bit mask of \ref HitFlags entries specifying which fields of the
+     *    surface interaction are required by the caller. Passing \ref
+     *    HitFlags::Minimal skips the surface parameterization entirely;
+     *    the resulting record can later be expanded on demand via \ref
+     *    SurfaceInteraction::finalize_surface_interaction(). The GPU and
+     *    kd-tree backends currently ignore this parameter and always
+     *    populate all fields.
+     *
+     * \return
+     *    A surface interaction record restricted to the requested fields.
+     *    Query its \ref <tt>is_valid()</tt> method to determine whether an
+     *    intersection was actually found.
+     */
+    SurfaceInteraction3f ray_intersect(const Ray3f &ray, uint32_t hit_flags,
+                                       Mask active = true) const;
+
     /**
      * \brief Ray intersection using brute force search. Used in
      * unit tests to validate the kdtree-based ray tracer.
@@ -61,6 +89,37 @@ public:
      */
     Mask ray_test(const Ray3f &ray, Mask active = true) const;
 
+    /**
+     * \brief Intersect a stream of rays against all primitives stored in
+     * the scene
+     *
+     * Semantically equivalent to calling \ref ray_intersect() once per entry,
+     * but the rays are handed to the underlying backend as a single batch.
+     * The Embree backend maps this onto stream (\c rtcIntersectNM) traversal,
+     * and the native backend keeps kd-tree nodes warm in cache across
+     * consecutive rays. This is primarily beneficial for coherent ray sets
+     * such as primary or shadow ray batches.
+     *
+     * \param rays
+     *    Pointer to an array of \c count rays
+     *
+     * \param si
+     *    Pointer to an array of \c count surface interaction records that
+     *    will be filled with the intersection results
+     *
+     * \param count
+     *    Number of rays in the stream
+     */
+    void ray_intersect_n(const Ray3f *rays, SurfaceInteraction3f *si,
+                         size_t count, Mask active = true) const;
+
+    /**
+     * \brief Batched analogue of \ref ray_test() that submits a stream of
+     * shadow rays to the backend at once
+     */
+    void ray_test_n(const Ray3f *rays, Mask *hit, size_t count,
+                    Mask active = true) const;
+
     //! @}
     // =============================================================
 
@@ -98,6 +157,45 @@ public:
                              bool test_visibility = true,
                              Mask active = true) const;
 
+    /**
+     * \brief Batched analogue of \ref sample_emitter_direction() for a
+     * whole wavefront of shading points
+     *
+     * Emitter sampling first runs for all entries with the visibility test
+     * deferred. The resulting shadow rays are then bucketed by target
+     * emitter and submitted to \ref ray_test_n() in bucket-contiguous
+     * order: rays towards the same (area) emitter share origin-cone
+     * coherence that the backend's stream traversal can exploit, which
+     * per-entry \ref sample_emitter_direction() invocations would
+     * interleave away.
+     *
+     * \param ref
+     *    Pointer to an array of \c count reference interactions
+     *
+     * \param sample
+     *    Pointer to an array of \c count uniformly distributed 2D samples
+     *
+     * \param ds
+     *    Pointer to an array of \c count direction sampling records that
+     *    will be filled with the sampled directions
+     *
+     * \param spec
+     *    Pointer to an array of \c count spectra that will be filled with
+     *    the incident radiance estimates (occluded entries are set to zero)
+     *
+     * \param count
+     *    Number of entries in the batch
+     *
+     * \param active
+     *    Pointer to an array of \c count activity masks
+     */
+    void sample_emitter_direction_n(const Interaction3f *ref,
+                                    const Point2f *sample,
+                                    DirectionSample3f *ds,
+                                    Spectrum *spec,
+                                    size_t count,
+                                    const Mask *active) const;
+
     /**
      * \brief Evaluate the probability density of the  \ref
      * sample_emitter_direct() technique given an filled-in \ref
@@ -149,6 +247,33 @@ public:
     /// Return the scene's integrator
     const Integrator* integrator() const { return m_integrator; }
 
+    /**
+     * \brief Does the scene contain participating media?
+     *
+     * Determined once at scene construction time. Integrators can use this
+     * to dispatch to a specialized sampling loop that omits the medium
+     * bookkeeping entirely (see e.g. the volumetric path tracer).
+     */
+    bool has_media() const { return m_has_media; }
+
+    //! @}
+    // =============================================================
+
+    // =============================================================
+    //! @{ \name Live parameter updates
+    // =============================================================
+
+    /**
+     * \brief Return the table of named parameters exposed by the scene graph
+     *
+     * The table is built once during scene construction. After overwriting
+     * entries via \ref ParameterTable::set(), call
+     * \ref ParameterTable::update() to re-propagate the changes to the
+     * affected objects (e.g. re-baking derived sampling data or refitting
+     * the acceleration data structure) without re-loading the scene.
+     */
+    ParameterTable &parameters() { return m_params; }
+
     //! @}
     // =============================================================
 
@@ -174,8 +299,12 @@ protected:
     void accel_release_cpu();
     void accel_release_gpu();
 
+    /// Update the acceleration data structure after shapes were modified
+    void accel_parameters_changed_cpu();
+
     /// Trace a ray
-    MTS_INLINE SurfaceInteraction3f ray_intersect_cpu(const Ray3f &ray, Mask active) const;
+    MTS_INLINE SurfaceInteraction3f ray_intersect_cpu(const Ray3f &ray, uint32_t hit_flags,
+                                                      Mask active) const;
     MTS_INLINE SurfaceInteraction3f ray_intersect_gpu(const Ray3f &ray, Mask active) const;
     MTS_INLINE SurfaceInteraction3f ray_intersect_naive_cpu(const Ray3f &ray, Mask active) const;
 
@@ -183,7 +312,20 @@ protected:
     MTS_INLINE Mask ray_test_cpu(const Ray3f &ray, Mask active) const;
     MTS_INLINE Mask ray_test_gpu(const Ray3f &ray, Mask active) const;
 
-    using ShapeKDTree = mitsuba::ShapeKDTree<Float, Spectrum>;
+    /// Trace a stream of rays
+    MTS_INLINE void ray_intersect_n_cpu(const Ray3f *rays, SurfaceInteraction3f *si,
+                                        size_t count, Mask active) const;
+
+    /// Trace a stream of shadow rays
+    MTS_INLINE void ray_test_n_cpu(const Ray3f *rays, Mask *hit, size_t count,
+                                   Mask active) const;
+
+    /// Append the active lanes of \c ray to \ref m_ray_recorder
+    void capture_ray(const Ray3f &ray, Mask active) const;
+
+    using ShapeKDTree     = mitsuba::ShapeKDTree<Float, Spectrum>;
+    using LightBVH        = mitsuba::LightBVH<Float, Spectrum>;
+    using VisibilityCache = mitsuba::VisibilityCache<Float, Spectrum>;
 
 protected:
     /// Acceleration data structure (type depends on implementation)
@@ -192,11 +334,21 @@ protected:
     ScalarBoundingBox3f m_bbox;
 
     host_vector<ref<Emitter>, Float> m_emitters;
+    /// Hierarchy for many-light sampling (only in scalar/packet variants)
+    ref<LightBVH> m_light_bvh;
+    /// Optional shadow-ray cache for emitter sampling (scalar variants only)
+    ref<VisibilityCache> m_vis_cache;
+    /// Optional ray stream capture for offline acceleration structure tuning
+    ref<RayStreamRecorder> m_ray_recorder;
     std::vector<ref<Shape>> m_shapes;
     std::vector<ref<Sensor>> m_sensors;
     std::vector<ref<Object>> m_children;
     ref<Integrator> m_integrator;
     ref<Emitter> m_environment;
+    /// Does any shape or endpoint reference a participating medium?
+    bool m_has_media = false;
+    /// Named parameters exposed by the scene graph (see \ref parameters())
+    ParameterTable m_params;
 };
 
 /// Dummy function which can be called to ensure that the librender shared library is loaded
@@ -12,12 +12,87 @@
 
 NAMESPACE_BEGIN(mitsuba)
 
+/**
+ * \brief Structure-of-arrays buffer holding the camera rays of a full tile
+ *
+ * Every ray component is stored in its own contiguous array, which is the
+ * layout consumed by wavefront/stream-style tracing loops. The buffer is
+ * filled by \ref Sensor::sample_ray_differential_batch(); the \ref ray()
+ * helper reconstructs individual ray differentials for consumers that
+ * prefer the conventional representation.
+ */
+template <typename Float_, typename Spectrum_> struct SensorRayBatch {
+    using Float              = Float_;
+    using Spectrum           = Spectrum_;
+    using Wavelength         = typename RenderAliases<Float, Spectrum>::Wavelength;
+    using RayDifferential3f  = typename RenderAliases<Float, Spectrum>::RayDifferential3f;
+
+    /// Ray origins and normalized directions, one array per component
+    std::vector<Float> o_x, o_y, o_z, d_x, d_y, d_z;
+
+    /// Valid ray segment and time value of each ray
+    std::vector<Float> mint, maxt, time;
+
+    /// Screen-space X/Y offset ray origins and directions
+    std::vector<Float> ox_x, ox_y, ox_z, dx_x, dx_y, dx_z,
+                       oy_x, oy_y, oy_z, dy_x, dy_y, dy_z;
+
+    /// Sampled wavelengths and associated importance weights
+    std::vector<Wavelength> wavelengths;
+    std::vector<Spectrum> weights;
+
+    size_t size() const { return time.size(); }
+
+    void resize(size_t size) {
+        for (std::vector<Float> *v :
+             { &o_x, &o_y, &o_z, &d_x, &d_y, &d_z, &mint, &maxt, &time,
+               &ox_x, &ox_y, &ox_z, &dx_x, &dx_y, &dx_z,
+               &oy_x, &oy_y, &oy_z, &dy_x, &dy_y, &dy_z })
+            v->resize(size);
+        wavelengths.resize(size);
+        weights.resize(size);
+    }
+
+    /// Store a sampled ray differential and its weight at index \c i
+    void set(size_t i, const RayDifferential3f &ray, const Spectrum &weight) {
+        o_x[i] = ray.o.x();   o_y[i] = ray.o.y();   o_z[i] = ray.o.z();
+        d_x[i] = ray.d.x();   d_y[i] = ray.d.y();   d_z[i] = ray.d.z();
+        mint[i] = ray.mint;   maxt[i] = ray.maxt;   time[i] = ray.time;
+        ox_x[i] = ray.o_x.x(); ox_y[i] = ray.o_x.y(); ox_z[i] = ray.o_x.z();
+        dx_x[i] = ray.d_x.x(); dx_y[i] = ray.d_x.y(); dx_z[i] = ray.d_x.z();
+        oy_x[i] = ray.o_y.x(); oy_y[i] = ray.o_y.y(); oy_z[i] = ray.o_y.z();
+        dy_x[i] = ray.d_y.x(); dy_y[i] = ray.d_y.y(); dy_z[i] = ray.d_y.z();
+        wavelengths[i] = ray.wavelengths;
+        weights[i] = weight;
+    }
+
+    /// Reconstruct the ray differential stored at index \c i
+    RayDifferential3f ray(size_t i) const {
+        RayDifferential3f result;
+        result.o    = { o_x[i], o_y[i], o_z[i] };
+        result.d    = { d_x[i], d_y[i], d_z[i] };
+        result.mint = mint[i];
+        result.maxt = maxt[i];
+        result.time = time[i];
+        result.o_x  = { ox_x[i], ox_y[i], ox_z[i] };
+        result.d_x  = { dx_x[i], dx_y[i], dx_z[i] };
+        result.o_y  = { oy_x[i], oy_y[i], oy_z[i] };
+        result.d_y  = { dy_x[i], dy_y[i], dy_z[i] };
+        result.wavelengths = wavelengths[i];
+        result.has_differentials = true;
+        result.update();
+        return result;
+    }
+};
+
 template <typename Float, typename Spectrum>
 class MTS_EXPORT_RENDER Sensor : public Endpoint<Float, Spectrum> {
 public:
     MTS_IMPORT_TYPES(Film, Sampler)
     MTS_IMPORT_BASE(Endpoint, sample_ray, m_needs_sample_3)
 
+    using RayBatch = SensorRayBatch<Float, Spectrum>;
+
     // =============================================================
     //! @{ \name Sensor-specific sampling functions
     // =============================================================
@@ -62,6 +137,25 @@ public:
                             const Point2f &sample2, const Point2f &sample3,
                             Mask active = true) const;
 
+    /**
+     * \brief Generate camera rays for an entire tile of samples in one call
+     *
+     * The semantics of the per-sample inputs match those of \ref
+     * sample_ray_differential(); all arrays must have the same length
+     * (\c sample3 may be empty when <tt>needs_sample_3() == false</tt>).
+     * Results are written into the structure-of-arrays buffer \c batch,
+     * which is resized as needed.
+     *
+     * The default implementation simply loops over \ref
+     * sample_ray_differential(). Sensors whose per-sample work is dominated
+     * by loop-invariant computations (inverse transforms, differential
+     * bases) should override it and hoist those out of the loop.
+     */
+    virtual void sample_ray_differential_batch(
+        const std::vector<Float> &time, const std::vector<Float> &sample1,
+        const std::vector<Point2f> &sample2, const std::vector<Point2f> &sample3,
+        RayBatch &batch, Mask active = true) const;
+
     //! @}
     // =============================================================
 
@@ -148,6 +148,24 @@ public:
      */
     virtual Mask ray_test(const Ray3f &ray, Mask active = true) const;
 
+    /**
+     * \brief Fast ray intersection test against a single sub-primitive
+     *
+     * Shapes that expose multiple primitives to the acceleration data
+     * structures (\ref primitive_count() > 1, e.g. the segments of a
+     * B-spline curve) must override this method, since the index-less \ref
+     * ray_intersect() variant cannot know which primitive a kd-tree leaf
+     * refers to. The default implementation ignores the index and forwards
+     * to \ref ray_intersect(); single-primitive shapes need not override it.
+     */
+    virtual std::pair<Mask, Float> ray_intersect(ScalarIndex prim_index,
+                                                 const Ray3f &ray, Float *cache,
+                                                 Mask active = true) const;
+
+    /// Sub-primitive variant of \ref ray_test(), analogous to the indexed \ref ray_intersect()
+    virtual Mask ray_test(ScalarIndex prim_index, const Ray3f &ray,
+                          Mask active = true) const;
+
     /**
      * \brief Given a surface intersection found by \ref ray_intersect(), fill
      * a \ref SurfaceInteraction data structure with detailed information
@@ -265,6 +283,18 @@ public:
     /// Return the shape's BSDF
     const BSDF *bsdf() const { return m_bsdf.get(); }
 
+    /**
+     * \brief Was this shape declared as an emitter portal?
+     *
+     * Portals mark the openings (e.g. windows) through which an environment
+     * emitter illuminates an otherwise enclosed scene. When at least one
+     * portal is present, environment emitters restrict their direction
+     * sampling to the portal geometry (see the \c envmap plugin). The flag
+     * has no effect on ray intersections or shading -- combine it with a
+     * \c null BSDF if the portal should not block light itself.
+     */
+    bool is_portal() const { return m_portal; }
+
     /// Is this shape also an area emitter?
     bool is_emitter() const { return (bool) m_emitter; }
 
@@ -297,9 +327,35 @@ public:
      */
     virtual ScalarSize effective_primitive_count() const;
 
+    /**
+     * \brief Mark the shape's geometry as outdated
+     *
+     * Plugins call this function from \ref parameters_changed() when vertex
+     * positions (or other data affecting primitive bounding boxes) were
+     * modified. The flag is consumed by the ray-intersection acceleration
+     * data structure (see \ref ShapeKDTree::update()), which refits or
+     * rebuilds the affected parts and clears it via \ref clear_dirty().
+     */
+    void mark_dirty() { m_dirty = true; }
+
+    /// Has the geometry changed since the last acceleration structure update?
+    bool dirty() const { return m_dirty; }
+
+    /// Mark the shape's geometry as up-to-date
+    void clear_dirty() { m_dirty = false; }
+
 #if defined(MTS_ENABLE_EMBREE)
     /// Return the Embree version of this shape
     virtual RTCGeometry embree_geometry(RTCDevice device) const;
+
+    /**
+     * \brief Return a nested Embree scene containing the shape's children
+     *
+     * Only implemented by the \c shapegroup plugin, whose contents are
+     * referenced by instances via \c rtcSetGeometryInstancedScene. The scene
+     * is built on first use and shared by all instances of the group.
+     */
+    virtual RTCScene embree_scene(RTCDevice device) const;
 #endif
 
 #if defined(MTS_ENABLE_OPTIX)
@@ -325,6 +381,8 @@ protected:
 
 protected:
     bool m_mesh = false;
+    bool m_dirty = false;
+    bool m_portal = false;
     ref<BSDF> m_bsdf;
     ref<Emitter> m_emitter;
     ref<Sensor> m_sensor;
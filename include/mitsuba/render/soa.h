@@ -0,0 +1,185 @@
+#pragma once
+
+#include <mitsuba/render/interaction.h>
+#include <mitsuba/render/records.h>
+#include <vector>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Structure-of-arrays buffer for interaction and sampling records
+ *
+ * Wavefront-style pipeline stages exchange queues of records such as \ref
+ * SurfaceInteraction and \ref DirectionSample. At the computation width,
+ * these are structs of (packets of) values, and storing a queue as a plain
+ * array of such structs interleaves all fields in memory: any stage that
+ * compacts, sorts, or otherwise reorders its entries must then shuffle
+ * every field by hand.
+ *
+ * In the packet variants, this class instead stores the *dynamic*
+ * (structure-of-arrays) representation of the record type, in which each
+ * scalar field occupies one contiguous array. Whole records move between the
+ * buffer and computation-width variables through \ref gather_records() and
+ * \ref scatter_records(), which compile to one contiguous or hardware
+ * gather/scatter access per field. The interface is width-agnostic: the
+ * scalar variants transparently fall back to an ordinary vector, which is
+ * the same layout at width one, so queue-based code need not branch on the
+ * variant.
+ *
+ * The buffer separates its logical size from the allocated slice count so
+ * that queue-style producers can append without repeated reallocation.
+ * Since the dynamic arrays own their (aligned) storage, instances should be
+ * kept per worker thread and recycled from one block to the next, following
+ * the same discipline as the \ref ScratchArena that backs the integrators'
+ * other per-block state.
+ */
+template <typename Record> class SoARecordBuffer {
+public:
+    using Float  = typename Record::Float;
+    using UInt32 = uint32_array_t<Float>;
+    using Mask   = mask_t<Float>;
+
+    /// Number of record entries processed per computation-width access
+    static constexpr size_t PacketSize = array_size_v<Float>;
+
+    /// Underlying storage: structure-of-arrays in the packet variants
+    using Storage = std::conditional_t<is_static_array_v<Float>,
+                                       make_dynamic_t<Record>,
+                                       std::vector<Record>>;
+
+    SoARecordBuffer() = default;
+
+    /// Number of records currently stored
+    size_t size() const { return m_size; }
+
+    /// Is the buffer empty?
+    bool empty() const { return m_size == 0; }
+
+    /// Number of (partially filled) packets covering the stored records
+    size_t packets() const { return (m_size + PacketSize - 1) / PacketSize; }
+
+    /// Discard the contents, keeping the allocation for reuse
+    void clear() {
+        if constexpr (!is_static_array_v<Float>)
+            m_data.clear();
+        m_size = 0;
+    }
+
+    /// Ensure that storage for at least \c capacity records exists
+    void reserve(size_t capacity) {
+        if constexpr (is_static_array_v<Float>) {
+            if (capacity <= m_capacity)
+                return;
+            capacity = std::max(capacity, 2 * m_capacity);
+
+            Storage data = zero<Storage>(capacity);
+            for (size_t i = 0; i < enoki::packets(m_data); ++i)
+                enoki::packet(data, i) = enoki::packet(m_data, i);
+
+            m_data = std::move(data);
+            m_capacity = capacity;
+        } else {
+            m_data.reserve(capacity);
+        }
+    }
+
+    /// Set the number of records, allocating additional storage as needed
+    void resize(size_t size) {
+        reserve(size);
+        if constexpr (!is_static_array_v<Float>)
+            m_data.resize(size);
+        m_size = size;
+    }
+
+    /**
+     * \brief Append the active lanes of a computation-width record
+     *
+     * Lanes disabled in \c active are skipped and the surviving entries are
+     * packed tightly, so repeatedly pushing partially occupied packets
+     * (e.g. after path termination) yields a compact queue.
+     */
+    void push(const Record &value, const Mask &active = true) {
+        if constexpr (!is_static_array_v<Float>) {
+            if (active) {
+                m_data.push_back(value);
+                m_size++;
+            }
+        } else {
+            uint32_t offsets[PacketSize], count = 0;
+            for (size_t i = 0; i < PacketSize; ++i)
+                offsets[i] = (uint32_t) m_size +
+                             ((bool) active.coeff(i) ? count++ : 0u);
+
+            if (count == 0)
+                return;
+
+            reserve(m_size + count);
+            enoki::scatter(m_data, value, load_unaligned<UInt32>(offsets),
+                           active);
+            m_size += count;
+        }
+    }
+
+    /// Read packet \c i of the buffer as a computation-width record
+    Record packet(size_t i) const {
+        if constexpr (is_static_array_v<Float>)
+            return enoki::packet(m_data, i);
+        else
+            return m_data[i];
+    }
+
+    /// Overwrite packet \c i of the buffer
+    void set_packet(size_t i, const Record &value) {
+        if constexpr (is_static_array_v<Float>)
+            enoki::packet(m_data, i) = value;
+        else
+            m_data[i] = value;
+    }
+
+    /// Direct access to the underlying storage
+    Storage &data() { return m_data; }
+
+    /// Direct access to the underlying storage (const version)
+    const Storage &data() const { return m_data; }
+
+private:
+    Storage m_data;
+    size_t m_size = 0, m_capacity = 0;
+};
+
+/**
+ * \brief Gather a computation-width record from the given buffer
+ *
+ * Reads the record entries at positions \c index and transposes them into
+ * the packet layout of \c Record, one gather per scalar field. Lanes
+ * disabled in \c active are left zero-initialized.
+ */
+template <typename Record, typename Index>
+MTS_INLINE Record gather_records(const SoARecordBuffer<Record> &buffer,
+                                 const Index &index,
+                                 const mask_t<Index> &active = true) {
+    if constexpr (is_static_array_v<typename Record::Float>)
+        return enoki::gather<Record>(buffer.data(), index, active);
+    else
+        return active ? buffer.data()[index] : zero<Record>();
+}
+
+/**
+ * \brief Scatter a computation-width record into the given buffer
+ *
+ * The inverse of \ref gather_records(): lane \c i of \c value is written to
+ * buffer position <tt>index[i]</tt> wherever \c active is set. The target
+ * positions must lie within the buffer's current size (see \ref
+ * SoARecordBuffer::resize()).
+ */
+template <typename Record, typename Index>
+MTS_INLINE void scatter_records(SoARecordBuffer<Record> &buffer,
+                                const Record &value, const Index &index,
+                                const mask_t<Index> &active = true) {
+    if constexpr (is_static_array_v<typename Record::Float>)
+        enoki::scatter(buffer.data(), value, index, active);
+    else if (active)
+        buffer.data()[index] = value;
+}
+
+NAMESPACE_END(mitsuba)
@@ -2,9 +2,13 @@
 
 #include <mitsuba/core/object.h>
 #include <mitsuba/core/spectrum.h>
+#include <mitsuba/core/atomic.h>
 #include <mitsuba/render/film.h>
 #include <mitsuba/render/imageblock.h>
 #include <tbb/spin_mutex.h>
+#include <atomic>
+#include <memory>
+#include <vector>
 
 #if !defined(MTS_BLOCK_SIZE)
 #  define MTS_BLOCK_SIZE 32
@@ -15,6 +19,26 @@ NAMESPACE_BEGIN(mitsuba)
 /**
  * \brief Generates a spiral of blocks to be rendered.
  *
+ * The first pass hands out equal-size blocks in spiral order (or, when
+ * density estimates were supplied via \ref set_density(), variable-size
+ * blocks that are large over empty regions and small over dense geometry).
+ * Blocks are claimed via atomic flags from a precomputed schedule, hence
+ * \ref next_block() is lock-free on the hot path. When rendering multiple
+ * passes, callers may report the observed rendering cost of each finished
+ * block via \ref record_cost(); subsequent passes are then scheduled in
+ * order of decreasing cost, and blocks that are much more expensive than
+ * average are split into sub-blocks that idle workers can pick up, which
+ * reduces the straggler tail at the end of each pass.
+ *
+ * When workers identify themselves (see \ref set_worker_count() and the
+ * \c worker argument of \ref next_block()), the scheduler additionally
+ * tracks which worker last rendered each block of the regular grid, and
+ * preferentially hands blocks back to that worker on subsequent passes.
+ * The per-block working set (kd-tree subtrees, textures, sampler state)
+ * then stays warm in that worker's cache across passes; a worker whose
+ * own blocks are exhausted falls back to claiming -- i.e. stealing --
+ * any remaining block in schedule order, so load balance is unaffected.
+ *
  * \author Adam Arbree
  * Aug 25, 2005
  * RayTracer.java
@@ -43,6 +67,22 @@ public:
     /// Reset the spiral to its initial state. Does not affect the number of passes.
     void reset();
 
+    /**
+     * \brief Provide per-block density estimates that steer the granularity
+     * of the first pass
+     *
+     * The array must hold \ref block_count() entries (one per block of the
+     * regular grid, in row-major order) with relative estimates of the
+     * image contents, e.g. the fraction of probe rays that hit geometry.
+     * Runs of empty blocks (density zero) are merged into larger work
+     * items, while blocks that are much denser than average are split into
+     * quadrants. Once cost feedback from \ref record_cost() is available,
+     * it takes precedence over the estimates.
+     *
+     * Rebuilds the schedule -- must be called before rendering starts.
+     */
+    void set_density(const float *density);
+
     /**
      * Sets the number of time the spiral should automatically reset.
      * Not affected by a call to \ref reset.
@@ -51,12 +91,51 @@ public:
         m_remaining_passes = passes;
     }
 
+    /**
+     * \brief Declare the number of workers that will identify themselves
+     * to \ref next_block(), enabling pass-to-pass block-worker affinity
+     *
+     * Must be called before rendering starts.
+     */
+    void set_worker_count(uint32_t workers);
+
     /**
      * \brief Return the offset and size of the next block.
      *
      * A size of zero indicates that the spiral traversal is done.
+     *
+     * \param worker
+     *     Identifier of the calling worker in
+     *     <tt>[0, worker_count)</tt>. Blocks that this worker rendered on
+     *     a previous pass are handed back to it in preference to the
+     *     global schedule order. \ref InvalidWorker disables affinity for
+     *     this call.
+     *
+     * \param block_id
+     *     When non-null, receives an identifier that is unique across all
+     *     blocks and passes handed out by this instance (e.g. for
+     *     deterministic sampler seeding)
      */
-    std::pair<Vector2i, Vector2i> next_block();
+    std::pair<Vector2i, Vector2i> next_block(uint32_t worker,
+                                             size_t *block_id = nullptr);
+
+    /// Convenience overload without worker affinity
+    std::pair<Vector2i, Vector2i> next_block(size_t *block_id = nullptr) {
+        return next_block(InvalidWorker, block_id);
+    }
+
+    /// Worker identifier denoting an anonymous caller of \ref next_block()
+    static constexpr uint32_t InvalidWorker = (uint32_t) -1;
+
+    /**
+     * \brief Report the observed cost (e.g. render time in milliseconds)
+     * of a finished block
+     *
+     * The cost accumulates onto the block of the regular grid that contains
+     * \c offset and steers the scheduling of subsequent passes. May be
+     * called concurrently from multiple threads.
+     */
+    void record_cost(const Vector2i &offset, float cost);
 
     MTS_DECLARE_CLASS()
 protected:
@@ -67,24 +146,64 @@ protected:
         Up
     };
 
-    size_t m_block_counter, //< Number of blocks generated so far
-           m_block_count,   //< Total number of blocks to be generated
+    /**
+     * \brief Append the work items of one pass to the schedule
+     *
+     * The first pass follows the classic spiral; later passes are ordered
+     * by decreasing recorded cost, splitting stragglers into quadrants.
+     * Must be called while holding \ref m_mutex.
+     */
+    void append_pass();
+
+    /// Map a block offset to its index within the regular grid
+    size_t grid_index(const Vector2i &offset) const;
+
+    /// Attempt to claim schedule entry \c index on behalf of \c worker
+    bool try_claim(size_t index, uint32_t worker, size_t *block_id);
+
+    size_t m_block_count,   //< Number of blocks of the regular grid (per pass)
            m_block_size;    //< Size of the (square) blocks (in pixels)
 
     Vector2i m_size,        //< Size of the 2D image (in pixels).
              m_offset,      //< Offset to the crop region on the sensor (pixels).
              m_blocks;      //< Number of blocks in each direction.
 
-    Point2i  m_position;    //< Relative position of the current block.
-    /// Direction where the spiral is currently headed.
-    Direction m_current_direction;
-    /// Step counters.
-    int m_steps_left, m_steps;
+    /// Scheduled work items; entries below \ref m_queue_size never change
+    std::vector<std::pair<Vector2i, Vector2i>> m_queue;
+
+    /// Number of published entries in \ref m_queue
+    std::atomic<size_t> m_queue_size;
+
+    /// All entries below this watermark have been claimed (scan hint)
+    std::atomic<size_t> m_block_index;
+
+    /// Number of claimed schedule entries; the pass is over once this
+    /// catches up with \ref m_queue_size
+    std::atomic<size_t> m_claimed_count;
+
+    /// One claim flag per schedule entry (same capacity as \ref m_queue)
+    std::unique_ptr<std::atomic<uint8_t>[]> m_claimed;
+
+    /// Worker that last rendered each block of the regular grid
+    std::unique_ptr<std::atomic<uint32_t>[]> m_owner;
+
+    /// Per-worker scan position within the schedule (touched only by the
+    /// owning worker)
+    std::vector<size_t> m_worker_scan;
+
+    /// Number of workers declared via \ref set_worker_count()
+    uint32_t m_worker_count;
+
+    /// Accumulated per-block cost feedback (one entry per grid block)
+    std::unique_ptr<AtomicFloat<float>[]> m_cost;
+
+    /// Optional density estimates used before cost feedback exists
+    std::unique_ptr<float[]> m_density;
 
     /// Number of times the spiral should automatically restart.
     size_t m_remaining_passes;
 
-    /// Protects the spiral's state (thread safety).
+    /// Serializes pass transitions and calls to \ref reset.
     tbb::spin_mutex m_mutex;
 };
 
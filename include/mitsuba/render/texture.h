@@ -85,6 +85,47 @@ public:
     //! @}
     // ======================================================================
 
+    // =============================================================
+    //! @{ \name Batched evaluation interface
+    // =============================================================
+
+    /**
+     * \brief Evaluate the texture at an array of surface interactions
+     *
+     * Batched variant of \ref eval() that processes \c count interaction
+     * records with a single virtual call, writing one result per record to
+     * \c out. Implementations with nontrivial per-call setup (UV transform,
+     * image metadata loads) are encouraged to override this method and hoist
+     * that work out of the loop -- in the scalar variants, this amortizes
+     * both the setup and the virtual dispatch overhead. The default
+     * implementation simply loops over \ref eval().
+     */
+    virtual void eval_n(const SurfaceInteraction3f *si, size_t count,
+                        UnpolarizedSpectrum *out, Mask active = true) const;
+
+    /**
+     * \brief Monochromatic evaluation of the texture at an array of surface
+     * interactions
+     *
+     * Batched variant of \ref eval_1(), analogous to \ref eval_n().
+     */
+    virtual void eval_1_n(const SurfaceInteraction3f *si, size_t count,
+                          Float *out, Mask active = true) const;
+
+    /**
+     * \brief Evaluate the sampling density at an array of surface
+     * interactions
+     *
+     * Batched variant of \ref pdf(), analogous to \ref eval_n(). The default
+     * implementation loops over \ref pdf() and hence throws when the
+     * underlying texture does not provide that method.
+     */
+    virtual void pdf_n(const SurfaceInteraction3f *si, size_t count,
+                       Wavelength *out, Mask active = true) const;
+
+    //! @}
+    // ======================================================================
+
     // =============================================================
     //! @{ \name Specialized evaluation routines
     // =============================================================
@@ -136,6 +177,16 @@ public:
      */
     virtual ScalarFloat mean() const;
 
+    /**
+     * Does the texture depend on the \c uv coordinates of the queried
+     * surface position?
+     *
+     * When this function returns \c false, a single evaluation at an
+     * arbitrary position characterizes the texture everywhere, which
+     * enables various precomputations.
+     */
+    virtual bool is_spatially_varying() const { return false; }
+
     //! @}
     // ======================================================================
 
@@ -185,6 +236,34 @@ public:
     /// Returns the maximum value of the texture over all dimensions.
     virtual ScalarFloat max() const;
 
+    /**
+     * \brief Returns a conservative maximum of the volume over the given
+     * world-space bounding box
+     *
+     * The default implementation simply returns the global maximum, which is
+     * always admissible. Discretized volumes are encouraged to override this
+     * with a tighter local bound -- it forms the basis of the majorant
+     * supergrid used by the heterogeneous medium.
+     */
+    virtual ScalarFloat max_over(const ScalarBoundingBox3f & /* bbox */) const {
+        return max();
+    }
+
+    /**
+     * \brief Returns an estimate of the average value of the volume over the
+     * given world-space bounding box
+     *
+     * The estimate serves as a control variate for residual ratio tracking
+     * in the heterogeneous medium and therefore does not need to be exact --
+     * any value between zero and the local maximum merely affects variance,
+     * not correctness. The default implementation returns half of the local
+     * maximum; discretized volumes are encouraged to override this with the
+     * actual local average.
+     */
+    virtual ScalarFloat mean_over(const ScalarBoundingBox3f &bbox) const {
+        return 0.5f * max_over(bbox);
+    }
+
     /// Returns the bounding box of the 3d texture
     ScalarBoundingBox3f bbox() const { return m_bbox; }
 
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <mitsuba/core/bbox.h>
+#include <mitsuba/core/object.h>
+#include <mitsuba/render/fwd.h>
+#include <atomic>
+#include <memory>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Conservative cache of shadow ray outcomes for emitter sampling
+ *
+ * In static scenes, shadow rays traced from nearby shading points towards the
+ * same emitter almost always agree: a shading point deep inside a room either
+ * sees a given light fixture or is separated from it by a wall, and both
+ * classifications tend to hold for its entire neighborhood. This class
+ * exploits that coherence with a fixed-size, open-addressed hash table over
+ * (position cell, emitter) pairs, where the position cell stems from a
+ * regular grid over the scene bounding box. Each entry counts how often the
+ * pair was observed to be occluded and visible; once a sufficient number of
+ * unanimous observations has accumulated, subsequent lookups answer the
+ * visibility query directly and the shadow ray is skipped altogether.
+ *
+ * Several safeguards keep the classification conservative: pairs with mixed
+ * observations (i.e. cells straddling an occluder boundary) are never
+ * answered from the cache, a fixed fraction of lookups deliberately falls
+ * through to a real shadow ray so that a stale classification cannot persist
+ * indefinitely, and any contradicting observation resets the affected entry.
+ * Entries are furthermore invalidated wholesale when the scene changes (see
+ * \ref Scene::parameters_changed()). The cache is nonetheless an
+ * approximation -- a sub-cell geometric feature can be missed between
+ * re-validations -- and is therefore opt-in via the scene-level
+ * \c visibility_cache attribute.
+ *
+ * All operations use relaxed atomics and may be invoked concurrently from
+ * all worker threads; a lost update merely discards one observation.
+ *
+ * \remark The cache is only consulted by the scalar variants, where an
+ * individual shadow ray can actually be elided. Packet and GPU variants
+ * trace entire wavefronts per call and bypass it.
+ */
+template <typename Float, typename Spectrum>
+class MTS_EXPORT_RENDER VisibilityCache : public Object {
+public:
+    MTS_IMPORT_TYPES()
+
+    /**
+     * \brief Construct an empty visibility cache
+     *
+     * \param bbox
+     *    Bounding box of the scene, which defines the spatial grid used to
+     *    discretize shading point positions
+     *
+     * \param resolution
+     *    Number of grid cells along each axis of the bounding box
+     *
+     * \param table_size
+     *    Number of hash table entries (must be a power of two). Colliding
+     *    pairs evict each other, hence the table never grows.
+     */
+    VisibilityCache(const ScalarBoundingBox3f &bbox, uint32_t resolution = 128,
+                    size_t table_size = (size_t) 1 << 18);
+
+    /**
+     * \brief Try to answer a visibility query from the cache
+     *
+     * \param p
+     *    The shading point position
+     *
+     * \param emitter
+     *    The emitter targeted by the shadow ray
+     *
+     * \param occluded
+     *    Set to the cached classification if the lookup succeeds
+     *
+     * \return \c true if the query was answered and the shadow ray can be
+     *    skipped, \c false if it must be traced (in which case the outcome
+     *    should be reported back via \ref record())
+     */
+    bool lookup(const ScalarPoint3f &p, const Object *emitter,
+                bool &occluded) const;
+
+    /// Report the outcome of a traced shadow ray back to the cache
+    void record(const ScalarPoint3f &p, const Object *emitter, bool occluded);
+
+    /// Discard all cached classifications (e.g. after a scene update)
+    void clear();
+
+    /// Return a human-readable string representation
+    virtual std::string to_string() const override;
+
+    MTS_DECLARE_CLASS()
+protected:
+    /// Virtual destructor
+    virtual ~VisibilityCache() = default;
+
+    /// Hash of the (position cell, emitter) pair; never zero
+    uint64_t cell_hash(const ScalarPoint3f &p, const Object *emitter) const;
+
+protected:
+    /// Number of unanimous observations required before lookups are answered
+    static constexpr uint32_t Confidence = 32;
+    /// One out of this many lookups re-validates the cached classification
+    static constexpr uint32_t RevalidationPeriod = 64;
+    /// Saturation value of the observation counters
+    static constexpr uint32_t CounterLimit = 1 << 16;
+
+    struct Entry {
+        /// Hash of the (position cell, emitter) pair, 0 = unused slot
+        std::atomic<uint64_t> key { 0 };
+        /// Number of observations that found the pair occluded / visible
+        std::atomic<uint32_t> occluded { 0 };
+        std::atomic<uint32_t> visible { 0 };
+        /// Number of lookups answered from this entry (drives re-validation)
+        mutable std::atomic<uint32_t> queries { 0 };
+    };
+
+    ScalarBoundingBox3f m_bbox;
+    /// Precomputed \c resolution / \c bbox.extents() factor
+    ScalarVector3f m_inv_cell;
+    uint32_t m_resolution;
+    /// Table size minus one (the size is a power of two)
+    size_t m_mask;
+    std::unique_ptr<Entry[]> m_entries;
+};
+
+MTS_EXTERN_CLASS_RENDER(VisibilityCache)
+NAMESPACE_END(mitsuba)
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <mitsuba/ui/fwd.h>
+#include <mitsuba/ui/texture.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Streams raw rendered tiles to the GPU, where they are tonemapped
+ *
+ * This class implements the display path of the viewer: rendered tiles are
+ * uploaded in their raw high dynamic range form through a pair of pixel
+ * buffer objects that are used in round-robin fashion, hence the driver's
+ * transfer of one tile overlaps the preparation of the next. Exposure and
+ * sRGB gamma correction are applied by a fragment shader when the image is
+ * developed into the display texture, so no full-frame conversion ever runs
+ * on the CPU -- even 8K previews update at interactive rates without
+ * stealing cores from the renderer.
+ *
+ * Must be used on a thread with a current OpenGL context.
+ */
+class MTS_EXPORT_UI GPUTileStream : public Object {
+public:
+    /// Allocate GPU-side storage for an image of the given size
+    GPUTileStream(const Vector<int, 2> &size);
+
+    /**
+     * \brief Upload a raw tile of rendered data
+     *
+     * \param offset
+     *     Position of the tile within the image, in pixels
+     * \param size
+     *     Size of the tile, in pixels
+     * \param data
+     *     Row-major RGBA single precision data containing
+     *     <tt>size.x() * size.y()</tt> pixels
+     */
+    void put_tile(const Vector<int, 2> &offset, const Vector<int, 2> &size,
+                  const float *data);
+
+    /// Upload an entire RGBA single precision bitmap as one tile
+    void put_bitmap(const Bitmap *bitmap);
+
+    /// Set the exposure value (in f-stops) applied during tonemapping
+    void set_exposure(float exposure);
+
+    /// Return the current exposure value (in f-stops)
+    float exposure() const { return m_exposure; }
+
+    /**
+     * \brief Return the tonemapped image
+     *
+     * Re-runs the tonemapping pass if tiles arrived or the exposure changed
+     * since the last call. The returned texture can be displayed directly,
+     * e.g. via \c nanogui::ImageView.
+     */
+    GPUTexture *texture();
+
+    /// Return the image size, in pixels
+    const Vector<int, 2> &size() const { return m_size; }
+
+protected:
+    virtual ~GPUTileStream();
+
+    /// Develop the raw data into \ref m_display using the tonemap shader
+    void refresh();
+
+protected:
+    Vector<int, 2> m_size;
+    float m_exposure = 0.f;
+    bool m_dirty = true;
+
+    /// Raw high dynamic range framebuffer contents
+    uint32_t m_hdr_texture = 0;
+    /// Round-robin upload buffers and index of the one to use next
+    uint32_t m_pbo[2] { 0, 0 };
+    uint32_t m_pbo_index = 0;
+    /// Tonemapping pass (framebuffer, empty VAO, shader program)
+    uint32_t m_framebuffer = 0;
+    uint32_t m_vertex_array = 0;
+    uint32_t m_program = 0;
+
+    /// Tonemapped output displayed by the viewer
+    ng::ref<GPUTexture> m_display;
+};
+
+NAMESPACE_END(mitsuba)
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <mitsuba/ui/fwd.h>
+#include <mitsuba/core/xml.h>
 #include <nanogui/screen.h>
 
 NAMESPACE_BEGIN(mitsuba)
@@ -20,8 +21,28 @@ public:
     /// Append an empty tab
     Tab *append_tab(const std::string &caption);
 
-    /// Load content (a scene or an image) into a tab
-    void load(Tab *tab, const fs::path &scene);
+    /**
+     * \brief Load content (a scene or an image) into a tab
+     *
+     * Intended to be invoked from a worker thread (see \ref
+     * ScopedSetThreadEnvironment) so that parsing a large scene does not
+     * block the user interface; log output and load progress are marshaled
+     * back to the UI thread through the tab's console and the progress
+     * panel.
+     */
+    void load(Tab *tab, const fs::path &scene,
+              xml::ParameterList parameters = xml::ParameterList());
+
+    /**
+     * \brief Update the progress panel (thread-safe)
+     *
+     * \param caption
+     *     Short description of the current operation (e.g. "Loading")
+     * \param value
+     *     Completion fraction in <tt>[0, 1]</tt>, or a negative value to
+     *     hide the progress panel
+     */
+    void set_progress(const std::string &caption, float value);
 
     using ng::Screen::perform_layout;
     virtual void perform_layout(NVGcontext* ctx) override;
@@ -35,6 +56,7 @@ protected:
     ng::ref<ng::PopupButton> m_btn_menu, m_btn_settings;
     ng::ref<ng::Widget> m_contents, m_progress_panel;
     ng::ref<ng::ProgressBar> m_progress_bar;
+    ng::ref<ng::Label> m_progress_caption, m_progress_label;
     ng::ref<ng::TabWidgetBase> m_tab_widget;
     ng::ref<ng::ImageView> m_view;
     std::vector<Tab *> m_tabs;
@@ -212,6 +212,13 @@ public:
         } else {
             std::tie(m_eta, m_k) = complex_ior_from_file<Spectrum, Texture>(props.string("material", "Cu"));
         }
+
+        parameters_changed();
+    }
+
+    void parameters_changed() override {
+        m_fresnel_curve =
+            ConductorReflectanceCurve<Float, Spectrum>(m_eta.get(), m_k.get());
     }
 
     std::pair<BSDFSample3f, Spectrum> sample(const BSDFContext &ctx,
@@ -235,11 +242,11 @@ public:
         bs.eta = 1.f;
         bs.pdf = 1.f;
 
-        Complex<UnpolarizedSpectrum> eta(m_eta->eval(si, active),
-                                         m_k->eval(si, active));
         UnpolarizedSpectrum reflectance = m_specular_reflectance->eval(si, active);
 
         if constexpr (is_polarized_v<Spectrum>) {
+            Complex<UnpolarizedSpectrum> eta(m_eta->eval(si, active),
+                                             m_k->eval(si, active));
             /* Due to lack of reciprocity in polarization-aware pBRDFs, they are
                always evaluated w.r.t. the actual light propagation direction, no
                matter the transport mode. In the following, 'wi_hat' is toward the
@@ -269,7 +276,15 @@ public:
                                                    wo_hat, p_axis_out, mueller::stokes_basis(wo_hat));
             value *= mueller::absorber(reflectance);
         } else {
-            value = reflectance * fresnel_conductor(UnpolarizedSpectrum(cos_theta_i), eta);
+            UnpolarizedSpectrum F;
+            if (likely(!m_fresnel_curve.empty())) {
+                F = m_fresnel_curve.eval(cos_theta_i, active);
+            } else {
+                Complex<UnpolarizedSpectrum> eta(m_eta->eval(si, active),
+                                                 m_k->eval(si, active));
+                F = fresnel_conductor(UnpolarizedSpectrum(cos_theta_i), eta);
+            }
+            value = reflectance * F;
         }
 
         return { bs, value & active };
@@ -305,6 +320,8 @@ public:
 private:
     ref<Texture> m_specular_reflectance;
     ref<Texture> m_eta, m_k;
+    /// Tabulated reflectance when eta/k permit precomputation (see \ref ConductorReflectanceCurve)
+    ConductorReflectanceCurve<Float, Spectrum> m_fresnel_curve;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(SmoothConductor, BSDF)
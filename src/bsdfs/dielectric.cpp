@@ -20,6 +20,13 @@ Smooth dielectric material (:monosp:`dielectric`)
  * - ext_ior
    - |float| or |string|
    - Exterior index of refraction specified numerically or using a known material name.  (Default: air / 1.000277)
+ * - abbe
+   - |float|
+   - Abbe number :math:`V_d` of the interior medium, which enables
+     wavelength-dependent refraction (dispersion) in the unpolarized spectral
+     rendering modes. The index of refraction then follows a two-term Cauchy
+     model fitted through the Fraunhofer d, F and C lines, with :paramtype:`int_ior`
+     interpreted as the value at the d line (587.6nm). (Default: disabled)
  * - specular_reflectance
    - |spectrum| or |texture|
    - Optional factor that can be used to modulate the specular reflection component. Note that for physical realism, this parameter should never be touched. (Default: 1.0)
@@ -89,9 +96,15 @@ In *polarized* rendering modes, the material automatically switches to a polariz
 implementation of the underlying Fresnel equations that quantify the reflectance and
 transmission.
 
-.. note::
-
-    Dispersion is currently unsupported but will be enabled in a future release.
+When an Abbe number is specified in a spectral variant, the interface becomes
+*dispersive*. Since the refraction direction then differs per wavelength, a
+sampled transmitted path follows the first (*hero*) wavelength of the current
+wavelength packet and terminates the remaining strata, whose selection
+probability for this exact direction is zero -- one traced path thus still
+serves the entire packet, and reflected paths continue to carry all
+wavelengths. The default wavelength sampling draws equally-shifted
+(stratified) wavelengths, so each wavelength regularly takes on the hero
+role over the course of rendering.
 
 Instead of specifying numerical values for the indices of refraction, Mitsuba 2
 comes with a list of presets that can be specified with the :paramtype:`material`
@@ -184,6 +197,36 @@ public:
 
         m_eta = int_ior / ext_ior;
 
+        /* Optional wavelength-dependent index of refraction (dispersion),
+           expressed as a two-term Cauchy model fitted to the Abbe number of
+           the interior medium. The exterior medium is assumed to be free of
+           dispersion. */
+        m_dispersion = props.has_property("abbe");
+        m_cauchy_a = m_eta;
+        m_cauchy_b = 0.f;
+        if (m_dispersion) {
+            if constexpr (!is_spectral_v<Spectrum> || is_polarized_v<Spectrum>) {
+                Log(Warn, "The \"abbe\" parameter (dispersion) is only "
+                          "supported in the unpolarized spectral modes and "
+                          "will be ignored.");
+                m_dispersion = false;
+            } else {
+                ScalarFloat abbe = props.float_("abbe");
+                if (abbe <= 0.f)
+                    Throw("The Abbe number must be positive!");
+
+                // Fraunhofer d, F and C lines (in micrometers)
+                ScalarFloat lambda_d = 0.5875618f,
+                            lambda_F = 0.4861327f,
+                            lambda_C = 0.6562725f;
+
+                ScalarFloat b = (int_ior - 1.f) /
+                    (abbe * (1.f / sqr(lambda_F) - 1.f / sqr(lambda_C)));
+                m_cauchy_b = b / ext_ior;
+                m_cauchy_a = (int_ior - b / sqr(lambda_d)) / ext_ior;
+            }
+        }
+
         m_specular_reflectance   = props.texture<Texture>("specular_reflectance", 1.f);
         m_specular_transmittance = props.texture<Texture>("specular_transmittance", 1.f);
 
@@ -205,10 +248,24 @@ public:
         bool has_reflection   = ctx.is_enabled(BSDFFlags::DeltaReflection, 0),
              has_transmission = ctx.is_enabled(BSDFFlags::DeltaTransmission, 1);
 
-        // Evaluate the Fresnel equations for unpolarized illumination
         Float cos_theta_i = Frame3f::cos_theta(si.wi);
 
-        auto [r_i, cos_theta_t, eta_it, eta_ti] = fresnel(cos_theta_i, Float(m_eta));
+        /* In dispersive mode, the relative index of refraction depends on
+           the wavelength; the sampled direction and lobe selection are
+           decided by the first ("hero") wavelength of the packet. The
+           remaining strata are re-weighted further below. */
+        Float eta_hero = m_eta;
+        Wavelength eta_w;
+        if constexpr (is_spectral_v<Spectrum>) {
+            if (m_dispersion) {
+                eta_w = m_cauchy_a +
+                        m_cauchy_b / sqr(si.wavelengths * 1e-3f); // nm -> um
+                eta_hero = eta_w.x();
+            }
+        }
+
+        // Evaluate the Fresnel equations for unpolarized illumination
+        auto [r_i, cos_theta_t, eta_it, eta_ti] = fresnel(cos_theta_i, eta_hero);
         Float t_i = 1.f - r_i;
 
         // Lobe selection
@@ -299,6 +356,28 @@ public:
                 weight[selected_t] *= transmittance;
         }
 
+        if constexpr (is_spectral_v<Spectrum> && !is_polarized_v<Spectrum>) {
+            if (m_dispersion) {
+                /* Hero wavelength re-weighting: the reflected direction is
+                   shared by all wavelengths, so each stratum carries its own
+                   Fresnel reflectance over the hero selection probability.
+                   The refracted direction only matches the hero wavelength;
+                   the secondary strata are terminated, as their MIS weight
+                   under the delta transmission lobe is zero. */
+                Wavelength r_w =
+                    std::get<0>(fresnel(Wavelength(cos_theta_i), eta_w));
+
+                if (any_or<true>(selected_r))
+                    weight[selected_r] *= Spectrum(r_w) / r_i;
+
+                if (any_or<true>(selected_t)) {
+                    Spectrum hero = zero<Spectrum>();
+                    hero.x() = 1.f;
+                    weight[selected_t] *= hero;
+                }
+            }
+        }
+
         if (any_or<true>(selected_t)) {
             /* For transmission, radiance must be scaled to account for the solid
                angle compression that occurs when crossing the interface. */
@@ -329,6 +408,7 @@ public:
         std::ostringstream oss;
         oss << "SmoothDielectric[" << std::endl
             << "  eta = " << m_eta << "," << std::endl
+            << "  dispersion = " << (int) m_dispersion << "," << std::endl
             << "  specular_reflectance = " << string::indent(m_specular_reflectance) << "," << std::endl
             << "  specular_transmittance = " << string::indent(m_specular_transmittance) << std::endl
             << "]";
@@ -338,6 +418,9 @@ public:
     MTS_DECLARE_CLASS()
 private:
     ScalarFloat m_eta;
+    /// Cauchy coefficients of the relative IOR (dispersive mode)
+    ScalarFloat m_cauchy_a, m_cauchy_b;
+    bool m_dispersion;
     ref<Texture> m_specular_reflectance;
     ref<Texture> m_specular_transmittance;
 };
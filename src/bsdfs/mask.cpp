@@ -80,6 +80,34 @@ public:
         if (!m_nested_bsdf)
            Throw("Child BSDF not specified");
 
+        /* Load-time flattening: "mask(twosided(x))" is the most common
+           adapter stack in typical scenes (e.g. foliage). Harvest the
+           two-sided adapter's children and inline its frame-flipping logic
+           here (see \ref nested_eval() etc.), which saves one virtual
+           dispatch and redundant frame queries per shading event. The
+           wrapper object remains referenced, so traverse() still exposes
+           the original parameter hierarchy. */
+        if (m_nested_bsdf->class_()->name() == "TwoSidedBRDF") {
+            struct Collector : TraversalCallback {
+                std::vector<std::pair<std::string, Object *>> objects;
+                void put_object(const std::string &name, Object *obj) override {
+                    objects.emplace_back(name, obj);
+                }
+                void put_parameter_impl(const std::string &,
+                                        const std::type_info &,
+                                        void *) override { }
+            } collector;
+            m_nested_bsdf->traverse(&collector);
+
+            for (auto &kv : collector.objects) {
+                if (kv.first == "brdf_0")
+                    m_fused_brdf[0] = dynamic_cast<Base *>(kv.second);
+                else if (kv.first == "brdf_1")
+                    m_fused_brdf[1] = dynamic_cast<Base *>(kv.second);
+            }
+            m_fused = m_fused_brdf[0] && m_fused_brdf[1];
+        }
+
         parameters_changed();
     }
 
@@ -124,7 +152,7 @@ public:
         Mask nested_mask = active && sample1 < opacity;
         if (any_or<true>(nested_mask)) {
             sample1 /= opacity;
-            auto tmp                = m_nested_bsdf->sample(ctx, si, sample1, sample2, nested_mask);
+            auto tmp                = nested_sample(ctx, si, sample1, sample2, nested_mask);
             masked(bs, nested_mask) = tmp.first;
             masked(result, nested_mask) = tmp.second;
         }
@@ -137,7 +165,7 @@ public:
         MTS_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
 
         Float opacity = eval_opacity(si, active);
-        return m_nested_bsdf->eval(ctx, si, wo, active) * opacity;
+        return nested_eval(ctx, si, wo, active) * opacity;
     }
 
     Float pdf(const BSDFContext &ctx, const SurfaceInteraction3f &si,
@@ -151,17 +179,170 @@ public:
         if (!sample_nested)
             return 0.f;
 
-        Float result = m_nested_bsdf->pdf(ctx, si, wo, active);
+        Float result = nested_pdf(ctx, si, wo, active);
         if (sample_transmission)
             result *= eval_opacity(si, active);
 
         return result;
     }
 
+    std::pair<Spectrum, Float> eval_pdf(const BSDFContext &ctx,
+                                        const SurfaceInteraction3f &si,
+                                        const Vector3f &wo,
+                                        Mask active) const override {
+        MTS_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
+
+        uint32_t null_index      = (uint32_t) component_count() - 1;
+        bool sample_transmission = ctx.is_enabled(BSDFFlags::Null, null_index);
+        bool sample_nested       = ctx.component == (uint32_t) -1 || ctx.component < null_index;
+
+        // The opacity lookup is shared between the value and the density
+        Float opacity = eval_opacity(si, active);
+
+        auto [value, pdf] = nested_eval_pdf(ctx, si, wo, active);
+        value *= opacity;
+
+        if (!sample_nested)
+            pdf = 0.f;
+        else if (sample_transmission)
+            pdf *= opacity;
+
+        return { value, pdf };
+    }
+
     MTS_INLINE Float eval_opacity(const SurfaceInteraction3f &si, Mask active) const {
         return clamp(m_opacity->eval_1(si, active), 0.f, 1.f);
     }
 
+    /* The three helpers below dispatch into the nested BSDF. In fused mode,
+       they reproduce the two-sided adapter's frame-flipping logic inline and
+       jump straight to its children, skipping the wrapper object. */
+
+    MTS_INLINE std::pair<BSDFSample3f, Spectrum>
+    nested_sample(const BSDFContext &ctx_, const SurfaceInteraction3f &si_,
+                  Float sample1, const Point2f &sample2, Mask active) const {
+        if (likely(!m_fused))
+            return m_nested_bsdf->sample(ctx_, si_, sample1, sample2, active);
+
+        using Result = std::pair<BSDFSample3f, Spectrum>;
+
+        SurfaceInteraction3f si(si_);
+        BSDFContext ctx(ctx_);
+
+        Mask front_side = Frame3f::cos_theta(si.wi) > 0.f && active,
+             back_side  = Frame3f::cos_theta(si.wi) < 0.f && active;
+
+        Result result = zero<Result>();
+        if (any_or<true>(front_side))
+            masked(result, front_side) =
+                m_fused_brdf[0]->sample(ctx, si, sample1, sample2, front_side);
+
+        if (any_or<true>(back_side)) {
+            if (ctx.component != (uint32_t) -1)
+                ctx.component -= (uint32_t) m_fused_brdf[0]->component_count();
+
+            si.wi.z() *= -1.f;
+            masked(result, back_side) =
+                m_fused_brdf[1]->sample(ctx, si, sample1, sample2, back_side);
+            masked(result.first.wo.z(), back_side) *= -1.f;
+        }
+
+        return result;
+    }
+
+    MTS_INLINE Spectrum nested_eval(const BSDFContext &ctx_,
+                                    const SurfaceInteraction3f &si_,
+                                    const Vector3f &wo_, Mask active) const {
+        if (likely(!m_fused))
+            return m_nested_bsdf->eval(ctx_, si_, wo_, active);
+
+        SurfaceInteraction3f si(si_);
+        BSDFContext ctx(ctx_);
+        Vector3f wo(wo_);
+        Spectrum result = 0.f;
+
+        Mask front_side = Frame3f::cos_theta(si.wi) > 0.f && active,
+             back_side  = Frame3f::cos_theta(si.wi) < 0.f && active;
+
+        if (any_or<true>(front_side))
+            result = m_fused_brdf[0]->eval(ctx, si, wo, front_side);
+
+        if (any_or<true>(back_side)) {
+            if (ctx.component != (uint32_t) -1)
+                ctx.component -= (uint32_t) m_fused_brdf[0]->component_count();
+
+            si.wi.z() *= -1.f;
+            wo.z() *= -1.f;
+
+            masked(result, back_side) = m_fused_brdf[1]->eval(ctx, si, wo, back_side);
+        }
+
+        return result;
+    }
+
+    MTS_INLINE std::pair<Spectrum, Float>
+    nested_eval_pdf(const BSDFContext &ctx_, const SurfaceInteraction3f &si_,
+                    const Vector3f &wo_, Mask active) const {
+        if (likely(!m_fused))
+            return m_nested_bsdf->eval_pdf(ctx_, si_, wo_, active);
+
+        using Result = std::pair<Spectrum, Float>;
+
+        SurfaceInteraction3f si(si_);
+        BSDFContext ctx(ctx_);
+        Vector3f wo(wo_);
+
+        Mask front_side = Frame3f::cos_theta(si.wi) > 0.f && active,
+             back_side  = Frame3f::cos_theta(si.wi) < 0.f && active;
+
+        Result result = zero<Result>();
+        if (any_or<true>(front_side))
+            result = m_fused_brdf[0]->eval_pdf(ctx, si, wo, front_side);
+
+        if (any_or<true>(back_side)) {
+            if (ctx.component != (uint32_t) -1)
+                ctx.component -= (uint32_t) m_fused_brdf[0]->component_count();
+
+            si.wi.z() *= -1.f;
+            wo.z() *= -1.f;
+
+            masked(result, back_side) =
+                m_fused_brdf[1]->eval_pdf(ctx, si, wo, back_side);
+        }
+
+        return result;
+    }
+
+    MTS_INLINE Float nested_pdf(const BSDFContext &ctx_,
+                                const SurfaceInteraction3f &si_,
+                                const Vector3f &wo_, Mask active) const {
+        if (likely(!m_fused))
+            return m_nested_bsdf->pdf(ctx_, si_, wo_, active);
+
+        SurfaceInteraction3f si(si_);
+        BSDFContext ctx(ctx_);
+        Vector3f wo(wo_);
+        Float result = 0.f;
+
+        Mask front_side = Frame3f::cos_theta(si.wi) > 0.f && active,
+             back_side  = Frame3f::cos_theta(si.wi) < 0.f && active;
+
+        if (any_or<true>(front_side))
+            result = m_fused_brdf[0]->pdf(ctx, si, wo, front_side);
+
+        if (any_or<true>(back_side)) {
+            if (ctx.component != (uint32_t) -1)
+                ctx.component -= (uint32_t) m_fused_brdf[0]->component_count();
+
+            si.wi.z() *= -1.f;
+            wo.z() *= -1.f;
+
+            masked(result, back_side) = m_fused_brdf[1]->pdf(ctx, si, wo, back_side);
+        }
+
+        return result;
+    }
+
     void traverse(TraversalCallback *callback) override {
         callback->put_object("opacity", m_opacity.get());
         callback->put_object("nested_bsdf", m_nested_bsdf.get());
@@ -180,6 +361,10 @@ public:
 private:
     ref<Texture> m_opacity;
     ref<Base> m_nested_bsdf;
+
+    /// Children of a flattened two-sided adapter (see the constructor)
+    ref<Base> m_fused_brdf[2];
+    bool m_fused = false;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(MaskBSDF, BSDF)
@@ -1,3 +1,7 @@
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/fresolver.h>
 #include <mitsuba/core/tensor.h>
@@ -23,6 +27,17 @@ public:
     using Warp2D2 = Marginal2D<Float, 2, true>;
     using Warp2D3 = Marginal2D<Float, 3, true>;
 
+    /// Warp structures and flags derived from a .bsdf file, shared
+    /// between all plugin instances referencing the same file
+    struct MeasuredData {
+        Warp2D0 ndf, sigma;
+        Warp2D2 vndf, luminance;
+        Warp2D3 spectra;
+        bool isotropic = false;
+        bool jacobian  = false;
+        int reduction  = 0;
+    };
+
     Measured(const Properties &props) : Base(props) {
         if constexpr (is_polarized_v<Spectrum>)
             Throw("The measured BSDF model requires that rendering takes place in spectral mode!");
@@ -34,6 +49,24 @@ public:
         fs::path file_path = fs->resolve(props.string("filename"));
         m_name             = file_path.filename().string();
 
+        /* The tensor file contents and the warp structures built from them
+           are identical for every instance referencing the same file --
+           scenes based on measured material libraries instantiate the same
+           .bsdf files many times, so share them across instances. */
+        m_data = load_data(file_path);
+    }
+
+    static std::shared_ptr<MeasuredData> load_data(const fs::path &file_path) {
+        static std::mutex cache_mutex;
+        static std::unordered_map<std::string, std::weak_ptr<MeasuredData>> cache;
+
+        std::lock_guard<std::mutex> guard(cache_mutex);
+        std::weak_ptr<MeasuredData> &entry = cache[file_path.string()];
+        std::shared_ptr<MeasuredData> data = entry.lock();
+        if (data)
+            return data;
+        data = std::make_shared<MeasuredData>();
+
         ref<TensorFile> tf = new TensorFile(file_path);
         auto theta_i       = tf->field("theta_i");
         auto phi_i         = tf->field("phi_i");
@@ -90,31 +123,31 @@ public:
               jacobian.dtype == Struct::Type::UInt8))
               Throw("Invalid file structure: %s", tf->to_string());
 
-        m_isotropic = phi_i.shape[0] <= 2;
-        m_jacobian  = ((uint8_t *) jacobian.data)[0];
+        data->isotropic = phi_i.shape[0] <= 2;
+        data->jacobian  = ((uint8_t *) jacobian.data)[0];
 
-        if (!m_isotropic) {
+        if (!data->isotropic) {
             ScalarFloat *phi_i_data = (ScalarFloat *) phi_i.data;
-            m_reduction = (int) std::rint((2 * math::Pi<ScalarFloat>) /
+            data->reduction = (int) std::rint((2 * math::Pi<ScalarFloat>) /
                 (phi_i_data[phi_i.shape[0] - 1] - phi_i_data[0]));
         }
 
         // Construct NDF interpolant data structure
-        m_ndf = Warp2D0(
+        data->ndf = Warp2D0(
             (ScalarFloat *) ndf.data,
             ScalarVector2u(ndf.shape[1], ndf.shape[0]),
             { }, { }, false, false
         );
 
         // Construct projected surface area interpolant data structure
-        m_sigma = Warp2D0(
+        data->sigma = Warp2D0(
             (ScalarFloat *) sigma.data,
             ScalarVector2u(sigma.shape[1], sigma.shape[0]),
             { }, { }, false, false
         );
 
         // Construct VNDF warp data structure
-        m_vndf = Warp2D2(
+        data->vndf = Warp2D2(
             (ScalarFloat *) vndf.data,
             ScalarVector2u(vndf.shape[3], vndf.shape[2]),
             {{ (uint32_t) phi_i.shape[0],
@@ -124,7 +157,7 @@ public:
         );
 
         // Construct Luminance warp data structure
-        m_luminance = Warp2D2(
+        data->luminance = Warp2D2(
             (ScalarFloat *) luminance.data,
             ScalarVector2u(luminance.shape[3], luminance.shape[2]),
             {{ (uint32_t) phi_i.shape[0],
@@ -134,7 +167,7 @@ public:
         );
 
         // Construct spectral interpolant
-        m_spectra = Warp2D3(
+        data->spectra = Warp2D3(
             (ScalarFloat *) spectra.data,
             ScalarVector2u(spectra.shape[4], spectra.shape[3]),
             {{ (uint32_t) phi_i.shape[0],
@@ -154,6 +187,9 @@ public:
         Log(Info, "Loaded material \"%s\" (resolution %i x %i x %i x %i x %i)",
             description_str, spectra.shape[0], spectra.shape[1],
             spectra.shape[3], spectra.shape[4], spectra.shape[2]);
+
+        entry = data;
+        return data;
     }
 
     /**
@@ -183,9 +219,9 @@ public:
 
         Float sx = -1.f, sy = -1.f;
 
-        if (m_reduction >= 2) {
+        if (m_data->reduction >= 2) {
             sy = wi.y();
-            sx = (m_reduction == 4) ? wi.x() : sy;
+            sx = (m_data->reduction == 4) ? wi.x() : sy;
             wi.x() = mulsign_neg(wi.x(), sx);
             wi.y() = mulsign_neg(wi.y(), sy);
         }
@@ -203,15 +239,15 @@ public:
         Float pdf = 1.f;
 
         #if MTS_SAMPLE_LUMINANCE == 1
-        std::tie(sample, pdf) = m_luminance.sample(sample, params, active);
+        std::tie(sample, pdf) = m_data->luminance.sample(sample, params, active);
         #endif
 
-        auto [u_m, ndf_pdf] = m_vndf.sample(sample, params, active);
+        auto [u_m, ndf_pdf] = m_data->vndf.sample(sample, params, active);
 
         Float phi_m   = u2phi(u_m.y()),
             theta_m = u2theta(u_m.x());
 
-        if (m_isotropic)
+        if (m_data->isotropic)
             phi_m += phi_i;
 
         // Spherical -> Cartesian coordinates
@@ -240,11 +276,11 @@ public:
             phi_m   = atan2(m.y(), m.x());
 
         Vector2f u_m(theta2u(theta_m),
-                    phi2u(m_isotropic ? (phi_m - phi_i) : phi_m));
+                    phi2u(m_data->isotropic ? (phi_m - phi_i) : phi_m));
 
         u_m[1] = u_m[1] - floor(u_m[1]);
 
-    std::tie(sample, std::ignore) = m_vndf.invert(u_m, params, active);
+    std::tie(sample, std::ignore) = m_data->vndf.invert(u_m, params, active);
 #endif // MTS_SAMPLE_DIFFUSE
 
         bs.eta               = 1.f;
@@ -254,12 +290,12 @@ public:
         UnpolarizedSpectrum spec;
         for (size_t i = 0; i < array_size_v<UnpolarizedSpectrum>; ++i) {
             Float params_spec[3] = { phi_i, theta_i, si.wavelengths[i] };
-            spec[i] = m_spectra.eval(sample, params_spec, active);
+            spec[i] = m_data->spectra.eval(sample, params_spec, active);
         }
 
-        if (m_jacobian)
-            spec *= m_ndf.eval(u_m, params, active) /
-                    (4 * m_sigma.eval(u_wi, params, active));
+        if (m_data->jacobian)
+            spec *= m_data->ndf.eval(u_m, params, active) /
+                    (4 * m_data->sigma.eval(u_wi, params, active));
 
         bs.wo.x() = mulsign_neg(bs.wo.x(), sx);
         bs.wo.y() = mulsign_neg(bs.wo.y(), sy);
@@ -281,9 +317,9 @@ public:
         if (!ctx.is_enabled(BSDFFlags::GlossyReflection) || none_or<false>(active))
             return Spectrum(0.f);
 
-        if (m_reduction >= 2) {
+        if (m_data->reduction >= 2) {
             Float sy = wi.y(),
-                sx = (m_reduction == 4) ? wi.x() : sy;
+                sx = (m_data->reduction == 4) ? wi.x() : sy;
 
             wi.x() = mulsign_neg(wi.x(), sx);
             wi.y() = mulsign_neg(wi.y(), sy);
@@ -302,22 +338,22 @@ public:
         // Spherical coordinates -> unit coordinate system
         Vector2f u_wi(theta2u(theta_i), phi2u(phi_i)),
                 u_m (theta2u(theta_m), phi2u(
-                    m_isotropic ? (phi_m - phi_i) : phi_m));
+                    m_data->isotropic ? (phi_m - phi_i) : phi_m));
 
         u_m[1] = u_m[1] - floor(u_m[1]);
 
         Float params[2] = { phi_i, theta_i };
-        auto [sample, unused] = m_vndf.invert(u_m, params, active);
+        auto [sample, unused] = m_data->vndf.invert(u_m, params, active);
 
         UnpolarizedSpectrum spec;
         for (size_t i = 0; i < array_size_v<UnpolarizedSpectrum>; ++i) {
             Float params_spec[3] = { phi_i, theta_i, si.wavelengths[i] };
-            spec[i] = m_spectra.eval(sample, params_spec, active);
+            spec[i] = m_data->spectra.eval(sample, params_spec, active);
         }
 
-        if (m_jacobian)
-            spec *= m_ndf.eval(u_m, params, active) /
-                    (4 * m_sigma.eval(u_wi, params, active));
+        if (m_data->jacobian)
+            spec *= m_data->ndf.eval(u_m, params, active) /
+                    (4 * m_data->sigma.eval(u_wi, params, active));
 
         return unpolarized<Spectrum>(spec) & active;
     }
@@ -334,9 +370,9 @@ public:
         if (!ctx.is_enabled(BSDFFlags::GlossyReflection) || none_or<false>(active))
             return 0.f;
 
-        if (m_reduction >= 2) {
+        if (m_data->reduction >= 2) {
             Float sy = wi.y(),
-                sx = (m_reduction == 4) ? wi.x() : sy;
+                sx = (m_data->reduction == 4) ? wi.x() : sy;
 
             wi.x() = mulsign_neg(wi.x(), sx);
             wi.y() = mulsign_neg(wi.y(), sy);
@@ -358,16 +394,16 @@ public:
         // Spherical coordinates -> unit coordinate system
         Vector2f u_wi(theta2u(theta_i), phi2u(phi_i));
         Vector2f u_m (theta2u(theta_m),
-                    phi2u(m_isotropic ? (phi_m - phi_i) : phi_m));
+                    phi2u(m_data->isotropic ? (phi_m - phi_i) : phi_m));
 
         u_m[1] = u_m[1] - floor(u_m[1]);
 
         Float params[2] = { phi_i, theta_i };
-        auto [sample, vndf_pdf] = m_vndf.invert(u_m, params, active);
+        auto [sample, vndf_pdf] = m_data->vndf.invert(u_m, params, active);
 
         Float pdf = 1.f;
         #if MTS_SAMPLE_LUMINANCE == 1
-        pdf = m_luminance.eval(sample, params, active);
+        pdf = m_data->luminance.eval(sample, params, active);
         #endif
 
         Float jacobian =
@@ -384,11 +420,11 @@ public:
         std::ostringstream oss;
         oss << "Measured[" << std::endl
             << "  filename = \"" << m_name << "\"," << std::endl
-            << "  ndf = " << string::indent(m_ndf.to_string()) << "," << std::endl
-            << "  sigma = " << string::indent(m_sigma.to_string()) << "," << std::endl
-            << "  vndf = " << string::indent(m_vndf.to_string()) << "," << std::endl
-            << "  luminance = " << string::indent(m_luminance.to_string()) << "," << std::endl
-            << "  spectra = " << string::indent(m_spectra.to_string()) << std::endl
+            << "  ndf = " << string::indent(m_data->ndf.to_string()) << "," << std::endl
+            << "  sigma = " << string::indent(m_data->sigma.to_string()) << "," << std::endl
+            << "  vndf = " << string::indent(m_data->vndf.to_string()) << "," << std::endl
+            << "  luminance = " << string::indent(m_data->luminance.to_string()) << "," << std::endl
+            << "  spectra = " << string::indent(m_data->spectra.to_string()) << std::endl
             << "]";
         return oss.str();
     }
@@ -413,14 +449,7 @@ private:
 
 private:
     std::string m_name;
-    Warp2D0 m_ndf;
-    Warp2D0 m_sigma;
-    Warp2D2 m_vndf;
-    Warp2D2 m_luminance;
-    Warp2D3 m_spectra;
-    bool m_isotropic;
-    bool m_jacobian;
-    int m_reduction;
+    std::shared_ptr<MeasuredData> m_data;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(Measured, BSDF)
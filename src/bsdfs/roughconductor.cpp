@@ -48,6 +48,12 @@ Rough conductor material (:monosp:`roughconductor`)
    - Enables a sampling technique proposed by Heitz and D'Eon :cite:`Heitz1014Importance`, which
      focuses computation on the visible parts of the microfacet normal distribution, considerably
      reducing variance in some cases. (Default: |true|, i.e. use visible normal sampling)
+ * - precompute_visible
+   - |bool|
+   - Replaces the numerical inversion underlying Beckmann visible normal sampling by a
+     precomputed table that is interpolated at render time. This speeds up BSDF sampling
+     at the cost of a slight approximation, and has no effect on the GGX distribution,
+     whose sampling routine is already cheap. (Default: |false|)
 
 This plugin implements a realistic microfacet scattering model for rendering
 rough conducting materials, such as metals.
@@ -170,6 +176,16 @@ public:
 
         m_sample_visible = props.bool_("sample_visible", true);
 
+        if (props.bool_("precompute_visible", false)) {
+            if (m_type == MicrofacetType::Beckmann && m_sample_visible)
+                m_visible_table =
+                    std::make_unique<BeckmannVisibleTable<Float>>();
+            else
+                Log(Warn, "The \"precompute_visible\" parameter only applies "
+                          "to visible normal sampling with the Beckmann "
+                          "distribution -- ignoring.");
+        }
+
         if (props.has_property("alpha_u") || props.has_property("alpha_v")) {
             if (!props.has_property("alpha_u") || !props.has_property("alpha_v"))
                 Throw("Microfacet model: both 'alpha_u' and 'alpha_v' must be specified.");
@@ -192,6 +208,9 @@ public:
 
         m_components.clear();
         m_components.push_back(m_flags);
+
+        m_fresnel_curve =
+            ConductorReflectanceCurve<Float, Spectrum>(m_eta.get(), m_k.get());
     }
 
     std::pair<BSDFSample3f, Spectrum> sample(const BSDFContext &ctx,
@@ -214,6 +233,8 @@ public:
                                      m_alpha_u->eval_1(si, active),
                                      m_alpha_v->eval_1(si, active),
                                      m_sample_visible);
+        if (unlikely(m_visible_table != nullptr))
+            distr.set_visible_table(m_visible_table.get());
 
         // Sample M, the microfacet normal
         Normal3f m;
@@ -239,11 +260,10 @@ public:
         bs.pdf /= 4.f * dot(bs.wo, m);
 
         // Evaluate the Fresnel factor
-        Complex<UnpolarizedSpectrum> eta_c(m_eta->eval(si, active),
-                                           m_k->eval(si, active));
-
         Spectrum F;
         if constexpr (is_polarized_v<Spectrum>) {
+            Complex<UnpolarizedSpectrum> eta_c(m_eta->eval(si, active),
+                                               m_k->eval(si, active));
             /* Due to lack of reciprocity in polarization-aware pBRDFs, they are
                always evaluated w.r.t. the actual light propagation direction, no
                matter the transport mode. In the following, 'wi_hat' is toward the
@@ -271,7 +291,13 @@ public:
                                               -wi_hat, p_axis_in, mueller::stokes_basis(-wi_hat),
                                                wo_hat, p_axis_out, mueller::stokes_basis(wo_hat));
         } else {
-            F = fresnel_conductor(UnpolarizedSpectrum(dot(si.wi, m)), eta_c);
+            if (likely(!m_fresnel_curve.empty()))
+                F = m_fresnel_curve.eval(dot(si.wi, m), active);
+            else
+                F = fresnel_conductor(
+                    UnpolarizedSpectrum(dot(si.wi, m)),
+                    Complex<UnpolarizedSpectrum>(m_eta->eval(si, active),
+                                                 m_k->eval(si, active)));
         }
 
         return { bs, (F * weight) & active };
@@ -311,11 +337,10 @@ public:
         Float result = D * G / (4.f * Frame3f::cos_theta(si.wi));
 
         // Evaluate the Fresnel factor
-        Complex<UnpolarizedSpectrum> eta_c(m_eta->eval(si, active),
-                                           m_k->eval(si, active));
-
         Spectrum F;
         if constexpr (is_polarized_v<Spectrum>) {
+            Complex<UnpolarizedSpectrum> eta_c(m_eta->eval(si, active),
+                                               m_k->eval(si, active));
             /* Due to lack of reciprocity in polarization-aware pBRDFs, they are
                always evaluated w.r.t. the actual light propagation direction, no
                matter the transport mode. In the following, 'wi_hat' is toward the
@@ -343,7 +368,13 @@ public:
                                               -wi_hat, p_axis_in, mueller::stokes_basis(-wi_hat),
                                                wo_hat, p_axis_out, mueller::stokes_basis(wo_hat));
         } else {
-            F = fresnel_conductor(UnpolarizedSpectrum(dot(si.wi, H)), eta_c);
+            if (likely(!m_fresnel_curve.empty()))
+                F = m_fresnel_curve.eval(dot(si.wi, H), active);
+            else
+                F = fresnel_conductor(
+                    UnpolarizedSpectrum(dot(si.wi, H)),
+                    Complex<UnpolarizedSpectrum>(m_eta->eval(si, active),
+                                                 m_k->eval(si, active)));
         }
 
         return (F * result) & active;
@@ -386,6 +417,96 @@ public:
         return select(active, result, 0.f);
     }
 
+    std::pair<Spectrum, Float> eval_pdf(const BSDFContext &ctx,
+                                        const SurfaceInteraction3f &si,
+                                        const Vector3f &wo,
+                                        Mask active) const override {
+        MTS_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
+
+        Float cos_theta_i = Frame3f::cos_theta(si.wi),
+              cos_theta_o = Frame3f::cos_theta(wo);
+
+        active &= cos_theta_i > 0.f && cos_theta_o > 0.f;
+
+        if (unlikely(!ctx.is_enabled(BSDFFlags::GlossyReflection) || none_or<false>(active)))
+            return { 0.f, 0.f };
+
+        // Calculate the half-direction vector
+        Vector3f H = normalize(wo + si.wi);
+
+        /* Construct a microfacet distribution matching the
+           roughness values at the current surface position. */
+        MicrofacetDistribution distr(m_type,
+                                     m_alpha_u->eval_1(si, active),
+                                     m_alpha_v->eval_1(si, active),
+                                     m_sample_visible);
+
+        // Evaluate the microfacet normal distribution
+        Float D = distr.eval(H);
+
+        active &= neq(D, 0.f);
+
+        // Shadow-masking terms, shared between the value and the density
+        Float smith_g1_wi = distr.smith_g1(si.wi, H),
+              G           = smith_g1_wi * distr.smith_g1(wo, H);
+
+        // Evaluate the full microfacet model (except Fresnel)
+        Float value = D * G / (4.f * cos_theta_i);
+
+        /* See \ref pdf(): the micro/macro-surface agreement encoded in
+           smith_g1() must be replicated for the density */
+        Mask active_pdf = active && dot(si.wi, H) > 0.f && dot(wo, H) > 0.f;
+
+        Float pdf;
+        if (likely(m_sample_visible))
+            pdf = D * smith_g1_wi / (4.f * cos_theta_i);
+        else
+            pdf = distr.pdf(si.wi, H) / (4.f * dot(wo, H));
+
+        // Evaluate the Fresnel factor
+        Spectrum F;
+        if constexpr (is_polarized_v<Spectrum>) {
+            Complex<UnpolarizedSpectrum> eta_c(m_eta->eval(si, active),
+                                               m_k->eval(si, active));
+            /* Due to lack of reciprocity in polarization-aware pBRDFs, they are
+               always evaluated w.r.t. the actual light propagation direction, no
+               matter the transport mode. In the following, 'wi_hat' is toward the
+               light source. */
+            Vector3f wi_hat = ctx.mode == TransportMode::Radiance ? wo : si.wi,
+                     wo_hat = ctx.mode == TransportMode::Radiance ? si.wi : wo;
+
+            // Mueller matrix for specular reflection.
+            F = mueller::specular_reflection(UnpolarizedSpectrum(Frame3f::cos_theta(wi_hat)), eta_c);
+
+            /* Apply frame reflection, according to "Stellar Polarimetry" by
+               David Clarke, Appendix A.2 (A26) */
+            F = mueller::reverse(F);
+
+            /* The Stokes reference frame vector of this matrix lies in the plane
+               of reflection. */
+            Vector3f s_axis_in  = normalize(cross(H, -wi_hat)),
+                     p_axis_in  = normalize(cross(-wi_hat, s_axis_in)),
+                     s_axis_out = normalize(cross(H, wo_hat)),
+                     p_axis_out = normalize(cross(wo_hat, s_axis_out));
+
+            /* Rotate in/out reference vector of F s.t. it aligns with the implicit
+               Stokes bases of -wi_hat & wo_hat. */
+            F = mueller::rotate_mueller_basis(F,
+                                              -wi_hat, p_axis_in, mueller::stokes_basis(-wi_hat),
+                                               wo_hat, p_axis_out, mueller::stokes_basis(wo_hat));
+        } else {
+            if (likely(!m_fresnel_curve.empty()))
+                F = m_fresnel_curve.eval(dot(si.wi, H), active);
+            else
+                F = fresnel_conductor(
+                    UnpolarizedSpectrum(dot(si.wi, H)),
+                    Complex<UnpolarizedSpectrum>(m_eta->eval(si, active),
+                                                 m_k->eval(si, active)));
+        }
+
+        return { (F * value) & active, select(active_pdf, pdf, 0.f) };
+    }
+
     void traverse(TraversalCallback *callback) override {
         if (m_alpha_u == m_alpha_v)
             callback->put_object("alpha", m_alpha_u.get());
@@ -418,10 +539,14 @@ private:
     ref<Texture> m_alpha_u, m_alpha_v;
     /// Importance sample the distribution of visible normals?
     bool m_sample_visible;
+    /// Optional precomputed inversion table for Beckmann visible normal sampling
+    std::unique_ptr<BeckmannVisibleTable<Float>> m_visible_table;
     /// Relative refractive index (real component)
     ref<Texture> m_eta;
     /// Relative refractive index (imaginary component).
     ref<Texture> m_k;
+    /// Tabulated reflectance when eta/k permit precomputation (see \ref ConductorReflectanceCurve)
+    ConductorReflectanceCurve<Float, Spectrum> m_fresnel_curve;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(RoughConductor, BSDF)
@@ -52,6 +52,12 @@ Rough dielectric material (:monosp:`roughdielectric`)
    - Enables a sampling technique proposed by Heitz and D'Eon :cite:`Heitz1014Importance`, which
      focuses computation on the visible parts of the microfacet normal distribution, considerably
      reducing variance in some cases. (Default: |true|, i.e. use visible normal sampling)
+ * - precompute_visible
+   - |bool|
+   - Replaces the numerical inversion underlying Beckmann visible normal sampling by a
+     precomputed table that is interpolated at render time. This speeds up BSDF sampling
+     at the cost of a slight approximation, and has no effect on the GGX distribution,
+     whose sampling routine is already cheap. (Default: |false|)
 
 
 This plugin implements a realistic microfacet scattering model for rendering
@@ -171,6 +177,16 @@ public:
 
         m_sample_visible = props.bool_("sample_visible", true);
 
+        if (props.bool_("precompute_visible", false)) {
+            if (m_type == MicrofacetType::Beckmann && m_sample_visible)
+                m_visible_table =
+                    std::make_unique<BeckmannVisibleTable<Float>>();
+            else
+                Log(Warn, "The \"precompute_visible\" parameter only applies "
+                          "to visible normal sampling with the Beckmann "
+                          "distribution -- ignoring.");
+        }
+
         if (props.has_property("alpha_u") || props.has_property("alpha_v")) {
             if (!props.has_property("alpha_u") || !props.has_property("alpha_v"))
                 Throw("Microfacet model: both 'alpha_u' and 'alpha_v' must be specified.");
@@ -225,6 +241,8 @@ public:
            reduce importance sampling weights. Not needed for the
            Heitz and D'Eon sampling technique. */
         MicrofacetDistribution sample_distr(distr);
+        if (unlikely(m_visible_table != nullptr))
+            sample_distr.set_visible_table(m_visible_table.get());
         if (unlikely(!m_sample_visible))
             sample_distr.scale_alpha(1.2f - .2f * sqrt(abs(cos_theta_i)));
 
@@ -440,9 +458,113 @@ public:
         return select(active, prob * abs(dwh_dwo), 0.f);
     }
 
+    std::pair<Spectrum, Float> eval_pdf(const BSDFContext &ctx,
+                                        const SurfaceInteraction3f &si,
+                                        const Vector3f &wo,
+                                        Mask active) const override {
+        MTS_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
+
+        Float cos_theta_i = Frame3f::cos_theta(si.wi),
+              cos_theta_o = Frame3f::cos_theta(wo);
+
+        // Ignore perfectly grazing configurations
+        active &= neq(cos_theta_i, 0.f);
+
+        // Determine the type of interaction
+        bool has_reflection   = ctx.is_enabled(BSDFFlags::GlossyReflection, 0),
+             has_transmission = ctx.is_enabled(BSDFFlags::GlossyTransmission, 1);
+
+        Mask reflect = cos_theta_i * cos_theta_o > 0.f;
+
+        // Determine the relative index of refraction
+        Float eta     = select(cos_theta_i > 0.f, Float(m_eta), Float(m_inv_eta)),
+              inv_eta = select(cos_theta_i > 0.f, Float(m_inv_eta), Float(m_eta));
+
+        // Compute the half-vector
+        Vector3f m = normalize(si.wi + wo * select(reflect, Float(1.f), eta));
+
+        // Ensure that the half-vector points into the same hemisphere as the macrosurface normal
+        m = mulsign(m, Frame3f::cos_theta(m));
+
+        /* Construct the microfacet distribution matching the
+           roughness values at the current surface position. */
+        MicrofacetDistribution distr(m_type,
+                                     m_alpha_u->eval_1(si, active),
+                                     m_alpha_v->eval_1(si, active),
+                                     m_sample_visible);
+
+        /* Quantities shared between the value and the density: the normal
+           distribution, Fresnel factor, and shadow-masking function */
+        Float D = distr.eval(m),
+              F = std::get<0>(fresnel(dot(si.wi, m), Float(m_eta))),
+              G = distr.G(si.wi, wo, m);
+
+        // Value computation, identical to eval()
+        Spectrum result(0.f);
+
+        Mask eval_r = Mask(has_reflection) && reflect && active,
+             eval_t = Mask(has_transmission) && !reflect && active;
+
+        if (any_or<true>(eval_r)) {
+            Float value = F * D * G / (4.f * abs(cos_theta_i));
+
+            result[eval_r] = m_specular_reflectance->eval(si, eval_r) * value;
+        }
+
+        if (any_or<true>(eval_t)) {
+            // Compute the total amount of transmission
+            Float value =
+                ((1.f - F) * D * G * eta * eta * dot(si.wi, m) * dot(wo, m)) /
+                (cos_theta_i * sqr(dot(si.wi, m) + eta * dot(wo, m)));
+
+            /* Missing term in the original paper: account for the solid angle
+               compression when tracing radiance -- this is necessary for
+               bidirectional methods. */
+            Float factor = (ctx.mode == TransportMode::Radiance) ? inv_eta : Float(1.f);
+
+            result[eval_t] =
+                m_specular_transmittance->eval(si, eval_t) *
+                abs(value * sqr(factor));
+        }
+
+        // Density computation, identical to pdf()
+        Mask active_pdf = active && ((Mask(has_reflection)   &&  reflect) ||
+                                     (Mask(has_transmission) && !reflect));
+
+        /* Filter cases where the micro/macro-surface don't agree on the
+           side (see \ref pdf()) */
+        active_pdf &= dot(si.wi, m) * Frame3f::cos_theta(si.wi) > 0.f &&
+                      dot(wo,    m) * Frame3f::cos_theta(wo)    > 0.f;
+
+        // Jacobian of the half-direction mapping
+        Float dwh_dwo = select(reflect, rcp(4.f * dot(wo, m)),
+                               (eta * eta * dot(wo, m)) /
+                                   sqr(dot(si.wi, m) + eta * dot(wo, m)));
+
+        Float prob;
+        if (likely(m_sample_visible)) {
+            prob = distr.pdf(mulsign(si.wi, Frame3f::cos_theta(si.wi)), m);
+        } else {
+            /* Trick by Walter et al.: slightly scale the roughness values to
+               reduce importance sampling weights. Not needed for the
+               Heitz and D'Eon sampling technique. */
+            MicrofacetDistribution sample_distr(m_type, distr.alpha_u(),
+                                                distr.alpha_v(),
+                                                m_sample_visible);
+            sample_distr.scale_alpha(1.2f -
+                                     .2f * sqrt(abs(Frame3f::cos_theta(si.wi))));
+            prob = sample_distr.pdf(mulsign(si.wi, Frame3f::cos_theta(si.wi)), m);
+        }
+
+        if (likely(has_transmission && has_reflection))
+            prob *= select(reflect, F, 1.f - F);
+
+        return { unpolarized<Spectrum>(result),
+                 select(active_pdf, prob * abs(dwh_dwo), 0.f) };
+    }
+
     void traverse(TraversalCallback *callback) override {
         if (m_alpha_u == m_alpha_v)
-            callback->put_object("alpha", m_alpha_u.get());
         else {
             callback->put_object("alpha_u", m_alpha_u.get());
             callback->put_object("alpha_v", m_alpha_v.get());
@@ -474,6 +596,8 @@ private:
     ref<Texture> m_alpha_u, m_alpha_v;
     ScalarFloat m_eta, m_inv_eta;
     bool m_sample_visible;
+    /// Optional precomputed inversion table for Beckmann visible normal sampling
+    std::unique_ptr<BeckmannVisibleTable<Float>> m_visible_table;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(RoughDielectric, BSDF)
@@ -8,6 +8,9 @@
 #include <mitsuba/render/ior.h>
 #include <mitsuba/render/microfacet.h>
 #include <mitsuba/render/texture.h>
+#include <map>
+#include <mutex>
+#include <tuple>
 
 #define MTS_ROUGH_TRANSMITTANCE_RES 64
 
@@ -192,23 +195,67 @@ public:
         m_specular_sampling_weight = s_mean / (d_mean + s_mean);
 
 
-        /* Precompute rough reflectance (vectorized) */ {
+        /* Material libraries often contain many rough plastic variations
+           that differ only in their texture bindings; the quadrature below
+           would then be repeated with identical parameters for each
+           instance, hence its results are shared through a cache */
+        auto [external, internal] =
+            rough_transmittance_table(m_type, m_alpha, m_eta);
+        m_external_transmittance =
+            DynamicBuffer<Float>::copy(external->data(), external->size());
+        m_internal_reflectance = internal;
+    }
+
+    /**
+     * \brief Return the precomputed rough transmittance table and internal
+     * reflectance for the given microfacet parameters
+     *
+     * The results are memoized in a process-wide store keyed by the
+     * distribution type, roughness, and relative index of refraction.
+     * Entries are never evicted, so the returned pointer remains valid for
+     * the lifetime of the process.
+     */
+    static std::pair<const std::vector<ScalarFloat> *, ScalarFloat>
+    rough_transmittance_table(MicrofacetType type, ScalarFloat alpha,
+                              ScalarFloat eta) {
+        using Key = std::tuple<int, ScalarFloat, ScalarFloat>;
+        struct Entry {
+            std::vector<ScalarFloat> external;
+            ScalarFloat internal;
+        };
+
+        static std::map<Key, Entry> cache;
+        static std::mutex mutex;
+
+        Key key((int) type, alpha, eta);
+
+        std::lock_guard<std::mutex> guard(mutex);
+        auto it = cache.find(key);
+        if (it == cache.end()) {
+            /* Compute rough reflectance (vectorized) */
             using FloatP    = Packet<ScalarFloat>;
             using Vector3fX = Vector<DynamicArray<FloatP>, 3>;
 
-            mitsuba::MicrofacetDistribution<FloatP, Spectrum> distr_p(m_type, m_alpha);
+            mitsuba::MicrofacetDistribution<FloatP, Spectrum> distr_p(type, alpha);
             Vector3fX wi = zero<Vector3fX>(MTS_ROUGH_TRANSMITTANCE_RES);
             for (size_t i = 0; i < slices(wi); ++i) {
                 ScalarFloat mu    = std::max((ScalarFloat) 1e-6f, ScalarFloat(i) / ScalarFloat(slices(wi) - 1));
                 slice(wi, i) = ScalarVector3f(std::sqrt(1 - mu * mu), 0.f, mu);
             }
 
-            auto external_transmittance = 1.f - eval_reflectance(distr_p, wi, m_eta);
-            m_external_transmittance = DynamicBuffer<Float>::copy(external_transmittance.data(),
-                                                                  slices(external_transmittance));
-            m_internal_reflectance =
-                hmean(eval_reflectance(distr_p, wi, 1.f / m_eta) * wi.z()) * 2.f;
+            auto external_transmittance = 1.f - eval_reflectance(distr_p, wi, eta);
+
+            Entry entry;
+            entry.external.assign(
+                external_transmittance.data(),
+                external_transmittance.data() + slices(external_transmittance));
+            entry.internal =
+                hmean(eval_reflectance(distr_p, wi, 1.f / eta) * wi.z()) * 2.f;
+
+            it = cache.emplace(key, std::move(entry)).first;
         }
+
+        return { &it->second.external, it->second.internal };
     }
 
     std::pair<BSDFSample3f, Spectrum> sample(const BSDFContext &ctx,
@@ -381,6 +428,85 @@ public:
         return result;
     }
 
+    std::pair<Spectrum, Float> eval_pdf(const BSDFContext &ctx,
+                                        const SurfaceInteraction3f &si,
+                                        const Vector3f &wo,
+                                        Mask active) const override {
+        MTS_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
+
+        /* Note the differing component-0 queries, which mirror eval() and
+           pdf(), respectively */
+        bool eval_specular = ctx.is_enabled(BSDFFlags::GlossyReflection, 0),
+             pdf_specular  = ctx.is_enabled(BSDFFlags::DeltaReflection, 0),
+             has_diffuse   = ctx.is_enabled(BSDFFlags::DiffuseReflection, 1);
+
+        Float cos_theta_i = Frame3f::cos_theta(si.wi),
+              cos_theta_o = Frame3f::cos_theta(wo);
+
+        active &= cos_theta_i > 0.f && cos_theta_o > 0.f;
+
+        if (unlikely((!eval_specular && !pdf_specular && !has_diffuse) ||
+                     none_or<false>(active)))
+            return { 0.f, 0.f };
+
+        /* Quantities shared between the value and the density: the
+           microfacet distribution, half-vector, and transmittance lookup */
+        MicrofacetDistribution distr(m_type, m_alpha, m_sample_visible);
+        Vector3f H = normalize(wo + si.wi);
+        Float D = distr.eval(H);
+
+        Float t_i = lerp_gather(m_external_transmittance.data(), cos_theta_i,
+                                MTS_ROUGH_TRANSMITTANCE_RES, active);
+
+        // Value computation, identical to eval()
+        Spectrum result(0.f);
+
+        if (eval_specular) {
+            // Fresnel term
+            Float F = std::get<0>(fresnel(dot(si.wi, H), Float(m_eta)));
+
+            // Smith's shadow-masking function
+            Float G = distr.G(si.wi, wo, H);
+
+            // Calculate the specular reflection component
+            Float value = F * D * G / (4.f * cos_theta_i);
+
+            result += m_specular_reflectance->eval(si, active) * value;
+        }
+
+        if (has_diffuse) {
+            Float t_o = lerp_gather(m_external_transmittance.data(), cos_theta_o,
+                                    MTS_ROUGH_TRANSMITTANCE_RES, active);
+
+            UnpolarizedSpectrum diff = depolarize(m_diffuse_reflectance->eval(si, active));
+            diff /= 1.f - (m_nonlinear ? (diff * m_internal_reflectance)
+                                       : UnpolarizedSpectrum(m_internal_reflectance));
+
+            result += diff * (math::InvPi<Float> * m_inv_eta_2 * cos_theta_o * t_i * t_o);
+        }
+
+        // Density computation, identical to pdf()
+        Float prob_specular = (1.f - t_i) * m_specular_sampling_weight,
+              prob_diffuse  = t_i * (1.f - m_specular_sampling_weight);
+
+        if (unlikely(pdf_specular != has_diffuse))
+            prob_specular = pdf_specular ? 1.f : 0.f;
+        else
+            prob_specular = prob_specular / (prob_specular + prob_diffuse);
+        prob_diffuse = 1.f - prob_specular;
+
+        Float pdf = 0.f;
+        if (m_sample_visible)
+            pdf = D * distr.smith_g1(si.wi, H) / (4.f * cos_theta_i);
+        else
+            pdf = distr.pdf(si.wi, H) / (4.f * dot(wo, H));
+        pdf *= prob_specular;
+
+        pdf += prob_diffuse * warp::square_to_cosine_hemisphere_pdf(wo);
+
+        return { select(active, unpolarized<Spectrum>(result), 0.f), pdf };
+    }
+
     void traverse(TraversalCallback *callback) override {
         callback->put_parameter("alpha", m_alpha);
         callback->put_parameter("eta", m_eta);
@@ -57,7 +57,27 @@ def test03_chi2_aniso_beckmann_visible(variant_packet_rgb):
     assert chi2.run()
 
 
-def test04_chi2_aniso_ggx_all(variant_packet_rgb):
+def test04_chi2_beckmann_precomputed_visible(variant_packet_rgb):
+    xml = """<float name="alpha_u" value="0.2"/>
+             <float name="alpha_v" value="0.05"/>
+             <string name="distribution" value="beckmann"/>
+             <boolean name="sample_visible" value="true"/>
+             <boolean name="precompute_visible" value="true"/>"""
+    wi = ek.normalize([1.0, 1.0, 1.0])
+    sample_func, pdf_func = BSDFAdapter("roughconductor", xml, wi=wi)
+
+    chi2 = ChiSquareTest(
+        domain=SphericalDomain(),
+        sample_func=sample_func,
+        pdf_func=pdf_func,
+        sample_dim=3,
+        ires=8
+    )
+
+    assert chi2.run()
+
+
+def test05_chi2_aniso_ggx_all(variant_packet_rgb):
     xml = """<float name="alpha_u" value="0.2"/>
              <float name="alpha_v" value="0.05"/>
              <string name="distribution" value="ggx"/>
@@ -76,7 +96,7 @@ def test04_chi2_aniso_ggx_all(variant_packet_rgb):
     assert chi2.run()
 
 
-def test05_chi2_aniso_ggx_visible(variant_packet_rgb):
+def test06_chi2_aniso_ggx_visible(variant_packet_rgb):
     xml = """<float name="alpha_u" value="0.2"/>
              <float name="alpha_v" value="0.05"/>
              <string name="distribution" value="ggx"/>
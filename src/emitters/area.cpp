@@ -1,8 +1,10 @@
+#include <mitsuba/core/distr_1d.h>
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/warp.h>
 #include <mitsuba/core/spectrum.h>
 #include <mitsuba/render/emitter.h>
 #include <mitsuba/render/medium.h>
+#include <mitsuba/render/mesh.h>
 #include <mitsuba/render/shape.h>
 #include <mitsuba/render/texture.h>
 
@@ -27,6 +29,18 @@ has the same apparent brightness regardless of the observer's viewing
 direction. Furthermore, since it occupies a nonzero amount of space, an
 area light generally causes scene objects to cast soft shadows.
 
+When a spatially varying :monosp:`radiance` texture is attached to a mesh,
+the emitter importance samples positions proportionally to the estimated
+emitted power of each face, which reduces variance considerably when only
+a small portion of the texture is actually bright.
+
+For lights close to the receiving surfaces (e.g. a softbox right above a
+product), sampling by surface area is a poor fit, since the implied
+density in the solid angle measure varies strongly across the light.
+:ref:`Rectangle <shape-rectangle>` shapes always sample the subtended
+solid angle directly; for small emissive meshes, the same behavior can be
+requested via the :monosp:`solid_angle_sampling` mesh property.
+
 To create an area light source, simply instantiate the desired
 emitter shape and specify an :monosp:`area` instance as its child:
 
@@ -45,7 +59,7 @@ template <typename Float, typename Spectrum>
 class AreaLight final : public Emitter<Float, Spectrum> {
 public:
     MTS_IMPORT_BASE(Emitter, m_flags, m_shape, m_medium)
-    MTS_IMPORT_TYPES(Scene, Shape, Texture)
+    MTS_IMPORT_TYPES(Scene, Shape, Mesh, Texture)
 
     AreaLight(const Properties &props) : Base(props) {
         if (props.has_property("to_world"))
@@ -64,6 +78,9 @@ public:
 
         Base::set_shape(shape);
         m_area_times_pi = m_shape->surface_area() * math::Pi<ScalarFloat>;
+
+        if (m_radiance->is_spatially_varying() && shape->is_mesh())
+            luminance_distr_build();
     }
 
     Spectrum eval(const SurfaceInteraction3f &si, Mask active) const override {
@@ -99,12 +116,67 @@ public:
     }
 
     std::pair<DirectionSample3f, Spectrum>
-    sample_direction(const Interaction3f &it, const Point2f &sample, Mask active) const override {
+    sample_direction(const Interaction3f &it, const Point2f &sample_, Mask active) const override {
         MTS_MASKED_FUNCTION(ProfilerPhase::EndpointSampleDirection, active);
 
         Assert(m_shape, "Can't sample from an area emitter without an associated Shape.");
 
-        DirectionSample3f ds = m_shape->sample_direction(it, sample, active);
+        DirectionSample3f ds;
+        if (likely(m_face_distr.empty())) {
+            ds = m_shape->sample_direction(it, sample_, active);
+        } else {
+            /* Pick a face proportionally to its estimated emitted power,
+               followed by a uniform position on that face */
+            const Mesh *mesh = static_cast<const Mesh *>(m_shape);
+
+            using Index = replace_scalar_t<Float, uint32_t>;
+            Index face_idx;
+            Point2f sample = sample_;
+            std::tie(face_idx, sample.y()) =
+                m_face_distr.sample_reuse(sample.y(), active);
+
+            auto fi = mesh->face_indices(face_idx, active);
+
+            Point3f p0 = mesh->vertex_position(fi[0], active),
+                    p1 = mesh->vertex_position(fi[1], active),
+                    p2 = mesh->vertex_position(fi[2], active);
+
+            Vector3f e0 = p1 - p0, e1 = p2 - p0;
+            Point2f b = warp::square_to_uniform_triangle(sample);
+
+            ds.p          = p0 + e0 * b.x() + e1 * b.y();
+            ds.time       = it.time;
+            ds.delta      = false;
+            ds.prim_index = face_idx;
+
+            Point2f uv0 = mesh->vertex_texcoord(fi[0], active),
+                    uv1 = mesh->vertex_texcoord(fi[1], active),
+                    uv2 = mesh->vertex_texcoord(fi[2], active);
+            ds.uv = uv0 * (1.f - b.x() - b.y()) + uv1 * b.x() + uv2 * b.y();
+
+            if (mesh->has_vertex_normals()) {
+                Normal3f n0 = mesh->vertex_normal(fi[0], active),
+                         n1 = mesh->vertex_normal(fi[1], active),
+                         n2 = mesh->vertex_normal(fi[2], active);
+                ds.n = normalize(n0 * (1.f - b.x() - b.y())
+                               + n1 * b.x() + n2 * b.y());
+            } else {
+                ds.n = normalize(cross(e0, e1));
+            }
+
+            Float face_area = .5f * norm(cross(e0, e1));
+            ds.pdf = m_face_distr.eval_pmf_normalized(face_idx, active) / face_area;
+
+            // Convert the area density into a density per unit solid angle
+            ds.d = ds.p - it.p;
+            Float dist_squared = squared_norm(ds.d);
+            ds.dist = sqrt(dist_squared);
+            ds.d /= ds.dist;
+
+            Float dp = abs_dot(ds.d, ds.n);
+            ds.pdf *= select(neq(dp, 0.f), dist_squared / dp, 0.f);
+        }
+
         active &= dot(ds.d, ds.n) < 0.f && neq(ds.pdf, 0.f);
 
         SurfaceInteraction3f si(ds, it.wavelengths);
@@ -118,12 +190,50 @@ public:
                         Mask active) const override {
         MTS_MASKED_FUNCTION(ProfilerPhase::EndpointEvaluate, active);
 
-        return select(dot(ds.d, ds.n) < 0.f,
-                      m_shape->pdf_direction(it, ds, active), 0.f);
+        Float pdf;
+        if (likely(m_face_distr.empty())) {
+            pdf = m_shape->pdf_direction(it, ds, active);
+        } else {
+            /* The density of the luminance-weighted technique is piecewise
+               constant and hence exactly recoverable from the face index
+               stored on the record */
+            const Mesh *mesh = static_cast<const Mesh *>(m_shape);
+
+            pdf = m_face_distr.eval_pmf_normalized(ds.prim_index, active) /
+                  mesh->face_area(ds.prim_index, active);
+
+            Float dp = abs_dot(ds.d, ds.n);
+            pdf *= select(neq(dp, 0.f), sqr(ds.dist) / dp, 0.f);
+        }
+
+        return select(dot(ds.d, ds.n) < 0.f, pdf, 0.f);
+    }
+
+    std::pair<Float, Float> pdf_ray(const Ray3f &ray, const Vector3f &n,
+                                    Mask active) const override {
+        MTS_MASKED_FUNCTION(ProfilerPhase::EndpointEvaluate, active);
+
+        Assert(m_shape, "Can't evaluate an area emitter without an associated Shape.");
+
+        PositionSample3f ps = zero<PositionSample3f>();
+        ps.p    = ray.o;
+        ps.n    = n;
+        ps.time = ray.time;
+
+        /* The directional component of \ref sample_ray() is cosine-hemisphere
+           distributed around the surface normal */
+        Float ct = dot(n, ray.d);
+
+        return { m_shape->pdf_position(ps, active),
+                 select(ct > 0.f, ct * math::InvPi<ScalarFloat>, 0.f) };
     }
 
     ScalarBoundingBox3f bbox() const override { return m_shape->bbox(); }
 
+    ScalarFloat power_estimate() const override {
+        return m_area_times_pi * m_radiance->mean();
+    }
+
     void traverse(TraversalCallback *callback) override {
         callback->put_object("radiance", m_radiance.get());
     }
@@ -144,8 +254,84 @@ public:
 
     MTS_DECLARE_CLASS()
 private:
+    /**
+     * \brief Build a discrete distribution over the faces of the attached
+     * mesh that is proportional to each face's emitted power (face area
+     * times an estimate of the mean texture luminance over the face).
+     *
+     * An ideal importance function would follow the radiance texture at
+     * texel granularity, but positions sampled that way could not be mapped
+     * back to a density when a BSDF-sampled ray hits the emitter, since the
+     * mesh provides no inverse UV parameterization. Choosing a face first
+     * and a uniform position within it second keeps the density piecewise
+     * constant and exactly recoverable from the \c prim_index field of the
+     * sampling record, which multiple importance sampling requires.
+     */
+    void luminance_distr_build() {
+        const Mesh *mesh = static_cast<const Mesh *>(m_shape);
+        uint32_t face_count = mesh->face_count();
+        if (face_count == 0 || !mesh->has_vertex_texcoords())
+            return;
+
+        SurfaceInteraction3f si = zero<SurfaceInteraction3f>();
+        if constexpr (is_spectral_v<Spectrum>)
+            si.wavelengths = MTS_WAVELENGTH_MIN +
+                (MTS_WAVELENGTH_MAX - MTS_WAVELENGTH_MIN) *
+                math::sample_shifted<Wavelength>(.5f);
+
+        auto eval_luminance = [&](const Point2f &uv) -> ScalarFloat {
+            si.uv = uv;
+            UnpolarizedSpectrum spec = m_radiance->eval(si, true);
+            Float lum;
+            if constexpr (is_spectral_v<Spectrum>)
+                lum = luminance(spec, si.wavelengths);
+            else if constexpr (is_monochromatic_v<Spectrum>)
+                lum = spec[0];
+            else
+                lum = luminance(spec);
+            return enoki::slice(lum, 0);
+        };
+
+        /* Probe points: face centroid plus three points near the corners */
+        const ScalarPoint2f probes[4] = {
+            { 1.f / 3.f, 1.f / 3.f }, { .8f, .1f }, { .1f, .8f }, { .1f, .1f }
+        };
+
+        std::unique_ptr<ScalarFloat[]> table(new ScalarFloat[face_count]);
+        double lum_sum = 0.0;
+        for (uint32_t i = 0; i < face_count; ++i) {
+            auto fi = mesh->face_indices(i);
+            ScalarPoint2f uv0 = mesh->vertex_texcoord(fi[0]),
+                          uv1 = mesh->vertex_texcoord(fi[1]),
+                          uv2 = mesh->vertex_texcoord(fi[2]);
+
+            ScalarFloat lum = 0.f;
+            for (const ScalarPoint2f &b : probes)
+                lum += eval_luminance(uv0 * (1.f - b.x() - b.y()) +
+                                      uv1 * b.x() + uv2 * b.y());
+            table[i] = .25f * lum;
+            lum_sum += (double) table[i];
+        }
+
+        if (lum_sum == 0.0)
+            return; // The texture is black -- keep the uniform fallback
+
+        /* Guard against the point-sampled probes entirely missing small
+           bright texels: every face keeps at least 1% of the average
+           luminance, which only affects variance, never correctness. */
+        ScalarFloat floor = .01f * ScalarFloat(lum_sum / face_count);
+        for (uint32_t i = 0; i < face_count; ++i)
+            table[i] = std::max(table[i], floor) * mesh->face_area(i);
+
+        m_face_distr = DiscreteDistribution<Float>(table.get(), face_count);
+        if (face_count >= 4096)
+            m_face_distr.set_alias_table(true);
+    }
+
     ref<Texture> m_radiance;
     ScalarFloat m_area_times_pi = 0.f;
+    /// Power-proportional face sampling weights (textured mesh emitters only)
+    DiscreteDistribution<Float> m_face_distr;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(AreaLight, Emitter)
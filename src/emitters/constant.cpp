@@ -115,6 +115,11 @@ public:
         return ScalarBoundingBox3f();
     }
 
+    ScalarFloat power_estimate() const override {
+        return 4.f * sqr(math::Pi<ScalarFloat> * m_bsphere.radius) *
+               m_radiance->mean();
+    }
+
     void traverse(TraversalCallback *callback) override {
         callback->put_object("radiance", m_radiance.get());
     }
@@ -28,6 +28,15 @@ Environment emitter (:monosp:`envmap`)
  * - to_world
    - |transform|
    - Specifies an optional emitter-to-world transformation.  (Default: none, i.e. emitter space = world space)
+ * - warp_resolution
+   - |int|
+   - Maximum side length of the hierarchical warp used for importance
+     sampling. The luminance image is reduced to this resolution before the
+     warp is built, which shortens the sampling traversal and the density
+     queries performed for multiple importance sampling on high-resolution
+     domes at a slight cost in sampling precision. The reduction preserves
+     the total energy, so the result remains unbiased. A value of 0 builds
+     the warp at the full image resolution. (Default: 0)
 
 This plugin provides a HDRI (high dynamic range imaging) environment map,
 which is a type of light source that is well-suited for representing "natural"
@@ -54,6 +63,19 @@ High quality free light probes are available on
 `Paul Debevec's <http://gl.ict.usc.edu/Data/HighResProbes>`_ and
 `Bernhard Vogl's <http://dativ.at/lightprobes/>`_ websites.
 
+**Portals**: in interior scenes that are lit through a few openings (e.g. a room
+with windows), almost all directions sampled from the environment map hit a wall,
+and convergence suffers accordingly. Shapes carrying the boolean :monosp:`portal`
+parameter (typically :ref:`rectangles <shape-rectangle>` placed in the openings)
+mark the regions through which the environment is visible. When at least one
+portal is present, this emitter samples the solid angle subtended by the portals
+as seen from the shading point instead of the luminance-weighted sphere, and
+reports the matching density for multiple importance sampling. Add a
+:monosp:`null` BSDF to a portal shape if it should not otherwise interact with
+light. Note that portals restrict *sampling* only---the emitter still
+illuminates the scene through any unmarked opening, just with the previous
+convergence behavior.
+
  */
 
 template <typename Float, typename Spectrum>
@@ -118,7 +140,10 @@ public:
         m_data = DynamicBuffer<Float>::copy(bitmap->data(), hprod(m_resolution) * 4);
 
         m_scale = props.float_("scale", 1.f);
-        m_warp = Warp(luminance.get(), m_resolution);
+        m_warp_res = (uint32_t) props.size_("warp_resolution", 0);
+        if (m_warp_res == 1)
+            Throw("\"warp_resolution\" must be 0 (disabled) or >= 2!");
+        build_warp(luminance.get());
         m_d65 = Texture::D65(1.f);
         m_flags = EmitterFlags::Infinite | EmitterFlags::SpatiallyVarying;
     }
@@ -154,13 +179,23 @@ public:
             }
         }
 
-        m_warp = Warp(luminance.get(), m_resolution);
+        build_warp(luminance.get());
     }
 
     void set_scene(const Scene *scene) override {
         m_bsphere = scene->bbox().bounding_sphere();
         m_bsphere.radius = max(math::RayEpsilon<Float>,
                                m_bsphere.radius * (1.f + math::RayEpsilon<Float>));
+
+        m_portals.clear();
+        for (const ref<Shape> &shape : scene->shapes()) {
+            if (shape->is_portal())
+                m_portals.push_back(shape.get());
+        }
+        if (!m_portals.empty())
+            Log(Info, "Environment map sampling will be restricted to %i "
+                      "portal%s.", m_portals.size(),
+                m_portals.size() > 1 ? "s" : "");
     }
 
     Spectrum eval(const SurfaceInteraction3f &si, Mask active) const override {
@@ -189,6 +224,9 @@ public:
     sample_direction(const Interaction3f &it, const Point2f &sample, Mask active) const override {
         MTS_MASKED_FUNCTION(ProfilerPhase::EndpointSampleDirection, active);
 
+        if (unlikely(!m_portals.empty()))
+            return sample_direction_portal(it, sample, active);
+
         auto [uv, pdf] = m_warp.sample(sample);
 
         Float theta = uv.y() * math::Pi<Float>,
@@ -225,6 +263,9 @@ public:
                         Mask active) const override {
         MTS_MASKED_FUNCTION(ProfilerPhase::EndpointEvaluate, active);
 
+        if (unlikely(!m_portals.empty()))
+            return portal_pdf(it, ds.d, active);
+
         Vector3f d = m_world_transform->eval(it.time, active)
                          .inverse()
                          .transform_affine(ds.d);
@@ -245,6 +286,11 @@ public:
         return ScalarBoundingBox3f();
     }
 
+    ScalarFloat power_estimate() const override {
+        return 4.f * sqr(math::Pi<ScalarFloat> * m_bsphere.radius) * m_scale *
+               m_mean_luminance;
+    }
+
     void traverse(TraversalCallback *callback) override {
         callback->put_parameter("scale", m_scale);
         callback->put_parameter("data", m_data);
@@ -256,12 +302,155 @@ public:
         oss << "EnvironmentMapEmitter[" << std::endl
             << "  filename = \"" << m_filename << "\"," << std::endl
             << "  resolution = \"" << m_resolution << "\"," << std::endl
+            << "  portals = " << m_portals.size() << "," << std::endl
             << "  bsphere = " << m_bsphere << std::endl
             << "]";
         return oss.str();
     }
 
 protected:
+    /**
+     * \brief Portal-guided variant of \ref sample_direction()
+     *
+     * Instead of warping the sample through the luminance distribution of the
+     * whole sphere, pick one of the scene's portal shapes uniformly and
+     * sample the solid angle it subtends as seen from the reference point.
+     * The returned density averages over all portals (see \ref portal_pdf())
+     * so that it matches \ref pdf_direction() for multiple importance
+     * sampling.
+     */
+    std::pair<DirectionSample3f, Spectrum>
+    sample_direction_portal(const Interaction3f &it, Point2f sample,
+                            Mask active) const {
+        uint32_t n = (uint32_t) m_portals.size();
+
+        /* Select one of the portals uniformly and re-use the sample */
+        UInt32 index = 0;
+        if (n > 1) {
+            Float scaled = sample.x() * (ScalarFloat) n;
+            index = min(UInt32(scaled), n - 1);
+            sample.x() = scaled - Float(index);
+        }
+
+        DirectionSample3f ds = zero<DirectionSample3f>();
+        for (uint32_t i = 0; i < n; ++i) {
+            Mask mask = active && eq(index, i);
+            if (none_or<false>(mask))
+                continue;
+            masked(ds, mask) = m_portals[i]->sample_direction(it, sample, mask);
+        }
+
+        /* Combined density of all portals in the solid angle measure */
+        Float pdf = portal_pdf(it, ds.d, active);
+
+        /* Convert to latitude-longitude texture coordinates */
+        Vector3f v = m_world_transform->eval(it.time, active)
+                         .inverse()
+                         .transform_affine(ds.d);
+        Point2f uv = Point2f(atan2(v.x(), -v.z()) * math::InvTwoPi<Float>,
+                             safe_acos(v.y()) * math::InvPi<Float>);
+        uv -= floor(uv);
+
+        /* The emitted radiance travels through the portal; the record itself
+           refers to the environment at infinity, like the unguided path */
+        Float dist = 2.f * m_bsphere.radius;
+        ds.p      = it.p + ds.d * dist;
+        ds.n      = -ds.d;
+        ds.uv     = uv;
+        ds.time   = it.time;
+        ds.pdf    = pdf;
+        ds.delta  = false;
+        ds.object = this;
+        ds.dist   = dist;
+
+        active &= pdf > 0.f;
+        Spectrum weight = select(
+            active,
+            unpolarized<Spectrum>(eval_spectrum(uv, it.wavelengths, active)) / pdf,
+            Spectrum(0.f));
+
+        return { ds, weight };
+    }
+
+    /**
+     * \brief Density of \ref sample_direction() in the portal-guided mode
+     *
+     * Returns the average solid-angle density with which the portals generate
+     * the direction \c d from the reference point; directions that miss every
+     * portal have zero density. Only the portal shapes themselves are
+     * intersected here -- no scene-level ray tracing takes place.
+     */
+    Float portal_pdf(const Interaction3f &it, const Vector3f &d,
+                     Mask active) const {
+        Ray3f ray(it.p, d, it.time, it.wavelengths);
+        Float result = 0.f;
+
+        for (const Shape *portal : m_portals) {
+            SurfaceInteraction3f si = portal->ray_intersect(ray, active);
+            Mask hit = active && si.is_valid();
+            if (none_or<false>(hit))
+                continue;
+
+            DirectionSample3f ds(si, it);
+            result += select(hit, portal->pdf_direction(it, ds, hit), 0.f);
+        }
+
+        return result * (1.f / (ScalarFloat) m_portals.size());
+    }
+
+    /**
+     * \brief (Re-)construct the hierarchical warp from a luminance image
+     *
+     * When \c warp_resolution is set, the luminance image is first reduced
+     * to the requested resolution by splatting each texel onto the coarser
+     * grid. The splat preserves the total energy, so every region with
+     * nonzero luminance keeps a nonzero density under the compressed warp
+     * (sampling merely becomes less precise at sub-patch scale). Since the
+     * warp reports its own interpolated density from both \ref sample()
+     * and \ref eval(), MIS weights remain consistent.
+     */
+    void build_warp(const ScalarFloat *luminance) {
+        double lum_accum = 0.0;
+        for (size_t i = 0, n = hprod(m_resolution); i < n; ++i)
+            lum_accum += (double) luminance[i];
+        m_mean_luminance = (ScalarFloat) (lum_accum / hprod(m_resolution));
+
+        if (m_warp_res != 0 && m_warp_res < hmax(m_resolution)) {
+            ScalarFloat scale = m_warp_res / (ScalarFloat) hmax(m_resolution);
+            ScalarVector2u res(
+                std::max(2u, (uint32_t) std::round(m_resolution.x() * scale)),
+                std::max(2u, (uint32_t) std::round(m_resolution.y() * scale)));
+
+            std::unique_ptr<ScalarFloat[]> ds(new ScalarFloat[hprod(res)]());
+
+            ScalarVector2f step((res.x() - 1) / ScalarFloat(m_resolution.x() - 1),
+                                (res.y() - 1) / ScalarFloat(m_resolution.y() - 1));
+
+            for (uint32_t y = 0; y < m_resolution.y(); ++y) {
+                ScalarFloat v  = y * step.y();
+                uint32_t y0    = std::min((uint32_t) v, res.y() - 2);
+                ScalarFloat fy = v - y0;
+
+                for (uint32_t x = 0; x < m_resolution.x(); ++x) {
+                    ScalarFloat u  = x * step.x();
+                    uint32_t x0    = std::min((uint32_t) u, res.x() - 2);
+                    ScalarFloat fx = u - x0,
+                                lum = *luminance++;
+
+                    ScalarFloat *dst = ds.get() + y0 * res.x() + x0;
+                    dst[0]          += lum * (1.f - fx) * (1.f - fy);
+                    dst[1]          += lum * fx * (1.f - fy);
+                    dst[res.x()]    += lum * (1.f - fx) * fy;
+                    dst[res.x() + 1]+= lum * fx * fy;
+                }
+            }
+
+            m_warp = Warp(ds.get(), res);
+        } else {
+            m_warp = Warp(luminance, m_resolution);
+        }
+    }
+
     UnpolarizedSpectrum eval_spectrum(Point2f uv, const Wavelength &wavelengths, Mask active) const {
         uv *= Vector2f(m_resolution - 1u);
 
@@ -320,9 +509,13 @@ protected:
     ScalarBoundingSphere3f m_bsphere;
     DynamicBuffer<Float> m_data;
     ScalarVector2u m_resolution;
+    uint32_t m_warp_res;
     Warp m_warp;
     ref<Texture> m_d65;
     ScalarFloat m_scale;
+    ScalarFloat m_mean_luminance = 1.f;
+    /// Shapes flagged as portals, restricting direction sampling (if any)
+    std::vector<const Shape *> m_portals;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(EnvironmentMapEmitter, Emitter)
@@ -1,9 +1,13 @@
 #include <mitsuba/core/bbox.h>
+#include <mitsuba/core/distr_2d.h>
+#include <mitsuba/core/fresolver.h>
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/warp.h>
 #include <mitsuba/render/emitter.h>
 #include <mitsuba/render/medium.h>
 #include <mitsuba/render/texture.h>
+#include <fstream>
+#include <vector>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -27,11 +31,188 @@ Point light source (:monosp:`point`)
  * - to_world
    - |transform|
    - Specifies an optional emitter-to-world transformation.  (Default: none, i.e. emitter space = world space)
+ * - ies
+   - |string|
+   - Optional filename of an IES photometric data file (IESNA LM-63) whose
+     directional profile modulates the emission. The profile is normalized
+     so that its average over the sphere equals one -- the overall
+     brightness thus remains controlled by :monosp:`intensity`, while the
+     profile only redistributes it. (Default: none, i.e. uniform emission)
 
 This emitter plugin implements a simple point light source, which
 uniformly radiates illumination into all directions.
 
+When the :monosp:`ies` parameter is specified, the emission is shaped by
+the given photometric profile instead: the tabulated candela values are
+resampled onto a latitude-longitude grid at load time and drive both
+evaluation and ray sampling, so rays leave the emitter proportionally to
+the fixture's actual output instead of uniformly. The profile's zero-degree
+vertical angle points along the emitter's local :math:`+Z` axis; use
+:monosp:`to_world` to orient the fixture.
+
+ */
+
+// Enables Throw in the non-member parsing code below
+static const Class *m_class = nullptr;
+
+/**
+ * \brief An IES photometric profile resampled onto a regular
+ * latitude-longitude grid
+ *
+ * The parser below is deliberately a non-template function: the plugin class
+ * is instantiated once per variant, but loading the file is
+ * variant-independent, so a single compiled copy serves every instantiation.
  */
+struct IESProfileData {
+    /// Candela values, row-major with the azimuth (phi) axis fastest
+    std::vector<float> data;
+    /// Grid resolution along the azimuth and polar axes
+    Vector<uint32_t, 2> res;
+};
+
+static IESProfileData parse_ies(const fs::path &path, const std::string &name) {
+    std::ifstream is(path.native());
+    if (!is.good())
+        Throw("\"%s\": could not open IES file \"%s\"!", name, path.string());
+
+    /* The keyword section at the top of the file ends with the TILT
+       specification; everything after it is a whitespace-separated
+       sequence of numbers. */
+    std::string line;
+    bool tilt_seen = false, tilt_include = false;
+    while (std::getline(is, line)) {
+        size_t pos = line.find("TILT=");
+        if (pos != std::string::npos) {
+            tilt_seen = true;
+            tilt_include = line.find("INCLUDE", pos) != std::string::npos;
+            break;
+        }
+    }
+    if (!tilt_seen)
+        Throw("\"%s\": missing TILT specification -- \"%s\" does not look "
+              "like an IES photometric file!", name, path.string());
+
+    auto next = [&]() -> double {
+        double value;
+        if (!(is >> value))
+            Throw("\"%s\": unexpected end of IES photometric data in \"%s\"!",
+                  name, path.string());
+        return value;
+    };
+
+    if (tilt_include) {
+        /* <lamp-to-luminaire geometry> <# of pairs> <angles> <factors> --
+           the tilt correction applies to a specific mounting orientation
+           and is intentionally not baked into the profile. */
+        next();
+        uint32_t n = (uint32_t) next();
+        for (uint32_t i = 0; i < 2 * n; ++i)
+            next();
+    }
+
+    next(); // number of lamps
+    next(); // lumens per lamp
+    double multiplier = next();
+    uint32_t nv = (uint32_t) next(),
+             nh = (uint32_t) next();
+    next(); // photometric type
+    next(); // units type
+    next(); next(); next(); // luminous opening dimensions
+    double ballast = next();
+    next(); // future use
+    double watts = next();
+    (void) watts;
+
+    if (nv < 2 || nh < 1 || nv > 4096 || nh > 4096)
+        Throw("\"%s\": invalid IES angle table size (%i x %i)!", name, nh, nv);
+
+    std::vector<double> vert(nv), horiz(nh);
+    for (uint32_t i = 0; i < nv; ++i) {
+        vert[i] = next();
+        if (i > 0 && vert[i] <= vert[i - 1])
+            Throw("\"%s\": IES vertical angles must be strictly increasing!", name);
+    }
+    for (uint32_t i = 0; i < nh; ++i) {
+        horiz[i] = next();
+        if (i > 0 && horiz[i] <= horiz[i - 1])
+            Throw("\"%s\": IES horizontal angles must be strictly increasing!", name);
+    }
+
+    double scale = multiplier * ballast;
+    std::vector<double> candela(nh * nv);
+    for (uint32_t h = 0; h < nh; ++h)
+        for (uint32_t v = 0; v < nv; ++v)
+            candela[h * nv + v] = next() * scale;
+
+    /* Look up the tabulated intensity for a direction given in degrees,
+       unfolding the symmetries implied by the horizontal angle range */
+    double span = horiz.back();
+    auto lookup = [&](double phi, double theta) -> double {
+        if (theta < vert.front() || theta > vert.back())
+            return 0.0;
+
+        auto it_v = std::upper_bound(vert.begin(), vert.end(), theta);
+        uint32_t v1 = std::min((uint32_t) (it_v - vert.begin()), nv - 1),
+                 v0 = v1 > 0 ? v1 - 1 : 0;
+        double dv = vert[v1] - vert[v0],
+               fv = dv > 0 ? (theta - vert[v0]) / dv : 0.0;
+
+        uint32_t h0 = 0, h1 = 0;
+        double fh = 0.0;
+        if (nh > 1 && span > 0) {
+            if (span <= 90.0 + 1e-3) {
+                // Quadrant symmetry
+                if (phi > 180.0)
+                    phi = 360.0 - phi;
+                if (phi > 90.0)
+                    phi = 180.0 - phi;
+            } else if (span <= 180.0 + 1e-3) {
+                // Bilateral symmetry
+                if (phi > 180.0)
+                    phi = 360.0 - phi;
+            }
+
+            if (phi >= horiz.front() && phi <= horiz.back()) {
+                auto it_h = std::upper_bound(horiz.begin(), horiz.end(), phi);
+                h1 = std::min((uint32_t) (it_h - horiz.begin()), nh - 1);
+                h0 = h1 > 0 ? h1 - 1 : 0;
+                double dh = horiz[h1] - horiz[h0];
+                fh = dh > 0 ? (phi - horiz[h0]) / dh : 0.0;
+            } else if (span > 180.0 + 1e-3) {
+                // Wrap around between the last and (periodic) first column
+                h0 = nh - 1; h1 = 0;
+                double lo = horiz.back(), hi = horiz.front() + 360.0;
+                if (phi < lo)
+                    phi += 360.0;
+                double dh = hi - lo;
+                fh = dh > 0 ? (phi - lo) / dh : 0.0;
+            }
+        }
+
+        return (candela[h0 * nv + v0] * (1.0 - fv) + candela[h0 * nv + v1] * fv) * (1.0 - fh) +
+               (candela[h1 * nv + v0] * (1.0 - fv) + candela[h1 * nv + v1] * fv) * fh;
+    };
+
+    /* Resample onto a regular grid that comfortably oversamples the
+       tabulation, so the piecewise-linear reconstruction of the warp does
+       not lose narrow features of the profile. */
+    uint32_t factor = span <= 90.0 + 1e-3 ? 4 : (span <= 180.0 + 1e-3 ? 2 : 1);
+    IESProfileData result;
+    result.res = Vector<uint32_t, 2>(
+        nh <= 1 ? 2 : std::min(std::max(4 * nh * factor, 32u), 1024u),
+        std::min(std::max(4 * nv, 32u), 512u));
+
+    result.data.resize(result.res.x() * result.res.y());
+    for (uint32_t y = 0; y < result.res.y(); ++y) {
+        double theta = 180.0 * y / (result.res.y() - 1);
+        for (uint32_t x = 0; x < result.res.x(); ++x) {
+            double phi = 360.0 * x / (result.res.x() - 1);
+            result.data[y * result.res.x() + x] = (float) lookup(phi, theta);
+        }
+    }
+
+    return result;
+}
 
 template <typename Float, typename Spectrum>
 class PointLight final : public Emitter<Float, Spectrum> {
@@ -39,6 +220,8 @@ public:
     MTS_IMPORT_BASE(Emitter, m_flags, m_medium, m_needs_sample_3, m_world_transform)
     MTS_IMPORT_TYPES(Scene, Shape, Texture)
 
+    using Warp = Hierarchical2D<Float, 0>;
+
     PointLight(const Properties &props) : Base(props) {
         if (props.has_property("position")) {
             if (props.has_property("to_world"))
@@ -50,6 +233,31 @@ public:
         }
 
         m_intensity = props.texture<Texture>("intensity", Texture::D65(1.f));
+
+        if (props.has_property("ies")) {
+            FileResolver *fs = Thread::thread()->file_resolver();
+            fs::path file_path = fs->resolve(props.string("ies"));
+            m_ies_name = file_path.filename().string();
+
+            IESProfileData profile = parse_ies(file_path, m_ies_name);
+            ScalarVector2u res(profile.res.x(), profile.res.y());
+
+            /* Weight by the Jacobian of the latitude-longitude
+               parameterization so that the warp samples directions (rather
+               than grid cells) proportionally to the profile */
+            std::unique_ptr<ScalarFloat[]> data(new ScalarFloat[hprod(res)]);
+            for (uint32_t y = 0; y < res.y(); ++y) {
+                ScalarFloat sin_theta = std::sin(
+                    y / ScalarFloat(res.y() - 1) * math::Pi<ScalarFloat>);
+                for (uint32_t x = 0; x < res.x(); ++x)
+                    data[y * res.x() + x] =
+                        profile.data[y * res.x() + x] * sin_theta;
+            }
+
+            m_profile = Warp(data.get(), res);
+            m_has_profile = true;
+        }
+
         m_needs_sample_3 = false;
         m_flags = +EmitterFlags::DeltaPosition;
     }
@@ -64,9 +272,20 @@ public:
             math::sample_shifted<Wavelength>(wavelength_sample), active);
 
         const auto &trafo = m_world_transform->eval(time);
-        Ray3f ray(trafo * Point3f(0.f),
-                 warp::square_to_uniform_sphere(dir_sample),
-                 time, wavelengths);
+
+        Vector3f d;
+        if (m_has_profile) {
+            /* Importance sample the photometric profile. Since the profile
+               is normalized to unit mean over the sphere, the resulting
+               weight coincides with that of the uniform case. */
+            Point2f uv = m_profile.sample(dir_sample).first;
+            d = trafo * math::sphdir(uv.y() * math::Pi<Float>,
+                                     uv.x() * (2.f * math::Pi<Float>));
+        } else {
+            d = warp::square_to_uniform_sphere(dir_sample);
+        }
+
+        Ray3f ray(trafo * Point3f(0.f), d, time, wavelengths);
 
         return { ray, unpolarized<Spectrum>(spec_weight) * (4.f * math::Pi<Float>) };
     }
@@ -94,6 +313,9 @@ public:
         si.wavelengths = it.wavelengths;
 
         Spectrum spec = m_intensity->eval(si, active) * (inv_dist * inv_dist);
+        if (m_has_profile)
+            spec *= profile_weight(trafo, -ds.d);
+
         return { ds, unpolarized<Spectrum>(spec) };
     }
 
@@ -107,6 +329,12 @@ public:
         return m_world_transform->translation_bounds();
     }
 
+    ScalarFloat power_estimate() const override {
+        /* Unaffected by the photometric profile, which is normalized to
+           unit mean over the sphere */
+        return 4.f * math::Pi<ScalarFloat> * m_intensity->mean();
+    }
+
     void traverse(TraversalCallback *callback) override {
         callback->put_object("intensity", m_intensity.get());
     }
@@ -115,15 +343,42 @@ public:
         std::ostringstream oss;
         oss << "PointLight[" << std::endl
             << "  world_transform = " << string::indent(m_world_transform->to_string()) << "," << std::endl
-            << "  intensity = " << m_intensity << "," << std::endl
-            << "  medium = " << (m_medium ? string::indent(m_medium->to_string()) : "")
+            << "  intensity = " << m_intensity << "," << std::endl;
+        if (m_has_profile)
+            oss << "  ies = \"" << m_ies_name << "\"," << std::endl;
+        oss << "  medium = " << (m_medium ? string::indent(m_medium->to_string()) : "")
             << "]";
         return oss.str();
     }
 
     MTS_DECLARE_CLASS()
 private:
+    /**
+     * \brief Evaluate the normalized photometric profile for the given
+     * world-space emission direction
+     *
+     * The warp stores the sine-weighted profile as a normalized density
+     * over the unit square; undoing the Jacobian and rescaling by the
+     * spherical mean yields a dimensionless weight whose average over the
+     * sphere equals one.
+     */
+    Float profile_weight(const Transform4f &trafo, const Vector3f &d_world) const {
+        Vector3f d = trafo.inverse().transform_affine(d_world);
+
+        Point2f uv(atan2(d.y(), d.x()) * math::InvTwoPi<Float>,
+                   safe_acos(d.z()) * math::InvPi<Float>);
+        uv.x() -= floor(uv.x());
+
+        Float inv_sin_theta = safe_rsqrt(
+            max(sqr(d.x()) + sqr(d.y()), sqr(math::Epsilon<Float>)));
+
+        return m_profile.eval(uv) * inv_sin_theta * (2.f * math::InvPi<Float>);
+    }
+
     ref<Texture> m_intensity;
+    Warp m_profile;
+    bool m_has_profile = false;
+    std::string m_ies_name;
 };
 
 
@@ -0,0 +1,539 @@
+#include <mitsuba/core/bsphere.h>
+#include <mitsuba/core/distr_2d.h>
+#include <mitsuba/core/frame.h>
+#include <mitsuba/core/math.h>
+#include <mitsuba/core/plugin.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/warp.h>
+#include <mitsuba/render/emitter.h>
+#include <mitsuba/render/scene.h>
+#include <mitsuba/render/srgb.h>
+#include <mitsuba/render/texture.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _emitter-sunsky:
+
+Sun and sky emitter (:monosp:`sunsky`)
+--------------------------------------
+
+.. pluginparameters::
+
+ * - turbidity
+   - |Float|
+   - Atmospheric turbidity, i.e. the amount of aerosol present in the
+     atmosphere. Smaller values produce a clear blue sky, larger values a
+     hazy, whitish one. Must lie in the interval [1, 10]. (Default: 3)
+ * - sun_direction
+   - |vector|
+   - Direction towards the sun in emitter coordinates, where the positive Y
+     axis points towards the zenith. (Default: (0, 1, 1), i.e. 45 degrees
+     of elevation)
+ * - sky_scale
+   - |Float|
+   - A scale factor applied to the radiance of the sky dome. (Default: 1.0)
+ * - sun_scale
+   - |Float|
+   - A scale factor applied to the radiance of the sun disc. (Default: 1.0)
+ * - sun_radius_scale
+   - |Float|
+   - Scale factor for the angular radius of the sun disc (0.2665 degrees).
+     Larger values produce softer shadows without changing the amount of
+     direct illumination. (Default: 1.0)
+ * - resolution
+   - |int|
+   - Side length of the precomputed table that importance samples the sky
+     dome. (Default: 256)
+ * - to_world
+   - |transform|
+   - Specifies an optional emitter-to-world transformation.
+     (Default: none, i.e. emitter space = world space)
+
+This plugin implements an analytic model of the clear daytime sky: the sky
+dome follows the Perez-style parameterization with the turbidity fits by
+Preetham et al., and the sun is modeled as a uniform disc whose color is
+attenuated by a simple air mass-dependent atmospheric transmittance. A
+captured HDR dome at a resolution sufficient to resolve the sun easily
+occupies hundreds of megabytes; this emitter evaluates the same kind of
+illumination in closed form from a handful of coefficients and only
+precomputes a small directional sampling table for the sky dome. The sun
+disc is importance sampled separately, which a texture-based dome cannot do
+without an extremely fine sampling table.
+
+Radiance values are expressed in kilo-candela per square meter; use the two
+scale parameters to adapt the absolute intensity to the units of a scene.
+
+.. code-block:: xml
+
+    <emitter type="sunsky">
+        <float name="turbidity" value="4"/>
+        <vector name="sun_direction" x="1" y="0.5" z="0"/>
+    </emitter>
+
+ */
+
+template <typename Float, typename Spectrum>
+class SunSkyEmitter final : public Emitter<Float, Spectrum> {
+public:
+    MTS_IMPORT_BASE(Emitter, m_flags, m_world_transform)
+    MTS_IMPORT_TYPES(Scene, Shape, Texture)
+
+    using Warp = Hierarchical2D<Float, 0>;
+
+    /// Mean angular radius of the solar disc as seen from earth (radians)
+    static constexpr ScalarFloat SunAppRadius = 0.2665f * math::Pi<ScalarFloat> / 180.f;
+
+    /// Mean luminance of the solar disc in kcd/m^2 before attenuation
+    static constexpr ScalarFloat SunLuminance = 1.6e6f;
+
+    SunSkyEmitter(const Properties &props) : Base(props) {
+        /* Until `set_scene` is called, we have no information
+           about the scene and default to the unit bounding sphere. */
+        m_bsphere = ScalarBoundingSphere3f(ScalarPoint3f(0.f), 1.f);
+
+        m_turbidity = props.float_("turbidity", 3.f);
+        if (m_turbidity < 1.f || m_turbidity > 10.f)
+            Throw("The turbidity parameter must lie in the interval [1, 10]!");
+
+        m_sun_dir = normalize(ScalarVector3f(
+            props.vector3f("sun_direction", ScalarVector3f(0.f, 1.f, 1.f))));
+
+        m_sky_scale        = props.float_("sky_scale", 1.f);
+        m_sun_scale        = props.float_("sun_scale", 1.f);
+        m_sun_radius_scale = props.float_("sun_radius_scale", 1.f);
+
+        uint32_t res = (uint32_t) props.size_("resolution", 256);
+        if (res < 4)
+            Throw("\"resolution\" must be >= 4!");
+        m_resolution = ScalarVector2u(res, res / 2);
+
+        m_d65 = Texture::D65(1.f);
+        m_flags = EmitterFlags::Infinite | EmitterFlags::SpatiallyVarying;
+
+        update();
+    }
+
+    /// Recompute the model coefficients and the sky sampling table
+    void update() {
+        ScalarFloat t = m_turbidity;
+
+        /* Perez function coefficients (luminance Y and chromaticities x, y)
+           from the turbidity fit by Preetham et al. */
+        const ScalarFloat coeff[3][5] = {
+            {  0.1787f * t - 1.4630f, -0.3554f * t + 0.4275f,
+              -0.0227f * t + 5.3251f,  0.1206f * t - 2.5771f,
+              -0.0670f * t + 0.3703f },
+            { -0.0193f * t - 0.2592f, -0.0665f * t + 0.0008f,
+              -0.0004f * t + 0.2125f, -0.0641f * t - 0.8989f,
+              -0.0033f * t + 0.0452f },
+            { -0.0167f * t - 0.2608f, -0.0950f * t + 0.0092f,
+              -0.0079f * t + 0.2102f, -0.0441f * t - 1.6537f,
+              -0.0109f * t + 0.0529f }
+        };
+        memcpy(m_coeff, coeff, sizeof(coeff));
+
+        ScalarFloat theta_s = std::acos(std::min(1.f, std::max(-1.f, m_sun_dir.y())));
+        bool sun_up = theta_s < .5f * math::Pi<ScalarFloat>;
+        if (!sun_up)
+            Log(Warn, "The sun is below the horizon -- only a residual sky "
+                      "dome will be visible.");
+
+        /* The zenith fits are only valid for daytime configurations */
+        theta_s = std::min(theta_s, .5f * math::Pi<ScalarFloat> - 1e-2f);
+        ScalarFloat cos_theta_s = std::cos(theta_s),
+                    theta_s_2 = theta_s * theta_s,
+                    theta_s_3 = theta_s_2 * theta_s;
+
+        // Zenith luminance (kcd/m^2) and chromaticities
+        ScalarFloat chi = (4.f / 9.f - t / 120.f) *
+                          (math::Pi<ScalarFloat> - 2.f * theta_s);
+        ScalarFloat zenith[3] = {
+            std::max(0.f, (4.0453f * t - 4.9710f) * std::tan(chi)
+                              - 0.2155f * t + 2.4192f),
+            t * t * ( 0.00166f * theta_s_3 - 0.00375f * theta_s_2 + 0.00209f * theta_s) +
+            t     * (-0.02903f * theta_s_3 + 0.06377f * theta_s_2 - 0.03202f * theta_s + 0.00394f) +
+                    ( 0.11693f * theta_s_3 - 0.21196f * theta_s_2 + 0.06052f * theta_s + 0.25886f),
+            t * t * ( 0.00275f * theta_s_3 - 0.00610f * theta_s_2 + 0.00317f * theta_s) +
+            t     * (-0.04214f * theta_s_3 + 0.08970f * theta_s_2 - 0.04153f * theta_s + 0.00516f) +
+                    ( 0.15346f * theta_s_3 - 0.26756f * theta_s_2 + 0.06670f * theta_s + 0.26688f)
+        };
+
+        for (int c = 0; c < 3; ++c)
+            m_norm[c] = zenith[c] / perez(ScalarFloat(1.f), theta_s,
+                                          cos_theta_s, c);
+
+        /* Sun disc: uniform radiance with a simple atmospheric
+           transmittance (Rayleigh scattering + aerosols) evaluated at
+           three representative wavelengths */
+        ScalarFloat theta_deg = theta_s * (180.f / math::Pi<ScalarFloat>),
+                    air_mass  = 1.f / (cos_theta_s +
+                                       0.15f * std::pow(93.885f - theta_deg, -1.253f)),
+                    beta      = 0.04608f * t - 0.04586f;
+
+        const ScalarFloat lambda[3] = { 0.65f, 0.55f, 0.44f }; // in micrometers
+        ScalarColor3f tau;
+        for (int c = 0; c < 3; ++c)
+            tau[c] = std::exp(-air_mass *
+                              (0.008735f * std::pow(lambda[c], -4.08f) +
+                               beta * std::pow(lambda[c], -1.3f)));
+
+        m_sun_radiance = (sun_up ? m_sun_scale : 0.f) * SunLuminance * tau;
+        m_sun_cos_cutoff =
+            std::cos(std::min(SunAppRadius * m_sun_radius_scale,
+                              .5f * math::Pi<ScalarFloat>));
+        if constexpr (is_spectral_v<Spectrum>) {
+            ScalarFloat scale = hmax(m_sun_radiance) * 2.f;
+            ScalarColor3f rgb_norm =
+                m_sun_radiance / std::max((ScalarFloat) 1e-8, scale);
+            m_sun_coeff = concat((ScalarColor3f) srgb_model_fetch(rgb_norm), scale);
+        }
+
+        build_tables();
+
+        /* Fraction of emitter samples dedicated to the sun disc, chosen
+           proportionally to the power each component contributes */
+        ScalarFloat sun_solid_angle =
+                        2.f * math::Pi<ScalarFloat> * (1.f - m_sun_cos_cutoff),
+                    sun_power = luminance(m_sun_radiance) * sun_solid_angle,
+                    sky_power = m_mean_luminance * 4.f * sqr(math::Pi<ScalarFloat>);
+        m_sun_sampling_weight =
+            sun_power > 0.f
+                ? std::min(.95f, sun_power / (sun_power + sky_power))
+                : 0.f;
+    }
+
+    void parameters_changed() override { update(); }
+
+    void set_scene(const Scene *scene) override {
+        m_bsphere = scene->bbox().bounding_sphere();
+        m_bsphere.radius = max(math::RayEpsilon<Float>,
+                               m_bsphere.radius * (1.f + math::RayEpsilon<Float>));
+    }
+
+    Spectrum eval(const SurfaceInteraction3f &si, Mask active) const override {
+        MTS_MASKED_FUNCTION(ProfilerPhase::EndpointEvaluate, active);
+
+        Vector3f d = m_world_transform->eval(si.time, active)
+                         .inverse()
+                         .transform_affine(-si.wi);
+
+        return unpolarized<Spectrum>(eval_direction(d, si.wavelengths, active));
+    }
+
+    std::pair<Ray3f, Spectrum> sample_ray(Float /* time */, Float /* wavelength_sample */,
+                                          const Point2f & /* sample2 */,
+                                          const Point2f & /* sample3 */,
+                                          Mask /* active */) const override {
+        NotImplementedError("sample_ray");
+    }
+
+    std::pair<DirectionSample3f, Spectrum>
+    sample_direction(const Interaction3f &it, const Point2f &sample, Mask active) const override {
+        MTS_MASKED_FUNCTION(ProfilerPhase::EndpointSampleDirection, active);
+
+        ScalarFloat w = m_sun_sampling_weight;
+        Mask pick_sun = active && sample.x() < w;
+
+        // Sun: uniformly sample a direction within the solar disc
+        Point2f sample_sun(sample);
+        sample_sun.x() /= std::max(w, (ScalarFloat) 1e-8);
+        Vector3f d_sun = Frame3f(Vector3f(m_sun_dir))
+                             .to_world(warp::square_to_uniform_cone(
+                                 sample_sun, Float(m_sun_cos_cutoff)));
+
+        // Sky: sample the precomputed hierarchical warp
+        Point2f sample_sky(sample);
+        sample_sky.x() =
+            (sample_sky.x() - w) / std::max(1.f - w, (ScalarFloat) 1e-8);
+        auto [uv_sky, warp_pdf] = m_warp.sample(sample_sky);
+        ENOKI_MARK_USED(warp_pdf);
+        Float theta = uv_sky.y() * math::Pi<Float>,
+              phi   = uv_sky.x() * (2.f * math::Pi<Float>);
+        Vector3f d_sky = math::sphdir(theta, phi);
+        d_sky = Vector3f(d_sky.y(), d_sky.z(), -d_sky.x());
+
+        Vector3f d = select(pick_sun, d_sun, d_sky);
+
+        Point2f uv = Point2f(atan2(d.x(), -d.z()) * math::InvTwoPi<Float>,
+                             safe_acos(d.y()) * math::InvPi<Float>);
+        uv -= floor(uv);
+
+        /* Evaluate the combined density of both sampling techniques so
+           that the sun disc remains correctly weighted when it is also
+           reachable through the sky warp */
+        Float pdf = pdf_direction_local(d);
+        active &= pdf > 0.f;
+
+        UnpolarizedSpectrum value =
+            eval_direction(d, it.wavelengths, active) / pdf;
+
+        Float dist = 2.f * m_bsphere.radius;
+        d = m_world_transform->eval(it.time, active).transform_affine(d);
+
+        DirectionSample3f ds;
+        ds.p      = it.p + d * dist;
+        ds.n      = -d;
+        ds.uv     = uv;
+        ds.time   = it.time;
+        ds.pdf    = select(active, pdf, 0.f);
+        ds.delta  = false;
+        ds.object = this;
+        ds.d      = d;
+        ds.dist   = dist;
+
+        return { ds, unpolarized<Spectrum>(select(active, value, 0.f)) };
+    }
+
+    Float pdf_direction(const Interaction3f &it, const DirectionSample3f &ds,
+                        Mask active) const override {
+        MTS_MASKED_FUNCTION(ProfilerPhase::EndpointEvaluate, active);
+
+        Vector3f d = m_world_transform->eval(it.time, active)
+                         .inverse()
+                         .transform_affine(ds.d);
+
+        return pdf_direction_local(d);
+    }
+
+    ScalarBoundingBox3f bbox() const override {
+        /* This emitter does not occupy any particular region
+           of space, return an invalid bounding box */
+        return ScalarBoundingBox3f();
+    }
+
+    ScalarFloat power_estimate() const override {
+        ScalarFloat sun_solid_angle =
+            2.f * math::Pi<ScalarFloat> * (1.f - m_sun_cos_cutoff);
+        return 4.f * sqr(math::Pi<ScalarFloat> * m_bsphere.radius) *
+               (m_mean_luminance + luminance(m_sun_radiance) * sun_solid_angle *
+                                       (1.f / (4.f * math::Pi<ScalarFloat>)));
+    }
+
+    void traverse(TraversalCallback *callback) override {
+        callback->put_parameter("turbidity", m_turbidity);
+        callback->put_parameter("sky_scale", m_sky_scale);
+        callback->put_parameter("sun_scale", m_sun_scale);
+        callback->put_parameter("sun_direction", m_sun_dir);
+    }
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "SunSkyEmitter[" << std::endl
+            << "  turbidity = " << m_turbidity << "," << std::endl
+            << "  sun_direction = " << m_sun_dir << "," << std::endl
+            << "  sky_scale = " << m_sky_scale << "," << std::endl
+            << "  sun_scale = " << m_sun_scale << "," << std::endl
+            << "  bsphere = " << m_bsphere << std::endl
+            << "]";
+        return oss.str();
+    }
+
+protected:
+    /// Perez luminance distribution function
+    template <typename Value>
+    MTS_INLINE Value perez(const Value &cos_theta, const Value &gamma,
+                           const Value &cos_gamma, int c) const {
+        return (1.f + m_coeff[c][0] *
+                          exp(m_coeff[c][1] / max(cos_theta, (Value) 1e-3f))) *
+               (1.f + m_coeff[c][2] * exp(m_coeff[c][3] * gamma) +
+                m_coeff[c][4] * sqr(cos_gamma));
+    }
+
+    /// Evaluate the sky dome (without the sun disc) as a linear sRGB color
+    template <typename Value>
+    Color<Value, 3> sky_radiance(const Value &cos_theta, const Value &gamma,
+                                 const Value &cos_gamma) const {
+        Value Y = m_norm[0] * perez(cos_theta, gamma, cos_gamma, 0),
+              x = m_norm[1] * perez(cos_theta, gamma, cos_gamma, 1),
+              y = m_norm[2] * perez(cos_theta, gamma, cos_gamma, 2);
+
+        // Convert the xyY specification to XYZ and then to linear sRGB
+        Color<Value, 3> xyz(x / y * Y, Y, (1.f - x - y) / y * Y);
+        Color<Value, 3> rgb = max(0.f, xyz_to_srgb(xyz)) * m_sky_scale;
+
+        return select(cos_theta > 0.f, rgb, Color<Value, 3>(0.f));
+    }
+
+    /// Evaluate the model for a direction in emitter coordinates
+    UnpolarizedSpectrum eval_direction(const Vector3f &d,
+                                       const Wavelength &wavelengths,
+                                       Mask active) const {
+        Float cos_theta = d.y(),
+              cos_gamma = dot(d, Vector3f(m_sun_dir)),
+              gamma     = safe_acos(cos_gamma);
+
+        Mask hit_sun = active && cos_gamma >= m_sun_cos_cutoff &&
+                       cos_theta > 0.f;
+
+        if constexpr (is_spectral_v<Spectrum>) {
+            /* Convert to latitude-longitude coordinates and interpolate
+               the precomputed spectral upsampling coefficients */
+            Point2f uv = Point2f(atan2(d.x(), -d.z()) * math::InvTwoPi<Float>,
+                                 safe_acos(d.y()) * math::InvPi<Float>);
+            uv -= floor(uv);
+            uv *= Vector2f(m_resolution - 1u);
+
+            Point2u pos = min(Point2u(uv), m_resolution - 2u);
+            Point2f w1 = uv - Point2f(pos),
+                    w0 = 1.f - w1;
+
+            const uint32_t width = m_resolution.x();
+            UInt32 index = pos.x() + pos.y() * width;
+
+            Vector4f v00 = gather<Vector4f>(m_data, index, active),
+                     v10 = gather<Vector4f>(m_data, index + 1, active),
+                     v01 = gather<Vector4f>(m_data, index + width, active),
+                     v11 = gather<Vector4f>(m_data, index + width + 1, active);
+
+            UnpolarizedSpectrum s00, s10, s01, s11, s0, s1, s;
+            Float f0, f1, f;
+
+            s00 = srgb_model_eval<UnpolarizedSpectrum>(head<3>(v00), wavelengths);
+            s10 = srgb_model_eval<UnpolarizedSpectrum>(head<3>(v10), wavelengths);
+            s01 = srgb_model_eval<UnpolarizedSpectrum>(head<3>(v01), wavelengths);
+            s11 = srgb_model_eval<UnpolarizedSpectrum>(head<3>(v11), wavelengths);
+
+            s0  = fmadd(w0.x(), s00, w1.x() * s10);
+            s1  = fmadd(w0.x(), s01, w1.x() * s11);
+            f0  = fmadd(w0.x(), v00.w(), w1.x() * v10.w());
+            f1  = fmadd(w0.x(), v01.w(), w1.x() * v11.w());
+
+            s   = fmadd(w0.y(), s0, w1.y() * s1);
+            f   = fmadd(w0.y(), f0, w1.y() * f1);
+
+            /// Evaluate the whitepoint spectrum
+            SurfaceInteraction3f si = zero<SurfaceInteraction3f>();
+            si.wavelengths = wavelengths;
+            UnpolarizedSpectrum wp = m_d65->eval(si, active);
+
+            UnpolarizedSpectrum sun =
+                srgb_model_eval<UnpolarizedSpectrum>(head<3>(m_sun_coeff),
+                                                     wavelengths) *
+                m_sun_coeff.w();
+
+            return wp * (s * f + select(hit_sun, sun, 0.f));
+        } else {
+            ENOKI_MARK_USED(wavelengths);
+            Color3f rgb = sky_radiance(cos_theta, gamma, cos_gamma);
+            rgb += select(hit_sun, Color3f(m_sun_radiance), Color3f(0.f));
+
+            if constexpr (is_monochromatic_v<Spectrum>)
+                return luminance(rgb);
+            else
+                return rgb;
+        }
+    }
+
+    /// Combined density of the sun/sky sampling strategies (emitter coordinates)
+    Float pdf_direction_local(const Vector3f &d) const {
+        Point2f uv = Point2f(atan2(d.x(), -d.z()) * math::InvTwoPi<Float>,
+                             safe_acos(d.y()) * math::InvPi<Float>);
+        uv -= floor(uv);
+
+        Float inv_sin_theta =
+            safe_rsqrt(max(sqr(d.x()) + sqr(d.z()), sqr(math::Epsilon<Float>)));
+        Float pdf_sky = m_warp.eval(uv) * inv_sin_theta *
+                        (1.f / (2.f * sqr(math::Pi<Float>)));
+
+        ScalarFloat w = m_sun_sampling_weight;
+        if (w == 0.f)
+            return pdf_sky;
+
+        Float pdf_sun =
+            select(dot(d, Vector3f(m_sun_dir)) >= m_sun_cos_cutoff,
+                   Float(math::InvTwoPi<ScalarFloat> /
+                         (1.f - m_sun_cos_cutoff)),
+                   Float(0.f));
+
+        return (1.f - w) * pdf_sky + w * pdf_sun;
+    }
+
+    /**
+     * \brief Tabulate the luminance of the sky dome over a lat-long grid
+     * and construct the hierarchical sample warp from it
+     *
+     * In spectral modes, the same pass also caches the coefficients of the
+     * spectral upsampling model, which are too expensive to fit per ray.
+     */
+    void build_tables() {
+        uint32_t w = m_resolution.x(), h = m_resolution.y();
+
+        std::unique_ptr<ScalarFloat[]> luminance_(new ScalarFloat[w * (size_t) h]);
+        std::unique_ptr<ScalarFloat[]> data;
+        if constexpr (is_spectral_v<Spectrum>)
+            data.reset(new ScalarFloat[w * (size_t) h * 4]);
+
+        ScalarFloat *lum_ptr = luminance_.get(),
+                    *ptr     = data.get();
+        double lum_accum = 0.0;
+
+        for (uint32_t y = 0; y < h; ++y) {
+            ScalarFloat theta = y / ScalarFloat(h - 1) * math::Pi<ScalarFloat>,
+                        sin_theta = std::sin(theta);
+
+            for (uint32_t x = 0; x < w; ++x) {
+                ScalarFloat phi = x / ScalarFloat(w - 1) *
+                                  (2.f * math::Pi<ScalarFloat>);
+
+                ScalarVector3f d = math::sphdir(theta, phi);
+                d = ScalarVector3f(d.y(), d.z(), -d.x());
+
+                ScalarFloat cos_gamma = dot(d, m_sun_dir),
+                            gamma = std::acos(
+                                std::min(1.f, std::max(-1.f, cos_gamma)));
+
+                ScalarColor3f rgb = sky_radiance(d.y(), gamma, cos_gamma);
+                ScalarFloat lum = luminance(rgb);
+
+                if constexpr (is_spectral_v<Spectrum>) {
+                    ScalarFloat scale = hmax(rgb) * 2.f;
+                    ScalarColor3f rgb_norm =
+                        rgb / std::max((ScalarFloat) 1e-8, scale);
+                    ScalarVector4f coeff =
+                        concat((ScalarColor3f) srgb_model_fetch(rgb_norm), scale);
+                    store_unaligned(ptr, coeff);
+                    ptr += 4;
+                }
+
+                *lum_ptr++ = lum * sin_theta;
+                lum_accum += (double) (lum * sin_theta);
+            }
+        }
+
+        if constexpr (is_spectral_v<Spectrum>)
+            m_data = DynamicBuffer<Float>::copy(data.get(), w * (size_t) h * 4);
+
+        m_mean_luminance = (ScalarFloat) (lum_accum / (w * (size_t) h));
+        m_warp = Warp(luminance_.get(), m_resolution);
+    }
+
+    MTS_DECLARE_CLASS()
+protected:
+    ScalarBoundingSphere3f m_bsphere;
+    ScalarFloat m_turbidity;
+    ScalarVector3f m_sun_dir;
+    ScalarFloat m_sky_scale, m_sun_scale, m_sun_radius_scale;
+
+    /// Perez function coefficients and normalized zenith values (Y, x, y)
+    ScalarFloat m_coeff[3][5];
+    ScalarFloat m_norm[3];
+
+    /// Radiance of the sun disc and the cosine of its angular cutoff
+    ScalarColor3f m_sun_radiance;
+    ScalarVector4f m_sun_coeff = 0.f;
+    ScalarFloat m_sun_cos_cutoff;
+    ScalarFloat m_sun_sampling_weight = 0.f;
+
+    /// Directional sampling table for the sky dome
+    ScalarVector2u m_resolution;
+    Warp m_warp;
+    DynamicBuffer<Float> m_data;
+    ref<Texture> m_d65;
+    ScalarFloat m_mean_luminance = 1.f;
+};
+
+MTS_IMPLEMENT_CLASS_VARIANT(SunSkyEmitter, Emitter)
+MTS_EXPORT_PLUGIN(SunSkyEmitter, "Sun and sky emitter")
+NAMESPACE_END(mitsuba)
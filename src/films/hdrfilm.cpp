@@ -1,11 +1,25 @@
 #include <mitsuba/core/bitmap.h>
 #include <mitsuba/core/filesystem.h>
 #include <mitsuba/core/fstream.h>
+#include <mitsuba/core/zstream.h>
 #include <mitsuba/core/spectrum.h>
 #include <mitsuba/core/string.h>
 #include <mitsuba/render/film.h>
 #include <mitsuba/render/fwd.h>
 #include <mitsuba/render/imageblock.h>
+#include <mitsuba/render/spiral.h>
+#include <tbb/spin_mutex.h>
+#include <tbb/task_group.h>
+#include <mutex>
+#include <thread>
+
+#if defined(MTS_ENABLE_OIDN)
+#  include <OpenImageDenoise/oidn.hpp>
+#endif
+
+/// Identifies sample-stream files ("MTSS"), see \ref HDRFilm::put_sample()
+#define MTS_SAMPLE_STREAM_MAGIC   0x5353544Du
+#define MTS_SAMPLE_STREAM_VERSION 1u
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -45,6 +59,72 @@ High dynamic range film (:monosp:`hdrfilm`)
    - If set to |true|, regions slightly outside of the film plane will also be sampled. This may
      improve the image quality at the edges, especially when using very large reconstruction
      filters. In general, this is not needed though. (Default: |false|, i.e. disabled)
+ * - tiled
+   - |bool|
+   - If set to |true|, finished image blocks are immediately flushed to a tiled OpenEXR file and
+     evicted from memory instead of being accumulated in RAM until the end of the rendering. This
+     bounds the memory footprint of the film and is mainly useful for very high-resolution output.
+     Only supported for :monosp:`file_format=openexr` in the CPU rendering modes, and not
+     compatible with AOV output. (Default: |false|, i.e. disabled)
+ * - tile_size
+   - |int|
+   - Side length of the tiles written in tiled mode, which must match the block size used by the
+     integrator. (Default: 32, i.e. the default block size)
+ * - compression
+   - |string|
+   - Compression scheme applied to OpenEXR output. The options are :monosp:`default`,
+     :monosp:`none`, :monosp:`rle`, :monosp:`zips`, :monosp:`zip`, :monosp:`piz`,
+     :monosp:`pxr24`, :monosp:`b44`, :monosp:`b44a`, :monosp:`dwaa`, and :monosp:`dwab`;
+     all but the last five are lossless. (Default: :monosp:`default`, i.e. the lossless
+     PIZ wavelet compressor)
+ * - compression_level
+   - |int|
+   - Compression level of the lossy :monosp:`dwaa` and :monosp:`dwab` schemes, with higher
+     values corresponding to a lower quality. (Default: 45, the OpenEXR default)
+ * - asynchronous
+   - |bool|
+   - If set to |true|, developing the film hands the converted image to a background
+     task that performs the compression and file I/O, so that e.g. the next frame of a
+     sequence can start rendering immediately. Any pending writes are completed when the
+     film is garbage collected. Not compatible with tiled output. (Default: |false|)
+ * - aov_storage_format
+   - |string|
+   - Specifies the in-memory precision used to accumulate AOV channels (i.e. all channels except
+     the color, alpha, and sample weight). The options are :monosp:`float32` and :monosp:`float16`;
+     the latter halves the film's memory footprint for AOV-heavy renderings at high resolutions.
+     Samples are still accumulated in full precision within each render block and only rounded
+     when a finished block is merged into the film. Only supported in the CPU rendering modes.
+     (Default: :monosp:`float32`)
+ * - planar
+   - |bool|
+   - If set to |true|, the film accumulates each channel in a separate contiguous plane
+     (structure-of-arrays layout) instead of interleaving the channels of every pixel.
+     This benefits AOV-heavy configurations (e.g. denoiser-ready renders with 10+ channels),
+     where both block merges and the develop-time per-channel format conversion otherwise
+     stride through memory with poor locality. Not compatible with
+     :monosp:`aov_storage_format=float16` or tiled output, and only supported in the CPU
+     rendering modes. (Default: |false|, i.e. interleaved storage)
+ * - sample_stream
+   - |string|
+   - Optional filename of a compressed per-sample output stream. When specified, every sample
+     that the integrator produces is additionally appended to this file in raw (unfiltered) form:
+     its fractional pixel position followed by all film channel values. This allows reconstruction
+     filtering, exposure, or deep-compositing decisions to be revisited after the render without
+     tracing any new paths---pair it with an :ref:`aov <integrator-aov>` integrator to include
+     per-sample depth for deep holdouts. Samples are buffered in per-thread shards and
+     deflate-compressed as they are written, so memory usage stays bounded. Only supported in the
+     CPU rendering modes. (Default: unused)
+ * - denoise
+   - |bool|
+   - If set to |true|, the developed image is run through Intel Open Image Denoise before it is
+     written to disk. Requires Mitsuba to be compiled with :monosp:`MTS_ENABLE_OIDN=ON`, and is
+     not compatible with tiled output. (Default: |false|, i.e. disabled)
+ * - denoise_normal_channel, denoise_albedo_channel
+   - |string|
+   - Names of 3-component AOVs (as declared in an :ref:`aov <integrator-aov>` integrator, e.g.
+     :monosp:`nn:sh_normal`) whose channels :monosp:`<name>.X/.Y/.Z` should be fed to the denoiser
+     as auxiliary normal and albedo guide buffers. Guide buffers considerably improve the quality
+     of the denoised output, especially at low sample counts. (Default: unused)
  * - (Nested plugin)
    - :paramtype:`rfilter`
    - Reconstruction filter that should be used by the film. (Default: :monosp:`gaussian`, a windowed
@@ -65,6 +145,21 @@ For OpenEXR files, Mitsuba 2 also supports fully general multi-channel output; r
 the :ref:`aov <integrator-aov>` or :ref:`stokes <integrator-stokes>` plugins for
 details on how this works.
 
+When the resolution is so large that the floating point film itself strains the available
+memory (e.g. 16k x 16k panoramas), the :monosp:`tiled` mode streams each finished
+image block straight into a tiled OpenEXR file, so that at most the blocks currently being
+rendered reside in memory. Since blocks are written out independently, reconstruction
+filter contributions that extend beyond a block boundary are discarded in this mode---use
+a filter with a radius of at most 0.5 (e.g. :monosp:`box`) to obtain output that exactly
+matches the default in-memory mode.
+
+When Mitsuba is compiled with Open Image Denoise support (:monosp:`MTS_ENABLE_OIDN=ON`),
+setting :monosp:`denoise=true` runs the developed image through the denoiser as a
+post-processing stage just before it is written to disk. The color channels are denoised in
+place; auxiliary normal and albedo guide buffers can be supplied via suitably named AOV
+channels (see :monosp:`denoise_normal_channel` and :monosp:`denoise_albedo_channel` above),
+and any remaining AOV channels are passed through unmodified.
+
 The plugin can also write RLE-compressed files in the Radiance RGBE format pioneered by Greg Ward
 (set :monosp:`file_format=rgbe`), as well as the Portable Float Map format
 (set :monosp:`file_format=pfm`). In the former case, the :monosp:`component_format` and
@@ -92,7 +187,8 @@ The following XML snippet discribes a film that writes a full-HD RGBA OpenEXR fi
 template <typename Float, typename Spectrum>
 class HDRFilm final : public Film<Float, Spectrum> {
 public:
-    MTS_IMPORT_BASE(Film, m_size, m_crop_size, m_crop_offset, m_high_quality_edges, m_filter)
+    MTS_IMPORT_BASE(Film, m_size, m_crop_size, m_crop_offset, m_high_quality_edges, m_filter,
+                    add_post_process, run_post_process)
     MTS_IMPORT_TYPES(ImageBlock)
 
     HDRFilm(const Properties &props) : Base(props) {
@@ -104,6 +200,9 @@ public:
             props.string("component_format", "float16"));
 
         m_dest_file = props.string("filename", "");
+        m_tiled = props.bool_("tiled", false);
+        m_tile_size = (uint32_t) props.size_("tile_size", MTS_BLOCK_SIZE);
+        m_sample_stream_path = props.string("sample_stream", "");
 
         if (file_format == "openexr" || file_format == "exr")
             m_file_format = Bitmap::FileFormat::OpenEXR;
@@ -141,6 +240,17 @@ public:
                   pixel_format);
         }
 
+        std::string aov_storage_format = string::to_lower(
+            props.string("aov_storage_format", "float32"));
+        if (aov_storage_format == "float32")
+            m_half_aov_storage = false;
+        else if (aov_storage_format == "float16")
+            m_half_aov_storage = true;
+        else
+            Throw("The \"aov_storage_format\" parameter must either be "
+                  "equal to \"float32\" or \"float16\". Found %s instead.",
+                  aov_storage_format);
+
         if (component_format == "float16")
             m_component_format = Struct::Type::Float16;
         else if (component_format == "float32")
@@ -153,6 +263,50 @@ public:
                   " Found %s instead.", component_format);
         }
 
+        std::string compression = string::to_lower(
+            props.string("compression", "default"));
+        if (compression == "default")
+            m_compression = Bitmap::Compression::Default;
+        else if (compression == "none")
+            m_compression = Bitmap::Compression::None;
+        else if (compression == "rle")
+            m_compression = Bitmap::Compression::RLE;
+        else if (compression == "zips")
+            m_compression = Bitmap::Compression::ZIPS;
+        else if (compression == "zip")
+            m_compression = Bitmap::Compression::ZIP;
+        else if (compression == "piz")
+            m_compression = Bitmap::Compression::PIZ;
+        else if (compression == "pxr24")
+            m_compression = Bitmap::Compression::PXR24;
+        else if (compression == "b44")
+            m_compression = Bitmap::Compression::B44;
+        else if (compression == "b44a")
+            m_compression = Bitmap::Compression::B44A;
+        else if (compression == "dwaa")
+            m_compression = Bitmap::Compression::DWAA;
+        else if (compression == "dwab")
+            m_compression = Bitmap::Compression::DWAB;
+        else {
+            Throw("The \"compression\" parameter must be one of \"default\", "
+                  "\"none\", \"rle\", \"zips\", \"zip\", \"piz\", \"pxr24\", "
+                  "\"b44\", \"b44a\", \"dwaa\", or \"dwab\". Found %s instead.",
+                  compression);
+        }
+
+        m_compression_level = props.int_("compression_level", -1);
+        m_asynchronous = props.bool_("asynchronous", false);
+        m_planar = props.bool_("planar", false);
+
+        if (m_planar && m_half_aov_storage)
+            Throw("planar=true cannot be combined with "
+                  "aov_storage_format=\"float16\"!");
+
+        if (m_compression != Bitmap::Compression::Default &&
+            m_file_format != Bitmap::FileFormat::OpenEXR)
+            Log(Warn, "The \"compression\" parameter only applies to "
+                      "file_format=\"openexr\" -- ignoring.");
+
         if (m_file_format == Bitmap::FileFormat::RGBE) {
             if (m_pixel_format != Bitmap::PixelFormat::RGB) {
                 Log(Warn, "The RGBE format only supports pixel_format=\"rgb\"."
@@ -177,6 +331,38 @@ public:
                 m_component_format = Struct::Type::Float32;
             }
         }
+
+        if (m_tiled) {
+            if constexpr (is_cuda_array_v<Float>)
+                Throw("Tiled film output is only supported in the CPU "
+                      "rendering modes!");
+            if (m_file_format != Bitmap::FileFormat::OpenEXR)
+                Throw("Tiled film output requires file_format=\"openexr\"!");
+            if (m_tile_size == 0)
+                Throw("The \"tile_size\" parameter must be positive!");
+            if (m_asynchronous)
+                Throw("Tiled film output cannot be combined with "
+                      "asynchronous writing!");
+            if (m_planar)
+                Throw("Tiled film output cannot be combined with planar "
+                      "storage!");
+        }
+
+        m_denoise = props.bool_("denoise", false);
+        m_denoise_normal_channel = props.string("denoise_normal_channel", "");
+        m_denoise_albedo_channel = props.string("denoise_albedo_channel", "");
+
+        if (m_denoise) {
+#if !defined(MTS_ENABLE_OIDN)
+            Throw("Denoising requires Open Image Denoise support, which was "
+                  "not enabled at compile time (set MTS_ENABLE_OIDN=ON in "
+                  "CMake)!");
+#else
+            if (m_tiled)
+                Throw("Tiled film output cannot be combined with denoising!");
+            add_post_process([this](Bitmap *bitmap) { denoise(bitmap); });
+#endif
+        }
     }
 
     void set_destination_file(const fs::path &dest_file) override {
@@ -194,15 +380,293 @@ public:
                 Throw("Film::prepare(): duplicate channel name \"%s\"", channels[i]);
         }
 
-        m_storage = new ImageBlock(m_crop_size, channels.size());
-        m_storage->set_offset(m_crop_offset);
-        m_storage->clear();
+        if (m_tiled) {
+            if (channels.size() != 5)
+                Throw("Tiled film output does not support AOVs!");
+            if (m_dest_file.empty())
+                Throw("Tiled film output requires the destination file to be "
+                      "specified before rendering starts!");
+            if (m_filter->border_size() > 0)
+                Log(Warn, "Tiled film output discards reconstruction filter "
+                          "contributions that cross a block boundary -- use a "
+                          "filter with a radius of at most 0.5 (e.g. \"box\") "
+                          "to avoid visible seams.");
+
+            // Determine the channel layout of the output file
+            ref<Bitmap> layout = new Bitmap(m_pixel_format, m_component_format,
+                                            ScalarVector2u(1, 1));
+
+            fs::path filename = m_dest_file;
+            if (string::to_lower(filename.extension().string()) != ".exr")
+                filename.replace_extension(".exr");
+
+            m_writer = new TiledBitmapWriter(filename,
+                                             ScalarVector2u(m_crop_size),
+                                             m_tile_size, layout->struct_(),
+                                             m_compression);
+            m_storage = nullptr;
+        } else {
+            m_storage = new ImageBlock(m_crop_size, channels.size());
+            m_storage->set_offset(m_crop_offset);
+            if (m_planar) {
+                if constexpr (is_cuda_array_v<Float>)
+                    Log(Warn, "planar=true is only available in the CPU "
+                              "rendering modes -- ignoring.");
+                else
+                    m_storage->set_planar(true);
+            }
+            if (m_half_aov_storage && channels.size() > 5) {
+                if constexpr (is_cuda_array_v<Float>) {
+                    Log(Warn, "aov_storage_format=\"float16\" is only "
+                              "available in the CPU rendering modes -- "
+                              "ignoring.");
+                } else {
+                    /* The color, alpha, and sample weight channels remain in
+                       full precision; the remaining AOV channels are rounded
+                       to half precision upon each block merge */
+                    std::vector<bool> half(channels.size(), true);
+                    for (size_t i = 0; i < 5; ++i)
+                        half[i] = false;
+                    m_storage->set_half_channels(half);
+                }
+            }
+            m_storage->clear();
+        }
+        if (m_splat_storage)
+            m_splat_storage->clear();
         m_channels = channels;
+
+        if (!m_sample_stream_path.empty()) {
+            if constexpr (is_cuda_array_v<Float>)
+                Log(Warn, "\"sample_stream\": per-sample recording is only "
+                          "supported in the CPU rendering modes -- ignoring.");
+            else
+                open_sample_stream();
+        }
     }
 
-    void put(const ImageBlock *block) override {
+    void put_splat(const Point2f &pos, const Wavelength &wavelengths,
+                   const Spectrum &value, Mask active = true) const override {
+        Assert(m_splat_storage != nullptr);
+        m_splat_storage->put(pos, wavelengths, value, 0.f, active);
+    }
+
+    void set_splat_scale(ScalarFloat scale) override {
+        if constexpr (is_cuda_array_v<Float>)
+            Throw("HDRFilm::set_splat_scale(): splatted contributions are "
+                  "only supported in the CPU rendering modes!");
+
+        if (m_tiled)
+            Throw("Tiled film output cannot be combined with splatted "
+                  "contributions!");
+
+        m_splat_scale = scale;
+
+        if (!m_splat_storage) {
+            /* Unlike the per-thread render blocks, the splat buffer covers
+               the whole film and is shared between all worker threads, hence
+               samples must be deposited using atomic additions. Splats carry
+               no sample weight; they are normalized to unit filter energy
+               and later scaled by m_splat_scale instead. */
+            m_splat_storage = new ImageBlock(
+                m_crop_size, 5, m_filter.get(), true /* warn_negative */,
+                true /* warn_invalid */, false /* border */,
+                true /* normalize */);
+            m_splat_storage->set_offset(m_crop_offset);
+            m_splat_storage->set_atomic(true);
+            m_splat_storage->clear();
+        }
+    }
+
+    void put_sample(const Point2f &pos, const Float *values,
+                    Mask active = true) const override {
+        if constexpr (is_cuda_array_v<Float>) {
+            ENOKI_MARK_USED(pos);
+            ENOKI_MARK_USED(values);
+            ENOKI_MARK_USED(active);
+        } else {
+            if (!m_sample_stream)
+                return;
+
+            /* Append buffers are sharded by thread, so that compressing and
+               writing out one full shard does not stall the workers that
+               are filling the others */
+            SampleShard &shard = m_sample_shards[
+                std::hash<std::thread::id>()(std::this_thread::get_id()) %
+                SampleShardCount];
+
+            std::vector<ScalarFloat> flush_data;
+            /* scope for shard lock */ {
+                tbb::spin_mutex::scoped_lock lock(shard.mutex);
+
+                auto append = [&](size_t lane) {
+                    shard.data.push_back(slice(pos.x(), lane));
+                    shard.data.push_back(slice(pos.y(), lane));
+                    for (size_t k = 0; k < m_channels.size(); ++k)
+                        shard.data.push_back(slice(values[k], lane));
+                };
+
+                if constexpr (is_array_v<Float>) {
+                    for (size_t l = 0; l < array_size_v<Float>; ++l) {
+                        if (active.coeff(l))
+                            append(l);
+                    }
+                } else {
+                    if (active)
+                        append(0);
+                }
+
+                if (shard.data.size() >= SampleShardFlushSize)
+                    flush_data.swap(shard.data);
+            }
+
+            if (!flush_data.empty()) {
+                std::lock_guard<std::mutex> guard(m_sample_stream_mutex);
+                m_sample_stream->write_array(flush_data.data(),
+                                             flush_data.size());
+            }
+        }
+    }
+
+    bool has_sample_stream() const override {
+        return m_sample_stream != nullptr;
+    }
+
+    /// Open the compressed sample-stream file and write its header
+    void open_sample_stream() {
+        std::lock_guard<std::mutex> guard(m_sample_stream_mutex);
+
+        // Finalize the previous job's stream first, if any
+        m_sample_stream = nullptr;
+
+        ref<FileStream> file =
+            new FileStream(m_sample_stream_path, FileStream::ETruncReadWrite);
+        file->set_byte_order(Stream::ELittleEndian);
+        file->write((uint32_t) MTS_SAMPLE_STREAM_MAGIC);
+        file->write((uint32_t) MTS_SAMPLE_STREAM_VERSION);
+        file->write((uint32_t) m_crop_size.x());
+        file->write((uint32_t) m_crop_size.y());
+        file->write((uint32_t) m_channels.size());
+        for (const std::string &name : m_channels) {
+            file->write((uint32_t) name.size());
+            file->write_array(name.data(), name.size());
+        }
+
+        /* The sample records (2 + channel_count floats each) follow the
+           header as a single deflate-compressed stream */
+        m_sample_stream = new ZStream(file);
+        if (!m_sample_shards)
+            m_sample_shards.reset(new SampleShard[SampleShardCount]);
+    }
+
+    /// Write out any sample records still sitting in the per-thread shards
+    void flush_sample_stream() const {
+        if (!m_sample_stream)
+            return;
+
+        for (size_t i = 0; i < SampleShardCount; ++i) {
+            SampleShard &shard = m_sample_shards[i];
+            std::vector<ScalarFloat> data;
+            /* scope for shard lock */ {
+                tbb::spin_mutex::scoped_lock lock(shard.mutex);
+                data.swap(shard.data);
+            }
+            if (data.empty())
+                continue;
+
+            std::lock_guard<std::mutex> guard(m_sample_stream_mutex);
+            m_sample_stream->write_array(data.data(), data.size());
+        }
+    }
+
+    void clear_region(const ScalarPoint2i &offset,
+                      const ScalarVector2i &size) override {
+        if constexpr (is_cuda_array_v<Float>)
+            Throw("HDRFilm::clear_region(): incremental region updates are "
+                  "only supported in the CPU rendering modes!");
+
+        if (m_tiled)
+            Throw("Tiled film output does not support incremental region "
+                  "updates!");
         Assert(m_storage != nullptr);
-        m_storage->put(block);
+
+        if (m_storage->has_half_channels())
+            Throw("HDRFilm::clear_region(): unsupported in combination with "
+                  "half-precision film storage!");
+
+        if (any(offset < m_crop_offset ||
+                offset + size > m_crop_offset + m_crop_size))
+            Throw("HDRFilm::clear_region(): region %s + %s lies outside of "
+                  "the crop window!", offset, size);
+
+        /* The storage block carries no reconstruction filter border, hence
+           its contents map 1:1 onto the crop window */
+        ScalarPoint2i rel = offset - m_crop_offset;
+        size_t ch    = m_storage->channel_count(),
+               width = (size_t) m_storage->width();
+        if (m_storage->planar()) {
+            size_t plane = width * m_storage->height();
+            ScalarFloat *base = (ScalarFloat *) m_storage->data().data() +
+                                rel.x() + rel.y() * width;
+            for (size_t k = 0; k < ch; ++k) {
+                ScalarFloat *ptr = base + k * plane;
+                for (int y = 0; y < size.y(); ++y, ptr += width)
+                    memset(ptr, 0, size.x() * sizeof(ScalarFloat));
+            }
+        } else {
+            size_t stride = width * ch;
+            ScalarFloat *ptr = (ScalarFloat *) m_storage->data().data() +
+                               rel.x() * ch + rel.y() * stride;
+            for (int y = 0; y < size.y(); ++y, ptr += stride)
+                memset(ptr, 0, size.x() * ch * sizeof(ScalarFloat));
+        }
+    }
+
+    void put(const ImageBlock *block) override {
+        if (!m_tiled) {
+            Assert(m_storage != nullptr);
+            m_storage->put(block);
+            return;
+        }
+
+        if constexpr (!is_cuda_array_v<Float>) {
+            Assert(m_writer != nullptr);
+
+            /* Convert the finished block to the output pixel format and
+               immediately append it to the tiled output file */
+            int border = block->border_size();
+            ScalarVector2i full_size = block->size() + 2 * border;
+
+            ref<Bitmap> source = new Bitmap(
+                Bitmap::PixelFormat::XYZAW, struct_type_v<ScalarFloat>,
+                ScalarVector2u(full_size), block->channel_count(),
+                (uint8_t *) block->data().data());
+
+            ref<Bitmap> converted =
+                source->convert(m_pixel_format, m_component_format, false);
+
+            if (border != 0) {
+                /* Drop the reconstruction filter border, whose contributions
+                   belong to neighboring blocks */
+                ref<Bitmap> interior = new Bitmap(
+                    m_pixel_format, m_component_format,
+                    ScalarVector2u(block->size()));
+
+                size_t bpp = converted->bytes_per_pixel();
+                const uint8_t *src = converted->uint8_data() +
+                    (border + border * (size_t) full_size.x()) * bpp;
+                uint8_t *dst = interior->uint8_data();
+                for (int y = 0; y < block->size().y(); ++y) {
+                    memcpy(dst, src, block->width() * bpp);
+                    src += full_size.x() * bpp;
+                    dst += block->width() * bpp;
+                }
+                converted = interior;
+            }
+
+            m_writer->put(ScalarPoint2u(block->offset() - m_crop_offset),
+                          converted);
+        }
     }
 
     bool develop(const ScalarPoint2i  &source_offset,
@@ -244,15 +708,31 @@ public:
     }
 
     ref<Bitmap> bitmap(bool raw = false) override {
+        if (m_tiled)
+            Throw("bitmap(): unsupported in tiled output mode -- the image "
+                  "is streamed to disk while rendering!");
+
         if constexpr (is_cuda_array_v<Float>) {
             cuda_eval();
             cuda_sync();
         }
 
-        ref<Bitmap> source = new Bitmap(m_channels.size() != 5 ? Bitmap::PixelFormat::MultiChannel
-                                                               : Bitmap::PixelFormat::XYZAW,
-                          struct_type_v<ScalarFloat>, m_storage->size(), m_storage->channel_count(),
-                          (uint8_t *) m_storage->data().managed().data());
+        ref<Bitmap> source;
+        if (m_storage->has_half_channels() || m_storage->planar()) {
+            /* Expand the mixed-precision or channel-planar film contents
+               into an interleaved temporary buffer */
+            source = new Bitmap(m_channels.size() != 5 ? Bitmap::PixelFormat::MultiChannel
+                                                       : Bitmap::PixelFormat::XYZAW,
+                                struct_type_v<ScalarFloat>, m_storage->size(),
+                                m_storage->channel_count());
+            m_storage->unpack((ScalarFloat *) source->uint8_data());
+        } else {
+            source = new Bitmap(m_channels.size() != 5 ? Bitmap::PixelFormat::MultiChannel
+                                                       : Bitmap::PixelFormat::XYZAW,
+                                struct_type_v<ScalarFloat>, m_storage->size(),
+                                m_storage->channel_count(),
+                                (uint8_t *) m_storage->data().managed().data());
+        }
 
         if (raw)
             return source;
@@ -313,13 +793,195 @@ public:
 
         source->convert(target);
 
+        if (m_splat_storage) {
+            /* Add the splatted contributions (see \ref put_splat()). Unlike
+               the main storage, the splat buffer holds unit-energy splats
+               that are normalized by the splat scale rather than by the
+               accumulated sample weight, so the Weight flag assigned to the
+               "W" channel of XYZAW bitmaps must be cleared before the
+               conversion. */
+            ref<Bitmap> splat_source = new Bitmap(
+                Bitmap::PixelFormat::XYZAW, struct_type_v<ScalarFloat>,
+                m_splat_storage->size(), m_splat_storage->channel_count(),
+                (uint8_t *) m_splat_storage->data().managed().data());
+
+            for (size_t i = 0; i < splat_source->struct_()->field_count(); ++i)
+                splat_source->struct_()->operator[](i).flags &= ~Struct::Flags::Weight;
+
+            ref<Bitmap> splat_converted = splat_source->convert(
+                has_aovs ? Bitmap::PixelFormat::RGB : m_pixel_format,
+                Struct::Type::Float32, false);
+
+            ref<Bitmap> accum = target;
+            if (m_component_format != Struct::Type::Float32)
+                accum = target->convert(target->pixel_format(),
+                                        Struct::Type::Float32, false);
+
+            /* The color (and alpha) channels lead in both layouts; any AOV
+               channels that follow are unaffected by splats */
+            size_t pixel_count = hprod(m_splat_storage->size()),
+                   ch_accum    = accum->channel_count(),
+                   ch_splat    = splat_converted->channel_count(),
+                   ch_copy     = has_aovs ? 3 : ch_splat;
+
+            float *a = (float *) accum->uint8_data();
+            const float *s = (const float *) splat_converted->uint8_data();
+            if (ch_copy == ch_accum && ch_copy == ch_splat) {
+                /* Matching layouts: one contiguous SIMD multiply-add */
+                accumulate_1d(s, a, pixel_count * ch_copy,
+                              (float) m_splat_scale);
+            } else {
+                for (size_t i = 0; i < pixel_count; ++i)
+                    for (size_t k = 0; k < ch_copy; ++k)
+                        a[i * ch_accum + k] +=
+                            (float) m_splat_scale * s[i * ch_splat + k];
+            }
+
+            if (accum != target)
+                accum->convert(target);
+        }
+
         return target;
      };
 
+#if defined(MTS_ENABLE_OIDN)
+    /**
+     * Run Open Image Denoise over the color channels of the developed image,
+     * optionally feeding normal and albedo AOV channels as guide buffers.
+     * The image is modified in place; all other channels pass through
+     * unchanged.
+     */
+    void denoise(Bitmap *bitmap) const {
+        if (bitmap->component_format() != Struct::Type::Float32) {
+            /* The denoiser operates on single precision data: convert,
+               denoise, and convert back to the output component format */
+            ref<Bitmap> tmp = bitmap->convert(bitmap->pixel_format(),
+                                              Struct::Type::Float32, false);
+            denoise(tmp);
+            tmp->convert(bitmap);
+            return;
+        }
+
+        size_t width       = bitmap->width(),
+               height      = bitmap->height(),
+               pixel_count = width * height,
+               ch_count    = bitmap->channel_count();
+
+        /* Locate the color channels and, if requested, the channels of the
+           normal and albedo guide AOVs by name */
+        const Struct *struct_ = bitmap->struct_();
+        int ch_color[3]  = { -1, -1, -1 },
+            ch_normal[3] = { -1, -1, -1 },
+            ch_albedo[3] = { -1, -1, -1 };
+
+        const char *suffix[3] = { ".X", ".Y", ".Z" };
+        for (size_t i = 0; i < struct_->field_count(); ++i) {
+            const std::string &name = (*struct_)[i].name;
+            for (int c = 0; c < 3; ++c) {
+                if (name == std::string(1, "RGB"[c]))
+                    ch_color[c] = (int) i;
+                if (!m_denoise_normal_channel.empty() &&
+                    name == m_denoise_normal_channel + suffix[c])
+                    ch_normal[c] = (int) i;
+                if (!m_denoise_albedo_channel.empty() &&
+                    name == m_denoise_albedo_channel + suffix[c])
+                    ch_albedo[c] = (int) i;
+            }
+        }
+
+        if (ch_color[0] < 0 || ch_color[1] < 0 || ch_color[2] < 0) {
+            Log(Warn, "denoise(): could not locate the \"R\", \"G\", \"B\" "
+                      "color channels (pixel_format=%s) -- skipping the "
+                      "denoising step.", m_pixel_format);
+            return;
+        }
+
+        bool have_normal = ch_normal[0] >= 0 && ch_normal[1] >= 0 && ch_normal[2] >= 0,
+             have_albedo = ch_albedo[0] >= 0 && ch_albedo[1] >= 0 && ch_albedo[2] >= 0;
+
+        if (!m_denoise_normal_channel.empty() && !have_normal)
+            Log(Warn, "denoise(): normal AOV \"%s\" not found among the film "
+                      "channels -- denoising without a normal buffer.",
+                m_denoise_normal_channel);
+        if (!m_denoise_albedo_channel.empty() && !have_albedo)
+            Log(Warn, "denoise(): albedo AOV \"%s\" not found among the film "
+                      "channels -- denoising without an albedo buffer.",
+                m_denoise_albedo_channel);
+
+        if (have_normal && !have_albedo) {
+            // Open Image Denoise only accepts a normal buffer alongside an albedo buffer
+            Log(Warn, "denoise(): the normal guide buffer requires an albedo "
+                      "buffer as well (see \"denoise_albedo_channel\") -- "
+                      "denoising without a normal buffer.");
+            have_normal = false;
+        }
+
+        Log(Info, "\U00002714  Denoising image ..");
+
+        /* De-interleave the relevant channels into packed RGB buffers */
+        float *data = (float *) bitmap->uint8_data();
+        std::vector<float> color(pixel_count * 3), output(pixel_count * 3),
+                           normal, albedo;
+        if (have_normal)
+            normal.resize(pixel_count * 3);
+        if (have_albedo)
+            albedo.resize(pixel_count * 3);
+
+        for (size_t i = 0; i < pixel_count; ++i) {
+            for (int c = 0; c < 3; ++c) {
+                color[3 * i + c] = data[i * ch_count + ch_color[c]];
+                if (have_normal)
+                    normal[3 * i + c] = data[i * ch_count + ch_normal[c]];
+                if (have_albedo)
+                    albedo[3 * i + c] = data[i * ch_count + ch_albedo[c]];
+            }
+        }
+
+        oidn::DeviceRef device = oidn::newDevice();
+        device.commit();
+
+        oidn::FilterRef filter = device.newFilter("RT");
+        filter.setImage("color", color.data(), oidn::Format::Float3, width, height);
+        if (have_albedo)
+            filter.setImage("albedo", albedo.data(), oidn::Format::Float3, width, height);
+        if (have_normal)
+            filter.setImage("normal", normal.data(), oidn::Format::Float3, width, height);
+        filter.setImage("output", output.data(), oidn::Format::Float3, width, height);
+        filter.set("hdr", true);
+        filter.commit();
+        filter.execute();
+
+        const char *error_message = nullptr;
+        if (device.getError(error_message) != oidn::Error::None) {
+            Log(Warn, "denoise(): Open Image Denoise reported an error: %s "
+                      "-- keeping the noisy image.", error_message);
+            return;
+        }
+
+        for (size_t i = 0; i < pixel_count; ++i)
+            for (int c = 0; c < 3; ++c)
+                data[i * ch_count + ch_color[c]] = output[3 * i + c];
+    }
+#endif
+
     void develop() override {
+        if (m_sample_stream) {
+            flush_sample_stream();
+            // Finalizes the compressed stream and closes the file
+            m_sample_stream = nullptr;
+        }
+
         if (m_dest_file.empty())
             Throw("Destination file not specified, cannot develop.");
 
+        if (m_tiled) {
+            // The image was already written incrementally; just finalize it
+            Assert(m_writer != nullptr);
+            Log(Info, "\U00002714  Finalizing tiled image ..");
+            m_writer->close();
+            return;
+        }
+
         fs::path filename = m_dest_file;
         std::string proper_extension;
         if (m_file_format == Bitmap::FileFormat::OpenEXR)
@@ -335,7 +997,30 @@ public:
 
         Log(Info, "\U00002714  Developing \"%s\" ..", filename.string());
 
-        bitmap()->write(filename, m_file_format);
+        ref<Bitmap> image = bitmap();
+        run_post_process(image);
+
+        if (m_asynchronous) {
+            /* Compress and write on a background task so that e.g. the next
+               frame of a sequence can start rendering right away. The
+               converted image is referenced by the task, hence the film
+               storage may be cleared and reused in the meantime; the
+               destructor waits for all outstanding tasks, hence capturing
+               'this' is safe. */
+            m_write_tasks.run(
+                [this, image, filename]() {
+                    try {
+                        image->write(filename, m_file_format,
+                                     m_compression_level, m_compression);
+                    } catch (const std::exception &e) {
+                        Log(Warn, "Asynchronous write of \"%s\" failed: %s",
+                            filename.string(), e.what());
+                    }
+                });
+        } else {
+            image->write(filename, m_file_format, m_compression_level,
+                         m_compression);
+        }
     }
 
     bool destination_exists(const fs::path &base_name) const override {
@@ -367,19 +1052,70 @@ public:
             << "  file_format = " << m_file_format << "," << std::endl
             << "  pixel_format = " << m_pixel_format << "," << std::endl
             << "  component_format = " << m_component_format << "," << std::endl
+            << "  compression = " << m_compression << "," << std::endl
+            << "  asynchronous = " << m_asynchronous << "," << std::endl
+            << "  tiled = " << m_tiled << "," << std::endl
+            << "  planar = " << m_planar << "," << std::endl
+            << "  denoise = " << m_denoise << "," << std::endl
+            << "  sample_stream = \"" << m_sample_stream_path << "\"," << std::endl
             << "  dest_file = \"" << m_dest_file << "\"" << std::endl
             << "]";
         return oss.str();
     }
 
     MTS_DECLARE_CLASS()
+protected:
+    /// Wait for any outstanding asynchronous writes (see \ref develop())
+    ~HDRFilm() {
+        m_write_tasks.wait();
+        if (m_sample_stream) {
+            flush_sample_stream();
+            m_sample_stream = nullptr;
+        }
+    }
+
 protected:
     Bitmap::FileFormat m_file_format;
     Bitmap::PixelFormat m_pixel_format;
     Struct::Type m_component_format;
+    Bitmap::Compression m_compression;
+    int m_compression_level;
+    bool m_asynchronous;
     fs::path m_dest_file;
+    bool m_half_aov_storage;
+    /// Accumulate each film channel in a separate contiguous plane?
+    bool m_planar;
+    bool m_tiled;
+    uint32_t m_tile_size;
+    bool m_denoise;
+    std::string m_denoise_normal_channel;
+    std::string m_denoise_albedo_channel;
     ref<ImageBlock> m_storage;
+    /// Film-sized buffer for atomically splatted samples (see \ref put_splat())
+    ref<ImageBlock> m_splat_storage;
+    ScalarFloat m_splat_scale = 1.f;
+    ref<TiledBitmapWriter> m_writer;
     std::vector<std::string> m_channels;
+    /// Outstanding asynchronous write tasks (see \ref develop())
+    tbb::task_group m_write_tasks;
+
+    /// Number of mutex-protected buffers that collect sample records
+    static constexpr size_t SampleShardCount = 64;
+    /// Shard occupancy (in floats) that triggers a write to disk
+    static constexpr size_t SampleShardFlushSize = 256 * 1024;
+
+    /// Buffer collecting the sample records of (roughly) one worker thread
+    struct SampleShard {
+        tbb::spin_mutex mutex;
+        std::vector<ScalarFloat> data;
+    };
+
+    /// Optional raw per-sample output (see \ref put_sample())
+    fs::path m_sample_stream_path;
+    mutable ref<ZStream> m_sample_stream;
+    mutable std::unique_ptr<SampleShard[]> m_sample_shards;
+    /// Serializes compression and file output of flushed shards
+    mutable std::mutex m_sample_stream_mutex;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(HDRFilm, Film)
@@ -127,19 +127,58 @@ public:
 
         if (m_aov_names.empty())
             Log(Warn, "No AOVs were specified!");
+
+        /* Request only the interaction fields that the enabled AOVs (and
+           sub-integrators) actually consume; depth and position queries then
+           take the minimal intersection fast path */
+        m_hit_flags = +HitFlags::Minimal;
+        for (Type type : m_aov_types) {
+            switch (type) {
+                case Type::UV:
+                    m_hit_flags = m_hit_flags | HitFlags::UV;
+                    break;
+                case Type::GeometricNormal:
+                case Type::ShadingNormal:
+                    m_hit_flags = m_hit_flags | HitFlags::ShadingFrame;
+                    break;
+                case Type::IntegratorRGBA:
+                    m_hit_flags = m_hit_flags | HitFlags::All;
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    std::pair<Spectrum, Mask> sample(const Scene *scene,
+                                     Sampler * sampler,
+                                     const RayDifferential3f &ray,
+                                     Float *aovs,
+                                     Mask active) const override {
+        MTS_MASKED_FUNCTION(ProfilerPhase::SamplingIntegratorSample, active);
+
+        /* A single intersection serves both the AOV channels and the nested
+           integrators; \c m_hit_flags requests all interaction fields
+           whenever a nested integrator is present */
+        SurfaceInteraction3f si = scene->ray_intersect(ray, m_hit_flags, active);
+        return sample(scene, sampler, ray, si, aovs, active);
     }
 
     std::pair<Spectrum, Mask> sample(const Scene *scene,
                                      Sampler * sampler,
                                      const RayDifferential3f &ray,
+                                     const SurfaceInteraction3f &si_,
                                      Float *aovs,
                                      Mask active) const override {
         MTS_MASKED_FUNCTION(ProfilerPhase::SamplingIntegratorSample, active);
 
         std::pair<Spectrum, Mask> result { 0.f, false };
 
-        SurfaceInteraction3f si = scene->ray_intersect(ray, active);
-        active = si.is_valid();
+        /* The AOV channels of escaped rays are written as zeros; the nested
+           integrators still receive the unmodified record so that they can
+           detect the miss themselves (environment contribution, alpha) */
+        active = active && si_.is_valid();
+        SurfaceInteraction3f si(si_);
         si[!active] = zero<SurfaceInteraction3f>();
         size_t ctr = 0;
 
@@ -174,7 +213,8 @@ public:
 
                 case Type::IntegratorRGBA: {
                         std::pair<Spectrum, Mask> result_sub =
-                            m_integrators[ctr].first->sample(scene, sampler, ray, aovs, active);
+                            m_integrators[ctr].first->sample(scene, sampler, ray, si_,
+                                                             aovs, active);
                         aovs += m_integrators[ctr].second;
 
                         UnpolarizedSpectrum spec_u = depolarize(result_sub.first);
@@ -237,6 +277,7 @@ private:
     std::vector<Type> m_aov_types;
     std::vector<std::string> m_aov_names;
     std::vector<std::pair<ref<Base>, size_t>> m_integrators;
+    uint32_t m_hit_flags;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(AOVIntegrator, SamplingIntegrator)
@@ -0,0 +1,691 @@
+#include <enoki/stl.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/ray.h>
+#include <mitsuba/core/warp.h>
+#include <mitsuba/render/bsdf.h>
+#include <mitsuba/render/emitter.h>
+#include <mitsuba/render/film.h>
+#include <mitsuba/render/integrator.h>
+#include <mitsuba/render/records.h>
+#include <mitsuba/render/sensor.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _integrator-bdpt:
+
+Bidirectional path tracer (:monosp:`bdpt`)
+------------------------------------------
+
+.. pluginparameters::
+
+ * - max_depth
+   - |int|
+   - Specifies the longest path depth in the generated output image (where -1 corresponds to
+     :math:`\infty`). (Default: -1)
+ * - rr_depth
+   - |int|
+   - Specifies the minimum path depth, after which the implementation will start to use the
+     *russian roulette* path termination criterion. (Default: 5)
+
+This integrator implements a bidirectional path tracer: in addition to the
+usual random walk starting from the sensor, a second subpath is traced
+starting from a light source, and every pair of prefix/suffix vertices is
+connected into a complete transport path. The resulting family of sampling
+strategies is combined using multiple importance sampling, so each strategy
+mainly contributes where it excels. Scenes whose light sources are hard to
+reach from the camera side---interiors lit through small openings, lamps in
+enclosures, strong indirect illumination---converge dramatically faster than
+with the unidirectional :ref:`path tracer <integrator-path>`, which must
+stumble upon the light by chance.
+
+Strategies that connect a light subpath directly to the sensor produce
+contributions at arbitrary positions on the film rather than at the pixel
+currently being rendered. These samples bypass the per-thread image blocks
+and are instead splatted into a shared film-sized buffer using atomic
+additions (see \ref Film::put_splat()), which the film adds to the developed
+image scaled by the reciprocal sample count.
+
+Light subpath vertices are stored in the per-thread scratch arena that also
+backs the other block rendering modes, so path generation performs no
+per-path heap allocations.
+
+.. note:: This integrator is currently restricted to the scalar variants,
+   to scenes whose emitters are all area lights, and to sensors that
+   implement \ref Endpoint::sample_direction() (e.g. the
+   :ref:`perspective <sensor-perspective>` camera). It does not handle
+   participating media, and cannot be combined with adaptive sampling.
+
+ */
+
+template <typename Float, typename Spectrum>
+class BDPTIntegrator final : public MonteCarloIntegrator<Float, Spectrum> {
+public:
+    MTS_IMPORT_BASE(MonteCarloIntegrator, should_stop, m_max_depth, m_rr_depth, rr_prob,
+                    m_block_size, m_error_threshold, m_scratch)
+    MTS_IMPORT_TYPES(Scene, Sensor, Film, ImageBlock, Sampler, Emitter,
+                     EmitterPtr, BSDF, BSDFPtr)
+
+    /// How a path vertex was generated
+    enum class VertexType { Camera, Light, Surface };
+
+    /// A single vertex of a camera or light subpath
+    struct Vertex {
+        /// Interaction at the vertex (for endpoints: position/frame only)
+        SurfaceInteraction3f si;
+        /// Product of importance weights of all preceding sampling events
+        Spectrum throughput;
+        /// Emitter associated with the vertex, if any
+        const Emitter *emitter = nullptr;
+        /// Area-measure density of sampling this vertex along the subpath
+        Float pdf_fwd = 0.f;
+        /// Area-measure density of sampling it from the opposite direction
+        Float pdf_rev = 0.f;
+        VertexType type = VertexType::Surface;
+        /// Is the vertex's scattering distribution a Dirac delta function?
+        bool delta = false;
+
+        /// Endpoint densities are expressed w.r.t. the solid angle measure only
+        bool on_surface() const { return type != VertexType::Camera; }
+    };
+
+    /// Subpath storage backed by the per-thread scratch arena
+    using VertexVector = std::vector<Vertex, ScratchAllocator<Vertex>>;
+
+    BDPTIntegrator(const Properties &props) : Base(props) { }
+
+    bool render(Scene *scene, Sensor *sensor) override {
+        if constexpr (is_array_v<Float>) {
+            Throw("BDPTIntegrator is only implemented for the scalar "
+                  "variants!");
+        } else {
+            for (auto &emitter : scene->emitters()) {
+                if (!has_flag(emitter->flags(), EmitterFlags::Surface))
+                    Throw("BDPTIntegrator currently only supports area "
+                          "emitters!");
+            }
+
+            if (m_error_threshold > 0.f)
+                Throw("BDPTIntegrator cannot be combined with adaptive "
+                      "sampling: splatted light tracing contributions are "
+                      "normalized by a fixed per-pixel sample count.");
+
+            /* Light tracing contributions are splatted into a shared buffer
+               and scaled by the reciprocal sample count when the film is
+               developed */
+            sensor->film()->set_splat_scale(
+                rcp((ScalarFloat) sensor->sampler()->sample_count()));
+
+            return Base::render(scene, sensor);
+        }
+    }
+
+    void render_block(const Scene *scene, const Sensor *sensor,
+                      Sampler *sampler, ImageBlock *block, Float * /* aovs */,
+                      size_t sample_count_ = size_t(-1)) const override {
+        if constexpr (is_array_v<Float>) {
+            ENOKI_MARK_USED(scene);
+            ENOKI_MARK_USED(sensor);
+            ENOKI_MARK_USED(sampler);
+            ENOKI_MARK_USED(block);
+            ENOKI_MARK_USED(sample_count_);
+            Throw("BDPTIntegrator is only implemented for the scalar "
+                  "variants!");
+        } else {
+            block->clear();
+            uint32_t pixel_count  = (uint32_t)(m_block_size * m_block_size),
+                     sample_count = (uint32_t)(sample_count_ == (size_t) -1
+                                                   ? sampler->sample_count()
+                                                   : sample_count_);
+
+            ScalarFloat diff_scale_factor =
+                rsqrt((ScalarFloat) sampler->sample_count());
+
+            for (uint32_t i = 0; i < pixel_count && !should_stop(); ++i) {
+                ScalarPoint2u pos = enoki::morton_decode<ScalarPoint2u>(i);
+                if (any(pos >= block->size()))
+                    continue;
+
+                pos += block->offset();
+                sampler->set_pixel(pos);
+                for (uint32_t j = 0; j < sample_count && !should_stop(); ++j)
+                    render_sample(scene, sensor, sampler, block, pos,
+                                  diff_scale_factor);
+            }
+        }
+    }
+
+    std::string to_string() const override {
+        return tfm::format("BDPTIntegrator[\n"
+            "  max_depth = %i,\n"
+            "  rr_depth = %i\n"
+            "]", m_max_depth, m_rr_depth);
+    }
+
+    MTS_DECLARE_CLASS()
+
+protected:
+    void render_sample(const Scene *scene, const Sensor *sensor,
+                       Sampler *sampler, ImageBlock *block,
+                       const Vector2f &pos,
+                       ScalarFloat diff_scale_factor) const {
+        if constexpr (is_array_v<Float>) {
+            ENOKI_MARK_USED(scene);
+            ENOKI_MARK_USED(sensor);
+            ENOKI_MARK_USED(sampler);
+            ENOKI_MARK_USED(block);
+            ENOKI_MARK_USED(pos);
+            ENOKI_MARK_USED(diff_scale_factor);
+        } else {
+            ScopedPhase sp(ProfilerPhase::SamplingIntegratorSample);
+
+            ScratchArena &arena = m_scratch;
+            ScratchArena::Rewind arena_guard(arena);
+
+            // --------------- Sample a ray from the sensor ----------------
+
+            Vector2f position_sample = pos + sampler->next_2d();
+
+            Point2f aperture_sample(.5f);
+            if (sensor->needs_aperture_sample())
+                aperture_sample = sampler->next_2d();
+
+            Float time = sensor->shutter_open();
+            if (sensor->shutter_open_time() > 0.f)
+                time += sampler->next_1d() * sensor->shutter_open_time();
+
+            Float wavelength_sample = sampler->next_1d();
+
+            Vector2f adjusted_position =
+                (position_sample - sensor->film()->crop_offset()) /
+                sensor->film()->crop_size();
+
+            auto [ray, wav_weight] = sensor->sample_ray_differential(
+                time, wavelength_sample, adjusted_position, aperture_sample);
+            ray.scale_differential(diff_scale_factor);
+
+            // ----------------- Generate the two subpaths -----------------
+
+            VertexVector camera_vs{ ScratchAllocator<Vertex>(arena) },
+                         light_vs{ ScratchAllocator<Vertex>(arena) };
+
+            generate_camera_subpath(scene, sensor, sampler, ray, wav_weight,
+                                    camera_vs);
+            generate_light_subpath(scene, sampler, time, ray.wavelengths,
+                                   light_vs);
+
+            /* A subpath pair with s light and t camera vertices forms a path
+               with s + t - 1 segments; path.cpp's depth convention counts
+               these segments, with depth 1 denoting a directly visible
+               emitter */
+            int max_depth = m_max_depth == -1
+                ? std::numeric_limits<int>::max() : m_max_depth;
+
+            // -------------------- Connection strategies ------------------
+
+            Spectrum result(0.f);
+            for (int t = 2; t <= (int) camera_vs.size(); ++t) {
+                for (int s = 0; s <= (int) light_vs.size(); ++s) {
+                    if (s + t - 1 > max_depth)
+                        continue;
+                    result += connect(scene, sensor, arena,
+                                      light_vs, camera_vs, s, t);
+                }
+            }
+
+            bool valid_ray = camera_vs.size() > 1;
+            block->put(position_sample, ray.wavelengths, result,
+                       valid_ray ? Float(1.f) : Float(0.f));
+
+            /* Light tracing strategies (t == 1) land at arbitrary film
+               positions and are splatted into the film's shared buffer */
+            for (int s = 1; s <= (int) light_vs.size() && s <= max_depth; ++s)
+                connect_sensor(scene, sensor, arena, light_vs, camera_vs, s,
+                               sampler->next_2d(), wav_weight,
+                               ray.wavelengths);
+
+            sampler->advance();
+        }
+    }
+
+    /**
+     * \brief Trace the camera subpath, depositing one vertex per surface
+     * interaction (preceded by a vertex for the sensor itself)
+     */
+    void generate_camera_subpath(const Scene *scene, const Sensor *sensor,
+                                 Sampler *sampler,
+                                 const RayDifferential3f &ray,
+                                 const Spectrum &wav_weight,
+                                 VertexVector &verts) const {
+        if constexpr (!is_array_v<Float>) {
+            Vertex v;
+            v.type       = VertexType::Camera;
+            v.si.p       = ray.o;
+            v.si.sh_frame = Frame3f(ray.d);
+            v.si.time    = ray.time;
+            v.si.wavelengths = ray.wavelengths;
+            v.throughput = wav_weight;
+            v.pdf_fwd    = 1.f;
+            verts.push_back(v);
+
+            int max_verts = m_max_depth == -1
+                ? std::numeric_limits<int>::max() : m_max_depth + 1;
+
+            Float pdf_dir = sensor->pdf_ray(ray, Vector3f(0.f)).second;
+            random_walk(scene, sampler, ray, wav_weight, pdf_dir,
+                        TransportMode::Radiance, verts, max_verts);
+        }
+    }
+
+    /**
+     * \brief Sample an emission vertex and trace the light subpath
+     *
+     * The emitter is chosen uniformly at random; the same (uniform) origin
+     * density is assumed by the multiple importance sampling weights, which
+     * keeps the combination consistent even though next event estimation
+     * elsewhere uses importance-weighted emitter selection.
+     */
+    void generate_light_subpath(const Scene *scene, Sampler *sampler,
+                                Float time, const Wavelength &wavelengths,
+                                VertexVector &verts) const {
+        if constexpr (!is_array_v<Float>) {
+            auto &emitters = scene->emitters();
+            if (emitters.empty() || m_max_depth == 0)
+                return;
+
+            uint32_t n_emitters = (uint32_t) emitters.size(),
+                     index = min((uint32_t)(sampler->next_1d() * n_emitters),
+                                 n_emitters - 1);
+            Float pick_pdf = rcp((ScalarFloat) n_emitters);
+
+            const Emitter *emitter = emitters[index].get();
+            const Shape *shape = emitter->shape();
+
+            PositionSample3f ps =
+                shape->sample_position(time, sampler->next_2d());
+
+            /* The emitted radiance itself is not folded into the vertex
+               weight: it depends on the emission direction and is evaluated
+               per connection via Emitter::eval() */
+            Vertex v;
+            v.type       = VertexType::Light;
+            v.si         = SurfaceInteraction3f(ps, wavelengths);
+            v.si.shape   = shape;
+            v.emitter    = emitter;
+            v.throughput = Spectrum(rcp(pick_pdf * ps.pdf));
+            v.pdf_fwd    = pick_pdf * ps.pdf;
+            verts.push_back(v);
+
+            // Sample the emission direction (cosine-weighted, cf. area.cpp)
+            Vector3f local = warp::square_to_cosine_hemisphere(sampler->next_2d());
+            Float pdf_dir  = warp::square_to_cosine_hemisphere_pdf(local);
+            if (pdf_dir == 0.f)
+                return;
+
+            SurfaceInteraction3f si = verts[0].si;
+            si.wi = local;
+            Spectrum throughput = verts[0].throughput * emitter->eval(si) *
+                                  local.z() / pdf_dir;
+            if (none(neq(depolarize(throughput), 0.f)))
+                return;
+
+            int max_verts = m_max_depth == -1
+                ? std::numeric_limits<int>::max() : m_max_depth;
+
+            RayDifferential3f ray(si.spawn_ray(si.to_world(local)));
+            random_walk(scene, sampler, ray, throughput, pdf_dir,
+                        TransportMode::Importance, verts, max_verts);
+        }
+    }
+
+    /**
+     * \brief Extend a subpath by repeated BSDF sampling
+     *
+     * Each new vertex records the area-measure density of its generation;
+     * the reverse density of the preceding vertex (i.e. the density of
+     * generating it from the opposite direction) is filled in once the
+     * successor's BSDF sample is known.
+     */
+    void random_walk(const Scene *scene, Sampler *sampler,
+                     RayDifferential3f ray, Spectrum throughput,
+                     Float pdf_dir, TransportMode mode, VertexVector &verts,
+                     int max_verts) const {
+        if constexpr (!is_array_v<Float>) {
+            BSDFContext ctx(mode);
+            Float eta(1.f);
+
+            while ((int) verts.size() < max_verts) {
+                SurfaceInteraction3f si = scene->ray_intersect(ray, true);
+                if (!si.is_valid())
+                    break;
+
+                size_t prev_i = verts.size() - 1;
+                BSDFPtr bsdf = si.bsdf(ray);
+
+                Vertex v;
+                v.type       = VertexType::Surface;
+                v.si         = si;
+                v.throughput = throughput;
+                v.emitter    = si.shape->emitter();
+                v.pdf_fwd    = pdf_dir / sqr(si.t) *
+                               abs_dot(si.sh_frame.n, ray.d);
+                v.delta      = !has_flag(bsdf->flags(), BSDFFlags::Smooth);
+                verts.push_back(v);
+
+                int depth = (int) verts.size() - 1;
+                if (depth > m_rr_depth) {
+                    Float q = rr_prob(hmax(depolarize(throughput)) * sqr(eta));
+                    if (sampler->next_1d() >= q)
+                        break;
+                    throughput *= rcp(q);
+                    verts.back().throughput = throughput;
+                }
+
+                // Sample BSDF * cos(theta)
+                auto [bs, bsdf_val] = bsdf->sample(ctx, si, sampler->next_1d(),
+                                                   sampler->next_2d(), true);
+                bsdf_val = si.to_world_mueller(bsdf_val, -bs.wo, si.wi);
+
+                throughput = throughput * bsdf_val;
+                if (none(neq(depolarize(throughput), 0.f)))
+                    break;
+
+                eta *= bs.eta;
+
+                /* Reverse density of the previous vertex: probability of the
+                   BSDF sampling the direction back towards it, given an
+                   incident direction along the newly sampled segment */
+                SurfaceInteraction3f si_rev = si;
+                si_rev.wi = bs.wo;
+                Float pdf_rev = bsdf->pdf(ctx, si_rev, si.wi, true) / sqr(si.t);
+                Vertex &prev = verts[prev_i];
+                if (prev.on_surface())
+                    pdf_rev *= abs_dot(prev.si.sh_frame.n, ray.d);
+                prev.pdf_rev = pdf_rev;
+
+                pdf_dir = bs.pdf;
+                ray = RayDifferential3f(si.spawn_ray(si.to_world(bs.wo)));
+            }
+        }
+    }
+
+    /**
+     * \brief Evaluate the contribution of the connection strategy with
+     * \c s light and \c t camera vertices (t >= 2), weighted by MIS
+     */
+    Spectrum connect(const Scene *scene, const Sensor *sensor,
+                     ScratchArena &arena, const VertexVector &light_vs,
+                     const VertexVector &camera_vs, int s, int t) const {
+        if constexpr (is_array_v<Float>) {
+            return 0.f;
+        } else {
+            const Vertex &pt = camera_vs[t - 1];
+            Spectrum value(0.f);
+
+            if (s == 0) {
+                // The camera subpath found an emitter on its own
+                if (pt.emitter == nullptr)
+                    return 0.f;
+                value = pt.throughput * pt.emitter->eval(pt.si);
+            } else {
+                const Vertex &qs = light_vs[s - 1];
+                if (qs.delta || pt.delta)
+                    return 0.f;
+
+                Vector3f d  = pt.si.p - qs.si.p;
+                Float dist2 = squared_norm(d);
+                if (dist2 == 0.f)
+                    return 0.f;
+                Float dist = sqrt(dist2);
+                d /= dist;
+
+                /* Scattering values at both connection endpoints; each one
+                   includes the cosine on its side, leaving 1 / dist^2 of the
+                   geometric term */
+                Spectrum f_light;
+                if (s == 1) {
+                    SurfaceInteraction3f si = qs.si;
+                    si.wi = si.to_local(d);
+                    f_light = qs.emitter->eval(si) * Frame3f::cos_theta(si.wi);
+                } else {
+                    BSDFContext ctx(TransportMode::Importance);
+                    Vector3f wo = qs.si.to_local(d);
+                    f_light = qs.si.bsdf()->eval(ctx, qs.si, wo, true);
+                    f_light = qs.si.to_world_mueller(f_light, -wo, qs.si.wi);
+                }
+
+                BSDFContext ctx;
+                Vector3f wo = pt.si.to_local(-d);
+                Spectrum f_camera = pt.si.bsdf()->eval(ctx, pt.si, wo, true);
+                f_camera = pt.si.to_world_mueller(f_camera, -wo, pt.si.wi);
+
+                value = qs.throughput * f_light * f_camera * pt.throughput
+                        / dist2;
+                if (none(neq(depolarize(value), 0.f)))
+                    return 0.f;
+
+                // Visibility test along the connection segment
+                Ray3f shadow_ray = qs.si.spawn_ray(d);
+                shadow_ray.maxt = dist * (1.f - math::ShadowEpsilon<Float>);
+                if (scene->ray_test(shadow_ray))
+                    return 0.f;
+            }
+
+            if (none(neq(depolarize(value), 0.f)))
+                return 0.f;
+
+            return value * mis_weight(scene, sensor, arena,
+                                      light_vs.data(), s,
+                                      camera_vs.data(), t);
+        }
+    }
+
+    /**
+     * \brief Evaluate the light tracing strategy (t == 1): connect a light
+     * subpath vertex directly to the sensor and splat the MIS-weighted
+     * contribution into the film
+     */
+    void connect_sensor(const Scene *scene, const Sensor *sensor,
+                        ScratchArena &arena, const VertexVector &light_vs,
+                        const VertexVector & /* camera_vs */, int s,
+                        const Point2f &sample, const Spectrum &wav_weight,
+                        const Wavelength &wavelengths) const {
+        if constexpr (!is_array_v<Float>) {
+            const Vertex &qs = light_vs[s - 1];
+            if (qs.delta)
+                return;
+
+            auto [ds, importance] = sensor->sample_direction(qs.si, sample);
+            if (ds.pdf == 0.f || none(neq(depolarize(importance), 0.f)))
+                return;
+
+            Spectrum f_light;
+            if (s == 1) {
+                SurfaceInteraction3f si = qs.si;
+                si.wi = si.to_local(ds.d);
+                f_light = qs.emitter->eval(si) * Frame3f::cos_theta(si.wi);
+            } else {
+                BSDFContext ctx(TransportMode::Importance);
+                Vector3f wo = qs.si.to_local(ds.d);
+                f_light = qs.si.bsdf()->eval(ctx, qs.si, wo, true);
+                f_light = qs.si.to_world_mueller(f_light, -wo, qs.si.wi);
+            }
+
+            Spectrum value = qs.throughput * f_light * importance * wav_weight;
+            if (none(neq(depolarize(value), 0.f)))
+                return;
+
+            Ray3f shadow_ray = qs.si.spawn_ray(ds.d);
+            shadow_ray.maxt = ds.dist * (1.f - math::ShadowEpsilon<Float>);
+            if (scene->ray_test(shadow_ray))
+                return;
+
+            // Temporary camera vertex standing in for the sampled endpoint
+            Vertex cam;
+            cam.type        = VertexType::Camera;
+            cam.si.p        = ds.p;
+            cam.si.sh_frame = Frame3f(ds.n);
+            cam.si.time     = ds.time;
+            cam.si.wavelengths = wavelengths;
+            cam.pdf_fwd     = 1.f;
+
+            Float weight = mis_weight(scene, sensor, arena,
+                                      light_vs.data(), s, &cam, 1);
+
+            sensor->film()->put_splat(ds.uv, wavelengths, value * weight);
+        }
+    }
+
+    // =============================================================
+    //! @{ \name Multiple importance sampling
+    // =============================================================
+
+    /**
+     * \brief Area-measure density of \c cur generating \c next, where \c
+     * prev (if any) determines the incident direction at \c cur
+     */
+    Float pdf_area(const Sensor *sensor, const Vertex *prev,
+                   const Vertex &cur, const Vertex &next) const {
+        if constexpr (is_array_v<Float>) {
+            return 0.f;
+        } else {
+            Vector3f d  = next.si.p - cur.si.p;
+            Float dist2 = squared_norm(d);
+            if (dist2 == 0.f)
+                return 0.f;
+            d *= rsqrt(dist2);
+
+            Float pdf_dir;
+            switch (cur.type) {
+                case VertexType::Camera:
+                    pdf_dir = sensor->pdf_ray(
+                        Ray3f(cur.si.p, d, cur.si.time, cur.si.wavelengths),
+                        cur.si.sh_frame.n).second;
+                    break;
+
+                case VertexType::Light:
+                    pdf_dir = cur.emitter->pdf_ray(
+                        Ray3f(cur.si.p, d, cur.si.time, cur.si.wavelengths),
+                        cur.si.sh_frame.n).second;
+                    break;
+
+                default: {
+                    SurfaceInteraction3f si = cur.si;
+                    if (prev)
+                        si.wi = si.to_local(normalize(prev->si.p - cur.si.p));
+                    pdf_dir = si.bsdf()->pdf(BSDFContext(), si,
+                                             si.to_local(d), true);
+                    break;
+                }
+            }
+
+            Float pdf = pdf_dir / dist2;
+            if (next.on_surface())
+                pdf *= abs_dot(next.si.sh_frame.n, d);
+            return pdf;
+        }
+    }
+
+    /// Area-measure density of starting a light subpath at vertex \c v
+    Float pdf_light_origin(const Scene *scene, const Vertex &v) const {
+        if constexpr (is_array_v<Float>) {
+            return 0.f;
+        } else {
+            const Emitter *emitter = v.emitter;
+            if (emitter == nullptr)
+                return 0.f;
+
+            Float pick_pdf = rcp((ScalarFloat) scene->emitters().size());
+            Float pdf_pos = emitter->pdf_ray(
+                Ray3f(v.si.p, v.si.sh_frame.n, v.si.time, v.si.wavelengths),
+                v.si.sh_frame.n).first;
+            return pick_pdf * pdf_pos;
+        }
+    }
+
+    /**
+     * \brief Power-heuristic MIS weight of the strategy with \c s light and
+     * \c t camera vertices, among all strategies that can generate the same
+     * path
+     *
+     * Follows the classic formulation: the densities of the alternative
+     * strategies are expressed as products of forward/reverse vertex density
+     * ratios along the path, with the entries adjacent to the connection
+     * edge re-evaluated for the opposite transport direction.
+     */
+    Float mis_weight(const Scene *scene, const Sensor *sensor,
+                     ScratchArena &arena, const Vertex *lv, int s,
+                     const Vertex *cv, int t) const {
+        if constexpr (is_array_v<Float>) {
+            return 0.f;
+        } else {
+            struct Entry { Float fwd, rev; bool delta; };
+            using EntryVector = std::vector<Entry, ScratchAllocator<Entry>>;
+            ScratchArena::Rewind arena_guard(arena);
+
+            EntryVector le{ ScratchAllocator<Entry>(arena) },
+                        ce{ ScratchAllocator<Entry>(arena) };
+            le.reserve(s);
+            ce.reserve(t);
+            for (int i = 0; i < s; ++i)
+                le.push_back({ lv[i].pdf_fwd, lv[i].pdf_rev, lv[i].delta });
+            for (int i = 0; i < t; ++i)
+                ce.push_back({ cv[i].pdf_fwd, cv[i].pdf_rev, cv[i].delta });
+
+            /* Re-evaluate the reverse densities of the (up to) four vertices
+               adjacent to the connection edge */
+            const Vertex &pt = cv[t - 1];
+            const Vertex *pt_minus = t > 1 ? &cv[t - 2] : nullptr;
+            const Vertex *qs       = s > 0 ? &lv[s - 1] : nullptr;
+            const Vertex *qs_minus = s > 1 ? &lv[s - 2] : nullptr;
+
+            ce[t - 1].rev = s > 0
+                ? pdf_area(sensor, qs_minus, *qs, pt)
+                : pdf_light_origin(scene, pt);
+            if (t > 1)
+                ce[t - 2].rev = s > 0
+                    ? pdf_area(sensor, qs, pt, *pt_minus)
+                    : pdf_area(sensor, nullptr,
+                               /* treat the emitter hit as a light vertex */
+                               light_proxy(pt), *pt_minus);
+            if (s > 0)
+                le[s - 1].rev = pdf_area(sensor, pt_minus, pt, *qs);
+            if (s > 1)
+                le[s - 2].rev = pdf_area(sensor, &pt, *qs, *qs_minus);
+
+            auto remap0 = [](Float f) { return f != 0.f ? f : 1.f; };
+
+            Float sum = 0.f, ri = 1.f;
+            for (int i = t - 1; i > 0; --i) {
+                ri *= remap0(ce[i].rev) / remap0(ce[i].fwd);
+                if (!ce[i].delta && !ce[i - 1].delta)
+                    sum += sqr(ri);
+            }
+
+            ri = 1.f;
+            for (int i = s - 1; i >= 0; --i) {
+                ri *= remap0(le[i].rev) / remap0(le[i].fwd);
+                bool prev_delta = i > 0 ? le[i - 1].delta : false;
+                if (!le[i].delta && !prev_delta)
+                    sum += sqr(ri);
+            }
+
+            return 1.f / (1.f + sum);
+        }
+    }
+
+    /// Reinterpret an emitter hit of the camera subpath as a light vertex
+    static Vertex light_proxy(const Vertex &v) {
+        Vertex proxy = v;
+        proxy.type = VertexType::Light;
+        return proxy;
+    }
+
+    //! @}
+    // =============================================================
+};
+
+MTS_IMPLEMENT_CLASS_VARIANT(BDPTIntegrator, MonteCarloIntegrator)
+MTS_EXPORT_PLUGIN(BDPTIntegrator, "Bidirectional Path Tracer integrator");
+NAMESPACE_END(mitsuba)
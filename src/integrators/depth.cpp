@@ -23,7 +23,10 @@ public:
                                      Mask active) const override {
         MTS_MASKED_FUNCTION(ProfilerPhase::SamplingIntegratorSample, active);
 
-        SurfaceInteraction3f si = scene->ray_intersect(ray, active);
+        /* Only the hit distance is needed -- skip the surface
+           parameterization via a minimal intersection query */
+        SurfaceInteraction3f si =
+            scene->ray_intersect(ray, +HitFlags::Minimal, active);
 
         return {
             select(si.is_valid(), si.t, 0.f),
@@ -29,6 +29,18 @@ Direct illumination integrator (:monosp:`direct`)
    - Optional more fine-grained parameter: specifies the number of samples that should be generated
      using the BSDF sampling strategies implemented by the scene's surfaces.
      (Default: set to the value of :monosp:`shading_samples`)
+ * - ris_samples
+   - |int|
+   - If set to a nonzero value, the emitter sampling strategy is replaced by
+     *resampled importance sampling*: the given number of candidate emitter
+     samples is generated without shadow rays, a single candidate is kept with
+     probability proportional to its unoccluded contribution, and only this
+     survivor is tested for visibility. (Default: 0, i.e. disabled)
+ * - ris_reuse
+   - |bool|
+   - When resampling is enabled, carry the reservoir of the previously shaded
+     point over to the next one, which amortizes candidate generation across
+     neighboring pixels. (Default: |true|)
  * - hide_emitters
    - |bool|
    - Hide directly visible emitters.
@@ -61,6 +73,21 @@ The number of samples spent on either technique is configurable, hence
 it is also possible to turn this plugin into an emitter sampling-only
 or BSDF sampling-only integrator.
 
+When :monosp:`ris_samples` is nonzero, the fixed-count emitter sampling loop
+is replaced by weighted reservoir sampling over that many candidates: each
+candidate is weighted by its *unoccluded* contribution (emitted radiance times
+BSDF value over the source density), so the surviving candidate is distributed
+approximately proportional to the integrand and a single shadow ray per
+shading point suffices. With :monosp:`ris_reuse`, unoccluded reservoirs are
+additionally carried over from the previously shaded point -- a spatial
+neighbor thanks to the Morton traversal order within each image block -- which
+makes the effective candidate count grow well beyond :monosp:`ris_samples` in
+many-light scenes. Reuse re-evaluates the carried candidate's target value at
+the receiving point, but (as in other ReSTIR-style estimators) slight bias can
+remain near geometric discontinuities where visibility changes between
+neighbors. The resampling mode is implemented for the scalar variants;
+vectorized variants fall back to standard emitter sampling.
+
 .. note:: This integrator does not handle participating media or indirect illumination.
 
  */
@@ -95,6 +122,24 @@ public:
         if (m_emitter_samples + m_bsdf_samples == 0)
             Throw("Must have at least 1 BSDF or emitter sample!");
 
+        /* Number of unshadowed emitter candidates to resample per shading
+           point (0 = use the classic fixed-count emitter sampling loop) */
+        m_ris_samples = props.size_("ris_samples", 0);
+
+        /// Carry reservoirs over between neighboring shading points?
+        m_ris_reuse = props.bool_("ris_reuse", true);
+
+        if (m_ris_samples > 0) {
+            /* Resampling condenses all candidates into a single
+               emitter-strategy sample */
+            m_emitter_samples = 1;
+
+            if constexpr (is_array_v<Float>)
+                Log(Warn, "The 'ris_samples' parameter is only supported by "
+                          "the scalar variants -- falling back to standard "
+                          "emitter sampling.");
+        }
+
         size_t sum    = m_emitter_samples + m_bsdf_samples;
         m_weight_bsdf = 1.f / (ScalarFloat) m_bsdf_samples;
         m_weight_lum  = 1.f / (ScalarFloat) m_emitter_samples;
@@ -109,96 +154,343 @@ public:
                                      Mask active) const override {
         MTS_MASKED_FUNCTION(ProfilerPhase::SamplingIntegratorSample, active);
 
-        SurfaceInteraction3f si = scene->ray_intersect(ray, active);
-        Mask valid_ray = si.is_valid();
+        if constexpr (!is_array_v<Float>) {
+            /* Scalar specialization: replaces the mask/select plumbing of
+               the generic implementation below (which is pure overhead for
+               a single sample) with ordinary early-exit branches */
+            if (!active)
+                return { Spectrum(0.f), false };
 
-        Spectrum result(0.f);
+            SurfaceInteraction3f si = scene->ray_intersect(ray, true);
+            bool valid_ray = si.is_valid();
 
-        // ----------------------- Visible emitters -----------------------
+            Spectrum result(0.f);
 
-        EmitterPtr emitter_vis = si.emitter(scene, active);
-        if (any_or<true>(neq(emitter_vis, nullptr)))
-            result += emitter_vis->eval(si, active);
+            // ----------------------- Visible emitters -----------------------
 
-        active &= si.is_valid();
-        if (none_or<false>(active))
-            return { result, valid_ray };
+            EmitterPtr emitter_vis = si.emitter(scene);
+            if (emitter_vis != nullptr)
+                result += emitter_vis->eval(si, true);
 
-        // ----------------------- Emitter sampling -----------------------
+            if (!si.is_valid())
+                return { result, valid_ray };
 
-        BSDFContext ctx;
-        BSDFPtr bsdf = si.bsdf(ray);
-        Mask sample_emitter = active && has_flag(bsdf->flags(), BSDFFlags::Smooth);
+            // ----------------------- Emitter sampling -----------------------
 
-        if (any_or<true>(sample_emitter)) {
-            for (size_t i = 0; i < m_emitter_samples; ++i) {
-                Mask active_e = sample_emitter;
-                DirectionSample3f ds;
-                Spectrum emitter_val;
-                std::tie(ds, emitter_val) = scene->sample_emitter_direction(
-                    si, sampler->next_2d(active_e), true, active_e);
-                active_e &= neq(ds.pdf, 0.f);
+            BSDFContext ctx;
+            BSDFPtr bsdf = si.bsdf(ray);
 
-                // Query the BSDF for that emitter-sampled direction
-                Vector3f wo = si.to_local(ds.d);
+            if (has_flag(bsdf->flags(), BSDFFlags::Smooth)) {
+                if (m_ris_samples > 0) {
+                    result += sample_emitter_ris(scene, sampler, si, bsdf, ctx);
+                } else {
+                    for (size_t i = 0; i < m_emitter_samples; ++i) {
+                        auto [ds, emitter_val] = scene->sample_emitter_direction(
+                            si, sampler->next_2d(), true, true);
+                        if (ds.pdf == 0.f)
+                            continue;
 
-                Spectrum bsdf_val = bsdf->eval(ctx, si, wo, active_e);
-                bsdf_val = si.to_world_mueller(bsdf_val, -wo, si.wi);
+                        // Query the BSDF for that emitter-sampled direction
+                        Vector3f wo = si.to_local(ds.d);
 
-                /* Determine probability of having sampled that same
-                   direction using BSDF sampling. */
-                Float bsdf_pdf = bsdf->pdf(ctx, si, wo, active_e);
+                        Spectrum bsdf_val = bsdf->eval(ctx, si, wo, true);
+                        bsdf_val = si.to_world_mueller(bsdf_val, -wo, si.wi);
+
+                        /* Determine probability of having sampled that same
+                           direction using BSDF sampling. */
+                        Float bsdf_pdf = bsdf->pdf(ctx, si, wo, true);
 
-                Float mis = select(ds.delta, Float(1.f), mis_weight(
-                    ds.pdf * m_frac_lum, bsdf_pdf * m_frac_bsdf) * m_weight_lum);
-                result[active_e] += mis * bsdf_val * emitter_val;
+                        Float mis = ds.delta
+                            ? 1.f
+                            : mis_weight(ds.pdf * m_frac_lum,
+                                         bsdf_pdf * m_frac_bsdf) * m_weight_lum;
+                        result += mis * bsdf_val * emitter_val;
+                    }
+                }
             }
-        }
 
-        // ------------------------ BSDF sampling -------------------------
+            // ------------------------ BSDF sampling -------------------------
 
-        for (size_t i = 0; i < m_bsdf_samples; ++i) {
-            auto [bs, bsdf_val] = bsdf->sample(ctx, si, sampler->next_1d(active),
-                                               sampler->next_2d(active), active);
-            bsdf_val = si.to_world_mueller(bsdf_val, -bs.wo, si.wi);
+            for (size_t i = 0; i < m_bsdf_samples; ++i) {
+                MTS_STAT_ADD(BSDFSamples, 1);
+                auto [bs, bsdf_val] = bsdf->sample(ctx, si, sampler->next_1d(),
+                                                   sampler->next_2d(), true);
+                bsdf_val = si.to_world_mueller(bsdf_val, -bs.wo, si.wi);
 
-            Mask active_b = active && any(neq(depolarize(bsdf_val), 0.f));
+                if (none(neq(depolarize(bsdf_val), 0.f)))
+                    continue;
 
-            // Trace the ray in the sampled direction and intersect against the scene
-            SurfaceInteraction si_bsdf =
-                scene->ray_intersect(si.spawn_ray(si.to_world(bs.wo)), active_b);
+                // Trace the ray in the sampled direction and intersect against the scene
+                SurfaceInteraction si_bsdf =
+                    scene->ray_intersect(si.spawn_ray(si.to_world(bs.wo)), true);
 
-            // Retain only rays that hit an emitter
-            EmitterPtr emitter = si_bsdf.emitter(scene, active_b);
-            active_b &= neq(emitter, nullptr);
+                // Retain only rays that hit an emitter
+                EmitterPtr emitter = si_bsdf.emitter(scene);
+                if (emitter == nullptr)
+                    continue;
 
-            if (any_or<true>(active_b)) {
-                Spectrum emitter_val = emitter->eval(si_bsdf, active_b);
-                Mask delta = has_flag(bs.sampled_type, BSDFFlags::Delta);
+                Spectrum emitter_val = emitter->eval(si_bsdf, true);
 
                 /* Determine probability of having sampled that same
                    direction using Emitter sampling. */
                 DirectionSample3f ds(si_bsdf, si);
                 ds.object = emitter;
 
-                Float emitter_pdf =
-                    select(delta, 0.f, scene->pdf_emitter_direction(si, ds, active_b));
+                Float emitter_pdf = has_flag(bs.sampled_type, BSDFFlags::Delta)
+                    ? 0.f
+                    : scene->pdf_emitter_direction(si, ds);
+
+                result += bsdf_val * emitter_val *
+                          mis_weight(bs.pdf * m_frac_bsdf, emitter_pdf * m_frac_lum) *
+                          m_weight_bsdf;
+            }
+
+            return { result, valid_ray };
+        } else {
+
+            SurfaceInteraction3f si = scene->ray_intersect(ray, active);
+            Mask valid_ray = si.is_valid();
+
+            Spectrum result(0.f);
+
+            // ----------------------- Visible emitters -----------------------
+
+            EmitterPtr emitter_vis = si.emitter(scene, active);
+            if (any_or<true>(neq(emitter_vis, nullptr)))
+                result += emitter_vis->eval(si, active);
+
+            active &= si.is_valid();
+            if (none_or<false>(active))
+                return { result, valid_ray };
+
+            // ----------------------- Emitter sampling -----------------------
+
+            BSDFContext ctx;
+            BSDFPtr bsdf = si.bsdf(ray);
+            Mask sample_emitter = active && has_flag(bsdf->flags(), BSDFFlags::Smooth);
+
+            if (any_or<true>(sample_emitter)) {
+                for (size_t i = 0; i < m_emitter_samples; ++i) {
+                    Mask active_e = sample_emitter;
+                    DirectionSample3f ds;
+                    Spectrum emitter_val;
+                    std::tie(ds, emitter_val) = scene->sample_emitter_direction(
+                        si, sampler->next_2d(active_e), true, active_e);
+                    active_e &= neq(ds.pdf, 0.f);
+
+                    // Query the BSDF for that emitter-sampled direction
+                    Vector3f wo = si.to_local(ds.d);
+
+                    Spectrum bsdf_val = bsdf->eval(ctx, si, wo, active_e);
+                    bsdf_val = si.to_world_mueller(bsdf_val, -wo, si.wi);
 
-                result[active_b] +=
-                    bsdf_val * emitter_val *
-                    mis_weight(bs.pdf * m_frac_bsdf, emitter_pdf * m_frac_lum) *
-                    m_weight_bsdf;
+                    /* Determine probability of having sampled that same
+                       direction using BSDF sampling. */
+                    Float bsdf_pdf = bsdf->pdf(ctx, si, wo, active_e);
+
+                    Float mis = select(ds.delta, Float(1.f), mis_weight(
+                        ds.pdf * m_frac_lum, bsdf_pdf * m_frac_bsdf) * m_weight_lum);
+                    result[active_e] += mis * bsdf_val * emitter_val;
+                }
+            }
+
+            // ------------------------ BSDF sampling -------------------------
+
+            for (size_t i = 0; i < m_bsdf_samples; ++i) {
+                MTS_STAT_ADD(BSDFSamples, count(active));
+                auto [bs, bsdf_val] = bsdf->sample(ctx, si, sampler->next_1d(active),
+                                                   sampler->next_2d(active), active);
+                bsdf_val = si.to_world_mueller(bsdf_val, -bs.wo, si.wi);
+
+                Mask active_b = active && any(neq(depolarize(bsdf_val), 0.f));
+
+                // Trace the ray in the sampled direction and intersect against the scene
+                SurfaceInteraction si_bsdf =
+                    scene->ray_intersect(si.spawn_ray(si.to_world(bs.wo)), active_b);
+
+                // Retain only rays that hit an emitter
+                EmitterPtr emitter = si_bsdf.emitter(scene, active_b);
+                active_b &= neq(emitter, nullptr);
+
+                if (any_or<true>(active_b)) {
+                    Spectrum emitter_val = emitter->eval(si_bsdf, active_b);
+                    Mask delta = has_flag(bs.sampled_type, BSDFFlags::Delta);
+
+                    /* Determine probability of having sampled that same
+                       direction using Emitter sampling. */
+                    DirectionSample3f ds(si_bsdf, si);
+                    ds.object = emitter;
+
+                    Float emitter_pdf =
+                        select(delta, 0.f, scene->pdf_emitter_direction(si, ds, active_b));
+
+                    result[active_b] +=
+                        bsdf_val * emitter_val *
+                        mis_weight(bs.pdf * m_frac_bsdf, emitter_pdf * m_frac_lum) *
+                        m_weight_bsdf;
+                }
             }
+
+            return { result, valid_ray };
+
         }
+    }
+
+    /**
+     * \brief Resampled importance sampling replacement for the emitter
+     * sampling loop (scalar variants only)
+     *
+     * Streams \c ris_samples unshadowed emitter candidates through a weighted
+     * reservoir whose target function is the unoccluded contribution, then
+     * traces a single shadow ray for the surviving candidate. When reuse is
+     * enabled, the reservoir of the previously shaded point participates as
+     * an additional candidate stream after re-evaluating its target value at
+     * the current point.
+     */
+    Spectrum sample_emitter_ris(const Scene *scene, Sampler *sampler,
+                                const SurfaceInteraction3f &si,
+                                const BSDFPtr &bsdf,
+                                const BSDFContext &ctx) const {
+        if constexpr (!is_array_v<Float>) {
+            auto lum = [&](const Spectrum &value) -> Float {
+                UnpolarizedSpectrum value_u = depolarize(value);
+                if constexpr (is_monochromatic_v<Spectrum>)
+                    return value_u.x();
+                else if constexpr (is_rgb_v<Spectrum>)
+                    return luminance(value_u);
+                else
+                    return luminance(value_u, si.wavelengths);
+            };
+
+            /* Reservoir state: surviving candidate, its target value, the
+               running sum of resampling weights and the effective number of
+               candidates seen so far */
+            DirectionSample3f r_ds;
+            Spectrum r_radiance(0.f), r_bsdf_val(0.f);
+            Float r_target   = 0.f,
+                  weight_sum = 0.f,
+                  candidates = (Float) m_ris_samples;
+            bool r_valid = false;
+
+            for (size_t i = 0; i < m_ris_samples; ++i) {
+                auto [ds, emitter_val] = scene->sample_emitter_direction(
+                    si, sampler->next_2d(), false, true);
+                if (ds.pdf == 0.f)
+                    continue;
+
+                Vector3f wo = si.to_local(ds.d);
+                Spectrum bsdf_val = bsdf->eval(ctx, si, wo, true);
+                bsdf_val = si.to_world_mueller(bsdf_val, -wo, si.wi);
+
+                /* 'emitter_val' is the emitted radiance divided by the source
+                   density, hence its luminance directly equals the resampling
+                   weight target / source */
+                Float w = lum(bsdf_val * emitter_val);
+                if (!(w > 0.f))
+                    continue;
+
+                weight_sum += w;
+                if (sampler->next_1d() * weight_sum <= w) {
+                    r_ds       = ds;
+                    r_radiance = emitter_val * ds.pdf;
+                    r_bsdf_val = bsdf_val;
+                    r_target   = w * ds.pdf;
+                    r_valid    = true;
+                }
+            }
 
-        return { result, valid_ray };
+            Reservoir &prev = m_reservoir;
+
+            if (m_ris_reuse && prev.valid) {
+                /* The previously shaded point is a spatial neighbor thanks to
+                   the Morton traversal order within each block -- merge its
+                   reservoir after re-evaluating the carried candidate's
+                   target value at the current point */
+                Vector3f d = prev.ds.p - si.p;
+                Float dist = norm(d);
+
+                if (dist > math::RayEpsilon<Float>) {
+                    DirectionSample3f ds = prev.ds;
+                    ds.d = d / dist;
+
+                    Spectrum radiance = prev.radiance;
+                    if (ds.delta) {
+                        /* Radiance of position-delta emitters includes the
+                           inverse-squared distance falloff */
+                        radiance *= sqr(ds.dist / dist);
+                    }
+                    ds.dist = dist;
+
+                    Vector3f wo = si.to_local(ds.d);
+                    Spectrum bsdf_val = bsdf->eval(ctx, si, wo, true);
+                    bsdf_val = si.to_world_mueller(bsdf_val, -wo, si.wi);
+
+                    Float target = lum(bsdf_val * radiance);
+
+                    /* Cap the carried-over candidate count to bound the
+                       correlation between neighboring pixels */
+                    Float m = min(prev.candidates,
+                                  (Float) (20 * m_ris_samples)),
+                          w = target * prev.weight * m;
+
+                    candidates += m;
+                    if (w > 0.f) {
+                        weight_sum += w;
+                        if (sampler->next_1d() * weight_sum <= w) {
+                            r_ds       = ds;
+                            r_radiance = radiance;
+                            r_bsdf_val = bsdf_val;
+                            r_target   = target;
+                            r_valid    = true;
+                        }
+                    }
+                }
+            }
+
+            Spectrum result(0.f);
+            prev.valid = false;
+
+            if (r_valid && r_target > 0.f) {
+                // Unbiased contribution weight of the surviving candidate
+                Float ucw = weight_sum / (candidates * r_target);
+
+                if (!scene->ray_test(si.spawn_ray_to(r_ds.p))) {
+                    /* MIS against the BSDF sampling strategy, based on the
+                       plain emitter sampling density as in the classic code
+                       path (the weights then still sum to one) */
+                    Float bsdf_pdf = bsdf->pdf(ctx, si, si.to_local(r_ds.d), true);
+
+                    Float mis = r_ds.delta
+                        ? 1.f
+                        : mis_weight(scene->pdf_emitter_direction(si, r_ds) * m_frac_lum,
+                                     bsdf_pdf * m_frac_bsdf) * m_weight_lum;
+
+                    result = mis * r_bsdf_val * r_radiance * ucw;
+
+                    /* Only unoccluded reservoirs are carried over to the next
+                       shading point ("visibility reuse") */
+                    prev.ds         = r_ds;
+                    prev.radiance   = r_radiance;
+                    prev.weight     = ucw;
+                    prev.candidates = candidates;
+                    prev.valid      = true;
+                }
+            }
+
+            return result;
+        } else {
+            ENOKI_MARK_USED(scene); ENOKI_MARK_USED(sampler);
+            ENOKI_MARK_USED(si); ENOKI_MARK_USED(bsdf); ENOKI_MARK_USED(ctx);
+            return Spectrum(0.f);
+        }
     }
 
     std::string to_string() const override {
         std::ostringstream oss;
         oss << "DirectIntegrator[" << std::endl
             << "  emitter_samples = " << m_emitter_samples << "," << std::endl
-            << "  bsdf_samples = " << m_bsdf_samples << std::endl
+            << "  bsdf_samples = " << m_bsdf_samples << "," << std::endl
+            << "  ris_samples = " << m_ris_samples << std::endl
             << "]";
         return oss.str();
     }
@@ -211,10 +503,24 @@ public:
 
     MTS_DECLARE_CLASS()
 private:
+    /// Weighted reservoir carried between neighboring shading points
+    struct Reservoir {
+        DirectionSample3f ds;      ///< Position record of the surviving candidate
+        Spectrum radiance = 0.f;   ///< Emitted radiance (source density factored out)
+        Float weight = 0.f;        ///< Unbiased contribution weight
+        Float candidates = 0.f;    ///< Effective number of candidates seen
+        bool valid = false;
+    };
+
     size_t m_emitter_samples;
     size_t m_bsdf_samples;
+    size_t m_ris_samples;
+    bool m_ris_reuse;
     ScalarFloat m_frac_bsdf, m_frac_lum;
     ScalarFloat m_weight_bsdf, m_weight_lum;
+
+    /// Per-thread reservoir from the previously shaded point
+    mutable ThreadLocal<Reservoir> m_reservoir;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(DirectIntegrator, SamplingIntegrator)
@@ -0,0 +1,558 @@
+#include <tbb/parallel_for.h>
+
+#include <enoki/stl.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/random.h>
+#include <mitsuba/core/ray.h>
+#include <mitsuba/render/bsdf.h>
+#include <mitsuba/render/emitter.h>
+#include <mitsuba/render/film.h>
+#include <mitsuba/render/integrator.h>
+#include <mitsuba/render/records.h>
+#include <mitsuba/render/sensor.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _integrator-gdpt:
+
+Gradient-domain path tracer (:monosp:`gdpt`)
+--------------------------------------------
+
+.. pluginparameters::
+
+ * - max_depth
+   - |int|
+   - Specifies the longest path depth in the generated output image (where -1 corresponds to
+     :math:`\infty`). (Default: -1)
+ * - rr_depth
+   - |int|
+   - Specifies the minimum path depth, after which the implementation will start to use the
+     *russian roulette* path termination criterion. (Default: 5)
+ * - reconstruct_alpha
+   - |float|
+   - Weight of the coarse (primal) image in the screened Poisson
+     reconstruction. Larger values pull the solution towards the noisy
+     primal estimate, smaller values trust the gradients more. (Default: 0.2)
+ * - reconstruct_iterations
+   - |int|
+   - Upper bound on the number of conjugate gradient iterations of the
+     reconstruction. (Default: 50)
+
+This integrator implements gradient-domain path tracing (Kettunen et al.,
+"Gradient-Domain Path Tracing", SIGGRAPH 2015). In addition to the usual
+radiance estimate, every sample also estimates the horizontal and vertical
+finite-difference *gradients* of the image: alongside each base path, offset
+paths through the two neighboring pixels are generated by replaying the base
+path's random number sequence, so that base and offset paths track each
+other closely and their difference carries far less noise than the
+radiances themselves. The gradients are accumulated into dedicated film
+channels (``gx.*`` / ``gy.*``), and once sampling has finished, the final
+image is obtained by solving a screened Poisson problem that blends the
+noisy primal image with the low-noise gradient field. Since most of the
+noise resides in the smooth part of the image that the gradients constrain
+very effectively, flat, evenly lit scenes---typical interiors---reach a
+given error level at a fraction of the sample count of plain path tracing.
+
+The offset paths use primary-sample-space replay as the shift mapping: both
+paths consume identical uniform variates, which preserves the path
+structure exactly on rough surfaces and corresponds to a shift with unit
+Jacobian. The more elaborate half-vector-preserving shifts of the original
+paper improve gradients across near-specular chains, at a considerable
+implementation cost; for the predominantly rough transport that this mode
+targets, replay captures most of the benefit.
+
+The raw gradient channels remain available in the developed output, which
+is convenient for diagnosing reconstruction artifacts.
+
+.. note:: This integrator is currently restricted to the scalar variants.
+   It does not handle participating media, and cannot be combined with
+   adaptive sampling (the per-pixel error estimate does not account for
+   the gradient reconstruction).
+
+ */
+
+template <typename Float, typename Spectrum>
+class GDPTIntegrator final : public MonteCarloIntegrator<Float, Spectrum> {
+public:
+    MTS_IMPORT_BASE(MonteCarloIntegrator, should_stop, m_stop, m_max_depth,
+                    m_rr_depth, rr_prob, m_block_size, m_error_threshold)
+    MTS_IMPORT_TYPES(Scene, Sensor, Film, ImageBlock, Sampler, Emitter,
+                     EmitterPtr, BSDF, BSDFPtr)
+
+    /**
+     * \brief Replayable random number source
+     *
+     * Base and offset paths must consume *identical* uniform variates, which
+     * a \ref Sampler cannot guarantee once their control flow diverges. The
+     * per-sample generator is therefore seeded explicitly and simply copied
+     * for each offset path.
+     */
+    struct ReplayRNG {
+        mitsuba::PCG32<uint32_t> rng;
+
+        ReplayRNG(uint64_t seed) : rng(PCG32_DEFAULT_STATE, seed) { }
+
+        Float next_1d() { return rng.next_float32(); }
+        Point2f next_2d() {
+            Float f1 = next_1d(), f2 = next_1d();
+            return Point2f(f1, f2);
+        }
+    };
+
+    GDPTIntegrator(const Properties &props) : Base(props) {
+        m_reconstruct_alpha = props.float_("reconstruct_alpha", .2f);
+        m_reconstruct_iterations =
+            (uint32_t) props.size_("reconstruct_iterations", 50);
+
+        if (m_reconstruct_alpha <= 0.f)
+            Throw("The 'reconstruct_alpha' parameter must be positive!");
+    }
+
+    std::vector<std::string> aov_names() const override {
+        return { "gx.X", "gx.Y", "gx.Z", "gy.X", "gy.Y", "gy.Z" };
+    }
+
+    bool render(Scene *scene, Sensor *sensor) override {
+        if constexpr (is_array_v<Float>) {
+            Throw("GDPTIntegrator is only implemented for the scalar "
+                  "variants!");
+        } else {
+            if (m_error_threshold > 0.f)
+                Throw("GDPTIntegrator cannot be combined with adaptive "
+                      "sampling!");
+
+            bool result = Base::render(scene, sensor);
+
+            /* Replace the primal image by the solution of the screened
+               Poisson problem before the film is developed */
+            if (result && !m_stop)
+                reconstruct(sensor->film());
+
+            return result;
+        }
+    }
+
+    void render_block(const Scene *scene, const Sensor *sensor,
+                      Sampler *sampler, ImageBlock *block, Float *aovs,
+                      size_t sample_count_ = size_t(-1)) const override {
+        if constexpr (is_array_v<Float>) {
+            ENOKI_MARK_USED(scene);
+            ENOKI_MARK_USED(sensor);
+            ENOKI_MARK_USED(sampler);
+            ENOKI_MARK_USED(block);
+            ENOKI_MARK_USED(aovs);
+            ENOKI_MARK_USED(sample_count_);
+            Throw("GDPTIntegrator is only implemented for the scalar "
+                  "variants!");
+        } else {
+            block->clear();
+            uint32_t pixel_count  = (uint32_t)(m_block_size * m_block_size),
+                     sample_count = (uint32_t)(sample_count_ == (size_t) -1
+                                                   ? sampler->sample_count()
+                                                   : sample_count_);
+
+            ScalarFloat diff_scale_factor =
+                rsqrt((ScalarFloat) sampler->sample_count());
+
+            for (uint32_t i = 0; i < pixel_count && !should_stop(); ++i) {
+                ScalarPoint2u pos = enoki::morton_decode<ScalarPoint2u>(i);
+                if (any(pos >= block->size()))
+                    continue;
+
+                pos += block->offset();
+                sampler->set_pixel(pos);
+                for (uint32_t j = 0; j < sample_count && !should_stop(); ++j)
+                    render_sample(scene, sensor, sampler, block, aovs, pos,
+                                  diff_scale_factor);
+            }
+        }
+    }
+
+    std::string to_string() const override {
+        return tfm::format("GDPTIntegrator[\n"
+            "  max_depth = %i,\n"
+            "  rr_depth = %i,\n"
+            "  reconstruct_alpha = %f,\n"
+            "  reconstruct_iterations = %i\n"
+            "]", m_max_depth, m_rr_depth, m_reconstruct_alpha,
+            m_reconstruct_iterations);
+    }
+
+    MTS_DECLARE_CLASS()
+
+protected:
+    /**
+     * \brief Estimate the pixel radiance along with forward-difference
+     * gradients towards the two neighboring pixels
+     */
+    void render_sample(const Scene *scene, const Sensor *sensor,
+                       Sampler *sampler, ImageBlock *block, Float *aovs,
+                       const Vector2f &pos,
+                       ScalarFloat diff_scale_factor) const {
+        if constexpr (is_array_v<Float>) {
+            ENOKI_MARK_USED(scene);
+            ENOKI_MARK_USED(sensor);
+            ENOKI_MARK_USED(sampler);
+            ENOKI_MARK_USED(block);
+            ENOKI_MARK_USED(aovs);
+            ENOKI_MARK_USED(pos);
+            ENOKI_MARK_USED(diff_scale_factor);
+        } else {
+            ScopedPhase sp(ProfilerPhase::SamplingIntegratorSample);
+
+            Vector2f position_sample = pos + sampler->next_2d();
+
+            Point2f aperture_sample(.5f);
+            if (sensor->needs_aperture_sample())
+                aperture_sample = sampler->next_2d();
+
+            Float time = sensor->shutter_open();
+            if (sensor->shutter_open_time() > 0.f)
+                time += sampler->next_1d() * sensor->shutter_open_time();
+
+            Float wavelength_sample = sampler->next_1d();
+
+            /* Seed for the replayable per-sample generator; derived from
+               the (deterministically seeded) block sampler */
+            uint64_t seed = sample_tea_64(
+                (uint32_t) (sampler->next_1d() * 0x1000000),
+                (uint32_t) (sampler->next_1d() * 0x1000000));
+
+            auto trace = [&](const Vector2f &position)
+                -> std::pair<Color3f, bool> {
+                Vector2f adjusted_position =
+                    (position - sensor->film()->crop_offset()) /
+                    sensor->film()->crop_size();
+
+                auto [ray, ray_weight] = sensor->sample_ray_differential(
+                    time, wavelength_sample, adjusted_position,
+                    aperture_sample);
+                ray.scale_differential(diff_scale_factor);
+
+                ReplayRNG rng(seed);
+                auto [spec, valid] = Li(scene, rng, ray);
+                spec = ray_weight * spec;
+
+                UnpolarizedSpectrum spec_u = depolarize(spec);
+                Color3f xyz;
+                if constexpr (is_monochromatic_v<Spectrum>) {
+                    xyz = spec_u.x();
+                } else if constexpr (is_rgb_v<Spectrum>) {
+                    xyz = srgb_to_xyz(spec_u, true);
+                } else {
+                    static_assert(is_spectral_v<Spectrum>);
+                    xyz = spectrum_to_xyz(spec_u, ray.wavelengths, true);
+                }
+                return { xyz, valid };
+            };
+
+            auto [xyz, valid]  = trace(position_sample);
+            auto [xyz_x, vx_]  = trace(position_sample + Vector2f(1.f, 0.f));
+            auto [xyz_y, vy_]  = trace(position_sample + Vector2f(0.f, 1.f));
+            ENOKI_MARK_USED(vx_);
+            ENOKI_MARK_USED(vy_);
+
+            Color3f gx = xyz_x - xyz,
+                    gy = xyz_y - xyz;
+
+            aovs[0] = xyz.x();  aovs[1] = xyz.y();  aovs[2] = xyz.z();
+            aovs[3] = valid ? 1.f : 0.f;
+            aovs[4] = 1.f;
+            aovs[5] = gx.x();   aovs[6] = gx.y();   aovs[7] = gx.z();
+            aovs[8] = gy.x();   aovs[9] = gy.y();   aovs[10] = gy.z();
+
+            block->put(position_sample, aovs, true);
+
+            sampler->advance();
+        }
+    }
+
+    /**
+     * \brief Path-traced radiance estimate driven by the replayable
+     * generator (mirroring the scalar specialization of path.cpp)
+     */
+    std::pair<Spectrum, bool> Li(const Scene *scene, ReplayRNG &rng,
+                                 RayDifferential3f ray) const {
+        if constexpr (is_array_v<Float>) {
+            ENOKI_MARK_USED(scene);
+            ENOKI_MARK_USED(rng);
+            ENOKI_MARK_USED(ray);
+            return { 0.f, false };
+        } else {
+            Float eta(1.f);
+            Float emission_weight(1.f);
+            Spectrum throughput(1.f), result(0.f);
+
+            SurfaceInteraction3f si = scene->ray_intersect(ray, true);
+            bool valid_ray = si.is_valid();
+            EmitterPtr emitter = si.emitter(scene);
+
+            for (int depth = 1;; ++depth) {
+                if (emitter != nullptr)
+                    result += emission_weight * throughput *
+                              emitter->eval(si, true);
+
+                if (!si.is_valid())
+                    break;
+
+                if (depth > m_rr_depth) {
+                    Float q = rr_prob(hmax(depolarize(throughput)) * sqr(eta));
+                    if (rng.next_1d() >= q)
+                        break;
+                    throughput *= rcp(q);
+                }
+
+                if ((uint32_t) depth >= (uint32_t) m_max_depth)
+                    break;
+
+                // --------------------- Emitter sampling ---------------------
+
+                BSDFContext ctx;
+                BSDFPtr bsdf = si.bsdf(ray);
+
+                if (likely(has_flag(bsdf->flags(), BSDFFlags::Smooth))) {
+                    auto [ds, emitter_val] = scene->sample_emitter_direction(
+                        si, rng.next_2d(), true, true);
+
+                    if (ds.pdf != 0.f) {
+                        Vector3f wo = si.to_local(ds.d);
+                        auto [bsdf_val, bsdf_pdf] =
+                            bsdf->eval_pdf(ctx, si, wo, true);
+                        bsdf_val = si.to_world_mueller(bsdf_val, -wo, si.wi);
+
+                        Float mis = ds.delta
+                            ? 1.f : mis_weight(ds.pdf, bsdf_pdf);
+                        result += mis * throughput * bsdf_val * emitter_val;
+                    }
+                }
+
+                // ----------------------- BSDF sampling ----------------------
+
+                auto [bs, bsdf_val] = bsdf->sample(ctx, si, rng.next_1d(),
+                                                   rng.next_2d(), true);
+                bsdf_val = si.to_world_mueller(bsdf_val, -bs.wo, si.wi);
+
+                throughput = throughput * bsdf_val;
+                if (none(neq(depolarize(throughput), 0.f)))
+                    break;
+
+                eta *= bs.eta;
+
+                ray = RayDifferential3f(si.spawn_ray(si.to_world(bs.wo)));
+                SurfaceInteraction3f si_bsdf = scene->ray_intersect(ray, true);
+
+                emitter = si_bsdf.emitter(scene);
+                DirectionSample3f ds(si_bsdf, si);
+                ds.object = emitter;
+
+                if (emitter != nullptr) {
+                    Float emitter_pdf =
+                        has_flag(bs.sampled_type, BSDFFlags::Delta)
+                            ? 0.f
+                            : scene->pdf_emitter_direction(si, ds);
+
+                    emission_weight = mis_weight(bs.pdf, emitter_pdf);
+                }
+
+                si = std::move(si_bsdf);
+            }
+
+            return { result, valid_ray };
+        }
+    }
+
+    Float mis_weight(Float pdf_a, Float pdf_b) const {
+        pdf_a *= pdf_a;
+        pdf_b *= pdf_b;
+        return select(pdf_a > 0.f, pdf_a / (pdf_a + pdf_b), 0.f);
+    }
+
+    // =============================================================
+    //! @{ \name Screened Poisson reconstruction
+    // =============================================================
+
+    /**
+     * \brief Replace the film's primal image by the solution of
+     *
+     * \f[
+     *     \alpha^2 (I - P) - \nabla \cdot (\nabla I - G) = 0
+     * \f]
+     *
+     * where \f$P\f$ is the sampled primal image and \f$G\f$ the sampled
+     * gradient field, solved per XYZ channel with conjugate gradients. The
+     * dominant cost is the repeated application of the screened Laplacian,
+     * which is parallelized over image rows.
+     */
+    void reconstruct(Film *film) const {
+        if constexpr (!is_array_v<Float>) {
+            ref<Bitmap> raw = film->bitmap(true);
+            ScalarVector2i size = film->crop_size();
+            size_t pixel_count = (size_t) hprod(size),
+                   channel_count = raw->channel_count();
+            int width = size.x(), height = size.y();
+
+            ScalarFloat *data = (ScalarFloat *) raw->data();
+
+            /* Weight-normalized primal and gradient channels. Gradients are
+               signed, so pixels that received no samples stay zero */
+            /* The raw bitmap may alias the film's live storage, which
+               \ref Film::prepare() below will reset -- extract everything
+               needed for the write-back first */
+            std::vector<ScalarFloat> primal(pixel_count * 3),
+                                     gx(pixel_count * 3),
+                                     gy(pixel_count * 3),
+                                     alpha(pixel_count),
+                                     solution(pixel_count * 3);
+
+            for (size_t i = 0; i < pixel_count; ++i) {
+                const ScalarFloat *px = data + i * channel_count;
+                ScalarFloat inv_w = px[4] > 0.f ? rcp(px[4]) : 0.f;
+                for (size_t c = 0; c < 3; ++c) {
+                    primal[i * 3 + c] = px[c]     * inv_w;
+                    gx[i * 3 + c]     = px[5 + c] * inv_w;
+                    gy[i * 3 + c]     = px[8 + c] * inv_w;
+                }
+                alpha[i] = px[3] * inv_w;
+            }
+
+            /* Apply the screened Laplacian: out = alpha^2 x + L x, with
+               Neumann (zero-gradient) boundary conditions */
+            ScalarFloat alpha2 = sqr(m_reconstruct_alpha);
+            auto apply = [&](const std::vector<ScalarFloat> &x,
+                             std::vector<ScalarFloat> &out) {
+                tbb::parallel_for(
+                    tbb::blocked_range<int>(0, height, 16),
+                    [&](const tbb::blocked_range<int> &range) {
+                        for (int y = range.begin(); y != range.end(); ++y) {
+                            for (int x_ = 0; x_ < width; ++x_) {
+                                size_t i = (size_t) y * width + x_;
+                                for (size_t c = 0; c < 3; ++c) {
+                                    ScalarFloat v = x[i * 3 + c], acc = 0.f;
+                                    if (x_ > 0)
+                                        acc += v - x[(i - 1) * 3 + c];
+                                    if (x_ + 1 < width)
+                                        acc += v - x[(i + 1) * 3 + c];
+                                    if (y > 0)
+                                        acc += v - x[(i - width) * 3 + c];
+                                    if (y + 1 < height)
+                                        acc += v - x[(i + width) * 3 + c];
+                                    out[i * 3 + c] = alpha2 * v + acc;
+                                }
+                            }
+                        }
+                    });
+            };
+
+            /* Right-hand side: alpha^2 P + divergence of the sampled
+               gradient field */
+            std::vector<ScalarFloat> rhs(pixel_count * 3);
+            tbb::parallel_for(
+                tbb::blocked_range<int>(0, height, 16),
+                [&](const tbb::blocked_range<int> &range) {
+                    for (int y = range.begin(); y != range.end(); ++y) {
+                        for (int x_ = 0; x_ < width; ++x_) {
+                            size_t i = (size_t) y * width + x_;
+                            for (size_t c = 0; c < 3; ++c) {
+                                ScalarFloat div = -gx[i * 3 + c]
+                                                  -gy[i * 3 + c];
+                                if (x_ > 0)
+                                    div += gx[(i - 1) * 3 + c];
+                                if (y > 0)
+                                    div += gy[(i - width) * 3 + c];
+                                rhs[i * 3 + c] =
+                                    alpha2 * primal[i * 3 + c] + div;
+                            }
+                        }
+                    }
+                });
+
+            // Conjugate gradients, warm-started with the primal image
+            solution = primal;
+            std::vector<ScalarFloat> r(pixel_count * 3), p(pixel_count * 3),
+                                     ap(pixel_count * 3);
+            apply(solution, ap);
+
+            double rr = 0.0;
+            for (size_t i = 0; i < r.size(); ++i) {
+                r[i] = rhs[i] - ap[i];
+                p[i] = r[i];
+                rr += (double) r[i] * (double) r[i];
+            }
+            double rr_init = std::max(rr, 1e-20);
+
+            for (uint32_t it = 0; it < m_reconstruct_iterations; ++it) {
+                if (rr / rr_init < 1e-8)
+                    break;
+
+                apply(p, ap);
+
+                double p_ap = 0.0;
+                for (size_t i = 0; i < p.size(); ++i)
+                    p_ap += (double) p[i] * (double) ap[i];
+                if (p_ap <= 0.0)
+                    break;
+
+                double step = rr / p_ap, rr_next = 0.0;
+                for (size_t i = 0; i < p.size(); ++i) {
+                    solution[i] += (ScalarFloat) step * p[i];
+                    r[i] -= (ScalarFloat) step * ap[i];
+                    rr_next += (double) r[i] * (double) r[i];
+                }
+
+                double beta = rr_next / rr;
+                for (size_t i = 0; i < p.size(); ++i)
+                    p[i] = r[i] + (ScalarFloat) beta * p[i];
+                rr = rr_next;
+            }
+
+            Log(Info, "Screened Poisson reconstruction: residual reduced "
+                "to %.2e of its initial value", rr / rr_init);
+
+            // Write the solution (and the raw gradients) back to the film
+            std::vector<std::string> channels;
+            for (size_t i = 0; i < 5; ++i)
+                channels.emplace_back(1, "XYZAW"[i]);
+            for (const std::string &name : aov_names())
+                channels.push_back(name);
+            film->prepare(channels);
+
+            ref<ImageBlock> block =
+                new ImageBlock(size, channel_count, nullptr, false);
+            block->set_offset(film->crop_offset());
+            block->clear();
+
+            std::unique_ptr<Float[]> values(new Float[channel_count]);
+            for (size_t i = 0; i < pixel_count; ++i) {
+                for (size_t c = 0; c < 3; ++c) {
+                    values[c]     = solution[i * 3 + c];
+                    values[5 + c] = gx[i * 3 + c];
+                    values[8 + c] = gy[i * 3 + c];
+                }
+                values[3] = alpha[i];
+                values[4] = 1.f;
+
+                Point2f pos = Point2f(i % (size_t) width,
+                                      i / (size_t) width) +
+                              Vector2f(.5f) + Vector2f(film->crop_offset());
+                block->put(pos, values.get(), true);
+            }
+
+            film->put(block);
+        }
+    }
+
+    //! @}
+    // =============================================================
+
+private:
+    /// Screening weight of the primal image in the reconstruction
+    ScalarFloat m_reconstruct_alpha;
+    /// Upper bound on the number of conjugate gradient iterations
+    uint32_t m_reconstruct_iterations;
+};
+
+MTS_IMPLEMENT_CLASS_VARIANT(GDPTIntegrator, MonteCarloIntegrator)
+MTS_EXPORT_PLUGIN(GDPTIntegrator, "Gradient-Domain Path Tracer integrator");
+NAMESPACE_END(mitsuba)
@@ -0,0 +1,711 @@
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+
+#include <enoki/stl.h>
+#include <mitsuba/core/atomic.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/ray.h>
+#include <mitsuba/core/spectrum.h>
+#include <mitsuba/core/warp.h>
+#include <mitsuba/render/bsdf.h>
+#include <mitsuba/render/emitter.h>
+#include <mitsuba/render/integrator.h>
+#include <mitsuba/render/records.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _integrator-guided_path:
+
+Guided path tracer (:monosp:`guided_path`)
+------------------------------------------
+
+.. pluginparameters::
+
+ * - max_depth
+   - |int|
+   - Specifies the longest path depth in the generated output image (where -1 corresponds to
+     :math:`\infty`). (Default: -1)
+ * - rr_depth
+   - |int|
+   - Specifies the minimum path depth, after which the implementation will start to use the
+     *russian roulette* path termination criterion. (Default: 5)
+ * - guiding_fraction
+   - |float|
+   - Probability of drawing a direction from the learned distribution rather than from the
+     BSDF; the two strategies are combined into a single-sample MIS estimator, so any value
+     in :math:`(0, 1)` remains unbiased. (Default: 0.5)
+ * - spatial_threshold
+   - |int|
+   - Number of radiance records after which a leaf of the spatial binary tree is split.
+     (Default: 12000)
+ * - directional_threshold
+   - |float|
+   - Fraction of a directional quadtree's total energy above which one of its quadrants is
+     subdivided during refinement. (Default: 0.01)
+ * - refinement_samples
+   - |int|
+   - Number of camera paths after which the first SD-tree refinement takes place; the
+     interval doubles after every refinement, mirroring the usual iterated training
+     schedule. (Default: 65536)
+
+This integrator extends the plain :ref:`path tracer <integrator-path>` with *path guiding*
+in the spirit of "Practical Path Guiding": radiance carried by completed paths is recorded
+into an adaptive spatial-directional tree (a binary tree over space whose leaves hold
+directional quadtrees over the sphere), and subsequent paths importance sample the learned
+incident radiance, mixed with BSDF sampling via multiple importance sampling. Scenes whose
+light transport is dominated by caustics or long glossy chains converge dramatically faster,
+since the guided distribution finds the important directions that BSDF sampling alone keeps
+missing.
+
+Learning happens online and concurrently: radiance records only touch atomic accumulators,
+so render threads never serialize against each other, and the tree structure itself is
+refined periodically (with an exponentially growing interval) while rendering continues.
+Because early passes sample from a still-untrained distribution, allocating the sample
+budget in multiple passes (``samples_per_pass``) lets later passes profit from what earlier
+ones learned.
+
+.. note:: Guiding is currently only implemented for the scalar variants; the packet and GPU
+   variants report an error.
+
+ */
+
+template <typename Float, typename Spectrum>
+class GuidedPathIntegrator : public MonteCarloIntegrator<Float, Spectrum> {
+public:
+    MTS_IMPORT_BASE(MonteCarloIntegrator, m_max_depth, m_rr_depth, rr_prob)
+    MTS_IMPORT_TYPES(Scene, Sampler, Emitter, EmitterPtr, BSDF, BSDFPtr)
+
+    /// Longest path prefix that records radiance into the SD-tree
+    static constexpr int MaxGuidedDepth = 32;
+
+    GuidedPathIntegrator(const Properties &props) : Base(props) {
+        m_guiding_fraction = props.float_("guiding_fraction", .5f);
+        if (m_guiding_fraction <= 0.f || m_guiding_fraction >= 1.f)
+            Throw("\"guiding_fraction\" must lie in the open interval (0, 1)!");
+
+        m_spatial_threshold = props.size_("spatial_threshold", 12000);
+        m_directional_threshold = props.float_("directional_threshold", .01f);
+        if (m_directional_threshold <= 0.f)
+            Throw("\"directional_threshold\" must be positive!");
+        m_refinement_samples = props.size_("refinement_samples", 65536);
+
+        m_next_refinement = m_refinement_samples;
+        m_paths_recorded = 0;
+        m_tree_ready = false;
+    }
+
+    // =============================================================
+    //! @{ \name Adaptive directional quadtree
+    // =============================================================
+
+    /**
+     * Quadtree node over the cylindrical unit square parameterization of the
+     * sphere (\ref warp::square_to_uniform_sphere). Each node stores the
+     * energy that fell into its four quadrants; recording a sample adds to
+     * the traversed quadrant at every level, so interior sums aggregate
+     * their subtrees and never need to be recomputed.
+     */
+    struct DTreeNode {
+        AtomicFloat<ScalarFloat> sum[4];
+        uint32_t child[4];
+
+        DTreeNode() {
+            for (int i = 0; i < 4; ++i) {
+                sum[i] = 0.f;
+                child[i] = 0;
+            }
+        }
+
+        DTreeNode(const DTreeNode &other) { *this = other; }
+
+        DTreeNode &operator=(const DTreeNode &other) {
+            for (int i = 0; i < 4; ++i) {
+                sum[i] = (ScalarFloat) other.sum[i];
+                child[i] = other.child[i];
+            }
+            return *this;
+        }
+
+        ScalarFloat total() const {
+            return (ScalarFloat) sum[0] + (ScalarFloat) sum[1] +
+                   (ScalarFloat) sum[2] + (ScalarFloat) sum[3];
+        }
+    };
+
+    struct DTree {
+        /// Nodes in breadth-compatible storage; index 0 is the root
+        std::vector<DTreeNode> nodes;
+
+        DTree() { nodes.emplace_back(); }
+
+        /// Lock-free accumulation of a radiance record (thread-safe)
+        void record(ScalarPoint2f uv, ScalarFloat value) {
+            uint32_t index = 0;
+            while (true) {
+                int qx = uv.x() >= .5f ? 1 : 0,
+                    qy = uv.y() >= .5f ? 1 : 0,
+                    q  = qx + 2 * qy;
+
+                DTreeNode &node = nodes[index];
+                node.sum[q] += value;
+
+                if (node.child[q] == 0)
+                    break;
+
+                uv = ScalarPoint2f(uv.x() * 2.f - (ScalarFloat) qx,
+                                   uv.y() * 2.f - (ScalarFloat) qy);
+                index = node.child[q];
+            }
+        }
+
+        /// Density of \ref sample() with respect to the unit square
+        ScalarFloat pdf(ScalarPoint2f uv) const {
+            ScalarFloat result = 1.f;
+            uint32_t index = 0;
+            while (true) {
+                const DTreeNode &node = nodes[index];
+                ScalarFloat total = node.total();
+                if (!(total > 0.f))
+                    return result; // Untrained region: uniform
+
+                int qx = uv.x() >= .5f ? 1 : 0,
+                    qy = uv.y() >= .5f ? 1 : 0,
+                    q  = qx + 2 * qy;
+
+                ScalarFloat fraction = (ScalarFloat) node.sum[q] / total;
+                if (!(fraction > 0.f))
+                    return 0.f;
+                result *= 4.f * fraction;
+
+                if (node.child[q] == 0)
+                    return result;
+
+                uv = ScalarPoint2f(uv.x() * 2.f - (ScalarFloat) qx,
+                                   uv.y() * 2.f - (ScalarFloat) qy);
+                index = node.child[q];
+            }
+        }
+
+        /// Hierarchical sample warping; returns a point on the unit square
+        ScalarPoint2f sample(ScalarPoint2f rnd, ScalarFloat &pdf_out) const {
+            ScalarPoint2f base(0.f), scale(1.f);
+            pdf_out = 1.f;
+            uint32_t index = 0;
+
+            while (true) {
+                const DTreeNode &node = nodes[index];
+                ScalarFloat total = node.total();
+                if (!(total > 0.f))
+                    break; // Untrained region: uniform within the cell
+
+                ScalarFloat left = (ScalarFloat) node.sum[0] + (ScalarFloat) node.sum[2];
+                int qx;
+                if (rnd.x() * total < left) {
+                    qx = 0;
+                    rnd.x() = left > 0.f ? rnd.x() * total / left : rnd.x();
+                } else {
+                    qx = 1;
+                    ScalarFloat right = total - left;
+                    rnd.x() = right > 0.f ? (rnd.x() * total - left) / right
+                                          : rnd.x();
+                }
+
+                ScalarFloat top    = (ScalarFloat) node.sum[qx],
+                            column = top + (ScalarFloat) node.sum[qx + 2];
+                int qy;
+                if (rnd.y() * column < top) {
+                    qy = 0;
+                    rnd.y() = top > 0.f ? rnd.y() * column / top : rnd.y();
+                } else {
+                    qy = 1;
+                    ScalarFloat bottom = column - top;
+                    rnd.y() = bottom > 0.f ? (rnd.y() * column - top) / bottom
+                                           : rnd.y();
+                }
+
+                int q = qx + 2 * qy;
+                pdf_out *= 4.f * (ScalarFloat) node.sum[q] / total;
+
+                scale *= .5f;
+                base += ScalarPoint2f((ScalarFloat) qx * scale.x(),
+                                      (ScalarFloat) qy * scale.y());
+
+                rnd = min(rnd, ScalarPoint2f(math::OneMinusEpsilon<ScalarFloat>));
+
+                if (node.child[q] == 0)
+                    break;
+                index = node.child[q];
+            }
+
+            return base + rnd * scale;
+        }
+
+        /**
+         * Rebuild the tree structure from the accumulated energy: quadrants
+         * holding more than \c rho of the total are subdivided (new children
+         * start out uniform), the rest are collapsed. All sums are then
+         * halved so that stale radiance fades out over future refinements.
+         */
+        void refine(ScalarFloat rho, int max_depth) {
+            ScalarFloat total = nodes[0].total();
+
+            std::vector<DTreeNode> result;
+            result.emplace_back();
+
+            struct WorkItem { uint32_t src, dst; int depth; };
+            std::vector<WorkItem> stack;
+            stack.push_back(WorkItem { 0u, 0u, 1 });
+
+            while (!stack.empty()) {
+                WorkItem item = stack.back();
+                stack.pop_back();
+
+                for (int q = 0; q < 4; ++q) {
+                    ScalarFloat value = (ScalarFloat) nodes[item.src].sum[q];
+                    result[item.dst].sum[q] = value;
+
+                    bool subdivide = total > 0.f && value > rho * total &&
+                                     item.depth < max_depth;
+                    if (!subdivide)
+                        continue;
+
+                    uint32_t dst_child = (uint32_t) result.size();
+                    result[item.dst].child[q] = dst_child;
+                    result.emplace_back();
+
+                    uint32_t src_child = nodes[item.src].child[q];
+                    if (src_child != 0) {
+                        stack.push_back(WorkItem { src_child, dst_child,
+                                                   item.depth + 1 });
+                    } else {
+                        // Newly created interior node: start out uniform
+                        for (int i = 0; i < 4; ++i)
+                            result[dst_child].sum[i] = value * .25f;
+                    }
+                }
+            }
+
+            for (DTreeNode &node : result)
+                for (int i = 0; i < 4; ++i)
+                    node.sum[i] = (ScalarFloat) node.sum[i] * .5f;
+
+            nodes = std::move(result);
+        }
+    };
+
+    //! @}
+    // =============================================================
+
+    // =============================================================
+    //! @{ \name Spatial binary tree
+    // =============================================================
+
+    /// Node of the spatial binary tree; leaves own a directional quadtree
+    struct SNode {
+        uint32_t child[2] = { 0, 0 };
+        uint8_t axis = 0;
+        std::atomic<size_t> samples { 0 };
+        std::unique_ptr<DTree> dtree;
+
+        SNode() = default;
+        SNode(SNode &&other)
+            : axis(other.axis), samples(other.samples.load()),
+              dtree(std::move(other.dtree)) {
+            child[0] = other.child[0];
+            child[1] = other.child[1];
+        }
+    };
+
+    /// Map a world-space position to the directional tree of its spatial leaf
+    DTree *lookup(const ScalarPoint3f &p_, std::atomic<size_t> **samples) const {
+        ScalarPoint3f p = min(max((p_ - m_tree_min) * m_tree_inv_extent,
+                                  ScalarPoint3f(0.f)),
+                              ScalarPoint3f(math::OneMinusEpsilon<ScalarFloat>));
+        uint32_t index = 0;
+        while (true) {
+            SNode &node = m_snodes[index];
+            if (node.child[0] == 0) {
+                *samples = &node.samples;
+                return node.dtree.get();
+            }
+            int a = node.axis;
+            if (p[a] < .5f) {
+                p[a] *= 2.f;
+                index = node.child[0];
+            } else {
+                p[a] = p[a] * 2.f - 1.f;
+                index = node.child[1];
+            }
+        }
+    }
+
+    /// Lazily set up the tree root once the scene bounds are known
+    void ensure_tree(const Scene *scene) const {
+        if (m_tree_ready.load(std::memory_order_acquire))
+            return;
+
+        std::lock_guard<std::mutex> guard(m_init_mutex);
+        if (m_tree_ready.load(std::memory_order_relaxed))
+            return;
+
+        ScalarBoundingBox3f bbox = scene->bbox();
+        ScalarVector3f extent = bbox.extent();
+        for (int i = 0; i < 3; ++i)
+            extent[i] = extent[i] > 0.f ? extent[i] : 1.f;
+
+        m_tree_min = bbox.min;
+        m_tree_inv_extent = rcp(extent);
+
+        m_snodes.clear();
+        m_snodes.emplace_back();
+        m_snodes[0].dtree = std::unique_ptr<DTree>(new DTree());
+
+        m_tree_ready.store(true, std::memory_order_release);
+    }
+
+    /**
+     * Periodic structural refinement: overfull spatial leaves are split (the
+     * children inherit a copy of the parent's directional tree), and every
+     * directional tree adapts its resolution to the energy recorded so far.
+     * Callers must not hold the shared side of \ref m_tree_mutex.
+     */
+    void maybe_refine() const {
+        if (m_paths_recorded.load(std::memory_order_relaxed) <
+            m_next_refinement.load(std::memory_order_relaxed))
+            return;
+
+        std::unique_lock<std::shared_mutex> lock(m_tree_mutex);
+        size_t next = m_next_refinement.load(std::memory_order_relaxed);
+        if (m_paths_recorded.load(std::memory_order_relaxed) < next)
+            return; // Another thread got here first
+
+        // Split spatial leaves that accumulated enough radiance records
+        for (uint32_t i = 0; i < (uint32_t) m_snodes.size(); ++i) {
+            if (m_snodes[i].child[0] != 0 ||
+                m_snodes[i].samples.load(std::memory_order_relaxed) <=
+                    m_spatial_threshold)
+                continue;
+
+            uint32_t left = (uint32_t) m_snodes.size();
+            m_snodes.emplace_back();
+            m_snodes.emplace_back();
+
+            SNode &parent = m_snodes[i];
+            for (int c = 0; c < 2; ++c) {
+                SNode &child = m_snodes[left + c];
+                child.axis = (uint8_t) ((parent.axis + 1) % 3);
+                child.dtree = std::unique_ptr<DTree>(
+                    c == 0 ? new DTree(*parent.dtree)
+                           : new DTree(std::move(*parent.dtree)));
+            }
+            parent.dtree.reset();
+            parent.child[0] = left;
+            parent.child[1] = left + 1;
+        }
+
+        size_t leaves = 0;
+        for (SNode &node : m_snodes) {
+            if (node.child[0] != 0)
+                continue;
+            node.dtree->refine(m_directional_threshold, 20);
+            node.samples.store(0, std::memory_order_relaxed);
+            ++leaves;
+        }
+
+        m_next_refinement.store(next * 2, std::memory_order_relaxed);
+        Log(Debug, "guided_path: refined the SD-tree (%zu spatial leaves, "
+            "next refinement after %zu paths)", leaves, next * 2);
+    }
+
+    //! @}
+    // =============================================================
+
+    std::pair<Spectrum, Mask> sample(const Scene *scene,
+                                     Sampler *sampler,
+                                     const RayDifferential3f &ray_,
+                                     Float * /* aovs */,
+                                     Mask active) const override {
+        MTS_MASKED_FUNCTION(ProfilerPhase::SamplingIntegratorSample, active);
+
+        if constexpr (is_array_v<Float>) {
+            ENOKI_MARK_USED(scene);
+            ENOKI_MARK_USED(sampler);
+            ENOKI_MARK_USED(ray_);
+            Throw("The guided path tracer is currently only available in the "
+                  "scalar variants!");
+        } else {
+            ensure_tree(scene);
+
+            RayDifferential3f ray = ray_;
+
+            // Tracks radiance scaling due to index of refraction changes
+            Float eta(1.f);
+
+            // MIS weight for intersected emitters (set by prev. iteration)
+            Float emission_weight(1.f);
+
+            Spectrum throughput(1.f), result(0.f);
+
+            /* Path vertices whose incident radiance is still being measured;
+               every radiance term added downstream is propagated back to
+               them and recorded into their directional trees */
+            struct Vertex {
+                DTree *dtree;
+                ScalarPoint2f uv;
+                ScalarFloat pdf;
+                ScalarFloat lum_after;
+            };
+            Vertex stack[MaxGuidedDepth];
+            int n_vertices = 0;
+
+            auto lum = [&](const Spectrum &value) -> ScalarFloat {
+                UnpolarizedSpectrum value_u = depolarize(value);
+                if constexpr (is_monochromatic_v<Spectrum>)
+                    return value_u.x();
+                else if constexpr (is_rgb_v<Spectrum>)
+                    return luminance(value_u);
+                else
+                    return luminance(value_u, ray.wavelengths);
+            };
+
+            auto splat = [&](ScalarFloat term) {
+                if (!(term > 0.f))
+                    return;
+                for (int i = 0; i < n_vertices; ++i) {
+                    const Vertex &v = stack[i];
+                    if (v.lum_after > 0.f)
+                        v.dtree->record(v.uv, term / (v.lum_after * v.pdf));
+                }
+            };
+
+            if (!active)
+                return { result, false };
+
+            /* Radiance records and guided sampling hold the shared side of
+               the tree lock; only structural refinement is exclusive */
+            std::shared_lock<std::shared_mutex> tree_lock(m_tree_mutex);
+
+            // ---------------------- First intersection ----------------------
+
+            SurfaceInteraction3f si = scene->ray_intersect(ray, true);
+            bool valid_ray = si.is_valid();
+            EmitterPtr emitter = si.emitter(scene);
+
+            for (int depth = 1;; ++depth) {
+
+                // ---------------- Intersection with emitters ----------------
+
+                if (emitter != nullptr) {
+                    Spectrum term = emission_weight * throughput * emitter->eval(si, true);
+                    result += term;
+                    splat(lum(term));
+                }
+
+                if (!si.is_valid())
+                    break;
+
+                /* Russian roulette: try to keep path weights equal to one,
+                   while accounting for the solid angle compression at refractive
+                   index boundaries. */
+                if (depth > m_rr_depth) {
+                    Float q = rr_prob(hmax(depolarize(throughput)) * sqr(eta));
+                    if (sampler->next_1d() >= q)
+                        break;
+                    throughput *= rcp(q);
+                }
+
+                if ((uint32_t) depth >= (uint32_t) m_max_depth)
+                    break;
+
+                BSDFContext ctx;
+                BSDFPtr bsdf = si.bsdf(ray);
+                bool smooth = has_flag(bsdf->flags(), BSDFFlags::Smooth);
+
+                DTree *dtree = nullptr;
+                std::atomic<size_t> *leaf_samples = nullptr;
+                if (smooth)
+                    dtree = lookup(si.p, &leaf_samples);
+
+                // --------------------- Emitter sampling ---------------------
+
+                if (likely(smooth)) {
+                    auto [ds, emitter_val] = scene->sample_emitter_direction(
+                        si, sampler->next_2d(), true, true);
+
+                    if (ds.pdf != 0.f) {
+                        Vector3f wo = si.to_local(ds.d);
+                        Spectrum bsdf_val = bsdf->eval(ctx, si, wo, true);
+                        bsdf_val = si.to_world_mueller(bsdf_val, -wo, si.wi);
+
+                        /* Density of generating that direction with the
+                           guided single-sample mixture */
+                        Float bsdf_pdf = bsdf->pdf(ctx, si, wo, true);
+                        Float mix_pdf = bsdf_pdf;
+                        if (dtree != nullptr) {
+                            ScalarFloat guide_pdf =
+                                dtree->pdf(warp::uniform_sphere_to_square(ds.d)) *
+                                math::InvFourPi<ScalarFloat>;
+                            mix_pdf = m_guiding_fraction * guide_pdf +
+                                      (1.f - m_guiding_fraction) * bsdf_pdf;
+                        }
+
+                        Float mis = ds.delta ? 1.f : mis_weight(ds.pdf, mix_pdf);
+                        Spectrum term = mis * throughput * bsdf_val * emitter_val;
+                        result += term;
+                        splat(lum(term));
+                    }
+                }
+
+                // ----------------------- BSDF sampling ----------------------
+
+                Vector3f wo_world;
+                Spectrum weight;
+                Float pdf_fwd; // Density of the sampled direction (for MIS)
+                bool delta, record = false;
+                ScalarPoint2f record_uv;
+
+                if (dtree != nullptr && sampler->next_1d() < m_guiding_fraction) {
+                    // Guided strategy of the single-sample mixture
+                    ScalarFloat guide_pdf_sq;
+                    record_uv = dtree->sample(sampler->next_2d(), guide_pdf_sq);
+                    wo_world = warp::square_to_uniform_sphere(record_uv);
+
+                    Vector3f wo = si.to_local(wo_world);
+                    Spectrum bsdf_val = bsdf->eval(ctx, si, wo, true);
+                    bsdf_val = si.to_world_mueller(bsdf_val, -wo, si.wi);
+                    Float bsdf_pdf = bsdf->pdf(ctx, si, wo, true);
+
+                    pdf_fwd = m_guiding_fraction * guide_pdf_sq *
+                                  math::InvFourPi<ScalarFloat> +
+                              (1.f - m_guiding_fraction) * bsdf_pdf;
+                    if (!(pdf_fwd > 0.f))
+                        break;
+
+                    weight = bsdf_val / pdf_fwd;
+                    delta = false;
+                    record = true;
+                } else {
+                    auto [bs, bsdf_weight] = bsdf->sample(ctx, si, sampler->next_1d(),
+                                                          sampler->next_2d(), true);
+                    bsdf_weight = si.to_world_mueller(bsdf_weight, -bs.wo, si.wi);
+                    wo_world = si.to_world(bs.wo);
+                    delta = has_flag(bs.sampled_type, BSDFFlags::Delta);
+                    eta *= bs.eta;
+
+                    if (dtree != nullptr && !delta) {
+                        /* Re-weight by the mixture density so that both
+                           strategies use the same estimator */
+                        record_uv = warp::uniform_sphere_to_square(wo_world);
+                        Spectrum bsdf_val = bsdf->eval(ctx, si, bs.wo, true);
+                        bsdf_val = si.to_world_mueller(bsdf_val, -bs.wo, si.wi);
+                        ScalarFloat guide_pdf =
+                            dtree->pdf(record_uv) * math::InvFourPi<ScalarFloat>;
+                        pdf_fwd = m_guiding_fraction * guide_pdf +
+                                  (1.f - m_guiding_fraction) * bs.pdf;
+                        if (!(pdf_fwd > 0.f))
+                            break;
+                        weight = bsdf_val / pdf_fwd;
+                        record = true;
+                    } else {
+                        /* Delta components cannot be produced by the guided
+                           strategy; compensate for its selection probability */
+                        weight = bsdf_weight;
+                        if (dtree != nullptr)
+                            weight *= rcp(1.f - m_guiding_fraction);
+                        pdf_fwd = bs.pdf;
+                    }
+                }
+
+                throughput = throughput * weight;
+                if (none(neq(depolarize(throughput), 0.f)))
+                    break;
+
+                if (record && n_vertices < MaxGuidedDepth) {
+                    stack[n_vertices++] = Vertex {
+                        dtree, record_uv, (ScalarFloat) pdf_fwd,
+                        lum(throughput)
+                    };
+                    if (leaf_samples)
+                        leaf_samples->fetch_add(1, std::memory_order_relaxed);
+                }
+
+                // Intersect the sampled ray against the scene geometry
+                ray = si.spawn_ray(wo_world);
+                SurfaceInteraction3f si_bsdf = scene->ray_intersect(ray, true);
+
+                /* Determine probability of having sampled that same
+                   direction using emitter sampling. */
+                emitter = si_bsdf.emitter(scene);
+                DirectionSample3f ds(si_bsdf, si);
+                ds.object = emitter;
+
+                if (emitter != nullptr) {
+                    Float emitter_pdf =
+                        delta ? 0.f : scene->pdf_emitter_direction(si, ds);
+                    emission_weight = mis_weight(pdf_fwd, emitter_pdf);
+                }
+
+                si = std::move(si_bsdf);
+            }
+
+            tree_lock.unlock();
+
+            m_paths_recorded.fetch_add(1, std::memory_order_relaxed);
+            maybe_refine();
+
+            return { result, valid_ray };
+        }
+    }
+
+    std::string to_string() const override {
+        return tfm::format("GuidedPathIntegrator[\n"
+            "  max_depth = %i,\n"
+            "  rr_depth = %i,\n"
+            "  guiding_fraction = %f,\n"
+            "  spatial_threshold = %i,\n"
+            "  directional_threshold = %f\n"
+            "]", m_max_depth, m_rr_depth, m_guiding_fraction,
+            m_spatial_threshold, m_directional_threshold);
+    }
+
+    Float mis_weight(Float pdf_a, Float pdf_b) const {
+        pdf_a *= pdf_a;
+        pdf_b *= pdf_b;
+        return select(pdf_a > 0.f, pdf_a / (pdf_a + pdf_b), 0.f);
+    }
+
+    MTS_DECLARE_CLASS()
+private:
+    /// Probability of sampling the learned distribution over the BSDF
+    ScalarFloat m_guiding_fraction;
+
+    /// Records per spatial leaf before it is split
+    size_t m_spatial_threshold;
+
+    /// Energy fraction above which a directional quadrant is subdivided
+    ScalarFloat m_directional_threshold;
+
+    /// Paths before the first refinement (interval doubles afterwards)
+    size_t m_refinement_samples;
+
+    /// Root bounds of the spatial tree (normalized lookup)
+    mutable ScalarPoint3f m_tree_min;
+    mutable ScalarVector3f m_tree_inv_extent;
+
+    /// Spatial tree nodes; only mutated under the exclusive tree lock
+    mutable std::vector<SNode> m_snodes;
+
+    /// Guards tree structure: shared for recording/sampling, exclusive for refinement
+    mutable std::shared_mutex m_tree_mutex;
+    mutable std::mutex m_init_mutex;
+    mutable std::atomic<bool> m_tree_ready;
+    mutable std::atomic<size_t> m_paths_recorded;
+    mutable std::atomic<size_t> m_next_refinement;
+};
+
+MTS_IMPLEMENT_CLASS_VARIANT(GuidedPathIntegrator, MonteCarloIntegrator)
+MTS_EXPORT_PLUGIN(GuidedPathIntegrator, "Guided path tracer integrator");
+NAMESPACE_END(mitsuba)
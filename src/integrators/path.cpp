@@ -30,6 +30,17 @@ Path tracer (:monosp:`path`)
  * - hide_emitters
    - |bool|
    - Hide directly visible emitters. (Default: no, i.e. |false|)
+ * - adaptive_rr
+   - |bool|
+   - Use efficiency-aware russian roulette: survival probabilities are
+     normalized by a running estimate of the mean image luminance, so that
+     high-contribution paths are not terminated prematurely and dim paths
+     are not extended needlessly. Strong paths additionally receive up to
+     :monosp:`rr_split_max` emitter samples per vertex. (Default: |false|)
+ * - rr_split_max
+   - |int|
+   - Upper bound on the per-vertex emitter sample splitting performed when
+     :monosp:`adaptive_rr` is enabled. (Default: 4)
 
 This integrator implements a basic path tracer and is a **good default choice**
 when there is no strong reason to prefer another method.
@@ -92,14 +103,25 @@ both direct and indirect illumination.
 template <typename Float, typename Spectrum>
 class PathIntegrator : public MonteCarloIntegrator<Float, Spectrum> {
 public:
-    MTS_IMPORT_BASE(MonteCarloIntegrator, m_max_depth, m_rr_depth)
+    MTS_IMPORT_BASE(MonteCarloIntegrator, m_max_depth, m_rr_depth,
+                    m_adaptive_rr, m_rr_split_max, rr_factor, rr_prob)
     MTS_IMPORT_TYPES(Scene, Sampler, Emitter, EmitterPtr, BSDF, BSDFPtr)
 
     PathIntegrator(const Properties &props) : Base(props) { }
 
+    std::pair<Spectrum, Mask> sample(const Scene *scene,
+                                     Sampler *sampler,
+                                     const RayDifferential3f &ray,
+                                     Float *aovs,
+                                     Mask active) const override {
+        SurfaceInteraction3f si = scene->ray_intersect(ray, active);
+        return sample(scene, sampler, ray, si, aovs, active);
+    }
+
     std::pair<Spectrum, Mask> sample(const Scene *scene,
                                      Sampler *sampler,
                                      const RayDifferential3f &ray_,
+                                     const SurfaceInteraction3f &si_first,
                                      Float * /* aovs */,
                                      Mask active) const override {
         MTS_MASKED_FUNCTION(ProfilerPhase::SamplingIntegratorSample, active);
@@ -114,98 +136,214 @@ public:
 
         Spectrum throughput(1.f), result(0.f);
 
-        // ---------------------- First intersection ----------------------
+        if constexpr (!is_array_v<Float>) {
+            /* Scalar specialization: the masked assignments and \c select
+               calls of the generic implementation below are no-ops for a
+               single sample, yet their data-flow formulation prevents the
+               compiler from turning path termination into early exits. This
+               variant of the loop uses plain branches instead. */
+            if (!active)
+                return { result, false };
+
+            // ---------------------- First intersection ----------------------
+
+            SurfaceInteraction3f si = si_first;
+            bool valid_ray = si.is_valid();
+            EmitterPtr emitter = si.emitter(scene);
+
+            for (int depth = 1;; ++depth) {
+
+                // ---------------- Intersection with emitters ----------------
+
+                if (emitter != nullptr)
+                    result += emission_weight * throughput * emitter->eval(si, true);
+
+                if (!si.is_valid())
+                    break;
+
+                /* Russian roulette: try to keep path weights equal to one,
+                   while accounting for the solid angle compression at refractive
+                   index boundaries. Stop with at least some probability to avoid
+                   getting stuck (e.g. due to total internal reflection) */
+                int n_split = 1;
+                if (depth > m_rr_depth) {
+                    Float tp = hmax(depolarize(throughput)) * sqr(eta);
+                    Float q = rr_prob(tp);
+                    if (sampler->next_1d() >= q)
+                        break;
+                    throughput *= rcp(q);
+
+                    /* Splitting counterpart of adaptive roulette: paths whose
+                       potential contribution exceeds the mean image luminance
+                       are given extra emitter samples instead of extra weight */
+                    if (m_adaptive_rr)
+                        n_split = std::min(std::max(1, (int) rr_factor(tp)),
+                                           m_rr_split_max);
+                }
+
+                // Stop if we've exceeded the number of requested bounces
+                if ((uint32_t) depth >= (uint32_t) m_max_depth)
+                    break;
+
+                // --------------------- Emitter sampling ---------------------
+
+                BSDFContext ctx;
+                BSDFPtr bsdf = si.bsdf(ray);
+
+                if (likely(has_flag(bsdf->flags(), BSDFFlags::Smooth))) {
+                    Float split_weight = 1.f / n_split;
+                    for (int j = 0; j < n_split; ++j) {
+                        auto [ds, emitter_val] = scene->sample_emitter_direction(
+                            si, sampler->next_2d(), true, true);
+
+                        if (ds.pdf != 0.f) {
+                            /* Query the BSDF for that emitter-sampled direction,
+                               along with the density of sampling that same
+                               direction using BSDF sampling */
+                            Vector3f wo = si.to_local(ds.d);
+                            auto [bsdf_val, bsdf_pdf] = bsdf->eval_pdf(ctx, si, wo, true);
+                            bsdf_val = si.to_world_mueller(bsdf_val, -wo, si.wi);
+
+                            Float mis = ds.delta ? 1.f : mis_weight(ds.pdf, bsdf_pdf);
+                            result += (split_weight * mis) * throughput *
+                                      bsdf_val * emitter_val;
+                        }
+                    }
+                }
+
+                // ----------------------- BSDF sampling ----------------------
+
+                // Sample BSDF * cos(theta)
+                MTS_STAT_ADD(BSDFSamples, 1);
+                auto [bs, bsdf_val] = bsdf->sample(ctx, si, sampler->next_1d(),
+                                                   sampler->next_2d(), true);
+                bsdf_val = si.to_world_mueller(bsdf_val, -bs.wo, si.wi);
+
+                throughput = throughput * bsdf_val;
+                if (none(neq(depolarize(throughput), 0.f)))
+                    break;
+
+                eta *= bs.eta;
+
+                // Intersect the BSDF ray against the scene geometry
+                ray = si.spawn_ray(si.to_world(bs.wo));
+                SurfaceInteraction3f si_bsdf = scene->ray_intersect(ray, true);
+
+                /* Determine probability of having sampled that same
+                   direction using emitter sampling. */
+                emitter = si_bsdf.emitter(scene);
+                DirectionSample3f ds(si_bsdf, si);
+                ds.object = emitter;
+
+                if (emitter != nullptr) {
+                    Float emitter_pdf =
+                        has_flag(bs.sampled_type, BSDFFlags::Delta)
+                            ? 0.f
+                            : scene->pdf_emitter_direction(si, ds);
+
+                    emission_weight = mis_weight(bs.pdf, emitter_pdf);
+                }
+
+                si = std::move(si_bsdf);
+            }
 
-        SurfaceInteraction3f si = scene->ray_intersect(ray, active);
-        Mask valid_ray = si.is_valid();
-        EmitterPtr emitter = si.emitter(scene);
+            return { result, valid_ray };
+        } else {
 
-        for (int depth = 1;; ++depth) {
+            // ---------------------- First intersection ----------------------
 
-            // ---------------- Intersection with emitters ----------------
+            SurfaceInteraction3f si = si_first;
+            Mask valid_ray = si.is_valid();
+            EmitterPtr emitter = si.emitter(scene);
 
-            if (any_or<true>(neq(emitter, nullptr)))
-                result[active] += emission_weight * throughput * emitter->eval(si, active);
+            for (int depth = 1;; ++depth) {
 
-            active &= si.is_valid();
+                // ---------------- Intersection with emitters ----------------
 
-            /* Russian roulette: try to keep path weights equal to one,
-               while accounting for the solid angle compression at refractive
-               index boundaries. Stop with at least some probability to avoid
-               getting stuck (e.g. due to total internal reflection) */
-            if (depth > m_rr_depth) {
-                Float q = min(hmax(depolarize(throughput)) * sqr(eta), .95f);
-                active &= sampler->next_1d(active) < q;
-                throughput *= rcp(q);
-            }
+                if (any_or<true>(neq(emitter, nullptr)))
+                    result[active] += emission_weight * throughput * emitter->eval(si, active);
 
-            // Stop if we've exceeded the number of requested bounces, or
-            // if there are no more active lanes. Only do this latter check
-            // in GPU mode when the number of requested bounces infinite
-            // since it causes a costly synchronization.
-            if ((uint32_t) depth >= (uint32_t) m_max_depth ||
-                ((!is_cuda_array_v<Float> || m_max_depth < 0) && none(active)))
-                break;
+                active &= si.is_valid();
 
-            // --------------------- Emitter sampling ---------------------
+                /* Russian roulette: try to keep path weights equal to one,
+                   while accounting for the solid angle compression at refractive
+                   index boundaries. Stop with at least some probability to avoid
+                   getting stuck (e.g. due to total internal reflection) */
+                if (depth > m_rr_depth) {
+                    Float q = rr_prob(hmax(depolarize(throughput)) * sqr(eta));
+                    active &= sampler->next_1d(active) < q;
+                    throughput *= rcp(q);
+                }
 
-            BSDFContext ctx;
-            BSDFPtr bsdf = si.bsdf(ray);
-            Mask active_e = active && has_flag(bsdf->flags(), BSDFFlags::Smooth);
+                // Stop if we've exceeded the number of requested bounces, or
+                // if there are no more active lanes. Only do this latter check
+                // in GPU mode when the number of requested bounces infinite
+                // since it causes a costly synchronization.
+                if ((uint32_t) depth >= (uint32_t) m_max_depth ||
+                    ((!is_cuda_array_v<Float> || m_max_depth < 0) && none(active)))
+                    break;
 
-            if (likely(any_or<true>(active_e))) {
-                auto [ds, emitter_val] = scene->sample_emitter_direction(
-                    si, sampler->next_2d(active_e), true, active_e);
-                active_e &= neq(ds.pdf, 0.f);
+                // --------------------- Emitter sampling ---------------------
 
-                // Query the BSDF for that emitter-sampled direction
-                Vector3f wo = si.to_local(ds.d);
-                Spectrum bsdf_val = bsdf->eval(ctx, si, wo, active_e);
-                bsdf_val = si.to_world_mueller(bsdf_val, -wo, si.wi);
+                BSDFContext ctx;
+                BSDFPtr bsdf = si.bsdf(ray);
+                Mask active_e = active && has_flag(bsdf->flags(), BSDFFlags::Smooth);
 
-                // Determine density of sampling that same direction using BSDF sampling
-                Float bsdf_pdf = bsdf->pdf(ctx, si, wo, active_e);
+                if (likely(any_or<true>(active_e))) {
+                    auto [ds, emitter_val] = scene->sample_emitter_direction(
+                        si, sampler->next_2d(active_e), true, active_e);
+                    active_e &= neq(ds.pdf, 0.f);
 
-                Float mis = select(ds.delta, 1.f, mis_weight(ds.pdf, bsdf_pdf));
-                result[active_e] += mis * throughput * bsdf_val * emitter_val;
-            }
+                    /* Query the BSDF for that emitter-sampled direction, along
+                       with the density of sampling that same direction using
+                       BSDF sampling */
+                    Vector3f wo = si.to_local(ds.d);
+                    auto [bsdf_val, bsdf_pdf] = bsdf->eval_pdf(ctx, si, wo, active_e);
+                    bsdf_val = si.to_world_mueller(bsdf_val, -wo, si.wi);
 
-            // ----------------------- BSDF sampling ----------------------
+                    Float mis = select(ds.delta, 1.f, mis_weight(ds.pdf, bsdf_pdf));
+                    result[active_e] += mis * throughput * bsdf_val * emitter_val;
+                }
 
-            // Sample BSDF * cos(theta)
-            auto [bs, bsdf_val] = bsdf->sample(ctx, si, sampler->next_1d(active),
-                                               sampler->next_2d(active), active);
-            bsdf_val = si.to_world_mueller(bsdf_val, -bs.wo, si.wi);
+                // ----------------------- BSDF sampling ----------------------
 
-            throughput = throughput * bsdf_val;
-            active &= any(neq(depolarize(throughput), 0.f));
-            if (none_or<false>(active))
-                break;
+                // Sample BSDF * cos(theta)
+                MTS_STAT_ADD(BSDFSamples, count(active));
+                auto [bs, bsdf_val] = bsdf->sample(ctx, si, sampler->next_1d(active),
+                                                   sampler->next_2d(active), active);
+                bsdf_val = si.to_world_mueller(bsdf_val, -bs.wo, si.wi);
 
-            eta *= bs.eta;
+                throughput = throughput * bsdf_val;
+                active &= any(neq(depolarize(throughput), 0.f));
+                if (none_or<false>(active))
+                    break;
 
-            // Intersect the BSDF ray against the scene geometry
-            ray = si.spawn_ray(si.to_world(bs.wo));
-            SurfaceInteraction3f si_bsdf = scene->ray_intersect(ray, active);
+                eta *= bs.eta;
 
-            /* Determine probability of having sampled that same
-               direction using emitter sampling. */
-            emitter = si_bsdf.emitter(scene, active);
-            DirectionSample3f ds(si_bsdf, si);
-            ds.object = emitter;
+                // Intersect the BSDF ray against the scene geometry
+                ray = si.spawn_ray(si.to_world(bs.wo));
+                SurfaceInteraction3f si_bsdf = scene->ray_intersect(ray, active);
 
-            if (any_or<true>(neq(emitter, nullptr))) {
-                Float emitter_pdf =
-                    select(has_flag(bs.sampled_type, BSDFFlags::Delta), 0.f,
-                           scene->pdf_emitter_direction(si, ds, active));
+                /* Determine probability of having sampled that same
+                   direction using emitter sampling. */
+                emitter = si_bsdf.emitter(scene, active);
+                DirectionSample3f ds(si_bsdf, si);
+                ds.object = emitter;
 
-                emission_weight = mis_weight(bs.pdf, emitter_pdf);
+                if (any_or<true>(neq(emitter, nullptr))) {
+                    Float emitter_pdf =
+                        select(has_flag(bs.sampled_type, BSDFFlags::Delta), 0.f,
+                               scene->pdf_emitter_direction(si, ds, active));
+
+                    emission_weight = mis_weight(bs.pdf, emitter_pdf);
+                }
+
+                si = std::move(si_bsdf);
             }
 
-            si = std::move(si_bsdf);
-        }
+            return { result, valid_ray };
 
-        return { result, valid_ray };
+        }
     }
 
     //! @}
@@ -0,0 +1,315 @@
+#include <enoki/stl.h>
+#include <mitsuba/core/ray.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/render/bsdf.h>
+#include <mitsuba/render/emitter.h>
+#include <mitsuba/render/integrator.h>
+#include <mitsuba/render/records.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _integrator-rb:
+
+Radiative backpropagation (:monosp:`rb`)
+----------------------------------------
+
+.. pluginparameters::
+
+ * - max_depth
+   - |int|
+   - Specifies the longest path depth in the generated output image (where -1 corresponds to
+     :math:`\infty`). (Default: -1)
+ * - rr_depth
+   - |int|
+   - Specifies the minimum path depth, after which the implementation will start to use the
+     *russian roulette* path termination criterion. (Default: 5)
+
+This integrator computes parameter gradients for differentiable rendering
+using *radiative backpropagation*: rather than taping the entire forward
+rendering computation and differentiating it in reverse (which requires
+memory proportional to the sample count), gradients are transported through
+the scene as an *adjoint radiance* quantity in a second tracing phase.
+
+The forward phase (``sample()``) is an ordinary path tracer with multiple
+importance sampling whose emitter and BSDF evaluations are detached from
+the autodiff graph, so that rendering the primal image records no
+transcript. The adjoint phase (``sample_adjoint()``) receives the gradient
+of the objective with respect to each camera sample and traces a second
+random walk that deposits this gradient at the differentiable parameters
+encountered along the way. Only the local emitter and BSDF evaluations at
+each path vertex are ever attached, so the retained graph remains small
+independently of path length, sample count, and image resolution.
+
+This plugin is only useful in the autodiff variants of the renderer --
+``sample_adjoint()`` raises an exception elsewhere, and ``sample()``
+behaves like the standard :ref:`path tracer <integrator-path>`.
+
+.. note:: This integrator does not handle participating media
+
+ */
+
+template <typename Float, typename Spectrum>
+class RadiativeBackpropIntegrator : public MonteCarloIntegrator<Float, Spectrum> {
+public:
+    MTS_IMPORT_BASE(MonteCarloIntegrator, m_max_depth, m_rr_depth, rr_prob)
+    MTS_IMPORT_TYPES(Scene, Sampler, Emitter, EmitterPtr, BSDF, BSDFPtr)
+
+    RadiativeBackpropIntegrator(const Properties &props) : Base(props) { }
+
+    std::pair<Spectrum, Mask> sample(const Scene *scene,
+                                     Sampler *sampler,
+                                     const RayDifferential3f &ray_,
+                                     Float * /* aovs */,
+                                     Mask active) const override {
+        MTS_MASKED_FUNCTION(ProfilerPhase::SamplingIntegratorSample, active);
+
+        RayDifferential3f ray = ray_;
+
+        // Tracks radiance scaling due to index of refraction changes
+        Float eta(1.f);
+
+        // MIS weight for intersected emitters (set by prev. iteration)
+        Float emission_weight(1.f);
+
+        Spectrum throughput(1.f), result(0.f);
+
+        SurfaceInteraction3f si = scene->ray_intersect(ray, active);
+        Mask valid_ray = si.is_valid();
+        EmitterPtr emitter = si.emitter(scene);
+
+        for (int depth = 1;; ++depth) {
+
+            // ---------------- Intersection with emitters ----------------
+
+            if (any_or<true>(neq(emitter, nullptr)))
+                result[active] += emission_weight * throughput *
+                                  detach_spec(emitter->eval(si, active));
+
+            active &= si.is_valid();
+
+            /* Russian roulette: try to keep path weights equal to one,
+               while accounting for the solid angle compression at refractive
+               index boundaries. Stop with at least some probability to avoid
+               getting stuck (e.g. due to total internal reflection) */
+            if (depth > m_rr_depth) {
+                Float q = rr_prob(hmax(depolarize(throughput)) * sqr(eta));
+                active &= sampler->next_1d(active) < q;
+                throughput *= rcp(q);
+            }
+
+            // Stop if we've exceeded the number of requested bounces, or
+            // if there are no more active lanes. Only do this latter check
+            // in GPU mode when the number of requested bounces infinite
+            // since it causes a costly synchronization.
+            if ((uint32_t) depth >= (uint32_t) m_max_depth ||
+                ((!is_cuda_array_v<Float> || m_max_depth < 0) && none(active)))
+                break;
+
+            // --------------------- Emitter sampling ---------------------
+
+            BSDFContext ctx;
+            BSDFPtr bsdf = si.bsdf(ray);
+            Mask active_e = active && has_flag(bsdf->flags(), BSDFFlags::Smooth);
+
+            if (likely(any_or<true>(active_e))) {
+                auto [ds, emitter_val] = scene->sample_emitter_direction(
+                    si, sampler->next_2d(active_e), true, active_e);
+                active_e &= neq(ds.pdf, 0.f);
+
+                /* Query the BSDF for that emitter-sampled direction, along
+                   with the density of sampling that same direction using
+                   BSDF sampling */
+                Vector3f wo = si.to_local(ds.d);
+                auto [bsdf_val, bsdf_pdf] = bsdf->eval_pdf(ctx, si, wo, active_e);
+                bsdf_val = si.to_world_mueller(bsdf_val, -wo, si.wi);
+
+                Float mis = select(ds.delta, 1.f, mis_weight(ds.pdf, bsdf_pdf));
+                result[active_e] += mis * throughput * detach_spec(bsdf_val) *
+                                    detach_spec(emitter_val);
+            }
+
+            // ----------------------- BSDF sampling ----------------------
+
+            // Sample BSDF * cos(theta)
+            MTS_STAT_ADD(BSDFSamples, count(active));
+            auto [bs, bsdf_val] = bsdf->sample(ctx, si, sampler->next_1d(active),
+                                               sampler->next_2d(active), active);
+            bsdf_val = si.to_world_mueller(bsdf_val, -bs.wo, si.wi);
+
+            throughput = throughput * detach_spec(bsdf_val);
+            active &= any(neq(depolarize(throughput), 0.f));
+            if (none_or<false>(active))
+                break;
+
+            eta *= bs.eta;
+
+            // Intersect the BSDF ray against the scene geometry
+            ray = si.spawn_ray(si.to_world(bs.wo));
+            SurfaceInteraction3f si_bsdf = scene->ray_intersect(ray, active);
+
+            /* Determine probability of having sampled that same
+               direction using emitter sampling. */
+            emitter = si_bsdf.emitter(scene, active);
+            DirectionSample3f ds(si_bsdf, si);
+            ds.object = emitter;
+
+            if (any_or<true>(neq(emitter, nullptr))) {
+                Float emitter_pdf =
+                    select(has_flag(bs.sampled_type, BSDFFlags::Delta), 0.f,
+                           scene->pdf_emitter_direction(si, ds, active));
+
+                emission_weight = mis_weight(bs.pdf, emitter_pdf);
+            }
+
+            si = std::move(si_bsdf);
+        }
+
+        return { result, valid_ray };
+    }
+
+    void sample_adjoint(const Scene *scene,
+                        Sampler *sampler,
+                        const RayDifferential3f &ray_,
+                        const Spectrum &adjoint,
+                        Mask active) const override {
+        if constexpr (!is_diff_array_v<Float>) {
+            ENOKI_MARK_USED(scene); ENOKI_MARK_USED(sampler);
+            ENOKI_MARK_USED(ray_); ENOKI_MARK_USED(adjoint);
+            ENOKI_MARK_USED(active);
+            NotImplementedError("sample_adjoint");
+        } else {
+            MTS_MASKED_FUNCTION(ProfilerPhase::SamplingIntegratorSample, active);
+
+            RayDifferential3f ray = ray_;
+            Float eta(1.f), emission_weight(1.f);
+            Spectrum throughput(1.f);
+
+            /* Inner product of the adjoint radiance with the (attached)
+               scattered contributions, accumulated across path vertices.
+               Differentiating this scalar at the end of the walk deposits
+               the gradients at the scene parameters. */
+            Float objective(0.f);
+
+            SurfaceInteraction3f si = scene->ray_intersect(ray, active);
+            EmitterPtr emitter = si.emitter(scene);
+
+            for (int depth = 1;; ++depth) {
+
+                // ---------------- Intersection with emitters ----------------
+
+                if (any_or<true>(neq(emitter, nullptr))) {
+                    Spectrum contrib = emission_weight * throughput *
+                                       emitter->eval(si, active);
+                    objective[active] +=
+                        hsum(depolarize(contrib) * depolarize(adjoint));
+                }
+
+                active &= si.is_valid();
+
+                /* The adjoint walk reuses the termination logic of the primal
+                   phase; russian roulette draws fresh random numbers, which
+                   leaves the gradient estimate unbiased */
+                if (depth > m_rr_depth) {
+                    Float q = rr_prob(hmax(depolarize(throughput)) * sqr(eta));
+                    active &= sampler->next_1d(active) < q;
+                    throughput *= rcp(q);
+                }
+
+                if ((uint32_t) depth >= (uint32_t) m_max_depth ||
+                    ((!is_cuda_array_v<Float> || m_max_depth < 0) && none(active)))
+                    break;
+
+                // --------------------- Emitter sampling ---------------------
+
+                BSDFContext ctx;
+                BSDFPtr bsdf = si.bsdf(ray);
+                Mask active_e = active && has_flag(bsdf->flags(), BSDFFlags::Smooth);
+
+                if (likely(any_or<true>(active_e))) {
+                    auto [ds, emitter_val] = scene->sample_emitter_direction(
+                        si, sampler->next_2d(active_e), true, active_e);
+                    active_e &= neq(ds.pdf, 0.f);
+
+                    Vector3f wo = si.to_local(ds.d);
+                    auto [bsdf_val, bsdf_pdf] = bsdf->eval_pdf(ctx, si, wo, active_e);
+                    bsdf_val = si.to_world_mueller(bsdf_val, -wo, si.wi);
+
+                    Float mis = select(ds.delta, 1.f, mis_weight(ds.pdf, bsdf_pdf));
+                    Spectrum contrib = mis * throughput * bsdf_val * emitter_val;
+                    objective[active_e] +=
+                        hsum(depolarize(contrib) * depolarize(adjoint));
+                }
+
+                // ----------------------- BSDF sampling ----------------------
+
+                MTS_STAT_ADD(BSDFSamples, count(active));
+                auto [bs, bsdf_val] = bsdf->sample(ctx, si, sampler->next_1d(active),
+                                                   sampler->next_2d(active), active);
+                bsdf_val = si.to_world_mueller(bsdf_val, -bs.wo, si.wi);
+
+                /* The path throughput stays detached -- gradients only flow
+                   through the local evaluations above */
+                throughput = throughput * detach_spec(bsdf_val);
+                active &= any(neq(depolarize(throughput), 0.f));
+                if (none_or<false>(active))
+                    break;
+
+                eta *= bs.eta;
+
+                ray = si.spawn_ray(si.to_world(bs.wo));
+                SurfaceInteraction3f si_bsdf = scene->ray_intersect(ray, active);
+
+                emitter = si_bsdf.emitter(scene, active);
+                DirectionSample3f ds(si_bsdf, si);
+                ds.object = emitter;
+
+                if (any_or<true>(neq(emitter, nullptr))) {
+                    Float emitter_pdf =
+                        select(has_flag(bs.sampled_type, BSDFFlags::Delta), 0.f,
+                               scene->pdf_emitter_direction(si, ds, active));
+
+                    emission_weight = mis_weight(bs.pdf, emitter_pdf);
+                }
+
+                si = std::move(si_bsdf);
+            }
+
+            if (requires_gradient(objective)) {
+                Float objective_sum = hsum(objective);
+                backward(objective_sum);
+            }
+        }
+    }
+
+    //! @}
+    // =============================================================
+
+    std::string to_string() const override {
+        return tfm::format("RadiativeBackpropIntegrator[\n"
+            "  max_depth = %i,\n"
+            "  rr_depth = %i\n"
+            "]", m_max_depth, m_rr_depth);
+    }
+
+    Float mis_weight(Float pdf_a, Float pdf_b) const {
+        pdf_a *= pdf_a;
+        pdf_b *= pdf_b;
+        return select(pdf_a > 0.f, pdf_a / (pdf_a + pdf_b), 0.f);
+    }
+
+    MTS_DECLARE_CLASS()
+private:
+    /// Strip gradient tracking from a value (no-op in non-autodiff variants)
+    template <typename Value> static Value detach_spec(const Value &value) {
+        if constexpr (is_diff_array_v<Float>)
+            return Value(detach(value));
+        else
+            return value;
+    }
+};
+
+MTS_IMPLEMENT_CLASS_VARIANT(RadiativeBackpropIntegrator, MonteCarloIntegrator)
+MTS_EXPORT_PLUGIN(RadiativeBackpropIntegrator, "Radiative backpropagation integrator");
+NAMESPACE_END(mitsuba)
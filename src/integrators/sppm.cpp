@@ -0,0 +1,650 @@
+#include <atomic>
+#include <memory>
+
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+
+#include <enoki/stl.h>
+#include <mitsuba/core/profiler.h>
+#include <mitsuba/core/progress.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/ray.h>
+#include <mitsuba/core/thread.h>
+#include <mitsuba/core/util.h>
+#include <mitsuba/render/bsdf.h>
+#include <mitsuba/render/emitter.h>
+#include <mitsuba/render/film.h>
+#include <mitsuba/render/integrator.h>
+#include <mitsuba/render/records.h>
+#include <mitsuba/render/sensor.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _integrator-sppm:
+
+Stochastic progressive photon mapper (:monosp:`sppm`)
+-----------------------------------------------------
+
+.. pluginparameters::
+
+ * - max_depth
+   - |int|
+   - Longest camera or photon subpath depth (where -1 corresponds to
+     :math:`\infty`). (Default: -1)
+ * - rr_depth
+   - |int|
+   - Minimum path depth, after which the implementation will start to use the
+     *russian roulette* path termination criterion. (Default: 5)
+ * - photon_count
+   - |int|
+   - Number of photon paths emitted in each iteration. (Default: 250000)
+ * - initial_radius
+   - |float|
+   - Initial photon gather radius in world-space units. The default value of
+     zero derives a radius from the scene bounding box and the film
+     resolution.
+ * - alpha
+   - |float|
+   - Radius reduction parameter of the progressive estimator; smaller values
+     shrink the gather radius more aggressively, trading noise for a faster
+     decay of the residual bias. (Default: 0.7)
+
+This integrator implements stochastic progressive photon mapping
+(Hachisuka and Jensen, "Stochastic Progressive Photon Mapping",
+SIGGRAPH Asia 2009). Rendering alternates between two passes: a camera pass
+that traces each pixel through perfectly specular interactions until the
+first non-delta surface, where a *gather point* is recorded, and a photon
+pass that emits photon paths from the light sources and splats their energy
+onto all gather points within a per-pixel search radius. The radius shrinks
+from one iteration to the next, so the estimate converges to the correct
+result in the limit while remaining robust where unbiased path sampling is
+hopeless---most notably specular-diffuse-specular transport such as
+caustics seen through the :ref:`dielectric <bsdf-dielectric>` interface of
+a pool or a glass object.
+
+Photons are deposited into per-thread arenas during the photon pass and
+then merged into a lock-free spatial hash grid: each cell stores the head
+of an index-linked photon list, and insertion is a single atomic exchange.
+The grid covers only the region occupied by the current gather points, so
+its resolution adapts to the camera-visible part of the scene.
+
+The number of iterations is taken from the sampler's sample count, i.e. a
+setting of 64 samples per pixel performs 64 camera and photon passes. The
+film is updated after every iteration, which makes the progression visible
+in preview renders.
+
+.. note:: This integrator is currently restricted to the scalar RGB and
+   monochrome variants. It does not handle participating media, and cannot
+   be combined with adaptive sampling (the estimator is biased, and its
+   residual error is not captured by the sample variance).
+
+ */
+
+template <typename Float, typename Spectrum>
+class SPPMIntegrator final : public MonteCarloIntegrator<Float, Spectrum> {
+public:
+    MTS_IMPORT_BASE(MonteCarloIntegrator, should_stop, m_stop, m_max_depth,
+                    m_rr_depth, rr_prob, m_render_timer, m_seed_offset)
+    MTS_IMPORT_TYPES(Scene, Sensor, Film, ImageBlock, Sampler, Emitter,
+                     EmitterPtr, BSDF, BSDFPtr)
+
+    /// Per-pixel state of the progressive estimator
+    struct GatherPoint {
+        /// Interaction at the first non-delta surface of this iteration
+        SurfaceInteraction3f si;
+        /// Camera path weight up to (and including) the gather surface
+        Spectrum throughput = 0.f;
+        /// Running sum of directly observed emission (averaged at the end)
+        Spectrum emitted = 0.f;
+        /// Accumulated (unnormalized) photon flux
+        Spectrum tau = 0.f;
+        /// Current squared gather radius
+        Float radius2 = 0.f;
+        /// Accumulated photon count after the \c alpha reduction
+        Float n = 0.f;
+        /// Running sum of per-iteration alpha values
+        Float alpha_accum = 0.f;
+        /// Did the camera pass of this iteration record a usable surface?
+        bool valid = false;
+    };
+
+    /// A photon deposited on a non-delta surface during the photon pass
+    struct PhotonRecord {
+        /// Position on the surface
+        Point3f p;
+        /// Direction of propagation at the time of deposition
+        Vector3f d;
+        /// Accumulated power of the photon path
+        Spectrum power;
+        /// Next entry of the containing hash grid cell's linked list
+        uint32_t next;
+    };
+
+    static constexpr uint32_t InvalidIndex = (uint32_t) -1;
+
+    SPPMIntegrator(const Properties &props) : Base(props) {
+        m_photon_count   = (uint32_t) props.size_("photon_count", 250000);
+        m_initial_radius = props.float_("initial_radius", 0.f);
+        m_alpha          = props.float_("alpha", .7f);
+
+        if (m_alpha <= 0.f || m_alpha > 1.f)
+            Throw("The radius reduction parameter 'alpha' must be in (0, 1]!");
+    }
+
+    bool render(Scene *scene, Sensor *sensor) override {
+        if constexpr (is_array_v<Float> || is_spectral_v<Spectrum> ||
+                      is_polarized_v<Spectrum>) {
+            ENOKI_MARK_USED(scene);
+            ENOKI_MARK_USED(sensor);
+            Throw("SPPMIntegrator is only implemented for the scalar RGB and "
+                  "monochrome variants!");
+        } else {
+            ScopedPhase sp(ProfilerPhase::Render);
+            m_stop = false;
+
+            if (scene->emitters().empty())
+                Throw("SPPMIntegrator requires a scene with at least one "
+                      "emitter!");
+
+            ref<Film> film = sensor->film();
+            ScalarVector2i film_size = film->crop_size();
+            ScalarPoint2i crop_offset = film->crop_offset();
+            size_t pixel_count = (size_t) hprod(film_size);
+
+            size_t iterations = sensor->sampler()->sample_count();
+
+            ScalarFloat radius = m_initial_radius;
+            if (radius == 0.f) {
+                /* Heuristic initial radius: a few pixels' worth of footprint
+                   at the scale of the scene */
+                ScalarBoundingBox3f bbox = scene->bbox();
+                radius = norm(bbox.extents()) * 5.f /
+                         (ScalarFloat) hmax(film_size);
+            }
+
+            std::vector<std::string> channels;
+            for (size_t i = 0; i < 5; ++i)
+                channels.emplace_back(1, "XYZAW"[i]);
+
+            Log(Info, "Starting render job (%ix%i, %i iteration%s, %i "
+                "photons/iteration, %i thread%s)",
+                film_size.x(), film_size.y(), iterations,
+                iterations == 1 ? "" : "s", m_photon_count,
+                __global_thread_count, __global_thread_count == 1 ? "" : "s");
+
+            std::vector<GatherPoint> gather_points(pixel_count);
+            for (GatherPoint &gp : gather_points)
+                gp.radius2 = sqr(radius);
+
+            ref<ProgressReporter> progress = new ProgressReporter("Rendering");
+            ThreadEnvironment env;
+            m_render_timer.reset();
+
+            size_t iterations_done = 0;
+            for (size_t it = 0; it < iterations && !should_stop(); ++it) {
+                camera_pass(scene, sensor, env, gather_points, it);
+                if (should_stop())
+                    break;
+
+                photon_pass(scene, sensor, env, gather_points, it);
+                ++iterations_done;
+
+                develop(film, channels, env, gather_points, crop_offset,
+                        film_size, iterations_done);
+                progress->update(iterations_done / (float) iterations);
+            }
+
+            if (!m_stop && iterations_done > 0)
+                Log(Info, "Rendering finished. (took %s)",
+                    util::time_string(m_render_timer.value(), true));
+
+            return !m_stop && iterations_done > 0;
+        }
+    }
+
+    std::string to_string() const override {
+        return tfm::format("SPPMIntegrator[\n"
+            "  max_depth = %i,\n"
+            "  rr_depth = %i,\n"
+            "  photon_count = %i,\n"
+            "  initial_radius = %f,\n"
+            "  alpha = %f\n"
+            "]", m_max_depth, m_rr_depth, m_photon_count, m_initial_radius,
+            m_alpha);
+    }
+
+    MTS_DECLARE_CLASS()
+
+protected:
+    /**
+     * \brief Trace one camera path per pixel through perfectly specular
+     * interactions and record a gather point at the first non-delta surface
+     *
+     * Emission observed along the specular prefix is accumulated into the
+     * pixel directly, since it cannot be recovered from the photon map.
+     */
+    void camera_pass(const Scene *scene, const Sensor *sensor,
+                     ThreadEnvironment &env,
+                     std::vector<GatherPoint> &gather_points,
+                     size_t iteration) const {
+        if constexpr (!is_array_v<Float>) {
+            ScalarVector2i film_size = sensor->film()->crop_size();
+            ScalarPoint2i crop_offset = sensor->film()->crop_offset();
+
+            tbb::parallel_for(
+                tbb::blocked_range<size_t>(0, gather_points.size(), 256),
+                [&](const tbb::blocked_range<size_t> &range) {
+                    ScopedSetThreadEnvironment set_env(env);
+                    ref<Sampler> sampler = sensor->sampler()->clone();
+                    sampler->seed(m_seed_offset +
+                                  (2 * iteration) * gather_points.size() +
+                                  range.begin());
+                    scoped_flush_denormals flush_denormals(true);
+
+                    for (size_t i = range.begin();
+                         i != range.end() && !should_stop(); ++i) {
+                        ScalarPoint2i pos(i % (size_t) film_size.x(),
+                                          i / (size_t) film_size.x());
+                        trace_gather_point(scene, sensor, sampler,
+                                           gather_points[i],
+                                           Point2f(pos) + Vector2f(crop_offset),
+                                           film_size);
+                        sampler->advance();
+                    }
+                });
+        }
+    }
+
+    /// Camera pass body for a single pixel
+    void trace_gather_point(const Scene *scene, const Sensor *sensor,
+                            Sampler *sampler, GatherPoint &gp,
+                            const Point2f &pos,
+                            const ScalarVector2i &film_size) const {
+        if constexpr (!is_array_v<Float>) {
+            Vector2f position_sample = pos + sampler->next_2d();
+
+            Point2f aperture_sample(.5f);
+            if (sensor->needs_aperture_sample())
+                aperture_sample = sampler->next_2d();
+
+            Float time = sensor->shutter_open();
+            if (sensor->shutter_open_time() > 0.f)
+                time += sampler->next_1d() * sensor->shutter_open_time();
+
+            Float wavelength_sample = sampler->next_1d();
+
+            Vector2f adjusted_position =
+                (position_sample - sensor->film()->crop_offset()) /
+                sensor->film()->crop_size();
+
+            auto [ray, throughput] = sensor->sample_ray_differential(
+                time, wavelength_sample, adjusted_position, aperture_sample);
+            ray.scale_differential(rsqrt((ScalarFloat) hprod(film_size)));
+
+            gp.valid = false;
+
+            int max_depth = m_max_depth == -1
+                ? std::numeric_limits<int>::max() : m_max_depth;
+            Float eta(1.f);
+            bool hit_anything = false;
+
+            for (int depth = 1; depth <= max_depth; ++depth) {
+                SurfaceInteraction3f si = scene->ray_intersect(ray, true);
+
+                // Directly observed emission (specular prefix included)
+                EmitterPtr emitter = si.emitter(scene);
+                if (emitter != nullptr)
+                    gp.emitted += throughput * emitter->eval(si);
+
+                if (!si.is_valid())
+                    break;
+                hit_anything = true;
+
+                BSDFPtr bsdf = si.bsdf(ray);
+                if (has_flag(bsdf->flags(), BSDFFlags::Smooth)) {
+                    /* Found a surface with a non-delta component: gather
+                       photons here instead of continuing the walk */
+                    gp.si         = si;
+                    gp.throughput = throughput;
+                    gp.valid      = true;
+                    break;
+                }
+
+                if (depth > m_rr_depth) {
+                    Float q = rr_prob(hmax(depolarize(throughput)) * sqr(eta));
+                    if (sampler->next_1d() >= q)
+                        break;
+                    throughput *= rcp(q);
+                }
+
+                auto [bs, bsdf_val] = bsdf->sample(BSDFContext(), si,
+                                                   sampler->next_1d(),
+                                                   sampler->next_2d(), true);
+                throughput = throughput * bsdf_val;
+                if (none(neq(depolarize(throughput), 0.f)))
+                    break;
+
+                eta *= bs.eta;
+                ray = RayDifferential3f(si.spawn_ray(si.to_world(bs.wo)));
+            }
+
+            gp.alpha_accum += hit_anything ? 1.f : 0.f;
+        }
+    }
+
+    /**
+     * \brief Emit photon paths, deposit photons on non-delta surfaces, and
+     * splat their energy onto the gather points
+     *
+     * Photons are collected in per-thread arenas and subsequently merged
+     * into a hash grid over the gather point region via atomic insertion
+     * into per-cell linked lists; the gather step then updates each pixel's
+     * statistics independently, so the only synchronization in the entire
+     * pass is the per-cell atomic exchange.
+     */
+    void photon_pass(const Scene *scene, const Sensor *sensor,
+                     ThreadEnvironment &env,
+                     std::vector<GatherPoint> &gather_points,
+                     size_t iteration) const {
+        if constexpr (!is_array_v<Float>) {
+            /* Bounding box of the gather points, expanded by the maximal
+               search radius; photons outside cannot contribute */
+            ScalarBoundingBox3f bbox;
+            ScalarFloat radius2_max = 0.f;
+            for (const GatherPoint &gp : gather_points) {
+                if (!gp.valid)
+                    continue;
+                bbox.expand(gp.si.p);
+                radius2_max = max(radius2_max, gp.radius2);
+            }
+            if (!bbox.valid())
+                return;
+
+            ScalarFloat radius_max = sqrt(radius2_max);
+            bbox.min -= radius_max;
+            bbox.max += radius_max;
+
+            // --------------------- Photon tracing ------------------------
+
+            tbb::enumerable_thread_specific<std::vector<PhotonRecord>> arenas;
+
+            tbb::parallel_for(
+                tbb::blocked_range<size_t>(0, (size_t) m_photon_count, 256),
+                [&](const tbb::blocked_range<size_t> &range) {
+                    ScopedSetThreadEnvironment set_env(env);
+                    ref<Sampler> sampler = sensor->sampler()->clone();
+                    sampler->seed(m_seed_offset +
+                                  (2 * iteration + 1) * (size_t) m_photon_count +
+                                  range.begin());
+                    scoped_flush_denormals flush_denormals(true);
+
+                    std::vector<PhotonRecord> &arena = arenas.local();
+                    for (size_t i = range.begin();
+                         i != range.end() && !should_stop(); ++i) {
+                        trace_photon(scene, sensor, sampler, bbox, arena);
+                        sampler->advance();
+                    }
+                });
+
+            if (should_stop())
+                return;
+
+            // ------------- Merge the arenas into the hash grid ------------
+
+            size_t photon_total = 0;
+            for (const auto &arena : arenas)
+                photon_total += arena.size();
+
+            std::vector<PhotonRecord> photons;
+            photons.reserve(photon_total);
+            for (auto &arena : arenas)
+                photons.insert(photons.end(), arena.begin(), arena.end());
+
+            /* Cells are as large as the maximal search radius, so a gather
+               query overlaps at most 2 cells per axis */
+            ScalarFloat cell_size = radius_max,
+                        inv_cell_size = rcp(cell_size);
+
+            size_t table_size = math::round_to_power_of_two(
+                std::max(gather_points.size(), (size_t) 1));
+            std::unique_ptr<std::atomic<uint32_t>[]> heads(
+                new std::atomic<uint32_t>[table_size]);
+
+            tbb::parallel_for(
+                tbb::blocked_range<size_t>(0, table_size, 4096),
+                [&](const tbb::blocked_range<size_t> &range) {
+                    for (size_t i = range.begin(); i != range.end(); ++i)
+                        heads[i].store(InvalidIndex,
+                                       std::memory_order_relaxed);
+                });
+
+            /* Relaxed ordering suffices: the loops below only start after
+               the implicit join of this parallel_for */
+            tbb::parallel_for(
+                tbb::blocked_range<size_t>(0, photons.size(), 4096),
+                [&](const tbb::blocked_range<size_t> &range) {
+                    for (size_t i = range.begin(); i != range.end(); ++i) {
+                        PhotonRecord &ph = photons[i];
+                        if (!bbox.contains(ph.p))
+                            continue;
+                        size_t h = hash_cell(
+                            cell_index(ph.p, bbox, inv_cell_size),
+                            table_size);
+                        ph.next = heads[h].exchange(
+                            (uint32_t) i, std::memory_order_relaxed);
+                    }
+                });
+
+            // ------------------------- Gathering --------------------------
+
+            tbb::parallel_for(
+                tbb::blocked_range<size_t>(0, gather_points.size(), 256),
+                [&](const tbb::blocked_range<size_t> &range) {
+                    ScopedSetThreadEnvironment set_env(env);
+                    scoped_flush_denormals flush_denormals(true);
+                    for (size_t i = range.begin(); i != range.end(); ++i)
+                        gather(gather_points[i], photons, heads.get(),
+                               table_size, bbox, inv_cell_size);
+                });
+        }
+    }
+
+    /// Trace a single photon path, depositing photons into \c arena
+    void trace_photon(const Scene *scene, const Sensor *sensor,
+                      Sampler *sampler, const ScalarBoundingBox3f &bbox,
+                      std::vector<PhotonRecord> &arena) const {
+        if constexpr (!is_array_v<Float>) {
+            auto &emitters = scene->emitters();
+
+            /* Uniform emitter selection, mirroring the light subpath
+               generation of the bidirectional path tracer */
+            uint32_t n_emitters = (uint32_t) emitters.size(),
+                     index = min((uint32_t)(sampler->next_1d() * n_emitters),
+                                 n_emitters - 1);
+
+            Float time = sensor->shutter_open();
+            if (sensor->shutter_open_time() > 0.f)
+                time += sampler->next_1d() * sensor->shutter_open_time();
+
+            auto [ray_, power] = emitters[index]->sample_ray(
+                time, sampler->next_1d(), sampler->next_2d(),
+                sampler->next_2d());
+            power *= (ScalarFloat) n_emitters;
+            if (none(neq(depolarize(power), 0.f)))
+                return;
+
+            RayDifferential3f ray(ray_);
+
+            int max_depth = m_max_depth == -1
+                ? std::numeric_limits<int>::max() : m_max_depth;
+            Float eta(1.f);
+
+            for (int depth = 1; depth <= max_depth; ++depth) {
+                SurfaceInteraction3f si = scene->ray_intersect(ray, true);
+                if (!si.is_valid())
+                    break;
+
+                BSDFPtr bsdf = si.bsdf(ray);
+                if (has_flag(bsdf->flags(), BSDFFlags::Smooth) &&
+                    bbox.contains(si.p))
+                    arena.push_back(
+                        PhotonRecord{ si.p, ray.d, power, InvalidIndex });
+
+                if (depth > m_rr_depth) {
+                    Float q = rr_prob(hmax(depolarize(power)) * sqr(eta));
+                    if (sampler->next_1d() >= q)
+                        break;
+                    power *= rcp(q);
+                }
+
+                auto [bs, bsdf_val] = bsdf->sample(
+                    BSDFContext(TransportMode::Importance), si,
+                    sampler->next_1d(), sampler->next_2d(), true);
+                power = power * bsdf_val;
+                if (none(neq(depolarize(power), 0.f)))
+                    break;
+
+                eta *= bs.eta;
+                ray = RayDifferential3f(si.spawn_ray(si.to_world(bs.wo)));
+            }
+        }
+    }
+
+    /**
+     * \brief Collect the photons within a gather point's search radius and
+     * apply the progressive radius/flux update
+     */
+    void gather(GatherPoint &gp, const std::vector<PhotonRecord> &photons,
+                const std::atomic<uint32_t> *heads, size_t table_size,
+                const ScalarBoundingBox3f &bbox,
+                ScalarFloat inv_cell_size) const {
+        if constexpr (!is_array_v<Float>) {
+            if (!gp.valid)
+                return;
+
+            Float radius = sqrt(gp.radius2);
+            ScalarPoint3i c_min = cell_index(gp.si.p - Vector3f(radius),
+                                             bbox, inv_cell_size),
+                          c_max = cell_index(gp.si.p + Vector3f(radius),
+                                             bbox, inv_cell_size);
+
+            Spectrum phi(0.f);
+            Float m = 0.f;
+
+            for (int z = c_min.z(); z <= c_max.z(); ++z) {
+                for (int y = c_min.y(); y <= c_max.y(); ++y) {
+                    for (int x = c_min.x(); x <= c_max.x(); ++x) {
+                        uint32_t idx = heads[hash_cell(
+                            ScalarPoint3i(x, y, z), table_size)].load(
+                                std::memory_order_relaxed);
+                        while (idx != InvalidIndex) {
+                            const PhotonRecord &ph = photons[idx];
+                            idx = ph.next;
+                            if (squared_norm(ph.p - gp.si.p) > gp.radius2)
+                                continue;
+
+                            /* Evaluate the BSDF for the photon's incident
+                               direction. \ref BSDF::eval() includes the
+                               cosine w.r.t. its 'wo' argument, which must
+                               be removed: the photon power already measures
+                               the flux arriving at the surface */
+                            Vector3f wo = gp.si.to_local(-ph.d);
+                            Float cos_wo = abs(Frame3f::cos_theta(wo));
+                            if (cos_wo <= math::Epsilon<Float>)
+                                continue;
+
+                            Spectrum f = gp.si.bsdf()->eval(
+                                BSDFContext(), gp.si, wo, true);
+                            if (none(neq(depolarize(f), 0.f)))
+                                continue;
+
+                            phi += ph.power * f / cos_wo;
+                            m += 1.f;
+                        }
+                    }
+                }
+            }
+
+            if (m > 0.f) {
+                /* Progressive update (Hachisuka and Jensen 2009): shrink
+                   the radius, and scale the accumulated flux so that its
+                   density w.r.t. the disc area stays consistent */
+                Float n_new = gp.n + m_alpha * m,
+                      ratio = n_new / (gp.n + m);
+                gp.tau     = (gp.tau + gp.throughput * phi) * ratio;
+                gp.radius2 *= ratio;
+                gp.n       = n_new;
+            }
+        }
+    }
+
+    /// Write the current per-pixel estimates to the film
+    void develop(Film *film, const std::vector<std::string> &channels,
+                 ThreadEnvironment &env,
+                 const std::vector<GatherPoint> &gather_points,
+                 const ScalarPoint2i &crop_offset,
+                 const ScalarVector2i &film_size,
+                 size_t iterations_done) const {
+        if constexpr (!is_array_v<Float>) {
+            film->prepare(channels);
+
+            ref<ImageBlock> block = new ImageBlock(
+                film_size, channels.size(), film->reconstruction_filter());
+            block->set_offset(crop_offset);
+            block->clear();
+
+            ENOKI_MARK_USED(env);
+            ScalarFloat inv_iter = rcp((ScalarFloat) iterations_done),
+                        inv_emitted = rcp((ScalarFloat) iterations_done *
+                                          (ScalarFloat) m_photon_count);
+
+            /* Neighboring pixels write to overlapping filter footprints, so
+               this final reconstruction step runs single-threaded; its cost
+               is negligible next to the two tracing passes */
+            for (size_t i = 0; i < gather_points.size(); ++i) {
+                const GatherPoint &gp = gather_points[i];
+
+                Spectrum value = gp.emitted * inv_iter +
+                    gp.tau * inv_emitted *
+                    rcp(math::Pi<ScalarFloat> * gp.radius2);
+
+                Point2f pos = Point2f(i % (size_t) film_size.x(),
+                                      i / (size_t) film_size.x()) +
+                              Vector2f(.5f) + Vector2f(crop_offset);
+
+                block->put(pos, zero<Wavelength>(), value,
+                           gp.alpha_accum * inv_iter);
+            }
+
+            film->put(block);
+        }
+    }
+
+    /// Integer cell coordinates of a position within the grid bounds
+    ScalarPoint3i cell_index(const ScalarPoint3f &p,
+                             const ScalarBoundingBox3f &bbox,
+                             ScalarFloat inv_cell_size) const {
+        return ScalarPoint3i(floor((p - bbox.min) * inv_cell_size));
+    }
+
+    /// Hash a cell coordinate into the grid table
+    static size_t hash_cell(const ScalarPoint3i &c, size_t table_size) {
+        return (size_t) (((uint32_t) c.x() * 73856093u) ^
+                         ((uint32_t) c.y() * 19349663u) ^
+                         ((uint32_t) c.z() * 83492791u)) & (table_size - 1);
+    }
+
+private:
+    /// Number of photon paths emitted per iteration
+    uint32_t m_photon_count;
+    /// Initial gather radius (0: derive from the scene bounds)
+    ScalarFloat m_initial_radius;
+    /// Radius reduction parameter of the progressive estimator
+    ScalarFloat m_alpha;
+};
+
+MTS_IMPLEMENT_CLASS_VARIANT(SPPMIntegrator, MonteCarloIntegrator)
+MTS_EXPORT_PLUGIN(SPPMIntegrator, "Stochastic Progressive Photon Mapper");
+NAMESPACE_END(mitsuba)
@@ -293,6 +293,30 @@ public:
             Mask active_medium  = active && neq(medium, nullptr);
             Mask active_surface = active && !active_medium;
             SurfaceInteraction3f si_medium;
+            if (any_or<true>(active_medium)) {
+                /* Media providing a dedicated transmittance estimator (e.g.
+                   residual ratio tracking) consume the entire in-medium
+                   segment at once instead of tracking collision by collision */
+                Mask use_estimator =
+                    active_medium && medium->has_dedicated_transmittance();
+                if (any_or<true>(use_estimator)) {
+                    Mask intersect = needs_intersection && use_estimator;
+                    if (any_or<true>(intersect))
+                        masked(si, intersect) = scene->ray_intersect(ray, intersect);
+                    needs_intersection &= !use_estimator;
+
+                    Ray3f tr_ray = ray;
+                    masked(tr_ray.maxt, use_estimator) = min(ray.maxt, si.t);
+                    auto tr = medium->eval_transmittance(tr_ray, sampler,
+                                                         channel, use_estimator);
+                    masked(transmittance, use_estimator) *= tr;
+
+                    /* The whole segment has been accounted for -- continue
+                       at the surface as if the medium had been escaped */
+                    escaped_medium |= use_estimator;
+                    active_medium &= !use_estimator;
+                }
+            }
             if (any_or<true>(active_medium)) {
                 auto mi = medium->sample_interaction(ray, sampler->next_1d(active_medium), channel, active_medium);
                 masked(ray.maxt, active_medium && medium->is_homogeneous() && mi.is_valid()) = mi.t;
@@ -311,7 +335,7 @@ public:
                 }
 
                 needs_intersection &= !active_medium;
-                escaped_medium = active_medium && !mi.is_valid();
+                escaped_medium |= active_medium && !mi.is_valid();
                 active_medium &= mi.is_valid();
                 masked(total_dist, active_medium) += mi.t;
 
@@ -69,7 +69,9 @@ public:
         std::conditional_t<SpectralMis, Matrix<Float, array_size_v<UnpolarizedSpectrum>>,
                            UnpolarizedSpectrum>;
 
-    VolumetricNullPathIntegratorImpl(const Properties &props) : Base(props) {}
+    VolumetricNullPathIntegratorImpl(const Properties &props) : Base(props) {
+        m_equiangular = props.bool_("equiangular", false);
+    }
 
     MTS_INLINE
     Float index_spectrum(const UnpolarizedSpectrum &spec, const UInt32 &idx) const {
@@ -93,6 +95,21 @@ public:
             Throw("This integrator currently does not support polarized mode!");
         }
 
+        /* Scenes without participating media dispatch to an instantiation of
+           the sampling loop in which the medium bookkeeping (free-flight
+           sampling, transmittance weights, medium transitions) is pruned at
+           compile time instead of being masked out at every bounce */
+        if (scene->has_media())
+            return sample_impl<true>(scene, sampler, ray_, active);
+        else
+            return sample_impl<false>(scene, sampler, ray_, active);
+    }
+
+    template <bool HasMedia>
+    std::pair<Spectrum, Mask> sample_impl(const Scene *scene,
+                                          Sampler *sampler,
+                                          const RayDifferential3f &ray_,
+                                          Mask active) const {
         // If there is an environment emitter and emitters are visible: all rays will be valid
         // Otherwise, it will depend on whether a valid interaction is sampled
         Mask valid_ray = !m_hide_emitters && neq(scene->environment(), nullptr);
@@ -143,104 +160,155 @@ public:
                 break;
 
             // ----------------------- Sampling the RTE -----------------------
-            Mask active_medium  = active && neq(medium, nullptr);
+            Mask active_medium = false;
+            if constexpr (HasMedia)
+                active_medium = active && neq(medium, nullptr);
             Mask active_surface = active && !active_medium;
-            Mask act_null_scatter = false, act_medium_scatter = false,
-                 escaped_medium = false;
+            Mask escaped_medium = false;
             Interaction3f last_scatter_event;
 
-            // If the medium does not have a spectrally varying extinction,
-            // we can perform a few optimizations to speed up rendering
-            Mask is_spectral = active_medium;
-            Mask not_spectral = false;
-            if (any_or<true>(active_medium)) {
-                is_spectral &= medium->has_spectral_extinction();
-                not_spectral = !is_spectral && active_medium;
-            }
+            if constexpr (HasMedia) {
+                Mask act_null_scatter = false, act_medium_scatter = false;
 
-            if (any_or<true>(active_medium)) {
-                mi = medium->sample_interaction(ray, sampler->next_1d(active_medium), channel, active_medium);
-                masked(ray.maxt, active_medium && medium->is_homogeneous() && mi.is_valid()) = mi.t;
-                Mask intersect = needs_intersection && active_medium;
-                if (any_or<true>(intersect))
-                    masked(si, intersect) = scene->ray_intersect(ray, intersect);
-                needs_intersection &= !active_medium;
-                masked(mi.t, active_medium && (si.t < mi.t)) = math::Infinity<Float>;
-
-                if (any_or<true>(is_spectral)) {
-                    auto [tr, free_flight_pdf] = medium->eval_tr_and_pdf(mi, si, is_spectral);
-                    update_weights(p_over_f, free_flight_pdf, tr, channel, is_spectral);
-                    update_weights(p_over_f_nee, free_flight_pdf, tr, channel, is_spectral);
+                // If the medium does not have a spectrally varying extinction,
+                // we can perform a few optimizations to speed up rendering
+                Mask is_spectral = active_medium;
+                Mask not_spectral = false;
+                if (any_or<true>(active_medium)) {
+                    is_spectral &= medium->has_spectral_extinction();
+                    not_spectral = !is_spectral && active_medium;
                 }
-                escaped_medium = active_medium && !mi.is_valid();
-                active_medium &= mi.is_valid();
-                is_spectral &= active_medium;
-                not_spectral &= active_medium;
-            }
 
-            if (any_or<true>(active_medium)) {
-                Mask null_scatter = sampler->next_1d(active_medium) >= index_spectrum(mi.sigma_t, channel) / index_spectrum(mi.combined_extinction, channel);
-                act_null_scatter |= null_scatter && active_medium;
-                act_medium_scatter |= !act_null_scatter && active_medium;
+                if (any_or<true>(active_medium)) {
+                    Float dist_sample = sampler->next_1d(active_medium);
+
+                    // Equi-angular sampling: anchor a second distance-sampling
+                    // strategy at a position sampled on an emitter and combine it
+                    // with transmittance sampling as a one-sample MIS mixture.
+                    // Only used in homogeneous media, where the density of the
+                    // transmittance-sampled distance is available in closed form.
+                    Mask ea = false, ea_used = false, ea_scattered = false;
+                    Point3f ea_pivot(0.f);
+                    Float t_query(math::Infinity<Float>);
+                    if (m_equiangular) {
+                        ea = active_medium && medium->is_homogeneous();
+                        if (any_or<true>(ea)) {
+                            Interaction3f ref_it;
+                            ref_it.p           = ray.o;
+                            ref_it.time        = ray.time;
+                            ref_it.wavelengths = ray.wavelengths;
+                            DirectionSample3f ds = scene->sample_emitter_direction(
+                                ref_it, sampler->next_2d(ea), false, ea).first;
+                            ea &= neq(ds.pdf, 0.f) && enoki::isfinite(ds.dist);
+                            ea_pivot = ds.p;
+                            ea_used  = ea && sampler->next_1d(ea) < .5f;
+                        }
+                    }
+
+                    mi = medium->sample_interaction(ray, dist_sample, channel,
+                                                    active_medium && !ea_used);
+                    if (any_or<true>(ea_used))
+                        masked(mi, ea_used) = medium->sample_interaction_equiangular(
+                            ray, ea_pivot, dist_sample, ea_used);
 
-                // Count this as a bounce
-                masked(depth, act_medium_scatter) += 1;
-                masked(last_scatter_event, act_medium_scatter) = mi;
+                    Ray3f ray_full = ray;
+                    masked(ray.maxt, active_medium && medium->is_homogeneous() && mi.is_valid()) = mi.t;
+                    Mask intersect = needs_intersection && active_medium;
+                    if (any_or<true>(intersect))
+                        masked(si, intersect) = scene->ray_intersect(ray, intersect);
+                    needs_intersection &= !active_medium;
 
-                active &= depth < (uint32_t) m_max_depth;
-                act_medium_scatter &= active;
-                specular_chain = specular_chain && !act_medium_scatter;
+                    // Mixture lanes cannot use the cancellation-based shortcut
+                    // below and always go through the explicit pdf bookkeeping
+                    is_spectral |= ea;
+                    not_spectral = !is_spectral && active_medium;
 
+                    masked(t_query, ea) = min(mi.t, si.t);
+                    ea_scattered = ea && (mi.t < si.t);
+                    masked(mi.t, active_medium && (si.t < mi.t)) = math::Infinity<Float>;
 
-                if (any_or<true>(act_null_scatter)) {
                     if (any_or<true>(is_spectral)) {
-                        update_weights(p_over_f, mi.sigma_n / mi.combined_extinction, mi.sigma_n, channel, is_spectral && act_null_scatter);
-                        update_weights(p_over_f_nee, 1.0f, mi.sigma_n, channel, is_spectral && act_null_scatter);
-                    }
-                    if (any_or<true>(not_spectral)) {
-                       update_weights(p_over_f, mi.sigma_n, mi.sigma_n, channel, not_spectral && act_null_scatter);
-                       update_weights(p_over_f_nee, 1.0f, mi.sigma_n / mi.combined_extinction, channel, not_spectral && act_null_scatter);
+                        auto [tr, free_flight_pdf] = medium->eval_tr_and_pdf(mi, si, is_spectral);
+                        UnpolarizedSpectrum pdf = free_flight_pdf;
+                        if (any_or<true>(ea)) {
+                            auto [ea_pdf, ea_beyond] = medium->pdf_equiangular(
+                                ray_full, ea_pivot, t_query, ea);
+                            masked(pdf, ea) = .5f * (free_flight_pdf +
+                                                     select(ea_scattered, ea_pdf, ea_beyond));
+                        }
+                        update_weights(p_over_f, pdf, tr, channel, is_spectral);
+                        update_weights(p_over_f_nee, pdf, tr, channel, is_spectral);
                     }
-
-                    masked(ray.o, act_null_scatter) = mi.p;
-                    masked(ray.mint, act_null_scatter) = 0.f;
-                    masked(si.t, act_null_scatter) = si.t - mi.t;
+                    escaped_medium = active_medium && !mi.is_valid();
+                    active_medium &= mi.is_valid();
+                    is_spectral &= active_medium;
+                    not_spectral &= active_medium;
                 }
 
-                if (any_or<true>(act_medium_scatter)) {
-                    if (any_or<true>(is_spectral))
-                        update_weights(p_over_f, mi.sigma_t / mi.combined_extinction, mi.sigma_s, channel, is_spectral && act_medium_scatter);
-                    if (any_or<true>(not_spectral))
-                        update_weights(p_over_f, mi.sigma_t, mi.sigma_s, channel, not_spectral && act_medium_scatter);
-
-                    PhaseFunctionContext phase_ctx(sampler);
-                    auto phase = mi.medium->phase_function();
-
-                    // --------------------- Emitter sampling ---------------------
-                    Mask sample_emitters = mi.medium->use_emitter_sampling();
-                    valid_ray |= act_medium_scatter;
-                    Mask active_e = act_medium_scatter && sample_emitters;
-                    if (any_or<true>(active_e)) {
-                        auto [p_over_f_nee_end, p_over_f_end, emitted, wo] = sample_emitter(mi, true, scene, sampler, medium, p_over_f, channel, active_e);
-                        Float phase_val = phase->eval(phase_ctx, mi, wo, active_e);
-                        update_weights(p_over_f_nee_end, 1.0f, phase_val, channel, active_e);
-                        update_weights(p_over_f_end, phase_val, phase_val, channel, active_e);
-                        masked(result, active_e) += mis_weight(p_over_f_nee_end, p_over_f_end) * emitted;
+                if (any_or<true>(active_medium)) {
+                    Mask null_scatter = sampler->next_1d(active_medium) >= index_spectrum(mi.sigma_t, channel) / index_spectrum(mi.combined_extinction, channel);
+                    act_null_scatter |= null_scatter && active_medium;
+                    act_medium_scatter |= !act_null_scatter && active_medium;
+
+                    // Count this as a bounce
+                    masked(depth, act_medium_scatter) += 1;
+                    masked(last_scatter_event, act_medium_scatter) = mi;
+
+                    active &= depth < (uint32_t) m_max_depth;
+                    act_medium_scatter &= active;
+                    specular_chain = specular_chain && !act_medium_scatter;
+
+
+                    if (any_or<true>(act_null_scatter)) {
+                        if (any_or<true>(is_spectral)) {
+                            update_weights(p_over_f, mi.sigma_n / mi.combined_extinction, mi.sigma_n, channel, is_spectral && act_null_scatter);
+                            update_weights(p_over_f_nee, 1.0f, mi.sigma_n, channel, is_spectral && act_null_scatter);
+                        }
+                        if (any_or<true>(not_spectral)) {
+                           update_weights(p_over_f, mi.sigma_n, mi.sigma_n, channel, not_spectral && act_null_scatter);
+                           update_weights(p_over_f_nee, 1.0f, mi.sigma_n / mi.combined_extinction, channel, not_spectral && act_null_scatter);
+                        }
+
+                        masked(ray.o, act_null_scatter) = mi.p;
+                        masked(ray.mint, act_null_scatter) = 0.f;
+                        masked(si.t, act_null_scatter) = si.t - mi.t;
                     }
 
-                    // In a real interaction: reset p_over_f_nee
-                    masked(p_over_f_nee, act_medium_scatter) = p_over_f;
-
-                    // ------------------ Phase function sampling -----------------
-                    masked(phase, !act_medium_scatter) = nullptr;
-                    auto [wo, phase_pdf] = phase->sample(phase_ctx, mi, sampler->next_2d(act_medium_scatter), act_medium_scatter);
-                    Ray3f new_ray  = mi.spawn_ray(wo);
-                    new_ray.mint = 0.0f;
-                    masked(ray, act_medium_scatter) = new_ray;
-                    needs_intersection |= act_medium_scatter;
-
-                    update_weights(p_over_f, phase_pdf, phase_pdf, channel, act_medium_scatter);
-                    update_weights(p_over_f_nee, 1.f, phase_pdf, channel, act_medium_scatter);
+                    if (any_or<true>(act_medium_scatter)) {
+                        if (any_or<true>(is_spectral))
+                            update_weights(p_over_f, mi.sigma_t / mi.combined_extinction, mi.sigma_s, channel, is_spectral && act_medium_scatter);
+                        if (any_or<true>(not_spectral))
+                            update_weights(p_over_f, mi.sigma_t, mi.sigma_s, channel, not_spectral && act_medium_scatter);
+
+                        PhaseFunctionContext phase_ctx(sampler);
+                        auto phase = mi.medium->phase_function();
+
+                        // --------------------- Emitter sampling ---------------------
+                        Mask sample_emitters = mi.medium->use_emitter_sampling();
+                        valid_ray |= act_medium_scatter;
+                        Mask active_e = act_medium_scatter && sample_emitters;
+                        if (any_or<true>(active_e)) {
+                            auto [p_over_f_nee_end, p_over_f_end, emitted, wo] = sample_emitter<HasMedia>(mi, true, scene, sampler, medium, p_over_f, channel, active_e);
+                            Float phase_val = phase->eval(phase_ctx, mi, wo, active_e);
+                            update_weights(p_over_f_nee_end, 1.0f, phase_val, channel, active_e);
+                            update_weights(p_over_f_end, phase_val, phase_val, channel, active_e);
+                            masked(result, active_e) += mis_weight(p_over_f_nee_end, p_over_f_end) * emitted;
+                        }
+
+                        // In a real interaction: reset p_over_f_nee
+                        masked(p_over_f_nee, act_medium_scatter) = p_over_f;
+
+                        // ------------------ Phase function sampling -----------------
+                        masked(phase, !act_medium_scatter) = nullptr;
+                        auto [wo, phase_pdf] = phase->sample(phase_ctx, mi, sampler->next_2d(act_medium_scatter), act_medium_scatter);
+                        Ray3f new_ray  = mi.spawn_ray(wo);
+                        new_ray.mint = 0.0f;
+                        masked(ray, act_medium_scatter) = new_ray;
+                        needs_intersection |= act_medium_scatter;
+
+                        update_weights(p_over_f, phase_pdf, phase_pdf, channel, act_medium_scatter);
+                        update_weights(p_over_f_nee, 1.f, phase_pdf, channel, act_medium_scatter);
+                    }
                 }
             }
 
@@ -281,16 +349,17 @@ public:
                 BSDFPtr bsdf  = si.bsdf(ray);
                 Mask active_e = active_surface && has_flag(bsdf->flags(), BSDFFlags::Smooth) && (depth + 1 < (uint32_t) m_max_depth);
                 if (likely(any_or<true>(active_e))) {
-                    auto [p_over_f_nee_end, p_over_f_end, emitted, wo] = sample_emitter(si, false, scene, sampler, medium, p_over_f, channel, active_e);
+                    auto [p_over_f_nee_end, p_over_f_end, emitted, wo] = sample_emitter<HasMedia>(si, false, scene, sampler, medium, p_over_f, channel, active_e);
                     Vector3f wo_local       = si.to_local(wo);
-                    Spectrum bsdf_val = bsdf->eval(ctx, si, wo_local, active_e);
-                    Float bsdf_pdf =  bsdf->pdf(ctx, si, wo_local, active_e);
+                    auto [bsdf_val, bsdf_pdf] =
+                        bsdf->eval_pdf(ctx, si, wo_local, active_e);
                     update_weights(p_over_f_nee_end, 1.0f, depolarize(bsdf_val), channel, active_e);
                     update_weights(p_over_f_end, bsdf_pdf, depolarize(bsdf_val), channel, active_e);
                     masked(result, active_e) += mis_weight(p_over_f_nee_end, p_over_f_end) * emitted;
                 }
 
                 // ----------------------- BSDF sampling ----------------------
+                MTS_STAT_ADD(BSDFSamples, count(active_surface));
                 auto [bs, bsdf_weight] = bsdf->sample(ctx, si, sampler->next_1d(active_surface),
                                                    sampler->next_2d(active_surface), active_surface);
                 active_surface &= bs.pdf > 0.f;
@@ -312,8 +381,10 @@ public:
                 update_weights(p_over_f, bs.pdf, depolarize(bsdf_weight * bs.pdf), channel, active_surface);
                 update_weights(p_over_f_nee, 1.f, depolarize(bsdf_weight * bs.pdf), channel, non_null_bsdf);
 
-                Mask has_medium_trans            = active_surface && si.is_medium_transition();
-                masked(medium, has_medium_trans) = si.target_medium(ray.d);
+                if constexpr (HasMedia) {
+                    Mask has_medium_trans            = active_surface && si.is_medium_transition();
+                    masked(medium, has_medium_trans) = si.target_medium(ray.d);
+                }
             }
             active &= (active_surface | active_medium);
         }
@@ -322,6 +393,7 @@ public:
     }
 
 
+    template <bool HasMedia>
     std::tuple<WeightMatrix, WeightMatrix, Spectrum, Vector3f> sample_emitter(const Interaction3f &ref_interaction, Mask is_medium_interaction,
                 const Scene *scene, Sampler *sampler,  MediumPtr medium, const WeightMatrix &p_over_f, UInt32 channel, Mask active) const {
         using EmitterPtr = replace_scalar_t<Float, const Emitter *>;
@@ -345,45 +417,49 @@ public:
         Mask needs_intersection = true;
         while (any(active)) {
             Mask escaped_medium = false;
-            Mask active_medium  = active && neq(medium, nullptr);
+            Mask active_medium = false;
+            if constexpr (HasMedia)
+                active_medium = active && neq(medium, nullptr);
             Mask active_surface = active && !active_medium;
 
-            if (any_or<true>(active_medium)) {
-                auto mi = medium->sample_interaction(ray, sampler->next_1d(active_medium), channel, active_medium);
-                masked(ray.maxt, active_medium && medium->is_homogeneous() && mi.is_valid()) = mi.t;
-                Mask intersect = needs_intersection && active_medium;
-                if (any_or<true>(intersect))
-                    masked(si, intersect) = scene->ray_intersect(ray, intersect);
-                masked(mi.t, active_medium && (si.t < mi.t)) = math::Infinity<Float>;
-                needs_intersection &= !active_medium;
-
-                Mask is_spectral = medium->has_spectral_extinction() && active_medium;
-                Mask not_spectral = !is_spectral && active_medium;
-                if (any_or<true>(is_spectral)) {
-                    auto [tr, free_flight_pdf] = medium->eval_tr_and_pdf(mi, si, is_spectral);
-                    update_weights(p_over_f_nee, free_flight_pdf, tr, channel, is_spectral);
-                    update_weights(p_over_f_uni, free_flight_pdf, tr, channel, is_spectral);
-                }
-
-                escaped_medium = active_medium && !mi.is_valid();
-                active_medium &= mi.is_valid();
-                is_spectral &= active_medium;
-                not_spectral &= active_medium;
-
-                masked(total_dist, active_medium) += mi.t;
-
+            if constexpr (HasMedia) {
                 if (any_or<true>(active_medium)) {
-                    masked(ray.o, active_medium)    = mi.p;
-                    masked(ray.mint, active_medium) = 0.f;
-                    // Update si.t since we continue the ray into the same direction
-                    masked(si.t, active_medium) = si.t - mi.t;
+                    auto mi = medium->sample_interaction(ray, sampler->next_1d(active_medium), channel, active_medium);
+                    masked(ray.maxt, active_medium && medium->is_homogeneous() && mi.is_valid()) = mi.t;
+                    Mask intersect = needs_intersection && active_medium;
+                    if (any_or<true>(intersect))
+                        masked(si, intersect) = scene->ray_intersect(ray, intersect);
+                    masked(mi.t, active_medium && (si.t < mi.t)) = math::Infinity<Float>;
+                    needs_intersection &= !active_medium;
+
+                    Mask is_spectral = medium->has_spectral_extinction() && active_medium;
+                    Mask not_spectral = !is_spectral && active_medium;
                     if (any_or<true>(is_spectral)) {
-                        update_weights(p_over_f_nee, 1.f, mi.sigma_n, channel, is_spectral);
-                        update_weights(p_over_f_uni, mi.sigma_n / mi.combined_extinction, mi.sigma_n, channel, is_spectral);
+                        auto [tr, free_flight_pdf] = medium->eval_tr_and_pdf(mi, si, is_spectral);
+                        update_weights(p_over_f_nee, free_flight_pdf, tr, channel, is_spectral);
+                        update_weights(p_over_f_uni, free_flight_pdf, tr, channel, is_spectral);
                     }
-                    if (any_or<true>(not_spectral)) {
-                        update_weights(p_over_f_nee, 1.f, mi.sigma_n / mi.combined_extinction, channel, not_spectral);
-                        update_weights(p_over_f_uni, mi.sigma_n, mi.sigma_n, channel, not_spectral);
+
+                    escaped_medium = active_medium && !mi.is_valid();
+                    active_medium &= mi.is_valid();
+                    is_spectral &= active_medium;
+                    not_spectral &= active_medium;
+
+                    masked(total_dist, active_medium) += mi.t;
+
+                    if (any_or<true>(active_medium)) {
+                        masked(ray.o, active_medium)    = mi.p;
+                        masked(ray.mint, active_medium) = 0.f;
+                        // Update si.t since we continue the ray into the same direction
+                        masked(si.t, active_medium) = si.t - mi.t;
+                        if (any_or<true>(is_spectral)) {
+                            update_weights(p_over_f_nee, 1.f, mi.sigma_n, channel, is_spectral);
+                            update_weights(p_over_f_uni, mi.sigma_n / mi.combined_extinction, mi.sigma_n, channel, is_spectral);
+                        }
+                        if (any_or<true>(not_spectral)) {
+                            update_weights(p_over_f_nee, 1.f, mi.sigma_n / mi.combined_extinction, channel, not_spectral);
+                            update_weights(p_over_f_uni, mi.sigma_n, mi.sigma_n, channel, not_spectral);
+                        }
                     }
                 }
             }
@@ -429,9 +505,11 @@ public:
                       (any(neq(depolarize(p_over_f_uni), 0.f)) || any(neq(depolarize(p_over_f_nee), 0.f)) );
 
             // If a medium transition is taking place: Update the medium pointer
-            Mask has_medium_trans = active_surface && si.is_medium_transition();
-            if (any_or<true>(has_medium_trans)) {
-                masked(medium, has_medium_trans) = si.target_medium(ray.d);
+            if constexpr (HasMedia) {
+                Mask has_medium_trans = active_surface && si.is_medium_transition();
+                if (any_or<true>(has_medium_trans)) {
+                    masked(medium, has_medium_trans) = si.target_medium(ray.d);
+                }
             }
         }
         return { p_over_f_nee, p_over_f_uni, emitter_val, ray.d};
@@ -496,12 +574,17 @@ public:
     std::string to_string() const override {
         return tfm::format("VolumetricNullPathIntegrator[\n"
                            "  max_depth = %i,\n"
-                           "  rr_depth = %i\n"
+                           "  rr_depth = %i,\n"
+                           "  equiangular = %s\n"
                            "]",
-                           m_max_depth, m_rr_depth);
+                           m_max_depth, m_rr_depth, m_equiangular);
     }
 
     MTS_DECLARE_CLASS()
+
+protected:
+    /// Combine equi-angular and transmittance-based distance sampling?
+    bool m_equiangular;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(VolumetricNullPathIntegrator, MonteCarloIntegrator);
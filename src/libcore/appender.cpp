@@ -1,7 +1,13 @@
 #include <mitsuba/core/appender.h>
 #include <mitsuba/core/logger.h>
+#include <mitsuba/core/math.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <fstream>
+#include <mutex>
 #include <sstream>
+#include <thread>
 
 #if defined(__WINDOWS__)
 #  include <windows.h>
@@ -114,7 +120,175 @@ StreamAppender::~StreamAppender() {
     }
 }
 
+struct AsyncAppender::AsyncAppenderPrivate {
+    struct Record {
+        LogLevel level;
+        std::string text;
+    };
+
+    /* Bounded multi-producer queue: each cell carries a sequence number
+       that encodes whether it is currently available to producers or to
+       the consumer (Vyukov-style). Producers never take a lock; all
+       dequeue operations happen while holding \ref mutex. */
+    struct Cell {
+        std::atomic<size_t> sequence;
+        Record record;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask = 0;
+    bool block_on_overflow = false;
+
+    std::atomic<size_t> enqueue_pos { 0 },
+                        dequeue_pos { 0 },
+                        dropped     { 0 };
+    std::atomic<bool> shutdown { false };
+
+    /// Serializes the writer thread with synchronous (Warn/Error) dispatch
+    std::mutex mutex;
+    std::condition_variable wake, drained;
+    std::thread worker;
+
+    bool try_enqueue(LogLevel level, const std::string &text) {
+        Cell *cell;
+        size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+
+        while (true) {
+            cell = &cells[pos & mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+
+            if (diff == 0) {
+                if (enqueue_pos.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                return false; // queue is full
+            } else {
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->record.level = level;
+        cell->record.text  = text;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Must be called while holding \ref mutex
+    bool try_dequeue(Record &r) {
+        size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+        Cell *cell = &cells[pos & mask];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+
+        if ((intptr_t) seq - (intptr_t) (pos + 1) < 0)
+            return false; // queue is empty
+
+        r.level = cell->record.level;
+        r.text  = std::move(cell->record.text);
+        cell->sequence.store(pos + mask + 1, std::memory_order_release);
+        dequeue_pos.store(pos + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool empty() const {
+        return enqueue_pos.load(std::memory_order_acquire) ==
+               dequeue_pos.load(std::memory_order_acquire);
+    }
+};
+
+AsyncAppender::AsyncAppender(Appender *nested, size_t capacity,
+                             bool block_on_overflow)
+    : m_nested(nested), d(new AsyncAppenderPrivate()) {
+    capacity = math::round_to_power_of_two(std::max(capacity, (size_t) 2));
+
+    d->cells.reset(new AsyncAppenderPrivate::Cell[capacity]);
+    for (size_t i = 0; i < capacity; ++i)
+        d->cells[i].sequence.store(i, std::memory_order_relaxed);
+    d->mask = capacity - 1;
+    d->block_on_overflow = block_on_overflow;
+
+    d->worker = std::thread([this] {
+        std::unique_lock<std::mutex> guard(d->mutex);
+
+        while (true) {
+            AsyncAppenderPrivate::Record r;
+            while (d->try_dequeue(r))
+                m_nested->append(r.level, r.text);
+
+            size_t dropped = d->dropped.exchange(0);
+            if (unlikely(dropped > 0))
+                m_nested->append(Warn,
+                    tfm::format("AsyncAppender: dropped %i log message(s) "
+                                "due to queue overflow", dropped));
+
+            d->drained.notify_all();
+
+            if (d->shutdown.load(std::memory_order_acquire))
+                break;
+
+            /* The timeout bounds the delivery latency in case a wake-up
+               notification raced with the drain loop above */
+            d->wake.wait_for(guard, std::chrono::milliseconds(100));
+        }
+    });
+}
+
+AsyncAppender::~AsyncAppender() {
+    d->shutdown.store(true, std::memory_order_release);
+    d->wake.notify_all();
+    d->worker.join();
+}
+
+void AsyncAppender::append(LogLevel level, const std::string &text) {
+    if (unlikely(level >= Warn)) {
+        /* Important messages skip the queue: drain the backlog to preserve
+           ordering and deliver synchronously */
+        std::lock_guard<std::mutex> guard(d->mutex);
+        AsyncAppenderPrivate::Record r;
+        while (d->try_dequeue(r))
+            m_nested->append(r.level, r.text);
+        m_nested->append(level, text);
+        return;
+    }
+
+    while (!d->try_enqueue(level, text)) {
+        if (!d->block_on_overflow) {
+            d->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        std::this_thread::yield();
+    }
+
+    d->wake.notify_one();
+}
+
+void AsyncAppender::log_progress(float progress, const std::string &name,
+    const std::string &formatted, const std::string &eta, const void *ptr) {
+    std::lock_guard<std::mutex> guard(d->mutex);
+    m_nested->log_progress(progress, name, formatted, eta, ptr);
+}
+
+void AsyncAppender::flush() {
+    std::unique_lock<std::mutex> guard(d->mutex);
+    d->wake.notify_all();
+    d->drained.wait(guard, [this] {
+        return d->empty() && d->dropped.load(std::memory_order_acquire) == 0;
+    });
+}
+
+std::string AsyncAppender::to_string() const {
+    std::ostringstream oss;
+    oss << "AsyncAppender[" << std::endl
+        << "  capacity = " << (d->mask + 1) << "," << std::endl
+        << "  block_on_overflow = " << d->block_on_overflow << "," << std::endl
+        << "  nested = " << string::indent(m_nested->to_string()) << std::endl
+        << "]";
+    return oss.str();
+}
+
 MTS_IMPLEMENT_CLASS(Appender, Object)
 MTS_IMPLEMENT_CLASS(StreamAppender, Appender)
+MTS_IMPLEMENT_CLASS(AsyncAppender, Appender)
 
 NAMESPACE_END(mitsuba)
@@ -6,7 +6,9 @@
 #include <mitsuba/core/rfilter.h>
 #include <mitsuba/core/transform.h>
 #include <mitsuba/core/fstream.h>
+#include <mitsuba/core/thread.h>
 #include <tbb/tbb.h>
+#include <mutex>
 #include <unordered_map>
 
 /* libpng */
@@ -36,6 +38,7 @@ extern "C" {
 #include <ImfStandardAttributes.h>
 #include <ImfRgbaYca.h>
 #include <ImfOutputFile.h>
+#include <ImfTiledOutputFile.h>
 #include <ImfChannelList.h>
 #include <ImfStringAttribute.h>
 #include <ImfIntAttribute.h>
@@ -272,15 +275,39 @@ resample(Bitmap *target, const Bitmap *source,
         r.set_boundary_condition(bc.second);
         r.set_clamp(clamp);
 
+        /* Resampling columns in place is slow on large images: every filter
+           tap lands on a different cache line. Instead, gather narrow chunks
+           of columns into a dense per-thread scratch buffer, resample the
+           whole chunk at unit stride (treating its columns as extra
+           channels), and scatter the result back. Both copies traverse the
+           bitmaps row by row and are therefore cache-linear. */
+        const size_t chunk         = 16,
+                     width         = source->width(),
+                     source_height = source->height(),
+                     target_height = target->height(),
+                     chunk_count   = (width + chunk - 1) / chunk;
+
         tbb::parallel_for(
-            tbb::blocked_range<size_t>(0, source->width(), 100),
+            tbb::blocked_range<size_t>(0, chunk_count, 1),
             [&](const tbb::blocked_range<size_t> &range) {
-                for (auto x = range.begin(); x != range.end(); ++x) {
+                std::unique_ptr<Scalar[]> s_buf(new Scalar[chunk * channels * source_height]),
+                                          t_buf(new Scalar[chunk * channels * target_height]);
+                for (auto i = range.begin(); i != range.end(); ++i) {
+                    size_t x0 = i * chunk,
+                           nc = std::min(chunk, width - x0) * channels;
+
                     const Scalar *s = (const Scalar *) source->uint8_data() +
-                                      x * channels;
-                    Scalar *t       = (Scalar *) target->uint8_data() +
-                                      x * channels;
-                    r.resample(s, source->width(), t, target->width(), (uint32_t) channels);
+                                      x0 * channels;
+                    for (size_t y = 0; y < source_height; ++y)
+                        memcpy(s_buf.get() + y * nc, s + y * width * channels,
+                               nc * sizeof(Scalar));
+
+                    r.resample(s_buf.get(), 1, t_buf.get(), 1, (uint32_t) nc);
+
+                    Scalar *t = (Scalar *) target->uint8_data() + x0 * channels;
+                    for (size_t y = 0; y < target_height; ++y)
+                        memcpy(t + y * width * channels, t_buf.get() + y * nc,
+                               nc * sizeof(Scalar));
                 }
             }
         );
@@ -461,7 +488,8 @@ void Bitmap::convert(Bitmap *target) const {
     }
 
     StructConverter conv(m_struct, target_struct, true);
-    bool rv = conv.convert_2d(m_size.x(), m_size.y(), uint8_data(), target->uint8_data());
+    bool rv = conv.convert_2d_parallel(m_size.x(), m_size.y(), uint8_data(),
+                                       target->uint8_data());
     if (!rv)
         Throw("Bitmap::convert(): conversion kernel indicated a failure!");
 }
@@ -611,8 +639,8 @@ std::vector<std::pair<std::string, ref<Bitmap>>> Bitmap::split() const {
                 link_field("A", a);
 
             StructConverter conv(m_struct, target_struct, true);
-            bool rv = conv.convert_2d(m_size.x(), m_size.y(),
-                                      uint8_data(), target->uint8_data());
+            bool rv = conv.convert_2d_parallel(m_size.x(), m_size.y(),
+                                               uint8_data(), target->uint8_data());
             if (!rv)
                 Throw("Bitmap::split(): conversion kernel indicated a failure!");
             result.push_back({ prefix, target });
@@ -631,8 +659,8 @@ std::vector<std::pair<std::string, ref<Bitmap>>> Bitmap::split() const {
         ref<Struct> target_struct = new Struct(*target->struct_());
         target_struct->field("Y").name = it->second.second->name;
         StructConverter conv(m_struct, target_struct, true);
-        bool rv = conv.convert_2d(m_size.x(), m_size.y(),
-                                  uint8_data(), target->uint8_data());
+        bool rv = conv.convert_2d_parallel(m_size.x(), m_size.y(),
+                                           uint8_data(), target->uint8_data());
         if (!rv)
             Throw("Bitmap::split(): conversion kernel indicated a failure!");
         result.push_back({ it->first + "." + it->second.first, target });
@@ -699,12 +727,14 @@ Bitmap::FileFormat Bitmap::detect_file_format(Stream *stream) {
     return format;
 }
 
-void Bitmap::write(const fs::path &path, FileFormat format, int quality) const {
+void Bitmap::write(const fs::path &path, FileFormat format, int quality,
+                   Compression compression) const {
     ref<FileStream> fs = new FileStream(path, FileStream::ETruncReadWrite);
-    write(fs, format, quality);
+    write(fs, format, quality, compression);
 }
 
-void Bitmap::write(Stream *stream, FileFormat format, int quality) const {
+void Bitmap::write(Stream *stream, FileFormat format, int quality,
+                   Compression compression) const {
     auto fs = dynamic_cast<FileStream *>(stream);
 
     if (format == FileFormat::Auto) {
@@ -737,7 +767,7 @@ void Bitmap::write(Stream *stream, FileFormat format, int quality) const {
 
     switch (format) {
         case FileFormat::OpenEXR:
-            write_openexr(stream, quality);
+            write_openexr(stream, quality, compression);
             break;
 
         case FileFormat::PNG:
@@ -769,25 +799,29 @@ void Bitmap::write(Stream *stream, FileFormat format, int quality) const {
     }
 }
 
-void Bitmap::write_async(const fs::path &path_, FileFormat format_, int quality_) const {
+void Bitmap::write_async(const fs::path &path_, FileFormat format_, int quality_,
+                         Compression compression_) const {
     class WriteTask : public tbb::task {
         ref<const Bitmap> bitmap;
         fs::path path;
         FileFormat format;
         int quality;
+        Compression compression;
 
     public:
-        WriteTask(const Bitmap *bitmap, fs::path path, FileFormat format, int quality)
-            : bitmap(bitmap), path(path), format(format), quality(quality) { }
+        WriteTask(const Bitmap *bitmap, fs::path path, FileFormat format,
+                  int quality, Compression compression)
+            : bitmap(bitmap), path(path), format(format), quality(quality),
+              compression(compression) { }
 
         tbb::task* execute() override {
-            bitmap->write(path, format, quality);
+            bitmap->write(path, format, quality, compression);
             return nullptr;
         }
     };
 
     WriteTask *t = new (tbb::task::allocate_root())
-        WriteTask(this, path_, format_, quality_);
+        WriteTask(this, path_, format_, quality_, compression_);
     tbb::task::enqueue(*t);
 }
 
@@ -878,9 +912,23 @@ private:
     ref<Stream> m_stream;
 };
 
+/* The OpenEXR thread pool is created lazily upon first use and then shared
+   by all subsequent EXR I/O. Its size tracks \ref __global_thread_count so
+   that a concurrency cap imposed via \ref set_global_thread_count() also
+   bounds EXR (de)compression, rather than OpenEXR silently bringing one
+   worker per core of its own. Scene loading decodes multiple images
+   concurrently, hence the update must be guarded. */
+static std::mutex exr_threads_mutex;
+
+static void exr_init_threads() {
+    std::lock_guard<std::mutex> guard(exr_threads_mutex);
+    int count = (int) __global_thread_count;
+    if (Imf::globalThreadCount() != count)
+        Imf::setGlobalThreadCount(count);
+}
+
 void Bitmap::read_openexr(Stream *stream) {
-    if (Imf::globalThreadCount() == 0)
-        Imf::setGlobalThreadCount(std::min(8, util::core_count()));
+    exr_init_threads();
 
     EXRIStream istr(stream);
     Imf::InputFile file(istr);
@@ -1106,11 +1154,19 @@ void Bitmap::read_openexr(Stream *stream) {
         uint8_t *dst = uint8_data() + field.offset;
         uint8_t *src = buf.second->uint8_data();
 
-        for (size_t j=0; j<pixel_count; ++j) {
-            memcpy(dst, src, comp_size);
-            src += comp_size;
-            dst += pixel_stride;
-        }
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, pixel_count, 10000),
+            [&](const tbb::blocked_range<size_t> &range) {
+                uint8_t *src_p = src + range.begin() * comp_size,
+                        *dst_p = dst + range.begin() * pixel_stride;
+
+                for (size_t j = range.begin(); j != range.end(); ++j) {
+                    memcpy(dst_p, src_p, comp_size);
+                    src_p += comp_size;
+                    dst_p += pixel_stride;
+                }
+            }
+        );
 
         buf.second = nullptr;
     }
@@ -1122,30 +1178,37 @@ void Bitmap::read_openexr(Stream *stream) {
         auto convert = [&](auto *data) {
             using T = std::decay_t<decltype(*data)>;
 
-            for (size_t j = 0; j < pixel_count; ++j) {
-                Float Y  = (Float) data[0],
-                      RY = (Float) data[1],
-                      BY = (Float) data[2];
-
-                if (std::is_integral<T>::value) {
-                    Float scale = Float(1) / std::numeric_limits<T>::max();
-                    Y *= scale; RY *= scale; BY *= scale;
-                }
-
-                Float R = (RY + 1.f) * Y,
-                      B = (BY + 1.f) * Y,
-                      G = ((Y - R * yw.x - B * yw.z) / yw.y);
-
-                if (std::is_integral<T>::value) {
-                    Float scale = std::numeric_limits<T>::max();
-                    R *= R * scale + .5f;
-                    G *= G * scale + .5f;
-                    B *= B * scale + .5f;
+            tbb::parallel_for(
+                tbb::blocked_range<size_t>(0, pixel_count, 10000),
+                [&](const tbb::blocked_range<size_t> &range) {
+                    auto *ptr = data + range.begin() * channel_count();
+
+                    for (size_t j = range.begin(); j != range.end(); ++j) {
+                        Float Y  = (Float) ptr[0],
+                              RY = (Float) ptr[1],
+                              BY = (Float) ptr[2];
+
+                        if (std::is_integral<T>::value) {
+                            Float scale = Float(1) / std::numeric_limits<T>::max();
+                            Y *= scale; RY *= scale; BY *= scale;
+                        }
+
+                        Float R = (RY + 1.f) * Y,
+                              B = (BY + 1.f) * Y,
+                              G = ((Y - R * yw.x - B * yw.z) / yw.y);
+
+                        if (std::is_integral<T>::value) {
+                            Float scale = std::numeric_limits<T>::max();
+                            R *= R * scale + .5f;
+                            G *= G * scale + .5f;
+                            B *= B * scale + .5f;
+                        }
+
+                        ptr[0] = T(R); ptr[1] = T(G); ptr[2] = T(B);
+                        ptr += channel_count();
+                    }
                 }
-
-                data[0] = T(R); data[1] = T(G); data[2] = T(B);
-                data += channel_count();
-            }
+            );
         };
 
         switch (m_component_format) {
@@ -1194,29 +1257,36 @@ void Bitmap::read_openexr(Stream *stream) {
         auto convert = [&](auto *data) {
             using T = std::decay_t<decltype(*data)>;
 
-            for (size_t j = 0; j < pixel_count; ++j) {
-                Float R = (Float) data[0],
-                      G = (Float) data[1],
-                      B = (Float) data[2];
-
-                if (std::is_integral<T>::value) {
-                    Float scale = Float(1) / std::numeric_limits<T>::max();
-                    R *= scale; G *= scale; B *= scale;
+            tbb::parallel_for(
+                tbb::blocked_range<size_t>(0, pixel_count, 10000),
+                [&](const tbb::blocked_range<size_t> &range) {
+                    auto *ptr = data + range.begin() * channel_count();
+
+                    for (size_t j = range.begin(); j != range.end(); ++j) {
+                        Float R = (Float) ptr[0],
+                              G = (Float) ptr[1],
+                              B = (Float) ptr[2];
+
+                        if (std::is_integral<T>::value) {
+                            Float scale = Float(1) / std::numeric_limits<T>::max();
+                            R *= scale; G *= scale; B *= scale;
+                        }
+
+                        Imath::V3f rgb = Imath::V3f(float(R), float(G), float(B)) * M;
+                        R = Float(rgb[0]); G = Float(rgb[1]); B = Float(rgb[2]);
+
+                        if (std::is_integral<T>::value) {
+                            Float scale = std::numeric_limits<T>::max();
+                            R *= R * scale + 0.5f;
+                            G *= G * scale + 0.5f;
+                            B *= B * scale + 0.5f;
+                        }
+
+                        ptr[0] = T(R); ptr[1] = T(G); ptr[2] = T(B);
+                        ptr += channel_count();
+                    }
                 }
-
-                Imath::V3f rgb = Imath::V3f(float(R), float(G), float(B)) * M;
-                R = Float(rgb[0]); G = Float(rgb[1]); B = Float(rgb[2]);
-
-                if (std::is_integral<T>::value) {
-                    Float scale = std::numeric_limits<T>::max();
-                    R *= R * scale + 0.5f;
-                    G *= G * scale + 0.5f;
-                    B *= B * scale + 0.5f;
-                }
-
-                data[0] = T(R); data[1] = T(G); data[2] = T(B);
-                data += channel_count();
-            }
+            );
         };
 
         switch (m_component_format) {
@@ -1228,9 +1298,29 @@ void Bitmap::read_openexr(Stream *stream) {
     }
 }
 
-void Bitmap::write_openexr(Stream *stream, int quality) const {
-    if (Imf::globalThreadCount() == 0)
-        Imf::setGlobalThreadCount(std::min(8, util::core_count()));
+/// Map a \ref Bitmap::Compression value onto the matching OpenEXR constant
+static Imf::Compression to_exr_compression(Bitmap::Compression compression,
+                                           int quality) {
+    switch (compression) {
+        case Bitmap::Compression::Default:
+            return quality <= 0 ? Imf::PIZ_COMPRESSION : Imf::DWAB_COMPRESSION;
+        case Bitmap::Compression::None:  return Imf::NO_COMPRESSION;
+        case Bitmap::Compression::RLE:   return Imf::RLE_COMPRESSION;
+        case Bitmap::Compression::ZIPS:  return Imf::ZIPS_COMPRESSION;
+        case Bitmap::Compression::ZIP:   return Imf::ZIP_COMPRESSION;
+        case Bitmap::Compression::PIZ:   return Imf::PIZ_COMPRESSION;
+        case Bitmap::Compression::PXR24: return Imf::PXR24_COMPRESSION;
+        case Bitmap::Compression::B44:   return Imf::B44_COMPRESSION;
+        case Bitmap::Compression::B44A:  return Imf::B44A_COMPRESSION;
+        case Bitmap::Compression::DWAA:  return Imf::DWAA_COMPRESSION;
+        case Bitmap::Compression::DWAB:  return Imf::DWAB_COMPRESSION;
+        default: Throw("Unknown compression scheme!");
+    }
+}
+
+void Bitmap::write_openexr(Stream *stream, int quality,
+                           Compression compression) const {
+    exr_init_threads();
 
     PixelFormat pixel_format = m_pixel_format;
 
@@ -1240,6 +1330,8 @@ void Bitmap::write_openexr(Stream *stream, int quality) const {
 
     std::vector<std::string> keys = metadata.property_names();
 
+    Imf::Compression exr_compression = to_exr_compression(compression, quality);
+
     Imf::Header header(
         (int) m_size.x(),  // width
         (int) m_size.y(),  // height,
@@ -1247,11 +1339,12 @@ void Bitmap::write_openexr(Stream *stream, int quality) const {
         Imath::V2f(0, 0),  // screenWindowCenter,
         1.f,               // screenWindowWidth
         Imf::INCREASING_Y, // lineOrder
-        quality <= 0 ? Imf::PIZ_COMPRESSION : Imf::DWAB_COMPRESSION // compression
+        exr_compression    // compression
     );
 
-    if (quality > 0)
-        Imf::addDwaCompressionLevel(header, float(quality));
+    if (exr_compression == Imf::DWAA_COMPRESSION ||
+        exr_compression == Imf::DWAB_COMPRESSION)
+        Imf::addDwaCompressionLevel(header, quality > 0 ? float(quality) : 45.f);
 
     for (auto it = keys.begin(); it != keys.end(); ++it) {
         using Type = Properties::Type;
@@ -1339,6 +1432,118 @@ void Bitmap::write_openexr(Stream *stream, int quality) const {
     file.writePixels((int) m_size.y());
 }
 
+/// Map a \ref Struct field type onto the matching OpenEXR component type
+static Imf::PixelType struct_to_exr_type(Struct::Type type) {
+    switch (type) {
+        case Struct::Type::Float16: return Imf::HALF;
+        case Struct::Type::Float32: return Imf::FLOAT;
+        case Struct::Type::UInt32:  return Imf::UINT;
+        default: Throw("Unexpected field type (must be float16, "
+                       "float32, or uint32)");
+    }
+}
+
+struct TiledBitmapWriter::EXRData {
+    ref<FileStream> stream;
+    std::unique_ptr<EXROStream> ostream;
+    std::unique_ptr<Imf::TiledOutputFile> file;
+    std::mutex mutex;
+};
+
+TiledBitmapWriter::TiledBitmapWriter(const fs::path &path, const Vector2u &size,
+                                     uint32_t tile_size, const Struct *fields,
+                                     Bitmap::Compression compression)
+    : m_size(size), m_tile_size(tile_size), m_struct(new Struct(*fields)) {
+    exr_init_threads();
+
+    if (tile_size == 0 || any(eq(size, 0u)))
+        Throw("TiledBitmapWriter: image and tile sizes must be positive!");
+
+    /* RANDOM_Y allows the tiles to arrive in arbitrary order (e.g. following
+       the spiral traversal of the image blocks) without any buffering */
+    Imf::Header header(
+        (int) size.x(),    // width
+        (int) size.y(),    // height,
+        1.f,               // pixelAspectRatio
+        Imath::V2f(0, 0),  // screenWindowCenter,
+        1.f,               // screenWindowWidth
+        Imf::RANDOM_Y,     // lineOrder
+        to_exr_compression(compression, /* quality = */ -1) // compression
+    );
+    if (compression == Bitmap::Compression::DWAA ||
+        compression == Bitmap::Compression::DWAB)
+        Imf::addDwaCompressionLevel(header, 45.f);
+    header.setTileDescription(
+        Imf::TileDescription(tile_size, tile_size, Imf::ONE_LEVEL));
+    header.insert("generatedBy",
+                  Imf::StringAttribute("Mitsuba version " MTS_VERSION));
+
+    Imf::ChannelList &channels = header.channels();
+    for (auto field : *m_struct)
+        channels.insert(field.name,
+                        Imf::Channel(struct_to_exr_type(field.type)));
+
+    m_data = std::make_unique<EXRData>();
+    m_data->stream = new FileStream(path, FileStream::ETruncReadWrite);
+    m_data->ostream = std::make_unique<EXROStream>(m_data->stream.get());
+    m_data->file = std::make_unique<Imf::TiledOutputFile>(*m_data->ostream, header);
+}
+
+TiledBitmapWriter::~TiledBitmapWriter() {
+    close();
+}
+
+void TiledBitmapWriter::put(const Point2u &offset, const Bitmap *tile) {
+    if (!m_data->file)
+        Throw("TiledBitmapWriter::put(): the image was already closed!");
+
+    if (*tile->struct_() != *m_struct)
+        Throw("TiledBitmapWriter::put(): pixel layout %s of the tile does "
+              "not match the image layout %s!",
+              tile->struct_()->to_string(), m_struct->to_string());
+
+    if (offset.x() % m_tile_size != 0 || offset.y() % m_tile_size != 0 ||
+        any(offset >= m_size))
+        Throw("TiledBitmapWriter::put(): offset %s is not aligned to the "
+              "%ix%i tile grid!", offset, m_tile_size, m_tile_size);
+
+    Vector2u expected_size = min(Vector2u(m_tile_size), m_size - offset);
+    if (tile->size() != expected_size)
+        Throw("TiledBitmapWriter::put(): tile at offset %s should have size "
+              "%s, got %s!", offset, expected_size, tile->size());
+
+    size_t pixel_stride = m_struct->size(),
+           row_stride   = pixel_stride * tile->width();
+
+    /* Address the frame buffer so that the data window of the tile maps
+       onto the in-memory contents of 'tile' */
+    const uint8_t *ptr = tile->uint8_data()
+        - offset.x() * pixel_stride - offset.y() * row_stride;
+
+    Imf::FrameBuffer framebuffer;
+    for (auto field : *m_struct)
+        framebuffer.insert(field.name,
+                           Imf::Slice(struct_to_exr_type(field.type),
+                                      (char *) (ptr + field.offset),
+                                      pixel_stride, row_stride));
+
+    /* OpenEXR permits concurrent writeTile() calls only for distinct output
+       files -- serialize access to this one */
+    std::lock_guard<std::mutex> guard(m_data->mutex);
+    m_data->file->setFrameBuffer(framebuffer);
+    m_data->file->writeTile((int) (offset.x() / m_tile_size),
+                            (int) (offset.y() / m_tile_size));
+}
+
+void TiledBitmapWriter::close() {
+    if (!m_data->file)
+        return;
+    m_data->file.reset();
+    m_data->ostream.reset();
+    m_data->stream->close();
+    m_data->stream = nullptr;
+}
+
 // -----------------------------------------------------------------------------
 //   JPEG bitmap I/O
 // -----------------------------------------------------------------------------
@@ -2417,6 +2622,24 @@ std::ostream &operator<<(std::ostream &os, Bitmap::FileFormat value) {
     return os;
 }
 
+std::ostream &operator<<(std::ostream &os, Bitmap::Compression value) {
+    switch (value) {
+        case Bitmap::Compression::Default: os << "default"; break;
+        case Bitmap::Compression::None:    os << "none"; break;
+        case Bitmap::Compression::RLE:     os << "rle"; break;
+        case Bitmap::Compression::ZIPS:    os << "zips"; break;
+        case Bitmap::Compression::ZIP:     os << "zip"; break;
+        case Bitmap::Compression::PIZ:     os << "piz"; break;
+        case Bitmap::Compression::PXR24:   os << "pxr24"; break;
+        case Bitmap::Compression::B44:     os << "b44"; break;
+        case Bitmap::Compression::B44A:    os << "b44a"; break;
+        case Bitmap::Compression::DWAA:    os << "dwaa"; break;
+        case Bitmap::Compression::DWAB:    os << "dwab"; break;
+        default: Throw("Unknown compression scheme!");
+    }
+    return os;
+}
+
 void Bitmap::static_initialization() {
     // No-op
 }
@@ -2426,5 +2649,6 @@ void Bitmap::static_shutdown() {
 }
 
 MTS_IMPLEMENT_CLASS(Bitmap, Object)
+MTS_IMPLEMENT_CLASS(TiledBitmapWriter, Object)
 
 NAMESPACE_END(mitsuba)
@@ -1,6 +1,6 @@
 #include <mitsuba/core/class.h>
 #include <mitsuba/core/logger.h>
-#include <map>
+#include <unordered_map>
 #include <iostream>
 
 NAMESPACE_BEGIN(mitsuba)
@@ -13,7 +13,10 @@ void cleanup();
 NAMESPACE_END(detail)
 NAMESPACE_END(xml)
 
-static std::map<std::string, Class *> *__classes;
+/* Open-addressed hash table rather than an ordered map: \ref for_name() is
+   on the hot path of plugin instantiation and only ever performs exact
+   lookups, so there is no reason to pay for ordered traversal */
+static std::unordered_map<std::string, Class *> *__classes;
 bool Class::m_is_initialized = false;
 const Class *m_class = nullptr;
 
@@ -34,7 +37,7 @@ Class::Class(const std::string &name, const std::string &parent, const std::stri
         m_alias = name;
 
     if (!__classes)
-        __classes = new std::map<std::string, Class *>();
+        __classes = new std::unordered_map<std::string, Class *>();
 
     (*__classes)[key(name, variant)] = this;
 
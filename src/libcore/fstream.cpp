@@ -4,6 +4,11 @@
 #include <sstream>
 #include <fstream>
 
+#if !defined(__WINDOWS__)
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif
+
 namespace fs = mitsuba::filesystem;
 
 NAMESPACE_BEGIN(mitsuba)
@@ -38,6 +43,35 @@ FileStream::~FileStream() {
     close();
 }
 
+void FileStream::prefetch(const fs::path &p) {
+#if defined(__LINUX__)
+    int fd = ::open(p.string().c_str(), O_RDONLY);
+    if (fd == -1)
+        return;
+    (void) posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+    ::close(fd);
+#elif defined(__OSX__)
+    int fd = ::open(p.string().c_str(), O_RDONLY);
+    if (fd == -1)
+        return;
+    off_t size = ::lseek(fd, 0, SEEK_END);
+    if (size > 0) {
+        struct radvisory advice;
+        advice.ra_offset = 0;
+        advice.ra_count  = size > 0x7fffffff ? 0x7fffffff : (int) size;
+        (void) ::fcntl(fd, F_RDADVISE, &advice);
+    }
+    ::close(fd);
+#else
+    /* No readahead hint available -- warm the file cache by reading the
+       contents (the caller is expected to invoke this from a worker) */
+    std::ifstream is(p.string(), std::ios::binary);
+    char buffer[65536];
+    while (is.good())
+        is.read(buffer, sizeof(buffer));
+#endif
+}
+
 void FileStream::close() {
     m_file->close();
 };
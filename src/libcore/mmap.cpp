@@ -43,6 +43,7 @@ struct MemoryMappedFile::MemoryMappedFilePrivate {
                 data = nullptr;
                 Throw("Could not map \"%s\" to memory!", filename.string());
             }
+            util::advise_huge_pages(data, size);
             if (close(fd) != 0)
                 Throw("close(): unable to close file!");
         #elif defined(__WINDOWS__)
@@ -64,6 +65,7 @@ struct MemoryMappedFile::MemoryMappedFilePrivate {
                     filename.string(), util::last_error());
         #endif
         can_write = true;
+        util::track_memory("Memory-mapped files", size);
     }
 
     void create_temp() {
@@ -94,6 +96,7 @@ struct MemoryMappedFile::MemoryMappedFilePrivate {
                 data = nullptr;
                 Throw("Could not map \"%s\" to memory!", filename.string());
             }
+            util::advise_huge_pages(data, size);
 
             if (close(fd) != 0)
                 Throw("close(): unable to close file!");
@@ -128,6 +131,7 @@ struct MemoryMappedFile::MemoryMappedFilePrivate {
                 Throw("MapViewOfFile: Could not map \"%s\" to memory: %s",
                     filename.string(), util::last_error());
         #endif
+        util::track_memory("Memory-mapped files", size);
     }
 
     void map() {
@@ -147,6 +151,7 @@ struct MemoryMappedFile::MemoryMappedFilePrivate {
                 data = nullptr;
                 Throw("Could not map \"%s\" to memory!", filename.string());
             }
+            util::advise_huge_pages(data, size);
 
             if (close(fd) != 0)
                 Throw("close(): unable to close file!");
@@ -169,6 +174,7 @@ struct MemoryMappedFile::MemoryMappedFilePrivate {
                 Throw("MapViewOfFile: Could not map \"%s\" to memory: %s",
                     filename.string(), util::last_error());
         #endif
+        util::track_memory("Memory-mapped files", size);
     }
 
     void unmap() {
@@ -203,6 +209,7 @@ struct MemoryMappedFile::MemoryMappedFilePrivate {
             }
         }
 
+        util::untrack_memory("Memory-mapped files", size);
         data = nullptr;
         size = 0;
     }
@@ -1,17 +1,25 @@
 #include <mitsuba/core/mstream.h>
+#include <algorithm>
 #include <sstream>
 
 NAMESPACE_BEGIN(mitsuba)
 
 MemoryStream::MemoryStream(size_t capacity)
     : Stream(), m_capacity(0), m_size(0), m_pos(0), m_owns_buffer(true),
-      m_data(nullptr), m_is_closed(false) {
+      m_read_only(false), m_data(nullptr), m_is_closed(false) {
     resize(capacity);
 }
 
 MemoryStream::MemoryStream(void *ptr, size_t size)
     : Stream(), m_capacity(size), m_size(size), m_pos(0), m_owns_buffer(false),
-      m_data(reinterpret_cast<uint8_t *>(ptr)), m_is_closed(false) { }
+      m_read_only(false), m_data(reinterpret_cast<uint8_t *>(ptr)),
+      m_is_closed(false) { }
+
+MemoryStream::MemoryStream(const void *ptr, size_t size)
+    : Stream(), m_capacity(size), m_size(size), m_pos(0), m_owns_buffer(false),
+      m_read_only(true),
+      m_data(reinterpret_cast<uint8_t *>(const_cast<void *>(ptr))),
+      m_is_closed(false) { }
 
 MemoryStream::~MemoryStream() {
     if (m_data != nullptr && m_owns_buffer)
@@ -42,13 +50,17 @@ void MemoryStream::read(void *p, size_t size) {
 void MemoryStream::write(const void *p, size_t size) {
     if (is_closed())
         Throw("Attempted to write to a closed stream: %s", to_string());
+    if (m_read_only)
+        Throw("Attempted to write to a read-only memory stream: %s",
+              to_string());
 
     size_t endPos = m_pos + size;
     if (endPos > m_size) {
         if (endPos > m_capacity) {
             // Double capacity until it will fit `endPos`, à la `std::vector`
-            auto newSize = m_capacity;
-            do { newSize *= 2; } while (endPos > newSize);
+            auto newSize = std::max(m_capacity, (size_t) 512);
+            while (endPos > newSize)
+                newSize *= 2;
             resize(newSize);
         }
         m_size = endPos;
@@ -57,6 +69,30 @@ void MemoryStream::write(const void *p, size_t size) {
     m_pos = endPos;
 }
 
+void MemoryStream::reserve(size_t capacity) {
+    if (capacity <= m_capacity)
+        return;
+
+    // Same doubling schedule as write(), see above
+    auto newSize = std::max(m_capacity, (size_t) 512);
+    while (capacity > newSize)
+        newSize *= 2;
+    resize(newSize);
+}
+
+uint8_t *MemoryStream::release_buffer(size_t &size_out) {
+    if (!m_owns_buffer)
+        Throw("release_buffer(): the underlying buffer does not belong to "
+              "this MemoryStream instance!");
+
+    uint8_t *data = m_data;
+    size_out = m_size;
+
+    m_data = nullptr;
+    m_capacity = m_size = m_pos = 0;
+    return data;
+}
+
 void MemoryStream::resize(size_t size) {
     if (!m_owns_buffer)
         Throw("Tried to resize a buffer, which doesn't "
@@ -92,6 +128,7 @@ std::string MemoryStream::to_string() const {
             << "  can_read = " << can_read() << "," << std::endl
             << "  can_write = " << can_write() << "," << std::endl
             << "  owns_buffer = " << owns_buffer() << "," << std::endl
+            << "  read_only = " << m_read_only << "," << std::endl
             << "  capacity = " << capacity() << "," << std::endl
             << "  pos = " << tell() << "," << std::endl
             << "  size = " << size() << std::endl;
@@ -7,10 +7,15 @@
 NAMESPACE_BEGIN(mitsuba)
 
 void Object::dec_ref(bool dealloc) const noexcept {
-    --m_ref_count;
-    if (m_ref_count == 0 && dealloc) {
+    /* Release ordering on the decrement publishes this thread's writes to
+       whoever ends up deleting the object; the matching acquire fence below
+       runs only in the thread that observes the count reaching zero. This
+       keeps the common (non-final) decrement free of acquire semantics. */
+    int old_value = m_ref_count.fetch_sub(1, std::memory_order_release);
+    if (old_value == 1 && dealloc) {
+        std::atomic_thread_fence(std::memory_order_acquire);
         delete this;
-    } else if (m_ref_count < 0) {
+    } else if (old_value < 1) {
         fprintf(stderr, "Internal error: Object reference count < 0!\n");
         abort();
     }
@@ -0,0 +1,101 @@
+#include <mitsuba/core/parameters.h>
+#include <mitsuba/core/logger.h>
+#include <algorithm>
+
+NAMESPACE_BEGIN(mitsuba)
+
+void ParameterTable::build(Object *root) {
+    m_entries.clear();
+    m_names.clear();
+    m_dirty.clear();
+
+    m_prefix.clear();
+    m_path = { root };
+    m_visited = { root };
+    root->traverse(this);
+    m_path.clear();
+    m_visited.clear();
+}
+
+void ParameterTable::put_object(const std::string &name, Object *obj) {
+    /* Shared objects are registered under the first path encountered; this
+       also guards against cycles in the object graph */
+    if (!obj || m_visited.count(obj))
+        return;
+    m_visited.insert(obj);
+
+    std::string prefix_backup = m_prefix;
+    m_prefix += name + ".";
+    m_path.push_back(obj);
+    obj->traverse(this);
+    m_path.pop_back();
+    m_prefix = prefix_backup;
+}
+
+void ParameterTable::put_parameter_impl(const std::string &name,
+                                        const std::type_info &type,
+                                        void *ptr) {
+    Entry entry;
+    entry.type = &type;
+    entry.ptr  = ptr;
+    entry.path = m_path;
+
+    auto [it, inserted] =
+        m_entries.emplace(m_prefix + name, std::move(entry));
+    if (inserted)
+        m_names.push_back(it->first);
+}
+
+bool ParameterTable::contains(const std::string &name) const {
+    return m_entries.find(name) != m_entries.end();
+}
+
+ParameterTable::Entry &ParameterTable::lookup(const std::string &name,
+                                              const std::type_info &type) {
+    auto it = m_entries.find(name);
+    if (it == m_entries.end())
+        Throw("ParameterTable: unknown parameter \"%s\"!", name);
+    if (*it->second.type != type)
+        Throw("ParameterTable: parameter \"%s\" has type '%s', but '%s' was "
+              "requested!", name, it->second.type->name(), type.name());
+    return it->second;
+}
+
+const ParameterTable::Entry &
+ParameterTable::lookup(const std::string &name,
+                       const std::type_info &type) const {
+    return const_cast<ParameterTable *>(this)->lookup(name, type);
+}
+
+void ParameterTable::set_dirty(const std::string &name) {
+    if (!contains(name))
+        Throw("ParameterTable: unknown parameter \"%s\"!", name);
+    m_dirty.insert(name);
+}
+
+void ParameterTable::update() {
+    /* Notify objects at greater depths first, so that parents observe a
+       consistent state of their children when they recompute their own */
+    size_t max_depth = 0;
+    for (const std::string &name : m_dirty)
+        max_depth = std::max(max_depth, m_entries[name].path.size());
+
+    std::vector<Object *> order;
+    std::unordered_set<const Object *> seen;
+    for (size_t depth = max_depth; depth > 0; --depth) {
+        for (const std::string &name : m_dirty) {
+            const std::vector<Object *> &path = m_entries[name].path;
+            if (path.size() < depth)
+                continue;
+            Object *obj = path[depth - 1];
+            if (seen.insert(obj).second)
+                order.push_back(obj);
+        }
+    }
+    m_dirty.clear();
+
+    for (Object *obj : order)
+        obj->parameters_changed();
+}
+
+NAMESPACE_END(mitsuba)
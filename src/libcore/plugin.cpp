@@ -4,6 +4,10 @@
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/filesystem.h>
 #include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/fstream.h>
+#include <tbb/parallel_for.h>
+#include <tbb/spin_mutex.h>
+#include <algorithm>
 #include <mutex>
 #include <unordered_map>
 
@@ -15,6 +19,54 @@
 
 NAMESPACE_BEGIN(mitsuba)
 
+NAMESPACE_BEGIN(detail)
+
+struct StaticPluginInfo {
+    const char *class_name;
+    const char *descr;
+};
+
+/// Plugins linked directly into the binary (see \ref MTS_EXPORT_PLUGIN)
+static std::unordered_map<std::string, StaticPluginInfo> &static_plugins() {
+    static std::unordered_map<std::string, StaticPluginInfo> registry;
+    return registry;
+}
+
+StaticPluginRegistrar::StaticPluginRegistrar(const char *file,
+                                             const char *class_name,
+                                             const char *descr) {
+    /* The user-visible plugin name matches the name of the defining
+       translation unit (e.g. "diffuse" for src/bsdfs/diffuse.cpp), which
+       is also the file name of the shared object that a dynamically
+       linked build would produce */
+    std::string name(file);
+    size_t slash = name.find_last_of("/\\");
+    if (slash != std::string::npos)
+        name = name.substr(slash + 1);
+    size_t dot = name.find_last_of('.');
+    if (dot != std::string::npos)
+        name = name.substr(0, dot);
+
+    static_plugins()[name] = StaticPluginInfo { class_name, descr };
+}
+
+NAMESPACE_END(detail)
+
+/// Build the platform-specific shared object name of a plugin
+static fs::path plugin_file_name(const std::string &name) {
+    fs::path filename = fs::path("plugins") / name;
+
+    #if defined(__WINDOWS__)
+        filename.replace_extension(".dll");
+    #elif defined(__OSX__)
+        filename.replace_extension(".dylib");
+    #else
+        filename.replace_extension(".so");
+    #endif
+
+    return filename;
+}
+
 class Plugin {
 public:
     Plugin(const fs::path &path) : m_path(path) {
@@ -40,7 +92,14 @@ public:
         }
     }
 
+    /// Represents a statically linked plugin (see \ref MTS_EXPORT_PLUGIN)
+    Plugin(const char *name, const char *descr)
+        : plugin_name(name), plugin_descr(descr) { }
+
     ~Plugin() {
+        if (!m_handle)
+            return;
+
         #if defined(__WINDOWS__)
             FreeLibrary(m_handle);
         #else
@@ -64,17 +123,45 @@ private:
         return ptr;
     }
 
+public:
+    /**
+     * \brief Return the \ref Class implementing the plugin in the given
+     * variant
+     *
+     * The result of the underlying \ref Class::for_name() query is interned
+     * here so that repeated instantiations (e.g. the tens of thousands of
+     * objects of a large scene) resolve to a cached pointer instead of
+     * re-hashing the combined name/variant key every time.
+     */
+    const Class *class_for_variant(const std::string &variant) const {
+        tbb::spin_mutex::scoped_lock lock(m_cache_mutex);
+
+        // Only a handful of variants exist; a linear scan is the fastest map
+        for (auto &entry : m_class_cache) {
+            if (entry.first == variant)
+                return entry.second;
+        }
+
+        const Class *class_ = Class::for_name(plugin_name, variant);
+        if (class_)
+            m_class_cache.emplace_back(variant, class_);
+        return class_;
+    }
+
 public:
     const char *plugin_name  = nullptr;
     const char *plugin_descr = nullptr;
 
 private:
     #if defined(__WINDOWS__)
-        HMODULE m_handle;
+        HMODULE m_handle = nullptr;
     #else
-        void *m_handle;
+        void *m_handle = nullptr;
     #endif
     fs::path m_path;
+    /// Resolved class pointers, one entry per requested variant
+    mutable std::vector<std::pair<std::string, const Class *>> m_class_cache;
+    mutable tbb::spin_mutex m_cache_mutex;
 };
 
 struct PluginManager::PluginManagerPrivate {
@@ -90,16 +177,18 @@ struct PluginManager::PluginManagerPrivate {
         if (it != m_plugins.end())
             return it->second;
 
-        /* Build the full plugin file name */
-        fs::path filename = fs::path("plugins") / name;
+        /* Plugin linked directly into the binary? */
+        const auto &static_registry = detail::static_plugins();
+        auto sit = static_registry.find(name);
+        if (sit != static_registry.end()) {
+            Plugin *plugin =
+                new Plugin(sit->second.class_name, sit->second.descr);
+            m_plugins[name] = plugin;
+            return plugin;
+        }
 
-        #if defined(__WINDOWS__)
-            filename.replace_extension(".dll");
-        #elif defined(__OSX__)
-            filename.replace_extension(".dylib");
-        #else
-            filename.replace_extension(".so");
-        #endif
+        /* Build the full plugin file name */
+        fs::path filename = plugin_file_name(name);
 
         const FileResolver *resolver = Thread::thread()->file_resolver();
         fs::path resolved = resolver->resolve(filename);
@@ -134,6 +223,22 @@ void PluginManager::register_python_plugin(const std::string &plugin_name) {
     Class::static_initialization();
 }
 
+const Class *PluginManager::get_plugin_class(const std::string &name,
+                                             const std::string &variant) {
+    const Class *plugin_class;
+
+    auto it = std::find(d->m_python_plugins.begin(), d->m_python_plugins.end(), name);
+    if (it != d->m_python_plugins.end()) {
+        plugin_class = Class::for_name(name, variant);
+    } else {
+        const Plugin *plugin = d->plugin(name);
+        plugin_class = plugin->class_for_variant(variant);
+    }
+
+    Assert(plugin_class != nullptr);
+    return plugin_class;
+}
+
 ref<Object> PluginManager::create_object(const Properties &props, const Class *class_) {
     Assert(class_ != nullptr);
     if (class_->name() == "Scene")
@@ -146,7 +251,7 @@ ref<Object> PluginManager::create_object(const Properties &props, const Class *c
         plugin_class = Class::for_name(props.plugin_name(), class_->variant());
     } else {
         const Plugin *plugin = d->plugin(props.plugin_name());
-        plugin_class = Class::for_name(plugin->plugin_name, class_->variant());
+        plugin_class = plugin->class_for_variant(class_->variant());
     }
 
     Assert(plugin_class != nullptr);
@@ -178,6 +283,65 @@ void PluginManager::ensure_plugin_loaded(const std::string &name) {
     (void) d->plugin(name);
 }
 
+void PluginManager::preload(const std::vector<std::string> &names) {
+    /* Determine which plugins actually involve the dynamic loader */
+    std::vector<std::string> pending;
+    {
+        std::lock_guard<std::mutex> guard(d->m_mutex);
+        for (const std::string &name : names) {
+            if (d->m_plugins.find(name) != d->m_plugins.end())
+                continue;
+            if (std::find(d->m_python_plugins.begin(),
+                          d->m_python_plugins.end(),
+                          name) != d->m_python_plugins.end())
+                continue;
+            if (detail::static_plugins().find(name) !=
+                detail::static_plugins().end())
+                continue;
+            if (std::find(pending.begin(), pending.end(), name) ==
+                pending.end())
+                pending.push_back(name);
+        }
+    }
+
+    if (pending.empty())
+        return;
+
+    Log(Debug, "Preloading %zu plugin%s ..", pending.size(),
+        pending.size() == 1 ? "" : "s");
+
+    /* Phase 1: resolve the shared objects and pull their contents into the
+       page cache in parallel. On a network-mounted installation, reading
+       the files is what dominates a cold start, and it parallelizes
+       perfectly -- unlike dlopen() itself, which the dynamic loader
+       serializes internally. */
+    const FileResolver *resolver = Thread::thread()->file_resolver();
+    std::vector<fs::path> paths;
+    for (const std::string &name : pending) {
+        fs::path resolved = resolver->resolve(plugin_file_name(name));
+        if (fs::exists(resolved))
+            paths.push_back(std::move(resolved));
+    }
+
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, paths.size(), 1),
+        [&](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i != range.end(); ++i)
+                FileStream::prefetch(paths[i]);
+        });
+
+    /* Phase 2: load the plugins themselves. Their static initializers
+       mutate the global class registry, hence this pass remains serial;
+       with warm caches it is cheap. Failures (e.g. misspelled plugin
+       names) are ignored here -- instantiation reports them with full
+       context. */
+    for (const std::string &name : pending) {
+        try {
+            (void) d->plugin(name);
+        } catch (...) { }
+    }
+}
+
 MTS_IMPLEMENT_CLASS(PluginManager, Object)
 
 NAMESPACE_END(mitsuba)
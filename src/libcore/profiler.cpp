@@ -1,58 +1,231 @@
 #include <mitsuba/core/profiler.h>
 #include <mitsuba/core/logger.h>
+#include <mitsuba/core/string.h>
 #include <mitsuba/core/util.h>
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+
+/// Number of cache-line-padded counter stripes shared among worker threads
+#if !defined(MTS_STAT_STRIPE_COUNT)
+#  define MTS_STAT_STRIPE_COUNT 64
+#endif
+
+NAMESPACE_BEGIN(mitsuba)
+
+/* Each thread is assigned one stripe round-robin on first use, hence (up to
+   the stripe count) concurrent increments never touch the same cache line.
+   Aggregation over the stripes only happens at reporting time. */
+struct alignas(64) StatsStripe {
+    std::atomic<uint64_t> counters[int(StatsCounter::StatsCounterCount)];
+};
+
+static StatsStripe stats_stripes[MTS_STAT_STRIPE_COUNT];
+static std::atomic<uint32_t> stats_thread_count { 0 };
+
+static uint32_t stats_stripe_index() {
+    static thread_local uint32_t index =
+        stats_thread_count.fetch_add(1, std::memory_order_relaxed) %
+        MTS_STAT_STRIPE_COUNT;
+    return index;
+}
+
+void Statistics::add(StatsCounter counter, uint64_t amount) {
+    stats_stripes[stats_stripe_index()].counters[int(counter)]
+        .fetch_add(amount, std::memory_order_relaxed);
+}
+
+uint64_t Statistics::value(StatsCounter counter) {
+    uint64_t result = 0;
+    for (StatsStripe &stripe : stats_stripes)
+        result += stripe.counters[int(counter)].load(std::memory_order_relaxed);
+    return result;
+}
+
+std::vector<std::pair<std::string, uint64_t>> Statistics::counters() {
+    std::vector<std::pair<std::string, uint64_t>> result;
+    for (int i = 0; i < int(StatsCounter::StatsCounterCount); ++i)
+        result.emplace_back(stats_counter_id[i], value((StatsCounter) i));
+    return result;
+}
+
+void Statistics::print_report() {
+    auto entries = counters();
+
+    size_t prefix_length = 0;
+    for (auto &kv : entries)
+        prefix_length = std::max(prefix_length, kv.first.length());
+
+    Log(Info, "\U0001F4CA  Render statistics:");
+    for (auto &kv : entries)
+        Log(Info, "    %s%s%i", kv.first,
+            std::string(prefix_length - kv.first.length() + 4, ' '),
+            kv.second);
+
+    // Derived quantities that are tedious to compute by hand
+    uint64_t camera_rays = value(StatsCounter::CameraRays);
+    if (camera_rays > 0)
+        Log(Info, "    Intersection rays per camera ray: %.2f",
+            value(StatsCounter::IntersectRays) / (double) camera_rays);
+}
+
+void Statistics::write_json(const std::string &filename) {
+    std::ofstream os(filename);
+    if (!os.good())
+        Throw("Could not open \"%s\" for writing!", filename);
+
+    auto entries = counters();
+    os << "{" << std::endl;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        std::string key = string::to_lower(entries[i].first);
+        std::replace(key.begin(), key.end(), ' ', '_');
+        os << "    \"" << key << "\": " << entries[i].second
+           << (i + 1 < entries.size() ? "," : "") << std::endl;
+    }
+    os << "}" << std::endl;
+}
+
+void Statistics::clear() {
+    for (StatsStripe &stripe : stats_stripes)
+        for (std::atomic<uint64_t> &counter : stripe.counters)
+            counter.store(0, std::memory_order_relaxed);
+}
+
+NAMESPACE_END(mitsuba)
 
 #if defined(MTS_ENABLE_PROFILER)
 #include <sys/time.h>
 #include <signal.h>
 #include <stdio.h>
+#include <time.h>
 #include <tbb/tbb.h>
 #include <array>
+#include <fstream>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <set>
 
-NAMESPACE_BEGIN(mitsuba)
+/// Number of trace events retained per thread (ring buffer, must be a power of two)
+#if !defined(MTS_PROFILE_TRACE_SIZE)
+#  define MTS_PROFILE_TRACE_SIZE 16384
+#endif
+
+/// Sampling interval of the profiler timer (microseconds, 100 Hz)
+#define MTS_PROFILE_INTERVAL_US 10000
 
-static thread_local uint64_t profiler_flags_storage = 0;
-uint64_t *profiler_flags() { return &profiler_flags_storage; }
+NAMESPACE_BEGIN(mitsuba)
 
+/* Samples are keyed by the call path active at the time of the timer
+   interrupt: up to MTS_PROFILE_STACK_DEPTH phase identifiers (each stored
+   with a +1 bias so that zero denotes an unused level), packed into a
+   64-bit integer with the outermost phase in the least significant byte. */
 struct ProfilerSample {
-    uint64_t flags = (uint64_t) -1;
+    uint64_t path  = (uint64_t) -1;
     uint64_t count = 0;
 };
 
-static std::array<ProfilerSample, MTS_PROFILE_HASH_SIZE> profiler_samples;
+/// Timestamped sample for the chrome://tracing export
+struct ProfilerTraceEvent {
+    uint64_t time_us;
+    uint64_t path;
+};
+
+/* Each thread records into its own buffers; the signal handler thus never
+   contends with other threads and per-thread breakdowns remain available
+   at reporting time. Buffers are heap-allocated and owned by a global
+   registry so that they outlive threads that exit before the report. */
+struct ProfilerThreadData {
+    ProfilerState state;
+    std::array<ProfilerSample, MTS_PROFILE_HASH_SIZE> samples;
+    std::array<ProfilerTraceEvent, MTS_PROFILE_TRACE_SIZE> trace;
+    uint64_t trace_pos = 0;
+    uint32_t thread_index = 0;
+};
+
+static std::mutex profiler_mutex;
+static std::vector<std::unique_ptr<ProfilerThreadData>> profiler_threads;
+static thread_local ProfilerThreadData *profiler_tls = nullptr;
+
+ProfilerState *profiler_state() {
+    ProfilerThreadData *data = profiler_tls;
+    if (unlikely(!data)) {
+        std::unique_ptr<ProfilerThreadData> td(new ProfilerThreadData());
+        data = td.get();
+        std::lock_guard<std::mutex> lock(profiler_mutex);
+        td->thread_index = (uint32_t) profiler_threads.size();
+        profiler_threads.push_back(std::move(td));
+        profiler_tls = data;
+    }
+    return &data->state;
+}
+
+/// Pack the current call path of \c state into a 64-bit sample key
+static uint64_t profiler_encode_path(const ProfilerState &state) {
+    uint32_t depth = state.depth;
+    std::atomic_signal_fence(std::memory_order_acquire);
+    uint64_t path = 0;
+    for (uint32_t i = 0; i < depth && i < MTS_PROFILE_STACK_DEPTH; ++i)
+        path |= (uint64_t) (state.stack[i] + 1u) << (8 * i);
+    return path;
+}
+
+/// Decode a packed call path into phase names (outermost first)
+static std::vector<const char *> profiler_decode_path(uint64_t path) {
+    std::vector<const char *> result;
+    for (int i = 0; i < MTS_PROFILE_STACK_DEPTH; ++i) {
+        uint32_t id = (path >> (8 * i)) & 0xff;
+        if (id == 0)
+            break;
+        result.push_back(profiler_phase_id[id - 1]);
+    }
+    return result;
+}
 
 static void profiler_callback(int, siginfo_t *, void *) {
-    uint64_t flags = *profiler_flags();
+    ProfilerThreadData *data = profiler_tls;
+    if (!data)
+        return; // Thread has never entered a profiled phase
+
+    uint64_t path = profiler_encode_path(data->state);
 
     uint64_t bucket_id =
-        std::hash<uint64_t>{}(flags) % (profiler_samples.size() - 1);
+        std::hash<uint64_t>{}(path) % (data->samples.size() - 1);
 
     // Hash table with linear probing
     size_t tries = 0;
-    while (tries < profiler_samples.size()) {
-        ProfilerSample &bucket = profiler_samples[bucket_id];
-        if (bucket.flags == (uint64_t) -1 || bucket.flags == flags)
+    while (tries < data->samples.size()) {
+        ProfilerSample &bucket = data->samples[bucket_id];
+        if (bucket.path == (uint64_t) -1 || bucket.path == path)
             break;
-        if (++bucket_id == profiler_samples.size())
+        if (++bucket_id == data->samples.size())
             bucket_id = 0;
         ++tries;
     }
 
-    if (tries == profiler_samples.size()) {
+    if (tries == data->samples.size()) {
         Log(Warn, "Profiler hash table filled up -- you may need to increase "
                   "MTS_PROFILE_HASH_SIZE.");
         return;
     }
 
-    ProfilerSample &bucket = profiler_samples[bucket_id];
-    bucket.flags = flags;
+    ProfilerSample &bucket = data->samples[bucket_id];
+    bucket.path = path;
     bucket.count++;
+
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ProfilerTraceEvent &event =
+        data->trace[data->trace_pos & (MTS_PROFILE_TRACE_SIZE - 1)];
+    event.time_us = (uint64_t) ts.tv_sec * 1000000ull +
+                    (uint64_t) ts.tv_nsec / 1000ull;
+    event.path = path;
+    data->trace_pos++;
 }
 
 void Profiler::static_initialization() {
     if (!util::detect_debugger()) {
-        (void) profiler_flags();
+        (void) profiler_state();
 
         struct sigaction sa;
         memset(&sa, 0, sizeof(sa));
@@ -64,7 +237,7 @@ void Profiler::static_initialization() {
 
         itimerval timer;
         timer.it_interval.tv_sec = 0;
-        timer.it_interval.tv_usec = 1000000 / 100; // 100 Hz sampling
+        timer.it_interval.tv_usec = MTS_PROFILE_INTERVAL_US;
         timer.it_value = timer.it_interval;
 
         if (setitimer(ITIMER_PROF, &timer, nullptr))
@@ -85,6 +258,99 @@ void Profiler::static_shutdown() {
         Throw("profiler_stop(): failure in setitimer(): %s", strerror(errno));
 }
 
+std::vector<std::pair<std::string, uint64_t>> Profiler::flat_profile() {
+    std::map<std::string, uint64_t> leaf_results;
+
+    std::lock_guard<std::mutex> lock(profiler_mutex);
+    for (const auto &thread : profiler_threads) {
+        for (auto const &sample : thread->samples) {
+            if (sample.count == 0)
+                continue;
+
+            auto path = profiler_decode_path(sample.path);
+            leaf_results[path.empty() ? "Idle" : path.back()] += sample.count;
+        }
+    }
+
+    std::vector<std::pair<std::string, uint64_t>> result;
+    result.reserve(leaf_results.size());
+    for (const auto &r : leaf_results)
+        result.push_back(r);
+
+    std::sort(result.begin(), result.end(),
+              [](auto a, auto b) { return a.second > b.second; });
+
+    return result;
+}
+
+void Profiler::write_trace(const std::string &filename) {
+    std::ofstream os(filename);
+    if (!os.good())
+        Throw("write_trace(): could not open file \"%s\"!", filename);
+
+    std::lock_guard<std::mutex> lock(profiler_mutex);
+
+    os << "{\"traceEvents\":[";
+    bool first = true;
+
+    for (const auto &thread : profiler_threads) {
+        uint64_t count = std::min(thread->trace_pos,
+                                  (uint64_t) MTS_PROFILE_TRACE_SIZE),
+                 start = thread->trace_pos - count;
+
+        /* Merge runs of consecutive samples with an identical call path
+           into a single duration event */
+        for (uint64_t i = 0; i < count; ) {
+            const ProfilerTraceEvent &event =
+                thread->trace[(start + i) & (MTS_PROFILE_TRACE_SIZE - 1)];
+
+            uint64_t j = i + 1, end_time = event.time_us;
+            while (j < count) {
+                const ProfilerTraceEvent &next =
+                    thread->trace[(start + j) & (MTS_PROFILE_TRACE_SIZE - 1)];
+                if (next.path != event.path ||
+                    next.time_us - end_time > 2 * MTS_PROFILE_INTERVAL_US)
+                    break;
+                end_time = next.time_us;
+                ++j;
+            }
+
+            auto path = profiler_decode_path(event.path);
+            std::string name = path.empty() ? "Idle" : path.back(),
+                        full_path;
+            for (size_t k = 0; k < path.size(); ++k) {
+                if (k > 0)
+                    full_path += "/";
+                full_path += path[k];
+            }
+
+            if (!first)
+                os << ",";
+            first = false;
+            os << "{\"name\":\"" << name << "\",\"cat\":\"phase\","
+               << "\"ph\":\"X\",\"ts\":" << event.time_us
+               << ",\"dur\":" << (end_time - event.time_us + MTS_PROFILE_INTERVAL_US)
+               << ",\"pid\":0,\"tid\":" << thread->thread_index
+               << ",\"args\":{\"path\":\"" << full_path << "\"}}";
+
+            i = j;
+        }
+    }
+
+    os << "]}" << std::endl;
+
+    Log(Info, "Wrote chrome://tracing profile to \"%s\".", filename);
+}
+
+void Profiler::clear() {
+    std::lock_guard<std::mutex> lock(profiler_mutex);
+    for (const auto &thread : profiler_threads) {
+        for (auto &sample : thread->samples)
+            sample = ProfilerSample();
+        thread->trace_pos = 0;
+    }
+}
+
 void Profiler::print_report() {
     using SampleMap = std::map<std::string, uint64_t>;
 
@@ -92,45 +358,48 @@ void Profiler::print_report() {
              buckets_used = 0;
 
     SampleMap leaf_results, hierarchical_results;
+    std::map<std::string, std::set<uint32_t>> leaf_threads;
 
     size_t prefix_length = 0;
     size_t max_indent = 0;
 
-    for (auto const &sample: profiler_samples) {
-        if (sample.count == 0)
-            continue;
-        uint64_t sample_flags = sample.flags;
-
-        event_count_total += sample.count;
-        buckets_used++;
-
-        size_t indent = 0;
-        std::string name_hierarchical;
-        for (int i = 0; i < int(ProfilerPhase::ProfilerPhaseCount); ++i) {
-            uint64_t flag = 1ull << i;
-            if (sample_flags & flag) {
-                const char *name = profiler_phase_id[i];
-                if (!name_hierarchical.empty())
-                    name_hierarchical += "/";
-                name_hierarchical += name;
-                prefix_length = std::max(prefix_length, strlen(name));
-                hierarchical_results[name_hierarchical] += sample.count;
-                sample_flags &= ~flag;
-                if (sample_flags == 0)
-                    leaf_results[name] += sample.count;
-                indent += 1;
+    size_t thread_count;
+    {
+        std::lock_guard<std::mutex> lock(profiler_mutex);
+        thread_count = profiler_threads.size();
+
+        for (const auto &thread : profiler_threads) {
+            for (auto const &sample : thread->samples) {
+                if (sample.count == 0)
+                    continue;
+
+                event_count_total += sample.count;
+                buckets_used++;
+
+                auto path = profiler_decode_path(sample.path);
+
+                std::string name_hierarchical;
+                for (const char *name : path) {
+                    if (!name_hierarchical.empty())
+                        name_hierarchical += "/";
+                    name_hierarchical += name;
+                    prefix_length = std::max(prefix_length, strlen(name));
+                    hierarchical_results[name_hierarchical] += sample.count;
+                }
+                max_indent = std::max(path.size(), max_indent);
+
+                const char *leaf = path.empty() ? "Idle" : path.back();
+                leaf_results[leaf] += sample.count;
+                leaf_threads[leaf].insert(thread->thread_index);
+                if (path.empty())
+                    hierarchical_results["Idle"] += sample.count;
             }
-            max_indent = std::max(indent, max_indent);
-        }
-
-        if (name_hierarchical.empty()) {
-            hierarchical_results["Idle"] += sample.count;
-            leaf_results["Idle"] += sample.count;
         }
     }
 
-    Log(Info, "Recorded %i samples, used %i/%i hash table entries.",
-        event_count_total, buckets_used, profiler_samples.size());
+    Log(Info, "Recorded %i samples over %i threads, used %i/%i hash table entries.",
+        event_count_total, thread_count, buckets_used,
+        thread_count * MTS_PROFILE_HASH_SIZE);
 
     if (event_count_total < 250)
         Log(Warn, "Collected very few samples -- perform a longer "
@@ -168,9 +437,10 @@ void Profiler::print_report() {
 
     Log(Info, "\U000023F1  Profile (flat):");
     for (auto kv : leaf_results_sorted) {
-        Log(Info, "    %s%s%.2f%%", kv.first,
+        Log(Info, "    %s%s%.2f%% (%i threads)", kv.first,
             std::string(prefix_length - kv.first.length() - 4, ' '),
-            kv.second / float(event_count_total) * 100.f);
+            kv.second / float(event_count_total) * 100.f,
+            leaf_threads[kv.first].size());
     }
 }
 
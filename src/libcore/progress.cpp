@@ -1,9 +1,12 @@
 #include <mitsuba/core/progress.h>
 #include <mitsuba/core/logger.h>
 #include <cmath>
+#include <cstdio>
 
 NAMESPACE_BEGIN(mitsuba)
 
+bool ProgressReporter::m_machine_readable = false;
+
 ProgressReporter::ProgressReporter(const std::string &label, void *payload)
     : m_label(label), m_line(util::terminal_width() + 1, ' '),
       m_bar_start(label.length() + 3), m_bar_size(0), m_payload(payload) {
@@ -23,23 +26,68 @@ ProgressReporter::ProgressReporter(const std::string &label, void *payload)
 
     m_last_update = 0;
     m_last_progress = -1.f;
+    m_progress = 0.f;
+
+    /* Formatting and output happen on a dedicated helper thread; capture
+       the creating thread's logger, as the helper is not registered with
+       the thread system */
+    m_logger = Thread::thread()->logger();
+    m_thread = std::thread([this]() { run(); });
 }
 
-ProgressReporter::~ProgressReporter() { }
+ProgressReporter::~ProgressReporter() {
+    /* Critical section */ {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_done = true;
+    }
+    m_cv.notify_one();
+    m_thread.join();
+}
 
 void ProgressReporter::update(float progress) {
     progress = std::min(std::max(progress, 0.f), 1.f);
+    m_progress.store(progress, std::memory_order_relaxed);
+
+    // Show the completed state promptly rather than at the next tick
+    if (progress == 1.f)
+        m_cv.notify_one();
+}
+
+void ProgressReporter::set_callback(Callback callback) {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_callback = std::move(callback);
+}
+
+void ProgressReporter::set_machine_readable(bool value) {
+    m_machine_readable = value;
+}
 
-    if (progress == m_last_progress)
-        return;
+void ProgressReporter::run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
 
-    size_t elapsed = m_timer.value();
-    if (progress != 1.f && (elapsed - m_last_update < 500 ||
-                            std::abs(progress - m_last_progress) < 0.01f))
-        return; // Don't refresh too often
+    while (true) {
+        m_cv.wait_for(lock, std::chrono::milliseconds(100));
 
-    float remaining = elapsed / progress * (1 - progress);
-    std::string eta = "(" + util::time_string(elapsed) + ", ETA: " + util::time_string(remaining) + ")";
+        bool done = m_done;
+        float progress = m_progress.load(std::memory_order_relaxed);
+
+        /* Skip ticks without measurable movement; the final value is
+           always emitted */
+        if (progress != m_last_progress &&
+            (progress == 1.f || done ||
+             progress - m_last_progress >= 1e-3f))
+            emit(progress, m_timer.value());
+
+        if (done)
+            break;
+    }
+}
+
+void ProgressReporter::emit(float progress, size_t elapsed) {
+    float remaining =
+        progress > 0.f ? elapsed / progress * (1.f - progress) : 0.f;
+    std::string eta = "(" + util::time_string(elapsed) +
+                      ", ETA: " + util::time_string(remaining) + ")";
     if (eta.length() > 22)
         eta.resize(22);
 
@@ -51,8 +99,29 @@ void ProgressReporter::update(float progress) {
         memcpy((char *) m_line.data() + eta_pos, eta.data(), eta.length());
     }
 
-    Thread::thread()->logger()->log_progress(progress, m_label, m_line,
-                                             eta, m_payload);
+    /* In machine-readable mode, the JSON lines below replace the
+       interactive progress bar, which would otherwise clutter the
+       consumer's input with escape sequences */
+    if (!m_machine_readable)
+        m_logger->log_progress(progress, m_label, m_line, eta, m_payload);
+
+    if (m_callback)
+        m_callback(progress, elapsed);
+
+    if (m_machine_readable) {
+        char buf[256];
+        int length = snprintf(
+            buf, sizeof(buf),
+            "{\"type\": \"progress\", \"label\": \"%s\", \"progress\": %.4f, "
+            "\"elapsed\": %.3f, \"eta\": %.3f}\n",
+            m_label.c_str(), progress, elapsed / 1000.0, remaining / 1000.0);
+        if (length > 0) {
+            fwrite(buf, 1, std::min((size_t) length, sizeof(buf) - 1), stdout);
+            fflush(stdout);
+        }
+    }
+
+    m_last_progress = progress;
     m_last_update = elapsed;
 }
 
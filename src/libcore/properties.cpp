@@ -3,10 +3,12 @@
 #  define _ENABLE_EXTENDED_ALIGNED_STORAGE
 #endif
 
+#include <algorithm>
 #include <cstdlib>
 #include <iostream>
-#include <map>
+#include <mutex>
 #include <sstream>
+#include <unordered_set>
 
 #include <mitsuba/core/logger.h>
 #include <mitsuba/core/properties.h>
@@ -58,37 +60,120 @@ struct SortKey {
     }
 };
 
+/**
+ * \brief Global atom table for property names
+ *
+ * Property names repeat heavily across the tens of thousands of objects of
+ * large scenes ("filename", "to_world", ...), so each distinct name is
+ * stored exactly once and entries merely reference it. References into a
+ * \c std::unordered_set remain stable across insertions, and atoms live
+ * until program termination.
+ */
+static const std::string *intern(const std::string &name) {
+    static std::mutex mutex;
+    static std::unordered_set<std::string> atoms;
+    std::lock_guard<std::mutex> lock(mutex);
+    return &*atoms.insert(name).first;
+}
+
 struct Properties::PropertiesPrivate {
-    std::map<std::string, Entry, SortKey> entries;
+    /* Entries are stored in a compact vector in insertion order. A small
+       open-addressed table maps name hashes to vector slots so that the
+       accessor lookups performed by every plugin constructor run in O(1)
+       without the pointer chasing and repeated string comparisons of a
+       tree-based map. Buckets store slot + 1; zero denotes an empty bucket. */
+    std::vector<std::pair<const std::string *, Entry>> entries;
+    std::vector<uint32_t> table;
     std::string id, plugin_name;
+
+    size_t find_index(const std::string &name) const {
+        if (entries.empty())
+            return (size_t) -1;
+        size_t mask   = table.size() - 1,
+               bucket = std::hash<std::string>()(name) & mask;
+        while (true) {
+            uint32_t slot = table[bucket];
+            if (slot == 0)
+                return (size_t) -1;
+            if (*entries[slot - 1].first == name)
+                return slot - 1;
+            bucket = (bucket + 1) & mask;
+        }
+    }
+
+    Entry *find(const std::string &name) {
+        size_t index = find_index(name);
+        return index == (size_t) -1 ? nullptr : &entries[index].second;
+    }
+
+    const Entry *find(const std::string &name) const {
+        size_t index = find_index(name);
+        return index == (size_t) -1 ? nullptr : &entries[index].second;
+    }
+
+    /// Return the entry with the given name, creating it if needed
+    Entry &insert(const std::string &name) {
+        if (Entry *entry = find(name))
+            return *entry;
+        if ((entries.size() + 1) * 2 > table.size())
+            rehash(std::max((size_t) 8, table.size() * 2));
+        entries.emplace_back(intern(name), Entry());
+        size_t mask   = table.size() - 1,
+               bucket = std::hash<std::string>()(name) & mask;
+        while (table[bucket] != 0)
+            bucket = (bucket + 1) & mask;
+        table[bucket] = (uint32_t) entries.size();
+        return entries.back().second;
+    }
+
+    bool erase(const std::string &name) {
+        size_t index = find_index(name);
+        if (index == (size_t) -1)
+            return false;
+        entries.erase(entries.begin() + index);
+        rehash(table.size());
+        return true;
+    }
+
+    void rehash(size_t capacity) {
+        table.assign(capacity, 0);
+        size_t mask = capacity - 1;
+        for (size_t i = 0; i < entries.size(); ++i) {
+            size_t bucket = std::hash<std::string>()(*entries[i].first) & mask;
+            while (table[bucket] != 0)
+                bucket = (bucket + 1) & mask;
+            table[bucket] = (uint32_t) (i + 1);
+        }
+    }
 };
 
 #define DEFINE_PROPERTY_ACCESSOR(Type, TagName, SetterName, GetterName) \
     void Properties::SetterName(const std::string &name, Type const &value, bool warn_duplicates) { \
         if (has_property(name) && warn_duplicates) \
             Log(Warn, "Property \"%s\" was specified multiple times!", name); \
-        d->entries[name].data = (Type) value; \
-        d->entries[name].queried = false; \
+        Entry &entry = d->insert(name); \
+        entry.data = (Type) value; \
+        entry.queried = false; \
     } \
     \
     Type const & Properties::GetterName(const std::string &name) const { \
-        const auto it = d->entries.find(name); \
-        if (it == d->entries.end()) \
+        Entry *entry = d->find(name); \
+        if (!entry) \
             Throw("Property \"%s\" has not been specified!", name); \
-        if (!it->second.data.is<Type>()) \
+        if (!entry->data.is<Type>()) \
             Throw("The property \"%s\" has the wrong type (expected <" #TagName ">).", name); \
-        it->second.queried = true; \
-        return (Type const &) it->second.data; \
+        entry->queried = true; \
+        return (Type const &) entry->data; \
     } \
     \
     Type const & Properties::GetterName(const std::string &name, Type const &def_val) const { \
-        const auto it = d->entries.find(name); \
-        if (it == d->entries.end()) \
+        Entry *entry = d->find(name); \
+        if (!entry) \
             return def_val; \
-        if (!it->second.data.is<Type>()) \
+        if (!entry->data.is<Type>()) \
             Throw("The property \"%s\" has the wrong type (expected <" #TagName ">).", name); \
-        it->second.queried = true; \
-        return (Type const &) it->second.data; \
+        entry->queried = true; \
+        return (Type const &) entry->data; \
     }
 
 DEFINE_PROPERTY_ACCESSOR(bool,              boolean,   set_bool,              bool_)
@@ -122,7 +207,7 @@ void Properties::operator=(const Properties &props) {
 }
 
 bool Properties::has_property(const std::string &name) const {
-    return d->entries.find(name) != d->entries.end();
+    return d->find(name) != nullptr;
 }
 
 namespace {
@@ -161,34 +246,41 @@ namespace {
 }
 
 Properties::Type Properties::type(const std::string &name) const {
-    const auto it = d->entries.find(name);
-    if (it == d->entries.end())
+    const Entry *entry = d->find(name);
+    if (!entry)
         Throw("type(): Could not find property named \"%s\"!", name);
 
-    return it->second.data.visit(PropertyTypeVisitor());
+    return entry->data.visit(PropertyTypeVisitor());
 }
 
 bool Properties::mark_queried(const std::string &name) const {
-    auto it = d->entries.find(name);
-    if (it == d->entries.end())
+    Entry *entry = d->find(name);
+    if (!entry)
         return false;
-    it->second.queried = true;
+    entry->queried = true;
     return true;
 }
 
+size_t Properties::mark_queried(const std::vector<std::string> &names) const {
+    size_t found = 0;
+    for (const std::string &name : names) {
+        if (Entry *entry = d->find(name)) {
+            entry->queried = true;
+            ++found;
+        }
+    }
+    return found;
+}
+
 bool Properties::was_queried(const std::string &name) const {
-    const auto it = d->entries.find(name);
-    if (it == d->entries.end())
+    const Entry *entry = d->find(name);
+    if (!entry)
         Throw("Could not find property named \"%s\"!", name);
-    return it->second.queried;
+    return entry->queried;
 }
 
 bool Properties::remove_property(const std::string &name) {
-    const auto it = d->entries.find(name);
-    if (it == d->entries.end())
-        return false;
-    d->entries.erase(it);
-    return true;
+    return d->erase(name);
 }
 
 const std::string &Properties::plugin_name() const {
@@ -210,16 +302,31 @@ void Properties::set_id(const std::string &id) {
 void Properties::copy_attribute(const Properties &properties,
                                 const std::string &source_name,
                                 const std::string &target_name) {
-    const auto it = properties.d->entries.find(source_name);
-    if (it == properties.d->entries.end())
+    const Entry *entry = properties.d->find(source_name);
+    if (!entry)
         Throw("copy_attribute(): Could not find parameter \"%s\"!", source_name);
-    d->entries[target_name] = it->second;
+    d->insert(target_name) = *entry;
 }
 
 std::vector<std::string> Properties::property_names() const {
+    /* Enumeration APIs report entries in natural sort order, matching the
+       behavior of the tree-based map that previously backed this class */
     std::vector<std::string> result;
+    result.reserve(d->entries.size());
     for (const auto &e : d->entries)
-        result.push_back(e.first);
+        result.push_back(*e.first);
+    std::sort(result.begin(), result.end(), SortKey());
+    return result;
+}
+
+std::vector<std::string> Properties::string_values() const {
+    std::vector<std::string> result;
+    for (const auto &e : d->entries) {
+        auto type = e.second.data.visit(PropertyTypeVisitor());
+        if (type != Type::String)
+            continue;
+        result.push_back((const std::string &) e.second.data);
+    }
     return result;
 }
 
@@ -231,9 +338,11 @@ std::vector<std::pair<std::string, NamedReference>> Properties::named_references
         if (type != Type::NamedReference)
             continue;
         auto const &value = (const NamedReference &) e.second.data;
-        result.push_back(std::make_pair(e.first, value));
+        result.push_back(std::make_pair(*e.first, value));
         e.second.queried = true;
     }
+    std::sort(result.begin(), result.end(),
+              [](const auto &a, const auto &b) { return SortKey()(a.first, b.first); });
     return result;
 }
 
@@ -244,9 +353,11 @@ std::vector<std::pair<std::string, ref<Object>>> Properties::objects() const {
         auto type = e.second.data.visit(PropertyTypeVisitor());
         if (type != Type::Object)
             continue;
-        result.push_back(std::make_pair(e.first, (const ref<Object> &) e.second));
+        result.push_back(std::make_pair(*e.first, (const ref<Object> &) e.second.data));
         e.second.queried = true;
     }
+    std::sort(result.begin(), result.end(),
+              [](const auto &a, const auto &b) { return SortKey()(a.first, b.first); });
     return result;
 }
 
@@ -254,14 +365,15 @@ std::vector<std::string> Properties::unqueried() const {
     std::vector<std::string> result;
     for (const auto &e : d->entries) {
         if (!e.second.queried)
-            result.push_back(e.first);
+            result.push_back(*e.first);
     }
+    std::sort(result.begin(), result.end(), SortKey());
     return result;
 }
 
 void Properties::merge(const Properties &p) {
     for (const auto &e : p.d->entries)
-        d->entries[e.first] = e.second;
+        d->insert(*e.first) = e.second;
 }
 
 bool Properties::operator==(const Properties &p) const {
@@ -271,10 +383,8 @@ bool Properties::operator==(const Properties &p) const {
         return false;
 
     for (const auto &e : d->entries) {
-        auto it = p.d->entries.find(e.first);
-        if (it == p.d->entries.end())
-            return false;
-        if (e.second.data != it->second.data)
+        const Entry *entry = p.d->find(*e.first);
+        if (!entry || e.second.data != entry->data)
             return false;
     }
 
@@ -282,46 +392,39 @@ bool Properties::operator==(const Properties &p) const {
 }
 
 std::string Properties::as_string(const std::string &name) const {
+    const Entry *entry = d->find(name);
+    if (!entry)
+        Throw("Property \"%s\" has not been specified!", name);
     std::ostringstream oss;
-    bool found = false;
-    for (auto &e : d->entries) {
-        if (e.first != name)
-            continue;
-        e.second.data.visit(StreamVisitor(oss));
-        found = true;
-        break;
-    }
-    if (!found)
-        Throw("Property \"%s\" has not been specified!", name); \
+    entry->data.visit(StreamVisitor(oss));
     return oss.str();
 }
 
 std::string Properties::as_string(const std::string &name, const std::string &def_val) const {
-    std::ostringstream oss;
-    bool found = false;
-    for (auto &e : d->entries) {
-        if (e.first != name)
-            continue;
-        e.second.data.visit(StreamVisitor(oss));
-        found = true;
-        break;
-    }
-    if (!found)
+    const Entry *entry = d->find(name);
+    if (!entry)
         return def_val;
+    std::ostringstream oss;
+    entry->data.visit(StreamVisitor(oss));
     return oss.str();
 }
 
 std::ostream &operator<<(std::ostream &os, const Properties &p) {
-    auto it = p.d->entries.begin();
+    std::vector<const std::pair<const std::string *, Entry> *> entries;
+    entries.reserve(p.d->entries.size());
+    for (const auto &e : p.d->entries)
+        entries.push_back(&e);
+    std::sort(entries.begin(), entries.end(),
+              [](const auto *a, const auto *b) { return SortKey()(*a->first, *b->first); });
 
     os << "Properties[" << std::endl
        << "  plugin_name = \"" << (p.d->plugin_name) << "\"," << std::endl
        << "  id = \"" << p.d->id << "\"," << std::endl
        << "  elements = {" << std::endl;
-    while (it != p.d->entries.end()) {
-        os << "    \"" << it->first << "\" -> ";
-        it->second.data.visit(StreamVisitor(os));
-        if (++it != p.d->entries.end()) os << ",";
+    for (size_t i = 0; i < entries.size(); ++i) {
+        os << "    \"" << *entries[i]->first << "\" -> ";
+        entries[i]->second.data.visit(StreamVisitor(os));
+        if (i + 1 < entries.size()) os << ",";
         os << std::endl;
     }
     os << "  }" << std::endl
@@ -336,32 +439,32 @@ std::ostream &operator<<(std::ostream &os, const Properties &p) {
 
 // size_t getter
 size_t Properties::size_(const std::string &name) const {
-    const auto it = d->entries.find(name);
-    if (it == d->entries.end())
+    Entry *entry = d->find(name);
+    if (!entry)
         Throw("Property \"%s\" has not been specified!", name);
-    if (!it->second.data.is<int64_t>())
+    if (!entry->data.is<int64_t>())
         Throw("The property \"%s\" has the wrong type (expected <integer>).", name);
 
-    auto v = (int64_t) it->second.data;
+    auto v = (int64_t) entry->data;
     if (v < 0) {
         Throw("Property \"%s\" has negative value %i, but was queried as a"
               " size_t (unsigned).", name, v);
     }
-    it->second.queried = true;
+    entry->queried = true;
     return (size_t) v;
 }
 // size_t getter (with default value)
 size_t Properties::size_(const std::string &name, const size_t &def_val) const {
-    const auto it = d->entries.find(name);
-    if (it == d->entries.end())
+    Entry *entry = d->find(name);
+    if (!entry)
         return def_val;
 
-    auto v = (int64_t) it->second.data;
+    auto v = (int64_t) entry->data;
     if (v < 0) {
         Throw("Property \"%s\" has negative value %i, but was queried as a"
               " size_t (unsigned).", name, v);
     }
-    it->second.queried = true;
+    entry->queried = true;
     return (size_t) v;
 }
 
@@ -371,8 +474,9 @@ void Properties::set_animated_transform(const std::string &name,
                                         bool warn_duplicates) {
     if (has_property(name) && warn_duplicates)
         Log(Warn, "Property \"%s\" was specified multiple times!", name);
-    d->entries[name].data = ref<Object>(value.get());
-    d->entries[name].queried = false;
+    Entry &entry = d->insert(name);
+    entry.data = ref<Object>(value.get());
+    entry.queried = false;
 }
 
 /// AnimatedTransform setter (from a simple Transform).
@@ -385,50 +489,50 @@ void Properties::set_animated_transform(const std::string &name,
 
 /// AnimatedTransform getter (without default value).
 ref<AnimatedTransform> Properties::animated_transform(const std::string &name) const {
-    const auto it = d->entries.find(name);
-    if (it == d->entries.end())
+    Entry *entry = d->find(name);
+    if (!entry)
         Throw("Property \"%s\" has not been specified!", name);
-    if (it->second.data.is<Transform4f>()) {
+    if (entry->data.is<Transform4f>()) {
         // Also accept simple transforms, from which we can build
         // an AnimatedTransform.
-        it->second.queried = true;
+        entry->queried = true;
         return new AnimatedTransform(
-            static_cast<const Transform4f &>(it->second.data));
+            static_cast<const Transform4f &>(entry->data));
     }
-    if (!it->second.data.is<ref<Object>>()) {
+    if (!entry->data.is<ref<Object>>()) {
         Throw("The property \"%s\" has the wrong type (expected "
               " <animated_transform> or <transform>).", name);
     }
-    ref<Object> o = it->second.data;
+    ref<Object> o = entry->data;
     if (!o->class_()->derives_from(MTS_CLASS(AnimatedTransform)))
         Throw("The property \"%s\" has the wrong type (expected "
               " <animated_transform> or <transform>).", name);
-    it->second.queried = true;
+    entry->queried = true;
     return (AnimatedTransform *) o.get();
 }
 
 /// AnimatedTransform getter (with default value).
 ref<AnimatedTransform> Properties::animated_transform(
         const std::string &name, ref<AnimatedTransform> def_val) const {
-    const auto it = d->entries.find(name);
-    if (it == d->entries.end())
+    Entry *entry = d->find(name);
+    if (!entry)
         return def_val;
-    if (it->second.data.is<Transform4f>()) {
+    if (entry->data.is<Transform4f>()) {
         // Also accept simple transforms, from which we can build
         // an AnimatedTransform.
-        it->second.queried = true;
+        entry->queried = true;
         return new AnimatedTransform(
-            static_cast<const Transform4f &>(it->second.data));
+            static_cast<const Transform4f &>(entry->data));
     }
-    if (!it->second.data.is<ref<Object>>()) {
+    if (!entry->data.is<ref<Object>>()) {
         Throw("The property \"%s\" has the wrong type (expected "
               " <animated_transform> or <transform>).", name);
     }
-    ref<Object> o = it->second.data;
+    ref<Object> o = entry->data;
     if (!o->class_()->derives_from(MTS_CLASS(AnimatedTransform)))
         Throw("The property \"%s\" has the wrong type (expected "
               " <animated_transform> or <transform>).", name);
-    it->second.queried = true;
+    entry->queried = true;
     return (AnimatedTransform *) o.get();
 }
 
@@ -439,14 +543,14 @@ ref<AnimatedTransform> Properties::animated_transform(
 }
 
 ref<Object> Properties::find_object(const std::string &name) const {
-    const auto it = d->entries.find(name);
-    if (it == d->entries.end())
+    const Entry *entry = d->find(name);
+    if (!entry)
         return ref<Object>();
 
-    if (!it->second.data.is<ref<Object>>())
+    if (!entry->data.is<ref<Object>>())
         Throw("The property \"%s\" has the wrong type.", name);
 
-    return it->second.data;
+    return entry->data;
 }
 
 NAMESPACE_END(mitsuba)
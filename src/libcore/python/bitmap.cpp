@@ -9,7 +9,7 @@ MTS_PY_EXPORT(Bitmap) {
     MTS_IMPORT_CORE_TYPES()
     using ReconstructionFilter = typename Bitmap::ReconstructionFilter;
 
-    auto bitmap = MTS_PY_CLASS(Bitmap, Object);
+    auto bitmap = MTS_PY_CLASS(Bitmap, Object, py::buffer_protocol());
 
     py::enum_<Bitmap::PixelFormat>(bitmap, "PixelFormat", D(Bitmap, PixelFormat))
         .value("Y",     Bitmap::PixelFormat::Y,     D(Bitmap, PixelFormat, Y))
@@ -33,6 +33,19 @@ MTS_PY_EXPORT(Bitmap) {
         .value("Unknown", Bitmap::FileFormat::Unknown, D(Bitmap, FileFormat, Unknown))
         .value("Auto",    Bitmap::FileFormat::Auto,    D(Bitmap, FileFormat, Auto));
 
+    py::enum_<Bitmap::Compression>(bitmap, "Compression", D(Bitmap, Compression))
+        .value("Default", Bitmap::Compression::Default, D(Bitmap, Compression, Default))
+        .value("None_",   Bitmap::Compression::None,    D(Bitmap, Compression, None))
+        .value("RLE",     Bitmap::Compression::RLE,     D(Bitmap, Compression, RLE))
+        .value("ZIPS",    Bitmap::Compression::ZIPS,    D(Bitmap, Compression, ZIPS))
+        .value("ZIP",     Bitmap::Compression::ZIP,     D(Bitmap, Compression, ZIP))
+        .value("PIZ",     Bitmap::Compression::PIZ,     D(Bitmap, Compression, PIZ))
+        .value("PXR24",   Bitmap::Compression::PXR24,   D(Bitmap, Compression, PXR24))
+        .value("B44",     Bitmap::Compression::B44,     D(Bitmap, Compression, B44))
+        .value("B44A",    Bitmap::Compression::B44A,    D(Bitmap, Compression, B44A))
+        .value("DWAA",    Bitmap::Compression::DWAA,    D(Bitmap, Compression, DWAA))
+        .value("DWAB",    Bitmap::Compression::DWAB,    D(Bitmap, Compression, DWAB));
+
     bitmap.def(py::init<Bitmap::PixelFormat, Struct::Type, const Vector2u &, size_t>(),
             "pixel_format"_a, "component_format"_a, "size"_a, "channel_count"_a = 0,
             D(Bitmap, Bitmap))
@@ -58,12 +71,23 @@ MTS_PY_EXPORT(Bitmap) {
             if (!pixel_format_.is_none())
                 pixel_format = pixel_format_.cast<Bitmap::PixelFormat>();
 
+            /* Zero-copy path: when the array is stored contiguously and
+               writable, wrap its memory instead of copying it. The
+               'keep_alive' annotation below ties the array's lifetime to
+               that of the bitmap. */
+            if ((obj.flags() & py::array::c_style) && obj.writeable()) {
+                Vector2u size(obj.shape()[1], obj.shape()[0]);
+                return new Bitmap(pixel_format, component_format, size,
+                                  channel_count, (uint8_t *) obj.mutable_data());
+            }
+
             obj = py::array::ensure(obj, py::array::c_style);
             Vector2u size(obj.shape()[1], obj.shape()[0]);
             auto bitmap = new Bitmap(pixel_format, component_format, size, channel_count);
             memcpy(bitmap->data(), obj.data(), bitmap->buffer_size());
             return bitmap;
-        }), "array"_a, "pixel_format"_a = py::none(), "Initialize a Bitmap from a NumPy array")
+        }), "array"_a, "pixel_format"_a = py::none(), py::keep_alive<1, 2>(),
+            "Initialize a Bitmap from a NumPy array (without copying, if possible)")
         .def(py::init<const Bitmap &>())
         .def_method(Bitmap, pixel_format)
         .def_method(Bitmap, component_format)
@@ -142,22 +166,58 @@ MTS_PY_EXPORT(Bitmap) {
             "format"_a = Bitmap::FileFormat::Auto,
             py::call_guard<py::gil_scoped_release>())
         .def("write",
-            py::overload_cast<Stream *, Bitmap::FileFormat, int>(
+            py::overload_cast<Stream *, Bitmap::FileFormat, int, Bitmap::Compression>(
                 &Bitmap::write, py::const_),
             "stream"_a, "format"_a = Bitmap::FileFormat::Auto, "quality"_a = -1,
+            "compression"_a = Bitmap::Compression::Default,
             D(Bitmap, write), py::call_guard<py::gil_scoped_release>())
         .def("write",
-            py::overload_cast<const fs::path &, Bitmap::FileFormat, int>(
+            py::overload_cast<const fs::path &, Bitmap::FileFormat, int, Bitmap::Compression>(
                 &Bitmap::write, py::const_),
             "path"_a, "format"_a = Bitmap::FileFormat::Auto, "quality"_a = -1,
+            "compression"_a = Bitmap::Compression::Default,
             D(Bitmap, write, 2), py::call_guard<py::gil_scoped_release>())
         .def("write_async",
-            py::overload_cast<const fs::path &, Bitmap::FileFormat, int>(
+            py::overload_cast<const fs::path &, Bitmap::FileFormat, int, Bitmap::Compression>(
                 &Bitmap::write_async, py::const_),
             "path"_a, "format"_a = Bitmap::FileFormat::Auto, "quality"_a = -1,
+            "compression"_a = Bitmap::Compression::Default,
             D(Bitmap, write_async))
         .def("split", &Bitmap::split, D(Bitmap, split))
         .def_static("detect_file_format", &Bitmap::detect_file_format, D(Bitmap, detect_file_format))
+        /* Expose the pixel storage as a writable buffer-protocol view. NumPy
+           arrays created from it (np.asarray(bitmap)) reference the bitmap's
+           memory directly and keep the bitmap alive. */
+        .def_buffer([](Bitmap &bitmap) -> py::buffer_info {
+            if (bitmap.struct_()->field_count() == 0)
+                Throw("Bitmap::__buffer__(): no channels!");
+            auto field = bitmap.struct_()->operator[](0);
+
+            std::string format;
+            switch (field.type) {
+                case Struct::Type::Int8:    format = py::format_descriptor<int8_t>::format();   break;
+                case Struct::Type::UInt8:   format = py::format_descriptor<uint8_t>::format();  break;
+                case Struct::Type::Int16:   format = py::format_descriptor<int16_t>::format();  break;
+                case Struct::Type::UInt16:  format = py::format_descriptor<uint16_t>::format(); break;
+                case Struct::Type::Int32:   format = py::format_descriptor<int32_t>::format();  break;
+                case Struct::Type::UInt32:  format = py::format_descriptor<uint32_t>::format(); break;
+                case Struct::Type::Int64:   format = py::format_descriptor<int64_t>::format();  break;
+                case Struct::Type::UInt64:  format = py::format_descriptor<uint64_t>::format(); break;
+                case Struct::Type::Float16: format = "e";                                       break;
+                case Struct::Type::Float32: format = py::format_descriptor<float>::format();    break;
+                case Struct::Type::Float64: format = py::format_descriptor<double>::format();   break;
+                default:
+                    Throw("Bitmap::__buffer__(): unsupported component format!");
+            }
+
+            size_t ch = bitmap.channel_count(),
+                   cs = field.size;
+            return py::buffer_info(
+                bitmap.data(), cs, format, 3,
+                { (size_t) bitmap.height(), (size_t) bitmap.width(), ch },
+                { cs * bitmap.width() * ch, cs * ch, cs }
+            );
+        })
         .def_property_readonly("__array_interface__", [](Bitmap &bitmap) -> py::object {
             if (bitmap.struct_()->size() == 0)
                 return py::none();
@@ -194,4 +254,16 @@ MTS_PY_EXPORT(Bitmap) {
             result["version"] = 3;
             return py::object(result);
         });
+
+    MTS_PY_CLASS(TiledBitmapWriter, Object)
+        .def(py::init<const fs::path &, const Vector2u &, uint32_t, const Struct *,
+                      Bitmap::Compression>(),
+            "path"_a, "size"_a, "tile_size"_a, "fields"_a,
+            "compression"_a = Bitmap::Compression::Default,
+            D(TiledBitmapWriter, TiledBitmapWriter))
+        .def("put", &TiledBitmapWriter::put, "offset"_a, "tile"_a,
+            D(TiledBitmapWriter, put), py::call_guard<py::gil_scoped_release>())
+        .def_method(TiledBitmapWriter, close)
+        .def_method(TiledBitmapWriter, size)
+        .def_method(TiledBitmapWriter, tile_size);
 }
@@ -27,9 +27,17 @@ MTS_PY_EXPORT(DiscreteDistribution) {
              "index"_a, "active"_a = true, D(DiscreteDistribution, eval_cdf))
         .def("eval_cdf_normalized", vectorize(&DiscreteDistribution::eval_cdf_normalized),
              "index"_a, "active"_a = true, D(DiscreteDistribution, eval_cdf_normalized))
-        .def_method(DiscreteDistribution, update)
+        .def("update", py::overload_cast<>(&DiscreteDistribution::update),
+             D(DiscreteDistribution, update))
+        .def("update",
+             py::overload_cast<uint32_t, uint32_t>(&DiscreteDistribution::update),
+             "begin"_a, "end"_a, D(DiscreteDistribution, update, 2))
         .def_method(DiscreteDistribution, sum)
         .def_method(DiscreteDistribution, normalization)
+        .def("set_alias_table", &DiscreteDistribution::set_alias_table,
+             "value"_a, "Enable or disable sampling via the alias method")
+        .def("alias_table", &DiscreteDistribution::alias_table,
+             "Is sampling performed using the alias method?")
         .def("sample",
             vectorize(&DiscreteDistribution::sample),
             "value"_a, "active"_a = true, D(DiscreteDistribution, sample))
@@ -76,6 +84,10 @@ MTS_PY_EXPORT(ContinuousDistribution) {
         .def_method(ContinuousDistribution, update)
         .def_method(ContinuousDistribution, integral)
         .def_method(ContinuousDistribution, normalization)
+        .def("set_alias_table", &ContinuousDistribution::set_alias_table,
+             "value"_a, "Enable or disable sampling via the alias method")
+        .def("alias_table", &ContinuousDistribution::alias_table,
+             "Is sampling performed using the alias method?")
         .def("sample",
             vectorize(&ContinuousDistribution::sample),
             "value"_a, "active"_a = true, D(ContinuousDistribution, sample))
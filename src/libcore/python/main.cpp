@@ -84,11 +84,15 @@ PYBIND11_MODULE(core_ext, m) {
             // Make sure the previous scheduler is deleted first.
             scheduler_holder->reset(nullptr);
             scheduler_holder->reset(new tbb::task_scheduler_init(count));
-            __global_thread_count = count;
+            /* Resize the shared task arena hosting Mitsuba's parallel work
+               and the (lazily sized) OpenEXR thread pool along with it */
+            set_global_thread_count(count <= 0 ? 0 : (size_t) count);
         },
         "count"_a = -1,
         "Sets the maximum number of threads to be used for parallelized "
-        "execution of Mitsuba code. Defaults to -1 (automatic).");
+        "execution of Mitsuba code. This caps the total concurrency of the "
+        "process: rendering, scene loading, and image I/O all draw from one "
+        "shared worker pool of the given size. Defaults to -1 (automatic).");
 
     py::module enoki_scalar = py::module::import("enoki.scalar");
     pybind11_type_alias<Array<uint32_t, 2>, Vector<uint32_t, 2>>();
@@ -94,7 +94,17 @@ MTS_PY_EXPORT(MemoryStream) {
         .def(py::init<size_t>(), D(MemoryStream, MemoryStream),
             "capacity"_a = 512)
         .def_method(MemoryStream, capacity)
-        .def_method(MemoryStream, owns_buffer);
+        .def_method(MemoryStream, owns_buffer)
+        .def("reserve", &MemoryStream::reserve, "capacity"_a,
+             "Pre-allocate memory for at least ``capacity`` bytes")
+        .def("raw_buffer", [](MemoryStream &s) {
+                return py::memoryview(py::buffer_info(
+                    s.raw_buffer(), sizeof(uint8_t),
+                    py::format_descriptor<uint8_t>::format(), 1,
+                    { (size_t) s.size() }, { sizeof(uint8_t) }));
+             }, py::keep_alive<0, 1>(),
+             "Return a zero-copy view of the stream contents (avoids the "
+             "intermediate copy that converting to ``bytes`` would make)");
 }
 
 MTS_PY_EXPORT(ZStream) {
@@ -103,6 +113,7 @@ MTS_PY_EXPORT(ZStream) {
     py::enum_<ZStream::EStreamType>(c, "EStreamType", D(ZStream, EStreamType))
         .value("EDeflateStream", ZStream::EDeflateStream, D(ZStream, EStreamType, EDeflateStream))
         .value("EGZipStream", ZStream::EGZipStream, D(ZStream, EStreamType, EGZipStream))
+        .value("EZstdStream", ZStream::EZstdStream, D(ZStream, EStreamType, EZstdStream))
         .export_values();
 
 
@@ -1,10 +1,191 @@
 #include <mitsuba/core/filesystem.h>
+#include <mitsuba/core/plugin.h>
+#include <mitsuba/core/properties.h>
 #include <mitsuba/core/xml.h>
 #include <mitsuba/python/python.h>
 
+#include <map>
+
 using Caster = py::object(*)(mitsuba::Object *);
 extern Caster cast_object;
 
+/// Create a uniform (resp. D65) texture for a constant-valued 'spectrum' entry
+static ref<Object> create_constant_texture(const std::string &variant,
+                                           Properties::Float value,
+                                           bool within_emitter,
+                                           bool is_spectral) {
+    Properties props("uniform");
+    if (within_emitter && is_spectral) {
+        props.set_plugin_name("d65");
+        props.set_float("scale", value);
+    } else {
+        props.set_float("value", value);
+    }
+
+    ref<Object> obj = PluginManager::instance()->create_object(
+        props, Class::for_name("Texture", variant));
+    auto expanded = obj->expand();
+    Assert(expanded.size() <= 1);
+    if (!expanded.empty())
+        obj = expanded[0];
+    return obj;
+}
+
+/// Create an sRGB spectrum/texture for an 'rgb' entry, mirroring the XML loader
+static ref<Object> create_rgb_texture(const std::string &variant,
+                                      const Properties::Color3f &color,
+                                      const std::string &name,
+                                      bool within_emitter) {
+    // Monochromatic IOR values and polarization-relevant quantities are unbounded
+    bool is_ior = name == "eta" || name == "k" || name == "int_ior" ||
+                  name == "ext_ior";
+
+    Properties props(within_emitter ? "srgb_d65" : "srgb");
+    props.set_color("color", color);
+
+    if (!within_emitter && is_ior)
+        props.set_bool("unbounded", true);
+
+    return PluginManager::instance()->create_object(
+        props, Class::for_name("Texture", variant));
+}
+
+/**
+ * Recursively construct an object graph from a Python dictionary: the
+ * programmatic counterpart of the XML loader, sharing its object model (typed
+ * \ref Properties entries, nested child objects, named references) while
+ * skipping serialization, parsing and temporary files.
+ */
+template <typename Float, typename Spectrum>
+ref<Object> load_dict_impl(const py::dict &dict,
+                           std::map<std::string, ref<Object>> &instances) {
+    const std::string variant = mitsuba::detail::get_variant<Float, Spectrum>();
+
+    if (!dict.contains("type"))
+        Throw("load_dict(): the dictionary is missing the \"type\" entry "
+              "that specifies the plugin to be instantiated");
+
+    std::string type = dict["type"].cast<std::string>();
+    bool is_scene = (type == "scene");
+
+    const Class *class_;
+    bool within_emitter = false;
+    if (is_scene) {
+        class_ = Class::for_name("Scene", variant);
+    } else {
+        class_ = PluginManager::instance()->get_plugin_class(type, variant);
+        within_emitter =
+            class_->derives_from(Class::for_name("Emitter", variant));
+    }
+
+    Properties props(type);
+
+    for (auto &kv : dict) {
+        std::string key = kv.first.cast<std::string>();
+        py::handle value = kv.second;
+
+        if (key == "type") {
+            continue;
+        } else if (key == "id") {
+            props.set_id(value.cast<std::string>());
+        } else if (py::isinstance<py::bool_>(value)) {
+            props.set_bool(key, value.cast<bool>());
+        } else if (py::isinstance<py::int_>(value)) {
+            props.set_long(key, value.cast<int64_t>());
+        } else if (py::isinstance<py::float_>(value)) {
+            props.set_float(key, value.cast<Properties::Float>());
+        } else if (py::isinstance<py::str>(value)) {
+            props.set_string(key, value.cast<std::string>());
+        } else if (py::isinstance<py::dict>(value)) {
+            py::dict child = value.cast<py::dict>();
+            std::string child_type;
+            if (child.contains("type"))
+                child_type = child["type"].cast<std::string>();
+
+            if (child_type == "ref") {
+                // Reference to an object defined earlier via its "id" entry
+                std::string id = child["id"].cast<std::string>();
+                auto it = instances.find(id);
+                if (it == instances.end())
+                    Throw("load_dict(): referenced id \"%s\" not found", id);
+                props.set_object(key, it->second);
+            } else if (child_type == "rgb") {
+                if (!child.contains("value"))
+                    Throw("load_dict(): \"rgb\" entry \"%s\" is missing its "
+                          "\"value\" entry", key);
+                py::handle v = child["value"];
+                Properties::Color3f color;
+                if (py::isinstance<py::float_>(v) || py::isinstance<py::int_>(v))
+                    color = Properties::Color3f(v.cast<Properties::Float>());
+                else
+                    color = v.cast<Properties::Color3f>();
+                props.set_object(
+                    key, create_rgb_texture(variant, color, key, within_emitter));
+            } else if (child_type == "spectrum") {
+                if (!child.contains("value"))
+                    Throw("load_dict(): \"spectrum\" entry \"%s\" is missing "
+                          "its \"value\" entry", key);
+                py::handle v = child["value"];
+                if (!py::isinstance<py::float_>(v) && !py::isinstance<py::int_>(v))
+                    Throw("load_dict(): only constant-valued \"spectrum\" "
+                          "entries are supported -- instantiate a texture "
+                          "plugin (e.g. \"regular\" or \"irregular\") for "
+                          "general spectra");
+                props.set_object(
+                    key, create_constant_texture(variant,
+                                                 v.cast<Properties::Float>(),
+                                                 within_emitter,
+                                                 is_spectral_v<Spectrum>));
+            } else {
+                ref<Object> obj = load_dict_impl<Float, Spectrum>(child, instances);
+
+                // Give the object a chance to recursively expand into sub-objects
+                std::vector<ref<Object>> children = obj->expand();
+                if (children.empty()) {
+                    props.set_object(key, obj);
+                } else if (children.size() == 1) {
+                    obj = children[0];
+                    props.set_object(key, obj);
+                } else {
+                    int ctr = 0;
+                    for (auto &c : children)
+                        props.set_object(key + "_" + std::to_string(ctr++), c);
+                    obj = children[0];
+                }
+
+                if (child.contains("id"))
+                    instances[child["id"].cast<std::string>()] = obj;
+            }
+        } else if (py::isinstance<Properties::Color3f>(value)) {
+            props.set_color(key, value.cast<Properties::Color3f>());
+        } else if (py::isinstance<Properties::Point3f>(value)) {
+            props.set_point3f(key, value.cast<Properties::Point3f>());
+        } else if (py::isinstance<Properties::Vector3f>(value)) {
+            props.set_vector3f(key, value.cast<Properties::Vector3f>());
+        } else if (py::isinstance<Properties::Transform4f>(value)) {
+            props.set_transform(key, value.cast<Properties::Transform4f>());
+        } else if (py::isinstance<Object>(value)) {
+            /* An already-constructed Mitsuba object, e.g. a Mesh assembled
+               from preallocated vertex/face buffers */
+            props.set_object(key, value.cast<ref<Object>>());
+        } else {
+            Throw("load_dict(): unsupported value type for entry \"%s\"", key);
+        }
+    }
+
+    ref<Object> obj = PluginManager::instance()->create_object(props, class_);
+
+    auto unqueried = props.unqueried();
+    if (!unqueried.empty())
+        Throw("load_dict(): unreferenced property \"%s\" in plugin of type "
+              "\"%s\"", unqueried[0], type);
+
+    if (dict.contains("id"))
+        instances[dict["id"].cast<std::string>()] = obj;
+
+    return obj;
+}
+
 MTS_PY_EXPORT(xml) {
     MTS_PY_IMPORT_TYPES()
 
@@ -26,4 +207,39 @@ MTS_PY_EXPORT(xml) {
                 xml::load_string(name, mitsuba::detail::get_variant<Float, Spectrum>(), param));
         },
         "string"_a, "parameters"_a = py::list(), D(xml, load_string));
+
+    m.def(
+        "load_dict",
+        [](const py::dict &dict) {
+            std::map<std::string, ref<Object>> instances;
+            ref<Object> obj = load_dict_impl<Float, Spectrum>(dict, instances);
+
+            std::vector<ref<Object>> expanded = obj->expand();
+            Assert(expanded.size() <= 1);
+            if (!expanded.empty())
+                obj = expanded[0];
+
+            return cast_object(obj);
+        },
+        "dict"_a,
+        R"doc(Load a Mitsuba scene or object from a Python dictionary
+
+This is the programmatic counterpart of ``load_string()``/``load_file()``:
+objects are assembled directly from typed parameters, skipping XML
+serialization, parsing, and temporary files, which matters when many
+procedurally generated scenes are constructed in a loop.
+
+Every (nested) dictionary requires a ``type`` entry naming the plugin to be
+instantiated (or ``scene`` for the top-level scene object). The remaining
+entries are forwarded to the plugin as typed parameters: booleans, integers,
+floats, strings, ``ScalarColor3f``, ``ScalarPoint3f``/``ScalarVector3f``,
+``ScalarTransform4f``, nested dictionaries (child objects), and
+already-constructed Mitsuba objects--e.g. a ``Mesh`` built from preallocated
+vertex and face buffers. An object carrying an ``id`` entry can be
+referenced later via ``{'type': 'ref', 'id': '..'}``. The special value
+dictionaries ``{'type': 'rgb', 'value': ..}`` and ``{'type': 'spectrum',
+'value': <float>}`` create textures like the corresponding XML tags.
+
+Parameter ``dict``:
+    Dictionary describing the object to be instantiated)doc");
 }
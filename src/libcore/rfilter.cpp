@@ -8,13 +8,16 @@ MTS_VARIANT ReconstructionFilter<Float, Spectrum>::~ReconstructionFilter() { }
 
 MTS_VARIANT void ReconstructionFilter<Float, Spectrum>::init_discretization() {
     Assert(m_radius > 0);
-    m_values.resize(MTS_FILTER_RESOLUTION + 1);
 
     // Evaluate and store the filter values
+    ScalarFloat values[MTS_FILTER_RESOLUTION + 1];
     for (size_t i = 0; i < MTS_FILTER_RESOLUTION; ++i)
-        m_values[i] = scalar_cast(hmax(eval((m_radius * i) / MTS_FILTER_RESOLUTION)));
+        values[i] = scalar_cast(hmax(eval((m_radius * i) / MTS_FILTER_RESOLUTION)));
+    values[MTS_FILTER_RESOLUTION] = 0;
 
-    m_values[MTS_FILTER_RESOLUTION] = 0;
+    /* Upload the table so that \ref eval_discretized() can gather from it
+       in all variants (including CUDA arrays) */
+    m_values = DynamicBuffer<Float>::copy(values, MTS_FILTER_RESOLUTION + 1);
     m_scale_factor = MTS_FILTER_RESOLUTION / m_radius;
     m_border_size = (int) std::ceil(m_radius - .5f - 2.f * math::RayEpsilon<ScalarFloat>);
 }
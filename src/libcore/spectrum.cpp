@@ -1,4 +1,5 @@
 #include <mitsuba/core/spectrum.h>
+#include <algorithm>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -84,23 +85,79 @@ static const Float cie1931_tbl[MTS_CIE_SAMPLES * 3] = {
     Float(0.000000000000), Float(0.000000000000), Float(0.000000000000)
 };
 
-const Float *cie1931_x_data = cie1931_tbl;
-const Float *cie1931_y_data = cie1931_tbl + MTS_CIE_SAMPLES;
-const Float *cie1931_z_data = cie1931_tbl + MTS_CIE_SAMPLES * 2;
+/* D65 illuminant data from CIE, expressed as relative spectral power
+   distribution, normalized relative to the power at 560nm. */
+const float d65_table[MTS_CIE_SAMPLES] = {
+    46.6383f,  49.3637f,  52.0891f,  51.0323f,  49.9755f,  52.3118f,  54.6482f,  68.7015f,
+    82.7549f,  87.1204f,  91.486f,   92.4589f,  93.4318f,  90.057f,   86.6823f,  95.7736f,
+    104.865f,  110.936f,  117.008f,  117.41f,   117.812f,  116.336f,  114.861f,  115.392f,
+    115.923f,  112.367f,  108.811f,  109.082f,  109.354f,  108.578f,  107.802f,  106.296f,
+    104.79f,   106.239f,  107.689f,  106.047f,  104.405f,  104.225f,  104.046f,  102.023f,
+    100.0f,    98.1671f,  96.3342f,  96.0611f,  95.788f,   92.2368f,  88.6856f,  89.3459f,
+    90.0062f,  89.8026f,  89.5991f,  88.6489f,  87.6987f,  85.4936f,  83.2886f,  83.4939f,
+    83.6992f,  81.863f,   80.0268f,  80.1207f,  80.2146f,  81.2462f,  82.2778f,  80.281f,
+    78.2842f,  74.0027f,  69.7213f,  70.6652f,  71.6091f,  72.979f,   74.349f,   67.9765f,
+    61.604f,   65.7448f,  69.8856f,  72.4863f,  75.087f,   69.3398f,  63.5927f,  55.0054f,
+    46.4182f,  56.6118f,  66.8054f,  65.0941f,  63.3828f,  63.8434f,  64.304f,   61.8779f,
+    59.4519f,  55.7054f,  51.959f,   54.6998f,  57.4406f,  58.8765f,  60.3125f
+};
+
+static Float cie1931_response_tbl[MTS_CIE_RESPONSE_SAMPLES * 3];
+
+const Float *cie1931_x_data = cie1931_response_tbl;
+const Float *cie1931_y_data = cie1931_response_tbl + MTS_CIE_RESPONSE_SAMPLES;
+const Float *cie1931_z_data = cie1931_response_tbl + MTS_CIE_RESPONSE_SAMPLES * 2;
+
+/* Resample the 5nm fits above onto a dense grid aligned with the wavelength
+   range sampled by the sensors. This folds the piecewise-linear interpolation
+   into table build time, so that the per-sample lookups in cie1931_xyz() and
+   cie1931_y() reduce to a nearest-neighbor gather. Runs once during static
+   initialization. */
+static struct CieResponseTableInit {
+    CieResponseTableInit() {
+        for (int i = 0; i < MTS_CIE_RESPONSE_SAMPLES; ++i) {
+            Float wavelength =
+                MTS_WAVELENGTH_MIN +
+                i * (MTS_WAVELENGTH_MAX - MTS_WAVELENGTH_MIN) /
+                    Float(MTS_CIE_RESPONSE_SAMPLES - 1);
+
+            Float x = 0.f, y = 0.f, z = 0.f;
+            if (wavelength >= MTS_CIE_MIN && wavelength <= MTS_CIE_MAX) {
+                Float t = (wavelength - MTS_CIE_MIN) *
+                          ((MTS_CIE_SAMPLES - 1) / (MTS_CIE_MAX - MTS_CIE_MIN));
+
+                int i0 = std::min(std::max((int) t, 0), MTS_CIE_SAMPLES - 2),
+                    i1 = i0 + 1;
+
+                Float w1 = t - Float(i0),
+                      w0 = 1.f - w1;
+
+                x = w0 * cie1931_tbl[i0] + w1 * cie1931_tbl[i1];
+                y = w0 * cie1931_tbl[MTS_CIE_SAMPLES + i0] +
+                    w1 * cie1931_tbl[MTS_CIE_SAMPLES + i1];
+                z = w0 * cie1931_tbl[MTS_CIE_SAMPLES * 2 + i0] +
+                    w1 * cie1931_tbl[MTS_CIE_SAMPLES * 2 + i1];
+            }
 
+            cie1931_response_tbl[i] = x;
+            cie1931_response_tbl[MTS_CIE_RESPONSE_SAMPLES + i] = y;
+            cie1931_response_tbl[MTS_CIE_RESPONSE_SAMPLES * 2 + i] = z;
+        }
+    }
+} cie_response_table_init;
 
 void cie_alloc() {
 #if defined(MTS_ENABLE_OPTIX)
     static bool cie_alloc_done = false;
     if (cie_alloc_done)
         return;
-    const size_t size = MTS_CIE_SAMPLES * 3 * sizeof(Float);
+    const size_t size = MTS_CIE_RESPONSE_SAMPLES * 3 * sizeof(Float);
     Float *src = (Float *) cuda_managed_malloc(size);
-    memcpy(src, cie1931_tbl, size);
+    memcpy(src, cie1931_response_tbl, size);
 
     cie1931_x_data = src;
-    cie1931_y_data = src + MTS_CIE_SAMPLES;
-    cie1931_z_data = src + MTS_CIE_SAMPLES * 2;
+    cie1931_y_data = src + MTS_CIE_RESPONSE_SAMPLES;
+    cie1931_z_data = src + MTS_CIE_RESPONSE_SAMPLES * 2;
     cie_alloc_done = true;
 #endif
 }
@@ -1,5 +1,8 @@
 #include <mitsuba/core/string.h>
 #include <mitsuba/core/object.h>
+#include <mitsuba/core/logger.h>
+#include <cstring>
+#include <cstdlib>
 
 NAMESPACE_BEGIN(mitsuba)
 NAMESPACE_BEGIN(string)
@@ -44,6 +47,169 @@ std::string indent(const Object *value, size_t amount) {
     return indent(string, amount);
 }
 
+/// Do the eight bytes of 'chunk' all hold ASCII digits?
+static inline bool swar_all_digits(uint64_t chunk) {
+    return ((chunk & 0xF0F0F0F0F0F0F0F0ull) |
+            (((chunk + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4)) ==
+           0x3333333333333333ull;
+}
+
+/// Convert eight ASCII digits to an integer using two SWAR multiplies
+static inline uint32_t swar_parse_digits(uint64_t chunk) {
+    const uint64_t mask = 0x000000FF000000FFull,
+                   mul1 = 0x000F424000000064ull, // 100 + (1000000 << 32)
+                   mul2 = 0x0000271000000001ull; // 1 + (10000 << 32)
+    chunk -= 0x3030303030303030ull;
+    chunk = (chunk * 10) + (chunk >> 8); // adjacent digits -> 2-digit values
+    return (uint32_t) ((((chunk & mask) * mul1) +
+                        (((chunk >> 16) & mask) * mul2)) >> 32);
+}
+
+template <typename Value>
+static size_t parse_floats_impl(const char *str, std::vector<Value> &dest,
+                                char extra_delim) {
+    /* Powers of ten that are exactly representable in double precision;
+       mantissa * 10^e with |e| <= 22 then rounds correctly in a single
+       multiplication or division */
+    static const double pow10_table[23] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10,
+        1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21,
+        1e22
+    };
+
+    auto is_delim = [extra_delim](char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == ',' ||
+               (c == extra_delim && c != '\0');
+    };
+
+    const char *p   = str,
+               *end = str + strlen(str);
+    size_t count = 0;
+
+    while (true) {
+        while (is_delim(*p))
+            ++p;
+        if (*p == '\0')
+            break;
+
+        const char *start = p;
+        bool negative = false;
+        if (*p == '+' || *p == '-') {
+            negative = *p == '-';
+            ++p;
+        }
+
+        uint64_t mantissa = 0;
+        int n_digits = 0, exp_adjust = 0;
+
+        // Integer part, eight digits at a time while possible
+        while (end - p >= 8 && n_digits + 8 <= 19) {
+            uint64_t chunk;
+            memcpy(&chunk, p, 8);
+            if (!swar_all_digits(chunk))
+                break;
+            mantissa = mantissa * 100000000ull + swar_parse_digits(chunk);
+            n_digits += 8;
+            p += 8;
+        }
+        while (*p >= '0' && *p <= '9') {
+            if (n_digits < 19) {
+                mantissa = mantissa * 10 + (uint64_t) (*p - '0');
+                ++n_digits;
+            } else {
+                ++exp_adjust; // excess integer digits shift the exponent
+            }
+            ++p;
+        }
+        bool any_digits = p != start + (negative || *start == '+' ? 1 : 0);
+
+        // Fractional part
+        if (*p == '.') {
+            ++p;
+            const char *frac_start = p;
+            while (end - p >= 8 && n_digits + 8 <= 19) {
+                uint64_t chunk;
+                memcpy(&chunk, p, 8);
+                if (!swar_all_digits(chunk))
+                    break;
+                mantissa = mantissa * 100000000ull + swar_parse_digits(chunk);
+                n_digits += 8;
+                exp_adjust -= 8;
+                p += 8;
+            }
+            while (*p >= '0' && *p <= '9') {
+                if (n_digits < 19) {
+                    mantissa = mantissa * 10 + (uint64_t) (*p - '0');
+                    ++n_digits;
+                    --exp_adjust;
+                } // excess fraction digits are below the representable precision
+                ++p;
+            }
+            any_digits |= p != frac_start;
+        }
+
+        // Exponent
+        bool malformed = !any_digits;
+        if (!malformed && (*p == 'e' || *p == 'E')) {
+            ++p;
+            bool exp_negative = false;
+            if (*p == '+' || *p == '-') {
+                exp_negative = *p == '-';
+                ++p;
+            }
+            if (!(*p >= '0' && *p <= '9')) {
+                malformed = true;
+            } else {
+                int exp_value = 0;
+                while (*p >= '0' && *p <= '9') {
+                    if (exp_value < 10000)
+                        exp_value = exp_value * 10 + (*p - '0');
+                    ++p;
+                }
+                exp_adjust += exp_negative ? -exp_value : exp_value;
+            }
+        }
+        if (!malformed && !(is_delim(*p) || *p == '\0'))
+            malformed = true;
+
+        double value;
+        if (likely(!malformed && exp_adjust >= -22 && exp_adjust <= 22 &&
+                   mantissa <= 0x1FFFFFFFFFFFFFull /* < 2^53 */)) {
+            value = (double) mantissa;
+            if (exp_adjust < 0)
+                value /= pow10_table[-exp_adjust];
+            else
+                value *= pow10_table[exp_adjust];
+            if (negative)
+                value = -value;
+        } else {
+            /* Unusual form (hex float, inf/nan, extreme exponent, or not a
+               number at all): let strtod decide */
+            char *endp = nullptr;
+            value = std::strtod(start, &endp);
+            if (endp == start || !(is_delim(*endp) || *endp == '\0'))
+                Throw("parse_floats(): invalid floating point value in \"%s\"!",
+                      str);
+            p = endp;
+        }
+
+        dest.push_back((Value) value);
+        ++count;
+    }
+
+    return count;
+}
+
+size_t parse_floats(const char *str, std::vector<float> &dest,
+                    char extra_delim) {
+    return parse_floats_impl(str, dest, extra_delim);
+}
+
+size_t parse_floats(const char *str, std::vector<double> &dest,
+                    char extra_delim) {
+    return parse_floats_impl(str, dest, extra_delim);
+}
+
 std::string trim(const std::string &s, const std::string &whitespace) {
     auto it1 = s.find_first_not_of(whitespace);
     if (it1 == std::string::npos)
@@ -3,10 +3,15 @@
 #include <mitsuba/core/math.h>
 #include <mitsuba/core/stream.h>
 #include <mitsuba/core/hash.h>
+#include <mitsuba/core/random.h>
 #include <mitsuba/core/jit.h>
 #include <enoki/array.h>
 #include <enoki/half.h>
 #include <enoki/color.h>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include <algorithm>
+#include <atomic>
 #include <unordered_map>
 #include <ostream>
 #include <map>
@@ -18,9 +23,6 @@
 
 NAMESPACE_BEGIN(mitsuba)
 
-// Defined in dither-matrix256.cpp
-extern const float dither_matrix256[65536];
-
 NAMESPACE_BEGIN(detail)
 
 #if MTS_STRUCTCONVERTER_USE_JIT == 1
@@ -1691,6 +1693,52 @@ bool StructConverter::convert_2d(size_t width, size_t height, const void *src_,
 }
 #endif
 
+bool StructConverter::convert_2d_parallel(size_t width, size_t height,
+                                          const void *src_, void *dest_) const {
+    /* Batch boundaries must be aligned to the period of the dither matrix so
+       that every sub-conversion sees the same matrix entries as a single
+       serial call would */
+    constexpr size_t granularity = 256;
+
+    /* Don't bother parallelizing small inputs */
+    constexpr size_t serial_threshold = 16384;
+
+    /* Split along the 'height' axis when working with images, and along
+       'width' for linear record streams (e.g. from the mesh loaders) */
+    bool split_rows = height > 1;
+    size_t extent   = split_rows ? height : width,
+           unit_in  = (split_rows ? width : 1) * m_source->size(),
+           unit_out = (split_rows ? width : 1) * m_target->size();
+
+    if (extent < 2 * granularity || width * height < serial_threshold)
+        return convert_2d(width, height, src_, dest_);
+
+    size_t block_count = (extent + granularity - 1) / granularity;
+
+    const uint8_t *src = (const uint8_t *) src_;
+    uint8_t *dest      = (uint8_t *) dest_;
+
+    std::atomic<bool> success(true);
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, block_count, 1),
+        [&](const tbb::blocked_range<size_t> &range) {
+            size_t start = range.begin() * granularity,
+                   end   = std::min(range.end() * granularity, extent),
+                   count = end - start;
+
+            bool rv = split_rows
+                ? convert_2d(width, count, src + start * unit_in,
+                             dest + start * unit_out)
+                : convert_2d(count, height, src + start * unit_in,
+                             dest + start * unit_out);
+
+            if (unlikely(!rv))
+                success = false;
+        });
+
+    return success;
+}
+
 std::string StructConverter::to_string() const {
     std::ostringstream oss;
     oss << "StructConverter[" << std::endl
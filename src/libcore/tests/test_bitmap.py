@@ -223,3 +223,40 @@ def test_accumulate():
     # but (row, column) in arrays.
     b1.accumulate(b2, [5, 3], [3, 1], [1, 5])
     assert np.all(np.array(b1, copy=False) == ref)
+
+
+def test_tiled_writer(tmpdir):
+    from mitsuba.core import TiledBitmapWriter
+
+    tmp_file = os.path.join(str(tmpdir), "out.exr")
+
+    # 70x50 image written as 32x32 tiles (with partial tiles at the edges)
+    ref = np.random.rand(50, 70, 3).astype(np.float32)
+    full = Bitmap(ref)
+    full.struct_()[0].name = 'R'
+    full.struct_()[1].name = 'G'
+    full.struct_()[2].name = 'B'
+
+    writer = TiledBitmapWriter(tmp_file, [70, 50], 32, full.struct_())
+    for y in range(0, 50, 32):
+        for x in range(0, 70, 32):
+            w, h = min(32, 70 - x), min(32, 50 - y)
+            tile = Bitmap(Bitmap.PixelFormat.RGB, Struct.Type.Float32, [w, h])
+            np.array(tile, copy=False)[:] = ref[y:y+h, x:x+w, :]
+            writer.put([x, y], tile)
+    writer.close()
+
+    b = Bitmap(tmp_file)
+    assert b.size() == [70, 50]
+    assert np.allclose(np.array(b, copy=False), ref)
+
+    # Tiles must be aligned and match the image layout
+    writer = TiledBitmapWriter(tmp_file, [70, 50], 32, full.struct_())
+    tile = Bitmap(Bitmap.PixelFormat.RGB, Struct.Type.Float32, [32, 32])
+    with pytest.raises(RuntimeError, match='aligned'):
+        writer.put([5, 0], tile)
+    with pytest.raises(RuntimeError, match='size'):
+        writer.put([64, 0], tile)
+    writer.close()
+    with pytest.raises(RuntimeError, match='closed'):
+        writer.put([0, 0], tile)
@@ -302,3 +302,51 @@ def test18_irrcont_simple_function(variant_packet_rgb):
                 0.48734, 0.654313, 0.786607, 0.899653, 1.])
          * d.normalization())
     )
+
+
+def test19_discr_alias(variant_packet_rgb):
+    # Check that alias-based sampling agrees with the stored distribution
+    from mitsuba.core import DiscreteDistribution, Float, PCG32, UInt64
+
+    x = DiscreteDistribution([1, 3, 2])
+    assert not x.alias_table()
+    x.set_alias_table(True)
+    assert x.alias_table()
+
+    # Histogram of a dense set of uniform variates must match the pmf
+    rng = PCG32(initseq=UInt64.arange(1024))
+    counts = [0] * 3
+    for i in range(100):
+        index, pmf = x.sample_pmf(rng.next_float32())
+        assert ek.allclose(pmf, ek.gather(x.pmf(), index) / 6.0)
+        for j in index:
+            counts[j] += 1
+    total = sum(counts)
+    assert ek.allclose(Float(counts) / total, Float([1, 3, 2]) / 6.0,
+                       atol=5e-3)
+
+    # The re-scaled variate must remain uniformly distributed
+    index, reused = x.sample_reuse(rng.next_float32())
+    assert ek.all((reused >= 0) & (reused <= 1))
+    assert abs(ek.hsum(reused) / len(reused) - 0.5) < 5e-2
+
+
+def test20_cont_alias(variant_packet_rgb):
+    # Check that alias-based sampling matches eval_pdf/eval_cdf
+    from mitsuba.core import ContinuousDistribution, Float, PCG32, UInt64
+
+    y = ek.exp(-ek.sqr(ek.linspace(Float, -2, 2, 65)))
+    d = ContinuousDistribution([-2, 2], y)
+    d.set_alias_table(True)
+    assert d.alias_table()
+
+    rng = PCG32(initseq=UInt64.arange(1024))
+    value = rng.next_float32()
+    x, pdf = d.sample_pdf(value)
+    assert ek.all((x >= -2) & (x <= 2))
+    assert ek.allclose(pdf, d.eval_pdf_normalized(x, True), rtol=1e-4)
+
+    # Empirical CDF of the samples must match the analytic CDF
+    for t in [-1.0, 0.0, 1.0]:
+        frac = ek.count(x < t) / float(len(x))
+        assert ek.allclose(frac, d.eval_cdf_normalized(t), atol=5e-2)
@@ -1,12 +1,15 @@
 #include <mitsuba/core/thread.h>
 #include <mitsuba/core/logger.h>
+#include <mitsuba/core/string.h>
 #include <mitsuba/core/tls.h>
 #include <mitsuba/core/util.h>
 #include <mitsuba/core/fresolver.h>
 #include <mitsuba/core/profiler.h>
 #include <tbb/task_scheduler_observer.h>
 #include <condition_variable>
+#include <mutex>
 #include <thread>
+#include <fstream>
 #include <sstream>
 #include <chrono>
 
@@ -22,8 +25,38 @@
 NAMESPACE_BEGIN(mitsuba)
 
 size_t __global_thread_count = 0;
+
+/* The single arena hosting all of Mitsuba's parallel work (see
+   \ref global_task_arena() in thread.h). Created lazily so that command
+   line tools can still adjust \ref __global_thread_count beforehand. */
+static std::unique_ptr<tbb::task_arena> global_arena;
+static std::mutex global_arena_mutex;
+
+tbb::task_arena &global_task_arena() {
+    std::lock_guard<std::mutex> guard(global_arena_mutex);
+    if (!global_arena) {
+        global_arena.reset(
+            new tbb::task_arena((int) __global_thread_count));
+        global_arena->initialize();
+    }
+    return *global_arena;
+}
+
+void set_global_thread_count(size_t count) {
+    if (count == 0)
+        count = (size_t) util::core_count();
+
+    std::lock_guard<std::mutex> guard(global_arena_mutex);
+    __global_thread_count = count;
+    global_arena.reset(new tbb::task_arena((int) count));
+    global_arena->initialize();
+}
+
 static ThreadLocal<Thread> *self = nullptr;
 static std::atomic<uint32_t> thread_ctr { 0 };
+static bool numa_pinning_enabled = false;
+static std::atomic<uint32_t> numa_pin_ctr { 0 };
+static thread_local int this_numa_node = 0;
 #if defined(__LINUX__) || defined(__OSX__)
 static pthread_key_t this_thread_id;
 #elif defined(__WINDOWS__)
@@ -340,6 +373,135 @@ void Thread::set_core_affinity(int core_id) {
 #endif
 }
 
+/**
+ * Return the list of processor cores belonging to each NUMA node. The
+ * topology is read from sysfs on Linux; on other platforms (and when
+ * detection fails) the machine is treated as a single node spanning all
+ * cores.
+ */
+static const std::vector<std::vector<int>> &numa_topology() {
+    static std::vector<std::vector<int>> topology = []() {
+        std::vector<std::vector<int>> result;
+#if defined(__LINUX__)
+        for (int node = 0; ; ++node) {
+            std::ifstream is(tfm::format(
+                "/sys/devices/system/node/node%i/cpulist", node));
+            if (!is.good())
+                break;
+
+            std::string line;
+            std::getline(is, line);
+
+            /* The cpulist format is a comma-separated sequence of
+               core ids and inclusive ranges, e.g. "0-15,32-47" */
+            std::vector<int> cores;
+            try {
+                for (const std::string &token : string::tokenize(line, ",")) {
+                    auto dash = token.find('-');
+                    if (dash == std::string::npos) {
+                        cores.push_back(std::stoi(token));
+                    } else {
+                        int begin = std::stoi(token.substr(0, dash)),
+                            end   = std::stoi(token.substr(dash + 1));
+                        for (int i = begin; i <= end; ++i)
+                            cores.push_back(i);
+                    }
+                }
+            } catch (const std::exception &) {
+                result.clear();
+                break;
+            }
+
+            if (!cores.empty())
+                result.push_back(std::move(cores));
+        }
+#endif
+        if (result.empty()) {
+            std::vector<int> cores(util::core_count());
+            for (size_t i = 0; i < cores.size(); ++i)
+                cores[i] = (int) i;
+            result.push_back(std::move(cores));
+        }
+        return result;
+    }();
+    return topology;
+}
+
+void Thread::set_numa_pinning(bool enable) {
+    numa_pinning_enabled = enable;
+    if (!enable)
+        return;
+
+    int node_count = numa_node_count();
+    if (node_count == 1) {
+        Log(Warn, "Thread::set_numa_pinning(): only a single NUMA node was "
+                  "detected -- pinning will have no effect.");
+        return;
+    }
+
+    Log(Info, "NUMA mode: distributing workers over %i nodes (%i cores)",
+        node_count, util::core_count());
+
+    // The calling thread takes part in rendering as well -- pin it to node 0
+    pin_to_numa_node(0);
+}
+
+bool Thread::numa_pinning() {
+    return numa_pinning_enabled;
+}
+
+int Thread::numa_node_count() {
+    return (int) numa_topology().size();
+}
+
+int Thread::numa_node() {
+    return this_numa_node;
+}
+
+bool Thread::pin_to_numa_node(int node) {
+    const auto &topology = numa_topology();
+    if (node < 0 || node >= (int) topology.size()) {
+        Log(Warn, "Thread::pin_to_numa_node(): node %i is out of bounds "
+                  "(%i nodes available)!", node, topology.size());
+        return false;
+    }
+
+#if defined(__LINUX__)
+    const std::vector<int> &cores = topology[node];
+    int max_core = 0;
+    for (int core : cores)
+        max_core = std::max(max_core, core);
+
+    size_t size = CPU_ALLOC_SIZE(max_core + 1);
+    cpu_set_t *cpuset = CPU_ALLOC(max_core + 1);
+    if (!cpuset) {
+        Log(Warn, "Thread::pin_to_numa_node(): could not allocate cpu_set_t");
+        return false;
+    }
+
+    CPU_ZERO_S(size, cpuset);
+    for (int core : cores)
+        CPU_SET_S(core, size, cpuset);
+
+    int retval = pthread_setaffinity_np(pthread_self(), size, cpuset);
+    CPU_FREE(cpuset);
+
+    if (retval) {
+        Log(Warn, "Thread::pin_to_numa_node(): pthread_setaffinity_np: "
+                  "failed: %s", strerror(retval));
+        return false;
+    }
+
+    this_numa_node = node;
+    return true;
+#else
+    /* Detection always reports a single node elsewhere, and pinning to it
+       would be a no-op */
+    this_numa_node = 0;
+    return node == 0;
+#endif
+}
+
 void Thread::start() {
     if (d->running)
         Log(Error, "Thread is already running!");
@@ -491,6 +653,11 @@ public:
         if (register_external_thread("tbb")) {
             std::unique_lock<std::mutex> lock(m_mutex);
             m_started_counter++;
+
+            /* Distribute the worker pool round-robin over the NUMA nodes,
+               pinning each worker to the cores of its assigned node */
+            if (numa_pinning_enabled && Thread::numa_node_count() > 1)
+                pin_to_numa_node(numa_pin_ctr++ % Thread::numa_node_count());
         }
     }
 
@@ -537,6 +704,9 @@ void Thread::static_initialization() {
 }
 
 void Thread::static_shutdown() {
+    /* Release the shared arena first so that its workers quiesce before
+       the scheduler observer goes away */
+    global_arena.reset();
     observer->wait();
     observer.reset();
     thread()->d->running = false;
@@ -556,7 +726,7 @@ ThreadEnvironment::ThreadEnvironment() {
     m_logger = thread->logger();
     m_file_resolver = thread->file_resolver();
 #if defined(MTS_ENABLE_PROFILER)
-    m_profiler_flags = *profiler_flags();
+    m_profiler_state = *profiler_state();
 #endif
 }
 
@@ -568,9 +738,8 @@ ScopedSetThreadEnvironment::ScopedSetThreadEnvironment(ThreadEnvironment &env) {
     thread->set_logger(env.m_logger);
     thread->set_file_resolver(env.m_file_resolver);
 #if defined(MTS_ENABLE_PROFILER)
-    uint64_t *profiler_flags = mitsuba::profiler_flags();
-    m_profiler_flags = *profiler_flags;
-    *profiler_flags = env.m_profiler_flags;
+    m_profiler_state = *profiler_state();
+    profiler_set_state(env.m_profiler_state);
 #endif
 }
 
@@ -579,7 +748,7 @@ ScopedSetThreadEnvironment::~ScopedSetThreadEnvironment() {
     thread->set_logger(m_logger);
     thread->set_file_resolver(m_file_resolver);
 #if defined(MTS_ENABLE_PROFILER)
-    *profiler_flags() = m_profiler_flags;
+    profiler_set_state(m_profiler_state);
 #endif
 }
 
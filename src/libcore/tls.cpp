@@ -1,6 +1,8 @@
 #include <mitsuba/core/tls.h>
 #include <tbb/spin_mutex.h>
 #include <tbb/mutex.h>
+#include <atomic>
+#include <cstring>
 #include <stdexcept>
 #include <unordered_map>
 #include <unordered_set>
@@ -39,6 +41,31 @@ static std::unordered_set<PerThreadData *> ptd_global;
 /// Lock to protect ptd_global
 static tbb::mutex ptd_global_lock;
 
+/* The render loop accesses a handful of TLS objects (scratch arena, current
+   thread, per-thread integrator state) over and over from tight per-block and
+   per-sample code, where even the uncontended spin lock + hash lookup in
+   \ref ThreadLocalBase::get() is measurable. The cache below short-circuits
+   repeated lookups of the same object through a small direct-mapped table in
+   native TLS; the portable registry remains the slow path and continues to
+   provide dynamic thread attach/detach and cleanup semantics. */
+
+/// Number of slots in the per-thread TLS lookup cache (must be a power of two)
+static constexpr size_t TLSCacheSize = 16;
+
+struct TLSCacheEntry {
+    ThreadLocalBase *key;
+    void *data;
+};
+
+static thread_local TLSCacheEntry tls_cache[TLSCacheSize];
+static thread_local uint64_t tls_cache_generation = 0;
+
+/** Bumped whenever cached pointers may have become stale (a \ref
+ * ThreadLocalBase instance or a thread's TLS entries were destroyed); threads
+ * that observe a newer generation flush their cache before refilling it. This
+ * guards against a destroyed instance's address being recycled for a new one. */
+static std::atomic<uint64_t> tls_generation { 1 };
+
 ThreadLocalBase::ThreadLocalBase(const ConstructFunctor &construct_functor,
                                  const DestructFunctor &destruct_functor)
     : m_construct_functor(construct_functor), m_destruct_functor(destruct_functor) { }
@@ -50,6 +77,9 @@ ThreadLocalBase::~ThreadLocalBase() {
 void ThreadLocalBase::clear() {
     tbb::mutex::scoped_lock guard(ptd_global_lock);
 
+    // Invalidate the per-thread lookup caches before freeing anything
+    tls_generation.fetch_add(1, std::memory_order_release);
+
     /* For every thread */
     for (auto ptd : ptd_global) {
         tbb::spin_mutex::scoped_lock guard2(ptd->mutex);
@@ -70,6 +100,14 @@ void ThreadLocalBase::clear() {
 void *ThreadLocalBase::get() {
     /* Look up a TLS entry. The goal is to make this entire operation very fast! */
 
+    /* Fast path: repeated accesses to the same object from the same thread
+       resolve through the direct-mapped cache without locking */
+    size_t slot = (size_t) (((uintptr_t) this) >> 4) & (TLSCacheSize - 1);
+    uint64_t generation = tls_generation.load(std::memory_order_acquire);
+    TLSCacheEntry &cache = tls_cache[slot];
+    if (likely(cache.key == this && tls_cache_generation == generation))
+        return cache.data;
+
     #if defined(__OSX__)
         PerThreadData *ptd = (PerThreadData *) pthread_getspecific(ptd_local);
     #else
@@ -81,26 +119,39 @@ void *ThreadLocalBase::get() {
             "Internal error: call to ThreadLocalPrivate::get() precedes the "
             "construction of thread-specific data structures!");
 
-    /* This is an uncontended thread-local lock (i.e. not to worry) */
-    tbb::spin_mutex::scoped_lock guard(ptd->mutex);
-
-    auto it = ptd->entries.find(this);
-    if (likely(it != ptd->entries.end()))
-        return it->second.data;
-
-    /* This is the first access from this thread */
-    ptd->entries.insert(std::make_pair(this, TLSEntry {
-        m_construct_functor(),
-        m_destruct_functor,
-        std::list<TLSEntry *>::iterator()
-    }));
-
-    TLSEntry &entry = ptd->entries.find(this)->second;
+    void *data;
+    {
+        /* This is an uncontended thread-local lock (i.e. not to worry) */
+        tbb::spin_mutex::scoped_lock guard(ptd->mutex);
+
+        auto it = ptd->entries.find(this);
+        if (likely(it != ptd->entries.end())) {
+            data = it->second.data;
+        } else {
+            /* This is the first access from this thread */
+            ptd->entries.insert(std::make_pair(this, TLSEntry {
+                m_construct_functor(),
+                m_destruct_functor,
+                std::list<TLSEntry *>::iterator()
+            }));
+
+            TLSEntry &entry = ptd->entries.find(this)->second;
+
+            ptd->entries_ordered.push_back(&entry);
+            entry.iterator = --ptd->entries_ordered.end();
+
+            data = entry.data;
+        }
+    }
 
-    ptd->entries_ordered.push_back(&entry);
-    entry.iterator = --ptd->entries_ordered.end();
+    if (tls_cache_generation != generation) {
+        memset(tls_cache, 0, sizeof(tls_cache));
+        tls_cache_generation = generation;
+    }
+    cache.key = this;
+    cache.data = data;
 
-    return entry.data;
+    return data;
 }
 
 void ThreadLocalBase::static_initialization() {
@@ -156,6 +207,10 @@ bool ThreadLocalBase::unregister_thread() {
     ptd->ref_count--;
 
     if (ptd->ref_count == 0) {
+        /* The thread's entries are about to be destroyed; invalidate the
+           lookup caches in case the same OS thread later re-attaches */
+        tls_generation.fetch_add(1, std::memory_order_release);
+
         tbb::spin_mutex::scoped_lock local_guard(ptd->mutex);
         for (auto it = ptd->entries_ordered.rbegin();
              it != ptd->entries_ordered.rend(); ++it)
@@ -3,6 +3,10 @@
 #include <mitsuba/core/string.h>
 #include <mitsuba/core/filesystem.h>
 #include <mitsuba/core/vector.h>
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
 
 #if defined(__LINUX__)
 #  if !defined(_GNU_SOURCE)
@@ -12,6 +16,7 @@
 #  include <unistd.h>
 #  include <limits.h>
 #  include <sys/ioctl.h>
+#  include <sys/mman.h>
 #elif defined(__OSX__)
 #  include <sys/sysctl.h>
 #  include <mach-o/dyld.h>
@@ -21,6 +26,15 @@
 #  include <windows.h>
 #endif
 
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#  define MTS_X86
+#  if defined(_MSC_VER)
+#    include <intrin.h>
+#  else
+#    include <cpuid.h>
+#  endif
+#endif
+
 NAMESPACE_BEGIN(mitsuba)
 NAMESPACE_BEGIN(util)
 
@@ -201,6 +215,107 @@ std::string mem_string(size_t size, bool precise) {
     return tfm::format(precise ? "%.5g %s" : "%.3g %s", value, orders[i]);
 }
 
+struct MemoryRecord {
+    size_t current = 0;
+    size_t peak = 0;
+};
+
+static std::mutex memory_registry_mutex;
+static std::map<std::string, MemoryRecord> memory_registry;
+
+void track_memory(const char *category, size_t size) {
+    if (size == 0)
+        return;
+    std::lock_guard<std::mutex> guard(memory_registry_mutex);
+    MemoryRecord &record = memory_registry[category];
+    record.current += size;
+    record.peak = std::max(record.peak, record.current);
+}
+
+void untrack_memory(const char *category, size_t size) {
+    if (size == 0)
+        return;
+    std::lock_guard<std::mutex> guard(memory_registry_mutex);
+    auto it = memory_registry.find(category);
+    if (it == memory_registry.end() || it->second.current < size) {
+        /* An unbalanced release indicates an accounting bug in the caller;
+           clamp instead of wrapping around */
+        if (it != memory_registry.end())
+            it->second.current = 0;
+        return;
+    }
+    it->second.current -= size;
+}
+
+std::string memory_usage_string() {
+    std::lock_guard<std::mutex> guard(memory_registry_mutex);
+    std::ostringstream oss;
+    oss << "Memory usage by subsystem:";
+    if (memory_registry.empty())
+        oss << " (no tracked allocations)";
+    for (const auto &kv : memory_registry)
+        oss << std::endl
+            << "  " << kv.first << ": " << mem_string(kv.second.current)
+            << " (peak: " << mem_string(kv.second.peak) << ")";
+    return oss.str();
+}
+
+void advise_huge_pages(void *ptr, size_t size) {
+#if defined(__LINUX__) && defined(MADV_HUGEPAGE)
+    /* Round the range inwards to page boundaries, which madvise() requires */
+    uintptr_t page_size = (uintptr_t) sysconf(_SC_PAGESIZE),
+              begin     = ((uintptr_t) ptr + page_size - 1) & ~(page_size - 1),
+              end       = ((uintptr_t) ptr + size) & ~(page_size - 1);
+
+    /* Not worthwhile below the 2 MiB huge page size */
+    if (end <= begin || end - begin < (uintptr_t) (2 * 1024 * 1024))
+        return;
+
+    /* Purely an optimization hint: failures (e.g. transparent huge pages
+       being disabled system-wide) are ignored */
+    (void) madvise((void *) begin, end - begin, MADV_HUGEPAGE);
+#else
+    (void) ptr; (void) size;
+#endif
+}
+
+#if defined(MTS_ENABLE_OPTIX)
+bool cuda_prefer_managed(size_t size) {
+    /* -1: uninitialized, 0: never, 1: always, 2: automatic */
+    static std::atomic<int> mode(-1);
+
+    int m = mode.load(std::memory_order_acquire);
+    if (unlikely(m == -1)) {
+        const char *env = getenv("MTS_CUDA_MANAGED");
+        m = env ? (atoi(env) != 0 ? 1 : 0) : 2;
+        mode.store(m, std::memory_order_release);
+    }
+    if (m != 2)
+        return m == 1;
+
+    /* Automatic policy: once an allocation would leave less than a fifth of
+       the device memory free, all further scene buffers go into managed
+       memory. The switch is sticky -- mixing the two allocation styles
+       within one scene would make the residency behavior of a render depend
+       on shape declaration order. */
+    static std::atomic<bool> engaged(false);
+    if (engaged.load(std::memory_order_relaxed))
+        return true;
+
+    size_t mem_free = 0, mem_total = 0;
+    cuda_mem_get_info(&mem_free, &mem_total);
+    if (size + mem_total / 5 > mem_free) {
+        if (!engaged.exchange(true))
+            Log(Info, "The scene is approaching the device memory capacity "
+                      "(%s free of %s) -- storing further scene buffers in "
+                      "CUDA managed memory.",
+                mem_string(mem_free), mem_string(mem_total));
+        return true;
+    }
+    return false;
+}
+#endif
+
 #if defined(__WINDOWS__) || defined(__LINUX__)
     void MTS_EXPORT __dummySymbol() { }
 #endif
@@ -273,6 +388,114 @@ int terminal_width() {
     return cached_width;
 }
 
+#if defined(MTS_X86)
+/// Instruction sets supported by the processor executing this binary
+struct HostFeatures {
+    bool sse42    = false, avx      = false, f16c     = false,
+         fma      = false, avx2     = false, avx512f  = false,
+         avx512cd = false, avx512dq = false, avx512bw = false,
+         avx512vl = false;
+};
+
+static void cpuid(int leaf, int subleaf, int out[4]) {
+#if defined(_MSC_VER)
+    __cpuidex(out, leaf, subleaf);
+#else
+    __cpuid_count(leaf, subleaf, out[0], out[1], out[2], out[3]);
+#endif
+}
+
+static HostFeatures host_features() {
+    HostFeatures f;
+    int info[4];
+
+    cpuid(0, 0, info);
+    int max_leaf = info[0];
+
+    cpuid(1, 0, info);
+    f.sse42      = info[2] & (1 << 20);
+    f.fma        = info[2] & (1 << 12);
+    f.f16c       = info[2] & (1 << 29);
+    bool osxsave = info[2] & (1 << 27),
+         avx     = info[2] & (1 << 28);
+
+    /* The operating system must additionally save and restore the wider
+       register files on context switches (XCR0 bits: XMM+YMM for AVX,
+       opmask+upper ZMM state for AVX-512) */
+    uint64_t xcr0 = 0;
+    if (osxsave) {
+#if defined(_MSC_VER)
+        xcr0 = _xgetbv(0);
+#else
+        uint32_t eax, edx;
+        __asm__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        xcr0 = eax | (uint64_t(edx) << 32);
+#endif
+    }
+    bool avx_os    = (xcr0 & 0x06) == 0x06,
+         avx512_os = (xcr0 & 0xe6) == 0xe6;
+
+    f.avx = avx && avx_os;
+
+    if (max_leaf >= 7) {
+        cpuid(7, 0, info);
+        f.avx2     = f.avx     && (info[1] & (1 << 5));
+        f.avx512f  = avx512_os && (info[1] & (1 << 16));
+        f.avx512dq = avx512_os && (info[1] & (1 << 17));
+        f.avx512cd = avx512_os && (info[1] & (1 << 28));
+        f.avx512bw = avx512_os && (info[1] & (1 << 30));
+        f.avx512vl = avx512_os && (info[1] & (1u << 31));
+    }
+
+    return f;
+}
+#endif
+
+std::string info_host_features() {
+    std::ostringstream oss;
+    oss << "Host processor features:";
+
+#if defined(MTS_X86)
+    HostFeatures f = host_features();
+    if (f.avx512f)  oss << " avx512f";
+    if (f.avx512cd) oss << " avx512cd";
+    if (f.avx512dq) oss << " avx512dq";
+    if (f.avx512vl) oss << " avx512vl";
+    if (f.avx512bw) oss << " avx512bw";
+    if (f.avx2)     oss << " avx2";
+    if (f.avx)      oss << " avx";
+    if (f.fma)      oss << " fma";
+    if (f.f16c)     oss << " f16c";
+    if (f.sse42)    oss << " sse4.2";
+#else
+    oss << " (runtime detection unavailable on this architecture)";
+#endif
+
+    return oss.str();
+}
+
+void check_host_features() {
+#if defined(MTS_X86)
+    HostFeatures f = host_features();
+
+    const char *missing = nullptr;
+    if (enoki::has_avx512f && !f.avx512f)
+        missing = "AVX-512";
+    else if (enoki::has_avx2 && !f.avx2)
+        missing = "AVX2";
+    else if (enoki::has_avx && !f.avx)
+        missing = "AVX";
+    else if (enoki::has_sse42 && !f.sse42)
+        missing = "SSE4.2";
+
+    if (missing)
+        Throw("This Mitsuba binary was compiled with %s instructions, which "
+              "the current processor does not support -- executing its packet "
+              "kernels would raise an illegal-instruction fault. Please use a "
+              "build targeting this machine's instruction set.", missing);
+#endif
+}
+
 std::string info_build(int thread_count) {
     constexpr size_t PacketSize = Packet<float>::Size;
 
@@ -1,12 +1,17 @@
+#include <atomic>
 #include <cctype>
 #include <fstream>
+#include <memory>
 #include <set>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 
 #include <mitsuba/core/class.h>
 #include <mitsuba/core/config.h>
 #include <mitsuba/core/filesystem.h>
 #include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/fstream.h>
 #include <mitsuba/core/logger.h>
 #include <mitsuba/core/math.h>
 #include <mitsuba/core/object.h>
@@ -15,6 +20,7 @@
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/spectrum.h>
 #include <mitsuba/core/string.h>
+#include <mitsuba/core/thread.h>
 #include <mitsuba/core/transform.h>
 #include <mitsuba/core/vector.h>
 #include <mitsuba/core/xml.h>
@@ -797,23 +803,21 @@ static std::pair<std::string, std::string> parse_xml(XMLSource &src, XMLParseCon
                            Wavelengths are expected to be specified in increasing order. */
                         std::vector<Float> wavelengths, values;
                         if (has_value) {
-                            std::vector<std::string> tokens = string::tokenize(node.attribute("value").value());
-
-                            for (const std::string &token : tokens) {
-                                std::vector<std::string> pair = string::tokenize(token, ":");
-                                if (pair.size() != 2)
-                                    src.throw_error(node, "invalid spectrum (expected wavelength:value pairs)");
-
-                                Float wavelength, value;
-                                try {
-                                    wavelength = detail::stof(pair[0]);
-                                    value = detail::stof(pair[1]);
-                                } catch (...) {
-                                    src.throw_error(node, "could not parse wavelength:value pair: \"%s\"", token);
-                                }
-
-                                wavelengths.push_back(wavelength);
-                                values.push_back(value);
+                            const char *value_str = node.attribute("value").value();
+                            std::vector<Float> numbers;
+                            try {
+                                string::parse_floats(value_str, numbers, ':');
+                            } catch (...) {
+                                src.throw_error(node, "could not parse spectrum \"%s\"", value_str);
+                            }
+                            if (numbers.size() % 2 != 0)
+                                src.throw_error(node, "invalid spectrum (expected wavelength:value pairs)");
+
+                            wavelengths.reserve(numbers.size() / 2);
+                            values.reserve(numbers.size() / 2);
+                            for (size_t n = 0; n < numbers.size(); n += 2) {
+                                wavelengths.push_back(numbers[n]);
+                                values.push_back(numbers[n + 1]);
                             }
                         } else if (has_filename) {
                             spectrum_from_file(node.attribute("filename").value(), wavelengths, values);
@@ -947,20 +951,19 @@ static std::pair<std::string, std::string> parse_xml(XMLSource &src, XMLParseCon
 
             case Tag::Matrix: {
                     check_attributes(src, node, { "value" });
-                    std::vector<std::string> tokens = string::tokenize(node.attribute("value").value());
+                    const char *value_str = node.attribute("value").value();
+                    std::vector<Float> tokens;
+                    try {
+                        string::parse_floats(value_str, tokens);
+                    } catch (...) {
+                        src.throw_error(node, "could not parse matrix \"%s\"", value_str);
+                    }
                     if (tokens.size() != 16)
                         Throw("matrix: expected 16 values");
                     Matrix4f matrix;
-                    for (int i = 0; i < 4; ++i) {
-                        for (int j = 0; j < 4; ++j) {
-                            try {
-                                matrix(i, j) = detail::stof(tokens[i * 4 + j]);
-                            } catch (...) {
-                                src.throw_error(node, "could not parse floating point value \"%s\"",
-                                                tokens[i * 4 + j]);
-                            }
-                        }
-                    }
+                    for (int i = 0; i < 4; ++i)
+                        for (int j = 0; j < 4; ++j)
+                            matrix(i, j) = tokens[i * 4 + j];
                     ctx.transform = Transform4f(matrix) * ctx.transform;
                 }
                 break;
@@ -983,6 +986,76 @@ static std::pair<std::string, std::string> parse_xml(XMLSource &src, XMLParseCon
     return std::make_pair("", "");
 }
 
+/**
+ * Issue readahead hints for every file referenced by the parsed scene, so
+ * that instantiation rarely blocks on cold storage (e.g. scene assets on a
+ * network file system). String properties are simply matched against the
+ * file system -- a false positive merely wastes a hint, and a false negative
+ * falls back to the usual cold open.
+ */
+static void prefetch_scene_files(const XMLParseContext &ctx) {
+    std::vector<fs::path> paths;
+    std::unordered_set<std::string> seen;
+
+    const FileResolver *fr = Thread::thread()->file_resolver();
+
+    for (const auto &kv : ctx.instances) {
+        for (const std::string &value : kv.second.props.string_values()) {
+            if (value.empty())
+                continue;
+            fs::path path = fr->resolve(value);
+            if (!fs::is_regular_file(path))
+                continue;
+            if (seen.insert(path.string()).second)
+                paths.push_back(std::move(path));
+        }
+    }
+
+    if (paths.empty())
+        return;
+
+    Log(Debug, "Prefetching %zu scene asset%s ..", paths.size(),
+        paths.size() == 1 ? "" : "s");
+
+    /* The hints themselves are non-blocking, but the fallback implementation
+       of \ref FileStream::prefetch() reads file contents; neither should
+       hold up instantiation, so the work runs on a few detached helper
+       threads that simply expire once the list is exhausted. */
+    auto shared  = std::make_shared<std::vector<fs::path>>(std::move(paths));
+    auto counter = std::make_shared<std::atomic<size_t>>(0);
+
+    size_t helper_count = std::min((size_t) 4, shared->size());
+    for (size_t i = 0; i < helper_count; ++i) {
+        std::thread([shared, counter]() {
+            while (true) {
+                size_t j = (*counter)++;
+                if (j >= shared->size())
+                    break;
+                FileStream::prefetch((*shared)[j]);
+            }
+        }).detach();
+    }
+}
+
+/**
+ * Load every plugin referenced by the parsed scene before instantiation
+ * begins. Collecting the names up front lets \ref PluginManager::preload()
+ * fetch all of the plugin shared objects at once instead of paying the
+ * cold-start cost of the dynamic loader serially, one first-use at a time.
+ */
+static void preload_plugins(const XMLParseContext &ctx) {
+    std::vector<std::string> names;
+    for (const auto &kv : ctx.instances) {
+        // The scene itself is constructed directly, without a plugin
+        if (kv.second.class_ && kv.second.class_->name() == "Scene")
+            continue;
+        const std::string &name = kv.second.props.plugin_name();
+        if (!name.empty())
+            names.push_back(name);
+    }
+    PluginManager::instance()->preload(names);
+}
+
 static ref<Object> instantiate_node(XMLParseContext &ctx, const std::string &id) {
     auto it = ctx.instances.find(id);
     if (it == ctx.instances.end())
@@ -1029,7 +1102,7 @@ static ref<Object> instantiate_node(XMLParseContext &ctx, const std::string &id)
                 } else {
                     int ctr = 0;
                     for (auto c : children)
-                        props.set_object(kv.first + "_" + std::to_string(ctr++), children[0], false);
+                        props.set_object(kv.first + "_" + std::to_string(ctr++), c, false);
                 }
             } catch (const std::exception &e) {
                 if (strstr(e.what(), "Error while loading") == nullptr)
@@ -1104,7 +1177,16 @@ ref<Object> load_string(const std::string &string, const std::string &variant,
     size_t arg_counter; // Unused
     auto scene_id = detail::parse_xml(src, ctx, root, Tag::Invalid, prop,
                                       param, arg_counter, 0).second;
-    return detail::instantiate_node(ctx, scene_id);
+    detail::prefetch_scene_files(ctx);
+    detail::preload_plugins(ctx);
+
+    /* Instantiate inside the shared arena so that parallel scene setup
+       (kd-tree/BVH builds, image decoding, ..) draws from the same worker
+       pool as everything else; see \ref global_task_arena() */
+    ref<Object> result;
+    global_task_arena().execute(
+        [&] { result = detail::instantiate_node(ctx, scene_id); });
+    return result;
 }
 
 ref<Object> load_file(const fs::path &filename_, const std::string &variant,
@@ -1162,7 +1244,14 @@ ref<Object> load_file(const fs::path &filename_, const std::string &variant,
         filename = backup;
     }
 
-    return detail::instantiate_node(ctx, scene_id);
+    detail::prefetch_scene_files(ctx);
+    detail::preload_plugins(ctx);
+
+    // See the corresponding comment in \ref load_string()
+    ref<Object> result;
+    global_task_arena().execute(
+        [&] { result = detail::instantiate_node(ctx, scene_id); });
+    return result;
 }
 
 NAMESPACE_END(xml)
@@ -1,13 +1,40 @@
 #include <mitsuba/core/zstream.h>
 #include <zlib.h>
 
+#if defined(MTS_ENABLE_ZSTD)
+#  include <zstd.h>
+#endif
+
 NAMESPACE_BEGIN(mitsuba)
 
 ZStream::ZStream(Stream *child_stream, EStreamType stream_type, int level)
     : m_child_stream(child_stream),
-      m_deflate_stream(new z_stream()),
-      m_inflate_stream(new z_stream()),
+      m_stream_type(stream_type),
       m_did_write(false) {
+    if (stream_type == EZstdStream) {
+#if defined(MTS_ENABLE_ZSTD)
+        m_zstd_cctx = ZSTD_createCCtx();
+        m_zstd_dctx = ZSTD_createDCtx();
+        if (!m_zstd_cctx || !m_zstd_dctx)
+            Throw("Could not initialize zstd contexts!");
+
+        if (level != -1) {
+            size_t retval = ZSTD_CCtx_setParameter(
+                m_zstd_cctx, ZSTD_c_compressionLevel, level);
+            if (ZSTD_isError(retval))
+                Throw("Could not set zstd compression level: %s",
+                      ZSTD_getErrorName(retval));
+        }
+#else
+        Throw("ZStream: zstd support was not enabled at compile time "
+              "(set MTS_ENABLE_ZSTD=ON in CMake)!");
+#endif
+        return;
+    }
+
+    m_deflate_stream.reset(new z_stream());
+    m_inflate_stream.reset(new z_stream());
+
     m_deflate_stream->zalloc = Z_NULL;
     m_deflate_stream->zfree = Z_NULL;
     m_deflate_stream->opaque = Z_NULL;
@@ -34,6 +61,26 @@ ZStream::ZStream(Stream *child_stream, EStreamType stream_type, int level)
 void ZStream::write(const void *ptr, size_t size) {
     Assert(m_child_stream != nullptr);
 
+#if defined(MTS_ENABLE_ZSTD)
+    if (m_stream_type == EZstdStream) {
+        ZSTD_inBuffer in { ptr, size, 0 };
+
+        do {
+            ZSTD_outBuffer out { m_deflate_buffer, sizeof(m_deflate_buffer), 0 };
+
+            size_t retval = ZSTD_compressStream2(m_zstd_cctx, &out, &in,
+                                                 ZSTD_e_continue);
+            if (ZSTD_isError(retval))
+                Throw("ZSTD_compressStream2(): %s", ZSTD_getErrorName(retval));
+
+            m_child_stream->write(m_deflate_buffer, out.pos);
+        } while (in.pos < in.size);
+
+        m_did_write = true;
+        return;
+    }
+#endif
+
     m_deflate_stream->avail_in = (uInt) size;
     m_deflate_stream->next_in = (uint8_t *) ptr;
 
@@ -60,6 +107,38 @@ void ZStream::read(void *ptr, size_t size) {
     Assert(m_child_stream != nullptr);
 
     uint8_t *targetPtr = (uint8_t *) ptr;
+
+#if defined(MTS_ENABLE_ZSTD)
+    if (m_stream_type == EZstdStream) {
+        while (size > 0) {
+            if (m_zstd_in_pos == m_zstd_in_size) {
+                size_t remaining = m_child_stream->size() - m_child_stream->tell();
+                m_zstd_in_pos = 0;
+                m_zstd_in_size = std::min(remaining, sizeof(m_inflate_buffer));
+                if (m_zstd_in_size == 0)
+                    Throw("Read less data than expected (%i more bytes required)", size);
+                m_child_stream->read(m_inflate_buffer, m_zstd_in_size);
+            }
+
+            ZSTD_inBuffer in { m_inflate_buffer, m_zstd_in_size, m_zstd_in_pos };
+            ZSTD_outBuffer out { targetPtr, size, 0 };
+
+            size_t retval = ZSTD_decompressStream(m_zstd_dctx, &out, &in);
+            if (ZSTD_isError(retval))
+                Throw("ZSTD_decompressStream(): %s", ZSTD_getErrorName(retval));
+
+            m_zstd_in_pos = in.pos;
+            targetPtr += out.pos;
+            size -= out.pos;
+
+            if (size > 0 && retval == 0 && m_zstd_in_pos == m_zstd_in_size &&
+                m_child_stream->tell() == m_child_stream->size())
+                Throw("ZSTD_decompressStream(): attempting to read past the end of the stream!");
+        }
+        return;
+    }
+#endif
+
     while (size > 0) {
         if (m_inflate_stream->avail_in == 0) {
             size_t remaining = m_child_stream->size() - m_child_stream->tell();
@@ -101,32 +180,80 @@ void ZStream::read(void *ptr, size_t size) {
 void ZStream::flush() {
     Assert(m_child_stream != nullptr);
 
-    if (m_did_write) {
-        m_deflate_stream->avail_in = 0;
-        m_deflate_stream->next_in = NULL;
-        int output_size = 0;
+    if (!m_did_write)
+        return;
 
-        do {
-            m_deflate_stream->avail_out = sizeof(m_deflate_buffer);
-            m_deflate_stream->next_out = m_deflate_buffer;
+#if defined(MTS_ENABLE_ZSTD)
+    if (m_stream_type == EZstdStream) {
+        ZSTD_inBuffer in { nullptr, 0, 0 };
+        size_t retval;
 
-            int retval = deflate(m_deflate_stream.get(), Z_FULL_FLUSH);
-            if (retval == Z_STREAM_ERROR)
-                Throw("deflate(): stream error!");
+        do {
+            ZSTD_outBuffer out { m_deflate_buffer, sizeof(m_deflate_buffer), 0 };
 
-            output_size = sizeof(m_deflate_buffer) - m_deflate_stream->avail_out;
+            retval = ZSTD_compressStream2(m_zstd_cctx, &out, &in, ZSTD_e_flush);
+            if (ZSTD_isError(retval))
+                Throw("ZSTD_compressStream2(): %s", ZSTD_getErrorName(retval));
 
-            m_child_stream->write(m_deflate_buffer, output_size);
-        } while (output_size != 0);
+            m_child_stream->write(m_deflate_buffer, out.pos);
+        } while (retval != 0);
 
         m_child_stream->flush();
+        return;
     }
+#endif
+
+    m_deflate_stream->avail_in = 0;
+    m_deflate_stream->next_in = NULL;
+    int output_size = 0;
+
+    do {
+        m_deflate_stream->avail_out = sizeof(m_deflate_buffer);
+        m_deflate_stream->next_out = m_deflate_buffer;
+
+        int retval = deflate(m_deflate_stream.get(), Z_FULL_FLUSH);
+        if (retval == Z_STREAM_ERROR)
+            Throw("deflate(): stream error!");
+
+        output_size = sizeof(m_deflate_buffer) - m_deflate_stream->avail_out;
+
+        m_child_stream->write(m_deflate_buffer, output_size);
+    } while (output_size != 0);
+
+    m_child_stream->flush();
 }
 
 void ZStream::close() {
     if (!m_child_stream)
         return;
 
+#if defined(MTS_ENABLE_ZSTD)
+    if (m_stream_type == EZstdStream) {
+        if (m_did_write) {
+            ZSTD_inBuffer in { nullptr, 0, 0 };
+            size_t retval;
+
+            do {
+                ZSTD_outBuffer out { m_deflate_buffer, sizeof(m_deflate_buffer), 0 };
+
+                retval = ZSTD_compressStream2(m_zstd_cctx, &out, &in, ZSTD_e_end);
+                if (ZSTD_isError(retval))
+                    Throw("ZSTD_compressStream2(): %s", ZSTD_getErrorName(retval));
+
+                m_child_stream->write(m_deflate_buffer, out.pos);
+            } while (retval != 0);
+        }
+
+        ZSTD_freeCCtx(m_zstd_cctx);
+        ZSTD_freeDCtx(m_zstd_dctx);
+        m_zstd_cctx = nullptr;
+        m_zstd_dctx = nullptr;
+
+        m_child_stream = nullptr;
+        return;
+    }
+#endif
+
     if (m_did_write) {
         m_deflate_stream->avail_in = 0;
         m_deflate_stream->next_in = NULL;
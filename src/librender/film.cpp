@@ -52,6 +52,33 @@ MTS_VARIANT Film<Float, Spectrum>::Film(const Properties &props) : Object() {
 
 MTS_VARIANT Film<Float, Spectrum>::~Film() {}
 
+MTS_VARIANT void Film<Float, Spectrum>::put_splat(const Point2f & /* pos */,
+                                                  const Wavelength & /* wavelengths */,
+                                                  const Spectrum & /* value */,
+                                                  Mask /* active */) const {
+    Throw("%s: this film does not support splatted contributions!",
+          class_()->name());
+}
+
+MTS_VARIANT void Film<Float, Spectrum>::set_splat_scale(ScalarFloat /* scale */) {
+    Throw("%s: this film does not support splatted contributions!",
+          class_()->name());
+}
+
+MTS_VARIANT void Film<Float, Spectrum>::put_sample(const Point2f & /* pos */,
+                                                   const Float * /* values */,
+                                                   Mask /* active */) const { }
+
+MTS_VARIANT bool Film<Float, Spectrum>::has_sample_stream() const {
+    return false;
+}
+
+MTS_VARIANT void Film<Float, Spectrum>::clear_region(const ScalarPoint2i & /* offset */,
+                                                     const ScalarVector2i & /* size */) {
+    Throw("%s: this film does not support incremental region updates!",
+          class_()->name());
+}
+
 MTS_VARIANT void Film<Float, Spectrum>::set_crop_window(const ScalarPoint2i &crop_offset,
                                                         const ScalarVector2i &crop_size) {
     if (any(crop_offset < 0 || crop_size <= 0 || crop_offset + crop_size > m_size))
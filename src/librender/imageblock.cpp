@@ -1,16 +1,196 @@
 #include <mitsuba/render/imageblock.h>
+#include <mitsuba/core/atomic.h>
 #include <mitsuba/core/bitmap.h>
 #include <mitsuba/core/profiler.h>
+#include <mitsuba/core/util.h>
+#include <enoki/half.h>
+#include <algorithm>
 
 NAMESPACE_BEGIN(mitsuba)
 
+/**
+ * \brief Variant of \ref accumulate_2d() that uses atomic additions within a
+ * band of \c overlap pixels along the boundary of the source region
+ *
+ * Worker threads merge finished blocks into the film without any kind of
+ * synchronization. This is fine for the block interiors, which are disjoint,
+ * but the reconstruction filter footprints of adjacent blocks overlap in a
+ * band of twice the border size around each block, and concurrent updates to
+ * this region must be atomic.
+ */
+template <typename Value>
+static void accumulate_2d_atomic(const Value *source,
+                                 Vector<int, 2> source_size,
+                                 Value *target,
+                                 Vector<int, 2> target_size,
+                                 Point<int, 2> source_offset,
+                                 Point<int, 2> target_offset,
+                                 Vector<int, 2> size,
+                                 size_t channel_count,
+                                 int overlap) {
+    /// Clip against bounds of source and target image
+    Vector<int, 2> shift = max(0, max(-source_offset, -target_offset));
+    source_offset += shift;
+    target_offset += shift;
+    size -= max(source_offset + size - source_size, 0);
+    size -= max(target_offset + size - target_size, 0);
+
+    if (any(size <= 0))
+        return;
+
+    source += (source_offset.x() + source_offset.y() * (size_t) source_size.x()) * channel_count;
+    target += (target_offset.x() + target_offset.y() * (size_t) target_size.x()) * channel_count;
+
+    int bx = std::min(overlap, size.x()),
+        by = std::min(overlap, size.y()),
+        n  = (int) (size.x() * channel_count);
+
+    for (int y = 0; y < size.y(); ++y) {
+        bool row_shared = y < by || y >= size.y() - by;
+
+        int n0 = row_shared ? n : (int) (bx * channel_count),
+            n1 = row_shared ? n : std::max(n0, (int) ((size.x() - bx) * channel_count));
+
+        for (int i = 0; i < n0; ++i)
+            ((AtomicFloat<Value> *) target)[i] += source[i];
+        /* The interior is owned exclusively by this thread and can use the
+           SIMD kernel; only the shared bands require atomics */
+        accumulate_1d(source + n0, target + n0, (size_t) (n1 - n0));
+        for (int i = n1; i < n; ++i)
+            ((AtomicFloat<Value> *) target)[i] += source[i];
+
+        source += source_size.x() * channel_count;
+        target += target_size.x() * channel_count;
+    }
+}
+
+/**
+ * \brief Variant of \ref accumulate_2d() that adds a single-precision source
+ * region into a packed mixed-precision target (see \ref
+ * ImageBlock::set_half_channels())
+ *
+ * Half-precision channels are widened, accumulated, and rounded back once per
+ * merge. Since sample accumulation happens in single precision within the
+ * source blocks, the rounding error is bounded by one ulp of the running sum
+ * per merged block. The caller must serialize concurrent invocations.
+ */
+template <typename Value>
+static void accumulate_2d_packed(const Value *source,
+                                 Vector<int, 2> source_size,
+                                 uint8_t *target,
+                                 Vector<int, 2> target_size,
+                                 Point<int, 2> source_offset,
+                                 Point<int, 2> target_offset,
+                                 Vector<int, 2> size,
+                                 size_t channel_count,
+                                 const std::vector<bool> &half_channels,
+                                 const std::vector<uint32_t> &channel_offset,
+                                 uint32_t pixel_stride) {
+    /// Clip against bounds of source and target image
+    Vector<int, 2> shift = max(0, max(-source_offset, -target_offset));
+    source_offset += shift;
+    target_offset += shift;
+    size -= max(source_offset + size - source_size, 0);
+    size -= max(target_offset + size - target_size, 0);
+
+    if (any(size <= 0))
+        return;
+
+    source += (source_offset.x() + source_offset.y() * (size_t) source_size.x()) * channel_count;
+    target += (target_offset.x() + target_offset.y() * (size_t) target_size.x()) * pixel_stride;
+
+    for (int y = 0; y < size.y(); ++y) {
+        const Value *source_p = source;
+        uint8_t *target_p = target;
+
+        for (int x = 0; x < size.x(); ++x) {
+            for (size_t k = 0; k < channel_count; ++k) {
+                uint8_t *ptr = target_p + channel_offset[k];
+                if (half_channels[k]) {
+                    uint16_t packed;
+                    memcpy(&packed, ptr, sizeof(uint16_t));
+                    packed = enoki::half::float32_to_float16(
+                        enoki::half::float16_to_float32(packed) +
+                        (float) source_p[k]);
+                    memcpy(ptr, &packed, sizeof(uint16_t));
+                } else {
+                    float value;
+                    memcpy(&value, ptr, sizeof(float));
+                    value += (float) source_p[k];
+                    memcpy(ptr, &value, sizeof(float));
+                }
+            }
+            source_p += channel_count;
+            target_p += pixel_stride;
+        }
+
+        source += source_size.x() * channel_count;
+        target += target_size.x() * pixel_stride;
+    }
+}
+
+/**
+ * \brief Variant of \ref accumulate_2d() that adds an interleaved or planar
+ * source region into a channel-planar target (see \ref
+ * ImageBlock::set_planar())
+ *
+ * The accumulation proceeds one channel plane at a time: every source channel
+ * is read in a single sweep and written to a contiguous region of the target,
+ * which streams well even for films with many AOV channels. The caller must
+ * serialize concurrent invocations.
+ */
+template <typename Value>
+static void accumulate_2d_planar(const Value *source,
+                                 Vector<int, 2> source_size,
+                                 Value *target,
+                                 Vector<int, 2> target_size,
+                                 Point<int, 2> source_offset,
+                                 Point<int, 2> target_offset,
+                                 Vector<int, 2> size,
+                                 size_t channel_count,
+                                 bool source_planar) {
+    /// Clip against bounds of source and target image
+    Vector<int, 2> shift = max(0, max(-source_offset, -target_offset));
+    source_offset += shift;
+    target_offset += shift;
+    size -= max(source_offset + size - source_size, 0);
+    size -= max(target_offset + size - target_size, 0);
+
+    if (any(size <= 0))
+        return;
+
+    size_t source_pixels    = (size_t) source_size.x() * source_size.y(),
+           target_pixels    = (size_t) target_size.x() * target_size.y(),
+           source_px_stride = source_planar ? 1 : channel_count,
+           source_ch_stride = source_planar ? source_pixels : 1;
+
+    source += (source_offset.x() + source_offset.y() * (size_t) source_size.x()) * source_px_stride;
+    target += target_offset.x() + target_offset.y() * (size_t) target_size.x();
+
+    for (size_t k = 0; k < channel_count; ++k) {
+        const Value *s = source + k * source_ch_stride;
+        Value *t = target + k * target_pixels;
+
+        for (int y = 0; y < size.y(); ++y) {
+            if (source_px_stride == 1) {
+                accumulate_1d(s, t, (size_t) size.x());
+            } else {
+                for (int x = 0; x < size.x(); ++x)
+                    t[x] += s[x * source_px_stride];
+            }
+            s += source_size.x() * source_px_stride;
+            t += target_size.x();
+        }
+    }
+}
+
 MTS_VARIANT
 ImageBlock<Float, Spectrum>::ImageBlock(const ScalarVector2i &size, size_t channel_count,
                                         const ReconstructionFilter *filter, bool warn_negative,
                                         bool warn_invalid, bool border, bool normalize)
     : m_offset(0), m_size(0), m_channel_count((uint32_t) channel_count), m_filter(filter),
       m_weights_x(nullptr), m_weights_y(nullptr), m_warn_negative(warn_negative),
-      m_warn_invalid(warn_invalid), m_normalize(normalize) {
+      m_warn_invalid(warn_invalid), m_normalize(normalize), m_track_variance(false) {
     m_border_size = (uint32_t)((filter != nullptr && border) ? filter->border_size() : 0);
 
     if (filter) {
@@ -18,32 +198,327 @@ ImageBlock<Float, Spectrum>::ImageBlock(const ScalarVector2i &size, size_t chann
         int filter_size = (int) std::ceil(2 * filter->radius()) + 1;
         m_weights_x = new Float[2 * filter_size];
         m_weights_y = m_weights_x + filter_size;
+
+        /* Record the per-axis filter tap count so that put() can dispatch to
+           a kernel with compile-time loop bounds (see \ref put_filtered()) */
+        if (filter->radius() > 1)
+            m_filter_taps = ceil2int<uint32_t>(
+                (filter->radius() - 2.f * math::RayEpsilon<ScalarFloat>) * 2.f);
     }
 
     set_size(size);
 }
 
 MTS_VARIANT ImageBlock<Float, Spectrum>::~ImageBlock() {
+    util::untrack_memory("Image blocks", m_tracked_bytes);
+
     /* Note that m_weights_y points to the same array as
        m_weights_x, so there is no need to delete it. */
     if (m_weights_x)
         delete[] m_weights_x;
 }
 
+MTS_VARIANT void ImageBlock<Float, Spectrum>::update_memory_tracking() {
+    if constexpr (is_cuda_array_v<Float> || is_diff_array_v<Float>)
+        return;
+
+    size_t pixel_count = hprod(m_size + 2 * m_border_size), bytes;
+    if (unlikely(m_packed))
+        bytes = pixel_count * (size_t) m_pixel_stride;
+    else
+        bytes = pixel_count * m_channel_count * sizeof(ScalarFloat);
+    if (m_track_variance)
+        bytes += 3 * hprod(m_size) * sizeof(ScalarFloat);
+    if (m_outlier_rejection)
+        bytes += 4 * hprod(m_size) * sizeof(ScalarFloat);
+
+    if (bytes == m_tracked_bytes)
+        return;
+
+    util::untrack_memory("Image blocks", m_tracked_bytes);
+    util::track_memory("Image blocks", bytes);
+    m_tracked_bytes = bytes;
+
+    /* Large blocks (i.e. the film storage) benefit from huge page backing */
+    if (unlikely(m_packed))
+        util::advise_huge_pages(m_packed.get(), bytes);
+    else if (m_data.data())
+        util::advise_huge_pages(m_data.data(), bytes);
+}
+
 MTS_VARIANT void ImageBlock<Float, Spectrum>::clear() {
     size_t size = m_channel_count * hprod(m_size + 2 * m_border_size);
-    if constexpr (!is_cuda_array_v<Float>)
-        memset(m_data.data(), 0, size * sizeof(ScalarFloat));
-    else
+    if constexpr (!is_cuda_array_v<Float>) {
+        if (unlikely(m_packed)) {
+            // Zero bit patterns denote zero in both float32 and float16
+            memset(m_packed.get(), 0,
+                   hprod(m_size + 2 * m_border_size) * (size_t) m_pixel_stride);
+        } else {
+            memset(m_data.data(), 0, size * sizeof(ScalarFloat));
+        }
+        if (m_track_variance)
+            memset(m_var_data.data(), 0, 3 * hprod(m_size) * sizeof(ScalarFloat));
+        if (m_outlier_rejection)
+            memset(m_outlier_data.data(), 0, 4 * hprod(m_size) * sizeof(ScalarFloat));
+    } else {
         m_data = zero<DynamicBuffer<Float>>(size);
+        if (m_track_variance)
+            m_var_data = zero<DynamicBuffer<Float>>(3 * hprod(m_size));
+    }
 }
 
 MTS_VARIANT void ImageBlock<Float, Spectrum>::set_size(const ScalarVector2i &size) {
     if (size == m_size)
         return;
     m_size = size;
-    m_data = empty<DynamicBuffer<Float>>(
-        m_channel_count * hprod(size + 2 * m_border_size));
+    if (unlikely(m_packed))
+        m_packed.reset(
+            new uint8_t[hprod(size + 2 * m_border_size) * (size_t) m_pixel_stride]);
+    else
+        m_data = empty<DynamicBuffer<Float>>(
+            m_channel_count * hprod(size + 2 * m_border_size));
+    if (m_track_variance)
+        m_var_data = empty<DynamicBuffer<Float>>(3 * hprod(size));
+    if (m_outlier_rejection)
+        m_outlier_data = zero<DynamicBuffer<Float>>(4 * hprod(size));
+    update_memory_tracking();
+}
+
+MTS_VARIANT void
+ImageBlock<Float, Spectrum>::set_half_channels(const std::vector<bool> &half) {
+    if (half.size() != m_channel_count)
+        Throw("ImageBlock::set_half_channels(): expected %i channel flags, "
+              "got %i!", m_channel_count, half.size());
+
+    bool any_half = std::find(half.begin(), half.end(), true) != half.end();
+
+    if constexpr (is_cuda_array_v<Float> || is_diff_array_v<Float>) {
+        if (any_half)
+            Throw("ImageBlock::set_half_channels(): only supported in the "
+                  "CPU rendering modes!");
+    }
+
+    if (any_half && m_planar)
+        Throw("ImageBlock::set_half_channels(): incompatible with planar "
+              "channel storage! (see set_planar())");
+
+    if (!any_half) {
+        // Restore the default full-precision storage
+        m_packed.reset();
+        m_half_channels.clear();
+        m_channel_offset.clear();
+        m_pixel_stride = 0;
+        m_data = zero<DynamicBuffer<Float>>(
+            m_channel_count * hprod(m_size + 2 * m_border_size));
+        update_memory_tracking();
+        return;
+    }
+
+    // Compute the byte offset of each channel within a packed pixel record
+    m_half_channels = half;
+    m_channel_offset.resize(m_channel_count);
+    uint32_t stride = 0;
+    for (uint32_t k = 0; k < m_channel_count; ++k) {
+        m_channel_offset[k] = stride;
+        stride += half[k] ? (uint32_t) sizeof(uint16_t)
+                          : (uint32_t) sizeof(float);
+    }
+    m_pixel_stride = stride;
+
+    size_t pixel_count = hprod(m_size + 2 * m_border_size);
+    m_packed.reset(new uint8_t[pixel_count * (size_t) m_pixel_stride]);
+    memset(m_packed.get(), 0, pixel_count * (size_t) m_pixel_stride);
+
+    // Release the now-unused full-precision buffer
+    m_data = DynamicBuffer<Float>();
+    update_memory_tracking();
+}
+
+MTS_VARIANT void ImageBlock<Float, Spectrum>::unpack(ScalarFloat *target) const {
+    if (unlikely(!m_packed && !m_planar))
+        Throw("ImageBlock::unpack(): neither half-precision nor planar "
+              "channel storage is enabled!");
+
+    size_t pixel_count = hprod(m_size + 2 * m_border_size);
+
+    if (m_planar) {
+        /* Transpose the channel planes into the interleaved output; each
+           plane is read in a single sequential sweep */
+        if constexpr (!is_cuda_array_v<Float> && !is_diff_array_v<Float>) {
+            const ScalarFloat *planes = m_data.data();
+            for (uint32_t k = 0; k < m_channel_count; ++k) {
+                const ScalarFloat *plane = planes + (size_t) k * pixel_count;
+                ScalarFloat *out = target + k;
+                for (size_t i = 0; i < pixel_count; ++i) {
+                    *out = plane[i];
+                    out += m_channel_count;
+                }
+            }
+        }
+        return;
+    }
+
+    const uint8_t *source = m_packed.get();
+
+    for (size_t i = 0; i < pixel_count; ++i) {
+        for (uint32_t k = 0; k < m_channel_count; ++k) {
+            const uint8_t *ptr = source + m_channel_offset[k];
+            if (m_half_channels[k]) {
+                uint16_t value;
+                memcpy(&value, ptr, sizeof(uint16_t));
+                *target++ = enoki::half::float16_to_float32(value);
+            } else {
+                float value;
+                memcpy(&value, ptr, sizeof(float));
+                *target++ = value;
+            }
+        }
+        source += m_pixel_stride;
+    }
+}
+
+MTS_VARIANT void ImageBlock<Float, Spectrum>::set_planar(bool value) {
+    if constexpr (is_cuda_array_v<Float> || is_diff_array_v<Float>) {
+        if (value)
+            Throw("ImageBlock::set_planar(): only supported in the CPU "
+                  "rendering modes!");
+    }
+    if (value && m_packed)
+        Throw("ImageBlock::set_planar(): incompatible with half-precision "
+              "channel storage! (see set_half_channels())");
+    if (value == m_planar)
+        return;
+    m_planar = value;
+    // The total allocation is unchanged, but any contents become stale
+    clear();
+}
+
+MTS_VARIANT void ImageBlock<Float, Spectrum>::set_atomic(bool value) {
+    if constexpr (is_cuda_array_v<Float> || is_diff_array_v<Float>) {
+        if (value)
+            Throw("ImageBlock::set_atomic(): only supported in the CPU "
+                  "rendering modes!");
+    }
+    m_atomic = value;
+}
+
+MTS_VARIANT void ImageBlock<Float, Spectrum>::set_track_variance(bool value) {
+    if (value == m_track_variance)
+        return;
+    m_track_variance = value;
+    if (m_track_variance)
+        m_var_data = zero<DynamicBuffer<Float>>(3 * hprod(m_size));
+    else
+        m_var_data = DynamicBuffer<Float>();
+    update_memory_tracking();
+}
+
+MTS_VARIANT void ImageBlock<Float, Spectrum>::set_outlier_rejection(bool value) {
+    if (value == m_outlier_rejection)
+        return;
+    if (value) {
+        if constexpr (is_cuda_array_v<Float>)
+            Throw("ImageBlock::set_outlier_rejection(): only supported in "
+                  "the CPU rendering modes!");
+        if (!m_track_variance)
+            Throw("ImageBlock::set_outlier_rejection(): requires variance "
+                  "tracking (see set_track_variance())!");
+    }
+    m_outlier_rejection = value;
+    if (m_outlier_rejection) {
+        m_outlier_data = zero<DynamicBuffer<Float>>(4 * hprod(m_size));
+        m_outlier_scratch.reset(new Float[m_channel_count]);
+    } else {
+        m_outlier_data = DynamicBuffer<Float>();
+        m_outlier_scratch.reset();
+    }
+    update_memory_tracking();
+}
+
+MTS_VARIANT void ImageBlock<Float, Spectrum>::merge_outliers() {
+    if constexpr (is_cuda_array_v<Float>) {
+        Throw("ImageBlock::merge_outliers(): not supported in GPU modes!");
+    } else {
+        if (!m_outlier_rejection)
+            return;
+
+        ScalarFloat *residual = m_outlier_data.data(),
+                    *data     = m_data.data();
+        uint32_t width      = (uint32_t) m_size.x() + 2 * m_border_size,
+                 n_channels = std::min(m_channel_count, 3u);
+        size_t px_stride = m_planar ? 1 : m_channel_count,
+               ch_stride = m_planar ? (size_t) hprod(m_size + 2 * m_border_size) : 1;
+
+        for (int y = 0; y < m_size.y(); ++y) {
+            for (int x = 0; x < m_size.x(); ++x) {
+                size_t i = (size_t) y * m_size.x() + x;
+                ScalarFloat count = residual[4 * i + 3];
+                if (count == 0)
+                    continue;
+
+                /* Density-based reweighting: a residual confirmed by 'count'
+                   independent samples keeps a (count - 1) / count fraction
+                   of its energy, which discards singleton fireflies while
+                   converging to the unbiased estimate as samples accumulate */
+                ScalarFloat weight = (count - 1) / count;
+                size_t offset = ((size_t) (y + m_border_size) * width +
+                                 (x + m_border_size)) * px_stride;
+                for (uint32_t k = 0; k < n_channels; ++k)
+                    data[offset + k * ch_stride] += residual[4 * i + k] * weight;
+            }
+        }
+
+        memset(residual, 0, 4 * hprod(m_size) * sizeof(ScalarFloat));
+    }
+}
+
+MTS_VARIANT typename ImageBlock<Float, Spectrum>::ScalarFloat
+ImageBlock<Float, Spectrum>::error_estimate() const {
+    if constexpr (is_cuda_array_v<Float>) {
+        Throw("ImageBlock::error_estimate(): not supported in GPU modes!");
+    } else {
+        Assert(m_track_variance);
+
+        const ScalarFloat *ptr = m_var_data.data();
+        ScalarFloat result = 0.f;
+        size_t pixel_count = hprod(m_size);
+
+        for (size_t i = 0; i < pixel_count; ++i) {
+            ScalarFloat sum    = ptr[3 * i],
+                        sum_sq = ptr[3 * i + 1],
+                        n      = ptr[3 * i + 2];
+            if (n < 2)
+                continue;
+
+            ScalarFloat mean     = sum / n,
+                        variance = std::max(sum_sq - sum * sum / n, ScalarFloat(0)) / (n - 1),
+                        error    = std::sqrt(variance / n) /
+                                   std::max(mean, ScalarFloat(1e-3));
+            result = std::max(result, error);
+        }
+
+        return result;
+    }
+}
+
+MTS_VARIANT std::pair<double, size_t>
+ImageBlock<Float, Spectrum>::luminance_accum() const {
+    if constexpr (is_cuda_array_v<Float>) {
+        Throw("ImageBlock::luminance_accum(): not supported in GPU modes!");
+    } else {
+        Assert(m_track_variance);
+
+        const ScalarFloat *ptr = m_var_data.data();
+        double accum = 0.0;
+        size_t count = 0;
+
+        for (size_t i = 0, n = hprod(m_size); i < n; ++i) {
+            accum += (double) ptr[3 * i];
+            count += (size_t) ptr[3 * i + 2];
+        }
+
+        return { accum, count };
+    }
 }
 
 MTS_VARIANT void ImageBlock<Float, Spectrum>::put(const ImageBlock *block) {
@@ -66,21 +541,180 @@ MTS_VARIANT void ImageBlock<Float, Spectrum>::put(const ImageBlock *block) {
             ScalarVector2i(0), source_offset - target_offset,
             source_size, channel_count()
         );
+    } else if (unlikely(m_packed)) {
+        if (unlikely(block->has_half_channels()))
+            Throw("ImageBlock::put(): both blocks use half-precision channel "
+                  "storage -- the source must be a full-precision block!");
+
+        /* Merges into the packed representation are serialized with a lock
+           instead of per-channel atomics; they occur only once per finished
+           block, so contention is negligible compared to sample splatting */
+        std::lock_guard<tbb::spin_mutex> lock(m_mutex);
+        accumulate_2d_packed(
+            block->data().data(), source_size,
+            m_packed.get(), target_size,
+            ScalarVector2i(0), source_offset - target_offset,
+            source_size, channel_count(),
+            m_half_channels, m_channel_offset, m_pixel_stride
+        );
+    } else if (unlikely(m_planar)) {
+        if (unlikely(block->has_half_channels()))
+            Throw("ImageBlock::put(): cannot merge a half-precision source "
+                  "block into a planar target!");
+
+        /* Like packed merges, plane-wise merges are serialized with a lock
+           instead of per-channel atomics; they occur only once per finished
+           block, so contention is negligible compared to sample splatting */
+        std::lock_guard<tbb::spin_mutex> lock(m_mutex);
+        accumulate_2d_planar(
+            block->data().data(), source_size,
+            data().data(), target_size,
+            ScalarVector2i(0), source_offset - target_offset,
+            source_size, channel_count(),
+            block->planar()
+        );
     } else {
-        accumulate_2d(
+        if (unlikely(block->planar()))
+            Throw("ImageBlock::put(): cannot merge a planar source block "
+                  "into an interleaved target!");
+
+        accumulate_2d_atomic(
             block->data().data(), source_size,
             data().data(), target_size,
             ScalarVector2i(0), source_offset - target_offset,
-            source_size, channel_count()
+            source_size, channel_count(),
+            2 * (int) block->border_size()
         );
     }
 }
 
+/* In atomic mode, the block is shared between all worker threads and each
+   filter tap must be deposited with an atomic addition (see \ref
+   set_atomic()). The default path relies on exclusive block ownership and
+   uses plain scatter-adds. */
+MTS_VARIANT void ImageBlock<Float, Spectrum>::deposit(const Float &value,
+                                                      const UInt32 &offset,
+                                                      const Mask &enabled) {
+    if constexpr (is_cuda_array_v<Float> || is_diff_array_v<Float>) {
+        scatter_add(m_data, value, offset, enabled);
+    } else if (likely(!m_atomic)) {
+        scatter_add(m_data, value, offset, enabled);
+    } else {
+        auto *ptr = (AtomicFloat<ScalarFloat> *) m_data.data();
+        if constexpr (is_array_v<Float>) {
+            for (size_t l = 0; l < Float::Size; ++l) {
+                if (enabled.coeff(l))
+                    ptr[offset.coeff(l)] += value.coeff(l);
+            }
+        } else {
+            if (enabled)
+                ptr[offset] += value;
+        }
+    }
+}
+
+MTS_VARIANT template <uint32_t N> typename ImageBlock<Float, Spectrum>::Mask
+ImageBlock<Float, Spectrum>::put_filtered(const Point2f &pos, const Float *value,
+                                          Mask active) {
+    ScalarFloat filter_radius = m_filter->radius();
+    ScalarVector2i size = m_size + 2 * m_border_size;
+
+    /* Distance between the channels of one pixel: adjacent in the default
+       interleaved layout, one full plane apart in planar mode */
+    uint32_t px_stride = m_channel_count, ch_stride = 1;
+    if (unlikely(m_planar)) {
+        px_stride = 1;
+        ch_stride = (uint32_t) hprod(size);
+    }
+
+    // Determine the affected range of pixels
+    Point2u lo = Point2u(max(ceil2int <Point2i>(pos - filter_radius), 0)),
+            hi = Point2u(min(floor2int<Point2i>(pos + filter_radius), size - 1));
+
+    uint32_t n;
+    if constexpr (N != 0)
+        n = N;
+    else
+        n = ceil2int<uint32_t>((filter_radius - 2.f * math::RayEpsilon<ScalarFloat>) * 2.f);
+
+    /* Compute the separable row/column filter weights once per sample; the
+       discretized table turns each weight into a single gather and is
+       available in every variant (including on the GPU). When the tap count
+       is a compile-time constant, the weights live on the stack and all of
+       the loops below are fully unrolled. */
+    Float local_x[N == 0 ? 1 : N], local_y[N == 0 ? 1 : N];
+    Float *weights_x, *weights_y;
+    if constexpr (N != 0) {
+        weights_x = local_x;
+        weights_y = local_y;
+    } else {
+        weights_x = m_weights_x;
+        weights_y = m_weights_y;
+    }
+
+    Point2f base = lo - pos;
+    for (uint32_t i = 0; i < n; ++i) {
+        Point2f p = base + i;
+        weights_x[i] = m_filter->eval_discretized(p.x(), active);
+        weights_y[i] = m_filter->eval_discretized(p.y(), active);
+    }
+
+    if (unlikely(m_normalize)) {
+        Float wx(0), wy(0);
+        for (uint32_t i = 0; i < n; ++i) {
+            wx += weights_x[i];
+            wy += weights_y[i];
+        }
+
+        Float factor = rcp(wx * wy);
+        for (uint32_t i = 0; i < n; ++i)
+            weights_x[i] *= factor;
+    }
+
+    if constexpr (N != 0) {
+        ENOKI_UNROLL for (uint32_t yr = 0; yr < N; ++yr) {
+            UInt32 y = lo.y() + yr;
+            Mask enabled = active && y <= hi.y();
+
+            ENOKI_UNROLL for (uint32_t xr = 0; xr < N; ++xr) {
+                UInt32 x       = lo.x() + xr,
+                       offset  = px_stride * (y * size.x() + x);
+                Float weight = weights_y[yr] * weights_x[xr];
+
+                enabled &= x <= hi.x();
+                ENOKI_NOUNROLL for (uint32_t k = 0; k < m_channel_count; ++k)
+                    deposit(value[k] * weight, offset + k * ch_stride, enabled);
+            }
+        }
+    } else {
+        ENOKI_NOUNROLL for (uint32_t yr = 0; yr < n; ++yr) {
+            UInt32 y = lo.y() + yr;
+            Mask enabled = active && y <= hi.y();
+
+            ENOKI_NOUNROLL for (uint32_t xr = 0; xr < n; ++xr) {
+                UInt32 x       = lo.x() + xr,
+                       offset  = px_stride * (y * size.x() + x);
+                Float weight = weights_y[yr] * weights_x[xr];
+
+                enabled &= x <= hi.x();
+                ENOKI_NOUNROLL for (uint32_t k = 0; k < m_channel_count; ++k)
+                    deposit(value[k] * weight, offset + k * ch_stride, enabled);
+            }
+        }
+    }
+
+    return active;
+}
+
 MTS_VARIANT typename ImageBlock<Float, Spectrum>::Mask
 ImageBlock<Float, Spectrum>::put(const Point2f &pos_, const Float *value, Mask active) {
     ScopedPhase sp(ProfilerPhase::ImageBlockPut);
     Assert(m_filter != nullptr);
 
+    if (unlikely(m_packed))
+        Throw("ImageBlock::put(): per-sample accumulation is unsupported in "
+              "half-precision storage mode! (see set_half_channels())");
+
     // Check if all sample values are valid
     if (likely(m_warn_negative || m_warn_invalid)) {
         Mask is_valid = true;
@@ -95,7 +729,12 @@ ImageBlock<Float, Spectrum>::put(const Point2f &pos_, const Float *value, Mask a
                 is_valid &= enoki::isfinite(value[k]);
         }
 
-        if (unlikely(any(active && !is_valid))) {
+        if constexpr (is_cuda_array_v<Float>) {
+            /* Inspecting the mask contents would force a device->host
+               synchronization on every put; silently discard invalid
+               samples on the device instead */
+            active &= is_valid;
+        } else if (unlikely(any(active && !is_valid))) {
             std::ostringstream oss;
             oss << "Invalid sample value: [";
             for (uint32_t i = 0; i < m_channel_count; ++i) {
@@ -108,64 +747,76 @@ ImageBlock<Float, Spectrum>::put(const Point2f &pos_, const Float *value, Mask a
         }
     }
 
-    ScalarFloat filter_radius = m_filter->radius();
-    ScalarVector2i size = m_size + 2 * m_border_size;
-
-    // Convert to pixel coordinates within the image block
-    Point2f pos = pos_ - (m_offset - m_border_size + .5f);
-
-    if (filter_radius > 1) {
-        // Determine the affected range of pixels
-        Point2u lo = Point2u(max(ceil2int <Point2i>(pos - filter_radius), 0)),
-                hi = Point2u(min(floor2int<Point2i>(pos + filter_radius), size - 1));
+    /* Outlier-aware accumulation: soft-clamp samples whose luminance
+       exceeds a robust threshold derived from the streaming per-pixel
+       statistics, and defer the excess into \ref m_outlier_data (re-merged
+       with density-based reweighting by \ref merge_outliers()) */
+    const Float *splat_value = value;
+    if (unlikely(m_outlier_rejection)) {
+        Point2i pix = floor2int<Point2i>(pos_ - m_offset);
+        Mask enabled = active && all(pix >= 0 && pix < Point2i(m_size));
+        UInt32 index = UInt32(pix.y()) * (uint32_t) m_size.x() + UInt32(pix.x());
+
+        Float sum    = gather<Float>(m_var_data, 3u * index,      enabled),
+              sum_sq = gather<Float>(m_var_data, 3u * index + 1u, enabled),
+              n      = gather<Float>(m_var_data, 3u * index + 2u, enabled);
+
+        /* A handful of samples must accumulate before the statistics are
+           trusted; the threshold is intentionally loose so that only
+           extreme events (isolated fireflies) are deferred */
+        Float mean     = sum / n,
+              variance = max(sum_sq - sum * mean, 0.f) / (n - 1.f),
+              thresh   = mean + 8.f * sqrt(variance),
+              lum      = value[1];
+        Mask outlier = enabled && n >= 4.f && lum > thresh;
+
+        if (unlikely(any(outlier))) {
+            Float scale = select(outlier, thresh / lum, 1.f);
+            uint32_t n_color = std::min(m_channel_count, 3u);
+            for (uint32_t k = 0; k < n_color; ++k)
+                scatter_add(m_outlier_data, value[k] * (1.f - scale),
+                            4u * index + k, outlier);
+            scatter_add(m_outlier_data, Float(1.f), 4u * index + 3u, outlier);
 
-        uint32_t n = ceil2int<uint32_t>((m_filter->radius() - 2.f * math::RayEpsilon<ScalarFloat>) * 2.f);
-
-        Point2f base = lo - pos;
-        for (uint32_t i = 0; i < n; ++i) {
-            Point2f p = base + i;
-            if constexpr (!is_cuda_array_v<Float>) {
-                m_weights_x[i] = m_filter->eval_discretized(p.x(), active);
-                m_weights_y[i] = m_filter->eval_discretized(p.y(), active);
-            } else {
-                m_weights_x[i] = m_filter->eval(p.x(), active);
-                m_weights_y[i] = m_filter->eval(p.y(), active);
-            }
-        }
-
-        if (unlikely(m_normalize)) {
-            Float wx(0), wy(0);
-            for (uint32_t i = 0; i <= n; ++i) {
-                wx += m_weights_x[i];
-                wy += m_weights_y[i];
-            }
-
-            Float factor = rcp(wx * wy);
-            for (uint32_t i = 0; i <= n; ++i)
-                m_weights_x[i] *= factor;
+            for (uint32_t k = 0; k < m_channel_count; ++k)
+                m_outlier_scratch[k] = k < n_color ? value[k] * scale : value[k];
+            splat_value = m_outlier_scratch.get();
         }
+    }
 
-        ENOKI_NOUNROLL for (uint32_t yr = 0; yr < n; ++yr) {
-            UInt32 y = lo.y() + yr;
-            Mask enabled = active && y <= hi.y();
-
-            ENOKI_NOUNROLL for (uint32_t xr = 0; xr < n; ++xr) {
-                UInt32 x       = lo.x() + xr,
-                       offset  = m_channel_count * (y * size.x() + x);
-                Float weight = m_weights_y[yr] * m_weights_x[xr];
+    // Convert to pixel coordinates within the image block
+    Point2f pos = pos_ - (m_offset - m_border_size + .5f);
 
-                enabled &= x <= hi.x();
-                ENOKI_NOUNROLL for (uint32_t k = 0; k < m_channel_count; ++k)
-                    scatter_add(m_data, value[k] * weight, offset + k, enabled);
-            }
+    if (m_filter->radius() > 1) {
+        /* Dispatch to a splatting kernel whose footprint loops are unrolled
+           at compile time for the common 2x2 (tent-like) and 4x4 (gaussian)
+           filter sizes */
+        switch (m_filter_taps) {
+            case 2:  put_filtered<2>(pos, splat_value, active); break;
+            case 4:  put_filtered<4>(pos, splat_value, active); break;
+            default: put_filtered<0>(pos, splat_value, active); break;
         }
     } else {
+        ScalarVector2i size = m_size + 2 * m_border_size;
+        uint32_t px_stride = m_planar ? 1u : m_channel_count,
+                 ch_stride = m_planar ? (uint32_t) hprod(size) : 1u;
         Point2u lo = ceil2int<Point2i>(pos - .5f);
-        UInt32 offset = m_channel_count * (lo.y() * size.x() + lo.x());
+        UInt32 offset = px_stride * (lo.y() * size.x() + lo.x());
 
         Mask enabled = active && all(lo >= 0u && lo < size);
         ENOKI_NOUNROLL for (uint32_t k = 0; k < m_channel_count; ++k)
-            scatter_add(m_data, value[k], offset + k, enabled);
+            deposit(splat_value[k], offset + k * ch_stride, enabled);
+    }
+
+    if (unlikely(m_track_variance)) {
+        // Nearest-pixel luminance statistics, unaffected by the filter
+        Point2i pix = floor2int<Point2i>(pos_ - m_offset);
+        Mask enabled = active && all(pix >= 0 && pix < Point2i(m_size));
+        UInt32 index = 3u * (UInt32(pix.y()) * (uint32_t) m_size.x() + UInt32(pix.x()));
+        Float lum = value[1];
+        scatter_add(m_var_data, lum, index, enabled);
+        scatter_add(m_var_data, lum * lum, index + 1u, enabled);
+        scatter_add(m_var_data, Float(1.f), index + 2u, enabled);
     }
 
     return active;
@@ -1,24 +1,45 @@
 #include <thread>
 #include <mutex>
+#include <atomic>
+#include <chrono>
+#include <shared_mutex>
 
 #include <enoki/morton.h>
+#include <mitsuba/core/bitmap.h>
+#include <mitsuba/core/filesystem.h>
+#include <mitsuba/core/fstream.h>
 #include <mitsuba/core/profiler.h>
 #include <mitsuba/core/progress.h>
 #include <mitsuba/core/spectrum.h>
+#include <mitsuba/core/thread.h>
 #include <mitsuba/core/timer.h>
 #include <mitsuba/core/util.h>
 #include <mitsuba/core/warp.h>
 #include <mitsuba/render/film.h>
 #include <mitsuba/render/integrator.h>
 #include <mitsuba/render/sampler.h>
+#include <mitsuba/render/scene.h>
 #include <mitsuba/render/sensor.h>
 #include <mitsuba/render/spiral.h>
 #include <tbb/blocked_range.h>
 #include <tbb/parallel_for.h>
 #include <mutex>
 
+#if defined(MTS_ENABLE_DISTRIBUTED)
+#  include "integrator_distributed.inl"
+#endif
+
 NAMESPACE_BEGIN(mitsuba)
 
+/* All parallel phases below run inside the shared task arena (see \ref
+   global_task_arena()), so that rendering composes with whatever else the
+   process is doing in parallel (e.g. loading the next scene of a batch)
+   instead of oversubscribing the machine with competing thread pools. */
+template <typename Range, typename Func>
+static void parallel_for_arena(const Range &range, const Func &func) {
+    global_task_arena().execute([&] { tbb::parallel_for(range, func); });
+}
+
 // -----------------------------------------------------------------------------
 
 MTS_VARIANT SamplingIntegrator<Float, Spectrum>::SamplingIntegrator(const Properties &props)
@@ -31,8 +52,47 @@ MTS_VARIANT SamplingIntegrator<Float, Spectrum>::SamplingIntegrator(const Proper
             m_block_size);
     }
 
+    /* Probe the scene with a few camera rays per block before rendering
+       starts and adapt the block granularity to the image contents (see
+       \ref Spiral::set_density()) */
+    m_adaptive_block_size = props.bool_("adaptive_block_size", true);
+
+    /* Trace each block as one coherent ray stream and shade the resulting
+       hits sorted by BSDF (see \ref render_block_sorted()) */
+    m_sort_block = props.bool_("sort_block", false);
+
     m_samples_per_pass = (uint32_t) props.size_("samples_per_pass", (size_t) -1);
     m_timeout = props.float_("timeout", -1.f);
+
+    /* GPU only: number of sample passes batched into each set of kernel
+       launches (see the declaration of \ref m_fuse_passes) */
+    m_fuse_passes = (uint32_t) props.size_("fuse_passes", 1);
+    if (m_fuse_passes == 0)
+        Throw("\"fuse_passes\" must be set to a value >= 1");
+
+    /// Relative per-pixel error tolerated before a block stops being refined
+    m_error_threshold = props.float_("error_threshold", 0.f);
+    if (m_error_threshold < 0.f)
+        Throw("\"error_threshold\" must be set to a value >= 0");
+    m_max_refinement_passes = (uint32_t) props.size_("max_refinement_passes", 16);
+
+    /* Defer extreme "firefly" samples and re-merge them with density-based
+       reweighting (see \ref ImageBlock::set_outlier_rejection()) */
+    m_outlier_rejection = props.bool_("outlier_rejection", false);
+
+    /* Reuse the previous frame of an animation via temporal reprojection
+       (see \ref temporal_reproject()) */
+    m_temporal_reuse = props.bool_("temporal_reuse", false);
+
+    /* Periodic film snapshots for crash/preemption recovery. Whole passes
+       are recorded, hence checkpointing is only useful in combination with
+       "samples_per_pass". */
+    m_checkpoint_path = props.string("checkpoint", "");
+    m_checkpoint_interval = props.float_("checkpoint_interval", 60.f);
+    if (m_checkpoint_interval <= 0.f)
+        Throw("\"checkpoint_interval\" must be set to a value > 0");
+    m_resume = props.bool_("resume", false);
+    m_seed_offset = 0;
 }
 
 MTS_VARIANT SamplingIntegrator<Float, Spectrum>::~SamplingIntegrator() { }
@@ -49,6 +109,13 @@ MTS_VARIANT bool SamplingIntegrator<Float, Spectrum>::render(Scene *scene, Senso
     ScopedPhase sp(ProfilerPhase::Render);
     m_stop = false;
 
+    // The luminance statistics of a previous job do not carry over
+    m_lum_accum.store(0.0, std::memory_order_relaxed);
+    m_lum_count.store(0, std::memory_order_relaxed);
+
+    // Scope the end-of-render statistics report to this render job
+    Statistics::clear();
+
     ref<Film> film = sensor->film();
     ScalarVector2i film_size = film->crop_size();
 
@@ -81,51 +148,436 @@ MTS_VARIANT bool SamplingIntegrator<Float, Spectrum>::render(Scene *scene, Senso
         if (m_timeout > 0.f)
             Log(Info, "Timeout specified: %.2f seconds.", m_timeout);
 
-        Spiral spiral(film, m_block_size, n_passes);
+        // Restore a previous snapshot of this rendering job, if requested
+        size_t passes_done = 0;
+        if (m_resume && !m_checkpoint_path.empty()) {
+            if (fs::exists(m_checkpoint_path)) {
+                passes_done = load_checkpoint(film, (uint32_t) channels.size(),
+                                              m_seed_offset);
+                passes_done = std::min(passes_done, n_passes);
+                Log(Info, "Resumed checkpoint \"%s\": %i of %i pass%s already "
+                    "completed.", m_checkpoint_path.string(), passes_done,
+                    n_passes, n_passes == 1 ? "" : "es");
+            } else {
+                Log(Warn, "Checkpoint file \"%s\" does not exist -- starting "
+                    "from scratch.", m_checkpoint_path.string());
+            }
+        }
+        size_t remaining_passes = n_passes - passes_done;
+
+        Spiral spiral(film, m_block_size, remaining_passes);
+        spiral.set_worker_count((uint32_t) n_threads);
 
         ThreadEnvironment env;
+
+        if (m_adaptive_block_size && remaining_passes > 0) {
+            /* Cheap visibility prepass: probe every block of the scheduling
+               grid with a handful of camera rays and record the fraction
+               that hits geometry. The scheduler merges empty (e.g. sky)
+               blocks into larger work items and splits dense ones, instead
+               of using a fixed granularity for both. */
+            ScalarVector2i grid(
+                (film_size.x() + (int) m_block_size - 1) / (int) m_block_size,
+                (film_size.y() + (int) m_block_size - 1) / (int) m_block_size);
+            std::vector<float> density(hprod(grid), 0.f);
+
+            parallel_for_arena(
+                tbb::blocked_range<size_t>(0, density.size(), 16),
+                [&](const tbb::blocked_range<size_t> &range) {
+                    ScopedSetThreadEnvironment set_env(env);
+                    for (size_t i = range.begin(); i != range.end(); ++i) {
+                        ScalarPoint2i cell((int) (i % grid.x()),
+                                           (int) (i / grid.x()));
+                        ScalarVector2i rel = cell * (int) m_block_size;
+                        ScalarPoint2f base(rel);
+                        ScalarVector2f extent(
+                            min(ScalarVector2i((int) m_block_size),
+                                film_size - rel));
+
+                        // Four inset corners and the center of the block
+                        const ScalarPoint2f probes[5] = {
+                            base + extent * ScalarVector2f(.1f, .1f),
+                            base + extent * ScalarVector2f(.9f, .1f),
+                            base + extent * ScalarVector2f(.1f, .9f),
+                            base + extent * ScalarVector2f(.9f, .9f),
+                            base + extent * ScalarVector2f(.5f, .5f)
+                        };
+
+                        uint32_t hits = 0;
+                        for (const ScalarPoint2f &p : probes) {
+                            ScalarPoint2f sp = p / ScalarVector2f(film_size);
+                            auto [ray, ray_weight] = sensor->sample_ray(
+                                sensor->shutter_open(), .5f,
+                                Point2f(sp.x(), sp.y()), Point2f(.5f));
+                            if (any(scene->ray_test(ray)))
+                                hits++;
+                        }
+                        density[i] = hits / 5.f;
+                    }
+                });
+
+            spiral.set_density(density.data());
+        }
+        /* Temporal reuse: seed the film with reprojected pixels from the
+           previous frame. Blocks whose pixels were all successfully
+           reprojected are skipped by the sampling loops below. */
+        std::vector<uint8_t> temporal_covered;
+        if (m_temporal_reuse && remaining_passes > 0 &&
+            m_temporal_cache.channel_count == channels.size())
+            temporal_covered = temporal_reproject(scene, sensor, film);
+
+        auto temporal_skip = [&](const ScalarPoint2i &offset_,
+                                 const ScalarVector2i &size_) {
+            if (temporal_covered.empty())
+                return false;
+            ScalarPoint2i base = offset_ - film->crop_offset();
+            for (int y = 0; y < size_.y(); ++y) {
+                const uint8_t *row = temporal_covered.data() +
+                    (size_t) (base.y() + y) * film_size.x() + base.x();
+                for (int x = 0; x < size_.x(); ++x) {
+                    if (!row[x])
+                        return false;
+                }
+            }
+            return true;
+        };
+
         ref<ProgressReporter> progress = new ProgressReporter("Rendering");
         std::mutex mutex;
 
-        // Total number of blocks to be handled, including multiple passes.
-        size_t total_blocks = spiral.block_count() * n_passes,
-               blocks_done = 0;
+        /* The scheduler may split expensive blocks into sub-blocks, hence
+           progress is tracked in pixels rather than blocks. */
+        size_t total_blocks = spiral.block_count() * remaining_passes;
+        double pixels_total = std::max(1.0, (double) hprod(film_size) * remaining_passes);
+        std::atomic<size_t> pixels_done(0);
+
+        bool adaptive = m_error_threshold > 0.f;
+
+        /* Progressive preview (see set_preview_callback()): developed tiles
+           are streamed to the registered callback as blocks complete */
+        bool preview = (bool) m_preview_callback;
+        if (preview && has_aovs) {
+            Log(Warn, "Progressive preview is not supported for integrators "
+                      "with AOVs -- ignoring the registered callback.");
+            preview = false;
+        }
+        if (preview) {
+            /* Tiled films stream their contents to disk and cannot be
+               re-read for preview purposes */
+            try {
+                film->bitmap(true);
+            } catch (const std::exception &) {
+                Log(Warn, "Progressive preview requires a film with in-memory "
+                          "storage -- ignoring the registered callback.");
+                preview = false;
+            }
+        }
+
+        /* Extract a rectangular film region, develop it into an RGBA tile
+           and hand it to the preview callback. Callers must hold
+           \c film_mutex in shared mode. */
+        auto deliver_tile = [&](const ScalarPoint2i &offset,
+                                const ScalarVector2i &tile_size, size_t pass) {
+            ref<Bitmap> raw = film->bitmap(true);
+
+            ref<Bitmap> tile = new Bitmap(
+                Bitmap::PixelFormat::XYZAW, struct_type_v<ScalarFloat>,
+                ScalarVector2u(tile_size), raw->channel_count());
+
+            size_t bpp = raw->bytes_per_pixel();
+            ScalarPoint2i rel = offset - film->crop_offset();
+            const uint8_t *src = raw->uint8_data() +
+                (rel.x() + rel.y() * (size_t) raw->width()) * bpp;
+            uint8_t *dst = tile->uint8_data();
+            for (int y = 0; y < tile_size.y(); ++y) {
+                memcpy(dst, src, tile_size.x() * bpp);
+                src += raw->width() * bpp;
+                dst += tile_size.x() * bpp;
+            }
+
+            ref<Bitmap> developed = tile->convert(
+                Bitmap::PixelFormat::RGBA, struct_type_v<ScalarFloat>, false);
+            m_preview_callback(offset, developed, pass);
+        };
+
+        /* Blocks whose relative pixel error still exceeds the threshold
+           after the regular passes; re-enqueued for further refinement */
+        std::vector<std::pair<ScalarPoint2i, ScalarVector2i>> refine;
+
+        /* Workers hold this in shared mode while merging blocks into the
+           film; the checkpoint thread takes it exclusively to copy a
+           consistent snapshot of the film contents */
+        std::shared_mutex film_mutex;
+        std::atomic<bool> render_done(false);
+        std::thread checkpoint_thread;
+
+        if (!m_checkpoint_path.empty()) {
+            /* Seed offset that a follow-up run must use so that it does not
+               reuse any random number sequence consumed by this run */
+            size_t next_seed_offset = m_seed_offset +
+                4 * total_blocks * (size_t) (m_max_refinement_passes + 2);
+
+            auto snapshot_loop = [&, next_seed_offset]() {
+                ScopedSetThreadEnvironment set_env(env);
+                Timer last_snapshot;
+
+                while (!render_done.load(std::memory_order_acquire)) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+                    if (render_done.load(std::memory_order_acquire) ||
+                        last_snapshot.value() < m_checkpoint_interval * 1000.f)
+                        continue;
+                    last_snapshot.reset();
+
+                    try {
+                        std::vector<ScalarFloat> data;
+                        ScalarVector2i size;
+                        uint32_t channel_count;
+                        size_t snapshot_passes;
+
+                        /* Critical section: copy the film contents */ {
+                            std::unique_lock<std::shared_mutex> guard(film_mutex);
+                            ref<Bitmap> raw = film->bitmap(true);
+                            const ScalarFloat *ptr = (const ScalarFloat *) raw->data();
+                            size = ScalarVector2i(raw->size());
+                            channel_count = (uint32_t) raw->channel_count();
+                            data.assign(ptr, ptr + hprod(size) * channel_count);
+
+                            std::lock_guard<std::mutex> guard2(mutex);
+                            snapshot_passes = passes_done +
+                                pixels_done.load(std::memory_order_relaxed) /
+                                    (size_t) hprod(film_size);
+                        }
+
+                        // Serialize to disk outside of the critical section
+                        write_checkpoint(size, channel_count, data,
+                                         snapshot_passes, next_seed_offset);
+                    } catch (const std::exception &e) {
+                        Log(Warn, "Checkpointing failed: %s", e.what());
+                        break;
+                    }
+                }
+            };
+
+            checkpoint_thread = std::thread([snapshot_loop]() {
+                Thread::register_external_thread("ckpt");
+                snapshot_loop();
+                Thread::unregister_external_thread();
+            });
+        }
 
         m_render_timer.reset();
-        tbb::parallel_for(
-            tbb::blocked_range<size_t>(0, total_blocks, 1),
+
+        if (preview && remaining_passes > 0) {
+            /* Preview pass: cover the entire frame once at one sample per
+               pixel using enlarged blocks in scanline order, so that a first
+               complete image reaches the callback as quickly as possible */
+            uint32_t preview_block_size = std::min(4 * m_block_size, 256u);
+
+            std::vector<std::pair<ScalarPoint2i, ScalarVector2i>> preview_blocks;
+            ScalarPoint2i crop_offset = film->crop_offset();
+            for (int y = 0; y < film_size.y(); y += preview_block_size)
+                for (int x = 0; x < film_size.x(); x += preview_block_size)
+                    preview_blocks.emplace_back(
+                        crop_offset + ScalarVector2i(x, y),
+                        min(ScalarVector2i((int) preview_block_size),
+                            film_size - ScalarVector2i(x, y)));
+
+            parallel_for_arena(
+                tbb::blocked_range<size_t>(0, preview_blocks.size(), 1),
+                [&](const tbb::blocked_range<size_t> &range) {
+                    ScopedSetThreadEnvironment set_env(env);
+                    ref<Sampler> sampler = sensor->sampler()->clone();
+                    ref<ImageBlock> block = new ImageBlock(preview_block_size,
+                                                           channels.size(),
+                                                           film->reconstruction_filter(),
+                                                           !has_aovs);
+                    scoped_flush_denormals flush_denormals(true);
+
+                    ScratchArena &arena = m_scratch;
+                    ScratchArena::Rewind arena_guard(arena);
+                    Float *aovs = arena.alloc<Float>(channels.size());
+
+                    for (auto i = range.begin(); i != range.end() && !should_stop(); ++i) {
+                        auto [offset, size] = preview_blocks[i];
+                        if (temporal_skip(offset, size))
+                            continue;
+                        block->set_size(size);
+                        block->set_offset(offset);
+
+                        /* Use a seed band that neither the regular nor the
+                           adaptive passes can reach */
+                        sampler->seed(m_seed_offset +
+                                      4 * total_blocks * (m_max_refinement_passes + 1) + i);
+
+                        render_block(scene, sensor, sampler, block, aovs, 1);
+
+                        /* see below */ {
+                            std::shared_lock<std::shared_mutex> put_guard(film_mutex);
+                            film->put(block);
+                            deliver_tile(offset, size, 0);
+                        }
+
+                        update_luminance_estimate(block);
+                    }
+                }
+            );
+        }
+
+        if (remaining_passes > 0) parallel_for_arena(
+            tbb::blocked_range<size_t>(0, n_threads, 1),
             [&](const tbb::blocked_range<size_t> &range) {
+                /* The range index doubles as a stable worker identity for
+                   the scheduler's pass-to-pass block affinity */
+                uint32_t worker_id = (uint32_t) range.begin();
                 ScopedSetThreadEnvironment set_env(env);
                 ref<Sampler> sampler = sensor->sampler()->clone();
                 ref<ImageBlock> block = new ImageBlock(m_block_size, channels.size(),
                                                        film->reconstruction_filter(),
                                                        !has_aovs);
+                block->set_track_variance(adaptive || m_outlier_rejection);
+                block->set_outlier_rejection(m_outlier_rejection);
                 scoped_flush_denormals flush_denormals(true);
-                std::unique_ptr<Float[]> aovs(new Float[channels.size()]);
 
-                // For each block
-                for (auto i = range.begin(); i != range.end() && !should_stop(); ++i) {
-                    auto [offset, size] = spiral.next_block();
-                    Assert(hprod(size) != 0);
+                ScratchArena &arena = m_scratch;
+                ScratchArena::Rewind arena_guard(arena);
+                Float *aovs = arena.alloc<Float>(channels.size());
+
+                /* Pull blocks from the scheduler until the work runs out.
+                   The number of items per pass may vary, since expensive
+                   blocks are split into sub-blocks for later passes. */
+                while (!should_stop()) {
+                    size_t block_id = 0;
+                    auto [offset, size] = spiral.next_block(worker_id, &block_id);
+                    if (hprod(size) == 0)
+                        break;
+
+                    if (temporal_skip(offset, size)) {
+                        size_t done = pixels_done.fetch_add(
+                            (size_t) hprod(size), std::memory_order_relaxed) + hprod(size);
+                        progress->update((float) (done / pixels_total));
+                        continue;
+                    }
+
                     block->set_size(size);
                     block->set_offset(offset);
 
                     // Ensure that the sample generation is fully deterministic
-                    sampler->seed(i);
+                    sampler->seed(m_seed_offset + block_id);
 
+                    Timer timer;
                     render_block(scene, sensor, sampler, block,
-                                 aovs.get(), samples_per_pass);
+                                 aovs, samples_per_pass);
+                    spiral.record_cost(offset, (float) timer.value());
 
-                    film->put(block);
+                    if (m_outlier_rejection)
+                        block->merge_outliers();
+
+                    /* Checkpoint snapshots must not observe partially
+                       merged blocks */ {
+                        std::shared_lock<std::shared_mutex> put_guard(film_mutex);
+                        film->put(block);
+                        if (preview)
+                            deliver_tile(offset, size,
+                                         1 + block_id / std::max(spiral.block_count(),
+                                                                 (size_t) 1));
+                    }
 
-                    /* Critical section: update progress bar */ {
+                    update_luminance_estimate(block);
+
+                    bool needs_refinement =
+                        adaptive && block->error_estimate() > m_error_threshold;
+
+                    /* Progress updates are lock-free: the counter is a
+                       relaxed atomic, and the reporter merely stores the
+                       value (formatting happens on its helper thread) */
+                    size_t done = pixels_done.fetch_add(
+                        (size_t) hprod(size), std::memory_order_relaxed) + hprod(size);
+                    progress->update((float) (done / pixels_total));
+
+                    if (needs_refinement) {
                         std::lock_guard<std::mutex> lock(mutex);
-                        blocks_done++;
-                        progress->update(blocks_done / (ScalarFloat) total_blocks);
+                        refine.emplace_back(offset, size);
                     }
                 }
             }
         );
+
+        /* Adaptive phase: spend additional passes only on blocks whose
+           per-pixel variance remains too high. The film normalizes by the
+           accumulated sample weight, so extra samples blend in seamlessly. */
+        for (uint32_t pass = 0; adaptive && !refine.empty() &&
+                                pass < m_max_refinement_passes && !should_stop(); ++pass) {
+            std::vector<std::pair<ScalarPoint2i, ScalarVector2i>> current(std::move(refine));
+            refine.clear();
+
+            Log(Info, "Adaptive pass %i: refining %i high-variance block%s",
+                pass + 1, current.size(), current.size() == 1 ? "" : "s");
+
+            parallel_for_arena(
+                tbb::blocked_range<size_t>(0, current.size(), 1),
+                [&](const tbb::blocked_range<size_t> &range) {
+                    ScopedSetThreadEnvironment set_env(env);
+                    ref<Sampler> sampler = sensor->sampler()->clone();
+                    ref<ImageBlock> block = new ImageBlock(m_block_size, channels.size(),
+                                                           film->reconstruction_filter(),
+                                                           !has_aovs);
+                    block->set_track_variance(true);
+                    block->set_outlier_rejection(m_outlier_rejection);
+                    scoped_flush_denormals flush_denormals(true);
+
+                    ScratchArena &arena = m_scratch;
+                    ScratchArena::Rewind arena_guard(arena);
+                    Float *aovs = arena.alloc<Float>(channels.size());
+
+                    for (auto i = range.begin(); i != range.end() && !should_stop(); ++i) {
+                        auto [offset, size] = current[i];
+                        block->set_size(size);
+                        block->set_offset(offset);
+
+                        /* Seeds must not collide with those of earlier
+                           passes; the scheduler hands out at most four
+                           sub-block ids per block and pass */
+                        sampler->seed(m_seed_offset + 4 * total_blocks * (pass + 1) + i);
+
+                        render_block(scene, sensor, sampler, block,
+                                     aovs, samples_per_pass);
+
+                        if (m_outlier_rejection)
+                            block->merge_outliers();
+
+                        /* see above */ {
+                            std::shared_lock<std::shared_mutex> put_guard(film_mutex);
+                            film->put(block);
+                            if (preview)
+                                deliver_tile(offset, size,
+                                             remaining_passes + pass + 1);
+                        }
+
+                        update_luminance_estimate(block);
+
+                        if (block->error_estimate() > m_error_threshold) {
+                            std::lock_guard<std::mutex> lock(mutex);
+                            refine.emplace_back(offset, size);
+                        }
+                    }
+                }
+            );
+        }
+
+        if (checkpoint_thread.joinable()) {
+            render_done.store(true, std::memory_order_release);
+            checkpoint_thread.join();
+        }
+
+        /* Record this frame's film contents and first-hit data so that the
+           next frame can reproject them; interrupted frames would poison
+           the cache and invalidate it instead */
+        if (m_temporal_reuse) {
+            if (!should_stop())
+                temporal_capture(scene, sensor, film);
+            else
+                m_temporal_cache.valid = false;
+        }
     } else {
         ref<Sampler> sampler = sensor->sampler();
 
@@ -146,20 +598,445 @@ MTS_VARIANT bool SamplingIntegrator<Float, Spectrum>::render(Scene *scene, Senso
                                 Float(idx / uint32_t(film_size[0])));
         std::vector<Float> aovs(channels.size());
 
-        for (size_t i = 0; i < n_passes; i++)
+        size_t n_flushes = 0, eval_time = 0;
+
+        for (size_t i = 0; i < n_passes; i++) {
             render_sample(scene, sensor, sampler, block, aovs.data(),
                           pos, diff_scale_factor);
 
+            /* Launch the queued kernels without blocking, batching
+               'fuse_passes' passes into each flush: enoki then fuses the
+               independent traces into one set of wider launches, which
+               shrinks the inter-launch gaps that dominate small frames.
+               The image block stays resident on the device across passes;
+               its contents are only read back once the film is developed. */
+            if ((i + 1) % (size_t) m_fuse_passes == 0 || i + 1 == n_passes) {
+                Timer flush_timer;
+                cuda_eval();
+                eval_time += flush_timer.value();
+                n_flushes++;
+            }
+        }
+
         film->put(block);
+
+        /* Scheduling report: how many launch batches this render submitted
+           and how much host time went into tracing and submitting them; the
+           remaining wall time is GPU execution and launch gaps. */
+        Log(Info, "CUDA scheduling: %i pass%s submitted as %i launch "
+                  "batch%s (%s of host-side submission time).",
+            n_passes, n_passes == 1 ? "" : "es", n_flushes,
+            n_flushes == 1 ? "" : "es",
+            util::time_string((float) eval_time));
     }
 
-    if (!m_stop)
+    if (!m_stop) {
         Log(Info, "Rendering finished. (took %s)",
             util::time_string(m_render_timer.value(), true));
+        Statistics::print_report();
+    }
 
     return !m_stop;
 }
 
+MTS_VARIANT bool SamplingIntegrator<Float, Spectrum>::render_region(
+        Scene *scene, Sensor *sensor, const ScalarPoint2i &offset,
+        const ScalarVector2i &size) {
+    if constexpr (is_cuda_array_v<Float>) {
+        ENOKI_MARK_USED(scene);
+        ENOKI_MARK_USED(sensor);
+        ENOKI_MARK_USED(offset);
+        ENOKI_MARK_USED(size);
+        Throw("render_region() is only supported in the CPU rendering modes!");
+    } else {
+        ScopedPhase sp(ProfilerPhase::Render);
+        m_stop = false;
+
+        ref<Film> film = sensor->film();
+        ScalarPoint2i crop_min = film->crop_offset();
+        ScalarPoint2i crop_max = crop_min + film->crop_size();
+
+        int border = (int) film->reconstruction_filter()->border_size();
+
+        /* Pixels whose accumulated values are reset and recomputed: the
+           dirty rectangle grown by the reconstruction filter support */
+        ScalarPoint2i clear_min = max(offset - border, crop_min),
+                      clear_max = min(offset + size + border, crop_max);
+        if (any(clear_min >= clear_max)) {
+            Log(Warn, "render_region(): region %s + %s does not overlap the "
+                "crop window -- nothing to do.", offset, size);
+            return true;
+        }
+
+        /* Samples to re-render: one further filter border of margin, so that
+           pixels at the edge of the cleared region receive the contributions
+           of nearby outside samples */
+        ScalarPoint2i sample_min = max(clear_min - border, crop_min),
+                      sample_max = min(clear_max + border, crop_max);
+        ScalarVector2i sample_size = sample_max - sample_min;
+
+        std::vector<std::string> channels = aov_names();
+        bool has_aovs = !channels.empty();
+        for (size_t i = 0; i < 5; ++i)
+            channels.insert(channels.begin() + i, std::string(1, "XYZAW"[i]));
+
+        size_t total_spp = sensor->sampler()->sample_count();
+        Log(Info, "Re-rendering %ix%i region at (%i, %i) (%i sample%s)",
+            sample_size.x(), sample_size.y(), sample_min.x(), sample_min.y(),
+            total_spp, total_spp == 1 ? "" : "s");
+
+        film->clear_region(clear_min, clear_max - clear_min);
+
+        /* Region-restricted block schedule in scanline order, replacing the
+           Spiral used for full-frame renders */
+        std::vector<std::pair<ScalarPoint2i, ScalarVector2i>> blocks;
+        for (int y = 0; y < sample_size.y(); y += m_block_size)
+            for (int x = 0; x < sample_size.x(); x += m_block_size)
+                blocks.emplace_back(
+                    sample_min + ScalarVector2i(x, y),
+                    min(ScalarVector2i((int) m_block_size),
+                        sample_size - ScalarVector2i(x, y)));
+
+        ThreadEnvironment env;
+        m_render_timer.reset();
+
+        parallel_for_arena(
+            tbb::blocked_range<size_t>(0, blocks.size(), 1),
+            [&](const tbb::blocked_range<size_t> &range) {
+                ScopedSetThreadEnvironment set_env(env);
+                ref<Sampler> sampler = sensor->sampler()->clone();
+                ref<ImageBlock> block = new ImageBlock(m_block_size, channels.size(),
+                                                       film->reconstruction_filter(),
+                                                       !has_aovs);
+                scoped_flush_denormals flush_denormals(true);
+
+                ScratchArena &arena = m_scratch;
+                ScratchArena::Rewind arena_guard(arena);
+                Float *aovs = arena.alloc<Float>(channels.size());
+
+                for (auto i = range.begin(); i != range.end() && !should_stop(); ++i) {
+                    auto [b_offset, b_size] = blocks[i];
+                    block->set_size(b_size);
+                    block->set_offset(b_offset);
+
+                    // Ensure that the sample generation is fully deterministic
+                    sampler->seed(m_seed_offset + i);
+
+                    render_block(scene, sensor, sampler, block, aovs);
+
+                    /* Contributions that margin samples deposit outside of
+                       the cleared region are already present on the film and
+                       must not accumulate twice */
+                    int b_border = block->border_size();
+                    ScalarVector2i full = b_size + 2 * b_border;
+                    ScalarPoint2i base = b_offset - b_border;
+                    size_t ch = channels.size();
+                    ScalarFloat *data = (ScalarFloat *) block->data().data();
+                    for (int py = 0; py < full.y(); ++py) {
+                        int fy = base.y() + py;
+                        ScalarFloat *row = data + (size_t) py * full.x() * ch;
+                        if (fy < clear_min.y() || fy >= clear_max.y()) {
+                            memset(row, 0, (size_t) full.x() * ch * sizeof(ScalarFloat));
+                            continue;
+                        }
+                        int x0 = std::max(clear_min.x() - base.x(), 0),
+                            x1 = std::min(clear_max.x() - base.x(), full.x());
+                        memset(row, 0, (size_t) x0 * ch * sizeof(ScalarFloat));
+                        memset(row + (size_t) x1 * ch, 0,
+                               (size_t) (full.x() - x1) * ch * sizeof(ScalarFloat));
+                    }
+
+                    film->put(block);
+                }
+            }
+        );
+
+        if (!m_stop)
+            Log(Info, "Region update finished. (took %s)",
+                util::time_string(m_render_timer.value(), true));
+
+        return !m_stop;
+    }
+}
+
+/// Identifies SamplingIntegrator checkpoint files ("MTSC"), see write_checkpoint()
+#define MTS_CHECKPOINT_MAGIC   0x4353544Du
+#define MTS_CHECKPOINT_VERSION 1u
+
+MTS_VARIANT void SamplingIntegrator<Float, Spectrum>::write_checkpoint(
+        const ScalarVector2i &size, uint32_t channel_count,
+        const std::vector<ScalarFloat> &data, size_t passes_done,
+        size_t seed_offset) const {
+    fs::path tmp_path(m_checkpoint_path.string() + ".tmp");
+
+    ref<FileStream> stream =
+        new FileStream(tmp_path, FileStream::ETruncReadWrite);
+    stream->set_byte_order(Stream::ELittleEndian);
+
+    stream->write((uint32_t) MTS_CHECKPOINT_MAGIC);
+    stream->write((uint32_t) MTS_CHECKPOINT_VERSION);
+    stream->write((uint32_t) size.x());
+    stream->write((uint32_t) size.y());
+    stream->write(channel_count);
+    stream->write((uint32_t) sizeof(ScalarFloat));
+    stream->write((uint64_t) passes_done);
+    stream->write((uint64_t) seed_offset);
+    stream->write_array(data.data(), data.size());
+    stream->close();
+
+    // Atomically replace the previous snapshot
+    if (!fs::rename(tmp_path, m_checkpoint_path))
+        Throw("Could not rename \"%s\" to \"%s\"!", tmp_path.string(),
+              m_checkpoint_path.string());
+
+    Log(Debug, "Wrote checkpoint \"%s\" (%i completed pass%s)",
+        m_checkpoint_path.string(), passes_done,
+        passes_done == 1 ? "" : "es");
+}
+
+MTS_VARIANT size_t SamplingIntegrator<Float, Spectrum>::load_checkpoint(
+        Film *film, uint32_t channel_count, size_t &seed_offset) const {
+    ref<FileStream> stream = new FileStream(m_checkpoint_path);
+    stream->set_byte_order(Stream::ELittleEndian);
+
+    uint32_t magic, version, size_x, size_y, channels, component_size;
+    uint64_t passes_done, stored_seed_offset;
+
+    stream->read(magic);
+    stream->read(version);
+    if (magic != MTS_CHECKPOINT_MAGIC || version != MTS_CHECKPOINT_VERSION)
+        Throw("\"%s\": not a valid checkpoint file!",
+              m_checkpoint_path.string());
+
+    stream->read(size_x);
+    stream->read(size_y);
+    stream->read(channels);
+    stream->read(component_size);
+
+    ScalarVector2i size = film->crop_size();
+    if (size_x != (uint32_t) size.x() || size_y != (uint32_t) size.y() ||
+        channels != channel_count || component_size != sizeof(ScalarFloat))
+        Throw("\"%s\": checkpoint is incompatible with the current rendering "
+              "job (%ix%ix%i vs. %ix%ix%i channels expected)!",
+              m_checkpoint_path.string(), size_x, size_y, channels,
+              size.x(), size.y(), channel_count);
+
+    stream->read(passes_done);
+    stream->read(stored_seed_offset);
+
+    std::vector<ScalarFloat> data((size_t) hprod(size) * channel_count);
+    stream->read_array(data.data(), data.size());
+
+    /* Accumulate the stored weighted sample sums onto the freshly prepared
+       film. The block has no reconstruction filter (and thus no border), so
+       its contents map 1:1 onto the film storage. */
+    ref<ImageBlock> block = new ImageBlock(size, channel_count);
+    block->set_offset(film->crop_offset());
+    memcpy(block->data().managed().data(), data.data(),
+           data.size() * sizeof(ScalarFloat));
+    film->put(block);
+
+    seed_offset = (size_t) stored_seed_offset;
+    return (size_t) passes_done;
+}
+
+MTS_VARIANT std::vector<uint8_t>
+SamplingIntegrator<Float, Spectrum>::temporal_reproject(const Scene *scene,
+                                                        const Sensor *sensor,
+                                                        Film *film) {
+    if constexpr (is_cuda_array_v<Float>) {
+        ENOKI_MARK_USED(scene);
+        ENOKI_MARK_USED(sensor);
+        ENOKI_MARK_USED(film);
+        return {};
+    } else {
+        TemporalCache &cache = m_temporal_cache;
+        ScalarVector2i size = film->crop_size();
+        ScalarPoint2i crop_offset = film->crop_offset();
+
+        /* A stale cache (different resolution or channel layout, aborted
+           previous frame) cannot be reprojected -- render from scratch */
+        if (!cache.valid || cache.size != size)
+            return {};
+
+        Timer timer;
+        size_t pixel_count = (size_t) hprod(size);
+        std::vector<uint8_t> covered(pixel_count, 0);
+
+        /* Every accepted cache pixel splats into one shared film-sized
+           block; distinct source pixels may reproject onto the same target
+           pixel, hence atomic accumulation */
+        ref<ImageBlock> block = new ImageBlock(size, cache.channel_count,
+                                               film->reconstruction_filter());
+        block->set_offset(crop_offset);
+        block->set_atomic(true);
+        block->clear();
+
+        /* The per-sample put() treats every SIMD lane as a separate sample,
+           while reprojection handles one pixel at a time */
+        Mask lane_0 = eq(arange<Float>(), Float(0.f));
+
+        std::atomic<size_t> n_reused(0);
+        ThreadEnvironment env;
+        parallel_for_arena(
+            tbb::blocked_range<size_t>(0, (size_t) size.y(), 1),
+            [&](const tbb::blocked_range<size_t> &range) {
+                ScopedSetThreadEnvironment set_env(env);
+                std::vector<Float> value(cache.channel_count);
+                size_t reused = 0;
+
+                for (size_t y = range.begin(); y != range.end(); ++y) {
+                    for (int x = 0; x < size.x(); ++x) {
+                        size_t i = y * (size_t) size.x() + x;
+                        if (!cache.shapes[i])
+                            continue;
+
+                        /* Project the cached first-hit point onto the film
+                           of the updated camera transform */
+                        Interaction3f it = zero<Interaction3f>();
+                        it.p = Point3f(cache.positions[3 * i],
+                                       cache.positions[3 * i + 1],
+                                       cache.positions[3 * i + 2]);
+                        it.time = sensor->shutter_open();
+
+                        auto [ds, importance] =
+                            sensor->sample_direction(it, Point2f(.5f), true);
+                        ENOKI_MARK_USED(importance);
+                        if (slice(ds.pdf, 0) == 0.f)
+                            continue; // outside the view frustum
+
+                        /* Verify that the same shape is still the first
+                           visible surface at (almost) the same depth */
+                        ScalarFloat dist = slice(ds.dist, 0);
+                        Ray3f ray(ds.p, -ds.d, it.time, zero<Wavelength>());
+                        ray.mint = math::RayEpsilon<ScalarFloat> * (1.f + dist);
+
+                        SurfaceInteraction3f si =
+                            scene->ray_intersect(ray, true);
+                        if (slice(si.shape, 0) != cache.shapes[i] ||
+                            std::abs(slice(si.t, 0) - dist) >
+                                1e-3f * (1.f + dist))
+                            continue; // disoccluded (or the shape moved)
+
+                        for (uint32_t k = 0; k < cache.channel_count; ++k)
+                            value[k] = Float(cache.values[i * cache.channel_count + k]);
+
+                        Point2f uv(slice(ds.uv.x(), 0), slice(ds.uv.y(), 0));
+                        block->put(uv, value.data(), lane_0);
+
+                        ScalarPoint2i pix(
+                            (int) std::floor(slice(ds.uv.x(), 0)),
+                            (int) std::floor(slice(ds.uv.y(), 0)));
+                        pix -= crop_offset;
+                        if (all(pix >= 0 && pix < ScalarPoint2i(size)))
+                            covered[(size_t) pix.y() * size.x() + pix.x()] = 1;
+                        reused++;
+                    }
+                }
+
+                n_reused.fetch_add(reused, std::memory_order_relaxed);
+            });
+
+        film->put(block);
+
+        Log(Info, "Temporal reuse: reprojected %i of %i pixels (took %s)",
+            n_reused.load(), pixel_count,
+            util::time_string(timer.value(), true));
+
+        return covered;
+    }
+}
+
+MTS_VARIANT void SamplingIntegrator<Float, Spectrum>::temporal_capture(
+        const Scene *scene, const Sensor *sensor, Film *film) {
+    if constexpr (is_cuda_array_v<Float>) {
+        ENOKI_MARK_USED(scene);
+        ENOKI_MARK_USED(sensor);
+        ENOKI_MARK_USED(film);
+    } else {
+        TemporalCache &cache = m_temporal_cache;
+        cache.valid = false;
+
+        ref<Bitmap> raw;
+        try {
+            raw = film->bitmap(true);
+        } catch (const std::exception &e) {
+            /* e.g. tiled films stream their contents to disk and cannot be
+               re-read */
+            Log(Warn, "Temporal reuse: could not read back the film contents "
+                      "(%s) -- disabling.", e.what());
+            m_temporal_reuse = false;
+            return;
+        }
+
+        ScalarVector2i size = film->crop_size();
+        size_t pixel_count = (size_t) hprod(size);
+        uint32_t ch = (uint32_t) raw->channel_count();
+
+        cache.size          = size;
+        cache.channel_count = ch;
+        cache.values.resize(pixel_count * ch);
+        cache.positions.resize(pixel_count * 3);
+        cache.shapes.assign(pixel_count, nullptr);
+
+        const ScalarFloat *data = (const ScalarFloat *) raw->uint8_data();
+
+        ThreadEnvironment env;
+        parallel_for_arena(
+            tbb::blocked_range<size_t>(0, (size_t) size.y(), 1),
+            [&](const tbb::blocked_range<size_t> &range) {
+                ScopedSetThreadEnvironment set_env(env);
+                for (size_t y = range.begin(); y != range.end(); ++y) {
+                    for (int x = 0; x < size.x(); ++x) {
+                        size_t i = y * (size_t) size.x() + x;
+
+                        /* Store weight-normalized channel values; pixels
+                           that never received a sample cannot be reused */
+                        ScalarFloat weight = data[i * ch + 4];
+                        if (weight <= 0.f)
+                            continue;
+                        ScalarFloat inv_w = 1.f / weight;
+                        ScalarFloat *value = &cache.values[i * ch];
+                        for (uint32_t k = 0; k < ch; ++k)
+                            value[k] = data[i * ch + k] * inv_w;
+                        value[4] = 1.f;
+
+                        // Probe the first visible surface at the pixel center
+                        ScalarPoint2f sp((x + .5f) / size.x(),
+                                         ((int) y + .5f) / size.y());
+                        auto [ray, ray_weight] = sensor->sample_ray(
+                            sensor->shutter_open(), .5f,
+                            Point2f(sp.x(), sp.y()), Point2f(.5f));
+                        ENOKI_MARK_USED(ray_weight);
+
+                        SurfaceInteraction3f si =
+                            scene->ray_intersect(ray, true);
+                        if (!(slice(si.t, 0) < math::Infinity<ScalarFloat>))
+                            continue; // miss: the background moves with the camera
+
+                        cache.positions[3 * i]     = slice(si.p.x(), 0);
+                        cache.positions[3 * i + 1] = slice(si.p.y(), 0);
+                        cache.positions[3 * i + 2] = slice(si.p.z(), 0);
+                        cache.shapes[i] = slice(si.shape, 0);
+                    }
+                }
+            });
+
+        cache.valid = true;
+    }
+}
+
+/// Copy a single SIMD lane of a (potentially nested) enoki array
+template <typename Value>
+static MTS_INLINE void copy_lane(Value &dst, size_t j, const Value &src, size_t i) {
+    if constexpr (is_array_v<value_t<Value>>) {
+        for (size_t k = 0; k < array_size_v<Value>; ++k)
+            copy_lane(dst.coeff(k), j, src.coeff(k), i);
+    } else {
+        dst.coeff(j) = src.coeff(i);
+    }
+}
+
 MTS_VARIANT void SamplingIntegrator<Float, Spectrum>::render_block(const Scene *scene,
                                                                    const Sensor *sensor,
                                                                    Sampler *sampler,
@@ -174,6 +1051,14 @@ MTS_VARIANT void SamplingIntegrator<Float, Spectrum>::render_block(const Scene *
 
     ScalarFloat diff_scale_factor = rsqrt((ScalarFloat) sampler->sample_count());
 
+    if constexpr (!is_cuda_array_v<Float>) {
+        if (unlikely(m_sort_block)) {
+            render_block_sorted(scene, sensor, sampler, block, aovs,
+                                sample_count, diff_scale_factor);
+            return;
+        }
+    }
+
     if constexpr (!is_array_v<Float>) {
         for (uint32_t i = 0; i < pixel_count && !should_stop(); ++i) {
             ScalarPoint2u pos = enoki::morton_decode<ScalarPoint2u>(i);
@@ -181,6 +1066,7 @@ MTS_VARIANT void SamplingIntegrator<Float, Spectrum>::render_block(const Scene *
                 continue;
 
             pos += block->offset();
+            sampler->set_pixel(pos);
             for (uint32_t j = 0; j < sample_count && !should_stop(); ++j) {
                 render_sample(scene, sensor, sampler, block, aovs,
                               pos, diff_scale_factor);
@@ -193,6 +1079,7 @@ MTS_VARIANT void SamplingIntegrator<Float, Spectrum>::render_block(const Scene *
             Point2u pos = enoki::morton_decode<Point2u>(index / UInt32(sample_count));
             active &= !any(pos >= block->size());
             pos += block->offset();
+            sampler->set_pixel(pos);
             render_sample(scene, sensor, sampler, block, aovs, pos, diff_scale_factor, active);
         }
     } else {
@@ -206,6 +1093,299 @@ MTS_VARIANT void SamplingIntegrator<Float, Spectrum>::render_block(const Scene *
     }
 }
 
+MTS_VARIANT void SamplingIntegrator<Float, Spectrum>::render_block_sorted(
+        const Scene *scene, const Sensor *sensor, Sampler *sampler,
+        ImageBlock *block, Float *aovs, uint32_t sample_count,
+        ScalarFloat diff_scale_factor) const {
+    if constexpr (!is_cuda_array_v<Float>) {
+        uint32_t pixel_count = (uint32_t) (m_block_size * m_block_size);
+
+        /// Camera sample whose radiance estimate is still outstanding
+        struct RaySample {
+            RayDifferential3f ray;
+            Spectrum weight;
+            Vector2f pos;
+            Mask active;
+        };
+
+        /* All per-block storage lives in the per-thread scratch arena and
+           is recycled from one block to the next */
+        ScratchArena &arena = m_scratch;
+        ScratchArena::Rewind arena_guard(arena);
+
+        std::vector<RaySample, ScratchAllocator<RaySample>> samples {
+            ScratchAllocator<RaySample>(arena) };
+        std::vector<Ray3f, ScratchAllocator<Ray3f>> rays {
+            ScratchAllocator<Ray3f>(arena) };
+
+        // ------------------ Phase 1: generate and trace ---------------------
+
+        auto enqueue = [&](const Vector2f &pos, Mask active) {
+            // Identical sampler draw order to render_sample()
+            Vector2f position_sample = pos + sampler->next_2d(active);
+
+            Point2f aperture_sample(.5f);
+            if (sensor->needs_aperture_sample())
+                aperture_sample = sampler->next_2d(active);
+
+            Float time = sensor->shutter_open();
+            if (sensor->shutter_open_time() > 0.f)
+                time += sampler->next_1d(active) * sensor->shutter_open_time();
+
+            Float wavelength_sample = sampler->next_1d(active);
+
+            Vector2f adjusted_position =
+                (position_sample - sensor->film()->crop_offset()) /
+                sensor->film()->crop_size();
+
+            auto [ray, ray_weight] = sensor->sample_ray_differential(
+                time, wavelength_sample, adjusted_position, aperture_sample);
+
+            ray.scale_differential(diff_scale_factor);
+            MTS_STAT_ADD(CameraRays, count(active));
+
+            /* Lanes outside of the block carry unusable sample values; an
+               inverted extent makes their rays miss on every backend */
+            if constexpr (is_array_v<Float>)
+                masked(ray.maxt, !active) = -math::Infinity<Float>;
+
+            samples.push_back(RaySample { ray, ray_weight, position_sample, active });
+            rays.push_back(ray);
+        };
+
+        if constexpr (!is_array_v<Float>) {
+            samples.reserve(pixel_count * sample_count);
+            rays.reserve(pixel_count * sample_count);
+            for (uint32_t i = 0; i < pixel_count && !should_stop(); ++i) {
+                ScalarPoint2u pos = enoki::morton_decode<ScalarPoint2u>(i);
+                if (any(pos >= block->size()))
+                    continue;
+
+                pos += block->offset();
+                sampler->set_pixel(pos);
+                for (uint32_t j = 0; j < sample_count; ++j)
+                    enqueue(pos, true);
+            }
+        } else {
+            size_t capacity = (pixel_count * sample_count) / array_size_v<Float> + 1;
+            samples.reserve(capacity);
+            rays.reserve(capacity);
+            for (auto [index, active] : range<UInt32>(pixel_count * sample_count)) {
+                if (should_stop())
+                    break;
+                Point2u pos = enoki::morton_decode<Point2u>(index / UInt32(sample_count));
+                active &= !any(pos >= block->size());
+                pos += block->offset();
+                sampler->set_pixel(pos);
+                enqueue(pos, active);
+            }
+        }
+
+        std::vector<SurfaceInteraction3f, ScratchAllocator<SurfaceInteraction3f>>
+            si { ScratchAllocator<SurfaceInteraction3f>(arena) };
+        si.resize(samples.size());
+        scene->ray_intersect_n(rays.data(), si.data(), samples.size());
+
+        // ------------------ Phase 2: sort hits, then shade ------------------
+
+        /* Distribute the shading work into per-BSDF buckets. A block only
+           ever touches a handful of materials, so a linear key scan followed
+           by a counting sort beats a comparison sort here. */
+        std::vector<const void *, ScratchAllocator<const void *>> bucket_key {
+            ScratchAllocator<const void *>(arena) };
+        std::vector<uint32_t, ScratchAllocator<uint32_t>> bucket_size {
+            ScratchAllocator<uint32_t>(arena) };
+
+        auto bucket_index = [&](const void *key) -> uint32_t {
+            for (uint32_t b = 0; b < (uint32_t) bucket_key.size(); ++b) {
+                if (bucket_key[b] == key)
+                    return b;
+            }
+            bucket_key.push_back(key);
+            bucket_size.push_back(0);
+            return (uint32_t) bucket_key.size() - 1;
+        };
+
+        std::vector<uint32_t, ScratchAllocator<uint32_t>> bucket {
+            ScratchAllocator<uint32_t>(arena) };
+        std::vector<uint32_t, ScratchAllocator<uint32_t>> order {
+            ScratchAllocator<uint32_t>(arena) };
+
+        const Film *film = sensor->film();
+        bool sample_stream = film->has_sample_stream();
+
+        auto shade = [&](const RaySample &s, const SurfaceInteraction3f &si_) {
+            std::pair<Spectrum, Mask> result =
+                sample(scene, sampler, s.ray, si_, aovs + 5, s.active);
+            result.first = s.weight * result.first;
+
+            UnpolarizedSpectrum spec_u = depolarize(result.first);
+
+            Color3f xyz;
+            if constexpr (is_monochromatic_v<Spectrum>) {
+                xyz = spec_u.x();
+            } else if constexpr (is_rgb_v<Spectrum>) {
+                xyz = srgb_to_xyz(spec_u, s.active);
+            } else {
+                static_assert(is_spectral_v<Spectrum>);
+                xyz = spectrum_to_xyz(spec_u, s.ray.wavelengths, s.active);
+            }
+
+            aovs[0] = xyz.x();
+            aovs[1] = xyz.y();
+            aovs[2] = xyz.z();
+            aovs[3] = select(result.second, Float(1.f), Float(0.f));
+            aovs[4] = 1.f;
+
+            block->put(s.pos, aovs, s.active);
+
+            if (unlikely(sample_stream))
+                film->put_sample(s.pos, aovs, s.active);
+
+            sampler->advance();
+        };
+
+        if constexpr (!is_array_v<Float>) {
+            uint32_t n = (uint32_t) samples.size();
+            bucket.resize(n);
+
+            for (uint32_t i = 0; i < n; ++i) {
+                auto shape = si[i].shape;
+                uint32_t b = bucket_index(shape ? shape->bsdf() : nullptr);
+                bucket[i] = b;
+                ++bucket_size[b];
+            }
+
+            // Turn the bucket sizes into a running offset
+            uint32_t offset = 0;
+            for (uint32_t b = 0; b < (uint32_t) bucket_size.size(); ++b) {
+                uint32_t size = bucket_size[b];
+                bucket_size[b] = offset;
+                offset += size;
+            }
+
+            order.resize(n);
+            for (uint32_t i = 0; i < n; ++i)
+                order[bucket_size[bucket[i]]++] = i;
+
+            for (uint32_t k = 0; k < n && !should_stop(); ++k)
+                shade(samples[order[k]], si[order[k]]);
+        } else {
+            constexpr size_t PacketSize = array_size_v<Float>;
+            uint32_t count = (uint32_t) samples.size(),
+                     n     = count * (uint32_t) PacketSize;
+            bucket.resize(n);
+
+            /* Bucket individual lanes; lanes that do not correspond to a
+               film sample are dropped rather than sorted */
+            uint32_t work = 0;
+            for (uint32_t e = 0; e < count; ++e) {
+                for (size_t l = 0; l < PacketSize; ++l) {
+                    uint32_t i = e * (uint32_t) PacketSize + (uint32_t) l;
+                    if (!(bool) samples[e].active.coeff(l)) {
+                        bucket[i] = (uint32_t) -1;
+                        continue;
+                    }
+                    auto shape = si[e].shape.coeff(l);
+                    uint32_t b = bucket_index(shape ? shape->bsdf() : nullptr);
+                    bucket[i] = b;
+                    ++bucket_size[b];
+                    ++work;
+                }
+            }
+
+            // Turn the bucket sizes into a running offset
+            uint32_t offset = 0;
+            for (uint32_t b = 0; b < (uint32_t) bucket_size.size(); ++b) {
+                uint32_t size = bucket_size[b];
+                bucket_size[b] = offset;
+                offset += size;
+            }
+
+            order.resize(work);
+            for (uint32_t i = 0; i < n; ++i) {
+                if (bucket[i] != (uint32_t) -1)
+                    order[bucket_size[bucket[i]]++] = i;
+            }
+
+            /* Regroup the sorted lanes into full packets so that every
+               shaded packet invokes a single BSDF */
+            RaySample acc;
+            SurfaceInteraction3f acc_si;
+            size_t filled = 0;
+
+            for (uint32_t k = 0; k < (uint32_t) order.size() && !should_stop(); ++k) {
+                uint32_t e = order[k] / (uint32_t) PacketSize;
+                size_t   l = (size_t) (order[k] % (uint32_t) PacketSize);
+
+                const RaySample &s = samples[e];
+                const SurfaceInteraction3f &s_si = si[e];
+
+                if (filled == 0) {
+                    /* Start from a copy of the source packet so that the
+                       not-yet-filled lanes contain valid (if unused) data */
+                    acc = s;
+                    acc_si = s_si;
+                    acc.active = false;
+                }
+
+                copy_lane(acc.ray.o,           filled, s.ray.o,           l);
+                copy_lane(acc.ray.d,           filled, s.ray.d,           l);
+                copy_lane(acc.ray.d_rcp,       filled, s.ray.d_rcp,       l);
+                copy_lane(acc.ray.mint,        filled, s.ray.mint,        l);
+                copy_lane(acc.ray.maxt,        filled, s.ray.maxt,        l);
+                copy_lane(acc.ray.time,        filled, s.ray.time,        l);
+                copy_lane(acc.ray.wavelengths, filled, s.ray.wavelengths, l);
+                if (s.ray.has_differentials) {
+                    copy_lane(acc.ray.o_x, filled, s.ray.o_x, l);
+                    copy_lane(acc.ray.o_y, filled, s.ray.o_y, l);
+                    copy_lane(acc.ray.d_x, filled, s.ray.d_x, l);
+                    copy_lane(acc.ray.d_y, filled, s.ray.d_y, l);
+                }
+                copy_lane(acc.weight, filled, s.weight, l);
+                copy_lane(acc.pos,    filled, s.pos,    l);
+
+                copy_lane(acc_si.t,           filled, s_si.t,           l);
+                copy_lane(acc_si.time,        filled, s_si.time,        l);
+                copy_lane(acc_si.wavelengths, filled, s_si.wavelengths, l);
+                copy_lane(acc_si.p,           filled, s_si.p,           l);
+                copy_lane(acc_si.uv,          filled, s_si.uv,          l);
+                copy_lane(acc_si.n,           filled, s_si.n,           l);
+                copy_lane(acc_si.sh_frame.s,  filled, s_si.sh_frame.s,  l);
+                copy_lane(acc_si.sh_frame.t,  filled, s_si.sh_frame.t,  l);
+                copy_lane(acc_si.sh_frame.n,  filled, s_si.sh_frame.n,  l);
+                copy_lane(acc_si.dp_du,       filled, s_si.dp_du,       l);
+                copy_lane(acc_si.dp_dv,       filled, s_si.dp_dv,       l);
+                copy_lane(acc_si.duv_dx,      filled, s_si.duv_dx,      l);
+                copy_lane(acc_si.duv_dy,      filled, s_si.duv_dy,      l);
+                copy_lane(acc_si.wi,          filled, s_si.wi,          l);
+                copy_lane(acc_si.prim_index,  filled, s_si.prim_index,  l);
+                copy_lane(acc_si.shape,       filled, s_si.shape,       l);
+                copy_lane(acc_si.instance,    filled, s_si.instance,    l);
+
+                acc.active.coeff(filled) = true;
+
+                if (++filled == PacketSize) {
+                    shade(acc, acc_si);
+                    filled = 0;
+                }
+            }
+
+            if (filled > 0)
+                shade(acc, acc_si);
+        }
+    } else {
+        ENOKI_MARK_USED(scene);
+        ENOKI_MARK_USED(sensor);
+        ENOKI_MARK_USED(sampler);
+        ENOKI_MARK_USED(block);
+        ENOKI_MARK_USED(aovs);
+        ENOKI_MARK_USED(sample_count);
+        ENOKI_MARK_USED(diff_scale_factor);
+        Throw("Not implemented for CUDA arrays.");
+    }
+}
+
 MTS_VARIANT void SamplingIntegrator<Float, Spectrum>::render_sample(
     const Scene *scene, const Sensor *sensor, Sampler *sampler, ImageBlock *block,
     Float *aovs, const Vector2f &pos, ScalarFloat diff_scale_factor, Mask active) const {
@@ -229,6 +1409,7 @@ MTS_VARIANT void SamplingIntegrator<Float, Spectrum>::render_sample(
         time, wavelength_sample, adjusted_position, aperture_sample);
 
     ray.scale_differential(diff_scale_factor);
+    MTS_STAT_ADD(CameraRays, count(active));
 
     std::pair<Spectrum, Mask> result = sample(scene, sampler, ray, aovs + 5, active);
     result.first = ray_weight * result.first;
@@ -252,6 +1433,11 @@ MTS_VARIANT void SamplingIntegrator<Float, Spectrum>::render_sample(
     aovs[4] = 1.f;
 
     block->put(position_sample, aovs, active);
+
+    if (unlikely(sensor->film()->has_sample_stream()))
+        sensor->film()->put_sample(position_sample, aovs, active);
+
+    sampler->advance();
 }
 
 MTS_VARIANT std::pair<Spectrum, typename SamplingIntegrator<Float, Spectrum>::Mask>
@@ -263,8 +1449,56 @@ SamplingIntegrator<Float, Spectrum>::sample(const Scene * /* scene */,
     NotImplementedError("sample");
 }
 
+MTS_VARIANT void
+SamplingIntegrator<Float, Spectrum>::sample_adjoint(const Scene * /* scene */,
+                                                    Sampler * /* sampler */,
+                                                    const RayDifferential3f & /* ray */,
+                                                    const Spectrum & /* adjoint */,
+                                                    Mask /* active */) const {
+    NotImplementedError("sample_adjoint");
+}
+
+MTS_VARIANT std::pair<Spectrum, typename SamplingIntegrator<Float, Spectrum>::Mask>
+SamplingIntegrator<Float, Spectrum>::sample(const Scene *scene,
+                                            Sampler *sampler,
+                                            const RayDifferential3f &ray,
+                                            const SurfaceInteraction3f & /* si */,
+                                            Float *aovs,
+                                            Mask active) const {
+    /* Integrators without a dedicated entry point simply discard the
+       precomputed intersection and find the first surface again */
+    return sample(scene, sampler, ray, aovs, active);
+}
+
 // -----------------------------------------------------------------------------
 
+MTS_VARIANT void SamplingIntegrator<Float, Spectrum>::update_luminance_estimate(
+        const ImageBlock *block) const {
+    if constexpr (is_cuda_array_v<Float>) {
+        ENOKI_MARK_USED(block);
+    } else {
+        if (!block->track_variance())
+            return;
+
+        auto [accum, count] = block->luminance_accum();
+        if (count == 0)
+            return;
+
+        double expected = m_lum_accum.load(std::memory_order_relaxed);
+        while (!m_lum_accum.compare_exchange_weak(expected, expected + accum))
+            ;
+        m_lum_count.fetch_add(count, std::memory_order_relaxed);
+    }
+}
+
+MTS_VARIANT typename SamplingIntegrator<Float, Spectrum>::ScalarFloat
+SamplingIntegrator<Float, Spectrum>::luminance_estimate() const {
+    size_t count = m_lum_count.load(std::memory_order_relaxed);
+    if (count == 0)
+        return 0.f;
+    return (ScalarFloat) (m_lum_accum.load(std::memory_order_relaxed) / count);
+}
+
 MTS_VARIANT MonteCarloIntegrator<Float, Spectrum>::MonteCarloIntegrator(const Properties &props)
     : Base(props) {
     /// Depth to begin using russian roulette
@@ -281,15 +1515,247 @@ MTS_VARIANT MonteCarloIntegrator<Float, Spectrum>::MonteCarloIntegrator(const Pr
 
     /// Disable direct visibility of emitters if needed
     m_hide_emitters = props.bool_("hide_emitters", false);
+
+    /* Normalize the russian roulette heuristic by a running estimate of the
+       mean image luminance, so that survival decisions reflect a path's
+       relative (rather than absolute) contribution potential */
+    m_adaptive_rr = props.bool_("adaptive_rr", false);
+
+    /// Cap on the emitter sample splitting granted to strong paths
+    m_rr_split_max = props.int_("rr_split_max", 4);
+    if (m_rr_split_max < 1)
+        Throw("\"rr_split_max\" must be set to a value greater than zero!");
 }
 
 MTS_VARIANT MonteCarloIntegrator<Float, Spectrum>::~MonteCarloIntegrator() { }
 
+// -----------------------------------------------------------------------------
+
+MTS_VARIANT WavefrontIntegrator<Float, Spectrum>::WavefrontIntegrator(const Properties &props)
+    : Base(props) { }
+
+MTS_VARIANT WavefrontIntegrator<Float, Spectrum>::~WavefrontIntegrator() { }
+
+MTS_VARIANT void WavefrontIntegrator<Float, Spectrum>::render_block(const Scene *scene,
+                                                                    const Sensor *sensor,
+                                                                    Sampler *sampler,
+                                                                    ImageBlock *block,
+                                                                    Float *aovs,
+                                                                    size_t sample_count_) const {
+    if constexpr (is_cuda_array_v<Float>) {
+        // GPU variants already evaluate the entire wavefront at once
+        Base::render_block(scene, sensor, sampler, block, aovs, sample_count_);
+    } else {
+        if (!aov_names().empty())
+            Throw("The wavefront scheduler does not currently support AOVs.");
+
+        block->clear();
+        uint32_t pixel_count  = (uint32_t)(m_block_size * m_block_size),
+                 sample_count = (uint32_t)(sample_count_ == (size_t) -1
+                                               ? sampler->sample_count()
+                                               : sample_count_);
+
+        ScalarFloat diff_scale_factor = rsqrt((ScalarFloat) sampler->sample_count());
+
+        /* Breadth-first queue of camera paths. States of equal depth are
+           stored contiguously so that scene and shading queries performed by
+           \ref trace_wavefront() operate on coherent batches. The storage
+           comes from the per-thread scratch arena and is recycled from one
+           block to the next. */
+        ScratchArena &arena = m_scratch;
+        ScratchArena::Rewind arena_guard(arena);
+        PathQueue queue { ScratchAllocator<PathState>(arena) };
+
+        auto enqueue = [&](const Vector2f &pos, Mask active) {
+            Vector2f position_sample = pos + sampler->next_2d(active);
+
+            Point2f aperture_sample(.5f);
+            if (sensor->needs_aperture_sample())
+                aperture_sample = sampler->next_2d(active);
+
+            Float time = sensor->shutter_open();
+            if (sensor->shutter_open_time() > 0.f)
+                time += sampler->next_1d(active) * sensor->shutter_open_time();
+
+            Float wavelength_sample = sampler->next_1d(active);
+
+            Vector2f adjusted_position =
+                (position_sample - sensor->film()->crop_offset()) /
+                sensor->film()->crop_size();
+
+            auto [ray, ray_weight] = sensor->sample_ray_differential(
+                time, wavelength_sample, adjusted_position, aperture_sample);
+
+            ray.scale_differential(diff_scale_factor);
+            MTS_STAT_ADD(CameraRays, count(active));
+
+            PathState state;
+            state.ray        = ray;
+            state.throughput = ray_weight;
+            state.result     = 0.f;
+            state.pos        = position_sample;
+            state.active     = active;
+            state.valid      = false;
+            state.mask       = active;
+            queue.push_back(state);
+        };
+
+        if constexpr (!is_array_v<Float>) {
+            queue.reserve(pixel_count * sample_count);
+            for (uint32_t i = 0; i < pixel_count && !should_stop(); ++i) {
+                ScalarPoint2u pos = enoki::morton_decode<ScalarPoint2u>(i);
+                if (any(pos >= block->size()))
+                    continue;
+
+                pos += block->offset();
+                sampler->set_pixel(pos);
+                for (uint32_t j = 0; j < sample_count; ++j)
+                    enqueue(pos, true);
+            }
+        } else {
+            queue.reserve((pixel_count * sample_count) / array_size_v<Float> + 1);
+            for (auto [index, active] : range<UInt32>(pixel_count * sample_count)) {
+                if (should_stop())
+                    break;
+                Point2u pos = enoki::morton_decode<Point2u>(index / UInt32(sample_count));
+                active &= !any(pos >= block->size());
+                pos += block->offset();
+                sampler->set_pixel(pos);
+                enqueue(pos, active);
+            }
+        }
+
+        // Advance all paths together, one bounce at a time
+        for (uint32_t depth = 0;
+             !queue.empty() && !should_stop() &&
+             (m_max_depth < 0 || depth < (uint32_t) m_max_depth); ++depth) {
+            trace_wavefront(scene, sampler, queue, depth);
+
+            /* Develop finished paths and repack the surviving lanes into
+               full packets for the next bounce */
+            compact_wavefront(queue, block, aovs);
+        }
+
+        // Paths cut short by the depth limit still carry a valid estimate
+        for (const PathState &state : queue)
+            develop(state, block, aovs);
+    }
+}
+
+MTS_VARIANT void WavefrontIntegrator<Float, Spectrum>::compact_wavefront(
+        PathQueue &queue, ImageBlock *block, Float *aovs) const {
+    if constexpr (!is_array_v<Float>) {
+        // One path per state -- simply remove finished entries
+        size_t size = 0;
+        for (size_t i = 0; i < queue.size(); ++i) {
+            if (none(queue[i].active))
+                develop(queue[i], block, aovs);
+            else
+                queue[size++] = queue[i];
+        }
+        queue.resize(size);
+    } else {
+        constexpr size_t PacketSize = array_size_v<Float>;
+
+        /* Splat the contributions of film samples whose paths have
+           terminated; the lanes they occupied are then free for reuse */
+        for (PathState &state : queue) {
+            Mask done = state.mask && !state.active;
+            if (any(done)) {
+                PathState finished = state;
+                finished.mask = done;
+                develop(finished, block, aovs);
+                state.mask &= state.active;
+            }
+        }
+
+        /* Gather the surviving lanes of partially occupied packets into
+           full ones, so that later bounces run at full SIMD occupancy at
+           the cost of a register-to-register shuffle per bounce */
+        PathQueue packed(queue.get_allocator());
+        packed.reserve(queue.size());
+
+        PathState acc;
+        size_t filled = 0;
+
+        for (const PathState &state : queue) {
+            for (size_t i = 0; i < PacketSize; ++i) {
+                if (!(bool) state.active.coeff(i))
+                    continue;
+
+                if (filled == 0) {
+                    /* Start from a copy of the source packet so that the
+                       not-yet-filled lanes contain valid (if unused) data */
+                    acc = state;
+                    acc.active = acc.valid = acc.mask = false;
+                }
+
+                copy_lane(acc.ray.o,           filled, state.ray.o,           i);
+                copy_lane(acc.ray.d,           filled, state.ray.d,           i);
+                copy_lane(acc.ray.d_rcp,       filled, state.ray.d_rcp,       i);
+                copy_lane(acc.ray.mint,        filled, state.ray.mint,        i);
+                copy_lane(acc.ray.maxt,        filled, state.ray.maxt,        i);
+                copy_lane(acc.ray.time,        filled, state.ray.time,        i);
+                copy_lane(acc.ray.wavelengths, filled, state.ray.wavelengths, i);
+                if (state.ray.has_differentials) {
+                    copy_lane(acc.ray.o_x, filled, state.ray.o_x, i);
+                    copy_lane(acc.ray.o_y, filled, state.ray.o_y, i);
+                    copy_lane(acc.ray.d_x, filled, state.ray.d_x, i);
+                    copy_lane(acc.ray.d_y, filled, state.ray.d_y, i);
+                }
+                copy_lane(acc.throughput, filled, state.throughput, i);
+                copy_lane(acc.result,     filled, state.result,     i);
+                copy_lane(acc.pos,        filled, state.pos,        i);
+
+                acc.active.coeff(filled) = true;
+                acc.valid.coeff(filled)  = (bool) state.valid.coeff(i);
+                acc.mask.coeff(filled)   = true;
+
+                if (++filled == PacketSize) {
+                    packed.push_back(acc);
+                    filled = 0;
+                }
+            }
+        }
+
+        if (filled > 0)
+            packed.push_back(acc);
+
+        queue = std::move(packed);
+    }
+}
+
+MTS_VARIANT void WavefrontIntegrator<Float, Spectrum>::develop(const PathState &state,
+                                                               ImageBlock *block,
+                                                               Float *aovs) const {
+    UnpolarizedSpectrum spec_u = depolarize(state.result);
+
+    Color3f xyz;
+    if constexpr (is_monochromatic_v<Spectrum>) {
+        xyz = spec_u.x();
+    } else if constexpr (is_rgb_v<Spectrum>) {
+        xyz = srgb_to_xyz(spec_u, state.mask);
+    } else {
+        static_assert(is_spectral_v<Spectrum>);
+        xyz = spectrum_to_xyz(spec_u, state.ray.wavelengths, state.mask);
+    }
+
+    aovs[0] = xyz.x();
+    aovs[1] = xyz.y();
+    aovs[2] = xyz.z();
+    aovs[3] = select(state.valid, Float(1.f), Float(0.f));
+    aovs[4] = 1.f;
+
+    block->put(state.pos, aovs, state.mask);
+}
+
 MTS_IMPLEMENT_CLASS_VARIANT(Integrator, Object, "integrator")
 MTS_IMPLEMENT_CLASS_VARIANT(SamplingIntegrator, Integrator)
 MTS_IMPLEMENT_CLASS_VARIANT(MonteCarloIntegrator, SamplingIntegrator)
+MTS_IMPLEMENT_CLASS_VARIANT(WavefrontIntegrator, MonteCarloIntegrator)
 
 MTS_INSTANTIATE_CLASS(Integrator)
 MTS_INSTANTIATE_CLASS(SamplingIntegrator)
 MTS_INSTANTIATE_CLASS(MonteCarloIntegrator)
+MTS_INSTANTIATE_CLASS(WavefrontIntegrator)
 NAMESPACE_END(mitsuba)
@@ -0,0 +1,576 @@
+/*
+    Distributed rendering over the bundled ZeroMQ transport: a coordinator
+    that shards the image blocks produced by the \ref Spiral scheduler across
+    worker processes, and the matching worker loop serving block rendering
+    requests (see "--workers" and "--serve" in the command line tool).
+
+    This file is included by integrator.cpp when Mitsuba is compiled with
+    -DMTS_ENABLE_DISTRIBUTED=1.
+*/
+
+#include <unordered_map>
+#include <unordered_set>
+
+#include <mitsuba/core/mstream.h>
+#include <mitsuba/core/xml.h>
+#include <mitsuba/core/zmq11.h>
+#include <mitsuba/core/zstream.h>
+
+NAMESPACE_BEGIN(mitsuba)
+NAMESPACE_BEGIN(detail)
+
+/// Wire protocol revision; bump when changing any of the structures below
+constexpr uint32_t kDistributedProtocolVersion = 1;
+
+/// Work order for a single image block (also the wire format)
+struct BlockOrder {
+    /// Scheduler-assigned block id, used for de-duplication by the coordinator
+    uint32_t index;
+    /// Crop window-relative offset and size of the block in pixels
+    int32_t offset_x, offset_y, size_x, size_y;
+    /// Sampler seed. Deterministic, so that re-dispatched copies of a
+    /// straggling block produce bit-identical results
+    uint64_t seed;
+    /// Number of samples per pixel to render
+    uint32_t spp;
+};
+
+/// Worker capabilities, reported in response to a "setup" request
+struct WorkerInfo {
+    uint32_t protocol_version;
+    uint32_t thread_count;
+    uint32_t channel_count;
+    uint32_t block_size;
+};
+
+/// Deflate the raw contents of an image block for transmission
+inline std::vector<uint8_t> compress_block(const void *ptr, size_t size) {
+    ref<MemoryStream> storage = new MemoryStream(size / 4);
+    ref<ZStream> zstream = new ZStream(storage);
+    zstream->write(ptr, size);
+    zstream->close();
+
+    std::vector<uint8_t> result(storage->size());
+    storage->seek(0);
+    storage->read(result.data(), result.size());
+    return result;
+}
+
+/// Inverse of \ref compress_block()
+inline void decompress_block(const void *src, size_t src_size,
+                             void *dst, size_t dst_size) {
+    ref<MemoryStream> storage =
+        new MemoryStream(const_cast<void *>(src), src_size);
+    ref<ZStream> zstream = new ZStream(storage);
+    zstream->read(dst, dst_size);
+}
+
+/// Receive the remaining parts of a multipart message
+inline std::vector<zmq::message> recv_parts(zmq::socket &socket) {
+    std::vector<zmq::message> parts;
+    while (socket.more()) {
+        zmq::message msg;
+        socket.recv(msg);
+        parts.push_back(std::move(msg));
+    }
+    return parts;
+}
+
+/// Reinterpret a message part as a trivially copyable structure
+template <typename T> const T &part_as(const zmq::message &msg) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    if (msg.size() != sizeof(T))
+        throw zmq::exception("Message part has an incorrect size (expected " +
+                             std::to_string(sizeof(T)) + " bytes, got " +
+                             std::to_string(msg.size()) + " bytes)");
+    return *msg.data<T>();
+}
+
+/// Reinterpret a message part as a string
+inline std::string part_as_string(const zmq::message &msg) {
+    return std::string(msg.data<char>(), msg.size());
+}
+
+NAMESPACE_END(detail)
+
+MTS_VARIANT void SamplingIntegrator<Float, Spectrum>::serve_blocks(
+        const std::string &bind_address, const std::string &mode) {
+    if constexpr (is_cuda_array_v<Float>) {
+        ENOKI_MARK_USED(bind_address);
+        ENOKI_MARK_USED(mode);
+        Throw("serve_blocks(): distributed rendering is not supported in "
+              "the GPU modes!");
+    } else {
+        using detail::BlockOrder;
+        using detail::WorkerInfo;
+
+        zmq::context context;
+        zmq::socket socket(context, zmq::socket::rep);
+        socket.bind(bind_address);
+
+        Log(Info, "Worker listening on \"%s\" (mode \"%s\", %i thread%s)",
+            bind_address, mode, __global_thread_count,
+            __global_thread_count == 1 ? "" : "s");
+
+        // State established by the most recent "setup" request
+        ref<Scene> scene;
+        ref<Sensor> sensor;
+        SamplingIntegrator *integrator = nullptr;
+        uint32_t channel_count = 0;
+        bool has_aovs = false;
+
+        while (true) {
+            std::string command;
+            std::vector<zmq::message> parts;
+            try {
+                socket.recv(command);
+                parts = detail::recv_parts(socket);
+            } catch (const zmq::exception &) {
+                break; // Interrupted (e.g. Ctrl+C) -- shut down
+            }
+
+            try {
+                if (command == "setup") {
+                    /* Load the requested scene; the coordinator and all
+                       workers must resolve the file to the same scene (e.g.
+                       via a shared file system) */
+                    if (parts.size() < 4)
+                        Throw("Malformed \"setup\" request (%i parts)!",
+                              parts.size());
+
+                    std::string req_mode   = detail::part_as_string(parts[0]),
+                                scene_file = detail::part_as_string(parts[1]);
+                    uint32_t sensor_index  = detail::part_as<uint32_t>(parts[2]),
+                             define_count  = detail::part_as<uint32_t>(parts[3]);
+
+                    if (parts.size() != 4 + 2 * (size_t) define_count)
+                        Throw("Malformed \"setup\" request (%i parts)!",
+                              parts.size());
+
+                    if (req_mode != mode)
+                        Throw("Variant mismatch: the coordinator renders in mode "
+                              "\"%s\", but this worker was started with \"%s\"!",
+                              req_mode, mode);
+
+                    xml::ParameterList params;
+                    for (uint32_t i = 0; i < define_count; ++i)
+                        params.emplace_back(
+                            detail::part_as_string(parts[4 + 2 * i]),
+                            detail::part_as_string(parts[5 + 2 * i]));
+
+                    Timer timer;
+                    ref<Object> parsed = xml::load_file(scene_file, mode, params);
+                    scene = dynamic_cast<Scene *>(parsed.get());
+                    if (!scene)
+                        Throw("Root element of \"%s\" must be a <scene> tag!",
+                              scene_file);
+                    if (sensor_index >= scene->sensors().size())
+                        Throw("Specified sensor index is out of bounds!");
+                    sensor = scene->sensors()[sensor_index];
+
+                    integrator = dynamic_cast<SamplingIntegrator *>(
+                        scene->integrator());
+                    if (!integrator)
+                        Throw("Distributed rendering requires a sampling-based "
+                              "integrator!");
+                    integrator->m_stop = false;
+
+                    has_aovs = !integrator->aov_names().empty();
+                    channel_count =
+                        (uint32_t) (5 + integrator->aov_names().size());
+
+                    Log(Info, "Scene \"%s\" is now resident. (took %s)",
+                        scene_file, util::time_string(timer.value()));
+
+                    WorkerInfo info;
+                    info.protocol_version = detail::kDistributedProtocolVersion;
+                    info.thread_count     = (uint32_t) __global_thread_count;
+                    info.channel_count    = channel_count;
+                    info.block_size       = integrator->m_block_size;
+                    socket.sendmore(std::string("ok"));
+                    socket.send(info);
+                } else if (command == "render") {
+                    if (!scene)
+                        Throw("Received a \"render\" request before \"setup\"!");
+
+                    std::vector<BlockOrder> orders(parts.size());
+                    for (size_t i = 0; i < parts.size(); ++i)
+                        orders[i] = detail::part_as<BlockOrder>(parts[i]);
+                    std::vector<std::vector<uint8_t>> payloads(orders.size());
+
+                    Film *film = sensor->film();
+                    ThreadEnvironment env;
+                    Timer timer;
+
+                    tbb::parallel_for(
+                        tbb::blocked_range<size_t>(0, orders.size(), 1),
+                        [&](const tbb::blocked_range<size_t> &range) {
+                            ScopedSetThreadEnvironment set_env(env);
+                            ref<Sampler> sampler = sensor->sampler()->clone();
+                            ref<ImageBlock> block = new ImageBlock(
+                                integrator->m_block_size, channel_count,
+                                film->reconstruction_filter(), !has_aovs);
+                            scoped_flush_denormals flush_denormals(true);
+
+                            ScratchArena &arena = integrator->m_scratch;
+                            ScratchArena::Rewind arena_guard(arena);
+                            Float *aovs = arena.alloc<Float>(channel_count);
+
+                            for (auto i = range.begin(); i != range.end(); ++i) {
+                                const BlockOrder &order = orders[i];
+                                block->set_size(ScalarVector2i(order.size_x,
+                                                               order.size_y));
+                                block->set_offset(ScalarPoint2i(order.offset_x,
+                                                                order.offset_y));
+                                sampler->seed(order.seed);
+
+                                integrator->render_block(scene, sensor, sampler,
+                                                         block, aovs, order.spp);
+
+                                size_t n_bytes = channel_count *
+                                    hprod(block->size() + 2 * block->border_size()) *
+                                    sizeof(ScalarFloat);
+                                payloads[i] = detail::compress_block(
+                                    block->data().managed().data(), n_bytes);
+                            }
+                        }
+                    );
+
+                    Log(Debug, "Rendered %i block%s. (took %s)", orders.size(),
+                        orders.size() == 1 ? "" : "s",
+                        util::time_string(timer.value()));
+
+                    if (orders.empty()) {
+                        socket.send(std::string("ok"));
+                    } else {
+                        socket.sendmore(std::string("ok"));
+                        for (size_t i = 0; i < orders.size(); ++i) {
+                            socket.sendmore(orders[i]);
+                            const auto &payload = payloads[i];
+                            if (i + 1 < orders.size())
+                                socket.sendmore(payload.data(), payload.size());
+                            else
+                                socket.send(payload.data(), payload.size());
+                        }
+                    }
+                } else if (command == "quit") {
+                    socket.send(std::string("ok"));
+                    break;
+                } else {
+                    Throw("Unknown request \"%s\"!", command);
+                }
+            } catch (const std::exception &e) {
+                Log(Warn, "Request \"%s\" failed: %s", command, e.what());
+                socket.sendmore(std::string("error"));
+                socket.send(std::string(e.what()));
+            }
+        }
+
+        Log(Info, "Worker shutting down.");
+    }
+}
+
+MTS_VARIANT bool SamplingIntegrator<Float, Spectrum>::render_distributed(
+        Scene *scene, Sensor *sensor, const std::vector<std::string> &workers,
+        const std::string &scene_file,
+        const std::vector<std::pair<std::string, std::string>> &parameters,
+        size_t sensor_index, const std::string &mode) {
+    if constexpr (is_cuda_array_v<Float>) {
+        ENOKI_MARK_USED(scene);
+        ENOKI_MARK_USED(sensor);
+        ENOKI_MARK_USED(workers);
+        ENOKI_MARK_USED(scene_file);
+        ENOKI_MARK_USED(parameters);
+        ENOKI_MARK_USED(sensor_index);
+        ENOKI_MARK_USED(mode);
+        Throw("render_distributed(): distributed rendering is not supported "
+              "in the GPU modes!");
+    } else {
+        using detail::BlockOrder;
+        using detail::WorkerInfo;
+        ENOKI_MARK_USED(scene);
+
+        ScopedPhase sp(ProfilerPhase::Render);
+        m_stop = false;
+
+        if (workers.empty())
+            Throw("render_distributed(): no workers were specified!");
+
+        ref<Film> film = sensor->film();
+        ScalarVector2i film_size = film->crop_size();
+
+        size_t total_spp        = sensor->sampler()->sample_count();
+        size_t samples_per_pass = (m_samples_per_pass == (size_t) -1)
+                                   ? total_spp : std::min((size_t) m_samples_per_pass, total_spp);
+        if ((total_spp % samples_per_pass) != 0)
+            Throw("sample_count (%d) must be a multiple of samples_per_pass (%d).",
+                  total_spp, samples_per_pass);
+
+        size_t n_passes = ceil(total_spp / (ScalarFloat) samples_per_pass);
+
+        std::vector<std::string> channels = aov_names();
+        bool has_aovs = !channels.empty();
+        for (size_t i = 0; i < 5; ++i)
+            channels.insert(channels.begin() + i, std::string(1, "XYZAW"[i]));
+        film->prepare(channels);
+
+        if (!m_checkpoint_path.empty() || m_error_threshold > 0.f ||
+            m_preview_callback)
+            Log(Warn, "Checkpointing, adaptive sampling and preview tiles are "
+                      "not supported in distributed mode -- ignoring.");
+
+        /* Connect to the worker pool and distribute the scene description.
+           Workers are persistent processes: they outlive individual jobs, so
+           that an animation pays the scene loading cost only once per node. */
+        zmq::context context;
+
+        struct Worker {
+            zmq::socket socket;
+            std::string address;
+            uint32_t batch_size = 0;
+            std::vector<BlockOrder> in_flight;
+            bool busy = false;
+            bool alive = true;
+        };
+        std::vector<Worker> pool;
+
+        for (std::string address : workers) {
+            if (address.find("://") == std::string::npos)
+                address = "tcp://" + address;
+
+            Worker w;
+            w.socket = zmq::socket(context, zmq::socket::req);
+            w.socket.setsockopt(ZMQ_LINGER, (int) 0);
+            w.socket.connect(address);
+            w.address = address;
+
+            w.socket.sendmore(std::string("setup"));
+            w.socket.sendmore(mode);
+            w.socket.sendmore(scene_file);
+            w.socket.sendmore((uint32_t) sensor_index);
+            if (parameters.empty()) {
+                w.socket.send((uint32_t) 0);
+            } else {
+                w.socket.sendmore((uint32_t) parameters.size());
+                for (size_t i = 0; i < parameters.size(); ++i) {
+                    w.socket.sendmore(parameters[i].first);
+                    if (i + 1 < parameters.size())
+                        w.socket.sendmore(parameters[i].second);
+                    else
+                        w.socket.send(parameters[i].second);
+                }
+            }
+            pool.push_back(std::move(w));
+        }
+
+        // Collect the setup replies, dropping workers that fail or time out
+        size_t alive_workers = 0;
+        for (Worker &w : pool) {
+            zmq::pollitem item { (void *) w.socket, 0, zmq::pollin, 0 };
+            if (zmq::poll(&item, 1, std::chrono::seconds(60)) == 0) {
+                Log(Warn, "Worker \"%s\" did not respond -- dropping it.",
+                    w.address);
+                w.alive = false;
+                continue;
+            }
+
+            std::string status;
+            w.socket.recv(status);
+            auto parts = detail::recv_parts(w.socket);
+            if (status != "ok") {
+                Log(Warn, "Worker \"%s\" failed to load the scene: %s -- "
+                          "dropping it.", w.address,
+                    detail::part_as_string(parts[0]));
+                w.alive = false;
+                continue;
+            }
+
+            const WorkerInfo &info = detail::part_as<WorkerInfo>(parts[0]);
+            if (info.protocol_version != detail::kDistributedProtocolVersion ||
+                info.channel_count != (uint32_t) channels.size() ||
+                info.block_size != m_block_size) {
+                Log(Warn, "Worker \"%s\" is incompatible with this job "
+                          "(protocol %i, %i channels, block size %i) -- "
+                          "dropping it.", w.address, info.protocol_version,
+                    info.channel_count, info.block_size);
+                w.alive = false;
+                continue;
+            }
+
+            /* One block per worker thread and request; large enough to keep
+               all cores busy, small enough for timely straggler detection */
+            w.batch_size = std::max(1u, info.thread_count);
+            alive_workers++;
+        }
+        if (alive_workers == 0)
+            Throw("render_distributed(): no usable workers remain!");
+
+        Log(Info, "Starting distributed render job (%ix%i, %i sample%s,%s %i worker%s)",
+            film_size.x(), film_size.y(),
+            total_spp, total_spp == 1 ? "" : "s",
+            n_passes > 1 ? tfm::format(" %d passes,", n_passes) : "",
+            alive_workers, alive_workers == 1 ? "" : "s");
+
+        if (m_timeout > 0.f)
+            Log(Info, "Timeout specified: %.2f seconds.", m_timeout);
+
+        Spiral spiral(film, m_block_size, n_passes);
+
+        ref<ProgressReporter> progress = new ProgressReporter("Rendering");
+        double pixels_total = std::max(1.0, (double) hprod(film_size) * n_passes),
+               pixels_done  = 0.0;
+
+        /* Orders handed out but not yet merged into the film, keyed by the
+           scheduler's block id. An order only leaves this map upon merging,
+           hence orders lost to failed workers are re-dispatched eventually. */
+        std::unordered_map<uint32_t, BlockOrder> outstanding;
+        std::unordered_set<uint32_t> completed;
+        bool exhausted = false;
+
+        // Pull the next batch of work orders for the given worker
+        auto next_batch = [&](const Worker &w) {
+            std::vector<BlockOrder> batch;
+            while (batch.size() < w.batch_size && !exhausted) {
+                size_t block_id = 0;
+                auto [offset, size] = spiral.next_block(&block_id);
+                if (hprod(size) == 0) {
+                    exhausted = true;
+                    break;
+                }
+
+                BlockOrder order;
+                order.index    = (uint32_t) block_id;
+                order.offset_x = offset.x();
+                order.offset_y = offset.y();
+                order.size_x   = size.x();
+                order.size_y   = size.y();
+                order.seed     = (uint64_t) (m_seed_offset + block_id);
+                order.spp      = (uint32_t) samples_per_pass;
+
+                outstanding[order.index] = order;
+                batch.push_back(order);
+            }
+
+            /* Straggler re-dispatch: when the scheduler runs dry, duplicate
+               orders that other workers have not returned yet. Seeds are
+               deterministic, so whichever copy arrives first is kept and
+               later duplicates are simply dropped. */
+            if (batch.empty()) {
+                for (const auto &kv : outstanding) {
+                    bool own = false;
+                    for (const BlockOrder &o : w.in_flight)
+                        own |= o.index == kv.first;
+                    if (own)
+                        continue;
+                    batch.push_back(kv.second);
+                    if (batch.size() >= w.batch_size)
+                        break;
+                }
+            }
+            return batch;
+        };
+
+        ref<ImageBlock> block = new ImageBlock(m_block_size, channels.size(),
+                                               film->reconstruction_filter(),
+                                               !has_aovs);
+
+        // Merge a worker reply into the film
+        auto merge_reply = [&](const std::vector<zmq::message> &parts) {
+            for (size_t i = 0; i + 1 < parts.size(); i += 2) {
+                const BlockOrder &order = detail::part_as<BlockOrder>(parts[i]);
+                if (completed.find(order.index) != completed.end())
+                    continue; // Duplicate result of a re-dispatched block
+
+                block->set_size(ScalarVector2i(order.size_x, order.size_y));
+                block->set_offset(ScalarPoint2i(order.offset_x, order.offset_y));
+
+                size_t n_bytes = channels.size() *
+                    hprod(block->size() + 2 * block->border_size()) *
+                    sizeof(ScalarFloat);
+                detail::decompress_block(parts[i + 1].data(),
+                                         parts[i + 1].size(),
+                                         block->data().managed().data(),
+                                         n_bytes);
+                film->put(block);
+
+                completed.insert(order.index);
+                outstanding.erase(order.index);
+                pixels_done += order.size_x * (double) order.size_y;
+                progress->update(pixels_done / pixels_total);
+            }
+        };
+
+        m_render_timer.reset();
+
+        while (!should_stop()) {
+            // Hand a fresh batch to every idle worker
+            for (Worker &w : pool) {
+                if (!w.alive || w.busy)
+                    continue;
+                auto batch = next_batch(w);
+                if (batch.empty())
+                    continue;
+
+                w.socket.sendmore(std::string("render"));
+                for (size_t i = 0; i < batch.size(); ++i) {
+                    if (i + 1 < batch.size())
+                        w.socket.sendmore(batch[i]);
+                    else
+                        w.socket.send(batch[i]);
+                }
+                w.in_flight = std::move(batch);
+                w.busy = true;
+            }
+
+            if (exhausted && outstanding.empty())
+                break; // All blocks have been merged
+
+            std::vector<zmq::pollitem> items;
+            std::vector<Worker *> item_workers;
+            for (Worker &w : pool) {
+                if (!w.alive || !w.busy)
+                    continue;
+                items.push_back({ (void *) w.socket, 0, zmq::pollin, 0 });
+                item_workers.push_back(&w);
+            }
+            if (items.empty())
+                Throw("render_distributed(): all workers failed with %i "
+                      "block%s left to render!", outstanding.size(),
+                      outstanding.size() == 1 ? "" : "s");
+
+            /* Wake up periodically even without replies so that timeouts
+               and cancellation are enforced accurately */
+            zmq::poll(items, std::chrono::milliseconds(500));
+
+            for (size_t i = 0; i < items.size(); ++i) {
+                if (!(items[i].revents & zmq::pollin))
+                    continue;
+                Worker &w = *item_workers[i];
+
+                std::string status;
+                w.socket.recv(status);
+                auto parts = detail::recv_parts(w.socket);
+                w.busy = false;
+                w.in_flight.clear();
+
+                if (status == "ok") {
+                    merge_reply(parts);
+                } else {
+                    /* The orders of the failed batch remain outstanding and
+                       are re-dispatched to the surviving workers */
+                    Log(Warn, "Worker \"%s\" failed: %s -- dropping it.",
+                        w.address, detail::part_as_string(parts[0]));
+                    w.alive = false;
+                }
+            }
+        }
+
+        if (!m_stop)
+            Log(Info, "Rendering finished. (took %s)",
+                util::time_string(m_render_timer.value(), true));
+
+        return !m_stop;
+    }
+}
+
+NAMESPACE_END(mitsuba)
@@ -1,6 +1,7 @@
 #include <mitsuba/render/kdtree.h>
 #include <mitsuba/render/mesh.h>
 #include <mitsuba/core/properties.h>
+#include <algorithm>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -44,10 +45,97 @@ MTS_VARIANT ShapeKDTree<Float, Spectrum>::ShapeKDTree(const Properties &props)
     if (props.has_property("kd_exact_primitive_threshold"))
         set_exact_primitive_threshold(props.int_("kd_exact_primitive_threshold"));
 
+    /* kd-tree construction: re-pack the node array into cache-line-sized
+       clusters after the build. Traversal of large trees is memory-bound,
+       which makes the extra build time worthwhile for final frames. */
+    if (props.has_property("kd_compact"))
+        set_compact_tree(props.bool_("kd_compact"));
+
+    /* Two-level acceleration: build a BVH over the shape bounding boxes and
+       a separate kd-tree per mesh (lazily, upon the first hit) rather than
+       one monolithic tree over all primitives of the scene */
+    m_two_level = props.bool_("kd_two_level", false);
+
+    /* Two-level acceleration: construct all per-mesh kd-trees up front (in
+       parallel) instead of on first hit. Recommended for final frames, where
+       every shape is eventually hit anyway and the lazy builds would be paid
+       for during the first sample pass. */
+    m_eager_build = props.bool_("kd_eager_build", false);
+
+    /* Precompute per-triangle intersection data (a plane equation and two
+       barycentric edge equations) for all meshes, so that candidate tests
+       during traversal avoid re-deriving them from the indexed vertex
+       buffers. Costs 48 bytes per triangle. */
+    m_precompute_triangles = props.bool_("kd_precompute_triangles", false);
+
+    m_primitive_map.push_back(0);
+}
+
+MTS_VARIANT ShapeKDTree<Float, Spectrum>::ShapeKDTree(
+    const SurfaceAreaHeuristic3f &model)
+    : Base(model), m_two_level(false), m_eager_build(false),
+      m_precompute_triangles(false) {
     m_primitive_map.push_back(0);
 }
 
+MTS_VARIANT ShapeKDTree<Float, Spectrum>::~ShapeKDTree() {
+    clear_subtrees();
+}
+
+MTS_VARIANT void ShapeKDTree<Float, Spectrum>::clear_subtrees() {
+    if (!m_subtrees)
+        return;
+    for (size_t i = 0; i < m_shapes.size(); ++i) {
+        ShapeKDTree *tree = m_subtrees[i].exchange(nullptr);
+        if (tree)
+            tree->dec_ref();
+    }
+}
+
 MTS_VARIANT void ShapeKDTree<Float, Spectrum>::build() {
+    if (m_precompute_triangles) {
+        /* Each builder parallelizes internally; displaced meshes skip the
+           request and keep intersecting their micro-tessellations */
+        for (auto &shape : m_shapes)
+            if (shape->is_mesh())
+                ((Mesh *) shape.get())->build_intersection_data();
+    }
+
+    if (m_two_level) {
+        Timer timer;
+
+        if (!m_subtrees) {
+            m_subtrees.reset(new std::atomic<ShapeKDTree *>[m_shapes.size()]);
+            for (size_t i = 0; i < m_shapes.size(); ++i)
+                m_subtrees[i].store(nullptr, std::memory_order_relaxed);
+            m_subtree_mutexes.reset(new std::mutex[m_shapes.size()]);
+        }
+
+        build_top_level();
+
+        if (m_eager_build) {
+            /* Builds of distinct shapes are independent; subtree() merely
+               serializes concurrent requests for the same tree */
+            tbb::parallel_for(
+                tbb::blocked_range<Size>(0, (Size) m_shapes.size(), 1),
+                [this](const tbb::blocked_range<Size> &range) {
+                    for (Size i = range.begin(); i != range.end(); ++i)
+                        (void) subtree(i);
+                });
+
+            Log(Info, "Built a top-level BVH over %i shapes (%i nodes) and "
+                      "%i per-shape kd-trees (took %s).",
+                shape_count(), m_top_nodes.size(), m_shapes.size(),
+                util::time_string(timer.value()));
+        } else {
+            Log(Info, "Built a top-level BVH over %i shapes (%i nodes, took %s); "
+                      "per-shape kd-trees are constructed on first hit.",
+                shape_count(), m_top_nodes.size(),
+                util::time_string(timer.value()));
+        }
+        return;
+    }
+
     Timer timer;
     Log(Info, "Building a SAH kd-tree (%i primitives) ..",
         primitive_count());
@@ -61,6 +149,221 @@ MTS_VARIANT void ShapeKDTree<Float, Spectrum>::build() {
     );
 }
 
+MTS_VARIANT void ShapeKDTree<Float, Spectrum>::build_top_level() {
+    struct BuildPrim {
+        Index index;
+        ScalarBoundingBox3f bbox;
+        ScalarPoint3f center;
+    };
+
+    std::vector<BuildPrim> prims;
+    prims.reserve(m_shapes.size());
+    for (Index i = 0; i < (Index) m_shapes.size(); ++i) {
+        BuildPrim bp;
+        bp.index  = i;
+        bp.bbox   = m_shapes[i]->bbox();
+        bp.center = bp.bbox.center();
+        prims.push_back(bp);
+    }
+
+    m_top_nodes.clear();
+    m_top_shapes.clear();
+    m_top_nodes.reserve(2 * prims.size());
+    m_top_shapes.reserve(prims.size());
+
+    /* Median split over the centroid bounds: trivially cheap compared to a
+       SAH build, produces a balanced tree whose depth stays within the
+       traversal stack bound, and is good enough for the coarse shape level
+       (the heavy lifting happens inside the per-shape trees) */
+    struct WorkItem { Index node; size_t begin, end; };
+    std::vector<WorkItem> work;
+    m_top_nodes.emplace_back();
+    work.push_back({ 0, 0, prims.size() });
+
+    while (!work.empty()) {
+        WorkItem item = work.back();
+        work.pop_back();
+
+        BVHNode node;
+        ScalarBoundingBox3f centroid_bounds;
+        for (size_t i = item.begin; i != item.end; ++i) {
+            node.bbox.expand(prims[i].bbox);
+            centroid_bounds.expand(prims[i].center);
+        }
+
+        size_t count = item.end - item.begin;
+        if (count <= 4) { // Create a leaf node
+            node.offset = (Index) m_top_shapes.size();
+            node.count  = (Index) count;
+            for (size_t i = item.begin; i != item.end; ++i)
+                m_top_shapes.push_back(prims[i].index);
+        } else {
+            uint32_t axis = centroid_bounds.major_axis();
+            size_t mid = item.begin + count / 2;
+            std::nth_element(
+                prims.begin() + item.begin, prims.begin() + mid,
+                prims.begin() + item.end,
+                [axis](const BuildPrim &a, const BuildPrim &b) {
+                    return a.center[axis] < b.center[axis];
+                });
+
+            node.offset = (Index) m_top_nodes.size();
+            node.count  = 0;
+            m_top_nodes.emplace_back();
+            m_top_nodes.emplace_back();
+            work.push_back({ node.offset,     item.begin, mid });
+            work.push_back({ Index(node.offset + 1), mid, item.end });
+        }
+
+        m_top_nodes[item.node] = node;
+    }
+}
+
+MTS_VARIANT void ShapeKDTree<Float, Spectrum>::update() {
+    if (m_two_level) {
+        Size dirty_shapes = 0;
+        for (size_t i = 0; i < m_shapes.size(); ++i) {
+            if (!m_shapes[i]->dirty())
+                continue;
+            ++dirty_shapes;
+            /* Discard the stale subtree -- it is rebuilt lazily upon the
+               next hit. Subtrees of unmodified shapes remain untouched. */
+            ShapeKDTree *tree = m_subtrees[i].exchange(nullptr);
+            if (tree)
+                tree->dec_ref();
+            m_shapes[i]->clear_dirty();
+        }
+
+        if (dirty_shapes == 0)
+            return;
+
+        Timer timer;
+        build_top_level();
+
+        m_bbox.reset();
+        for (Shape *shape : m_shapes)
+            m_bbox.expand(shape->bbox());
+
+        Log(Info, "Rebuilt the top-level BVH (%i/%i shapes moved, took %s)",
+            dirty_shapes, shape_count(), util::time_string(timer.value()));
+        return;
+    }
+
+    // Determine which primitives moved since the last build/update
+    Size dirty_prims = 0;
+    std::vector<bool> shape_dirty(m_shapes.size());
+    for (size_t i = 0; i < m_shapes.size(); ++i) {
+        shape_dirty[i] = m_shapes[i]->dirty();
+        if (shape_dirty[i])
+            dirty_prims += m_primitive_map[i + 1] - m_primitive_map[i];
+    }
+
+    if (dirty_prims == 0)
+        return;
+
+    /* When the majority of the scene moved, the old spatial subdivision is
+       a poor fit for the new geometry -- rebuild from scratch instead. */
+    if (!ready() || dirty_prims * 2 > primitive_count()) {
+        m_nodes.reset();
+        m_indices.reset();
+        m_numa_replicas.clear();
+        m_node_count = m_index_count = 0;
+        m_bbox.reset();
+        for (Shape *shape : m_shapes)
+            m_bbox.expand(shape->bbox());
+        build();
+        for (Shape *shape : m_shapes)
+            shape->clear_dirty();
+        return;
+    }
+
+    Timer timer;
+    Log(Info, "Refitting the SAH kd-tree (%i/%i primitives moved) ..",
+        dirty_prims, primitive_count());
+
+    /* Pass 1: collect the per-leaf primitive lists, keeping the entries of
+       unmodified shapes and dropping those of modified ones */
+    std::vector<std::vector<Index>> leaf_prims(m_node_count);
+    for (Size i = 0; i < m_node_count; ++i) {
+        const KDNode &node = m_nodes[i];
+        if (!node.leaf())
+            continue;
+        std::vector<Index> &list = leaf_prims[i];
+        for (Index j = 0; j < node.primitive_count(); ++j) {
+            Index prim_index = m_indices[node.primitive_offset() + j],
+                  temp       = prim_index;
+            if (!shape_dirty[find_shape(temp)])
+                list.push_back(prim_index);
+        }
+    }
+
+    /* Pass 2: re-bin the primitives of modified shapes starting from the
+       root. The split planes remain fixed; a primitive is sent down every
+       child whose half-space its bounding box touches, which keeps
+       traversal correct for arbitrary motion (the tree quality degrades
+       gracefully and is restored by the next full build). */
+    Size stack[MTS_KD_MAXDEPTH];
+    for (size_t s = 0; s < m_shapes.size(); ++s) {
+        if (!shape_dirty[s])
+            continue;
+        m_bbox.expand(m_shapes[s]->bbox());
+        for (Index prim = m_primitive_map[s];
+             prim != m_primitive_map[s + 1]; ++prim) {
+            ScalarBoundingBox3f prim_bbox = bbox(prim);
+            int32_t stack_index = 0;
+            stack[stack_index++] = 0;
+            while (stack_index > 0) {
+                Size node_index = stack[--stack_index];
+                const KDNode &node = m_nodes[node_index];
+                if (node.leaf()) {
+                    leaf_prims[node_index].push_back(prim);
+                    continue;
+                }
+                Index axis = node.axis();
+                if (prim_bbox.min[axis] <= node.split())
+                    stack[stack_index++] = node_index + node.left_offset();
+                if (prim_bbox.max[axis] >= node.split())
+                    stack[stack_index++] = node_index + node.left_offset() + 1;
+            }
+        }
+    }
+
+    // Pass 3: rebuild the flattened index list and rewrite the leaf nodes
+    size_t index_count = 0;
+    for (Size i = 0; i < m_node_count; ++i)
+        if (m_nodes[i].leaf())
+            index_count += leaf_prims[i].size();
+
+    m_indices.reset(new Index[index_count]);
+    m_index_count = Size(index_count);
+
+    size_t offset = 0;
+    for (Size i = 0; i < m_node_count; ++i) {
+        KDNode &node = m_nodes[i];
+        if (!node.leaf())
+            continue;
+        const std::vector<Index> &list = leaf_prims[i];
+        memcpy(m_indices.get() + offset, list.data(),
+               list.size() * sizeof(Index));
+        if (!node.set_leaf_node(offset, list.size()))
+            Throw("Internal error during kd-tree refit: could not create "
+                  "leaf node with %i primitives!", list.size());
+        offset += list.size();
+    }
+
+    // Refresh the NUMA-local tree copies, if any
+    replicate_numa();
+
+    for (Shape *shape : m_shapes)
+        shape->clear_dirty();
+
+    Log(Info, "Finished. (%s of storage, took %s)",
+        util::mem_string(m_index_count * sizeof(Index) +
+                        m_node_count * sizeof(KDNode)),
+        util::time_string(timer.value())
+    );
+}
+
 MTS_VARIANT void ShapeKDTree<Float, Spectrum>::add_shape(Shape *shape) {
     Assert(!ready());
     m_primitive_map.push_back(m_primitive_map.back() +
@@ -0,0 +1,376 @@
+#include <mitsuba/core/transform.h>
+#include <mitsuba/render/emitter.h>
+#include <mitsuba/render/lightbvh.h>
+#include <mitsuba/render/shape.h>
+#include <algorithm>
+
+NAMESPACE_BEGIN(mitsuba)
+
+template <typename Float, typename Spectrum>
+struct LightBVH<Float, Spectrum>::BuildPrim {
+    uint32_t index;
+    ScalarBoundingBox3f bbox;
+    ScalarPoint3f center;
+    ScalarFloat power;
+};
+
+MTS_VARIANT LightBVH<Float, Spectrum>::LightBVH(
+    const host_vector<ref<Emitter>, Float> &emitters,
+    const ScalarBoundingBox3f &scene_bbox) {
+
+    std::vector<BuildPrim> prims;
+    prims.reserve(emitters.size());
+    m_trail.resize(emitters.size(), 0);
+    m_emitter_index.reserve(emitters.size());
+
+    for (uint32_t i = 0; i < (uint32_t) emitters.size(); ++i) {
+        const Emitter *emitter = emitters[i].get();
+
+        BuildPrim bp;
+        bp.index = i;
+        emitter_extents(emitter, scene_bbox, bp.bbox, bp.power);
+        bp.center = bp.bbox.center();
+        prims.push_back(bp);
+
+        m_emitter_index[emitter] = i;
+    }
+
+    // Slot for the root node; children are appended during construction
+    m_node_data.resize(NodeStride, 0.f);
+    m_node_child.resize(1, 0);
+    m_node_offset.resize(1, 0);
+    m_node_count.resize(1, 0);
+    m_prim_index.reserve(prims.size());
+    m_prim_power.reserve(prims.size());
+
+    build_node(0, prims.data(), prims.data() + prims.size(), 0, 0);
+
+    Log(Debug, "Built light hierarchy over %i emitters (%i nodes)",
+        prims.size(), m_node_child.size());
+}
+
+MTS_VARIANT LightBVH<Float, Spectrum>::~LightBVH() { }
+
+MTS_VARIANT void LightBVH<Float, Spectrum>::emitter_extents(
+    const Emitter *emitter, const ScalarBoundingBox3f &scene_bbox,
+    ScalarBoundingBox3f &bbox, ScalarFloat &power) const {
+
+    bbox = ScalarBoundingBox3f();
+    if (emitter->shape()) {
+        bbox = emitter->shape()->bbox();
+    } else if (has_flag(emitter->flags(), EmitterFlags::Infinite)) {
+        /* Infinite emitters occupy no particular region of space -- use
+           the scene bounds so that their importance becomes effectively
+           position-independent */
+        bbox = scene_bbox;
+    } else {
+        // Delta position emitters
+        bbox.expand(emitter->world_transform()->eval(0.f) *
+                    ScalarPoint3f(0.f));
+    }
+    if (!bbox.valid())
+        bbox = scene_bbox;
+
+    /* Clamp the power estimate so that every emitter remains selectable
+       with nonzero probability */
+    power = std::max(emitter->power_estimate(),
+                     math::Epsilon<ScalarFloat>);
+}
+
+MTS_VARIANT void LightBVH<Float, Spectrum>::refit(
+    const host_vector<ref<Emitter>, Float> &emitters,
+    const ScalarBoundingBox3f &scene_bbox) {
+
+    if (emitters.size() != m_trail.size())
+        Throw("LightBVH::refit(): the emitter list changed (%i vs %i "
+              "entries), the hierarchy must be rebuilt instead!",
+              emitters.size(), m_trail.size());
+
+    // Refresh the per-emitter inputs referenced by the leaves
+    std::vector<ScalarBoundingBox3f> prim_bbox(m_prim_index.size());
+    for (size_t i = 0; i < m_prim_index.size(); ++i)
+        emitter_extents(emitters[m_prim_index[i]].get(), scene_bbox,
+                        prim_bbox[i], m_prim_power[i]);
+
+    /* Children are appended after their parent during construction, so a
+       reverse sweep visits every node after both of its children */
+    for (uint32_t node = (uint32_t) m_node_child.size(); node-- > 0; ) {
+        ScalarBoundingBox3f bbox;
+        ScalarFloat power = 0.f;
+
+        uint32_t child = m_node_child[node];
+        if (child == 0) {
+            uint32_t offset = m_node_offset[node],
+                     count  = m_node_count[node];
+            for (uint32_t i = 0; i < count; ++i) {
+                bbox.expand(prim_bbox[offset + i]);
+                power += m_prim_power[offset + i];
+            }
+        } else {
+            for (uint32_t c = child; c <= child + 1; ++c) {
+                const ScalarFloat *d = m_node_data.data() + c * NodeStride;
+                bbox.expand(ScalarPoint3f(d[0], d[1], d[2]));
+                bbox.expand(ScalarPoint3f(d[3], d[4], d[5]));
+                power += d[6];
+            }
+        }
+
+        ScalarFloat *data = m_node_data.data() + node * NodeStride;
+        for (int i = 0; i < 3; ++i) {
+            data[i]     = bbox.min[i];
+            data[i + 3] = bbox.max[i];
+        }
+        data[6] = power;
+    }
+}
+
+MTS_VARIANT void LightBVH<Float, Spectrum>::build_node(
+    uint32_t node, BuildPrim *begin, BuildPrim *end, uint32_t depth,
+    uint32_t trail) {
+
+    size_t prim_count = (size_t) (end - begin);
+
+    ScalarBoundingBox3f bbox;
+    ScalarFloat power = 0.f;
+    for (BuildPrim *it = begin; it != end; ++it) {
+        bbox.expand(it->bbox);
+        power += it->power;
+    }
+
+    ScalarFloat *data = m_node_data.data() + node * NodeStride;
+    for (int i = 0; i < 3; ++i) {
+        data[i]     = bbox.min[i];
+        data[i + 3] = bbox.max[i];
+    }
+    data[6] = power;
+
+    if (prim_count <= LeafSize || depth + 1 >= MaxDepth) {
+        m_node_child[node]  = 0;
+        m_node_offset[node] = (uint32_t) m_prim_index.size();
+        m_node_count[node]  = (uint32_t) prim_count;
+        for (BuildPrim *it = begin; it != end; ++it) {
+            m_prim_index.push_back(it->index);
+            m_prim_power.push_back(it->power);
+            m_trail[it->index] = trail;
+        }
+        return;
+    }
+
+    // Split at the median along the axis with the largest centroid extent
+    ScalarBoundingBox3f centroid_bbox;
+    for (BuildPrim *it = begin; it != end; ++it)
+        centroid_bbox.expand(it->center);
+    uint32_t axis = centroid_bbox.major_axis();
+
+    BuildPrim *mid = begin + prim_count / 2;
+    std::nth_element(begin, mid, end,
+                     [axis](const BuildPrim &a, const BuildPrim &b) {
+                         return a.center[axis] < b.center[axis];
+                     });
+
+    uint32_t left = (uint32_t) m_node_child.size();
+    m_node_child[node] = left;
+
+    m_node_data.resize(m_node_data.size() + 2 * NodeStride, 0.f);
+    m_node_child.resize(m_node_child.size() + 2, 0);
+    m_node_offset.resize(m_node_offset.size() + 2, 0);
+    m_node_count.resize(m_node_count.size() + 2, 0);
+
+    build_node(left,     begin, mid, depth + 1, trail);
+    build_node(left + 1, mid,   end, depth + 1, trail | (1u << depth));
+}
+
+MTS_VARIANT Float LightBVH<Float, Spectrum>::node_importance(
+    const Point3f &p, const UInt32 &index, const Mask &active) const {
+    if constexpr (is_cuda_array_v<Float>) {
+        ENOKI_MARK_USED(p);
+        ENOKI_MARK_USED(index);
+        ENOKI_MARK_USED(active);
+        NotImplementedError("node_importance");
+    } else {
+        const ScalarFloat *data = m_node_data.data();
+        UInt32 offset = index * NodeStride;
+
+        Point3f bbox_min(gather<Float>(data, offset + 0u, active),
+                         gather<Float>(data, offset + 1u, active),
+                         gather<Float>(data, offset + 2u, active)),
+                bbox_max(gather<Float>(data, offset + 3u, active),
+                         gather<Float>(data, offset + 4u, active),
+                         gather<Float>(data, offset + 5u, active));
+        Float power = gather<Float>(data, offset + 6u, active);
+
+        /* Squared distance to the closest point of the node's bounding box,
+           clamped below by a quarter of the squared bbox diagonal to keep
+           the importance bounded when the reference point lies inside */
+        Float d2 = squared_norm(p - min(max(p, bbox_min), bbox_max));
+        d2 = max(max(d2, .25f * squared_norm(bbox_max - bbox_min)),
+                 math::Epsilon<Float>);
+
+        return power * rcp(d2);
+    }
+}
+
+MTS_VARIANT std::tuple<typename LightBVH<Float, Spectrum>::UInt32, Float, Float>
+LightBVH<Float, Spectrum>::sample_emitter(const Point3f &p, Float sample_,
+                                          Mask active) const {
+    if constexpr (is_cuda_array_v<Float>) {
+        ENOKI_MARK_USED(p);
+        ENOKI_MARK_USED(sample_);
+        ENOKI_MARK_USED(active);
+        NotImplementedError("sample_emitter");
+    } else {
+        Float sample(sample_), pdf(1.f);
+        UInt32 node = zero<UInt32>();
+
+        // Stochastically descend into the subtree with higher importance
+        Mask running = active;
+        while (true) {
+            UInt32 child = gather<UInt32>(m_node_child.data(), node, running);
+            running &= neq(child, 0u);
+            if (none(running))
+                break;
+
+            Float w_left  = node_importance(p, child, running),
+                  w_right = node_importance(p, child + 1u, running),
+                  w_sum   = w_left + w_right;
+
+            Float p_left = select(w_sum > 0.f, w_left / w_sum, .5f);
+            Mask go_left = sample < p_left;
+
+            masked(pdf, running) = pdf * select(go_left, p_left, 1.f - p_left);
+            masked(sample, running) = min(
+                select(go_left, sample / p_left,
+                       (sample - p_left) / (1.f - p_left)),
+                math::OneMinusEpsilon<Float>);
+            masked(node, running) = select(go_left, child, child + 1u);
+        }
+
+        // Pick one of the emitters within the leaf in proportion to its power
+        UInt32 offset = gather<UInt32>(m_node_offset.data(), node, active),
+               count  = gather<UInt32>(m_node_count.data(), node, active);
+        uint32_t max_count = (uint32_t) hmax(count);
+
+        Float total = zero<Float>();
+        for (uint32_t i = 0; i < max_count; ++i) {
+            Mask valid = active && i < count;
+            total += select(
+                valid, gather<Float>(m_prim_power.data(), offset + i, valid),
+                0.f);
+        }
+
+        Float target = sample * total,
+              cum    = zero<Float>(),
+              below  = zero<Float>(),
+              weight = zero<Float>();
+        UInt32 slot = offset;
+        Mask found = false;
+
+        for (uint32_t i = 0; i < max_count; ++i) {
+            Mask valid = active && i < count;
+            Float w = select(
+                valid, gather<Float>(m_prim_power.data(), offset + i, valid),
+                0.f);
+            Mask pick = valid && !found && (cum + w > target || eq(count, i + 1u));
+            masked(slot, pick)   = offset + i;
+            masked(weight, pick) = w;
+            masked(below, pick)  = cum;
+            found |= pick;
+            cum += w;
+        }
+
+        masked(pdf, active) = pdf * weight / total;
+        Float sample_reused = clamp((target - below) / weight, 0.f,
+                                    math::OneMinusEpsilon<Float>);
+        UInt32 index = gather<UInt32>(m_prim_index.data(), slot, active);
+
+        return { index, pdf, sample_reused };
+    }
+}
+
+MTS_VARIANT Float LightBVH<Float, Spectrum>::pdf_emitter(
+    const Point3f &p, const EmitterPtr &emitter, Mask active) const {
+    if constexpr (is_cuda_array_v<Float>) {
+        ENOKI_MARK_USED(p);
+        ENOKI_MARK_USED(emitter);
+        ENOKI_MARK_USED(active);
+        NotImplementedError("pdf_emitter");
+    } else {
+        // Map the emitter pointers back to their indices within the scene
+        UInt32 em_idx = zero<UInt32>();
+        Mask valid = active;
+        if constexpr (is_array_v<EmitterPtr>) {
+            for (size_t i = 0; i < EmitterPtr::Size; ++i) {
+                auto it = m_emitter_index.find(emitter.coeff(i));
+                if (it != m_emitter_index.end())
+                    em_idx.coeff(i) = it->second;
+                else
+                    valid.coeff(i) = false;
+            }
+        } else {
+            auto it = m_emitter_index.find(emitter);
+            if (it != m_emitter_index.end())
+                em_idx = it->second;
+            else
+                valid = false;
+        }
+
+        /* Replay the stochastic descent along the recorded trail of the
+           target emitter, accumulating the selection probability */
+        UInt32 trail = gather<UInt32>(m_trail.data(), em_idx, valid);
+        UInt32 node = zero<UInt32>();
+        Float pdf = select(valid, Float(1.f), Float(0.f));
+
+        Mask running = valid;
+        while (true) {
+            UInt32 child = gather<UInt32>(m_node_child.data(), node, running);
+            running &= neq(child, 0u);
+            if (none(running))
+                break;
+
+            Float w_left  = node_importance(p, child, running),
+                  w_right = node_importance(p, child + 1u, running),
+                  w_sum   = w_left + w_right;
+
+            Float p_left = select(w_sum > 0.f, w_left / w_sum, .5f);
+            Mask go_left = eq(trail & 1u, 0u);
+
+            masked(pdf, running)   = pdf * select(go_left, p_left, 1.f - p_left);
+            masked(node, running)  = select(go_left, child, child + 1u);
+            masked(trail, running) = sr<1>(trail);
+        }
+
+        // Discrete probability of the emitter within its leaf
+        UInt32 offset = gather<UInt32>(m_node_offset.data(), node, valid),
+               count  = gather<UInt32>(m_node_count.data(), node, valid);
+        uint32_t max_count = (uint32_t) hmax(count);
+
+        Float total  = zero<Float>(),
+              weight = zero<Float>();
+        for (uint32_t i = 0; i < max_count; ++i) {
+            Mask in_leaf = valid && i < count;
+            Float w = select(
+                in_leaf, gather<Float>(m_prim_power.data(), offset + i, in_leaf),
+                0.f);
+            Mask match = in_leaf &&
+                eq(gather<UInt32>(m_prim_index.data(), offset + i, in_leaf),
+                   em_idx);
+            masked(weight, match) = w;
+            total += w;
+        }
+
+        return select(valid, pdf * weight / total, 0.f);
+    }
+}
+
+MTS_VARIANT std::string LightBVH<Float, Spectrum>::to_string() const {
+    std::ostringstream oss;
+    oss << "LightBVH[" << std::endl
+        << "  emitter_count = " << m_prim_index.size() << "," << std::endl
+        << "  node_count = " << m_node_child.size() << std::endl
+        << "]";
+    return oss.str();
+}
+
+MTS_IMPLEMENT_CLASS_VARIANT(LightBVH, Object)
+MTS_INSTANTIATE_CLASS(LightBVH)
+NAMESPACE_END(mitsuba)
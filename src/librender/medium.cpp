@@ -2,6 +2,7 @@
 #include <mitsuba/core/properties.h>
 #include <mitsuba/render/medium.h>
 #include <mitsuba/render/phase.h>
+#include <mitsuba/render/sampler.h>
 #include <mitsuba/render/scene.h>
 #include <mitsuba/render/texture.h>
 
@@ -33,6 +34,7 @@ typename Medium<Float, Spectrum>::MediumInteraction3f
 Medium<Float, Spectrum>::sample_interaction(const Ray3f &ray, Float sample,
                                             UInt32 channel, Mask active) const {
     MTS_MASKED_FUNCTION(ProfilerPhase::MediumSample, active);
+    MTS_STAT_ADD(MediumSamples, count(active));
 
     // initialize basic medium interaction fields
     MediumInteraction3f mi;
@@ -71,6 +73,84 @@ Medium<Float, Spectrum>::sample_interaction(const Ray3f &ray, Float sample,
     return mi;
 }
 
+MTS_VARIANT
+typename Medium<Float, Spectrum>::MediumInteraction3f
+Medium<Float, Spectrum>::sample_interaction_equiangular(const Ray3f &ray,
+                                                        const Point3f &pivot,
+                                                        Float sample,
+                                                        Mask active) const {
+    MTS_MASKED_FUNCTION(ProfilerPhase::MediumSample, active);
+    MTS_STAT_ADD(MediumSamples, count(active));
+
+    // initialize basic medium interaction fields
+    MediumInteraction3f mi;
+    mi.sh_frame    = Frame3f(ray.d);
+    mi.wi          = -ray.d;
+    mi.time        = ray.time;
+    mi.wavelengths = ray.wavelengths;
+
+    auto [aabb_its, mint, maxt] = intersect_aabb(ray);
+    aabb_its &= (enoki::isfinite(mint) || enoki::isfinite(maxt));
+    active &= aabb_its;
+    masked(mint, !active) = 0.f;
+    masked(maxt, !active) = math::Infinity<Float>;
+
+    mint = max(ray.mint, mint);
+    maxt = min(ray.maxt, maxt);
+
+    /* Decompose the pivot into a signed distance along the ray and the
+       (clamped) perpendicular distance to it */
+    Float delta = dot(pivot - ray.o, ray.d),
+          d     = max(norm(pivot - ray(delta)), math::RayEpsilon<Float>);
+
+    Float theta_a = atan((mint - delta) / d),
+          theta_b = atan((maxt - delta) / d),
+          theta   = theta_a + (theta_b - theta_a) * sample;
+
+    Float sampled_t = clamp(delta + d * tan(theta), mint, maxt);
+    mi.t            = select(active, sampled_t, math::Infinity<Float>);
+    mi.p            = ray(sampled_t);
+    mi.medium       = this;
+    mi.mint         = mint;
+    std::tie(mi.sigma_s, mi.sigma_n, mi.sigma_t) =
+        get_scattering_coefficients(mi, active);
+    mi.combined_extinction = get_combined_extinction(mi, active);
+    return mi;
+}
+
+MTS_VARIANT
+std::pair<typename Medium<Float, Spectrum>::Float,
+          typename Medium<Float, Spectrum>::Float>
+Medium<Float, Spectrum>::pdf_equiangular(const Ray3f &ray, const Point3f &pivot,
+                                         Float t, Mask active) const {
+    MTS_MASKED_FUNCTION(ProfilerPhase::MediumEvaluate, active);
+
+    auto [aabb_its, mint, maxt] = intersect_aabb(ray);
+    aabb_its &= (enoki::isfinite(mint) || enoki::isfinite(maxt));
+    active &= aabb_its;
+    masked(mint, !active) = 0.f;
+    masked(maxt, !active) = math::Infinity<Float>;
+
+    mint = max(ray.mint, mint);
+    maxt = min(ray.maxt, maxt);
+
+    Float delta = dot(pivot - ray.o, ray.d),
+          d     = max(norm(pivot - ray(delta)), math::RayEpsilon<Float>);
+
+    Float theta_a = atan((mint - delta) / d),
+          theta_b = atan((maxt - delta) / d),
+          extent  = theta_b - theta_a;
+
+    Float t_c   = clamp(t, mint, maxt),
+          theta = atan((t_c - delta) / d);
+
+    active &= extent > 0.f;
+    Float pdf = select(active && t >= mint && t <= maxt,
+                       d / (extent * (sqr(d) + sqr(t_c - delta))), 0.f),
+          beyond = select(active, (theta_b - theta) / extent, 0.f);
+    return { pdf, beyond };
+}
+
 MTS_VARIANT
 std::pair<typename Medium<Float, Spectrum>::UnpolarizedSpectrum,
           typename Medium<Float, Spectrum>::UnpolarizedSpectrum>
@@ -85,6 +165,57 @@ Medium<Float, Spectrum>::eval_tr_and_pdf(const MediumInteraction3f &mi,
     return { tr, pdf };
 }
 
+MTS_VARIANT
+typename Medium<Float, Spectrum>::UnpolarizedSpectrum
+Medium<Float, Spectrum>::eval_transmittance(const Ray3f &ray, Sampler *sampler,
+                                            UInt32 channel, Mask active) const {
+    MTS_MASKED_FUNCTION(ProfilerPhase::MediumEvaluate, active);
+
+    auto [aabb_its, mint, maxt] = intersect_aabb(ray);
+    aabb_its &= (enoki::isfinite(mint) || enoki::isfinite(maxt));
+    active &= aabb_its;
+
+    mint = max(ray.mint, mint);
+    maxt = min(ray.maxt, maxt);
+
+    MediumInteraction3f mi;
+    mi.sh_frame    = Frame3f(ray.d);
+    mi.wi          = -ray.d;
+    mi.time        = ray.time;
+    mi.wavelengths = ray.wavelengths;
+    mi.medium      = this;
+    mi.mint        = mint;
+    mi.p           = ray(mint);
+
+    auto combined_extinction = get_combined_extinction(mi, active);
+    Float m                  = combined_extinction[0];
+    if constexpr (is_rgb_v<Spectrum>) { // Handle RGB rendering
+        masked(m, eq(channel, 1u)) = combined_extinction[1];
+        masked(m, eq(channel, 2u)) = combined_extinction[2];
+    } else {
+        ENOKI_MARK_USED(channel);
+    }
+
+    /* Classic ratio tracking: step at the majorant rate and accumulate the
+       null-collision probabilities of the visited points */
+    UnpolarizedSpectrum tr(1.f);
+    Float t      = mint;
+    Mask running = active && (m > 0.f);
+    while (any(running)) {
+        masked(t, running) = t - enoki::log(1 - sampler->next_1d(running)) / m;
+        running &= (t < maxt);
+
+        masked(mi.p, running) = ray(t);
+        auto [sigma_s, sigma_n, sigma_t] =
+            get_scattering_coefficients(mi, running);
+        ENOKI_MARK_USED(sigma_s);
+        ENOKI_MARK_USED(sigma_t);
+        masked(tr, running) = tr * (sigma_n / combined_extinction);
+    }
+
+    return tr;
+}
+
 MTS_IMPLEMENT_CLASS_VARIANT(Medium, Object, "medium")
 MTS_INSTANTIATE_CLASS(Medium)
 NAMESPACE_END(mitsuba)
@@ -1,3 +1,6 @@
+#include <mitsuba/core/fstream.h>
+#include <mitsuba/core/hash.h>
+#include <mitsuba/core/plugin.h>
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/timer.h>
 #include <mitsuba/core/transform.h>
@@ -6,7 +9,22 @@
 #include <mitsuba/render/interaction.h>
 #include <mitsuba/render/mesh.h>
 #include <mitsuba/render/records.h>
+#include <mitsuba/render/texture.h>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+#include <tbb/parallel_sort.h>
+#include <algorithm>
+#include <atomic>
+#include <list>
 #include <mutex>
+#include <numeric>
+#include <unordered_map>
+
+#if !defined(_WIN32)
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
 
 #if defined(MTS_ENABLE_EMBREE)
     #include <embree3/rtcore.h>
@@ -20,13 +38,100 @@
 
 NAMESPACE_BEGIN(mitsuba)
 
+/**
+ * \brief Bounded LRU cache of micro-tessellated triangles
+ *
+ * Sharded by face index to limit lock contention during traversal. Each
+ * shard keeps its entries in an intrusive LRU list (front = most recently
+ * used) and evicts from the back once the per-shard capacity is exceeded.
+ * Entries are handed out as shared pointers so that a tessellation that is
+ * evicted while another thread still intersects against it stays alive.
+ */
+MTS_VARIANT struct Mesh<Float, Spectrum>::DisplacementCache {
+    using Entry = std::pair<ScalarIndex, std::shared_ptr<const MicroMesh>>;
+
+    struct Shard {
+        std::mutex mutex;
+        std::list<Entry> lru;
+        std::unordered_map<ScalarIndex, typename std::list<Entry>::iterator> map;
+    };
+
+    static constexpr size_t ShardCount = 16;
+
+    DisplacementCache(size_t capacity)
+        : capacity_per_shard(std::max((size_t) 1, capacity / ShardCount)) { }
+
+    Shard shards[ShardCount];
+    size_t capacity_per_shard;
+};
+
 MTS_VARIANT Mesh<Float, Spectrum>::Mesh(const Properties &props) : Base(props) {
     /* When set to ``true``, Mitsuba will use per-face instead of per-vertex
        normals when rendering the object, which will give it a faceted
        appearance. Default: ``false`` */
     if (props.bool_("face_normals", false))
         m_disable_vertex_normals = true;
+    /* When set to ``true``, vertex normals are stored octahedral-encoded in
+       two 16 bit integers and texture coordinates in half precision, which
+       reduces memory use and bandwidth on large meshes. Default: ``false`` */
+    m_compress_attributes = props.bool_("compress_attributes", false);
+    /* When set to ``true``, faces are clustered along a space-filling curve
+       and vertices re-indexed in first-use order at load time (see \ref
+       reorder_layout()), which reduces cache misses during ray traversal of
+       meshes stored in unfavorable (e.g. scan acquisition) order.
+       Default: ``false`` */
+    m_reorder = props.bool_("reorder", false);
+    /* When set to ``true`` (and used together with the ``cache`` property of
+       the mesh loaders), the vertex and face buffers alias a read-only
+       mapping of the binary cache file instead of being loaded into RAM.
+       Geometry then pages in on first intersection and can be evicted by the
+       OS (or explicitly via \ref evict_geometry()) under memory pressure,
+       which permits scenes whose geometry exceeds main memory.
+       Default: ``false`` */
+    m_out_of_core = props.bool_("out_of_core", false);
+    /* When set to ``true``, direct illumination sampling of this mesh draws
+       directions uniformly within the solid angle of the selected triangle
+       (Arvo's spherical triangle warp) instead of sampling the surface area
+       and reweighting by the squared distance, which greatly reduces
+       variance for emitters close to the receiver. The density evaluation
+       visits every face, so this is intended for small emissive meshes
+       (e.g. light fixtures). Default: ``false`` */
+    m_solid_angle_sampling = props.bool_("solid_angle_sampling", false);
+    if (m_out_of_core && m_compress_attributes)
+        Throw("The 'out_of_core' and 'compress_attributes' properties cannot "
+              "be combined: re-encoding attributes requires writable "
+              "geometry buffers!");
     m_to_world = props.transform("to_world", ScalarTransform4f());
+
+    /* Optional displacement map: rather than pre-tessellating in a DCC tool
+       (which explodes file sizes), triangles are micro-tessellated on the
+       fly during traversal and displaced along the interpolated shading
+       normal by ``displacement_scale`` times the texture value. */
+    if (props.has_property("displacement")) {
+        if constexpr (is_cuda_array_v<Float>)
+            Throw("Displacement mapping is currently not supported in GPU modes!");
+
+#if defined(MTS_ENABLE_EMBREE)
+        Throw("Displacement mapping requires the native kd-tree "
+              "(recompile with MTS_ENABLE_EMBREE=OFF)!");
+#endif
+
+        m_displacement       = props.texture<Texture>("displacement");
+        m_displacement_scale = (ScalarFloat) props.float_("displacement_scale", 1.f);
+        /* Number of micro-triangle rows per base triangle. Default: ``8`` */
+        m_displacement_res   = (uint32_t) props.size_("displacement_resolution", 8);
+        /* Upper bound on the number of concurrently cached
+           micro-tessellations. Default: ``65536`` */
+        m_displacement_cache_capacity =
+            props.size_("displacement_cache_capacity", 65536);
+
+        if (m_displacement_res < 1)
+            Throw("\"displacement_resolution\" must be at least 1!");
+
+        m_displacement_cache.reset(
+            new DisplacementCache(m_displacement_cache_capacity));
+    }
+
     m_mesh = true;
 }
 
@@ -81,14 +186,188 @@ MTS_VARIANT Mesh<Float, Spectrum>::Mesh(const std::string &name, Struct *vertex_
     m_vertex_size = (ScalarSize) m_vertex_struct->size();
     m_face_size   = (ScalarSize) m_face_struct->size();
 
-    m_vertices = VertexHolder(new uint8_t[(vertex_count + 1) * m_vertex_size]);
-    m_faces    = VertexHolder(new uint8_t[(face_count + 1) * m_face_size]);
+    m_vertices = detail::alloc_mesh_buffer((vertex_count + 1) * (size_t) m_vertex_size);
+    m_faces    = detail::alloc_mesh_buffer((face_count + 1) * (size_t) m_face_size);
 
     m_mesh = true;
 }
 
 MTS_VARIANT Mesh<Float, Spectrum>::~Mesh() { }
 
+/// Magic number and version of the binary mesh cache format
+#define MTS_MESH_CACHE_MAGIC   0x4D53544Du /* 'MTSM' */
+#define MTS_MESH_CACHE_VERSION 2u
+
+/* Alignment of the payload within cache files, so that memory-mapped vertex
+   data can be accessed with aligned loads (see \ref Mesh::read_cache) */
+#define MTS_MESH_CACHE_ALIGNMENT 64u
+
+MTS_VARIANT size_t Mesh<Float, Spectrum>::cache_hash(const uint8_t *data, size_t size) {
+    /* FNV-1a -- cheap single pass over the source data, which is still orders
+       of magnitude faster than parsing a text-based mesh format */
+    size_t h = (size_t) 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < size; ++i) {
+        h ^= data[i];
+        h *= (size_t) 0x100000001b3ull;
+    }
+    return h;
+}
+
+MTS_VARIANT bool Mesh<Float, Spectrum>::read_cache(const fs::path &path, size_t source_hash) {
+    if (!fs::exists(path))
+        return false;
+
+    try {
+        ref<FileStream> stream = new FileStream(path);
+
+        uint32_t magic, version;
+        uint64_t hash_value;
+        stream->read(magic);
+        stream->read(version);
+        stream->read(hash_value);
+
+        if (magic != MTS_MESH_CACHE_MAGIC ||
+            version != MTS_MESH_CACHE_VERSION ||
+            hash_value != (uint64_t) source_hash)
+            return false;
+
+        auto read_struct = [&]() {
+            uint32_t field_count;
+            stream->read(field_count);
+            ref<Struct> result = new Struct();
+            for (uint32_t i = 0; i < field_count; ++i) {
+                std::string name;
+                uint32_t type, flags;
+                stream->read(name);
+                stream->read(type);
+                stream->read(flags);
+                result->append(name, (typename Struct::Type) type, flags);
+            }
+            return result;
+        };
+
+        m_vertex_struct = read_struct();
+        m_face_struct   = read_struct();
+
+        stream->read(m_vertex_count);
+        stream->read(m_face_count);
+        stream->read(m_normal_offset);
+        stream->read(m_texcoord_offset);
+        stream->read(m_color_offset);
+
+        m_vertex_size = (ScalarSize) m_vertex_struct->size();
+        m_face_size   = (ScalarSize) m_face_struct->size();
+
+        // The payload is aligned so that it can be memory-mapped (see below)
+        size_t payload_offset = stream->tell();
+        payload_offset +=
+            (MTS_MESH_CACHE_ALIGNMENT - payload_offset % MTS_MESH_CACHE_ALIGNMENT) %
+            MTS_MESH_CACHE_ALIGNMENT;
+
+        size_t vertex_bytes = m_vertex_count * (size_t) m_vertex_size,
+               face_bytes   = m_face_count * (size_t) m_face_size;
+
+        if (m_out_of_core) {
+            /* Out-of-core mode: alias the payload of the (page-cached) cache
+               file instead of copying it to the heap. Geometry pages in on
+               first access, and clean pages can be reclaimed by the OS at any
+               time -- the kd-tree itself only retains bounds. The file ends
+               with one slack vertex/face (see write_cache), mirroring the
+               slack element of the heap layout. */
+            m_mmap = new MemoryMappedFile(path);
+
+            if (m_mmap->size() < payload_offset + vertex_bytes + face_bytes +
+                                     m_vertex_size + m_face_size) {
+                m_mmap = nullptr;
+                return false;
+            }
+
+            uint8_t *base = (uint8_t *) m_mmap->data() + payload_offset;
+            m_vertices = VertexHolder(base, detail::MeshBufferDeleter{ false });
+            m_faces    = FaceHolder(base + vertex_bytes,
+                                    detail::MeshBufferDeleter{ false });
+
+#if !defined(_WIN32)
+            // Access is traversal-driven -- disable sequential readahead
+            madvise(m_mmap->data(), m_mmap->size(), MADV_RANDOM);
+#endif
+        } else {
+            stream->seek(payload_offset);
+
+            m_vertices = detail::alloc_mesh_buffer((m_vertex_count + 1) * (size_t) m_vertex_size);
+            m_faces    = detail::alloc_mesh_buffer((m_face_count + 1) * (size_t) m_face_size);
+
+            stream->read(m_vertices.get(), vertex_bytes);
+            stream->read(m_faces.get(), face_bytes);
+        }
+
+        recompute_bbox();
+        return true;
+    } catch (const std::exception &e) {
+        Log(Warn, "\"%s\": could not read mesh cache file \"%s\": %s", m_name,
+            path.string(), e.what());
+        return false;
+    }
+}
+
+MTS_VARIANT void Mesh<Float, Spectrum>::write_cache(const fs::path &path,
+                                                    size_t source_hash) const {
+    try {
+        ref<FileStream> stream = new FileStream(path, FileStream::ETruncReadWrite);
+
+        stream->write((uint32_t) MTS_MESH_CACHE_MAGIC);
+        stream->write((uint32_t) MTS_MESH_CACHE_VERSION);
+        stream->write((uint64_t) source_hash);
+
+        auto write_struct = [&](const Struct *s) {
+            stream->write((uint32_t) s->field_count());
+            for (size_t i = 0; i < s->field_count(); ++i) {
+                const typename Struct::Field &field = (*s)[i];
+                stream->write(field.name);
+                stream->write((uint32_t) field.type);
+                stream->write((uint32_t) field.flags);
+            }
+        };
+
+        write_struct(m_vertex_struct.get());
+        write_struct(m_face_struct.get());
+
+        stream->write(m_vertex_count);
+        stream->write(m_face_count);
+        stream->write(m_normal_offset);
+        stream->write(m_texcoord_offset);
+        stream->write(m_color_offset);
+
+        // Align the payload so that read_cache() can memory-map it
+        while (stream->tell() % MTS_MESH_CACHE_ALIGNMENT != 0)
+            stream->write((uint8_t) 0);
+
+        stream->write(m_vertices.get(), m_vertex_count * (size_t) m_vertex_size);
+        stream->write(m_faces.get(), m_face_count * (size_t) m_face_size);
+
+        /* Trailing slack element, mirroring the extra vertex/face that the
+           heap layout allocates (vectorized gathers may read past the end) */
+        std::vector<uint8_t> slack(m_vertex_size + m_face_size, 0);
+        stream->write(slack.data(), slack.size());
+    } catch (const std::exception &e) {
+        Log(Warn, "\"%s\": could not write mesh cache file \"%s\": %s", m_name,
+            path.string(), e.what());
+    }
+}
+
+MTS_VARIANT void Mesh<Float, Spectrum>::evict_geometry() const {
+#if !defined(_WIN32)
+    if (!m_mmap)
+        return;
+
+    /* Drop the resident pages of the mapping; they are clean (the mapping is
+       never written through) and fault back in from the cache file on the
+       next access */
+    MemoryMappedFile *mmap = const_cast<MemoryMappedFile *>(m_mmap.get());
+    madvise(mmap->data(), mmap->size(), MADV_DONTNEED);
+#endif
+}
+
 MTS_VARIANT void Mesh<Float, Spectrum>::write(Stream *) const {
     NotImplementedError("write");
 }
@@ -111,8 +390,31 @@ Mesh<Float, Spectrum>::bbox(ScalarIndex index) const {
                   v1 = vertex_position(idx[1]),
                   v2 = vertex_position(idx[2]);
 
-    return typename Mesh<Float, Spectrum>::ScalarBoundingBox3f(min(min(v0, v1), v2),
-                                                               max(max(v0, v1), v2));
+    typename Mesh<Float, Spectrum>::ScalarBoundingBox3f result(
+        min(min(v0, v1), v2), max(max(v0, v1), v2));
+
+    // Temporally-expanded bounds covering the entire vertex motion
+    if (unlikely(has_vertex_motion())) {
+        result.expand(ScalarPoint3f(vertex_position_end(idx[0])));
+        result.expand(ScalarPoint3f(vertex_position_end(idx[1])));
+        result.expand(ScalarPoint3f(vertex_position_end(idx[2])));
+    }
+
+    // Conservatively account for the maximum possible displacement
+    if (unlikely(has_displacement())) {
+        ScalarFloat bound = abs(m_displacement_scale);
+        result.min -= bound;
+        result.max += bound;
+    }
+
+    return result;
+}
+
+/// Lock-free accumulation of a float (C++17 lacks atomic<float>::fetch_add)
+template <typename Value>
+static ENOKI_INLINE void atomic_add(std::atomic<Value> &target, Value value) {
+    Value old = target.load(std::memory_order_relaxed);
+    while (!target.compare_exchange_weak(old, old + value)) { }
 }
 
 MTS_VARIANT void Mesh<Float, Spectrum>::recompute_vertex_normals() {
@@ -120,61 +422,463 @@ MTS_VARIANT void Mesh<Float, Spectrum>::recompute_vertex_normals() {
         Throw("Storing new normals in a Mesh that didn't have normals at "
               "construction time is not implemented yet.");
 
-    std::vector<InputNormal3f> normals(m_vertex_count, zero<InputNormal3f>());
-    size_t invalid_counter = 0;
+    /* Scattered accumulation uses atomics: a vertex is shared by few faces,
+       hence contention is negligible. The price is that the summation order
+       (and thus the last few normal bits) depends on task scheduling. */
+    std::unique_ptr<std::atomic<InputFloat>[]> normals(
+        new std::atomic<InputFloat>[3 * (size_t) m_vertex_count]());
+    std::atomic<size_t> invalid_counter(0);
     Timer timer;
 
     /* Weighting scheme based on "Computing Vertex Normals from Polygonal Facets"
        by Grit Thuermer and Charles A. Wuethrich, JGT 1998, Vol 3 */
-    for (ScalarSize i = 0; i < m_face_count; ++i) {
-        const ScalarIndex *idx = (const ScalarIndex *) face(i);
-        Assert(idx[0] < m_vertex_count && idx[1] < m_vertex_count && idx[2] < m_vertex_count);
-        InputPoint3f v[3]{ vertex_position(idx[0]),
-                           vertex_position(idx[1]),
-                           vertex_position(idx[2]) };
-
-        InputVector3f side_0 = v[1] - v[0],
-                      side_1 = v[2] - v[0];
-        InputNormal3f n = cross(side_0, side_1);
-        InputFloat length_sqr = squared_norm(n);
-        if (likely(length_sqr > 0)) {
-            n *= rsqrt(length_sqr);
-
-            // Use Enoki to compute the face angles at the same time
-            auto side1 = transpose(Array<Packet<InputFloat, 3>, 3>{ side_0, v[2] - v[1], v[0] - v[2] });
-            auto side2 = transpose(Array<Packet<InputFloat, 3>, 3>{ side_1, v[0] - v[1], v[1] - v[2] });
-            InputVector3f face_angles = unit_angle(normalize(side1), normalize(side2));
-
-            for (size_t j = 0; j < 3; ++j)
-                normals[idx[j]] += n * face_angles[j];
-        }
-    }
-
-    for (ScalarSize i = 0; i < m_vertex_count; i++) {
-        InputNormal3f n = normals[i];
-        InputFloat length = norm(n);
-        if (likely(length != 0.f)) {
-            n /= length;
-        } else {
-            n = InputNormal3f(1, 0, 0); // Choose some bogus value
-            invalid_counter++;
-        }
+    tbb::parallel_for(
+        tbb::blocked_range<ScalarSize>(0, m_face_count, 4096),
+        [&](const tbb::blocked_range<ScalarSize> &range) {
+            for (ScalarSize i = range.begin(); i != range.end(); ++i) {
+                const ScalarIndex *idx = (const ScalarIndex *) face(i);
+                Assert(idx[0] < m_vertex_count && idx[1] < m_vertex_count && idx[2] < m_vertex_count);
+                InputPoint3f v[3]{ vertex_position(idx[0]),
+                                   vertex_position(idx[1]),
+                                   vertex_position(idx[2]) };
+
+                InputVector3f side_0 = v[1] - v[0],
+                              side_1 = v[2] - v[0];
+                InputNormal3f n = cross(side_0, side_1);
+                InputFloat length_sqr = squared_norm(n);
+                if (likely(length_sqr > 0)) {
+                    n *= rsqrt(length_sqr);
+
+                    // Use Enoki to compute the face angles at the same time
+                    auto side1 = transpose(Array<Packet<InputFloat, 3>, 3>{ side_0, v[2] - v[1], v[0] - v[2] });
+                    auto side2 = transpose(Array<Packet<InputFloat, 3>, 3>{ side_1, v[0] - v[1], v[1] - v[2] });
+                    InputVector3f face_angles = unit_angle(normalize(side1), normalize(side2));
+
+                    for (size_t j = 0; j < 3; ++j) {
+                        InputNormal3f weighted = n * face_angles[j];
+                        for (size_t k = 0; k < 3; ++k)
+                            atomic_add(normals[3 * (size_t) idx[j] + k],
+                                       weighted[k]);
+                    }
+                }
+            }
+        });
+
+    tbb::parallel_for(
+        tbb::blocked_range<ScalarSize>(0, m_vertex_count, 4096),
+        [&](const tbb::blocked_range<ScalarSize> &range) {
+            for (ScalarSize i = range.begin(); i != range.end(); ++i) {
+                InputNormal3f n(
+                    normals[3 * (size_t) i + 0].load(std::memory_order_relaxed),
+                    normals[3 * (size_t) i + 1].load(std::memory_order_relaxed),
+                    normals[3 * (size_t) i + 2].load(std::memory_order_relaxed));
+                InputFloat length = norm(n);
+                if (likely(length != 0.f)) {
+                    n /= length;
+                } else {
+                    n = InputNormal3f(1, 0, 0); // Choose some bogus value
+                    invalid_counter.fetch_add(1, std::memory_order_relaxed);
+                }
 
-        store(vertex(i) + m_normal_offset, n);
-    }
+                store(vertex(i) + m_normal_offset, n);
+            }
+        });
 
     if (invalid_counter == 0)
         Log(Debug, "\"%s\": computed vertex normals (took %s)", m_name,
             util::time_string(timer.value()));
     else
         Log(Warn, "\"%s\": computed vertex normals (took %s, %i invalid vertices!)",
-            m_name, util::time_string(timer.value()), invalid_counter);
+            m_name, util::time_string(timer.value()), invalid_counter.load());
 }
 
 MTS_VARIANT void Mesh<Float, Spectrum>::recompute_bbox() {
-    m_bbox.reset();
-    for (ScalarSize i = 0; i < m_vertex_count; ++i)
-        m_bbox.expand(vertex_position(i));
+    m_bbox = tbb::parallel_reduce(
+        tbb::blocked_range<ScalarSize>(0, m_vertex_count, 4096),
+        ScalarBoundingBox3f(),
+        [&](const tbb::blocked_range<ScalarSize> &range,
+            ScalarBoundingBox3f bbox) {
+            for (ScalarSize i = range.begin(); i != range.end(); ++i) {
+                bbox.expand(vertex_position(i));
+                if (unlikely(has_vertex_motion()))
+                    bbox.expand(vertex_position_end(i));
+            }
+            return bbox;
+        },
+        [](ScalarBoundingBox3f a, const ScalarBoundingBox3f &b) {
+            a.expand(b);
+            return a;
+        });
+
+    /* Conservatively account for the maximum possible displacement, which
+       can move the surface by up to |scale| along the shading normal in
+       either direction (texture values are assumed to lie in [0, 1]). */
+    if (unlikely(has_displacement())) {
+        ScalarFloat bound = abs(m_displacement_scale);
+        m_bbox.min -= bound;
+        m_bbox.max += bound;
+    }
+}
+
+MTS_VARIANT void Mesh<Float, Spectrum>::build_intersection_data() {
+    /* Displaced triangles are intersected through their micro-tessellations;
+       deforming triangles change with the ray time */
+    if (unlikely(has_displacement() || has_vertex_motion()))
+        return;
+
+    Timer timer;
+    size_t size = 12 * sizeof(InputFloat) * (size_t) m_face_count;
+    m_intersection_data = detail::alloc_mesh_buffer(size);
+    InputFloat *data = (InputFloat *) m_intersection_data.get();
+
+    tbb::parallel_for(
+        tbb::blocked_range<ScalarSize>(0, m_face_count, 4096),
+        [&](const tbb::blocked_range<ScalarSize> &range) {
+            for (ScalarSize i = range.begin(); i != range.end(); ++i) {
+                const ScalarIndex *idx = (const ScalarIndex *) face(i);
+                InputPoint3f p0 = vertex_position(idx[0]),
+                             p1 = vertex_position(idx[1]),
+                             p2 = vertex_position(idx[2]);
+
+                InputVector3f e1 = p1 - p0, e2 = p2 - p0;
+                InputNormal3f n  = cross(e1, e2);
+                InputFloat length_sqr = squared_norm(n);
+                InputFloat *rec = data + 12 * (size_t) i;
+
+                if (unlikely(length_sqr == 0)) {
+                    /* Degenerate triangle: store equations that reject every
+                       ray (the first edge equation evaluates to -1) */
+                    memset(rec, 0, 12 * sizeof(InputFloat));
+                    rec[7] = -1.f;
+                    continue;
+                }
+
+                /* Rows evaluating the barycentric coordinates of a point on
+                   the triangle plane: dot(cross(e2, n), e1) = dot(n, n) and
+                   dot(cross(e2, n), e2) = 0, hence dividing by |n|^2 yields
+                   u directly (and symmetrically for v) */
+                InputVector3f row_u = cross(e2, n) / length_sqr,
+                              row_v = cross(n, e1) / length_sqr;
+
+                store_unaligned(rec,     n);
+                store_unaligned(rec + 4, row_u);
+                store_unaligned(rec + 8, row_v);
+                rec[3]  =  dot(n, p0);
+                rec[7]  = -dot(row_u, p0);
+                rec[11] = -dot(row_v, p0);
+            }
+        });
+
+    Log(Debug, "\"%s\": precomputed triangle intersection data (%s, took %s)",
+        m_name, util::mem_string(size), util::time_string(timer.value()));
+}
+
+MTS_VARIANT void Mesh<Float, Spectrum>::attach_vertex_motion(
+    const Mesh *end_state, ScalarFloat time_begin, ScalarFloat time_end) {
+    if (end_state->vertex_count() != m_vertex_count ||
+        end_state->face_count() != m_face_count)
+        Throw("\"%s\": the motion sample has %i vertices / %i faces, but the "
+              "mesh has %i vertices / %i faces -- deformation motion blur "
+              "requires identical connectivity!",
+              m_name, end_state->vertex_count(), end_state->face_count(),
+              m_vertex_count, m_face_count);
+
+    if (unlikely(has_displacement()))
+        Throw("\"%s\": displacement mapping and deformation motion blur "
+              "cannot be combined!", m_name);
+
+    if (!(time_end > time_begin))
+        Throw("\"%s\": invalid motion time range [%f, %f]!", m_name,
+              time_begin, time_end);
+
+    size_t size = 3 * sizeof(InputFloat) * (size_t) m_vertex_count;
+    m_vertex_positions_end = detail::alloc_mesh_buffer(size);
+    InputFloat *data = (InputFloat *) m_vertex_positions_end.get();
+
+    tbb::parallel_for(
+        tbb::blocked_range<ScalarSize>(0, m_vertex_count, 4096),
+        [&](const tbb::blocked_range<ScalarSize> &range) {
+            for (ScalarSize i = range.begin(); i != range.end(); ++i)
+                store_unaligned(data + 3 * (size_t) i,
+                                end_state->vertex_position(i));
+        });
+
+    m_motion_time_begin = time_begin;
+    m_motion_time_end   = time_end;
+    m_inv_motion_span   = 1.f / (time_end - time_begin);
+
+    // Report temporally-expanded bounds to the acceleration data structures
+    m_bbox.expand(end_state->bbox());
+}
+
+MTS_VARIANT void Mesh<Float, Spectrum>::load_vertex_motion(const Properties &props) {
+    if (likely(!props.has_property("filename_end")))
+        return;
+
+    if constexpr (is_cuda_array_v<Float>) {
+        Log(Warn, "\"%s\": deformation motion blur is only available in the "
+            "CPU rendering modes -- ignoring.", m_name);
+        return;
+    }
+
+    if (unlikely(m_reorder))
+        Throw("\"%s\": the 'reorder' property permutes the vertex order and "
+              "cannot be combined with deformation motion blur!", m_name);
+
+    /* Load the shutter-close sample through the same plugin, with the same
+       settings (the recursion terminates since the end state itself carries
+       no 'filename_end' property) */
+    Properties props_end(props);
+    props_end.set_string("filename", props.string("filename_end"), false);
+    props_end.remove_property("filename_end");
+
+    ref<Shape> shape = PluginManager::instance()->create_object<Shape>(props_end);
+    const Mesh *end_state = dynamic_cast<const Mesh *>(shape.get());
+    if (!end_state)
+        Throw("\"%s\": could not load the motion sample \"%s\"!", m_name,
+              props.string("filename_end"));
+
+    attach_vertex_motion(end_state,
+                         props.float_("motion_time_begin", 0.f),
+                         props.float_("motion_time_end", 1.f));
+}
+
+/// Interleave the lowest 10 bits of 'v' with pairs of zero bits (Morton helper)
+static ENOKI_INLINE uint32_t expand_bits_10(uint32_t v) {
+    v = (v * 0x00010001u) & 0xFF0000FFu;
+    v = (v * 0x00000101u) & 0x0F00F00Fu;
+    v = (v * 0x00000011u) & 0xC30C30C3u;
+    v = (v * 0x00000005u) & 0x49249249u;
+    return v;
+}
+
+MTS_VARIANT void Mesh<Float, Spectrum>::reorder_layout() {
+    if (m_face_count == 0 || m_vertex_count == 0)
+        return;
+
+    if (m_out_of_core) {
+        Log(Warn, "\"%s\": the 'reorder' property requires writable geometry "
+            "buffers and is ignored for out-of-core meshes.", m_name);
+        return;
+    }
+
+    Timer timer;
+
+    if (!all(m_bbox.valid()))
+        recompute_bbox();
+
+    /* 1. Spatial face clustering: sort the faces along a 30-bit Morton curve
+       over their quantized centroids. This approximates the leaf order of
+       the spatial median builds in kdtree.h (and of Embree's BVH), so
+       triangles that are fetched together during traversal end up on nearby
+       cache lines. */
+    ScalarVector3f extents = m_bbox.extents();
+    ScalarVector3f scale = select(extents > 0.f, 1024.f / extents,
+                                  ScalarVector3f(0.f));
+
+    std::vector<uint32_t> code(m_face_count);
+    tbb::parallel_for(
+        tbb::blocked_range<ScalarSize>(0, m_face_count, 4096),
+        [&](const tbb::blocked_range<ScalarSize> &range) {
+            for (ScalarSize i = range.begin(); i != range.end(); ++i) {
+                const ScalarIndex *idx = (const ScalarIndex *) face(i);
+                ScalarPoint3f centroid =
+                    ScalarPoint3f(vertex_position(idx[0]) +
+                                  vertex_position(idx[1]) +
+                                  vertex_position(idx[2])) * (1.f / 3.f);
+                ScalarVector3f rel = (centroid - m_bbox.min) * scale;
+                uint32_t x = std::min(1023u, (uint32_t) std::max(rel.x(), ScalarFloat(0))),
+                         y = std::min(1023u, (uint32_t) std::max(rel.y(), ScalarFloat(0))),
+                         z = std::min(1023u, (uint32_t) std::max(rel.z(), ScalarFloat(0)));
+                code[i] = (expand_bits_10(x) << 2) | (expand_bits_10(y) << 1) |
+                           expand_bits_10(z);
+            }
+        });
+
+    std::vector<ScalarIndex> order(m_face_count);
+    std::iota(order.begin(), order.end(), (ScalarIndex) 0);
+    tbb::parallel_sort(order.begin(), order.end(),
+                       [&](ScalarIndex a, ScalarIndex b) {
+                           return code[a] != code[b] ? code[a] < code[b]
+                                                     : a < b;
+                       });
+
+    /* 2. Vertex re-indexing: assign new vertex ids in first-use order of the
+       clustered face sequence, so that the vertex records referenced by
+       neighboring faces share cache lines. Unreferenced vertices are
+       appended at the end. */
+    const ScalarIndex unused = (ScalarIndex) -1;
+    std::vector<ScalarIndex> vertex_remap(m_vertex_count, unused);
+    ScalarIndex next = 0;
+    for (ScalarSize k = 0; k < m_face_count; ++k) {
+        const ScalarIndex *idx = (const ScalarIndex *) face(order[k]);
+        for (size_t j = 0; j < 3; ++j) {
+            if (vertex_remap[idx[j]] == unused)
+                vertex_remap[idx[j]] = next++;
+        }
+    }
+    for (ScalarSize i = 0; i < m_vertex_count; ++i) {
+        if (vertex_remap[i] == unused)
+            vertex_remap[i] = next++;
+    }
+
+    /* 3. Permute the interleaved records. The vertex/face layouts themselves
+       (m_vertex_struct/m_face_struct) are unchanged, hence moving the
+       fixed-size rows and rewriting the index triples suffices. */
+    VertexHolder vertices =
+        detail::alloc_mesh_buffer((m_vertex_count + 1) * (size_t) m_vertex_size);
+    FaceHolder faces =
+        detail::alloc_mesh_buffer((m_face_count + 1) * (size_t) m_face_size);
+
+    tbb::parallel_for(
+        tbb::blocked_range<ScalarSize>(0, m_vertex_count, 4096),
+        [&](const tbb::blocked_range<ScalarSize> &range) {
+            for (ScalarSize i = range.begin(); i != range.end(); ++i)
+                memcpy(vertices.get() +
+                           (size_t) vertex_remap[i] * m_vertex_size,
+                       vertex(i), m_vertex_size);
+        });
+
+    tbb::parallel_for(
+        tbb::blocked_range<ScalarSize>(0, m_face_count, 4096),
+        [&](const tbb::blocked_range<ScalarSize> &range) {
+            for (ScalarSize k = range.begin(); k != range.end(); ++k) {
+                uint8_t *row = faces.get() + (size_t) k * m_face_size;
+                memcpy(row, face(order[k]), m_face_size);
+                ScalarIndex *dst = (ScalarIndex *) row;
+                for (size_t j = 0; j < 3; ++j)
+                    dst[j] = vertex_remap[dst[j]];
+            }
+        });
+
+    m_vertices = std::move(vertices);
+    m_faces    = std::move(faces);
+
+    Log(Debug, "\"%s\": reordered %i faces and %i vertices for traversal "
+        "locality (took %s)", m_name, m_face_count, m_vertex_count,
+        util::time_string(timer.value()));
+}
+
+/// Map a unit vector to the octahedron (inverse of \ref Mesh::octahedral_decode)
+static uint32_t octahedral_encode(float x, float y, float z) {
+    float l1 = std::abs(x) + std::abs(y) + std::abs(z);
+    // Degenerate input (e.g. an unreferenced vertex) -- encode as +Z
+    float inv_l1 = l1 > 0.f ? 1.f / l1 : 0.f;
+
+    float u = x * inv_l1, v = y * inv_l1;
+    if (z < 0.f) {
+        float u_old = u;
+        u = (1.f - std::abs(v)) * std::copysign(1.f, u_old);
+        v = (1.f - std::abs(u_old)) * std::copysign(1.f, v);
+    }
+
+    auto quantize = [](float f) {
+        f = (f * .5f + .5f) * 65535.f;
+        return (uint32_t) std::min(65535.f, std::max(0.f, std::rint(f)));
+    };
+
+    return quantize(u) | (quantize(v) << 16);
+}
+
+/// Store a pair of values in half precision (inverse of \ref Mesh::float16_decode)
+static uint32_t float16_encode(float a, float b) {
+    return (uint32_t) enoki::half(a).value |
+          ((uint32_t) enoki::half(b).value << 16);
+}
+
+MTS_VARIANT void Mesh<Float, Spectrum>::compress_vertex_attributes() {
+    if constexpr (is_cuda_array_v<Float>) {
+        Log(Warn, "\"%s\": vertex attribute compression is not supported in "
+                  "GPU modes, ignoring.", m_name);
+    } else {
+        if (m_compressed_normals || m_compressed_texcoords)
+            return;
+
+        bool normals   = has_vertex_normals(),
+             texcoords = has_vertex_texcoords();
+        if (!normals && !texcoords)
+            return;
+
+        Timer timer;
+
+        /* Rebuild the vertex layout: normals shrink to two octahedral-mapped
+           16-bit integers, texture coordinates to a pair of halves. All other
+           fields (positions, colors) are carried over unmodified. */
+        ref<Struct> vertex_struct = new Struct();
+        std::vector<std::array<size_t, 3>> passthrough; // src offset, dst offset, size
+
+        for (size_t i = 0; i < m_vertex_struct->field_count(); ++i) {
+            const Struct::Field &f = (*m_vertex_struct)[i];
+
+            if (normals && (f.name == "nx" || f.name == "ny" || f.name == "nz")) {
+                if (f.name == "nx") {
+                    vertex_struct->append("nx", Struct::Type::UInt16);
+                    vertex_struct->append("ny", Struct::Type::UInt16);
+                }
+                continue;
+            }
+
+            if (texcoords && (f.name == "u" || f.name == "v")) {
+                if (f.name == "u") {
+                    vertex_struct->append("u", Struct::Type::Float16);
+                    vertex_struct->append("v", Struct::Type::Float16);
+                }
+                continue;
+            }
+
+            vertex_struct->append(f.name, f.type, f.flags, f.default_);
+            passthrough.push_back(
+                { f.offset, vertex_struct->field(f.name).offset, f.size });
+        }
+
+        ScalarSize vertex_size = (ScalarSize) vertex_struct->size();
+        ScalarIndex normal_offset = normals
+            ? (ScalarIndex) vertex_struct->field("nx").offset : 0;
+        ScalarIndex texcoord_offset = texcoords
+            ? (ScalarIndex) vertex_struct->field("u").offset : 0;
+        ScalarIndex color_offset = has_vertex_colors()
+            ? (ScalarIndex) vertex_struct->field("r").offset : 0;
+
+        VertexHolder vertices = detail::alloc_mesh_buffer(
+            (m_vertex_count + 1) * (size_t) vertex_size);
+
+        for (ScalarSize i = 0; i < m_vertex_count; ++i) {
+            const uint8_t *src = m_vertices.get() + (size_t) m_vertex_size * i;
+            uint8_t *dst = vertices.get() + (size_t) vertex_size * i;
+
+            for (auto const &field : passthrough)
+                memcpy(dst + field[1], src + field[0], field[2]);
+
+            if (normals) {
+                InputNormal3f n =
+                    load_unaligned<InputNormal3f>(src + m_normal_offset);
+                uint32_t encoded = octahedral_encode(n.x(), n.y(), n.z());
+                memcpy(dst + normal_offset, &encoded, sizeof(uint32_t));
+            }
+
+            if (texcoords) {
+                InputVector2f uv =
+                    load_unaligned<InputVector2f>(src + m_texcoord_offset);
+                uint32_t encoded = float16_encode(uv.x(), uv.y());
+                memcpy(dst + texcoord_offset, &encoded, sizeof(uint32_t));
+            }
+        }
+
+        Log(Debug, "\"%s\": compressed vertex attributes (%s -> %s, took %s)",
+            m_name,
+            util::mem_string((m_vertex_count + 1) * (size_t) m_vertex_size),
+            util::mem_string((m_vertex_count + 1) * (size_t) vertex_size),
+            util::time_string(timer.value()));
+
+        m_vertices             = std::move(vertices);
+        m_vertex_struct        = vertex_struct;
+        m_vertex_size          = vertex_size;
+        m_normal_offset        = normal_offset;
+        m_texcoord_offset      = texcoord_offset;
+        m_color_offset         = color_offset;
+        m_compressed_normals   = normals;
+        m_compressed_texcoords = texcoords;
+    }
 }
 
 MTS_VARIANT void Mesh<Float, Spectrum>::area_distr_build() {
@@ -183,13 +887,24 @@ MTS_VARIANT void Mesh<Float, Spectrum>::area_distr_build() {
 
     std::lock_guard<tbb::spin_mutex> lock(m_mutex);
     std::unique_ptr<ScalarFloat[]> table(new ScalarFloat[m_face_count]);
-    for (ScalarIndex i = 0; i < m_face_count; i++)
-        table[i] = face_area(i);
+    tbb::parallel_for(
+        tbb::blocked_range<ScalarIndex>(0, m_face_count, 4096),
+        [&](const tbb::blocked_range<ScalarIndex> &range) {
+            for (ScalarIndex i = range.begin(); i != range.end(); ++i)
+                table[i] = face_area(i);
+        });
 
     m_area_distr = DiscreteDistribution<Float>(
         table.get(),
         m_face_count
     );
+
+    /* Large emissive meshes are position-sampled once per shadow ray; switch
+       to Walker's alias method so that each sample costs two gathers instead
+       of a log(n) binary search over the CDF. Small meshes keep the plain
+       CDF search, which preserves the stratification of the sample set. */
+    if (m_face_count >= 4096)
+        m_area_distr.set_alias_table(true);
 }
 
 MTS_VARIANT typename Mesh<Float, Spectrum>::ScalarSize
@@ -224,10 +939,11 @@ Mesh<Float, Spectrum>::sample_position(Float time, const Point2f &sample_, Mask
     Point2f b = warp::square_to_uniform_triangle(sample);
 
     PositionSample3f ps;
-    ps.p     = p0 + e0 * b.x() + e1 * b.y();
-    ps.time  = time;
-    ps.pdf   = m_area_distr.normalization();
-    ps.delta = false;
+    ps.p          = p0 + e0 * b.x() + e1 * b.y();
+    ps.time       = time;
+    ps.pdf        = m_area_distr.normalization();
+    ps.delta      = false;
+    ps.prim_index = face_idx;
 
     if (has_vertex_texcoords()) {
         Point2f uv0 = vertex_texcoord(fi[0], active),
@@ -259,7 +975,229 @@ MTS_VARIANT Float Mesh<Float, Spectrum>::pdf_position(const PositionSample3f &,
     return m_area_distr.normalization();
 }
 
-MTS_VARIANT void Mesh<Float, Spectrum>::fill_surface_interaction(const Ray3f & /*ray*/,
+MTS_VARIANT typename Mesh<Float, Spectrum>::DirectionSample3f
+Mesh<Float, Spectrum>::sample_direction(const Interaction3f &it, const Point2f &sample_,
+                                        Mask active) const {
+    MTS_MASK_ARGUMENT(active);
+
+    if (likely(!m_solid_angle_sampling))
+        return Base::sample_direction(it, sample_, active);
+
+    area_distr_ensure();
+
+    using Index = replace_scalar_t<Float, ScalarIndex>;
+    Index face_idx;
+    Point2f sample = sample_;
+    std::tie(face_idx, sample.y()) = m_area_distr.sample_reuse(sample.y(), active);
+
+    Array<Index, 3> fi = face_indices(face_idx, active);
+
+    Point3f p0 = vertex_position(fi[0], active),
+            p1 = vertex_position(fi[1], active),
+            p2 = vertex_position(fi[2], active);
+
+    if (unlikely(has_vertex_motion())) {
+        Float w = motion_weight(it.time);
+        p0 += (Point3f(vertex_position_end(fi[0], active)) - p0) * w;
+        p1 += (Point3f(vertex_position_end(fi[1], active)) - p1) * w;
+        p2 += (Point3f(vertex_position_end(fi[2], active)) - p2) * w;
+    }
+
+    // Unit vectors spanning the spherical triangle
+    Vector3f a = normalize(p0 - it.p),
+             b = normalize(p1 - it.p),
+             c = normalize(p2 - it.p);
+
+    // Normals of the planes through the reference point and each edge
+    Vector3f n_ab = cross(a, b), n_bc = cross(b, c), n_ca = cross(c, a);
+
+    Mask degenerate = squared_norm(n_ab) < math::RayEpsilon<Float> ||
+                      squared_norm(n_bc) < math::RayEpsilon<Float> ||
+                      squared_norm(n_ca) < math::RayEpsilon<Float>;
+
+    n_ab = normalize(n_ab); n_bc = normalize(n_bc); n_ca = normalize(n_ca);
+
+    // Interior dihedral angles; the spherical excess is the solid angle
+    Float cos_alpha = -dot(n_ab, n_ca),
+          alpha     = safe_acos(cos_alpha),
+          beta      = safe_acos(-dot(n_bc, n_ab)),
+          gamma     = safe_acos(-dot(n_ca, n_bc)),
+          solid_angle = alpha + beta + gamma - math::Pi<Float>;
+
+    /* The warp degenerates for reference points that are (nearly) in the
+       plane of the triangle -- fall back to area sampling reweighted by the
+       distance there (mirroring the spherical rectangle sampling). */
+    Mask valid = active && !degenerate &&
+                 solid_angle > math::RayEpsilon<Float> &&
+                 enoki::isfinite(solid_angle);
+
+    DirectionSample3f result = zero<DirectionSample3f>();
+
+    Vector3f e0 = p1 - p0, e1 = p2 - p0;
+    Normal3f ng = normalize(cross(e0, e1));
+
+    if (likely(any(valid))) {
+        // Arvo, "Stratified Sampling of Spherical Triangles" (SIGGRAPH 1995)
+        Float sin_alpha = safe_sqrt(fnmadd(cos_alpha, cos_alpha, 1.f));
+
+        auto [s, t] = sincos(fmadd(sample.x(), solid_angle, -alpha));
+        Float u = t - cos_alpha,
+              v = s + sin_alpha * dot(a, b);
+
+        Float q = clamp(((v * t - u * s) * cos_alpha - v) /
+                        ((v * s + u * t) * sin_alpha), -1.f, 1.f);
+
+        // Vertex of the sub-triangle along the arc from 'a' to 'c'
+        Vector3f c_hat = q * a +
+            safe_sqrt(fnmadd(q, q, 1.f)) * normalize(fnmadd(dot(c, a), a, c));
+
+        // Sample along the arc from 'b' to the new vertex
+        Float z = 1.f - sample.y() * (1.f - dot(c_hat, b));
+        Vector3f d = z * b +
+            safe_sqrt(fnmadd(z, z, 1.f)) * normalize(fnmadd(dot(c_hat, b), b, c_hat));
+
+        // Project onto the triangle plane to complete the sample record
+        Float dp   = dot(d, Vector3f(ng)),
+              dist = select(neq(dp, 0.f),
+                            dot(p0 - it.p, Vector3f(ng)) / dp, 0.f);
+
+        DirectionSample3f ds = zero<DirectionSample3f>();
+        ds.d    = d;
+        ds.p    = it.p + d * dist;
+        ds.dist = dist;
+
+        // Barycentric coordinates of the sampled point (attribute lookup)
+        Vector3f rel = ds.p - p0;
+        Float b1  = dot(e0, rel), b2 = dot(e1, rel),
+              a11 = dot(e0, e0), a12 = dot(e0, e1), a22 = dot(e1, e1),
+              inv_det = rcp(fmsub(a11, a22, a12 * a12)),
+              bu = fmsub (a22, b1, a12 * b2) * inv_det,
+              bv = fnmadd(a12, b1, a11 * b2) * inv_det,
+              b0 = 1.f - bu - bv;
+
+        if (has_vertex_texcoords()) {
+            Point2f uv0 = vertex_texcoord(fi[0], valid),
+                    uv1 = vertex_texcoord(fi[1], valid),
+                    uv2 = vertex_texcoord(fi[2], valid);
+            ds.uv = uv0 * b0 + uv1 * bu + uv2 * bv;
+        } else {
+            ds.uv = Point2f(bu, bv);
+        }
+
+        if (has_vertex_normals()) {
+            Normal3f n0 = vertex_normal(fi[0], valid),
+                     n1 = vertex_normal(fi[1], valid),
+                     n2 = vertex_normal(fi[2], valid);
+            ds.n = normalize(n0 * b0 + n1 * bu + n2 * bv);
+        } else {
+            ds.n = ng;
+        }
+
+        /* Combined density over all triangles whose solid angle contains
+           the sampled direction (required for unbiasedness when several
+           faces overlap as seen from the reference point) */
+        ds.pdf = pdf_direction(it, ds, valid);
+        masked(ds.pdf, eq(dist, 0.f)) = 0.f;
+
+        result[valid] = ds;
+    }
+
+    Mask fallback = andnot(active, valid);
+    if (unlikely(any(fallback))) {
+        // Area-sample the selected triangle and reweight by the distance
+        Point2f bc = warp::square_to_uniform_triangle(sample);
+
+        DirectionSample3f ds = zero<DirectionSample3f>();
+        ds.p  = p0 + e0 * bc.x() + e1 * bc.y();
+        ds.uv = bc;
+        ds.n  = ng;
+
+        if (has_vertex_texcoords()) {
+            Point2f uv0 = vertex_texcoord(fi[0], fallback),
+                    uv1 = vertex_texcoord(fi[1], fallback),
+                    uv2 = vertex_texcoord(fi[2], fallback);
+            ds.uv = uv0 * (1.f - bc.x() - bc.y()) + uv1 * bc.x() + uv2 * bc.y();
+        }
+
+        if (has_vertex_normals()) {
+            Normal3f n0 = vertex_normal(fi[0], fallback),
+                     n1 = vertex_normal(fi[1], fallback),
+                     n2 = vertex_normal(fi[2], fallback);
+            ds.n = normalize(n0 * (1.f - bc.x() - bc.y()) + n1 * bc.x() + n2 * bc.y());
+        }
+
+        ds.d = ds.p - it.p;
+        Float dist_squared = squared_norm(ds.d);
+        ds.dist = sqrt(dist_squared);
+        ds.d   /= ds.dist;
+
+        Float dp = abs_dot(ds.d, ds.n);
+        ds.pdf = m_area_distr.normalization() *
+                 select(neq(dp, 0.f), dist_squared / dp, 0.f);
+
+        result[fallback] = ds;
+    }
+
+    result.time  = it.time;
+    result.delta = false;
+    result.object = (const Object *) this;
+
+    return result;
+}
+
+MTS_VARIANT Float Mesh<Float, Spectrum>::pdf_direction(const Interaction3f &it,
+                                                       const DirectionSample3f &ds,
+                                                       Mask active) const {
+    MTS_MASK_ARGUMENT(active);
+
+    if (likely(!m_solid_angle_sampling))
+        return Base::pdf_direction(it, ds, active);
+
+    area_distr_ensure();
+
+    /* Accumulate the densities of all triangles whose solid angle contains
+       the direction. The linear sweep over the faces is what restricts this
+       sampling strategy to small emissive meshes. */
+    Ray3f ray(it.p, ds.d, it.time, it.wavelengths);
+    Float inv_total_area = m_area_distr.normalization(),
+          result = 0.f;
+
+    for (ScalarIndex i = 0; i < m_face_count; ++i) {
+        Mask hit = std::get<0>(ray_intersect_triangle(i, ray, active));
+        if (none_or<false>(hit))
+            continue;
+
+        auto fi = face_indices(i);
+
+        Point3f p0 = vertex_position(fi[0]),
+                p1 = vertex_position(fi[1]),
+                p2 = vertex_position(fi[2]);
+
+        if (unlikely(has_vertex_motion())) {
+            Float w = motion_weight(it.time);
+            p0 += (Point3f(vertex_position_end(fi[0])) - p0) * w;
+            p1 += (Point3f(vertex_position_end(fi[1])) - p1) * w;
+            p2 += (Point3f(vertex_position_end(fi[2])) - p2) * w;
+        }
+
+        Vector3f a = normalize(p0 - it.p),
+                 b = normalize(p1 - it.p),
+                 c = normalize(p2 - it.p);
+
+        // Solid angle via the formula of Van Oosterom and Strackee
+        Float solid_angle = 2.f *
+            atan2(abs(dot(a, cross(b, c))),
+                  1.f + dot(a, b) + dot(b, c) + dot(a, c));
+
+        Float prob = .5f * norm(cross(p1 - p0, p2 - p0)) * inv_total_area;
+        masked(result, hit && solid_angle > math::RayEpsilon<Float>) +=
+            prob * rcp(solid_angle);
+    }
+
+    return result;
+}
+
+MTS_VARIANT void Mesh<Float, Spectrum>::fill_surface_interaction(const Ray3f &ray,
                                                                  const Float *cache,
                                                                  SurfaceInteraction3f &si,
                                                                  Mask active) const {
@@ -277,12 +1215,24 @@ MTS_VARIANT void Mesh<Float, Spectrum>::fill_surface_interaction(const Ray3f & /
             p1 = vertex_position(fi[1], active),
             p2 = vertex_position(fi[2], active);
 
+    if (unlikely(has_vertex_motion())) {
+        Float w = motion_weight(ray.time);
+        p0 += (Point3f(vertex_position_end(fi[0], active)) - p0) * w;
+        p1 += (Point3f(vertex_position_end(fi[1], active)) - p1) * w;
+        p2 += (Point3f(vertex_position_end(fi[2], active)) - p2) * w;
+    }
+
     Vector3f dp0 = p1 - p0,
              dp1 = p2 - p0;
 
     // Re-interpolate intersection using barycentric coordinates
     si.p[active] = p0 * b0 + p1 * b1 + p2 * b2;
 
+    /* For displaced meshes, the intersection point lies on the displaced
+       micro-surface rather than on the base triangle */
+    if (unlikely(has_displacement()))
+        si.p[active] = ray(si.t);
+
     // Face normal
     Normal3f n = normalize(cross(dp0, dp1));
     si.n[active] = n;
@@ -342,6 +1292,13 @@ Mesh<Float, Spectrum>::normal_derivative(const SurfaceInteraction3f &si, bool sh
             p1 = vertex_position(fi[1], active),
             p2 = vertex_position(fi[2], active);
 
+    if (unlikely(has_vertex_motion())) {
+        Float w = motion_weight(si.time);
+        p0 += (Point3f(vertex_position_end(fi[0], active)) - p0) * w;
+        p1 += (Point3f(vertex_position_end(fi[1], active)) - p1) * w;
+        p2 += (Point3f(vertex_position_end(fi[2], active)) - p2) * w;
+    }
+
     Normal3f n0 = vertex_normal(fi[0], active),
              n1 = vertex_normal(fi[1], active),
              n2 = vertex_normal(fi[2], active);
@@ -438,6 +1395,15 @@ MTS_VARIANT typename Mesh<Float, Spectrum>::ScalarBoundingBox3f
 Mesh<Float, Spectrum>::bbox(ScalarIndex index, const ScalarBoundingBox3f &clip) const {
     using ScalarPoint3d = mitsuba::Point<double, 3>;
 
+    /* Exact clipping against the triangle plane applies neither to displaced
+       nor to deforming geometry -- fall back to the padded/temporally-expanded
+       per-face bounds intersected with the clip region. */
+    if (unlikely(has_displacement() || has_vertex_motion())) {
+        ScalarBoundingBox3f result = bbox(index);
+        result.clip(clip);
+        return result;
+    }
+
     // Reserve room for some additional vertices
     ScalarPoint3d vertices1[max_vertices], vertices2[max_vertices];
     size_t n_vertices = 3;
@@ -482,6 +1448,174 @@ Mesh<Float, Spectrum>::bbox(ScalarIndex index, const ScalarBoundingBox3f &clip)
     return result;
 }
 
+MTS_VARIANT typename Mesh<Float, Spectrum>::ScalarFloat
+Mesh<Float, Spectrum>::eval_displacement(const ScalarPoint2f &uv) const {
+    if constexpr (!is_cuda_array_v<Float>) {
+        /* Evaluate the texture with a broadcast interaction and extract a
+           single value -- tessellation happens one grid vertex at a time */
+        SurfaceInteraction3f si = zero<SurfaceInteraction3f>();
+        si.uv = Point2f(Float(uv.x()), Float(uv.y()));
+
+        Float value = m_displacement->eval_1(si, true);
+        if constexpr (is_array_v<Float>)
+            return value.coeff(0);
+        else
+            return value;
+    } else {
+        ENOKI_MARK_USED(uv);
+        return 0.f;
+    }
+}
+
+MTS_VARIANT std::shared_ptr<const typename Mesh<Float, Spectrum>::MicroMesh>
+Mesh<Float, Spectrum>::micro_mesh(ScalarIndex index) const {
+    auto &shard =
+        m_displacement_cache->shards[index % DisplacementCache::ShardCount];
+
+    /* Fast path: the tessellation is already cached */ {
+        std::lock_guard<std::mutex> guard(shard.mutex);
+        auto it = shard.map.find(index);
+        if (likely(it != shard.map.end())) {
+            shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+            return it->second->second;
+        }
+    }
+
+    /* Build the micro-tessellation outside of the lock. Two threads may
+       occasionally build the same triangle concurrently; the result is
+       identical and one of the two copies simply wins below. */
+    uint32_t res = m_displacement_res;
+
+    auto mm = std::make_shared<MicroMesh>();
+    mm->res = res;
+    mm->vertices.reserve(((res + 1) * (res + 2)) / 2);
+
+    auto fi = face_indices(index);
+    ScalarPoint3f p0 = vertex_position(fi[0]),
+                  p1 = vertex_position(fi[1]),
+                  p2 = vertex_position(fi[2]);
+
+    ScalarNormal3f face_n = normalize(cross(p1 - p0, p2 - p0));
+    ScalarFloat step = rcp((ScalarFloat) res);
+
+    for (uint32_t i = 0; i <= res; ++i) {
+        for (uint32_t j = 0; j <= res - i; ++j) {
+            ScalarFloat b1 = i * step, b2 = j * step, b0 = 1.f - b1 - b2;
+
+            ScalarPoint3f p = p0 * b0 + p1 * b1 + p2 * b2;
+
+            ScalarNormal3f n = face_n;
+            if (has_vertex_normals())
+                n = normalize(ScalarNormal3f(vertex_normal(fi[0])) * b0 +
+                              ScalarNormal3f(vertex_normal(fi[1])) * b1 +
+                              ScalarNormal3f(vertex_normal(fi[2])) * b2);
+
+            ScalarPoint2f uv(b1, b2);
+            if (has_vertex_texcoords())
+                uv = ScalarPoint2f(vertex_texcoord(fi[0])) * b0 +
+                     ScalarPoint2f(vertex_texcoord(fi[1])) * b1 +
+                     ScalarPoint2f(vertex_texcoord(fi[2])) * b2;
+
+            mm->vertices.push_back(
+                p + n * (m_displacement_scale * eval_displacement(uv)));
+        }
+    }
+
+    std::lock_guard<std::mutex> guard(shard.mutex);
+    auto it = shard.map.find(index);
+    if (it != shard.map.end())
+        return it->second->second;
+
+    shard.lru.emplace_front(index, mm);
+    shard.map[index] = shard.lru.begin();
+
+    if (shard.lru.size() > m_displacement_cache->capacity_per_shard) {
+        shard.map.erase(shard.lru.back().first);
+        shard.lru.pop_back();
+    }
+
+    return mm;
+}
+
+MTS_VARIANT std::tuple<typename Mesh<Float, Spectrum>::Mask, Float, Float, Float>
+Mesh<Float, Spectrum>::ray_intersect_triangle_displaced(const ScalarIndex &index,
+                                                        const Ray3f &ray,
+                                                        Mask active) const {
+    if constexpr (is_cuda_array_v<Float>) {
+        ENOKI_MARK_USED(index);
+        ENOKI_MARK_USED(ray);
+        ENOKI_MARK_USED(active);
+        return { Mask(false), Float(0.f), Float(0.f), Float(0.f) };
+    } else {
+        std::shared_ptr<const MicroMesh> mm = micro_mesh(index);
+        uint32_t res = mm->res;
+
+        // Triangular grid layout: row i starts at offset i*(res+1) - i*(i-1)/2
+        auto vtx = [&](uint32_t i, uint32_t j) -> const ScalarPoint3f & {
+            return mm->vertices[i * (res + 1) - (i * (i - 1)) / 2 + j];
+        };
+
+        ScalarFloat step = rcp((ScalarFloat) res);
+
+        Mask hit = false;
+        Float u_out = 0.f, v_out = 0.f,
+              t_best = math::Infinity<Float>;
+
+        /* Moeller-Trumbore test against one micro-triangle; barycentric
+           coordinates of the hit are mapped back to the base triangle so
+           that attribute interpolation downstream works unchanged. */
+        auto intersect = [&](const ScalarPoint3f &p0, const ScalarPoint3f &p1,
+                             const ScalarPoint3f &p2, const ScalarPoint2f &q0,
+                             const ScalarPoint2f &q1, const ScalarPoint2f &q2) {
+            Vector3f e1 = Vector3f(p1 - p0),
+                     e2 = Vector3f(p2 - p0);
+
+            Vector3f pvec = cross(ray.d, e2);
+            Float inv_det = rcp(dot(e1, pvec));
+
+            Vector3f tvec = ray.o - Point3f(p0);
+            Float u = dot(tvec, pvec) * inv_det;
+
+            Vector3f qvec = cross(tvec, e1);
+            Float v = dot(ray.d, qvec) * inv_det;
+
+            Float t = dot(e2, qvec) * inv_det;
+
+            Mask valid = active && u >= 0.f && v >= 0.f && u + v <= 1.f &&
+                         t >= ray.mint && t <= ray.maxt && t < t_best;
+
+            if (any_or<true>(valid)) {
+                Float w = 1.f - u - v;
+                masked(u_out, valid)  = w * q0.x() + u * q1.x() + v * q2.x();
+                masked(v_out, valid)  = w * q0.y() + u * q1.y() + v * q2.y();
+                masked(t_best, valid) = t;
+                hit |= valid;
+            }
+        };
+
+        for (uint32_t i = 0; i < res; ++i) {
+            for (uint32_t j = 0; j < res - i; ++j) {
+                ScalarPoint2f q00(i * step, j * step),
+                              q10((i + 1) * step, j * step),
+                              q01(i * step, (j + 1) * step);
+
+                // "Upward" micro-triangle of cell (i, j)
+                intersect(vtx(i, j), vtx(i + 1, j), vtx(i, j + 1),
+                          q00, q10, q01);
+
+                // "Downward" micro-triangle (absent along the diagonal edge)
+                if (j + 1 < res - i) {
+                    ScalarPoint2f q11((i + 1) * step, (j + 1) * step);
+                    intersect(vtx(i + 1, j), vtx(i + 1, j + 1), vtx(i, j + 1),
+                              q10, q11, q01);
+                }
+            }
+        }
+
+        return { hit, u_out, v_out, t_best };
+    }
+}
+
 MTS_VARIANT std::string Mesh<Float, Spectrum>::to_string() const {
     std::ostringstream oss;
     oss << class_()->name() << "[" << std::endl
@@ -503,6 +1637,14 @@ MTS_VARIANT std::string Mesh<Float, Spectrum>::to_string() const {
 MTS_VARIANT RTCGeometry Mesh<Float, Spectrum>::embree_geometry(RTCDevice device) const {
     RTCGeometry geom = rtcNewGeometry(device, RTC_GEOMETRY_TYPE_TRIANGLE);
 
+    if (unlikely(has_vertex_motion())) {
+        rtcSetGeometryTimeStepCount(geom, 2);
+        rtcSetGeometryTimeRange(geom, (float) m_motion_time_begin,
+                                (float) m_motion_time_end);
+        rtcSetSharedGeometryBuffer(geom, RTC_BUFFER_TYPE_VERTEX, 1, RTC_FORMAT_FLOAT3,
+                m_vertex_positions_end.get(), 0, 3 * sizeof(InputFloat), m_vertex_count);
+    }
+
     rtcSetSharedGeometryBuffer(geom, RTC_BUFFER_TYPE_VERTEX, 0, RTC_FORMAT_FLOAT3, m_vertices.get(),
             0, m_vertex_size, m_vertex_count);
     rtcSetSharedGeometryBuffer(geom, RTC_BUFFER_TYPE_INDEX, 0, RTC_FORMAT_UINT3, m_faces.get(),
@@ -589,6 +1731,16 @@ MTS_VARIANT void Mesh<Float, Spectrum>::parameters_changed() {
 
         if (m_area_distr.empty())
             area_distr_build();
+    } else {
+        /* Vertex positions may have moved: recompute the bounding box,
+           invalidate the area distribution (it is rebuilt lazily on the
+           next use), and flag the mesh so that the acceleration data
+           structure refits the affected subtrees. */
+        recompute_bbox();
+        m_area_distr = DiscreteDistribution<Float>();
+        if (has_intersection_data())
+            build_intersection_data();
+        mark_dirty();
     }
 }
 
@@ -606,9 +1758,17 @@ Result cuda_upload(size_t size, Func func) {
 
     Result result;
     for (size_t j = 0; j < Dim; ++j) {
-        void *dst = cuda_malloc(size * sizeof(ScalarValue));
-        cuda_memcpy_to_device_async(dst, tmp + j * size,
-                                    size * sizeof(ScalarValue));
+        size_t bytes = size * sizeof(ScalarValue);
+
+        /* Scenes that outgrow the device fall back to managed memory, which
+           the driver pages in and out on demand (see \ref
+           util::cuda_prefer_managed()). The explicit upload below then
+           doubles as a prefetch that migrates the pages to the device while
+           it still has room. */
+        void *dst = util::cuda_prefer_managed(bytes)
+                        ? cuda_managed_malloc(bytes)
+                        : cuda_malloc(bytes);
+        cuda_memcpy_to_device_async(dst, tmp + j * size, bytes);
         result[j] = CUDAArray<ScalarValue>::map(dst, size, true);
     }
 
@@ -695,6 +1855,9 @@ MTS_VARIANT RTgeometrytriangles Mesh<Float, Spectrum>::optix_geometry(RTcontext
 MTS_VARIANT void Mesh<Float, Spectrum>::traverse(TraversalCallback *callback) {
     Base::traverse(callback);
 
+    if (m_displacement)
+        callback->put_object("displacement", m_displacement.get());
+
     if constexpr (is_cuda_array_v<Float>) {
         callback->put_parameter("vertex_count",     m_vertex_count);
         callback->put_parameter("face_count",       m_face_count);
@@ -707,6 +1870,9 @@ MTS_VARIANT void Mesh<Float, Spectrum>::traverse(TraversalCallback *callback) {
 
 #else // MTS_ENABLE_OPTIX off
 MTS_VARIANT void Mesh<Float, Spectrum>::parameters_changed() {
+    recompute_bbox();
+    m_area_distr = DiscreteDistribution<Float>();
+    mark_dirty();
 }
 MTS_VARIANT void Mesh<Float, Spectrum>::traverse(TraversalCallback * /*callback*/) {
 }
@@ -2,6 +2,123 @@
 #include <mitsuba/render/bsdf.h>
 #include <mitsuba/render/shape.h>
 #include <mitsuba/core/properties.h>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+/// Number of packets processed per task in the batched BSDF bindings
+#define MTS_BSDF_BATCH_GRAIN_SIZE 64
+
+template <typename FloatP, typename SpectrumP, typename Class,
+          enable_if_t<!is_static_array_v<FloatP>> = 0>
+void bind_bsdf_batch(Class &) {
+    /* The batched entry points chunk dynamic inputs into native-width
+       packets; they only make sense in the packet variants */
+}
+
+template <typename FloatP, typename SpectrumP, typename Class,
+          enable_if_t<is_static_array_v<FloatP>> = 0>
+void bind_bsdf_batch(Class &bsdf_class) {
+    using Float    = make_dynamic_t<FloatP>;
+    using Spectrum = make_dynamic_t<SpectrumP>;
+    MTS_IMPORT_TYPES()
+    using BSDFPacket = mitsuba::BSDF<FloatP, SpectrumP>;
+
+    /* Broadcast a length-1 'active' argument (e.g. the default 'True') to
+       the number of evaluated directions */
+    auto expand_mask = [](Mask &active, size_t n, const char *name) {
+        if (slices(active) == 1 && n != 1)
+            active = full<Mask>(slice(active, 0), n);
+        else if (slices(active) != n)
+            Throw("%s: 'active' must have 1 or %i entries, got %i!",
+                  name, n, slices(active));
+    };
+
+    auto check_size = [](size_t m, size_t n, const char *name, const char *arg) {
+        if (m != n)
+            Throw("%s: '%s' must have %i entries, got %i!", name, arg, n, m);
+    };
+
+    bsdf_class.def("eval_batch",
+        [expand_mask, check_size](const BSDFPacket *bsdf, const BSDFContext &ctx,
+                                  const SurfaceInteraction3f &si, const Vector3f &wo,
+                                  Mask active) {
+            size_t n = slices(si);
+            check_size(slices(wo), n, "eval_batch()", "wo");
+            expand_mask(active, n, "eval_batch()");
+            Spectrum result = zero<Spectrum>(n);
+
+            size_t packet_count = packets(si);
+            py::gil_scoped_release release;
+            tbb::parallel_for(
+                tbb::blocked_range<size_t>(0, packet_count,
+                                           MTS_BSDF_BATCH_GRAIN_SIZE),
+                [&](const tbb::blocked_range<size_t> &range) {
+                    for (size_t i = range.begin(); i != range.end(); ++i)
+                        packet(result, i) =
+                            bsdf->eval(ctx, packet(si, i), packet(wo, i),
+                                       packet(active, i));
+                });
+
+            return result;
+        },
+        "ctx"_a, "si"_a, "wo"_a, "active"_a = true, D(BSDF, eval_batch));
+
+    bsdf_class.def("pdf_batch",
+        [expand_mask, check_size](const BSDFPacket *bsdf, const BSDFContext &ctx,
+                                  const SurfaceInteraction3f &si, const Vector3f &wo,
+                                  Mask active) {
+            size_t n = slices(si);
+            check_size(slices(wo), n, "pdf_batch()", "wo");
+            expand_mask(active, n, "pdf_batch()");
+            Float result = zero<Float>(n);
+
+            size_t packet_count = packets(si);
+            py::gil_scoped_release release;
+            tbb::parallel_for(
+                tbb::blocked_range<size_t>(0, packet_count,
+                                           MTS_BSDF_BATCH_GRAIN_SIZE),
+                [&](const tbb::blocked_range<size_t> &range) {
+                    for (size_t i = range.begin(); i != range.end(); ++i)
+                        packet(result, i) =
+                            bsdf->pdf(ctx, packet(si, i), packet(wo, i),
+                                      packet(active, i));
+                });
+
+            return result;
+        },
+        "ctx"_a, "si"_a, "wo"_a, "active"_a = true, D(BSDF, pdf_batch));
+
+    bsdf_class.def("sample_batch",
+        [expand_mask, check_size](const BSDFPacket *bsdf, const BSDFContext &ctx,
+                                  const SurfaceInteraction3f &si, const Float &sample1,
+                                  const Point2f &sample2, Mask active) {
+            size_t n = slices(si);
+            check_size(slices(sample1), n, "sample_batch()", "sample1");
+            check_size(slices(sample2), n, "sample_batch()", "sample2");
+            expand_mask(active, n, "sample_batch()");
+            BSDFSample3f bs = zero<BSDFSample3f>(n);
+            Spectrum value  = zero<Spectrum>(n);
+
+            size_t packet_count = packets(si);
+            py::gil_scoped_release release;
+            tbb::parallel_for(
+                tbb::blocked_range<size_t>(0, packet_count,
+                                           MTS_BSDF_BATCH_GRAIN_SIZE),
+                [&](const tbb::blocked_range<size_t> &range) {
+                    for (size_t i = range.begin(); i != range.end(); ++i) {
+                        auto [bs_i, value_i] =
+                            bsdf->sample(ctx, packet(si, i), packet(sample1, i),
+                                         packet(sample2, i), packet(active, i));
+                        packet(bs, i)    = bs_i;
+                        packet(value, i) = value_i;
+                    }
+                });
+
+            return std::make_pair(bs, value);
+        },
+        "ctx"_a, "si"_a, "sample1"_a, "sample2"_a, "active"_a = true,
+        D(BSDF, sample_batch));
+}
 
 MTS_PY_EXPORT(BSDFSample) {
     MTS_PY_IMPORT_TYPES_DYNAMIC()
@@ -83,6 +200,8 @@ MTS_PY_EXPORT(BSDF) {
         .def("__repr__", &BSDF::to_string)
         ;
 
+    bind_bsdf_batch<Float, Spectrum>(bsdf);
+
     if constexpr (is_cuda_array_v<Float>) {
         pybind11_type_alias<UInt64, BSDFPtr>();
         pybind11_type_alias<UInt32, replace_scalar_t<Float, BSDFFlags>>();
@@ -12,6 +12,7 @@ MTS_PY_EXPORT(Film) {
     MTS_PY_CLASS(Film, Object)
         .def_method(Film, prepare, "channels"_a)
         .def_method(Film, put, "block"_a)
+        .def_method(Film, clear_region, "offset"_a, "size"_a)
         .def_method(Film, set_destination_file, "filename"_a)
         .def("develop", py::overload_cast<>(&Film::develop))
         .def("develop", py::overload_cast<const ScalarPoint2i &, const ScalarVector2i &,
@@ -4,7 +4,8 @@
 
 MTS_PY_EXPORT(ImageBlock) {
     MTS_PY_IMPORT_TYPES(ImageBlock, ReconstructionFilter)
-    MTS_PY_CLASS(ImageBlock, Object)
+    auto block = MTS_PY_CLASS(ImageBlock, Object, py::buffer_protocol());
+    block
         .def(py::init<const ScalarVector2i &, size_t,
                 const ReconstructionFilter *, bool, bool, bool, bool>(),
             "size"_a, "channel_count"_a, "filter"_a = nullptr,
@@ -25,6 +26,9 @@ MTS_PY_EXPORT(ImageBlock) {
                 ib.put(pos, data.data(), mask);
             }, "pos"_a, "data"_a, "active"_a = true)
         .def_method(ImageBlock, clear)
+        .def_method(ImageBlock, set_track_variance, "value"_a)
+        .def_method(ImageBlock, track_variance)
+        .def_method(ImageBlock, error_estimate)
         .def_method(ImageBlock, set_offset, "offset"_a)
         .def_method(ImageBlock, offset)
         .def_method(ImageBlock, size)
@@ -37,4 +41,21 @@ MTS_PY_EXPORT(ImageBlock) {
         .def_method(ImageBlock, border_size)
         .def_method(ImageBlock, channel_count)
         .def("data", py::overload_cast<>(&ImageBlock::data, py::const_), D(ImageBlock, data));
+
+    /* On CPU variants, additionally expose the accumulation buffer (including
+       its border region) as a writable buffer-protocol view so that film
+       readback does not need to copy. */
+    if constexpr (!is_cuda_array_v<Float> && !is_diff_array_v<Float>) {
+        block.def_buffer([](ImageBlock &b) -> py::buffer_info {
+            size_t ch     = b.channel_count(),
+                   width  = b.width()  + 2 * b.border_size(),
+                   height = b.height() + 2 * b.border_size(),
+                   cs     = sizeof(ScalarFloat);
+            return py::buffer_info(
+                b.data().data(), cs, py::format_descriptor<ScalarFloat>::format(), 3,
+                { height, width, ch },
+                { cs * width * ch, cs * ch, cs }
+            );
+        });
+    }
 }
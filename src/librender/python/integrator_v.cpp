@@ -1,8 +1,17 @@
 #include <mitsuba/python/python.h>
+#include <mitsuba/core/appender.h>
+#include <mitsuba/core/bitmap.h>
 #include <mitsuba/render/integrator.h>
+#include <mitsuba/render/film.h>
+#include <mitsuba/render/sensor.h>
+#include <mitsuba/core/logger.h>
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/thread.h>
 #include <mitsuba/core/tls.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 #if defined(__APPLE__) || defined(__linux__)
 #  define MTS_HANDLE_SIGINT 1
@@ -20,6 +29,147 @@ static std::function<void()> sigint_handler;
 static void (*sigint_handler_prev)(int) = nullptr;
 #endif
 
+/// Forwards progress messages emitted via \ref ProgressReporter to a callback
+class CallbackAppender : public mitsuba::Appender {
+public:
+    using Callback = std::function<void(float, const std::string &)>;
+
+    CallbackAppender(Callback callback) : m_callback(std::move(callback)) { }
+
+    void append(mitsuba::LogLevel, const std::string &) override { }
+
+    void log_progress(float progress, const std::string &, const std::string &,
+                      const std::string &eta, const void *) override {
+        m_callback(progress, eta);
+    }
+
+private:
+    Callback m_callback;
+};
+
+/**
+ * \brief Background rendering job returned by \c Integrator.render_async()
+ *
+ * Runs \ref Integrator::render() on a dedicated thread that inherits the
+ * caller's thread environment (logger, file resolver). Progress messages
+ * emitted during the render are intercepted by temporarily registering a
+ * \ref CallbackAppender with the shared logger.
+ */
+MTS_VARIANT class AsyncRenderJob : public Object {
+public:
+    MTS_IMPORT_TYPES(Integrator, Scene, Sensor)
+
+    AsyncRenderJob(Integrator *integrator, Scene *scene, Sensor *sensor,
+                   CallbackAppender::Callback progress)
+        : m_integrator(integrator), m_scene(scene), m_sensor(sensor) {
+        if (progress) {
+            m_appender = new CallbackAppender(std::move(progress));
+            Thread::thread()->logger()->add_appender(m_appender);
+        }
+
+        ThreadEnvironment env;
+        m_thread = std::thread([this, env]() mutable {
+            ScopedSetThreadEnvironment set_env(env);
+            bool result = false;
+            try {
+                result = m_integrator->render(m_scene, m_sensor);
+            } catch (...) {
+                m_error = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_done = true;
+            m_result = result;
+            m_cond.notify_all();
+        });
+    }
+
+    /**
+     * \brief Wait until the job has finished, or for at most \c timeout
+     * seconds when a non-negative value is given. Returns whether the job
+     * has finished.
+     */
+    bool wait(float timeout) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (timeout >= 0.f)
+            m_cond.wait_for(lock, std::chrono::duration<float>(timeout),
+                            [this] { return m_done; });
+        else
+            m_cond.wait(lock, [this] { return m_done; });
+        return m_done;
+    }
+
+    /// Has the rendering job finished (successfully or not)?
+    bool done() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_done;
+    }
+
+    /// Return the value of render(); only valid once the job has finished
+    bool result() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_done)
+                Throw("AsyncRenderJob::result(): the rendering job has not "
+                      "finished yet -- use wait()!");
+        }
+        finish();
+        if (m_error)
+            std::rethrow_exception(m_error);
+        return m_result;
+    }
+
+    /// Request that the render winds down at the next opportunity
+    void cancel() { m_integrator->cancel(); }
+
+    /**
+     * \brief Develop a copy of the current film contents
+     *
+     * May be invoked while the render is still in progress; blocks that are
+     * being merged concurrently may only be partially visible in the
+     * returned bitmap.
+     */
+    ref<Bitmap> film_snapshot(bool raw) const {
+        return m_sensor->film()->bitmap(raw);
+    }
+
+protected:
+    ~AsyncRenderJob() {
+        m_integrator->cancel();
+        /* When Python drops the last reference, the GIL is held -- release
+           it so that an in-flight progress callback cannot deadlock the
+           join below */
+        if (PyGILState_Check()) {
+            py::gil_scoped_release release;
+            finish();
+        } else {
+            finish();
+        }
+    }
+
+private:
+    /// Join the worker thread and unhook the progress appender
+    void finish() {
+        if (m_thread.joinable())
+            m_thread.join();
+        if (m_appender) {
+            Thread::thread()->logger()->remove_appender(m_appender);
+            m_appender = nullptr;
+        }
+    }
+
+private:
+    ref<Integrator> m_integrator;
+    ref<Scene> m_scene;
+    ref<Sensor> m_sensor;
+    ref<Appender> m_appender;
+    std::thread m_thread;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::exception_ptr m_error;
+    bool m_done = false;
+    bool m_result = false;
+};
+
 /// Trampoline for derived types implemented in Python
 MTS_VARIANT class PySamplingIntegrator : public SamplingIntegrator<Float, Spectrum> {
 public:
@@ -72,6 +222,16 @@ void bind_integrator_sample(Class &integrator) {
             return std::make_tuple(spec, mask, aovs);
         },
         "scene"_a, "sampler"_a, "ray"_a, "active"_a = true, D(SamplingIntegrator, sample));
+
+    /// Python compatibility wrapper around SamplingIntegrator::sample_adjoint()
+    integrator.def(
+        "sample_adjoint",
+        [](const SamplingIntegrator *integrator, const Scene *scene, Sampler *sampler,
+           const RayDifferential3f &ray, const Spectrum &adjoint, Mask active) {
+            integrator->sample_adjoint(scene, sampler, ray, adjoint, active);
+        },
+        "scene"_a, "sampler"_a, "ray"_a, "adjoint"_a, "active"_a = true,
+        D(SamplingIntegrator, sample_adjoint));
 }
 
 template <typename FloatP, typename SpectrumP, typename Class,
@@ -112,11 +272,44 @@ void bind_integrator_sample(Class &integrator) {
             return std::make_tuple(result_spec, result_mask, result_aovs);
         },
         "scene"_a, "sampler"_a, "ray"_a, "active"_a = true, D(SamplingIntegrator, sample));
+
+    /// Python compatibility wrapper around SamplingIntegrator::sample_adjoint(), packet tracing
+    integrator.def(
+        "sample_adjoint",
+        [](const SamplingIntegrator *integrator, const Scene *scene, Sampler *sampler,
+           const RayDifferential3f &ray, const Spectrum &adjoint, Mask active) {
+            set_slices(active, slices(ray));
+            for (size_t i = 0; i < packets(ray); ++i)
+                integrator->sample_adjoint(scene, sampler, packet(ray, i),
+                                           packet(adjoint, i), packet(active, i));
+        },
+        "scene"_a, "sampler"_a, "ray"_a, "adjoint"_a, "active"_a = true,
+        D(SamplingIntegrator, sample_adjoint));
 }
 
 MTS_PY_EXPORT(Integrator) {
     MTS_PY_IMPORT_TYPES()
     using PySamplingIntegrator = PySamplingIntegrator<Float, Spectrum>;
+    using AsyncRenderJob = AsyncRenderJob<Float, Spectrum>;
+
+    py::class_<AsyncRenderJob, Object, ref<AsyncRenderJob>>(
+            m, "AsyncRenderJob", D(AsyncRenderJob))
+        .def("wait",
+            [](AsyncRenderJob &job, float timeout) {
+                py::gil_scoped_release release;
+                return job.wait(timeout);
+            },
+            "timeout"_a = -1.f, D(AsyncRenderJob, wait))
+        .def("done", &AsyncRenderJob::done, D(AsyncRenderJob, done))
+        .def("result",
+            [](AsyncRenderJob &job) {
+                py::gil_scoped_release release;
+                return job.result();
+            },
+            D(AsyncRenderJob, result))
+        .def("cancel", &AsyncRenderJob::cancel, D(AsyncRenderJob, cancel))
+        .def("film_snapshot", &AsyncRenderJob::film_snapshot,
+             "raw"_a = false, D(AsyncRenderJob, film_snapshot));
 
     MTS_PY_CLASS(Integrator, Object)
         .def("render",
@@ -150,6 +343,24 @@ MTS_PY_EXPORT(Integrator) {
                 return res;
             },
             D(Integrator, render), "scene"_a, "sensor"_a)
+        .def("render_async",
+            [&](Integrator *integrator, Scene *scene, Sensor *sensor,
+                py::object progress_callback) {
+                std::function<void(float, const std::string &)> progress;
+                if (!progress_callback.is_none()) {
+                    py::function func = progress_callback.cast<py::function>();
+                    progress = [func](float value, const std::string &eta) {
+                        // Progress messages arrive from the render thread
+                        py::gil_scoped_acquire gil;
+                        func(value, eta);
+                    };
+                }
+
+                return new AsyncRenderJob(integrator, scene, sensor,
+                                          std::move(progress));
+            },
+            D(Integrator, render_async), "scene"_a, "sensor"_a,
+            "progress_callback"_a = py::none())
         .def_method(Integrator, cancel);
 
     auto integrator =
@@ -157,7 +368,26 @@ MTS_PY_EXPORT(Integrator) {
                     ref<SamplingIntegrator>>(m, "SamplingIntegrator", D(SamplingIntegrator))
             .def(py::init<const Properties&>())
             .def_method(SamplingIntegrator, aov_names)
-            .def_method(SamplingIntegrator, should_stop);
+            .def_method(SamplingIntegrator, should_stop)
+            .def("render_region",
+                [&](SamplingIntegrator *integrator, Scene *scene, Sensor *sensor,
+                    const ScalarPoint2i &offset, const ScalarVector2i &size) {
+                    py::gil_scoped_release release;
+                    return integrator->render_region(scene, sensor, offset, size);
+                },
+                "scene"_a, "sensor"_a, "offset"_a, "size"_a,
+                D(SamplingIntegrator, render_region))
+            .def("set_preview_callback",
+                [](SamplingIntegrator &integrator, py::function callback) {
+                    integrator.set_preview_callback(
+                        [callback](const ScalarPoint2i &offset,
+                                   const Bitmap *tile, size_t pass) {
+                            // Tiles arrive from render worker threads
+                            py::gil_scoped_acquire gil;
+                            callback(offset, py::cast(tile), pass);
+                        });
+                },
+                "callback"_a, D(SamplingIntegrator, set_preview_callback));
 
     bind_integrator_sample<Float, Spectrum>(integrator);
 
@@ -135,6 +135,9 @@ MTS_PY_EXPORT(SurfaceInteraction) {
             D(SurfaceInteraction, bsdf, 2))
         .def("compute_partials", &SurfaceInteraction3f::compute_partials, "ray"_a,
             D(SurfaceInteraction, compute_partials))
+        .def("finalize_surface_interaction",
+            &SurfaceInteraction3f::finalize_surface_interaction,
+            "ray"_a, "active"_a = true)
         .def("has_uv_partials", &SurfaceInteraction3f::has_uv_partials,
             D(SurfaceInteraction, has_uv_partials))
         // .def("normal_derivative", &SurfaceInteraction3f::normal_derivative, D(SurfaceInteraction, normal_derivative)) // TODO
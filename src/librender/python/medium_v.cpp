@@ -42,6 +42,8 @@ MTS_PY_EXPORT(Medium) {
             .def("get_scattering_coefficients", vectorize(&Medium::get_scattering_coefficients), "mi"_a, "active"_a=true)
             .def("sample_interaction", vectorize(&Medium::sample_interaction), "ray"_a, "sample"_a, "channel"_a, "active"_a=true)
             .def("eval_tr_and_pdf", vectorize(&Medium::eval_tr_and_pdf), "mi"_a, "si"_a, "active"_a=true)
+            .def("eval_transmittance", &Medium::eval_transmittance, "ray"_a, "sampler"_a, "channel"_a, "active"_a=true)
+            .def_method(Medium, has_dedicated_transmittance)
             .def_method(Medium, phase_function)
             .def_method(Medium, use_emitter_sampling)
             // .def_method(Medium, is_homogeneous)
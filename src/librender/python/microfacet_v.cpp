@@ -1,11 +1,113 @@
 #include <mitsuba/python/python.h>
 #include <mitsuba/core/properties.h>
 #include <mitsuba/render/microfacet.h>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+/// Number of packets processed per task in the batched microfacet bindings
+#define MTS_MICROFACET_BATCH_GRAIN_SIZE 256
+
+template <typename FloatP, typename SpectrumP, typename Class,
+          enable_if_t<!is_static_array_v<FloatP>> = 0>
+void bind_microfacet_batch(Class &) {
+    /* The batched entry points chunk dynamic inputs into native-width
+       packets; they only make sense in the packet variants */
+}
+
+template <typename FloatP, typename SpectrumP, typename Class,
+          enable_if_t<is_static_array_v<FloatP>> = 0>
+void bind_microfacet_batch(Class &md_class) {
+    using Float    = make_dynamic_t<FloatP>;
+    using Spectrum = make_dynamic_t<SpectrumP>;
+    MTS_IMPORT_TYPES()
+    using MicrofacetPacket = mitsuba::MicrofacetDistribution<FloatP, SpectrumP>;
+
+    auto check_size = [](size_t m, size_t n, const char *name, const char *arg) {
+        if (m != n)
+            Throw("%s: '%s' must have %i entries, got %i!", name, arg, n, m);
+    };
+
+    /* Run 'func' over all native-width packets of the inputs in parallel
+       with the GIL released, writing one output packet each */
+    auto run = [](size_t packet_count, auto &&func) {
+        py::gil_scoped_release release;
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, packet_count,
+                                       MTS_MICROFACET_BATCH_GRAIN_SIZE),
+            [&](const tbb::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i != range.end(); ++i)
+                    func(i);
+            });
+    };
+
+    md_class.def("eval_batch",
+        [run](const MicrofacetPacket &d, const Vector3f &m) {
+            Float result = zero<Float>(slices(m));
+            run(packets(m), [&](size_t i) {
+                packet(result, i) = d.eval(packet(m, i));
+            });
+            return result;
+        },
+        "m"_a, D(MicrofacetDistribution, eval_batch));
+
+    md_class.def("pdf_batch",
+        [run, check_size](const MicrofacetPacket &d, const Vector3f &wi,
+                          const Vector3f &m) {
+            check_size(slices(m), slices(wi), "pdf_batch()", "m");
+            Float result = zero<Float>(slices(wi));
+            run(packets(wi), [&](size_t i) {
+                packet(result, i) = d.pdf(packet(wi, i), packet(m, i));
+            });
+            return result;
+        },
+        "wi"_a, "m"_a, D(MicrofacetDistribution, pdf_batch));
+
+    md_class.def("smith_g1_batch",
+        [run, check_size](const MicrofacetPacket &d, const Vector3f &v,
+                          const Vector3f &m) {
+            check_size(slices(m), slices(v), "smith_g1_batch()", "m");
+            Float result = zero<Float>(slices(v));
+            run(packets(v), [&](size_t i) {
+                packet(result, i) = d.smith_g1(packet(v, i), packet(m, i));
+            });
+            return result;
+        },
+        "v"_a, "m"_a, D(MicrofacetDistribution, smith_g1_batch));
+
+    md_class.def("G_batch",
+        [run, check_size](const MicrofacetPacket &d, const Vector3f &wi,
+                          const Vector3f &wo, const Vector3f &m) {
+            check_size(slices(wo), slices(wi), "G_batch()", "wo");
+            check_size(slices(m), slices(wi), "G_batch()", "m");
+            Float result = zero<Float>(slices(wi));
+            run(packets(wi), [&](size_t i) {
+                packet(result, i) = d.G(packet(wi, i), packet(wo, i),
+                                        packet(m, i));
+            });
+            return result;
+        },
+        "wi"_a, "wo"_a, "m"_a, D(MicrofacetDistribution, G_batch));
+
+    md_class.def("sample_batch",
+        [run, check_size](const MicrofacetPacket &d, const Vector3f &wi,
+                          const Point2f &sample) {
+            check_size(slices(sample), slices(wi), "sample_batch()", "sample");
+            Normal3f m = zero<Normal3f>(slices(wi));
+            Float pdf  = zero<Float>(slices(wi));
+            run(packets(wi), [&](size_t i) {
+                auto [m_i, pdf_i] = d.sample(packet(wi, i), packet(sample, i));
+                packet(m, i)   = m_i;
+                packet(pdf, i) = pdf_i;
+            });
+            return std::make_pair(m, pdf);
+        },
+        "wi"_a, "sample"_a, D(MicrofacetDistribution, sample_batch));
+}
 
 MTS_PY_EXPORT(MicrofacetDistribution) {
     MTS_PY_IMPORT_TYPES(MicrofacetDistribution)
 
-    py::class_<MicrofacetDistribution>(m, "MicrofacetDistribution", D(MicrofacetDistribution))
+    auto md = py::class_<MicrofacetDistribution>(m, "MicrofacetDistribution", D(MicrofacetDistribution))
         // TODO is this needed?
         .def(py::init([](MicrofacetType t, ScalarFloat alpha, bool sv) {
             return MicrofacetDistribution(t, alpha, sv);
@@ -40,6 +142,8 @@ MTS_PY_EXPORT(MicrofacetDistribution) {
             "cos_theta_i"_a, "sample"_a, D(MicrofacetDistribution, sample_visible_11))
         .def_repr(MicrofacetDistribution);
 
+    bind_microfacet_batch<Float, Spectrum>(md);
+
     m.def("eval_reflectance",
         [](MicrofacetType type, float alpha_u, float alpha_v,
            const Vector<DynamicArray<Packet<float>>, 3> &wi_,
@@ -27,6 +27,7 @@ MTS_PY_EXPORT(PositionSample) {
         .def_readwrite("pdf",    &PositionSample3f::pdf,    D(PositionSample, pdf))
         .def_readwrite("delta",  &PositionSample3f::delta,  D(PositionSample, delta))
         .def_readwrite("object", &PositionSample3f::object, D(PositionSample, object))
+        .def_readwrite("prim_index", &PositionSample3f::prim_index, D(PositionSample, prim_index))
         .def_repr(PositionSample3f);
 
     bind_set_object<PositionSample3f>(pos);
@@ -9,6 +9,7 @@ MTS_PY_EXPORT(Sampler) {
         .def_method(Sampler, wavefront_size)
         .def("seed", vectorize(&Sampler::seed),
              "seed_value"_a, D(Sampler, seed))
+        .def_method(Sampler, advance)
         .def("next_1d", vectorize(&Sampler::next_1d),
              "active"_a = true, D(Sampler, next_1d))
         .def("next_2d", vectorize(&Sampler::next_2d),
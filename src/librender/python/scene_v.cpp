@@ -5,6 +5,77 @@
 #include <mitsuba/render/kdtree.h>
 #include <mitsuba/render/sensor.h>
 #include <mitsuba/python/python.h>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+/// Number of packets processed per task in the batched intersection bindings
+#define MTS_RAY_BATCH_GRAIN_SIZE 64
+
+template <typename FloatP, typename SpectrumP, typename Class,
+          enable_if_t<!is_static_array_v<FloatP>> = 0>
+void bind_scene_batch(Class &) {
+    /* The batched entry points chunk dynamic inputs into native-width
+       packets; they only make sense in the packet variants */
+}
+
+template <typename FloatP, typename SpectrumP, typename Class,
+          enable_if_t<is_static_array_v<FloatP>> = 0>
+void bind_scene_batch(Class &scene_class) {
+    using Float    = make_dynamic_t<FloatP>;
+    using Spectrum = make_dynamic_t<SpectrumP>;
+    MTS_IMPORT_TYPES()
+    using ScenePacket = mitsuba::Scene<FloatP, SpectrumP>;
+
+    /* Broadcast a length-1 'active' argument (e.g. the default 'True') to
+       the number of traced rays */
+    auto expand_mask = [](Mask &active, size_t n, const char *name) {
+        if (slices(active) == 1 && n != 1)
+            active = full<Mask>(slice(active, 0), n);
+        else if (slices(active) != n)
+            Throw("%s: 'active' must have 1 or %i entries, got %i!",
+                  name, n, slices(active));
+    };
+
+    scene_class.def("ray_intersect_batch",
+        [expand_mask](const ScenePacket *scene, const Ray3f &ray, Mask active) {
+            expand_mask(active, slices(ray), "ray_intersect_batch()");
+            SurfaceInteraction3f si = zero<SurfaceInteraction3f>(slices(ray));
+
+            size_t packet_count = packets(ray);
+            py::gil_scoped_release release;
+            tbb::parallel_for(
+                tbb::blocked_range<size_t>(0, packet_count,
+                                           MTS_RAY_BATCH_GRAIN_SIZE),
+                [&](const tbb::blocked_range<size_t> &range) {
+                    for (size_t i = range.begin(); i != range.end(); ++i)
+                        packet(si, i) = scene->ray_intersect(packet(ray, i),
+                                                             packet(active, i));
+                });
+
+            return si;
+        },
+        "ray"_a, "active"_a = true, D(Scene, ray_intersect_batch));
+
+    scene_class.def("ray_test_batch",
+        [expand_mask](const ScenePacket *scene, const Ray3f &ray, Mask active) {
+            expand_mask(active, slices(ray), "ray_test_batch()");
+            Mask hit = zero<Mask>(slices(ray));
+
+            size_t packet_count = packets(ray);
+            py::gil_scoped_release release;
+            tbb::parallel_for(
+                tbb::blocked_range<size_t>(0, packet_count,
+                                           MTS_RAY_BATCH_GRAIN_SIZE),
+                [&](const tbb::blocked_range<size_t> &range) {
+                    for (size_t i = range.begin(); i != range.end(); ++i)
+                        packet(hit, i) = scene->ray_test(packet(ray, i),
+                                                         packet(active, i));
+                });
+
+            return hit;
+        },
+        "ray"_a, "active"_a = true, D(Scene, ray_test_batch));
+}
 
 MTS_PY_EXPORT(ShapeKDTree) {
     MTS_PY_IMPORT_TYPES(ShapeKDTree, Shape, Mesh)
@@ -36,11 +107,16 @@ MTS_PY_EXPORT(ShapeKDTree) {
 #if 1
 MTS_PY_EXPORT(Scene) {
     MTS_PY_IMPORT_TYPES(Scene, Integrator, SamplingIntegrator, MonteCarloIntegrator, Sensor)
-    MTS_PY_CLASS(Scene, Object)
+    auto scene = MTS_PY_CLASS(Scene, Object)
         .def(py::init<const Properties>())
         .def("ray_intersect",
-            vectorize(&Scene::ray_intersect),
+            vectorize(py::overload_cast<const Ray3f &, Mask>(
+                &Scene::ray_intersect, py::const_)),
             "ray"_a, "active"_a = true, D(Scene, ray_intersect))
+        .def("ray_intersect",
+            vectorize(py::overload_cast<const Ray3f &, uint32_t, Mask>(
+                &Scene::ray_intersect, py::const_)),
+            "ray"_a, "hit_flags"_a, "active"_a = true)
         .def("ray_test",
             vectorize(&Scene::ray_test),
             "ray"_a, "active"_a = true)
@@ -72,5 +148,7 @@ MTS_PY_EXPORT(Scene) {
             },
             D(Scene, integrator))
         .def("__repr__", &Scene::to_string);
+
+    bind_scene_batch<Float, Spectrum>(scene);
 }
 #endif
\ No newline at end of file
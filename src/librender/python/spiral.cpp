@@ -11,5 +11,7 @@ MTS_PY_EXPORT(Spiral) {
         .def_method(Spiral, block_count)
         .def_method(Spiral, reset)
         .def_method(Spiral, set_passes)
-        .def_method(Spiral, next_block);
+        .def("next_block",
+            [](Spiral &s) { return s.next_block(); },
+            D(Spiral, next_block));
 }
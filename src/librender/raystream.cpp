@@ -0,0 +1,101 @@
+#include <mitsuba/core/fstream.h>
+#include <mitsuba/core/logger.h>
+#include <mitsuba/render/raystream.h>
+#include <cstring>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/// Per-thread buffer size: flushes happen every ~448 KiB of raw ray data
+static constexpr size_t ChunkSize = 16384;
+
+RayStreamRecorder::RayStreamRecorder(const fs::path &filename)
+    : m_ray_count(0) {
+    m_stream = new ZStream(
+        new FileStream(filename, FileStream::ETruncReadWrite));
+
+    /* The header is written through the compressor as well, which keeps
+       the reader symmetric (a single ZStream over the whole file). */
+    m_stream->write(Magic, strlen(Magic) + 1);
+    m_stream->write(Version);
+}
+
+RayStreamRecorder::~RayStreamRecorder() {
+    close();
+}
+
+void RayStreamRecorder::record(const Record &rec) {
+    std::vector<Record> &buffer = m_buffers.local();
+    if (buffer.capacity() == 0)
+        buffer.reserve(ChunkSize);
+
+    buffer.push_back(rec);
+    m_ray_count.fetch_add(1, std::memory_order_relaxed);
+
+    if (buffer.size() == ChunkSize) {
+        std::lock_guard<tbb::spin_mutex> lock(m_mutex);
+        flush(buffer);
+    }
+}
+
+void RayStreamRecorder::flush(std::vector<Record> &buffer) {
+    if (buffer.empty())
+        return;
+    m_stream->write((uint64_t) buffer.size());
+    m_stream->write_array((const float *) buffer.data(),
+                          buffer.size() * 7);
+    buffer.clear();
+}
+
+void RayStreamRecorder::close() {
+    if (!m_stream || m_stream->is_closed())
+        return;
+
+    std::lock_guard<tbb::spin_mutex> lock(m_mutex);
+    for (std::vector<Record> &buffer : m_buffers)
+        flush(buffer);
+
+    // A zero-length chunk terminates the stream
+    m_stream->write((uint64_t) 0);
+    m_stream->close();
+
+    Log(Info, "Ray stream capture finished: %i rays.", ray_count());
+}
+
+RayStreamReader::RayStreamReader(const fs::path &filename) {
+    m_stream = new ZStream(new FileStream(filename, FileStream::ERead));
+
+    char magic[8];
+    uint32_t version;
+    m_stream->read(magic, sizeof(magic));
+    m_stream->read(version);
+
+    if (memcmp(magic, RayStreamRecorder::Magic, sizeof(magic)) != 0)
+        Throw("\"%s\": not a captured ray stream!", filename.string());
+    if (version != RayStreamRecorder::Version)
+        Throw("\"%s\": unsupported ray stream version %i (expected %i)!",
+              filename.string(), version, RayStreamRecorder::Version);
+}
+
+bool RayStreamReader::next_chunk(std::vector<Record> &records) {
+    records.clear();
+
+    uint64_t count;
+    m_stream->read(count);
+    if (count == 0)
+        return false;
+
+    records.resize((size_t) count);
+    m_stream->read_array((float *) records.data(), (size_t) count * 7);
+    return true;
+}
+
+std::vector<RayStreamReader::Record> RayStreamReader::read_all() {
+    std::vector<Record> result, chunk;
+    while (next_chunk(chunk))
+        result.insert(result.end(), chunk.begin(), chunk.end());
+    return result;
+}
+
+MTS_IMPLEMENT_CLASS(RayStreamRecorder, Object)
+MTS_IMPLEMENT_CLASS(RayStreamReader, Object)
+NAMESPACE_END(mitsuba)
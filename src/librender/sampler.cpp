@@ -13,6 +13,10 @@ MTS_VARIANT Sampler<Float, Spectrum>::~Sampler() { }
 
 MTS_VARIANT void Sampler<Float, Spectrum>::seed(UInt64) { NotImplementedError("seed"); }
 
+MTS_VARIANT void Sampler<Float, Spectrum>::set_pixel(const Point2u &) { }
+
+MTS_VARIANT void Sampler<Float, Spectrum>::advance() { }
+
 MTS_VARIANT Float Sampler<Float, Spectrum>::next_1d(Mask) { NotImplementedError("next_1d"); }
 
 MTS_VARIANT typename Sampler<Float, Spectrum>::Point2f Sampler<Float, Spectrum>::next_2d(Mask) {
@@ -4,6 +4,9 @@
 #include <mitsuba/render/medium.h>
 #include <mitsuba/render/scene.h>
 #include <mitsuba/render/kdtree.h>
+#include <mitsuba/render/lightbvh.h>
+#include <mitsuba/render/viscache.h>
+#include <mitsuba/render/raystream.h>
 #include <mitsuba/render/integrator.h>
 #include <enoki/stl.h>
 
@@ -106,6 +109,46 @@ MTS_VARIANT Scene<Float, Spectrum>::Scene(const Properties &props) {
         if (!emitter->shape())
             Throw("Surface emitter was not attached to any shape: %s", emitter);
     }
+
+    // Detect whether any participating media are present (see has_media())
+    for (const Shape *shape : m_shapes)
+        m_has_media |= shape->is_medium_transition();
+    for (const Sensor *sensor : m_sensors)
+        m_has_media |= sensor->medium() != nullptr;
+    for (const Emitter *emitter : m_emitters)
+        m_has_media |= emitter->medium() != nullptr;
+
+    /* Arrange the emitters into a hierarchy for many-light sampling. The
+       traversal runs on the host, hence GPU variants retain the uniform
+       selection strategy. */
+    if constexpr (!is_cuda_array_v<Float>) {
+        if (m_emitters.size() > 1 && props.bool_("light_bvh", true))
+            m_light_bvh = new LightBVH(m_emitters, m_bbox);
+    }
+
+    /* Optional conservative cache of shadow ray outcomes for emitter
+       sampling (see \ref VisibilityCache). Approximate, hence disabled
+       unless explicitly requested. */
+    if constexpr (!is_array_v<Float>) {
+        if (!m_emitters.empty() && props.bool_("visibility_cache", false))
+            m_vis_cache = new VisibilityCache(
+                m_bbox, (uint32_t) props.size_("visibility_cache_resolution", 128));
+    }
+
+    /* Opt-in capture of the rays traced through \ref ray_intersect() for
+       offline acceleration structure tuning -- the resulting file can be
+       re-traced against rebuilt structures via 'mitsuba-bench --replay' */
+    if constexpr (!is_cuda_array_v<Float>) {
+        std::string capture = props.string("capture_rays", "");
+        if (!capture.empty()) {
+            m_ray_recorder = new RayStreamRecorder(capture);
+            Log(Info, "Capturing ray streams to \"%s\" ..", capture);
+        }
+    }
+
+    /* Index the named parameters exposed by the scene graph, enabling
+       in-place updates without a scene reload (see \ref parameters()) */
+    m_params.build(this);
 }
 
 MTS_VARIANT Scene<Float, Spectrum>::~Scene() {
@@ -117,12 +160,41 @@ MTS_VARIANT Scene<Float, Spectrum>::~Scene() {
 
 MTS_VARIANT typename Scene<Float, Spectrum>::SurfaceInteraction3f
 Scene<Float, Spectrum>::ray_intersect(const Ray3f &ray, Mask active) const {
+    return ray_intersect(ray, +HitFlags::All, active);
+}
+
+MTS_VARIANT typename Scene<Float, Spectrum>::SurfaceInteraction3f
+Scene<Float, Spectrum>::ray_intersect(const Ray3f &ray, uint32_t hit_flags, Mask active) const {
     MTS_MASKED_FUNCTION(ProfilerPhase::RayIntersect, active);
+    MTS_STAT_ADD(IntersectRays, count(active));
 
-    if constexpr (is_cuda_array_v<Float>)
+    if constexpr (is_cuda_array_v<Float>) {
+        // The GPU backend always populates all fields
+        ENOKI_MARK_USED(hit_flags);
         return ray_intersect_gpu(ray, active);
-    else
-        return ray_intersect_cpu(ray, active);
+    } else {
+        if (unlikely(m_ray_recorder))
+            capture_ray(ray, active);
+        return ray_intersect_cpu(ray, hit_flags, active);
+    }
+}
+
+MTS_VARIANT void Scene<Float, Spectrum>::capture_ray(const Ray3f &ray, Mask active) const {
+    if constexpr (is_cuda_array_v<Float>) {
+        ENOKI_MARK_USED(ray);
+        ENOKI_MARK_USED(active);
+    } else {
+        for (size_t i = 0; i < slices(ray.o); ++i) {
+            if (!slice(active, i))
+                continue;
+            ScalarPoint3f  o = slice(ray.o, i);
+            ScalarVector3f d = slice(ray.d, i);
+            m_ray_recorder->record(RayStreamRecorder::Record {
+                { (float) o.x(), (float) o.y(), (float) o.z() },
+                { (float) d.x(), (float) d.y(), (float) d.z() },
+                (float) slice(ray.time, i) });
+        }
+    }
 }
 
 MTS_VARIANT typename Scene<Float, Spectrum>::SurfaceInteraction3f
@@ -141,6 +213,7 @@ Scene<Float, Spectrum>::ray_intersect_naive(const Ray3f &ray, Mask active) const
 MTS_VARIANT typename Scene<Float, Spectrum>::Mask
 Scene<Float, Spectrum>::ray_test(const Ray3f &ray, Mask active) const {
     MTS_MASKED_FUNCTION(ProfilerPhase::RayTest, active);
+    MTS_STAT_ADD(ShadowRays, count(active));
 
     if constexpr (is_cuda_array_v<Float>)
         return ray_test_gpu(ray, active);
@@ -148,10 +221,39 @@ Scene<Float, Spectrum>::ray_test(const Ray3f &ray, Mask active) const {
         return ray_test_cpu(ray, active);
 }
 
+MTS_VARIANT void Scene<Float, Spectrum>::ray_intersect_n(const Ray3f *rays,
+                                                         SurfaceInteraction3f *si,
+                                                         size_t count, Mask active) const {
+    MTS_MASKED_FUNCTION(ProfilerPhase::RayIntersect, active);
+    MTS_STAT_ADD(IntersectRays, count * enoki::count(active));
+
+    if constexpr (is_cuda_array_v<Float>) {
+        // GPU variants already trace entire wavefronts per call
+        for (size_t i = 0; i < count; ++i)
+            si[i] = ray_intersect_gpu(rays[i], active);
+    } else {
+        ray_intersect_n_cpu(rays, si, count, active);
+    }
+}
+
+MTS_VARIANT void Scene<Float, Spectrum>::ray_test_n(const Ray3f *rays, Mask *hit,
+                                                    size_t count, Mask active) const {
+    MTS_MASKED_FUNCTION(ProfilerPhase::RayTest, active);
+    MTS_STAT_ADD(ShadowRays, count * enoki::count(active));
+
+    if constexpr (is_cuda_array_v<Float>) {
+        for (size_t i = 0; i < count; ++i)
+            hit[i] = ray_test_gpu(rays[i], active);
+    } else {
+        ray_test_n_cpu(rays, hit, count, active);
+    }
+}
+
 MTS_VARIANT std::pair<typename Scene<Float, Spectrum>::DirectionSample3f, Spectrum>
 Scene<Float, Spectrum>::sample_emitter_direction(const Interaction3f &ref, const Point2f &sample_,
                                                  bool test_visibility, Mask active) const {
     MTS_MASKED_FUNCTION(ProfilerPhase::SampleEmitterDirection, active);
+    MTS_STAT_ADD(EmitterSamples, count(active));
 
     using EmitterPtr = replace_scalar_t<Float, Emitter*>;
 
@@ -164,13 +266,29 @@ Scene<Float, Spectrum>::sample_emitter_direction(const Interaction3f &ref, const
             // Fast path if there is only one emitter
             std::tie(ds, spec) = m_emitters[0]->sample_direction(ref, sample, active);
         } else {
-            ScalarFloat emitter_pdf = 1.f / m_emitters.size();
+            Float emitter_pdf;
+            UInt32 index;
+
+            bool used_bvh = false;
+            if constexpr (!is_cuda_array_v<Float>) {
+                if (m_light_bvh) {
+                    // Pick an emitter via the light hierarchy
+                    std::tie(index, emitter_pdf, sample.x()) =
+                        m_light_bvh->sample_emitter(ref.p, sample.x(), active);
+                    used_bvh = true;
+                }
+            }
 
-            // Randomly pick an emitter
-            UInt32 index = min(UInt32(sample.x() * (ScalarFloat) m_emitters.size()), (uint32_t) m_emitters.size()-1);
+            if (!used_bvh) {
+                ScalarFloat uniform_pdf = 1.f / m_emitters.size();
 
-            // Rescale sample.x() to lie in [0,1) again
-            sample.x() = (sample.x() - index*emitter_pdf) * m_emitters.size();
+                // Randomly pick an emitter
+                index = min(UInt32(sample.x() * (ScalarFloat) m_emitters.size()), (uint32_t) m_emitters.size()-1);
+
+                // Rescale sample.x() to lie in [0,1) again
+                sample.x() = (sample.x() - index*uniform_pdf) * m_emitters.size();
+                emitter_pdf = uniform_pdf;
+            }
 
             EmitterPtr emitter = gather<EmitterPtr>(m_emitters.data(), index, active);
 
@@ -186,9 +304,28 @@ Scene<Float, Spectrum>::sample_emitter_direction(const Interaction3f &ref, const
 
         // Perform a visibility test if requested
         if (test_visibility && any_or<true>(active)) {
-            Ray3f ray(ref.p, ds.d, math::RayEpsilon<Float> * (1.f + hmax(abs(ref.p))),
-                      ds.dist * (1.f - math::ShadowEpsilon<Float>), ref.time, ref.wavelengths);
-            spec[ray_test(ray, active)] = 0.f;
+            Mask occluded(false);
+            bool cached = false;
+
+            /* Consult the visibility cache (if present) before tracing; in
+               scalar mode, \c ds.object is a plain emitter pointer */
+            if constexpr (!is_array_v<Float>) {
+                if (m_vis_cache && active)
+                    cached = m_vis_cache->lookup(ref.p, ds.object, occluded);
+            }
+
+            if (!cached) {
+                Ray3f ray(ref.p, ds.d, math::RayEpsilon<Float> * (1.f + hmax(abs(ref.p))),
+                          ds.dist * (1.f - math::ShadowEpsilon<Float>), ref.time, ref.wavelengths);
+                occluded = ray_test(ray, active);
+
+                if constexpr (!is_array_v<Float>) {
+                    if (m_vis_cache && active)
+                        m_vis_cache->record(ref.p, ds.object, occluded);
+                }
+            }
+
+            spec[occluded] = 0.f;
         }
     } else {
         ds = zero<DirectionSample3f>();
@@ -198,6 +335,112 @@ Scene<Float, Spectrum>::sample_emitter_direction(const Interaction3f &ref, const
     return { ds, spec };
 }
 
+MTS_VARIANT void Scene<Float, Spectrum>::sample_emitter_direction_n(
+        const Interaction3f *ref, const Point2f *sample, DirectionSample3f *ds,
+        Spectrum *spec, size_t count, const Mask *active) const {
+    MTS_MASKED_FUNCTION(ProfilerPhase::SampleEmitterDirection, Mask(true));
+
+    if constexpr (is_cuda_array_v<Float>) {
+        // GPU variants already evaluate the entire wavefront at once
+        for (size_t i = 0; i < count; ++i)
+            std::tie(ds[i], spec[i]) =
+                sample_emitter_direction(ref[i], sample[i], true, active[i]);
+    } else {
+        /* Phase 1: sample a direction towards an emitter for every entry,
+           deferring the visibility tests */
+        for (size_t i = 0; i < count; ++i)
+            std::tie(ds[i], spec[i]) =
+                sample_emitter_direction(ref[i], sample[i], false, active[i]);
+
+        if (m_emitters.empty())
+            return;
+
+        /* Phase 2: bucket the shadow rays by target emitter. A batch only
+           ever references a handful of emitters, so a linear key scan
+           followed by a counting sort suffices (mirroring the per-BSDF
+           shading sort of the sorted block renderer). */
+        std::vector<const Object *> bucket_key;
+        std::vector<uint32_t> bucket_size;
+
+        auto bucket_index = [&](const Object *key) -> uint32_t {
+            for (uint32_t b = 0; b < (uint32_t) bucket_key.size(); ++b) {
+                if (bucket_key[b] == key)
+                    return b;
+            }
+            bucket_key.push_back(key);
+            bucket_size.push_back(0);
+            return (uint32_t) bucket_key.size() - 1;
+        };
+
+        std::vector<uint32_t> bucket(count);
+        uint32_t work = 0;
+        for (size_t i = 0; i < count; ++i) {
+            Mask valid = active[i] && neq(ds[i].pdf, 0.f);
+            if (none_or<false>(valid)) {
+                bucket[i] = (uint32_t) -1;
+                continue;
+            }
+
+            const Object *key;
+            if constexpr (is_array_v<Float>) {
+                /* Lanes of a packet may target different emitters; the
+                   first lane picks the bucket, which only influences the
+                   traversal order, not the result */
+                key = ds[i].object.coeff(0);
+            } else {
+                key = ds[i].object;
+            }
+
+            uint32_t b = bucket_index(key);
+            bucket[i] = b;
+            ++bucket_size[b];
+            ++work;
+        }
+
+        if (work == 0)
+            return;
+
+        // Turn the bucket sizes into a running offset
+        uint32_t offset = 0;
+        for (uint32_t b = 0; b < (uint32_t) bucket_size.size(); ++b) {
+            uint32_t size = bucket_size[b];
+            bucket_size[b] = offset;
+            offset += size;
+        }
+
+        std::vector<uint32_t> order(work);
+        for (size_t i = 0; i < count; ++i) {
+            if (bucket[i] != (uint32_t) -1)
+                order[bucket_size[bucket[i]]++] = (uint32_t) i;
+        }
+
+        // Phase 3: submit the shadow rays in bucket-contiguous order
+        std::vector<Ray3f> rays;
+        rays.reserve(work);
+        for (uint32_t k = 0; k < work; ++k) {
+            uint32_t i = order[k];
+            Ray3f ray(ref[i].p, ds[i].d,
+                      math::RayEpsilon<Float> * (1.f + hmax(abs(ref[i].p))),
+                      ds[i].dist * (1.f - math::ShadowEpsilon<Float>),
+                      ref[i].time, ref[i].wavelengths);
+
+            /* Lanes without a valid sample carry unusable ray values; an
+               inverted extent makes them miss on every backend */
+            if constexpr (is_array_v<Float>)
+                masked(ray.maxt, !(active[i] && neq(ds[i].pdf, 0.f))) =
+                    -math::Infinity<Float>;
+
+            rays.push_back(ray);
+        }
+
+        std::unique_ptr<Mask[]> hit(new Mask[work]);
+        ray_test_n(rays.data(), hit.get(), work);
+
+        for (uint32_t k = 0; k < work; ++k)
+            spec[order[k]][hit[k]] = 0.f;
+    }
+}
+
 MTS_VARIANT Float
 Scene<Float, Spectrum>::pdf_emitter_direction(const Interaction3f &ref,
                                               const DirectionSample3f &ds,
@@ -210,8 +453,16 @@ Scene<Float, Spectrum>::pdf_emitter_direction(const Interaction3f &ref,
         // Fast path if there is only one emitter
         return m_emitters[0]->pdf_direction(ref, ds, active);
     } else {
-        return reinterpret_array<EmitterPtr>(ds.object)->pdf_direction(ref, ds, active) *
-            (1.f / m_emitters.size());
+        EmitterPtr emitter = reinterpret_array<EmitterPtr>(ds.object);
+
+        // Discrete probability of having selected this emitter
+        Float emitter_pdf = 1.f / (ScalarFloat) m_emitters.size();
+        if constexpr (!is_cuda_array_v<Float>) {
+            if (m_light_bvh)
+                emitter_pdf = m_light_bvh->pdf_emitter(ref.p, emitter, active);
+        }
+
+        return emitter->pdf_direction(ref, ds, active) * emitter_pdf;
     }
 }
 
@@ -227,6 +478,19 @@ MTS_VARIANT void Scene<Float, Spectrum>::traverse(TraversalCallback *callback) {
 MTS_VARIANT void Scene<Float, Spectrum>::parameters_changed() {
     if (m_environment)
         m_environment->set_scene(this);
+
+    // Refit/rebuild the acceleration data structure if shapes were modified
+    if constexpr (!is_cuda_array_v<Float>)
+        accel_parameters_changed_cpu();
+
+    /* Emitter updates invalidate the power estimates baked into the light
+       hierarchy; a bottom-up refit of the existing topology suffices */
+    if (m_light_bvh)
+        m_light_bvh->refit(m_emitters, m_bbox);
+
+    // Cached visibility classifications may refer to the old geometry
+    if (m_vis_cache)
+        m_vis_cache->clear();
 }
 
 MTS_VARIANT std::string Scene<Float, Spectrum>::to_string() const {
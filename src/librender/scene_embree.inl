@@ -1,4 +1,8 @@
 #include <embree3/rtcore.h>
+#include <mitsuba/core/string.h>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include <tbb/task_arena.h>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -21,7 +25,24 @@ NAMESPACE_BEGIN(mitsuba)
 
 static RTCDevice __embree_device = nullptr;
 
-MTS_VARIANT void Scene<Float, Spectrum>::accel_init_cpu(const Properties &/*props*/) {
+/**
+ * \brief Commit an Embree scene using the worker threads of the surrounding
+ * TBB arena
+ *
+ * Every worker joins the BVH build via \c rtcJoinCommitScene instead of
+ * leaving the work to the device's isolated internal thread pool. The nested
+ * parallelism then composes with whatever else the scene loader is doing at
+ * the same time (e.g. loading textures or building distributions on sibling
+ * tasks) rather than oversubscribing the machine.
+ */
+static void embree_commit_parallel(RTCScene scene) {
+    int n_threads = tbb::this_task_arena::max_concurrency();
+    tbb::parallel_for(
+        tbb::blocked_range<int>(0, n_threads, 1),
+        [scene](const tbb::blocked_range<int> &) { rtcJoinCommitScene(scene); });
+}
+
+MTS_VARIANT void Scene<Float, Spectrum>::accel_init_cpu(const Properties &props) {
     static_assert(is_float_v<scalar_t<Float>>, "Embree is not supported in double precision mode.");
     if (!__embree_device)
         __embree_device = rtcNewDevice("");
@@ -29,9 +50,35 @@ MTS_VARIANT void Scene<Float, Spectrum>::accel_init_cpu(const Properties &/*prop
     Timer timer;
     RTCScene embree_scene = rtcNewScene(__embree_device);
     m_accel = embree_scene;
+
+    /* Acceleration structure knobs: 'low' build quality trades some
+       traversal performance for much faster (re-)builds, which is usually
+       the right choice for animation; 'high' spends extra build time on
+       spatial splits. */
+    std::string quality = string::to_lower(
+        props.string_("accel_build_quality", "medium"));
+    if (quality == "low")
+        rtcSetSceneBuildQuality(embree_scene, RTC_BUILD_QUALITY_LOW);
+    else if (quality == "medium")
+        rtcSetSceneBuildQuality(embree_scene, RTC_BUILD_QUALITY_MEDIUM);
+    else if (quality == "high")
+        rtcSetSceneBuildQuality(embree_scene, RTC_BUILD_QUALITY_HIGH);
+    else
+        Throw("Invalid acceleration structure build quality \"%s\", must be "
+              "one of \"low\", \"medium\" or \"high\"!", quality);
+
+    uint32_t scene_flags = RTC_SCENE_FLAG_NONE;
+    // Watertight traversal, at a slight intersection performance cost
+    if (props.bool_("accel_robust", false))
+        scene_flags |= RTC_SCENE_FLAG_ROBUST;
+    // Lower memory footprint, mainly useful for very large scenes
+    if (props.bool_("accel_compact", false))
+        scene_flags |= RTC_SCENE_FLAG_COMPACT;
+    rtcSetSceneFlags(embree_scene, (RTCSceneFlags) scene_flags);
+
     for (Shape *shape : m_shapes)
         rtcAttachGeometry(embree_scene, shape->embree_geometry(__embree_device));
-    rtcCommitScene(embree_scene);
+    embree_commit_parallel(embree_scene);
     Log(Info, "Embree ready. (took %s)", util::time_string(timer.value()));
 }
 
@@ -39,8 +86,28 @@ MTS_VARIANT void Scene<Float, Spectrum>::accel_release_cpu() {
     rtcReleaseScene((RTCScene) m_accel);
 }
 
+MTS_VARIANT void Scene<Float, Spectrum>::accel_parameters_changed_cpu() {
+    RTCScene embree_scene = (RTCScene) m_accel;
+    bool changed = false;
+
+    /* Geometries were attached in shape order in \ref accel_init_cpu(), so
+       the Embree geometry id of the i-th shape is simply i */
+    for (size_t i = 0; i < m_shapes.size(); ++i) {
+        if (!m_shapes[i]->dirty())
+            continue;
+        rtcCommitGeometry(rtcGetGeometry(embree_scene, (unsigned int) i));
+        m_shapes[i]->clear_dirty();
+        changed = true;
+    }
+
+    // Embree updates the BVH of re-committed geometries incrementally
+    if (changed)
+        embree_commit_parallel(embree_scene);
+}
+
 MTS_VARIANT typename Scene<Float, Spectrum>::SurfaceInteraction3f
-Scene<Float, Spectrum>::ray_intersect_cpu(const Ray3f &ray, Mask active) const {
+Scene<Float, Spectrum>::ray_intersect_cpu(const Ray3f &ray, uint32_t hit_flags,
+                                          Mask active) const {
     if constexpr (!is_cuda_array_v<Float>) {
         RTCIntersectContext context;
         rtcInitIntersectContext(&context);
@@ -55,7 +122,7 @@ Scene<Float, Spectrum>::ray_intersect_cpu(const Ray3f &ray, Mask active) const {
             rh.ray.dir_x = ray.d.x();
             rh.ray.dir_y = ray.d.y();
             rh.ray.dir_z = ray.d.z();
-            rh.ray.time = 0;
+            rh.ray.time = ray.time;
             rh.ray.tfar = ray.maxt;
             rh.ray.mask = 0;
             rh.ray.id = 0;
@@ -67,6 +134,16 @@ Scene<Float, Spectrum>::ray_intersect_cpu(const Ray3f &ray, Mask active) const {
                 uint32_t shape_index = rh.hit.geomID;
                 uint32_t prim_index = rh.hit.primID;
 
+                /* Hits within an instanced shape group are attributed to the
+                   corresponding `instance` shape; the geomID of the nested
+                   scene is forwarded through the cache */
+                Float cache[3] = { rh.hit.u, rh.hit.v, 0.f };
+                bool instanced = rh.hit.instID[0] != RTC_INVALID_GEOMETRY_ID;
+                if (instanced) {
+                    cache[2] = reinterpret_array<Float>(UInt32(shape_index));
+                    shape_index = rh.hit.instID[0];
+                }
+
                 // Fill in basic information common to all shapes
                 si.t = rh.ray.tfar;
                 si.time = ray.time;
@@ -74,18 +151,25 @@ Scene<Float, Spectrum>::ray_intersect_cpu(const Ray3f &ray, Mask active) const {
                 si.shape = m_shapes[shape_index];
                 si.prim_index = prim_index;
 
-                Float cache[2] = { rh.hit.u, rh.hit.v };
-
-                // Ask shape(s) to fill in the rest using the cache
-                si.shape->fill_surface_interaction(ray, cache, si);
+                if (hit_flags == +HitFlags::Minimal && !instanced) {
+                    /* Lazy record: stash the local hit coordinates in 'uv'
+                       and let the caller expand the remaining fields on
+                       demand via si.finalize_surface_interaction() */
+                    si.p = ray(si.t);
+                    si.uv = Point2f(rh.hit.u, rh.hit.v);
+                    si.wi = -ray.d;
+                } else {
+                    // Ask shape(s) to fill in the rest using the cache
+                    si.shape->fill_surface_interaction(ray, cache, si);
 
-                // Gram-schmidt orthogonalization to compute local shading frame
-                si.sh_frame.s = normalize(
-                    fnmadd(si.sh_frame.n, dot(si.sh_frame.n, si.dp_du), si.dp_du));
-                si.sh_frame.t = cross(si.sh_frame.n, si.sh_frame.s);
+                    // Gram-schmidt orthogonalization to compute local shading frame
+                    si.sh_frame.s = normalize(
+                        fnmadd(si.sh_frame.n, dot(si.sh_frame.n, si.dp_du), si.dp_du));
+                    si.sh_frame.t = cross(si.sh_frame.n, si.sh_frame.s);
 
-                // Incident direction in local coordinates
-                si.wi = si.to_local(-ray.d);
+                    // Incident direction in local coordinates
+                    si.wi = si.to_local(-ray.d);
+                }
             } else {
                 si.wavelengths = ray.wavelengths;
                 si.wi = -ray.d;
@@ -105,7 +189,7 @@ Scene<Float, Spectrum>::ray_intersect_cpu(const Ray3f &ray, Mask active) const {
             store(rh.ray.dir_x, ray.d.x());
             store(rh.ray.dir_y, ray.d.y());
             store(rh.ray.dir_z, ray.d.z());
-            store(rh.ray.time, Float(0));
+            store(rh.ray.time, ray.time);
             store(rh.ray.tfar, ray.maxt);
             store(rh.ray.mask, UInt32(0));
             store(rh.ray.id, UInt32(0));
@@ -120,6 +204,15 @@ Scene<Float, Spectrum>::ray_intersect_cpu(const Ray3f &ray, Mask active) const {
                 ScopedPhase sp(ProfilerPhase::CreateSurfaceInteraction);
                 UInt32 shape_index = load<UInt32>(rh.hit.geomID);
                 UInt32 prim_index  = load<UInt32>(rh.hit.primID);
+                UInt32 inst_index  = load<UInt32>(rh.hit.instID[0]);
+
+                /* Hits within an instanced shape group are attributed to the
+                   corresponding `instance` shape; the geomID of the nested
+                   scene is forwarded through the cache */
+                Float cache[3] = { load<Float>(rh.hit.u), load<Float>(rh.hit.v),
+                                   reinterpret_array<Float>(shape_index) };
+                Mask instanced = neq(inst_index, UInt32(RTC_INVALID_GEOMETRY_ID));
+                shape_index = select(instanced, inst_index, shape_index);
 
                 // Fill in basic information common to all shapes
                 si.t = load<Float>(rh.ray.tfar);
@@ -128,18 +221,25 @@ Scene<Float, Spectrum>::ray_intersect_cpu(const Ray3f &ray, Mask active) const {
                 si.shape = gather<ShapePtr>(m_shapes.data(), shape_index, hit);
                 si.prim_index = prim_index;
 
-                Float cache[2] = { load<Float>(rh.hit.u), load<Float>(rh.hit.v) };
-
-                // Ask shape(s) to fill in the rest using the cache
-                si.shape->fill_surface_interaction(ray, cache, si, active);
+                if (hit_flags == +HitFlags::Minimal && none(instanced && hit)) {
+                    /* Lazy record: stash the local hit coordinates in 'uv'
+                       and let the caller expand the remaining fields on
+                       demand via si.finalize_surface_interaction() */
+                    si.p = ray(si.t);
+                    si.uv = Point2f(cache[0], cache[1]);
+                    si.wi = -ray.d;
+                } else {
+                    // Ask shape(s) to fill in the rest using the cache
+                    si.shape->fill_surface_interaction(ray, cache, si, active);
 
-                // Gram-schmidt orthogonalization to compute local shading frame
-                si.sh_frame.s = normalize(
-                    fnmadd(si.sh_frame.n, dot(si.sh_frame.n, si.dp_du), si.dp_du));
-                si.sh_frame.t = cross(si.sh_frame.n, si.sh_frame.s);
+                    // Gram-schmidt orthogonalization to compute local shading frame
+                    si.sh_frame.s = normalize(
+                        fnmadd(si.sh_frame.n, dot(si.sh_frame.n, si.dp_du), si.dp_du));
+                    si.sh_frame.t = cross(si.sh_frame.n, si.sh_frame.s);
 
-                // Incident direction in local coordinates
-                si.wi = select(hit, si.to_local(-ray.d), -ray.d);
+                    // Incident direction in local coordinates
+                    si.wi = select(hit, si.to_local(-ray.d), -ray.d);
+                }
             } else {
                 si.wavelengths = ray.wavelengths;
                 si.wi = -ray.d;
@@ -152,6 +252,210 @@ Scene<Float, Spectrum>::ray_intersect_cpu(const Ray3f &ray, Mask active) const {
     }
 }
 
+MTS_VARIANT void Scene<Float, Spectrum>::ray_intersect_n_cpu(const Ray3f *rays,
+                                                             SurfaceInteraction3f *si_out,
+                                                             size_t count, Mask active) const {
+    if constexpr (!is_cuda_array_v<Float>) {
+        RTCIntersectContext context;
+        rtcInitIntersectContext(&context);
+        context.flags = RTC_INTERSECT_CONTEXT_FLAG_COHERENT;
+
+        if constexpr (!is_array_v<Float>) {
+            std::unique_ptr<RTCRayHit[]> rh(new RTCRayHit[count]);
+            for (size_t i = 0; i < count; ++i) {
+                const Ray3f &ray = rays[i];
+                rh[i].ray.org_x = ray.o.x();
+                rh[i].ray.org_y = ray.o.y();
+                rh[i].ray.org_z = ray.o.z();
+                // Inactive rays are flagged via an inverted [tnear, tfar] range
+                rh[i].ray.tnear = active ? ray.mint : ray.maxt + 1.f;
+                rh[i].ray.dir_x = ray.d.x();
+                rh[i].ray.dir_y = ray.d.y();
+                rh[i].ray.dir_z = ray.d.z();
+                rh[i].ray.time = ray.time;
+                rh[i].ray.tfar = ray.maxt;
+                rh[i].ray.mask = 0;
+                rh[i].ray.id = (unsigned int) i;
+                rh[i].ray.flags = 0;
+            }
+
+            rtcIntersect1M((RTCScene) m_accel, &context, rh.get(),
+                           (unsigned int) count, sizeof(RTCRayHit));
+
+            for (size_t i = 0; i < count; ++i) {
+                const Ray3f &ray = rays[i];
+                SurfaceInteraction3f si = zero<SurfaceInteraction3f>();
+
+                if (active && rh[i].ray.tfar != ray.maxt) {
+                    ScopedPhase sp(ProfilerPhase::CreateSurfaceInteraction);
+                    uint32_t shape_index = rh[i].hit.geomID;
+                    uint32_t prim_index = rh[i].hit.primID;
+
+                    /* Hits within an instanced shape group are attributed to
+                       the corresponding `instance` shape; the geomID of the
+                       nested scene is forwarded through the cache */
+                    Float cache[3] = { rh[i].hit.u, rh[i].hit.v, 0.f };
+                    if (rh[i].hit.instID[0] != RTC_INVALID_GEOMETRY_ID) {
+                        cache[2] = reinterpret_array<Float>(UInt32(shape_index));
+                        shape_index = rh[i].hit.instID[0];
+                    }
+
+                    // Fill in basic information common to all shapes
+                    si.t = rh[i].ray.tfar;
+                    si.time = ray.time;
+                    si.wavelengths = ray.wavelengths;
+                    si.shape = m_shapes[shape_index];
+                    si.prim_index = prim_index;
+
+                    // Ask shape(s) to fill in the rest using the cache
+                    si.shape->fill_surface_interaction(ray, cache, si);
+
+                    // Gram-schmidt orthogonalization to compute local shading frame
+                    si.sh_frame.s = normalize(
+                        fnmadd(si.sh_frame.n, dot(si.sh_frame.n, si.dp_du), si.dp_du));
+                    si.sh_frame.t = cross(si.sh_frame.n, si.sh_frame.s);
+
+                    // Incident direction in local coordinates
+                    si.wi = si.to_local(-ray.d);
+                } else {
+                    si.wavelengths = ray.wavelengths;
+                    si.wi = -ray.d;
+                    si.t = math::Infinity<Float>;
+                }
+                si_out[i] = si;
+            }
+        } else {
+            std::unique_ptr<RTCRayHitW[]> rh(new RTCRayHitW[count]);
+            for (size_t i = 0; i < count; ++i) {
+                const Ray3f &ray = rays[i];
+                store(rh[i].ray.org_x, ray.o.x());
+                store(rh[i].ray.org_y, ray.o.y());
+                store(rh[i].ray.org_z, ray.o.z());
+                // Inactive lanes are flagged via an inverted [tnear, tfar] range
+                store(rh[i].ray.tnear, select(active, ray.mint, ray.maxt + 1.f));
+                store(rh[i].ray.dir_x, ray.d.x());
+                store(rh[i].ray.dir_y, ray.d.y());
+                store(rh[i].ray.dir_z, ray.d.z());
+                store(rh[i].ray.time, ray.time);
+                store(rh[i].ray.tfar, ray.maxt);
+                store(rh[i].ray.mask, UInt32(0));
+                store(rh[i].ray.id, UInt32((uint32_t) i));
+                store(rh[i].ray.flags, UInt32(0));
+            }
+
+            rtcIntersectNM((RTCScene) m_accel, &context, (RTCRayHitN *) rh.get(),
+                           MTS_RAY_WIDTH, (unsigned int) count, sizeof(RTCRayHitW));
+
+            for (size_t i = 0; i < count; ++i) {
+                const Ray3f &ray = rays[i];
+                SurfaceInteraction3f si = zero<SurfaceInteraction3f>();
+
+                Mask hit = active && neq(load<Float>(rh[i].ray.tfar), ray.maxt);
+
+                if (likely(any(hit))) {
+                    using ShapePtr = replace_scalar_t<Float, const Shape *>;
+                    ScopedPhase sp(ProfilerPhase::CreateSurfaceInteraction);
+                    UInt32 shape_index = load<UInt32>(rh[i].hit.geomID);
+                    UInt32 prim_index  = load<UInt32>(rh[i].hit.primID);
+                    UInt32 inst_index  = load<UInt32>(rh[i].hit.instID[0]);
+
+                    /* Hits within an instanced shape group are attributed to
+                       the corresponding `instance` shape; the geomID of the
+                       nested scene is forwarded through the cache */
+                    Float cache[3] = { load<Float>(rh[i].hit.u), load<Float>(rh[i].hit.v),
+                                       reinterpret_array<Float>(shape_index) };
+                    shape_index = select(neq(inst_index, UInt32(RTC_INVALID_GEOMETRY_ID)),
+                                         inst_index, shape_index);
+
+                    // Fill in basic information common to all shapes
+                    si.t = load<Float>(rh[i].ray.tfar);
+                    si.time = ray.time;
+                    si.wavelengths = ray.wavelengths;
+                    si.shape = gather<ShapePtr>(m_shapes.data(), shape_index, hit);
+                    si.prim_index = prim_index;
+
+                    // Ask shape(s) to fill in the rest using the cache
+                    si.shape->fill_surface_interaction(ray, cache, si, active);
+
+                    // Gram-schmidt orthogonalization to compute local shading frame
+                    si.sh_frame.s = normalize(
+                        fnmadd(si.sh_frame.n, dot(si.sh_frame.n, si.dp_du), si.dp_du));
+                    si.sh_frame.t = cross(si.sh_frame.n, si.sh_frame.s);
+
+                    // Incident direction in local coordinates
+                    si.wi = select(hit, si.to_local(-ray.d), -ray.d);
+                } else {
+                    si.wavelengths = ray.wavelengths;
+                    si.wi = -ray.d;
+                }
+                si.t[!hit] = math::Infinity<Float>;
+                si_out[i] = si;
+            }
+        }
+    } else {
+        Throw("ray_intersect_n_cpu() should only be called in CPU mode.");
+    }
+}
+
+MTS_VARIANT void Scene<Float, Spectrum>::ray_test_n_cpu(const Ray3f *rays, Mask *hit,
+                                                        size_t count, Mask active) const {
+    if constexpr (!is_cuda_array_v<Float>) {
+        RTCIntersectContext context;
+        rtcInitIntersectContext(&context);
+        context.flags = RTC_INTERSECT_CONTEXT_FLAG_COHERENT;
+
+        if constexpr (!is_array_v<Float>) {
+            std::unique_ptr<RTCRay[]> rays2(new RTCRay[count]);
+            for (size_t i = 0; i < count; ++i) {
+                const Ray3f &ray = rays[i];
+                rays2[i].org_x = ray.o.x();
+                rays2[i].org_y = ray.o.y();
+                rays2[i].org_z = ray.o.z();
+                rays2[i].tnear = active ? ray.mint : ray.maxt + 1.f;
+                rays2[i].dir_x = ray.d.x();
+                rays2[i].dir_y = ray.d.y();
+                rays2[i].dir_z = ray.d.z();
+                rays2[i].time = ray.time;
+                rays2[i].tfar = ray.maxt;
+                rays2[i].mask = 0;
+                rays2[i].id = (unsigned int) i;
+                rays2[i].flags = 0;
+            }
+
+            rtcOccluded1M((RTCScene) m_accel, &context, rays2.get(),
+                          (unsigned int) count, sizeof(RTCRay));
+
+            for (size_t i = 0; i < count; ++i)
+                hit[i] = active && rays2[i].tfar != rays[i].maxt;
+        } else {
+            std::unique_ptr<RTCRayW[]> rays2(new RTCRayW[count]);
+            for (size_t i = 0; i < count; ++i) {
+                const Ray3f &ray = rays[i];
+                store(rays2[i].org_x, ray.o.x());
+                store(rays2[i].org_y, ray.o.y());
+                store(rays2[i].org_z, ray.o.z());
+                store(rays2[i].tnear, select(active, ray.mint, ray.maxt + 1.f));
+                store(rays2[i].dir_x, ray.d.x());
+                store(rays2[i].dir_y, ray.d.y());
+                store(rays2[i].dir_z, ray.d.z());
+                store(rays2[i].time, ray.time);
+                store(rays2[i].tfar, ray.maxt);
+                store(rays2[i].mask, UInt32(0));
+                store(rays2[i].id, UInt32((uint32_t) i));
+                store(rays2[i].flags, UInt32(0));
+            }
+
+            rtcOccludedNM((RTCScene) m_accel, &context, (RTCRayN *) rays2.get(),
+                          MTS_RAY_WIDTH, (unsigned int) count, sizeof(RTCRayW));
+
+            for (size_t i = 0; i < count; ++i)
+                hit[i] = active && neq(load<Float>(rays2[i].tfar), rays[i].maxt);
+        }
+    } else {
+        Throw("ray_test_n_cpu() should only be called in CPU mode.");
+    }
+}
+
 MTS_VARIANT typename Scene<Float, Spectrum>::Mask
 Scene<Float, Spectrum>::ray_test_cpu(const Ray3f &ray, Mask active) const {
     if constexpr (!is_cuda_array_v<Float>) {
@@ -167,7 +471,7 @@ Scene<Float, Spectrum>::ray_test_cpu(const Ray3f &ray, Mask active) const {
             ray2.dir_x = ray.d.x();
             ray2.dir_y = ray.d.y();
             ray2.dir_z = ray.d.z();
-            ray2.time = 0;
+            ray2.time = ray.time;
             ray2.tfar = ray.maxt;
             ray2.mask = 0;
             ray2.id = 0;
@@ -188,7 +492,7 @@ Scene<Float, Spectrum>::ray_test_cpu(const Ray3f &ray, Mask active) const {
             store(ray2.dir_x, ray.d.x());
             store(ray2.dir_y, ray.d.y());
             store(ray2.dir_z, ray.d.z());
-            store(ray2.time, Float(0));
+            store(ray2.time, ray.time);
             store(ray2.tfar, ray.maxt);
             store(ray2.mask, UInt32(0));
             store(ray2.id, UInt32(0));
@@ -14,8 +14,18 @@ MTS_VARIANT void Scene<Float, Spectrum>::accel_release_cpu() {
     m_accel = nullptr;
 }
 
+MTS_VARIANT void Scene<Float, Spectrum>::accel_parameters_changed_cpu() {
+    ((ShapeKDTree *) m_accel)->update();
+}
+
 MTS_VARIANT typename Scene<Float, Spectrum>::SurfaceInteraction3f
-Scene<Float, Spectrum>::ray_intersect_cpu(const Ray3f &ray, Mask active) const {
+Scene<Float, Spectrum>::ray_intersect_cpu(const Ray3f &ray, uint32_t hit_flags,
+                                          Mask active) const {
+    /* The kd-tree intersection cache has a shape-specific layout that cannot
+       be stashed in the interaction record, hence this backend ignores the
+       request mask and always populates all fields */
+    ENOKI_MARK_USED(hit_flags);
+
     const ShapeKDTree *kdtree = (const ShapeKDTree *) m_accel;
     Float cache[MTS_KD_INTERSECTION_CACHE_SIZE];
 
@@ -51,7 +61,24 @@ Scene<Float, Spectrum>::ray_intersect_naive_cpu(const Ray3f &ray, Mask active) c
 MTS_VARIANT typename Scene<Float, Spectrum>::Mask
 Scene<Float, Spectrum>::ray_test_cpu(const Ray3f &ray, Mask active) const {
     const ShapeKDTree *kdtree = (ShapeKDTree *) m_accel;
-    return kdtree->template ray_intersect<true>(ray, (Float *) nullptr, active).first;
+    return kdtree->ray_test(ray, active);
+}
+
+/* Stream variants: the native backend traverses the kd-tree once per ray, but
+   processing a whole batch back-to-back keeps the upper tree levels (and, for
+   coherent batches, most visited leaves) resident in cache across rays. */
+
+MTS_VARIANT void Scene<Float, Spectrum>::ray_intersect_n_cpu(const Ray3f *rays,
+                                                             SurfaceInteraction3f *si,
+                                                             size_t count, Mask active) const {
+    for (size_t i = 0; i < count; ++i)
+        si[i] = ray_intersect_cpu(rays[i], +HitFlags::All, active);
+}
+
+MTS_VARIANT void Scene<Float, Spectrum>::ray_test_n_cpu(const Ray3f *rays, Mask *hit,
+                                                        size_t count, Mask active) const {
+    for (size_t i = 0; i < count; ++i)
+        hit[i] = ray_test_cpu(rays[i], active);
 }
 
 NAMESPACE_END(mitsuba)
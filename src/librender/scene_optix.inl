@@ -1,5 +1,7 @@
 #include <optix.h>
 #include <optix_cuda_interop.h>
+#include <thread>
+#include <mitsuba/core/filesystem.h>
 #include "librender_ptx.h"
 
 NAMESPACE_BEGIN(mitsuba)
@@ -18,24 +20,124 @@ void __rt_check(RTcontext context, RTresult errval, const char *file, const int
 }
 
 constexpr size_t kOptixVariableCount = 30;
-constexpr int kDeviceID = 0;
+
+/* OptiX device that the wavefront and its zero-copy interop buffers live on.
+   Arrays produced by the CUDA backend are resident on a single device, hence
+   one renderer process drives exactly one GPU; additional GPUs are used by
+   launching one process per device and selecting the device of each process
+   via the MTS_OPTIX_DEVICE environment variable. */
+static int optix_device_id() {
+    int device = 0;
+    if (const char *env = getenv("MTS_OPTIX_DEVICE"))
+        device = atoi(env);
+
+    unsigned int device_count = 0;
+    rtDeviceGetDeviceCount(&device_count);
+    if (device < 0 || (device_count > 0 && device >= (int) device_count)) {
+        Log(Warn, "MTS_OPTIX_DEVICE=%i is out of range (%u device%s available)"
+                  " -- falling back to device 0.", device, device_count,
+            device_count == 1 ? "" : "s");
+        device = 0;
+    }
+
+    return device;
+}
 
 struct OptixState {
     RTcontext context;
+    int device_id;
     RTbuffer var_buf[kOptixVariableCount];
     RTmaterial material;
     RTprogram attr_prog;
     RTacceleration accel;
     RTgeometrygroup group;
+
+    /* The acceleration structure build runs on a helper thread so that it
+       overlaps the remaining scene setup on the host; it must complete
+       before the first launch (see \c optix_sync_build()) */
+    std::thread build_thread;
 };
 
+/// Wait for an asynchronous acceleration structure build to complete
+static void optix_sync_build(OptixState &s) {
+    if (s.build_thread.joinable())
+        s.build_thread.join();
+}
+
+#if defined(OPTIX_VERSION) && OPTIX_VERSION >= 60000
+/* Persist compiled kernels across process launches. The OptiX disk cache
+   stores the result of each PTX->SASS compilation keyed by a hash of the
+   program and the driver version, and serializes concurrent access to the
+   underlying database internally, so that parameter-sweep jobs launching
+   many short renders share a single compile instead of each paying the
+   full JIT cost at startup. The cache lives in ~/.mitsuba/optix-cache by
+   default; MTS_OPTIX_CACHE_DIR overrides the location, and setting it to
+   an empty string disables the cache. */
+static void optix_configure_cache(OptixState &s) {
+    fs::path path;
+    if (const char *env = getenv("MTS_OPTIX_CACHE_DIR")) {
+        if (env[0] == '\0') {
+            int enabled = 0;
+            rtContextSetAttribute(s.context,
+                                  RT_CONTEXT_ATTRIBUTE_DISK_CACHE_ENABLED,
+                                  sizeof(int), &enabled);
+            return;
+        }
+        path = fs::path(env);
+    } else {
+#if !defined(_WIN32)
+        const char *home = getenv("HOME");
+#else
+        const char *home = getenv("USERPROFILE");
+#endif
+        if (!home)
+            return; // No usable default location -- keep OptiX's own default
+        path = fs::path(home) / ".mitsuba" / "optix-cache";
+    }
+
+    if (!fs::is_directory(path)) {
+        fs::create_directory(path.parent_path());
+        if (!fs::create_directory(path) && !fs::is_directory(path)) {
+            Log(Warn, "OptiX: could not create kernel cache directory \"%s\" "
+                      "-- falling back to the driver default.", path.string());
+            return;
+        }
+    }
+
+    /* A failure to relocate the cache is not fatal -- the driver default
+       (which may not be shared between jobs) remains in effect */
+    std::string path_str = path.string();
+    const char *location = path_str.c_str();
+    RTresult err = rtContextSetAttribute(
+        s.context, RT_CONTEXT_ATTRIBUTE_DISK_CACHE_LOCATION,
+        sizeof(char *), &location);
+    if (err != RT_SUCCESS)
+        Log(Warn, "OptiX: could not set the kernel cache location to \"%s\".",
+            path_str);
+    else
+        Log(Debug, "OptiX: kernel cache located at \"%s\".", path_str);
+}
+#endif
+
 MTS_VARIANT void Scene<Float, Spectrum>::accel_init_gpu(const Properties &/*props*/) {
     m_accel = new OptixState();
     OptixState &s = *(OptixState *) m_accel;
 
     rt_check(rtContextCreate(&s.context));
-    int devices = 0;
-    rt_check(rtContextSetDevices(s.context, 1, &devices));
+    s.device_id = optix_device_id();
+    rt_check(rtContextSetDevices(s.context, 1, &s.device_id));
+
+    unsigned int device_count = 0;
+    char device_name[256] = { 0 };
+    rtDeviceGetDeviceCount(&device_count);
+    rtDeviceGetAttribute(s.device_id, RT_DEVICE_ATTRIBUTE_NAME,
+                         sizeof(device_name) - 1, device_name);
+    Log(Info, "OptiX: using device %i of %u (%s).",
+        s.device_id, device_count, device_name);
+
+#if defined(OPTIX_VERSION) && OPTIX_VERSION >= 60000
+    optix_configure_cache(s);
+#endif
 
     rt_check(rtContextSetRayTypeCount(s.context, 1));
     rt_check(rtContextSetEntryPointCount(s.context, 2));
@@ -67,7 +169,7 @@ MTS_VARIANT void Scene<Float, Spectrum>::accel_init_gpu(const Properties &/*prop
         rt_check(rtBufferCreate(s.context, RT_BUFFER_INPUT | RT_BUFFER_COPY_ON_DIRTY, &s.var_buf[i]));
         rt_check(rtBufferSetFormat(s.var_buf[i], fmt));
         rt_check(rtBufferSetSize1D(s.var_buf[i], 0));
-        rt_check(rtBufferSetDevicePointer(s.var_buf[i], kDeviceID, (void *) 8));
+        rt_check(rtBufferSetDevicePointer(s.var_buf[i], s.device_id, (void *) 8));
         rt_check(rtContextDeclareVariable(s.context, var_names[i], &var_obj[i]));
         rt_check(rtVariableSetObject(var_obj[i], s.var_buf[i]));
     }
@@ -107,6 +209,10 @@ MTS_VARIANT void Scene<Float, Spectrum>::accel_init_gpu(const Properties &/*prop
     rt_check(rtAccelerationCreate(s.context, &s.accel));
     rt_check(rtAccelerationSetBuilder(s.accel, "Trbvh"));
 
+    /* Bound the peak memory footprint of the Trbvh build by processing large
+       meshes in automatically sized chunks rather than in one piece */
+    rt_check(rtAccelerationSetProperty(s.accel, "chunk_size", "-1"));
+
     rt_check(rtGeometryGroupCreate(s.context, &s.group));
     rt_check(rtGeometryGroupSetAcceleration(s.group, s.accel));
     rt_check(rtGeometryGroupSetChildCount(s.group, (uint32_t) m_shapes.size()));
@@ -142,18 +248,31 @@ MTS_VARIANT void Scene<Float, Spectrum>::accel_init_gpu(const Properties &/*prop
     // This will trigger the scatter calls to upload geometry to the device
     cuda_eval();
 
+    /* The geometry is uploaded at this point; validate the context and
+       trigger the acceleration structure build on a helper thread so that it
+       overlaps the remaining scene setup (emitter registration, light
+       hierarchy construction, ..) on the host. No other OptiX call touches
+       the context until \c optix_sync_build() has joined this thread. */
     Log(Info, "Validating and building scene in OptiX.");
-    rt_check(rtContextValidate(s.context));
-    RTresult rt = rtContextLaunch1D(s.context, 0, 0);
-    if (rt == RT_ERROR_MEMORY_ALLOCATION_FAILED) {
+    s.build_thread = std::thread([&s]() {
+        rt_check(rtContextValidate(s.context));
+        RTresult rt = rtContextLaunch1D(s.context, 0, 0);
+        if (rt == RT_ERROR_MEMORY_ALLOCATION_FAILED) {
+            cuda_malloc_trim();
+            rt = rtContextLaunch1D(s.context, 0, 0);
+        }
+        rt_check(rt);
+
+        /* Return temporary build allocations cached by the allocator to the
+           driver -- scan meshes otherwise hold on to a sizable fraction of
+           device memory beyond the lifetime of the build */
         cuda_malloc_trim();
-        rt = rtContextLaunch1D(s.context, 0, 0);
-    }
-    rt_check(rt);
+    });
 }
 
 MTS_VARIANT void Scene<Float, Spectrum>::accel_release_gpu() {
     OptixState &s = *(OptixState *) m_accel;
+    optix_sync_build(s);
     rt_check(rtContextDestroy(s.context));
     delete (OptixState *) m_accel;
     m_accel = nullptr;
@@ -203,13 +322,14 @@ Scene<Float, Spectrum>::ray_intersect_gpu(const Ray3f &ray_, Mask active) const
         };
 
         OptixState &s = *(OptixState *) m_accel;
+        optix_sync_build(s);
         for (size_t i = 0; i < kOptixVariableCount; ++i) {
             if (cuda_ptr[i]) {
                 rt_check(rtBufferSetSize1D(s.var_buf[i], ray_count));
-                rt_check(rtBufferSetDevicePointer(s.var_buf[i], kDeviceID, (void *) cuda_ptr[i]));
+                rt_check(rtBufferSetDevicePointer(s.var_buf[i], s.device_id, (void *) cuda_ptr[i]));
             } else {
                 rt_check(rtBufferSetSize1D(s.var_buf[i], 0));
-                rt_check(rtBufferSetDevicePointer(s.var_buf[i], kDeviceID, (void *) 8));
+                rt_check(rtBufferSetDevicePointer(s.var_buf[i], s.device_id, (void *) 8));
             }
         }
 
@@ -285,15 +405,16 @@ Scene<Float, Spectrum>::ray_test_gpu(const Ray3f &ray_, Mask active) const {
         };
 
         OptixState &s = *(OptixState *) m_accel;
+        optix_sync_build(s);
         for (size_t i = 0; i < kOptixVariableCount; ++i) {
             if (cuda_ptr[i]) {
                 rt_check(rtBufferSetSize1D(s.var_buf[i], ray_count));
-                rt_check(rtBufferSetDevicePointer(s.var_buf[i], kDeviceID,
+                rt_check(rtBufferSetDevicePointer(s.var_buf[i], s.device_id,
                                                 (void *) cuda_ptr[i]));
             } else {
                 rt_check(rtBufferSetSize1D(s.var_buf[i], 0));
                 rt_check(
-                    rtBufferSetDevicePointer(s.var_buf[i], kDeviceID, (void *) 8));
+                    rtBufferSetDevicePointer(s.var_buf[i], s.device_id, (void *) 8));
             }
         }
 
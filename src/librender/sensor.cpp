@@ -84,6 +84,24 @@ Sensor<Float, Spectrum>::sample_ray_differential(Float time, Float sample1, cons
     return { result_ray, result_spec };
 }
 
+MTS_VARIANT void Sensor<Float, Spectrum>::sample_ray_differential_batch(
+    const std::vector<Float> &time, const std::vector<Float> &sample1,
+    const std::vector<Point2f> &sample2, const std::vector<Point2f> &sample3,
+    RayBatch &batch, Mask active) const {
+    Assert(time.size() == sample2.size() && sample1.size() == sample2.size() &&
+           (sample3.size() == sample2.size() || sample3.empty()));
+
+    size_t count = sample2.size();
+    batch.resize(count);
+
+    for (size_t i = 0; i < count; ++i) {
+        auto [ray, weight] = sample_ray_differential(
+            time[i], sample1[i], sample2[i],
+            sample3.empty() ? Point2f(.5f) : sample3[i], active);
+        batch.set(i, ray, weight);
+    }
+}
+
 MTS_VARIANT void Sensor<Float, Spectrum>::set_crop_window(const ScalarVector2i &crop_size,
                                                           const ScalarPoint2i &crop_offset) {
     m_film->set_crop_window(crop_size, crop_offset);
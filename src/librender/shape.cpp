@@ -9,6 +9,8 @@
 NAMESPACE_BEGIN(mitsuba)
 
 MTS_VARIANT Shape<Float, Spectrum>::Shape(const Properties &props) : m_id(props.id()) {
+    m_portal = props.bool_("portal", false);
+
     for (auto &kv : props.objects()) {
         Emitter *emitter = dynamic_cast<Emitter *>(kv.second.get());
         BSDF *bsdf = dynamic_cast<BSDF *>(kv.second.get());
@@ -62,6 +64,10 @@ MTS_VARIANT Float Shape<Float, Spectrum>::pdf_position(const PositionSample3f &
 MTS_VARIANT RTCGeometry Shape<Float, Spectrum>::embree_geometry(RTCDevice) const {
     NotImplementedError("embree_geometry");
 }
+
+MTS_VARIANT RTCScene Shape<Float, Spectrum>::embree_scene(RTCDevice) const {
+    NotImplementedError("embree_scene");
+}
 #endif
 
 #if defined(MTS_ENABLE_OPTIX)
@@ -117,6 +123,18 @@ MTS_VARIANT typename Shape<Float, Spectrum>::Mask Shape<Float, Spectrum>::ray_te
     return ray_intersect(ray, unused).first;
 }
 
+MTS_VARIANT std::pair<typename Shape<Float, Spectrum>::Mask, Float>
+Shape<Float, Spectrum>::ray_intersect(ScalarIndex /*prim_index*/, const Ray3f &ray,
+                                      Float *cache, Mask active) const {
+    return ray_intersect(ray, cache, active);
+}
+
+MTS_VARIANT typename Shape<Float, Spectrum>::Mask
+Shape<Float, Spectrum>::ray_test(ScalarIndex /*prim_index*/, const Ray3f &ray,
+                                 Mask active) const {
+    return ray_test(ray, active);
+}
+
 MTS_VARIANT void Shape<Float, Spectrum>::fill_surface_interaction(const Ray3f & /*ray*/,
                                                                   const Float * /*cache*/,
                                                                   SurfaceInteraction3f & /*si*/,
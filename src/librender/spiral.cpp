@@ -1,71 +1,284 @@
 #include <mitsuba/core/bitmap.h>
 #include <mitsuba/render/spiral.h>
 #include <mitsuba/mitsuba.h>
+#include <algorithm>
+#include <cstring>
 #include <mutex>
+#include <tuple>
 
 NAMESPACE_BEGIN(mitsuba)
 
 Spiral::Spiral(Vector2i size, Vector2i offset, size_t block_size, size_t passes)
     : m_block_size(block_size),
       m_size(size), m_offset(offset),
+      m_worker_count(0),
       m_remaining_passes(passes) {
 
     m_blocks = Vector2i(ceil(Vector2f(m_size) / m_block_size));
     m_block_count = hprod(m_blocks);
 
+    m_cost.reset(new AtomicFloat<float>[m_block_count]);
+    m_owner.reset(new std::atomic<uint32_t>[m_block_count]);
+
+    /* Reserve capacity for the worst case (every block of every pass split
+       into quadrants) up front: published schedule entries must remain at
+       a stable address, since workers read them without holding a lock.
+       The claim flags mirror this capacity. */
+    m_queue.reserve(m_block_count * std::max(passes, (size_t) 1) * 4);
+    m_claimed.reset(new std::atomic<uint8_t>[m_queue.capacity()]);
+
     reset();
 }
 
 void Spiral::reset() {
-    m_block_counter = 0;
-    m_current_direction = Direction::Right;
-    m_position = m_blocks / 2;
-    m_steps_left = 1;
-    m_steps = 1;
+    std::lock_guard<tbb::spin_mutex> lock(m_mutex);
+
+    m_queue.clear();
+    m_queue_size.store(0, std::memory_order_relaxed);
+    m_block_index.store(0, std::memory_order_relaxed);
+    m_claimed_count.store(0, std::memory_order_relaxed);
+
+    for (size_t i = 0; i < m_queue.capacity(); ++i)
+        m_claimed[i].store(0, std::memory_order_relaxed);
+
+    for (size_t i = 0; i < m_block_count; ++i) {
+        m_cost[i] = 0.f;
+        m_owner[i].store(InvalidWorker, std::memory_order_relaxed);
+    }
+
+    std::fill(m_worker_scan.begin(), m_worker_scan.end(), 0);
+
+    append_pass();
 }
 
-std::pair<Spiral::Vector2i, Spiral::Vector2i> Spiral::next_block() {
-    // Reimplementation of the spiraling block generator by Adam Arbree.
-    std::lock_guard<tbb::spin_mutex> lock(m_mutex);
+void Spiral::set_worker_count(uint32_t workers) {
+    m_worker_count = workers;
+    m_worker_scan.assign(workers, 0);
+}
+
+void Spiral::set_density(const float *density) {
+    m_density.reset(new float[m_block_count]);
+    memcpy(m_density.get(), density, m_block_count * sizeof(float));
+    reset();
+}
 
-    if (m_block_count == m_block_counter) {
-        if (m_remaining_passes > 1) {
-            --m_remaining_passes;
-            reset();
+void Spiral::append_pass() {
+    // Enumerate the blocks of the regular grid, following Adam Arbree's spiral
+    std::vector<std::tuple<float, Vector2i, Vector2i>> blocks;
+    blocks.reserve(m_block_count);
+
+    double mean_cost = 0.0;
+    for (size_t i = 0; i < m_block_count; ++i)
+        mean_cost += m_cost[i];
+    mean_cost /= m_block_count;
+
+    /* Before any cost feedback exists (i.e. on the first pass), density
+       estimates from the integrator's prepass steer the granularity:
+       aligned 2x2 groups of empty blocks are merged into a single work
+       item, which avoids oversubscribing the scheduler with trivial sky
+       blocks, and much-denser-than-average blocks are split below. */
+    const float *density = (mean_cost == 0.0) ? m_density.get() : nullptr;
+    float mean_density = 0.f;
+    std::vector<uint8_t> merged; // 0: regular, 1: merge anchor, 2: consumed
+    if (density) {
+        for (size_t i = 0; i < m_block_count; ++i)
+            mean_density += density[i];
+        mean_density /= m_block_count;
+
+        merged.assign(m_block_count, 0);
+        for (int y = 0; y + 1 < m_blocks.y(); y += 2) {
+            for (int x = 0; x + 1 < m_blocks.x(); x += 2) {
+                size_t i00 = (size_t) x + (size_t) y * m_blocks.x(),
+                       i10 = i00 + 1,
+                       i01 = i00 + m_blocks.x(),
+                       i11 = i01 + 1;
+                if (density[i00] == 0.f && density[i10] == 0.f &&
+                    density[i01] == 0.f && density[i11] == 0.f) {
+                    merged[i00] = 1;
+                    merged[i10] = merged[i01] = merged[i11] = 2;
+                }
+            }
         }
-        else
-            return { Vector2i(0), Vector2i(0) };
     }
 
-    Vector2i offset(m_position * (int) m_block_size);
-    Vector2i size = min((int) m_block_size, m_size - offset);
-    offset += m_offset;
+    Point2i position = m_blocks / 2;
+    Direction direction = Direction::Right;
+    int steps_left = 1, steps = 1;
+
+    for (size_t i = 0; i < m_block_count; ++i) {
+        size_t index = (size_t) position.x() +
+                       (size_t) position.y() * (size_t) m_blocks.x();
 
-    Assert(all(size > 0));
+        uint8_t state = merged.empty() ? 0 : merged[index];
+        if (state != 2) { // Skip blocks consumed by a merged neighbor
+            int scale = state == 1 ? 2 : 1;
+            Vector2i offset(position * (int) m_block_size);
+            Vector2i size = min((int) (scale * m_block_size), m_size - offset);
+            Assert(all(size > 0));
 
-    ++m_block_counter;
+            /* In density mode, the (otherwise zero) cost slot carries the
+               density estimate so the split decision below can use it */
+            float cost = density ? density[index] : (float) m_cost[index];
+            blocks.emplace_back(cost, offset + m_offset, size);
+        }
+
+        if (i + 1 == m_block_count)
+            break;
 
-    if (m_block_counter != m_block_count) {
-        // Prepare the next block's position along the spiral.
         do {
-            switch (m_current_direction) {
-                case Direction::Right: ++m_position.x(); break;
-                case Direction::Down:  ++m_position.y(); break;
-                case Direction::Left:  --m_position.x(); break;
-                case Direction::Up:    --m_position.y(); break;
+            switch (direction) {
+                case Direction::Right: ++position.x(); break;
+                case Direction::Down:  ++position.y(); break;
+                case Direction::Left:  --position.x(); break;
+                case Direction::Up:    --position.y(); break;
             }
 
-            if (--m_steps_left == 0) {
-                m_current_direction = Direction(((int) m_current_direction + 1) % 4);
-                if (m_current_direction == Direction::Left ||
-                    m_current_direction == Direction::Right)
-                    ++m_steps;
-                m_steps_left = m_steps;
+            if (--steps_left == 0) {
+                direction = Direction(((int) direction + 1) % 4);
+                if (direction == Direction::Left ||
+                    direction == Direction::Right)
+                    ++steps;
+                steps_left = steps;
             }
-        } while (any(m_position < 0 || m_position >= m_blocks));
+        } while (any(position < 0 || position >= m_blocks));
+    }
+
+    /* Without cost feedback (i.e. on the first pass), the stable sort
+       preserves the spiral order */
+    if (mean_cost > 0.0)
+        std::stable_sort(blocks.begin(), blocks.end(),
+                         [](const auto &a, const auto &b) {
+                             return std::get<0>(a) > std::get<0>(b);
+                         });
+
+    /* Only reachable when set_passes() extended the schedule beyond what
+       the constructor reserved -- in that case, concurrent rendering is
+       not supported anyway. */
+    if (unlikely(m_queue.capacity() < m_queue.size() + 4 * m_block_count)) {
+        m_queue.reserve(m_queue.size() + 4 * m_block_count);
+
+        std::unique_ptr<std::atomic<uint8_t>[]> claimed(
+            new std::atomic<uint8_t>[m_queue.capacity()]);
+        for (size_t i = 0; i < m_queue.capacity(); ++i)
+            claimed[i].store(i < m_queue.size()
+                                 ? m_claimed[i].load(std::memory_order_relaxed)
+                                 : (uint8_t) 0,
+                             std::memory_order_relaxed);
+        m_claimed = std::move(claimed);
     }
 
-    return { offset, size };
+    for (auto const &[cost, offset, size] : blocks) {
+        /* Split blocks that are much more expensive than average (or, on
+           the first pass, cover much denser geometry) into quadrants, so
+           that several idle workers can share the load */
+        bool split = density
+            ? (mean_density > 0.f && cost > 2.f * mean_density)
+            : (mean_cost > 0.0 && cost > 2.0 * mean_cost);
+        if (split && all(size > 1)) {
+            Vector2i half = (size + 1) / 2;
+            for (int qy = 0; qy < 2; ++qy) {
+                for (int qx = 0; qx < 2; ++qx) {
+                    Vector2i sub_offset(qx * half.x(), qy * half.y()),
+                             sub_size = min(half, size - sub_offset);
+                    if (all(sub_size > 0))
+                        m_queue.emplace_back(offset + sub_offset, sub_size);
+                }
+            }
+        } else {
+            m_queue.emplace_back(offset, size);
+        }
+    }
+
+    m_queue_size.store(m_queue.size(), std::memory_order_release);
+}
+
+size_t Spiral::grid_index(const Vector2i &offset) const {
+    Vector2i position = (offset - m_offset) / (int) m_block_size;
+    size_t index = (size_t) position.x() +
+                   (size_t) position.y() * (size_t) m_blocks.x();
+    Assert(index < m_block_count);
+    return index;
+}
+
+bool Spiral::try_claim(size_t index, uint32_t worker, size_t *block_id) {
+    uint8_t expected = 0;
+    if (!m_claimed[index].compare_exchange_strong(
+            expected, 1, std::memory_order_relaxed))
+        return false;
+
+    m_claimed_count.fetch_add(1, std::memory_order_relaxed);
+
+    /* The claiming worker becomes the block's owner, so that the next pass
+       hands it back to the same cache (this also reassigns stolen blocks) */
+    if (worker < m_worker_count)
+        m_owner[grid_index(m_queue[index].first)].store(
+            worker, std::memory_order_relaxed);
+
+    if (block_id)
+        *block_id = index;
+    return true;
+}
+
+std::pair<Spiral::Vector2i, Spiral::Vector2i> Spiral::next_block(uint32_t worker,
+                                                                 size_t *block_id) {
+    while (true) {
+        size_t size = m_queue_size.load(std::memory_order_acquire);
+
+        /* Affinity fast path: claim a block that this worker rendered on a
+           previous pass. The scan position only ever advances past a
+           contiguous prefix of claimed entries and is touched by no other
+           thread. */
+        if (worker < m_worker_count) {
+            size_t &scan = m_worker_scan[worker];
+            for (size_t i = scan; i < size; ++i) {
+                if (m_claimed[i].load(std::memory_order_relaxed)) {
+                    if (i == scan)
+                        ++scan;
+                    continue;
+                }
+                if (m_owner[grid_index(m_queue[i].first)].load(
+                        std::memory_order_relaxed) != worker)
+                    continue;
+                if (try_claim(i, worker, block_id))
+                    return m_queue[i];
+            }
+        }
+
+        /* Global order: claim the first unclaimed entry, stealing blocks
+           owned by other workers if need be. The shared watermark advances
+           over the claimed prefix so that scans stay short. */
+        size_t index = m_block_index.load(std::memory_order_relaxed);
+        for (size_t i = index; i < size; ++i) {
+            if (m_claimed[i].load(std::memory_order_relaxed)) {
+                if (i == index &&
+                    m_block_index.compare_exchange_weak(
+                        index, i + 1, std::memory_order_relaxed))
+                    index = i + 1;
+                continue;
+            }
+            if (try_claim(i, worker, block_id))
+                return m_queue[i];
+        }
+
+        // Current pass exhausted -- extend the schedule or report completion
+        std::lock_guard<tbb::spin_mutex> lock(m_mutex);
+
+        /* Entries are still (or, after a concurrent pass transition, again)
+           unclaimed -- retry the scan */
+        if (m_claimed_count.load(std::memory_order_relaxed) <
+            m_queue_size.load(std::memory_order_relaxed))
+            continue;
+
+        if (m_remaining_passes <= 1)
+            return { Vector2i(0), Vector2i(0) };
+
+        --m_remaining_passes;
+        append_pass();
+    }
+}
+
+void Spiral::record_cost(const Vector2i &offset, float cost) {
+    m_cost[grid_index(offset)] += cost;
 }
 
 MTS_IMPLEMENT_CLASS(Spiral, Object)
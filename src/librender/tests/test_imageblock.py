@@ -247,4 +247,28 @@ def test06_put_values_basic(variant_scalar_spectral):
             # we'll just add one sample right in the center of each pixel.
             im.put([j + 0.5, i + 0.5], wavelengths, spectrum, alpha=1.0)
 
-    check_value(im, ref, atol=1e-6)
\ No newline at end of file
+    check_value(im, ref, atol=1e-6)
+
+def test07_variance_tracking(variant_scalar_rgb):
+    from mitsuba.core.xml import load_string
+    from mitsuba.render import ImageBlock
+
+    rfilter = load_string("""<rfilter version="2.0.0" type="box"/>""")
+    im = ImageBlock([4, 4], 5, filter=rfilter)
+    im.set_track_variance(True)
+    assert im.track_variance()
+    im.clear()
+
+    # Constant-luminance samples: the error estimate must vanish
+    for _ in range(4):
+        for i in range(4):
+            for j in range(4):
+                im.put([j + 0.5, i + 0.5], [1.0, 0.5, 0.25, 1.0, 1.0])
+    assert ek.allclose(im.error_estimate(), 0.0)
+
+    # A pixel with wildly varying luminance dominates the estimate
+    im.clear()
+    for k in range(8):
+        im.put([0.5, 0.5], [0.0, float(k % 2), 0.0, 1.0, 1.0])
+        im.put([1.5, 0.5], [0.0, 0.5, 0.0, 1.0, 1.0])
+    assert im.error_estimate() > 0.1
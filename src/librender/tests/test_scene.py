@@ -52,3 +52,40 @@ def test01_emitter_checks(variant_scalar_rgb):
                 + shape_xml.format('<emitter type="area" id="my_inner_emitter"/>')
                 + shape_xml.format('<ref id="my_emitter"/>'), 4)
 
+
+@pytest.mark.parametrize("use_bvh", [True, False])
+def test02_emitter_sampling_pdf_consistency(variant_scalar_rgb, use_bvh):
+    # Check that sample_emitter_direction() and pdf_emitter_direction() agree,
+    # both with the light hierarchy and with uniform emitter selection
+    import enoki as ek
+    from mitsuba.core.xml import load_string
+    from mitsuba.render import SurfaceInteraction3f
+
+    emitters = [(-4, 0, 1, 0.5, 8.0), (2, 1, -3, 1.0, 0.2),
+                (0, 5, 2, 0.3, 25.0), (6, -2, 4, 2.0, 1.0),
+                (-1, -6, -2, 0.8, 3.0)]
+
+    shapes = "".join("""<shape type="sphere">
+            <point name="center" x="{}" y="{}" z="{}"/>
+            <float name="radius" value="{}"/>
+            <emitter type="area">
+                <spectrum name="radiance" value="{}"/>
+            </emitter>
+        </shape>""".format(*e) for e in emitters)
+
+    scene = load_string("""<scene version="2.0.0">
+            <boolean name="light_bvh" value="{}"/>
+            {}
+        </scene>""".format(str(use_bvh).lower(), shapes))
+
+    it = SurfaceInteraction3f.zero()
+    it.p = [0.5, -0.3, 0.2]
+
+    for i in range(16):
+        sample = [(i + 0.3) / 16.0, 0.7]
+        ds, spec = scene.sample_emitter_direction(it, sample, False)
+        assert ds.pdf > 0
+        assert ek.all(ek.isfinite(spec))
+        assert ek.allclose(scene.pdf_emitter_direction(it, ds), ds.pdf,
+                           rtol=1e-4)
+
@@ -31,6 +31,24 @@ Texture<Float, Spectrum>::pdf(const SurfaceInteraction3f &, Mask) const {
     NotImplementedError("pdf");
 }
 
+MTS_VARIANT void Texture<Float, Spectrum>::eval_n(const SurfaceInteraction3f *si, size_t count,
+                                                  UnpolarizedSpectrum *out, Mask active) const {
+    for (size_t i = 0; i < count; ++i)
+        out[i] = eval(si[i], active);
+}
+
+MTS_VARIANT void Texture<Float, Spectrum>::eval_1_n(const SurfaceInteraction3f *si, size_t count,
+                                                    Float *out, Mask active) const {
+    for (size_t i = 0; i < count; ++i)
+        out[i] = eval_1(si[i], active);
+}
+
+MTS_VARIANT void Texture<Float, Spectrum>::pdf_n(const SurfaceInteraction3f *si, size_t count,
+                                                 Wavelength *out, Mask active) const {
+    for (size_t i = 0; i < count; ++i)
+        out[i] = pdf(si[i], active);
+}
+
 MTS_VARIANT Float Texture<Float, Spectrum>::eval_1(const SurfaceInteraction3f &, Mask) const {
     NotImplementedError("eval_1");
 }
@@ -0,0 +1,136 @@
+#include <mitsuba/core/util.h>
+#include <mitsuba/render/viscache.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+MTS_VARIANT VisibilityCache<Float, Spectrum>::VisibilityCache(
+    const ScalarBoundingBox3f &bbox, uint32_t resolution, size_t table_size)
+    : m_bbox(bbox), m_resolution(resolution) {
+
+    if (resolution == 0)
+        Throw("VisibilityCache: the grid resolution must be positive!");
+    if (table_size == 0 || (table_size & (table_size - 1)) != 0)
+        Throw("VisibilityCache: the table size must be a nonzero power of two!");
+
+    m_inv_cell = ScalarVector3f((ScalarFloat) resolution) /
+                 max(bbox.extents(), math::RayEpsilon<ScalarFloat>);
+    m_mask = table_size - 1;
+    m_entries.reset(new Entry[table_size]);
+
+    Log(Debug, "Allocated a %s visibility cache (%u^3 cells)",
+        util::mem_string(table_size * sizeof(Entry)), resolution);
+}
+
+MTS_VARIANT uint64_t VisibilityCache<Float, Spectrum>::cell_hash(
+    const ScalarPoint3f &p, const Object *emitter) const {
+    ScalarVector3f rel = (p - m_bbox.min) * m_inv_cell;
+    ScalarVector3i cell =
+        min(max(ScalarVector3i(rel), 0), (int32_t) m_resolution - 1);
+
+    uint64_t key = (uint64_t) (uint32_t) cell.x() +
+                   ((uint64_t) (uint32_t) cell.y() << 21) +
+                   ((uint64_t) (uint32_t) cell.z() << 42);
+    key ^= (uint64_t) (uintptr_t) emitter;
+
+    // SplitMix64 finalizer: decorrelate the table index from the input bits
+    key += 0x9e3779b97f4a7c15ull;
+    key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ull;
+    key = (key ^ (key >> 27)) * 0x94d049bb133111ebull;
+    key ^= key >> 31;
+
+    // Zero marks an unused slot
+    return key != 0 ? key : 1;
+}
+
+MTS_VARIANT bool VisibilityCache<Float, Spectrum>::lookup(
+    const ScalarPoint3f &p, const Object *emitter, bool &occluded) const {
+    uint64_t key = cell_hash(p, emitter);
+    const Entry &entry = m_entries[key & m_mask];
+
+    if (entry.key.load(std::memory_order_relaxed) != key)
+        return false;
+
+    uint32_t n_occluded = entry.occluded.load(std::memory_order_relaxed),
+             n_visible  = entry.visible.load(std::memory_order_relaxed);
+
+    /* Only trust pairs whose observations are unanimous and numerous. Mixed
+       counts indicate a cell straddling an occluder boundary. */
+    if ((n_occluded != 0 && n_visible != 0) ||
+        n_occluded + n_visible < Confidence)
+        return false;
+
+    /* Let a fixed fraction of lookups fall through to a real shadow ray so
+       that an incorrect classification cannot persist indefinitely */
+    if (entry.queries.fetch_add(1, std::memory_order_relaxed) %
+            RevalidationPeriod == 0)
+        return false;
+
+    occluded = n_occluded != 0;
+    return true;
+}
+
+MTS_VARIANT void VisibilityCache<Float, Spectrum>::record(
+    const ScalarPoint3f &p, const Object *emitter, bool occluded) {
+    uint64_t key = cell_hash(p, emitter);
+    Entry &entry = m_entries[key & m_mask];
+
+    if (entry.key.load(std::memory_order_relaxed) != key) {
+        /* Claim an empty slot or evict a colliding pair. A racing thread
+           doing the same merely discards one observation. */
+        entry.key.store(key, std::memory_order_relaxed);
+        entry.occluded.store(0, std::memory_order_relaxed);
+        entry.visible.store(0, std::memory_order_relaxed);
+        entry.queries.store(0, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint32_t> &agreeing = occluded ? entry.occluded : entry.visible,
+                          &opposing = occluded ? entry.visible : entry.occluded;
+
+    if (opposing.load(std::memory_order_relaxed) != 0) {
+        /* Contradicting observation: restart the classification so that the
+           entry must prove itself unanimous again */
+        opposing.store(0, std::memory_order_relaxed);
+        agreeing.store(1, std::memory_order_relaxed);
+    } else if (agreeing.load(std::memory_order_relaxed) < CounterLimit) {
+        agreeing.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+MTS_VARIANT void VisibilityCache<Float, Spectrum>::clear() {
+    for (size_t i = 0; i <= m_mask; ++i) {
+        Entry &entry = m_entries[i];
+        entry.key.store(0, std::memory_order_relaxed);
+        entry.occluded.store(0, std::memory_order_relaxed);
+        entry.visible.store(0, std::memory_order_relaxed);
+        entry.queries.store(0, std::memory_order_relaxed);
+    }
+}
+
+MTS_VARIANT std::string VisibilityCache<Float, Spectrum>::to_string() const {
+    size_t used = 0, classified = 0;
+    for (size_t i = 0; i <= m_mask; ++i) {
+        const Entry &entry = m_entries[i];
+        if (entry.key.load(std::memory_order_relaxed) == 0)
+            continue;
+        ++used;
+
+        uint32_t n_occluded = entry.occluded.load(std::memory_order_relaxed),
+                 n_visible  = entry.visible.load(std::memory_order_relaxed);
+        if ((n_occluded == 0) != (n_visible == 0) &&
+            n_occluded + n_visible >= Confidence)
+            ++classified;
+    }
+
+    std::ostringstream oss;
+    oss << "VisibilityCache[" << std::endl
+        << "  resolution = " << m_resolution << "," << std::endl
+        << "  table_size = " << m_mask + 1 << "," << std::endl
+        << "  used_entries = " << used << "," << std::endl
+        << "  classified_entries = " << classified << std::endl
+        << "]";
+    return oss.str();
+}
+
+MTS_IMPLEMENT_CLASS_VARIANT(VisibilityCache, Object)
+MTS_INSTANTIATE_CLASS(VisibilityCache)
+NAMESPACE_END(mitsuba)
@@ -0,0 +1,215 @@
+#include <mitsuba/ui/tilestream.h>
+#include <mitsuba/core/bitmap.h>
+#include <mitsuba/core/logger.h>
+
+#include <nanogui/opengl.h>
+
+#include <cstring>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/* The raw data is kept in linear RGBA32F form; this pair of shaders
+   implements the develop step (exposure followed by the sRGB transfer
+   function) while rasterizing a single full-screen triangle */
+
+static const char *tonemap_vertex_shader = R"(
+    #version 330
+    out vec2 uv;
+    void main() {
+        vec2 v = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+        uv = v;
+        gl_Position = vec4(v * 2.0 - 1.0, 0.0, 1.0);
+    }
+)";
+
+static const char *tonemap_fragment_shader = R"(
+    #version 330
+    uniform sampler2D source;
+    uniform float scale;
+    in vec2 uv;
+    out vec4 frag_color;
+
+    vec3 to_srgb(vec3 v) {
+        vec3 a = 12.92 * v,
+             b = 1.055 * pow(max(v, 0.0), vec3(1.0 / 2.4)) - 0.055;
+        return mix(a, b, step(vec3(0.0031308), v));
+    }
+
+    void main() {
+        vec4 p = texture(source, uv);
+        frag_color = vec4(to_srgb(p.rgb * scale), p.a);
+    }
+)";
+
+static GLuint compile_shader(GLenum type, const char *source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint status = 0;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status != GL_TRUE) {
+        char log[1024];
+        glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+        glDeleteShader(shader);
+        Throw("GPUTileStream: could not compile the tonemapping %s shader: %s",
+              type == GL_VERTEX_SHADER ? "vertex" : "fragment", log);
+    }
+    return shader;
+}
+
+GPUTileStream::GPUTileStream(const Vector<int, 2> &size) : m_size(size) {
+    if (size.x() <= 0 || size.y() <= 0)
+        Throw("GPUTileStream: image size must be positive, got %ix%i!",
+              size.x(), size.y());
+
+    /* Raw framebuffer contents */
+    glGenTextures(1, &m_hdr_texture);
+    glBindTexture(GL_TEXTURE_2D, m_hdr_texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, size.x(), size.y(), 0,
+                 GL_RGBA, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenBuffers(2, m_pbo);
+
+    /* Tonemapped output, displayed by the viewer */
+    m_display = new GPUTexture(
+        GPUTexture::PixelFormat::RGBA, GPUTexture::ComponentFormat::Float32,
+        nanogui::Vector2i(size.x(), size.y()),
+        GPUTexture::InterpolationMode::Bilinear,
+        GPUTexture::InterpolationMode::Nearest,
+        GPUTexture::WrapMode::ClampToEdge, 1,
+        (uint8_t) (GPUTexture::TextureFlags::ShaderRead |
+                   GPUTexture::TextureFlags::RenderTarget));
+
+    glGenFramebuffers(1, &m_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                           GL_TEXTURE_2D, m_display->texture_handle(), 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        Throw("GPUTileStream: could not create the tonemapping framebuffer!");
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    /* The full-screen triangle is generated in the vertex shader, but core
+       profile contexts still require a vertex array object to be bound */
+    glGenVertexArrays(1, &m_vertex_array);
+
+    GLuint vs = compile_shader(GL_VERTEX_SHADER, tonemap_vertex_shader),
+           fs = compile_shader(GL_FRAGMENT_SHADER, tonemap_fragment_shader);
+    m_program = glCreateProgram();
+    glAttachShader(m_program, vs);
+    glAttachShader(m_program, fs);
+    glLinkProgram(m_program);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+
+    GLint status = 0;
+    glGetProgramiv(m_program, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE) {
+        char log[1024];
+        glGetProgramInfoLog(m_program, sizeof(log), nullptr, log);
+        Throw("GPUTileStream: could not link the tonemapping shader: %s", log);
+    }
+}
+
+GPUTileStream::~GPUTileStream() {
+    glDeleteProgram(m_program);
+    glDeleteVertexArrays(1, &m_vertex_array);
+    glDeleteFramebuffers(1, &m_framebuffer);
+    glDeleteBuffers(2, m_pbo);
+    glDeleteTextures(1, &m_hdr_texture);
+}
+
+void GPUTileStream::put_tile(const Vector<int, 2> &offset,
+                             const Vector<int, 2> &size, const float *data) {
+    if (offset.x() < 0 || offset.y() < 0 ||
+        offset.x() + size.x() > m_size.x() ||
+        offset.y() + size.y() > m_size.y())
+        Throw("GPUTileStream::put_tile(): tile [%ix%i + %ix%i] exceeds the "
+              "image boundaries (%ix%i)!", offset.x(), offset.y(), size.x(),
+              size.y(), m_size.x(), m_size.y());
+
+    GLuint pbo = m_pbo[m_pbo_index];
+    m_pbo_index = (m_pbo_index + 1) % 2;
+
+    size_t nbytes = (size_t) size.x() * (size_t) size.y() * 4 * sizeof(float);
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+
+    /* Orphan the previous contents so that the copy below never stalls on a
+       transfer that is still in flight; with two buffers in rotation, the
+       driver overlaps the DMA of one tile with the fill of the next */
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, nbytes, nullptr, GL_STREAM_DRAW);
+
+    void *ptr = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, nbytes,
+                                 GL_MAP_WRITE_BIT |
+                                 GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (!ptr)
+        Throw("GPUTileStream::put_tile(): could not map the upload buffer!");
+    memcpy(ptr, data, nbytes);
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+    glBindTexture(GL_TEXTURE_2D, m_hdr_texture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, offset.x(), offset.y(), size.x(),
+                    size.y(), GL_RGBA, GL_FLOAT, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    m_dirty = true;
+}
+
+void GPUTileStream::put_bitmap(const Bitmap *bitmap) {
+    if (bitmap->pixel_format() != Bitmap::PixelFormat::RGBA ||
+        bitmap->component_format() != Struct::Type::Float32)
+        Throw("GPUTileStream::put_bitmap(): expected an RGBA single "
+              "precision bitmap, got %s/%s!", bitmap->pixel_format(),
+              bitmap->component_format());
+
+    put_tile(Vector<int, 2>(0, 0), Vector<int, 2>(bitmap->size()),
+             (const float *) bitmap->data());
+}
+
+void GPUTileStream::set_exposure(float exposure) {
+    if (exposure == m_exposure)
+        return;
+    m_exposure = exposure;
+    m_dirty = true;
+}
+
+GPUTexture *GPUTileStream::texture() {
+    if (m_dirty)
+        refresh();
+    return m_display.get();
+}
+
+void GPUTileStream::refresh() {
+    GLint prev_framebuffer = 0, prev_viewport[4];
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prev_framebuffer);
+    glGetIntegerv(GL_VIEWPORT, prev_viewport);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    glViewport(0, 0, m_size.x(), m_size.y());
+
+    glUseProgram(m_program);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_hdr_texture);
+    glUniform1i(glGetUniformLocation(m_program, "source"), 0);
+    glUniform1f(glGetUniformLocation(m_program, "scale"),
+                std::exp2(m_exposure));
+
+    glBindVertexArray(m_vertex_array);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glUseProgram(0);
+    glBindFramebuffer(GL_FRAMEBUFFER, (GLuint) prev_framebuffer);
+    glViewport(prev_viewport[0], prev_viewport[1], prev_viewport[2],
+               prev_viewport[3]);
+
+    m_dirty = false;
+}
+
+NAMESPACE_END(mitsuba)
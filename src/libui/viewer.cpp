@@ -1,11 +1,13 @@
 #include <mitsuba/ui/viewer.h>
 #include <mitsuba/ui/texture.h>
+#include <mitsuba/ui/tilestream.h>
 #include <mitsuba/core/bitmap.h>
 #include <mitsuba/core/filesystem.h>
 #include <mitsuba/core/appender.h>
 #include <mitsuba/core/fstream.h>
 #include <mitsuba/core/fresolver.h>
 #include <mitsuba/core/formatter.h>
+#include <mitsuba/core/xml.h>
 
 #include <nanogui/layout.h>
 #include <nanogui/label.h>
@@ -28,16 +30,32 @@ struct MitsubaViewer::Tab {
     struct Layer {
         std::string name;
         ref<Bitmap> bitmap;
+        ref<GPUTileStream> stream;
         ng::ref<GPUTexture> texture;
 
         Layer(const std::string &name, Bitmap *bitmap)
-            : name(name), bitmap(bitmap), texture(new GPUTexture(bitmap)) { }
+            : name(name), bitmap(bitmap) {
+            /* High dynamic range content goes through the tile streamer,
+               which uploads the raw data and tonemaps it on the GPU;
+               anything else is displayed as-is */
+            if (bitmap->pixel_format() == Bitmap::PixelFormat::RGBA &&
+                bitmap->component_format() == Struct::Type::Float32) {
+                stream = new GPUTileStream(Vector<int, 2>(bitmap->size()));
+                stream->put_bitmap(bitmap);
+                texture = stream->texture();
+            } else {
+                texture = new GPUTexture(bitmap);
+            }
+        }
     };
 
     int id = 0;
     ng::ref<ng::VScrollPanel> console_panel;
     ng::ref<ng::TextArea> console;
     std::vector<Layer> layers;
+
+    /// Scene loaded into this tab, if any (set by a background worker)
+    ref<Object> scene;
 };
 
 MitsubaViewer::MitsubaViewer()
@@ -213,16 +231,16 @@ MitsubaViewer::MitsubaViewer()
     m_progress_panel = new Widget(m_contents);
     layout->set_anchor(m_progress_panel, Anchor(1, 2, Alignment::Fill, Alignment::Fill));
 
-    Label *label1 = new Label(m_progress_panel, "Rendering:", "sans-bold");
-    Label *label2 = new Label(m_progress_panel, "30% (ETA: 0.2s)");
+    m_progress_caption = new Label(m_progress_panel, "Idle", "sans-bold");
+    m_progress_label = new Label(m_progress_panel, "");
     m_progress_bar = new ProgressBar(m_progress_panel);
-    m_progress_bar->set_value(.3f);
+    m_progress_bar->set_value(0.f);
 
     AdvancedGridLayout *progress_layout = new AdvancedGridLayout({0, 5, 0, 10, 0}, {0}, 0);
     progress_layout->set_col_stretch(4, 1);
     m_progress_panel->set_layout(progress_layout);
-    progress_layout->set_anchor(label1, Anchor(0, 0));
-    progress_layout->set_anchor(label2, Anchor(2, 0));
+    progress_layout->set_anchor(m_progress_caption, Anchor(0, 0));
+    progress_layout->set_anchor(m_progress_label, Anchor(2, 0));
     progress_layout->set_anchor(m_progress_bar, Anchor(4, 0));
 
     Screen::set_resize_callback([this](const ng::Vector2i &size) {
@@ -266,15 +284,36 @@ public:
         });
     }
 
-    void log_progress(float /*progress*/, const std::string & /*name*/,
-                      const std::string & /*formatted*/, const std::string & /*eta*/,
-                      const void * /*ptr*/) {}
+    void log_progress(float progress, const std::string &name,
+                      const std::string & /*formatted*/, const std::string &eta,
+                      const void * /*ptr*/) {
+        /* Throttle progress updates: the loaders report at a rate that would
+           flood the UI event queue of a busy interface */
+        float now = (float) glfwGetTime();
+        if (progress != 1.f && now - m_last_progress_update < 0.05f)
+            return;
+        m_last_progress_update = now;
+
+        m_viewer->set_progress(name + (eta.empty() ? "" : " " + eta),
+                               progress);
+    }
 
 private:
     MitsubaViewer *m_viewer;
     MitsubaViewer::Tab *m_tab;
+    float m_last_progress_update = 0.f;
 };
 
+void MitsubaViewer::set_progress(const std::string &caption, float value) {
+    ng::async([this, caption, value]() {
+        m_progress_caption->set_caption(caption.empty() ? "Idle" : caption);
+        m_progress_label->set_caption(
+            value >= 0.f ? tfm::format("%.0f%%", value * 100.f) : "");
+        m_progress_bar->set_value(std::max(value, 0.f));
+        redraw();
+    });
+}
+
 MitsubaViewer::Tab *MitsubaViewer::append_tab(const std::string &name) {
     Tab *tab = new Tab();
     tab->console_panel = new ng::VScrollPanel(m_tab_widget);
@@ -292,7 +331,8 @@ MitsubaViewer::Tab *MitsubaViewer::append_tab(const std::string &name) {
     return tab;
 }
 
-void MitsubaViewer::load(Tab *tab, const fs::path &fname) {
+void MitsubaViewer::load(Tab *tab, const fs::path &fname,
+                         xml::ParameterList parameters) {
     try {
         ref<Logger> logger = new Logger();
         logger->clear_appenders();
@@ -312,9 +352,29 @@ void MitsubaViewer::load(Tab *tab, const fs::path &fname) {
                 for (auto &kv: images)
                     tab->layers.emplace_back(kv.first, kv.second);
             });
+        } else {
+            /* Not an image -- parse the file as a scene. This runs on the
+               calling worker thread, so even a very large scene leaves the
+               interface responsive; progress and log output stream into the
+               tab console and the progress panel through the logger set up
+               above. Scenes using the lazily built two-level acceleration
+               structure ('kd_two_level') become renderable as soon as this
+               returns, with per-shape trees constructed on first hit. */
+            set_progress("Loading " + fname.filename().string(), 0.f);
+            stream->close();
+
+            ref<Object> scene =
+                xml::load_file(fname, MTS_DEFAULT_VARIANT, parameters);
+
+            set_progress("", -1.f);
+            ng::async([this, tab, scene = std::move(scene)]() mutable {
+                tab->scene = std::move(scene);
+                redraw();
+            });
         }
     } catch (const std::exception &e) {
         Log(Warn, "A critical exception occurred: %s", e.what());
+        set_progress("", -1.f);
     }
 }
 
@@ -15,7 +15,8 @@ NAMESPACE_BEGIN(mitsuba)
 template <typename Float, typename Spectrum>
 class HeterogeneousMedium final : public Medium<Float, Spectrum> {
 public:
-    MTS_IMPORT_BASE(Medium, m_is_homogeneous, m_has_spectral_extinction)
+    MTS_IMPORT_BASE(Medium, m_is_homogeneous, m_has_spectral_extinction,
+                    m_dedicated_transmittance)
     MTS_IMPORT_TYPES(Scene, Sampler, Texture, Volume)
 
     HeterogeneousMedium(const Properties &props) : Base(props) {
@@ -50,14 +51,84 @@ public:
 
         m_max_density = m_density_scale * m_sigmat->max();
         m_aabb        = m_sigmat->bbox();
+
+        /* Optionally accelerate free-flight sampling with a majorant
+           supergrid: a coarse grid of per-cell density bounds that is
+           marched with a DDA so that the null-collision rate tracks the
+           local density rather than the global maximum. */
+        uint32_t majorant_res = (uint32_t) props.size_("majorant_resolution", 0);
+        if constexpr (is_cuda_array_v<Float> || is_diff_array_v<Float>) {
+            if (majorant_res > 1)
+                Log(Warn, "The majorant supergrid is not supported in the "
+                          "GPU/autodiff modes and will be ignored.");
+            majorant_res = 0;
+        }
+
+        /* Transmittance estimator used for shadow rays: "ratio" leaves the
+           collision-by-collision tracking to the integrator, while
+           "residual_ratio" handles the bulk of the optical depth analytically
+           with a per-supergrid-cell control density, so that optically thin
+           cells cost almost no tracking steps. */
+        std::string estimator = props.string("transmittance_estimator", "ratio");
+        bool residual_ratio = estimator == "residual_ratio";
+        if (!residual_ratio && estimator != "ratio")
+            Throw("Invalid transmittance estimator \"%s\", must be one of "
+                  "\"ratio\" or \"residual_ratio\"!", estimator);
+        if (residual_ratio && majorant_res <= 1) {
+            Log(Warn, "The \"residual_ratio\" transmittance estimator requires "
+                      "a majorant supergrid (\"majorant_resolution\") -- "
+                      "falling back to \"ratio\".");
+            residual_ratio = false;
+        }
+
+        if (majorant_res > 1 && m_aabb.valid()) {
+            m_majorant_res          = majorant_res;
+            m_majorant_cell_extents = m_aabb.extents() / (ScalarFloat) majorant_res;
+            m_majorant_grid.resize((size_t) majorant_res * majorant_res * majorant_res);
+            if (residual_ratio) {
+                m_control_grid.resize(m_majorant_grid.size());
+                m_residual_grid.resize(m_majorant_grid.size());
+            }
+
+            for (uint32_t z = 0; z < majorant_res; ++z) {
+                for (uint32_t y = 0; y < majorant_res; ++y) {
+                    for (uint32_t x = 0; x < majorant_res; ++x) {
+                        ScalarPoint3f p0 = m_aabb.min +
+                            ScalarVector3f((ScalarFloat) x, (ScalarFloat) y,
+                                           (ScalarFloat) z) * m_majorant_cell_extents;
+                        ScalarBoundingBox3f cell(p0, p0 + m_majorant_cell_extents);
+                        size_t index = ((size_t) z * majorant_res + y) *
+                                       majorant_res + x;
+                        ScalarFloat cell_max =
+                            m_density_scale * m_sigmat->max_over(cell);
+                        m_majorant_grid[index] = cell_max;
+
+                        if (residual_ratio) {
+                            /* Control density and a bound on the residual
+                               |sigma_t - control| within the cell */
+                            ScalarFloat cell_mean = std::min(
+                                m_density_scale * m_sigmat->mean_over(cell),
+                                cell_max);
+                            m_control_grid[index]  = cell_mean;
+                            m_residual_grid[index] =
+                                std::max(cell_max - cell_mean, cell_mean);
+                        }
+                    }
+                }
+            }
+
+            m_dedicated_transmittance = residual_ratio;
+        }
     }
 
     UnpolarizedSpectrum
-    get_combined_extinction(const MediumInteraction3f & /* mi */,
+    get_combined_extinction(const MediumInteraction3f &mi,
                             Mask active) const override {
         // TODO: This could be a spectral quantity (at least in RGB mode)
         MTS_MASKED_FUNCTION(ProfilerPhase::MediumEvaluate, active);
-        return m_max_density;
+        if (m_majorant_grid.empty())
+            return m_max_density;
+        return majorant_at(mi.p, active);
     }
 
     std::tuple<UnpolarizedSpectrum, UnpolarizedSpectrum, UnpolarizedSpectrum>
@@ -75,6 +146,181 @@ public:
         return m_aabb.ray_intersect(ray);
     }
 
+    MediumInteraction3f sample_interaction(const Ray3f &ray, Float sample,
+                                           UInt32 channel,
+                                           Mask active) const override {
+        if (m_majorant_grid.empty())
+            return Base::sample_interaction(ray, sample, channel, active);
+
+        MTS_MASKED_FUNCTION(ProfilerPhase::MediumSample, active);
+        ENOKI_MARK_USED(channel);
+
+        // Initialize basic medium interaction fields
+        MediumInteraction3f mi;
+        mi.sh_frame    = Frame3f(ray.d);
+        mi.wi          = -ray.d;
+        mi.time        = ray.time;
+        mi.wavelengths = ray.wavelengths;
+
+        auto [aabb_its, mint, maxt] = intersect_aabb(ray);
+        aabb_its &= (enoki::isfinite(mint) || enoki::isfinite(maxt));
+        active &= aabb_its;
+        masked(mint, !active) = 0.f;
+        masked(maxt, !active) = math::Infinity<Float>;
+
+        mint = max(ray.mint, mint);
+        maxt = min(ray.maxt, maxt);
+
+        /* Sample the free-flight distance against the piecewise-constant
+           majorant field instead of the global maximum */
+        Float desired_tau = -enoki::log(1 - sample);
+        auto [sampled_t, majorant, tau] =
+            march_majorants(ray, mint, maxt, desired_tau, active);
+        ENOKI_MARK_USED(tau);
+
+        Mask valid_mi = active && (sampled_t <= maxt);
+        mi.t          = select(valid_mi, sampled_t, math::Infinity<Float>);
+        /* Keep the position finite even for lanes that escaped the medium
+           so that eval_tr_and_pdf() can reconstruct the ray later on */
+        mi.p          = ray(select(valid_mi, sampled_t, mint));
+        mi.medium     = this;
+        mi.mint       = mint;
+        std::tie(mi.sigma_s, mi.sigma_n, mi.sigma_t) =
+            get_scattering_coefficients(mi, valid_mi);
+        mi.combined_extinction =
+            select(valid_mi, UnpolarizedSpectrum(majorant),
+                   UnpolarizedSpectrum(m_max_density));
+        return mi;
+    }
+
+    std::pair<UnpolarizedSpectrum, UnpolarizedSpectrum>
+    eval_tr_and_pdf(const MediumInteraction3f &mi,
+                    const SurfaceInteraction3f &si,
+                    Mask active) const override {
+        if (m_majorant_grid.empty())
+            return Base::eval_tr_and_pdf(mi, si, active);
+
+        MTS_MASKED_FUNCTION(ProfilerPhase::MediumEvaluate, active);
+
+        /* The free-flight distribution is exponential in the *local*
+           majorant, hence the transmittance requires integrating the
+           supergrid along the segment [mint, min(mi.t, si.t)] */
+        Vector3f d  = -mi.wi;
+        Float t_ref = select(enoki::isfinite(mi.t), mi.t, mi.mint);
+        Ray3f ray(mi.p - d * t_ref, d, mi.time, mi.wavelengths);
+
+        auto [sampled_t, majorant, tau] = march_majorants(
+            ray, mi.mint, min(mi.t, si.t), math::Infinity<Float>, active);
+        ENOKI_MARK_USED(sampled_t);
+        ENOKI_MARK_USED(majorant);
+
+        UnpolarizedSpectrum tr  = exp(-tau);
+        UnpolarizedSpectrum pdf = select(si.t < mi.t, tr,
+                                         tr * mi.combined_extinction);
+        return { tr, pdf };
+    }
+
+    UnpolarizedSpectrum eval_transmittance(const Ray3f &ray, Sampler *sampler,
+                                           UInt32 channel,
+                                           Mask active) const override {
+        if (m_control_grid.empty())
+            return Base::eval_transmittance(ray, sampler, channel, active);
+
+        MTS_MASKED_FUNCTION(ProfilerPhase::MediumEvaluate, active);
+        ENOKI_MARK_USED(channel);
+
+        auto [aabb_its, mint, maxt] = intersect_aabb(ray);
+        aabb_its &= (enoki::isfinite(mint) || enoki::isfinite(maxt));
+        active &= aabb_its;
+
+        mint = max(ray.mint, mint);
+        maxt = min(ray.maxt, maxt);
+
+        MediumInteraction3f mi;
+        mi.sh_frame    = Frame3f(ray.d);
+        mi.wi          = -ray.d;
+        mi.time        = ray.time;
+        mi.wavelengths = ray.wavelengths;
+        mi.medium      = this;
+        mi.mint        = mint;
+
+        /* Residual ratio tracking: per supergrid cell, the control density
+           contributes an analytic exponential factor and only the residual
+           |sigma_t - control| is tracked stochastically. Optically thin
+           cells have a near-zero residual and therefore cost almost no
+           density evaluations. */
+        int32_t res = (int32_t) m_majorant_res;
+
+        UnpolarizedSpectrum tr(1.f);
+        Float t = mint;
+
+        // DDA initialization (Amanatides & Woo)
+        Point3f rel  = (ray(mint) - m_aabb.min) / m_majorant_cell_extents;
+        Point3i cell = min(max(Point3i(rel), 0), res - 1);
+
+        Vector3i step;
+        Vector3f t_next, t_delta;
+        for (size_t i = 0; i < 3; ++i) {
+            Mask pos    = ray.d[i] >= 0.f;
+            step[i]     = select(pos, Int32(1), Int32(-1));
+            Float bound = m_aabb.min[i] +
+                          (Float(cell[i]) + select(pos, Float(1.f), Float(0.f))) *
+                              m_majorant_cell_extents[i];
+            Float inv   = rcp(ray.d[i]);
+            t_next[i]   = (bound - ray.o[i]) * inv;
+            t_delta[i]  = abs(m_majorant_cell_extents[i] * inv);
+            // Never step across an axis the ray does not advance along
+            masked(t_next[i], eq(ray.d[i], 0.f)) = math::Infinity<Float>;
+        }
+
+        Mask marching = active && (t < maxt);
+        while (any(marching)) {
+            Float t_exit = min(hmin(t_next), maxt);
+            Float dt     = max(t_exit - t, 0.f);
+
+            UInt32 index = (UInt32(cell.z()) * m_majorant_res + UInt32(cell.y())) *
+                               m_majorant_res + UInt32(cell.x());
+            Float control  = gather<Float>(m_control_grid.data(), index, marching),
+                  residual = gather<Float>(m_residual_grid.data(), index, marching);
+
+            // Analytic transmittance of the control density over the cell
+            masked(tr, marching) = tr * exp(-control * dt);
+
+            // Track the residual collisions inside [t, t_exit]
+            Float t_col = t - enoki::log(1 - sampler->next_1d(marching)) / residual;
+            Mask colliding = marching && (residual > 0.f) && (t_col < t_exit);
+            while (any(colliding)) {
+                mi.p = ray(t_col);
+                UnpolarizedSpectrum sigmat =
+                    m_density_scale * m_sigmat->eval(mi, colliding);
+                masked(tr, colliding) =
+                    tr * (1.f - (sigmat - control) / residual);
+
+                masked(t_col, colliding) =
+                    t_col - enoki::log(1 - sampler->next_1d(colliding)) / residual;
+                colliding &= (t_col < t_exit);
+            }
+
+            // Advance to the next cell
+            masked(t, marching) = t_exit;
+
+            Mask x_min = (t_next.x() <= t_next.y()) && (t_next.x() <= t_next.z()),
+                 y_min = !x_min && (t_next.y() <= t_next.z()),
+                 z_min = !(x_min || y_min);
+
+            masked(cell.x(),   marching && x_min) = cell.x() + step.x();
+            masked(t_next.x(), marching && x_min) = t_next.x() + t_delta.x();
+            masked(cell.y(),   marching && y_min) = cell.y() + step.y();
+            masked(t_next.y(), marching && y_min) = t_next.y() + t_delta.y();
+            masked(cell.z(),   marching && z_min) = cell.z() + step.z();
+            masked(t_next.z(), marching && z_min) = t_next.z() + t_delta.z();
+
+            marching &= (t < maxt) && all(cell >= 0 && cell < res);
+        }
+
+        return tr;
+    }
+
     void traverse(TraversalCallback *callback) override {
         callback->put_object("density", m_density.get());
         callback->put_object("albedo", m_albedo.get());
@@ -84,19 +330,121 @@ public:
     std::string to_string() const override {
         std::ostringstream oss;
         oss << "HeterogeneousMedium[" << std::endl
-            << "  albedo  = " << string::indent(m_albedo) << std::endl
-            << "  sigma_t = " << string::indent(m_sigmat) << std::endl
-            << "  density = " << string::indent(m_density) << std::endl
+            << "  albedo       = " << string::indent(m_albedo) << std::endl
+            << "  sigma_t      = " << string::indent(m_sigmat) << std::endl
+            << "  density      = " << string::indent(m_density) << std::endl
+            << "  majorant_res = " << m_majorant_res << std::endl
+            << "  transmittance_estimator = "
+            << (m_control_grid.empty() ? "ratio" : "residual_ratio") << std::endl
             << "]";
         return oss.str();
     }
 
     MTS_DECLARE_CLASS()
 private:
+    /// Fetch the majorant of the supergrid cell containing \c p
+    MTS_INLINE Float majorant_at(const Point3f &p, Mask active) const {
+        Point3f rel  = (p - m_aabb.min) / m_majorant_cell_extents;
+        Point3i cell = min(max(Point3i(rel), 0),
+                           (int32_t) m_majorant_res - 1);
+        UInt32 index = (UInt32(cell.z()) * m_majorant_res + UInt32(cell.y())) *
+                           m_majorant_res + UInt32(cell.x());
+        return gather<Float>(m_majorant_grid.data(), index, active);
+    }
+
+    /**
+     * \brief March the majorant supergrid along a ray segment
+     *
+     * Accumulates majorant optical depth over <tt>[mint, maxt]</tt> by
+     * stepping through the supergrid cells with a DDA. Marching stops early
+     * once the accumulated optical depth reaches \c desired_tau, which
+     * implements free-flight distance sampling; an infinite \c desired_tau
+     * instead integrates the full segment.
+     *
+     * \return A tuple <tt>(t, majorant, tau)</tt> with the distance at which
+     *         \c desired_tau was reached (infinity if the segment was
+     *         exhausted first), the majorant of the cell containing that
+     *         point, and the accumulated majorant optical depth.
+     */
+    std::tuple<Float, Float, Float>
+    march_majorants(const Ray3f &ray, Float mint, Float maxt,
+                    Float desired_tau, Mask active) const {
+        int32_t res = (int32_t) m_majorant_res;
+
+        Float t   = mint,
+              tau = zero<Float>(),
+              sampled_t      = math::Infinity<Float>,
+              local_majorant = zero<Float>();
+
+        // DDA initialization (Amanatides & Woo)
+        Point3f rel  = (ray(mint) - m_aabb.min) / m_majorant_cell_extents;
+        Point3i cell = min(max(Point3i(rel), 0), res - 1);
+
+        Vector3i step;
+        Vector3f t_next, t_delta;
+        for (size_t i = 0; i < 3; ++i) {
+            Mask pos    = ray.d[i] >= 0.f;
+            step[i]     = select(pos, Int32(1), Int32(-1));
+            Float bound = m_aabb.min[i] +
+                          (Float(cell[i]) + select(pos, Float(1.f), Float(0.f))) *
+                              m_majorant_cell_extents[i];
+            Float inv   = rcp(ray.d[i]);
+            t_next[i]   = (bound - ray.o[i]) * inv;
+            t_delta[i]  = abs(m_majorant_cell_extents[i] * inv);
+            // Never step across an axis the ray does not advance along
+            masked(t_next[i], eq(ray.d[i], 0.f)) = math::Infinity<Float>;
+        }
+
+        Mask marching = active && (t < maxt);
+        while (any(marching)) {
+            Float t_exit = min(hmin(t_next), maxt);
+            Float dt     = max(t_exit - t, 0.f);
+
+            UInt32 index = (UInt32(cell.z()) * m_majorant_res + UInt32(cell.y())) *
+                               m_majorant_res + UInt32(cell.x());
+            Float m_cell = gather<Float>(m_majorant_grid.data(), index, marching);
+
+            // Stop within this cell if it contains the requested optical depth
+            Mask hit = marching && (m_cell > 0.f) &&
+                       (tau + m_cell * dt >= desired_tau);
+            masked(sampled_t, hit)      = t + (desired_tau - tau) / m_cell;
+            masked(local_majorant, hit) = m_cell;
+            marching &= !hit;
+
+            // Otherwise account for the cell and advance to the next one
+            masked(tau, marching) = tau + m_cell * dt;
+            masked(t, marching)   = t_exit;
+
+            Mask x_min = (t_next.x() <= t_next.y()) && (t_next.x() <= t_next.z()),
+                 y_min = !x_min && (t_next.y() <= t_next.z()),
+                 z_min = !(x_min || y_min);
+
+            masked(cell.x(),   marching && x_min) = cell.x() + step.x();
+            masked(t_next.x(), marching && x_min) = t_next.x() + t_delta.x();
+            masked(cell.y(),   marching && y_min) = cell.y() + step.y();
+            masked(t_next.y(), marching && y_min) = t_next.y() + t_delta.y();
+            masked(cell.z(),   marching && z_min) = cell.z() + step.z();
+            masked(t_next.z(), marching && z_min) = t_next.z() + t_delta.z();
+
+            marching &= (t < maxt) && all(cell >= 0 && cell < res);
+        }
+
+        return { sampled_t, local_majorant, tau };
+    }
+
     ref<Volume> m_sigmat, m_albedo, m_density;
 
     ScalarBoundingBox3f m_aabb;
     ScalarFloat m_density_scale, m_max_density;
+
+    /// Per-cell upper bounds on m_density_scale * sigma_t (empty if disabled)
+    std::vector<ScalarFloat> m_majorant_grid;
+
+    /// Control densities and residual bounds for residual ratio tracking
+    /// (empty unless transmittance_estimator == "residual_ratio")
+    std::vector<ScalarFloat> m_control_grid, m_residual_grid;
+    uint32_t m_majorant_res = 0;
+    ScalarVector3f m_majorant_cell_extents;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(HeterogeneousMedium, Medium)
@@ -0,0 +1,594 @@
+#include <mitsuba/core/argparser.h>
+#include <mitsuba/core/bitmap.h>
+#include <mitsuba/core/filesystem.h>
+#include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/jit.h>
+#include <mitsuba/core/logger.h>
+#include <mitsuba/core/profiler.h>
+#include <mitsuba/core/string.h>
+#include <mitsuba/core/thread.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/util.h>
+#include <mitsuba/core/vector.h>
+#include <mitsuba/core/xml.h>
+#include <mitsuba/render/integrator.h>
+#include <mitsuba/render/raystream.h>
+#include <mitsuba/render/records.h>
+#include <mitsuba/render/scene.h>
+#include <mitsuba/render/sensor.h>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_scheduler_init.h>
+
+#include <atomic>
+#include <fstream>
+#include <sstream>
+
+using namespace mitsuba;
+
+static void help(int thread_count) {
+    std::cout << util::info_build(thread_count) << std::endl;
+    std::cout << util::info_copyright() << std::endl;
+    std::cout << util::info_features() << std::endl;
+    std::cout << R"(
+Usage: mitsuba-bench [options] [<One or more scene XML files>]
+
+Renders each scene in every requested mode, reports throughput and a
+per-phase breakdown of the builtin sampling profiler in JSON form, and
+optionally compares the outcome against a previously stored baseline.
+When no scene files are specified, the committed benchmark corpus in
+"resources/data/bench" is used.
+
+Options:
+
+    -h, --help
+        Display this help text.
+
+    -m, --mode
+        Benchmark the specified mode (can be specified multiple times).
+
+        Default: all modes enabled at compile time, i.e.
+              )" << string::indent(MTS_VARIANTS, 14) << R"(
+    -t <count>, --threads <count>
+        Render with the specified number of threads.
+
+    -o <filename>, --output <filename>
+        Write the JSON report to the file "filename" instead of the
+        standard output.
+
+    -b <filename>, --baseline <filename>
+        Compare against the baseline report "filename" (a previous
+        -o output) and exit with a nonzero status when the throughput
+        of any (scene, mode) pair regressed by more than the tolerance.
+
+    --tolerance <value>
+        Relative throughput regression (in percent) tolerated during
+        baseline comparison. Default value: 5.
+
+    -D <key>=<value>, --define <key>=<value>
+        Define a constant that can referenced as "$key"
+        within the scene description (e.g. to sweep kd-tree builder
+        parameters across benchmark runs).
+
+    --replay <filename>
+        Instead of rendering, re-trace the ray stream previously captured
+        via the "capture_rays" scene property against each scene's freshly
+        built acceleration structure, and report rays per second and the
+        hit rate. The scene files should match the one that produced the
+        capture (minus the "capture_rays" property, which would otherwise
+        overwrite it). Not supported in GPU modes.
+)";
+}
+
+/// Outcome of benchmarking a single (scene, mode) combination
+struct BenchResult {
+    std::string scene;
+    std::string variant;
+    double load_time = 0.0;
+    double render_time = 0.0;
+    double samples_per_second = 0.0;
+    /// Only nonzero in replay mode (see \ref bench_replay)
+    double rays_per_second = 0.0;
+    double hit_rate = 0.0;
+    std::vector<std::pair<std::string, double>> phases;
+
+    /// The throughput figure relevant to this result
+    double throughput() const {
+        return samples_per_second > 0.0 ? samples_per_second
+                                        : rays_per_second;
+    }
+};
+
+template <typename Float, typename Spectrum>
+bool bench_render(Object *scene_, BenchResult *result) {
+    auto *scene = dynamic_cast<Scene<Float, Spectrum> *>(scene_);
+    if (!scene)
+        Throw("Root element of the input file must be a <scene> tag!");
+    if (scene->sensors().empty())
+        Throw("The benchmark scene does not define a sensor!");
+    auto sensor = scene->sensors()[0];
+    auto film = sensor->film();
+
+    auto integrator = scene->integrator();
+    if (!integrator)
+        Throw("No integrator specified for scene: %s", scene->to_string());
+
+    size_t total_samples = (size_t) hprod(film->crop_size()) *
+                           (size_t) sensor->sampler()->sample_count();
+
+    /* Only attribute profiler samples gathered while rendering */
+    Profiler::clear();
+
+    Timer timer;
+    bool success = integrator->render(scene, sensor.get());
+    result->render_time = timer.value() / 1000.0;
+
+    if (success && result->render_time > 0.0)
+        result->samples_per_second = total_samples / result->render_time;
+
+    uint64_t event_count_total = 0;
+    auto profile = Profiler::flat_profile();
+    for (const auto &kv : profile)
+        event_count_total += kv.second;
+    for (const auto &kv : profile)
+        result->phases.emplace_back(
+            kv.first, kv.second * 100.0 / (double) event_count_total);
+
+    if (!success)
+        Log(Warn, "\U0000274C Rendering failed.");
+    return success;
+}
+
+/**
+ * Re-trace a captured ray stream (see \ref RayStreamRecorder) against the
+ * scene's freshly built acceleration structure. This isolates the traversal
+ * cost from sampling and shading, so that kd-tree builder parameters can be
+ * evaluated against real production ray distributions in seconds.
+ */
+template <typename Float, typename Spectrum>
+bool bench_replay(Object *scene_,
+                  const std::vector<RayStreamReader::Record> *rays,
+                  BenchResult *result) {
+    auto *scene = dynamic_cast<Scene<Float, Spectrum> *>(scene_);
+    if (!scene)
+        Throw("Root element of the input file must be a <scene> tag!");
+
+    if constexpr (is_cuda_array_v<Float>) {
+        ENOKI_MARK_USED(rays);
+        ENOKI_MARK_USED(result);
+        Throw("Ray stream replay is not supported in GPU modes!");
+    } else {
+        using ScalarFloat = scalar_t<Float>;
+        using Point3f     = Point<Float, 3>;
+        using Vector3f    = Vector<Float, 3>;
+        using Mask        = mask_t<Float>;
+        using Wavelength  = wavelength_t<Spectrum>;
+        using Ray3f       = Ray<Point3f, Spectrum>;
+
+        size_t ray_count = rays->size();
+        if (ray_count == 0)
+            Throw("The captured ray stream is empty!");
+
+        /* Only attribute profiler samples gathered while tracing */
+        Profiler::clear();
+
+        std::atomic<size_t> hits(0);
+
+        Timer timer;
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, ray_count, 4096),
+            [&](const tbb::blocked_range<size_t> &range) {
+                constexpr size_t PacketSize = array_size_v<Float>;
+                size_t local_hits = 0;
+
+                for (size_t i = range.begin(); i < range.end(); i += PacketSize) {
+                    size_t lanes = std::min(PacketSize, range.end() - i);
+
+                    Point3f o;
+                    Vector3f d;
+                    Float time;
+                    for (size_t l = 0; l < lanes; ++l) {
+                        const auto &r = (*rays)[i + l];
+                        slice(o, l)    = Point<ScalarFloat, 3>(r.o[0], r.o[1], r.o[2]);
+                        slice(d, l)    = Vector<ScalarFloat, 3>(r.d[0], r.d[1], r.d[2]);
+                        slice(time, l) = (ScalarFloat) r.time;
+                    }
+                    // Pad any unused tail lanes with a valid (masked-off) ray
+                    for (size_t l = lanes; l < PacketSize; ++l) {
+                        slice(o, l)    = slice(o, 0);
+                        slice(d, l)    = slice(d, 0);
+                        slice(time, l) = slice(time, 0);
+                    }
+
+                    Mask active = true;
+                    if constexpr (is_array_v<Float>)
+                        active = arange<Float>() < (ScalarFloat) lanes;
+
+                    Ray3f ray(o, d, time, zero<Wavelength>());
+                    auto si = scene->ray_intersect(ray, active);
+                    local_hits += count(si.is_valid() && active);
+                }
+
+                hits += local_hits;
+            });
+        result->render_time = timer.value() / 1000.0;
+
+        if (result->render_time > 0.0)
+            result->rays_per_second = ray_count / result->render_time;
+        result->hit_rate = hits / (double) ray_count;
+
+        uint64_t event_count_total = 0;
+        auto profile = Profiler::flat_profile();
+        for (const auto &kv : profile)
+            event_count_total += kv.second;
+        for (const auto &kv : profile)
+            result->phases.emplace_back(
+                kv.first, kv.second * 100.0 / (double) event_count_total);
+
+        return true;
+    }
+}
+
+/// Serialize a benchmark report (the format parsed by \ref parse_report)
+static void write_report(std::ostream &os,
+                         const std::vector<BenchResult> &results) {
+    os << "{\n  \"results\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult &r = results[i];
+        os << (i > 0 ? "," : "") << "\n    {\n"
+           << "      \"scene\": \"" << r.scene << "\",\n"
+           << "      \"variant\": \"" << r.variant << "\",\n"
+           << "      \"load_time\": " << r.load_time << ",\n"
+           << "      \"render_time\": " << r.render_time << ",\n"
+           << "      \"samples_per_second\": " << r.samples_per_second << ",\n"
+           << "      \"rays_per_second\": " << r.rays_per_second << ",\n"
+           << "      \"hit_rate\": " << r.hit_rate << ",\n"
+           << "      \"phases\": {";
+        for (size_t j = 0; j < r.phases.size(); ++j)
+            os << (j > 0 ? "," : "") << "\n        \"" << r.phases[j].first
+               << "\": " << r.phases[j].second;
+        os << (r.phases.empty() ? "" : "\n      ") << "}\n    }";
+    }
+    os << "\n  ]\n}" << std::endl;
+}
+
+/// Extract the quoted value following the colon of a "key": "value" line
+static std::string parse_string_value(const std::string &line) {
+    auto colon = line.find(':');
+    auto open = line.find('"', colon + 1);
+    auto close = line.find('"', open + 1);
+    if (colon == std::string::npos || open == std::string::npos ||
+        close == std::string::npos)
+        Throw("Could not parse baseline entry \"%s\"!", line);
+    return line.substr(open + 1, close - open - 1);
+}
+
+/// Extract the numeric value following the colon of a "key": value line
+static double parse_number_value(const std::string &line) {
+    auto colon = line.find(':');
+    if (colon == std::string::npos)
+        Throw("Could not parse baseline entry \"%s\"!", line);
+    return std::stod(line.substr(colon + 1));
+}
+
+/**
+ * Minimal parser for the JSON reports produced by \ref write_report. This
+ * is intentionally not a general JSON parser -- it only needs to round-trip
+ * the tool's own line-oriented output.
+ */
+static std::vector<BenchResult> parse_report(const fs::path &filename) {
+    std::ifstream is(filename.string());
+    if (!is.good())
+        Throw("Could not open baseline file \"%s\"!", filename.string());
+
+    std::vector<BenchResult> results;
+    std::string line;
+    bool in_phases = false;
+
+    while (std::getline(is, line)) {
+        line = string::trim(line);
+        if (in_phases) {
+            if (line.find('}') != std::string::npos) {
+                in_phases = false;
+            } else if (!line.empty() && line[0] == '"') {
+                /* The phase name is the key itself, the value follows the colon */
+                auto close = line.find('"', 1);
+                if (close == std::string::npos)
+                    Throw("Could not parse baseline entry \"%s\"!", line);
+                results.back().phases.emplace_back(
+                    line.substr(1, close - 1),
+                    parse_number_value(line.substr(close)));
+            }
+        } else if (line.find("\"scene\":") == 0) {
+            results.emplace_back();
+            results.back().scene = parse_string_value(line);
+        } else if (line.find("\"variant\":") == 0) {
+            results.back().variant = parse_string_value(line);
+        } else if (line.find("\"load_time\":") == 0) {
+            results.back().load_time = parse_number_value(line);
+        } else if (line.find("\"render_time\":") == 0) {
+            results.back().render_time = parse_number_value(line);
+        } else if (line.find("\"samples_per_second\":") == 0) {
+            results.back().samples_per_second = parse_number_value(line);
+        } else if (line.find("\"rays_per_second\":") == 0) {
+            results.back().rays_per_second = parse_number_value(line);
+        } else if (line.find("\"hit_rate\":") == 0) {
+            results.back().hit_rate = parse_number_value(line);
+        } else if (line.find("\"phases\":") == 0) {
+            in_phases = line.find('}') == std::string::npos;
+        }
+    }
+
+    return results;
+}
+
+/// Locate the committed default corpus relative to the installed binary
+static std::vector<std::string> default_corpus() {
+    const char *scenes[] = { "cbox.xml", "plate.xml", "spheres.xml" };
+    fs::path candidates[] = {
+        fs::path("resources/data/bench"),
+        util::library_path().parent_path() / "../resources/data/bench",
+        util::library_path().parent_path() / "../../resources/data/bench"
+    };
+
+    for (const fs::path &dir : candidates) {
+        if (!fs::exists(dir / scenes[0]))
+            continue;
+        std::vector<std::string> result;
+        for (const char *scene : scenes)
+            result.push_back((dir / scene).string());
+        return result;
+    }
+
+    Throw("Could not locate the default benchmark corpus "
+          "(resources/data/bench) -- please specify scene files explicitly.");
+}
+
+int main(int argc, char *argv[]) {
+    Jit::static_initialization();
+    Class::static_initialization();
+    Thread::static_initialization();
+    Logger::static_initialization();
+    Bitmap::static_initialization();
+    Profiler::static_initialization();
+
+    // Ensure that the mitsuba-render shared library is loaded
+    librender_nop();
+
+    ArgParser parser;
+    using StringVec    = std::vector<std::string>;
+    auto arg_threads   = parser.add(StringVec{ "-t", "--threads" }, true);
+    auto arg_output    = parser.add(StringVec{ "-o", "--output" }, true);
+    auto arg_baseline  = parser.add(StringVec{ "-b", "--baseline" }, true);
+    auto arg_tolerance = parser.add(StringVec{ "--tolerance" }, true);
+    auto arg_help      = parser.add(StringVec{ "-h", "--help" });
+    auto arg_mode      = parser.add(StringVec{ "-m", "--mode" }, true);
+    auto arg_define    = parser.add(StringVec{ "-D", "--define" }, true);
+    auto arg_replay    = parser.add(StringVec{ "--replay" }, true);
+    auto arg_extra     = parser.add("", true);
+    std::string error_msg;
+    int exit_code = 0;
+
+    try {
+        // Parse all command line options
+        parser.parse(argc, argv);
+
+        if (*arg_help) {
+            help((int) __global_thread_count);
+            exit_code = -2;
+        }
+
+        std::vector<std::string> modes;
+        while (arg_mode && *arg_mode) {
+            modes.push_back(arg_mode->as_string());
+            arg_mode = arg_mode->next();
+        }
+        if (modes.empty())
+            modes = string::tokenize(MTS_VARIANTS, "\n");
+
+        for (const std::string &mode : modes) {
+            if (string::starts_with(mode, "gpu")) {
+                cie_alloc();
+                break;
+            }
+        }
+
+        double tolerance = *arg_tolerance ? std::stod(arg_tolerance->as_string()) : 5.0;
+
+        xml::ParameterList params;
+        while (arg_define && *arg_define) {
+            std::string value = arg_define->as_string();
+            auto sep = value.find('=');
+            if (sep == std::string::npos)
+                Throw("-D/--define: expect key=value pair!");
+            params.push_back(std::make_pair(value.substr(0, sep),
+                                            value.substr(sep+1)));
+            arg_define = arg_define->next();
+        }
+
+        // Initialize Intel Thread Building Blocks with the requested number of threads
+        if (*arg_threads)
+            __global_thread_count = arg_threads->as_int();
+        if (__global_thread_count < 1)
+            Throw("Thread count must be >= 1!");
+        tbb::task_scheduler_init init((int) __global_thread_count);
+
+        // Append the mitsuba directory to the FileResolver search path list
+        ref<Thread> thread = Thread::thread();
+        ref<FileResolver> fr = thread->file_resolver();
+        fs::path base_path = util::library_path().parent_path();
+        if (!fr->contains(base_path))
+            fr->append(base_path);
+
+        std::vector<std::string> scenes;
+        while (arg_extra && *arg_extra) {
+            scenes.push_back(arg_extra->as_string());
+            arg_extra = arg_extra->next();
+        }
+
+        if (exit_code == 0) {
+            if (scenes.empty())
+                scenes = default_corpus();
+
+            Log(Info, "%s", util::info_build((int) __global_thread_count));
+#if !defined(NDEBUG)
+            Log(Warn, "Renderer is compiled in debug mode, benchmark results "
+                      "will not be meaningful.");
+#endif
+
+            /* Read back the captured ray stream before any scene is loaded,
+               in case a scene still carries the capture_rays property (which
+               would truncate the very file being replayed) */
+            std::vector<RayStreamReader::Record> replay_rays;
+            if (*arg_replay) {
+                ref<RayStreamReader> reader =
+                    new RayStreamReader(arg_replay->as_string());
+                replay_rays = reader->read_all();
+                Log(Info, "Loaded %i captured rays from \"%s\".",
+                    replay_rays.size(), arg_replay->as_string());
+            }
+
+            std::vector<BenchResult> results;
+            for (const std::string &scene_name : scenes) {
+                fs::path filename(scene_name);
+
+                ref<FileResolver> fr2 = new FileResolver(*fr);
+                thread->set_file_resolver(fr2);
+
+                // Add the scene file's directory to the search path.
+                fs::path scene_dir = filename.parent_path();
+                if (!fr2->contains(scene_dir))
+                    fr2->append(scene_dir);
+
+                for (const std::string &mode : modes) {
+                    if (*arg_replay && string::starts_with(mode, "gpu")) {
+                        Log(Warn, "Ray stream replay is not supported in GPU "
+                                  "modes -- skipping \"%s\".", mode);
+                        continue;
+                    }
+
+                    BenchResult result;
+                    result.scene = filename.filename().string();
+                    result.variant = mode;
+
+                    Log(Info, "Benchmarking \"%s\" in mode \"%s\" ..",
+                        result.scene, mode);
+
+                    Timer timer;
+                    ref<Object> parsed =
+                        xml::load_file(scene_name, mode, params);
+                    result.load_time = timer.reset() / 1000.0;
+
+                    bool success = *arg_replay
+                        ? MTS_INVOKE_VARIANT(mode, bench_replay, parsed.get(),
+                                             &replay_rays, &result)
+                        : MTS_INVOKE_VARIANT(mode, bench_render, parsed.get(),
+                                             &result);
+                    if (!success)
+                        Throw("Rendering of scene \"%s\" failed in mode "
+                              "\"%s\"!", result.scene, mode);
+
+                    if (*arg_replay)
+                        Log(Info, "  %.2f Mrays/s, %.1f%% hit rate (loaded in "
+                            "%s, traced in %s)",
+                            result.rays_per_second * 1e-6,
+                            result.hit_rate * 100.0,
+                            util::time_string((float) (result.load_time * 1000.0)),
+                            util::time_string((float) (result.render_time * 1000.0)));
+                    else
+                        Log(Info, "  %.2f Msamples/s (loaded in %s, rendered in %s)",
+                            result.samples_per_second * 1e-6,
+                            util::time_string((float) (result.load_time * 1000.0)),
+                            util::time_string((float) (result.render_time * 1000.0)));
+
+                    results.push_back(std::move(result));
+                }
+            }
+
+            if (*arg_output) {
+                std::ofstream os(arg_output->as_string());
+                if (!os.good())
+                    Throw("Could not open output file \"%s\"!",
+                          arg_output->as_string());
+                write_report(os, results);
+            } else {
+                write_report(std::cout, results);
+            }
+
+            if (*arg_baseline) {
+                auto baseline = parse_report(arg_baseline->as_string());
+                size_t regressions = 0;
+
+                for (const BenchResult &r : results) {
+                    const BenchResult *base = nullptr;
+                    for (const BenchResult &b : baseline) {
+                        if (b.scene == r.scene && b.variant == r.variant) {
+                            base = &b;
+                            break;
+                        }
+                    }
+                    if (!base || base->throughput() <= 0.0) {
+                        Log(Warn, "No baseline entry for (\"%s\", %s) -- "
+                                  "skipping.", r.scene, r.variant);
+                        continue;
+                    }
+
+                    double delta = (r.throughput() - base->throughput()) /
+                                   base->throughput() * 100.0;
+                    bool regressed = delta < -tolerance;
+                    Log(regressed ? Warn : Info,
+                        "%s (\"%s\", %s): %+.2f%% throughput vs. baseline",
+                        regressed ? "\U0000274C" : "\U00002714", r.scene,
+                        r.variant, delta);
+                    if (regressed)
+                        regressions++;
+                }
+
+                if (regressions > 0) {
+                    Log(Warn, "%i benchmark(s) regressed by more than "
+                        "%.1f%%!", regressions, tolerance);
+                    exit_code = 1;
+                }
+            }
+        }
+    } catch (const std::exception &e) {
+        error_msg = std::string("Caught a critical exception: ") + e.what();
+    } catch (...) {
+        error_msg = std::string("Caught a critical exception of unknown type!");
+    }
+
+    if (!error_msg.empty()) {
+        /* Strip zero-width spaces from the message (Mitsuba uses these
+           to properly format chains of multiple exceptions) */
+        const std::string zerowidth_space = "\xe2\x80\x8b";
+        while (true) {
+            auto it = error_msg.find(zerowidth_space);
+            if (it == std::string::npos)
+                break;
+            error_msg = error_msg.substr(0, it) + error_msg.substr(it + 3);
+        }
+
+#if defined(__WINDOWS__)
+        HANDLE console = GetStdHandle(STD_OUTPUT_HANDLE);
+        CONSOLE_SCREEN_BUFFER_INFO console_info;
+        GetConsoleScreenBufferInfo(console, &console_info);
+        SetConsoleTextAttribute(console, FOREGROUND_RED | FOREGROUND_INTENSITY);
+#else
+        std::cerr << "\x1b[31m";
+#endif
+        std::cerr << std::endl << error_msg << std::endl;
+#if defined(__WINDOWS__)
+        SetConsoleTextAttribute(console, console_info.wAttributes);
+#else
+        std::cerr << "\x1b[0m";
+#endif
+    }
+
+    Profiler::static_shutdown();
+    Bitmap::static_shutdown();
+    Logger::static_shutdown();
+    Thread::static_shutdown();
+    Class::static_shutdown();
+    Jit::static_shutdown();
+    return error_msg.empty() ? (exit_code == -2 ? 0 : exit_code) : -1;
+}
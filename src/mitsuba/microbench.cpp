@@ -0,0 +1,434 @@
+#include <mitsuba/core/argparser.h>
+#include <mitsuba/core/distr_1d.h>
+#include <mitsuba/core/distr_2d.h>
+#include <mitsuba/core/jit.h>
+#include <mitsuba/core/logger.h>
+#include <mitsuba/core/qmc.h>
+#include <mitsuba/core/random.h>
+#include <mitsuba/core/spline.h>
+#include <mitsuba/core/struct.h>
+#include <mitsuba/core/thread.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/util.h>
+#include <mitsuba/core/vector.h>
+#include <mitsuba/core/warp.h>
+
+#if defined(__linux__)
+#  include <linux/perf_event.h>
+#  include <sys/ioctl.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
+
+using namespace mitsuba;
+
+/* This tool benchmarks the leaf kernels of libcore (sample warping,
+   1D/2D distribution sampling, spline evaluation, the radical inverse,
+   and Struct conversion) in isolation, across scalar and packet widths.
+   It complements 'mitsuba-bench': end-to-end scene throughput hides
+   small regressions in these kernels, which only surface much later in
+   production renders. Compare reports across compiler or enoki upgrades. */
+
+using FloatX   = float;
+using FloatP   = enoki::Packet<float>;
+using UInt64X  = uint64_t;
+using UInt64P  = enoki::Packet<uint64_t, FloatP::Size>;
+
+template <typename Value> using Point2  = Point<Value, 2>;
+
+static void help() {
+    std::cout << util::info_build(1) << std::endl;
+    std::cout << util::info_copyright() << std::endl;
+    std::cout << util::info_features() << std::endl;
+    std::cout << R"(
+Usage: mitsuba-microbench [options]
+
+Benchmarks the leaf kernels of libcore (warp, distr_1d, distr_2d, spline,
+qmc, Struct conversion) in scalar and packet form and reports the cost
+per element. On Linux, hardware performance counters additionally provide
+cycles and last-level cache misses per element when available.
+
+Options:
+
+    -h, --help
+        Display this help text.
+
+    -d <ms>, --duration <ms>
+        Measure each kernel for the given number of milliseconds.
+
+        Default: 200
+)";
+}
+
+// -----------------------------------------------------------------------
+//! @{ \name Hardware performance counter capture (Linux, optional)
+// -----------------------------------------------------------------------
+
+class PerfCounters {
+public:
+    PerfCounters() {
+#if defined(__linux__)
+        m_fd_cycles = open_counter(PERF_COUNT_HW_CPU_CYCLES);
+        m_fd_misses = open_counter(PERF_COUNT_HW_CACHE_MISSES);
+#endif
+    }
+
+    ~PerfCounters() {
+#if defined(__linux__)
+        if (m_fd_cycles >= 0)
+            close(m_fd_cycles);
+        if (m_fd_misses >= 0)
+            close(m_fd_misses);
+#endif
+    }
+
+    bool available() const { return m_fd_cycles >= 0; }
+
+    void start() {
+#if defined(__linux__)
+        reset_and_enable(m_fd_cycles);
+        reset_and_enable(m_fd_misses);
+#endif
+    }
+
+    /// Return the (cycle count, cache miss count) since \ref start()
+    std::pair<uint64_t, uint64_t> stop() {
+        uint64_t cycles = 0, misses = 0;
+#if defined(__linux__)
+        cycles = disable_and_read(m_fd_cycles);
+        misses = disable_and_read(m_fd_misses);
+#endif
+        return { cycles, misses };
+    }
+
+private:
+#if defined(__linux__)
+    static int open_counter(uint64_t config) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.type           = PERF_TYPE_HARDWARE;
+        attr.size           = sizeof(attr);
+        attr.config         = config;
+        attr.disabled       = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        return (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+
+    static void reset_and_enable(int fd) {
+        if (fd < 0)
+            return;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+
+    static uint64_t disable_and_read(int fd) {
+        if (fd < 0)
+            return 0;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        uint64_t value = 0;
+        if (read(fd, &value, sizeof(value)) != sizeof(value))
+            value = 0;
+        return value;
+    }
+#endif
+
+    int m_fd_cycles = -1;
+    int m_fd_misses = -1;
+};
+
+//! @}
+// -----------------------------------------------------------------------
+
+/// Accumulator that keeps the optimizer from discarding kernel results
+static volatile float sink;
+
+static size_t __duration_ms = 200;
+
+/**
+ * Run \c kernel repeatedly for the configured duration. The callable
+ * processes \c count elements per invocation; the report is normalized
+ * per element.
+ */
+template <typename Kernel>
+void run(const char *name, size_t count, PerfCounters &perf, Kernel &&kernel) {
+    // Warm up caches, branch predictors and the sink
+    kernel();
+
+    Timer timer;
+    perf.start();
+
+    size_t iterations = 0;
+    do {
+        kernel();
+        ++iterations;
+    } while (timer.value() < __duration_ms);
+
+    auto [cycles, misses] = perf.stop();
+    double elements = (double) count * (double) iterations,
+           ns       = (double) timer.value() * 1e6 / elements;
+
+    if (perf.available())
+        printf("  %-32s %10.3f ns %10.2f cyc %10.4f miss\n", name, ns,
+               (double) cycles / elements, (double) misses / elements);
+    else
+        printf("  %-32s %10.3f ns\n", name, ns);
+}
+
+int main(int argc, char *argv[]) {
+    Jit::static_initialization();
+    Class::static_initialization();
+    Thread::static_initialization();
+    Logger::static_initialization();
+
+    ArgParser parser;
+    using StringVec    = std::vector<std::string>;
+    auto arg_duration  = parser.add(StringVec{ "-d", "--duration" }, true);
+    auto arg_help      = parser.add(StringVec{ "-h", "--help" });
+
+    int exit_code = 0;
+
+    try {
+        parser.parse(argc, argv);
+
+        if (*arg_help) {
+            help();
+            return 0;
+        }
+
+        if (*arg_duration)
+            __duration_ms = (size_t) arg_duration->as_int();
+
+        constexpr size_t Count = 4096;
+
+        /* Deterministic inputs shared by all kernels. The benchmark streams
+           through these arrays so that input loads behave like they do in
+           the renderer (sequential), while the kernels' own table accesses
+           remain data-dependent. */
+        mitsuba::PCG32<uint32_t> rng;
+        std::unique_ptr<float[]>    u1(new float[Count]),
+                                    u2(new float[Count]);
+        std::unique_ptr<uint64_t[]> idx(new uint64_t[Count]);
+        for (size_t i = 0; i < Count; ++i) {
+            u1[i]  = rng.next_float32();
+            u2[i]  = rng.next_float32();
+            idx[i] = rng.next_uint32() & 0xffffff;
+        }
+
+        PerfCounters perf;
+        if (!perf.available())
+            Log(Warn, "Hardware performance counters are unavailable "
+                      "(perf_event_open failed) -- reporting wall-clock "
+                      "time only.");
+
+        printf("%-34s %13s %14s %15s\n", "kernel (per element)", "time",
+               "cycles", "cache misses");
+
+        /* ------------------------ Sample warping ----------------------- */
+
+        auto bench_warp = [&](auto tag, const char *suffix) {
+            using Value = decltype(tag);
+            constexpr size_t W = array_size_v<Value> == 0 ? 1 : array_size_v<Value>;
+
+            auto for_each = [&](auto &&f) {
+                float accum = 0.f;
+                for (size_t i = 0; i < Count; i += W) {
+                    Point2<Value> p(enoki::load_unaligned<Value>(u1.get() + i),
+                                    enoki::load_unaligned<Value>(u2.get() + i));
+                    accum += enoki::hsum(f(p));
+                }
+                sink = sink + accum;
+            };
+
+            char name[64];
+            auto named = [&](const char *kernel) -> const char * {
+                snprintf(name, sizeof(name), "%s (%s)", kernel, suffix);
+                return name;
+            };
+
+            run(named("warp::disk_concentric"), Count, perf, [&] {
+                for_each([](const auto &p) {
+                    return warp::square_to_uniform_disk_concentric(p).x();
+                });
+            });
+            run(named("warp::uniform_sphere"), Count, perf, [&] {
+                for_each([](const auto &p) {
+                    return warp::square_to_uniform_sphere(p).z();
+                });
+            });
+            run(named("warp::cosine_hemisphere"), Count, perf, [&] {
+                for_each([](const auto &p) {
+                    return warp::square_to_cosine_hemisphere(p).z();
+                });
+            });
+            run(named("warp::beckmann"), Count, perf, [&] {
+                for_each([](const auto &p) {
+                    return warp::square_to_beckmann(p, 0.1f).z();
+                });
+            });
+        };
+
+        bench_warp(FloatX(), "scalar");
+        bench_warp(FloatP(), "packet");
+
+        /* --------------------- 1D/2D distributions --------------------- */
+
+        {
+            constexpr size_t Res = 1024;
+            std::unique_ptr<float[]> density(new float[Res]);
+            for (size_t i = 0; i < Res; ++i)
+                density[i] = rng.next_float32() + .01f;
+
+            DiscreteDistribution<FloatX>   discrete(density.get(), Res);
+            DiscreteDistribution<FloatP>   discrete_p(density.get(), Res);
+            ContinuousDistribution<FloatX> continuous({ 0.f, 1.f }, density.get(), Res);
+            ContinuousDistribution<FloatP> continuous_p({ 0.f, 1.f }, density.get(), Res);
+
+            run("distr_1d::discrete (scalar)", Count, perf, [&] {
+                float accum = 0.f;
+                for (size_t i = 0; i < Count; ++i)
+                    accum += discrete.sample_pmf(u1[i]).second;
+                sink = sink + accum;
+            });
+            run("distr_1d::discrete (packet)", Count, perf, [&] {
+                float accum = 0.f;
+                for (size_t i = 0; i < Count; i += FloatP::Size)
+                    accum += enoki::hsum(
+                        discrete_p.sample_pmf(
+                            enoki::load_unaligned<FloatP>(u1.get() + i)).second);
+                sink = sink + accum;
+            });
+            run("distr_1d::continuous (scalar)", Count, perf, [&] {
+                float accum = 0.f;
+                for (size_t i = 0; i < Count; ++i)
+                    accum += continuous.sample(u1[i]);
+                sink = sink + accum;
+            });
+            run("distr_1d::continuous (packet)", Count, perf, [&] {
+                float accum = 0.f;
+                for (size_t i = 0; i < Count; i += FloatP::Size)
+                    accum += enoki::hsum(continuous_p.sample(
+                        enoki::load_unaligned<FloatP>(u1.get() + i)));
+                sink = sink + accum;
+            });
+        }
+
+        {
+            constexpr uint32_t Res = 64;
+            std::unique_ptr<float[]> density(new float[Res * Res]);
+            for (size_t i = 0; i < Res * Res; ++i)
+                density[i] = rng.next_float32() + .01f;
+
+            Marginal2D<FloatX, 0, true> marg(density.get(), { Res, Res });
+            Marginal2D<FloatP, 0, true> marg_p(density.get(), { Res, Res });
+
+            run("distr_2d::marginal (scalar)", Count, perf, [&] {
+                float accum = 0.f;
+                for (size_t i = 0; i < Count; ++i)
+                    accum += marg.sample(Point2<FloatX>(u1[i], u2[i])).second;
+                sink = sink + accum;
+            });
+            run("distr_2d::marginal (packet)", Count, perf, [&] {
+                float accum = 0.f;
+                for (size_t i = 0; i < Count; i += FloatP::Size)
+                    accum += enoki::hsum(marg_p.sample(Point2<FloatP>(
+                        enoki::load_unaligned<FloatP>(u1.get() + i),
+                        enoki::load_unaligned<FloatP>(u2.get() + i))).second);
+                sink = sink + accum;
+            });
+        }
+
+        /* -------------------------- Splines ---------------------------- */
+
+        {
+            constexpr uint32_t Res = 64;
+            std::unique_ptr<float[]> values(new float[Res]);
+            for (size_t i = 0; i < Res; ++i)
+                values[i] = rng.next_float32();
+
+            run("spline::eval_1d (scalar)", Count, perf, [&] {
+                float accum = 0.f;
+                for (size_t i = 0; i < Count; ++i)
+                    accum += spline::eval_1d(0.f, 1.f, values.get(), Res, u1[i]);
+                sink = sink + accum;
+            });
+            run("spline::eval_1d (packet)", Count, perf, [&] {
+                float accum = 0.f;
+                for (size_t i = 0; i < Count; i += FloatP::Size)
+                    accum += enoki::hsum(
+                        spline::eval_1d(0.f, 1.f, values.get(), Res,
+                                        enoki::load_unaligned<FloatP>(u1.get() + i)));
+                sink = sink + accum;
+            });
+        }
+
+        /* ---------------------- Radical inverse ------------------------ */
+
+        {
+            ref<RadicalInverse> ri = new RadicalInverse();
+
+            run("qmc::radical_inverse (scalar)", Count, perf, [&] {
+                float accum = 0.f;
+                for (size_t i = 0; i < Count; ++i)
+                    accum += ri->eval<FloatX>(i % 1024, (UInt64X) idx[i]);
+                sink = sink + accum;
+            });
+            run("qmc::radical_inverse (packet)", Count, perf, [&] {
+                float accum = 0.f;
+                for (size_t i = 0; i < Count; i += FloatP::Size)
+                    accum += enoki::hsum(ri->eval<FloatP>(
+                        i % 1024,
+                        enoki::load_unaligned<UInt64P>(idx.get() + i)));
+                sink = sink + accum;
+            });
+
+            constexpr size_t Dims = 16;
+            std::unique_ptr<float[]> out(new float[Count]);
+            run("qmc::radical_inverse (batched)", Count, perf, [&] {
+                ri->eval_n<FloatX>(0, Dims, idx.get(), Count / Dims, out.get());
+                float accum = 0.f;
+                for (size_t i = 0; i < Count; ++i)
+                    accum += out[i];
+                sink = sink + accum;
+            });
+        }
+
+        /* --------------------- Struct conversion ----------------------- */
+
+        {
+            ref<Struct> source = new Struct();
+            source->append("r", Struct::Type::UInt8)
+                   .append("g", Struct::Type::UInt8)
+                   .append("b", Struct::Type::UInt8);
+
+            ref<Struct> target = new Struct();
+            target->append("r", Struct::Type::Float32)
+                   .append("g", Struct::Type::Float32)
+                   .append("b", Struct::Type::Float32);
+
+            std::unique_ptr<uint8_t[]> src(new uint8_t[Count * 3]);
+            std::unique_ptr<float[]>   dst(new float[Count * 3]);
+            for (size_t i = 0; i < Count * 3; ++i)
+                src[i] = (uint8_t) (rng.next_uint32() & 0xff);
+
+            ref<StructConverter> conv = new StructConverter(source, target);
+
+            run("struct::u8_to_f32", Count, perf, [&] {
+                conv->convert(Count, src.get(), dst.get());
+                sink = sink + dst[0];
+            });
+        }
+    } catch (const std::exception &e) {
+        fprintf(stderr, "\nCaught a critical exception: %s\n", e.what());
+        exit_code = -1;
+    } catch (...) {
+        fprintf(stderr, "\nCaught a critical exception of unknown type!\n");
+        exit_code = -1;
+    }
+
+    Logger::static_shutdown();
+    Thread::static_shutdown();
+    Class::static_shutdown();
+    Jit::static_shutdown();
+    return exit_code;
+}
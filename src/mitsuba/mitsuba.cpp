@@ -6,7 +6,10 @@
 #include <mitsuba/core/jit.h>
 #include <mitsuba/core/logger.h>
 #include <mitsuba/core/profiler.h>
+#include <mitsuba/core/progress.h>
+#include <mitsuba/core/string.h>
 #include <mitsuba/core/thread.h>
+#include <mitsuba/core/timer.h>
 #include <mitsuba/core/util.h>
 #include <mitsuba/core/vector.h>
 #include <mitsuba/core/xml.h>
@@ -25,6 +28,7 @@ static void help(int thread_count) {
     std::cout << util::info_build(thread_count) << std::endl;
     std::cout << util::info_copyright() << std::endl;
     std::cout << util::info_features() << std::endl;
+    std::cout << util::info_host_features() << std::endl;
     std::cout << R"(
 Usage: mitsuba [options] <One or more scene XML files>
 
@@ -47,13 +51,34 @@ Options:
     -t <count>, --threads <count>
         Render with the specified number of threads.
 
+    --numa
+        Distribute and pin worker threads over the machine's NUMA nodes
+        and replicate read-only acceleration data structures per node.
+        (Linux only, no effect on single-socket machines)
+
+    --trace <filename>
+        Write the sampling profiler's timeline to the specified file in
+        the chrome://tracing JSON format.
+
+    --json-progress
+        Report progress as one JSON object per line on the standard
+        output instead of drawing an interactive progress bar. Intended
+        for job schedulers and other scripted consumers.
+
     -D <key>=<value>, --define <key>=<value>
         Define a constant that can referenced as "$key"
         within the scene description.
 
-    -s <index>, --sensor <index>
-        Index of the sensor to render with (following the declaration
-        order in the scene file). Default value: 0.
+    -s <indices>, --sensor <indices>
+        Comma-separated list of sensor indices to render (following the
+        declaration order in the scene file). All selected sensors are
+        rendered from a single scene load, sharing the acceleration data
+        structures and all textures. Default value: 0.
+
+    -a, --all-sensors
+        Render every sensor declared in the scene, as if their indices
+        had all been passed to --sensor. When more than one sensor is
+        rendered, output filenames receive a "_s<index>" suffix.
 
     -u, --update
         When specified, Mitsuba will update the scene's
@@ -61,6 +86,51 @@ Options:
 
     -o <filename>, --output <filename>
         Write the output image to the file "filename".
+
+    -c <filename>, --checkpoint <filename>
+        Periodically write a snapshot of the partially completed render
+        to the file "filename" (see also --resume). Overrides the
+        integrator's "checkpoint" parameter.
+
+    -r, --resume
+        Continue rendering from the checkpoint file if it exists, rather
+        than starting from scratch. The file is specified via --checkpoint
+        or the integrator's "checkpoint" parameter.
+
+    -i, --interactive
+        Keep the process resident and accept commands on the standard
+        input instead of exiting after one render. This avoids paying
+        the startup cost (initialization, plugin loading, thread pool
+        creation) and the scene loading cost for every frame of an
+        animation. Type "help" at the prompt for the list of commands.
+)";
+#if defined(MTS_ENABLE_DISTRIBUTED)
+    std::cout << R"(    -w <list>, --workers <list>
+        Distribute the rendering job across the given comma-separated
+        list of worker endpoints (e.g. "node17:7554,node18:7554"). The
+        workers must have been started with --serve and must be able to
+        resolve the scene file (e.g. via a shared file system).
+
+    --serve <address>
+        Run as a rendering worker: bind the given address (e.g.
+        "tcp://*:7554") and serve block rendering requests issued by a
+        coordinator until the process is interrupted.
+)";
+#endif
+}
+
+static void interactive_help() {
+    std::cout << R"(Available commands:
+
+    load <scene.xml>      Parse a scene file and keep it resident.
+    set <key>=<value>     Add or replace a scene constant (as with -D);
+                          takes effect at the next load/reload.
+    reload                Re-parse the current scene file with the
+                          updated constants.
+    render [filename]     Render the resident scene. The output defaults
+                          to the scene filename with an .exr extension.
+    help                  Display this help text.
+    quit                  Exit (end-of-input does the same).
 )";
 }
 
@@ -68,37 +138,107 @@ std::function<void(void)> develop_callback;
 std::mutex develop_callback_mutex;
 
 template <typename Float, typename Spectrum>
-bool render(Object *scene_, size_t sensor_i, filesystem::path filename) {
+bool render(Object *scene_, std::vector<size_t> sensor_indices,
+            filesystem::path filename, filesystem::path checkpoint,
+            bool resume, const std::vector<std::string> &workers,
+            const fs::path &scene_file, const xml::ParameterList &params,
+            const std::string &mode) {
     auto *scene = dynamic_cast<Scene<Float, Spectrum> *>(scene_);
     if (!scene)
         Throw("Root element of the input file must be a <scene> tag!");
-    if (sensor_i >= scene->sensors().size())
-        Throw("Specified sensor index is out of bounds!");
-    auto sensor = scene->sensors()[sensor_i];
-    auto film = sensor->film();
 
-    filename.replace_extension("exr");
-    film->set_destination_file(filename);
+    // Empty list (--all-sensors): render every sensor declared in the scene
+    if (sensor_indices.empty()) {
+        for (size_t i = 0; i < scene->sensors().size(); ++i)
+            sensor_indices.push_back(i);
+        if (sensor_indices.empty())
+            Throw("The scene does not declare any sensors!");
+    }
 
     auto integrator = scene->integrator();
     if (!integrator)
         Throw("No integrator specified for scene: %s", scene->to_string());
 
-    /* critical section */ {
-        std::lock_guard<std::mutex> guard(develop_callback_mutex);
-        develop_callback = [&]() { film->develop(); };
-    }
-    bool success = integrator->render(scene, sensor.get());
-    /* critical section */ {
-        std::lock_guard<std::mutex> guard(develop_callback_mutex);
-        develop_callback = nullptr;
+    bool batch = sensor_indices.size() > 1,
+         all_success = true;
+
+    /* All takes below render from the same resident scene, sharing the
+       acceleration data structure, textures and all other scene state;
+       each film is developed as soon as its take finishes. */
+    for (size_t sensor_i : sensor_indices) {
+        if (sensor_i >= scene->sensors().size())
+            Throw("Specified sensor index is out of bounds!");
+        auto sensor = scene->sensors()[sensor_i];
+        auto film = sensor->film();
+
+        /* Disambiguate the per-sensor outputs when rendering several takes
+           in one invocation */
+        fs::path out = filename, take_checkpoint = checkpoint;
+        out.replace_extension("");
+        if (batch)
+            out = fs::path(out.string() + tfm::format("_s%02i", sensor_i));
+        out.replace_extension("exr");
+        film->set_destination_file(out);
+
+        if (batch && !checkpoint.empty())
+            take_checkpoint = fs::path(checkpoint.string() +
+                                       tfm::format(".s%02i", sensor_i));
+
+        if (!take_checkpoint.empty() || resume) {
+            auto *si =
+                dynamic_cast<SamplingIntegrator<Float, Spectrum> *>(integrator);
+            if (si)
+                si->set_checkpoint(take_checkpoint, resume);
+            else
+                Log(Warn, "--checkpoint/--resume are only supported by "
+                          "sampling-based integrators, ignoring.");
+        }
+
+        /* critical section */ {
+            std::lock_guard<std::mutex> guard(develop_callback_mutex);
+            develop_callback = [film]() { film->develop(); };
+        }
+        bool success;
+        if (!workers.empty()) {
+#if defined(MTS_ENABLE_DISTRIBUTED)
+            auto *si =
+                dynamic_cast<SamplingIntegrator<Float, Spectrum> *>(integrator);
+            if (!si)
+                Throw("Distributed rendering requires a sampling-based "
+                      "integrator!");
+            success = si->render_distributed(scene, sensor.get(), workers,
+                                             scene_file.string(), params,
+                                             sensor_i, mode);
+#else
+            (void) scene_file; (void) params; (void) mode;
+            Throw("Mitsuba was compiled without distributed rendering support "
+                  "(MTS_ENABLE_DISTRIBUTED)!");
+#endif
+        } else {
+            success = integrator->render(scene, sensor.get());
+        }
+        /* critical section */ {
+            std::lock_guard<std::mutex> guard(develop_callback_mutex);
+            develop_callback = nullptr;
+        }
+        if (success)
+            film->develop();
+        else
+            Log(Warn, "\U0000274C Rendering failed, result not saved.");
+
+        all_success = all_success && success;
     }
-    if (success)
-        film->develop();
-    else
-        Log(Warn, "\U0000274C Rendering failed, result not saved.");
-    return success;
+
+    return all_success;
+}
+
+#if defined(MTS_ENABLE_DISTRIBUTED)
+template <typename Float, typename Spectrum>
+bool serve(const std::string &bind_address, const std::string &mode) {
+    SamplingIntegrator<Float, Spectrum>::serve_blocks(bind_address, mode);
+    return true;
 }
+#endif
 
 #if !defined(__WINDOWS__)
 // Handle the hang-up signal and write a partially rendered image to disk
@@ -128,8 +268,19 @@ int main(int argc, char *argv[]) {
     auto arg_verbose   = parser.add(StringVec{ "-v", "--verbose" }, false);
     auto arg_define    = parser.add(StringVec{ "-D", "--define" }, true);
     auto arg_sensor_i  = parser.add(StringVec{ "-s", "--sensor" }, true);
+    auto arg_all_sens  = parser.add(StringVec{ "-a", "--all-sensors" }, false);
     auto arg_output    = parser.add(StringVec{ "-o", "--output" }, true);
+    auto arg_checkpt   = parser.add(StringVec{ "-c", "--checkpoint" }, true);
+    auto arg_resume    = parser.add(StringVec{ "-r", "--resume" }, false);
     auto arg_update    = parser.add(StringVec{ "-u", "--update" }, false);
+    auto arg_interact  = parser.add(StringVec{ "-i", "--interactive" }, false);
+    auto arg_numa      = parser.add(StringVec{ "--numa" }, false);
+    auto arg_trace     = parser.add(StringVec{ "--trace" }, true);
+    auto arg_json_prog = parser.add(StringVec{ "--json-progress" }, false);
+#if defined(MTS_ENABLE_DISTRIBUTED)
+    auto arg_workers   = parser.add(StringVec{ "-w", "--workers" }, true);
+    auto arg_serve     = parser.add(StringVec{ "--serve" }, true);
+#endif
     auto arg_help      = parser.add(StringVec{ "-h", "--help" });
     auto arg_mode      = parser.add(StringVec{ "-m", "--mode" }, true);
     auto arg_extra     = parser.add("", true);
@@ -148,6 +299,10 @@ int main(int argc, char *argv[]) {
 #endif
 
     try {
+        /* Fail early (and with a clear message) when this build requires
+           instruction sets that the current machine does not provide */
+        util::check_host_features();
+
         // Parse all command line options
         parser.parse(argc, argv);
 
@@ -159,6 +314,9 @@ int main(int argc, char *argv[]) {
                 logger->set_log_level(Debug);
         }
 
+        if (*arg_json_prog)
+            ProgressReporter::set_machine_readable(true);
+
         while (arg_define && *arg_define) {
             std::string value = arg_define->as_string();
             auto sep = value.find('=');
@@ -172,13 +330,41 @@ int main(int argc, char *argv[]) {
         if (string::starts_with(mode, "gpu"))
             cie_alloc();
 
-        size_t sensor_i  = (*arg_sensor_i ? arg_sensor_i->as_int() : 0);
+        /* Sensors to render: an explicit comma-separated index list, every
+           sensor in the scene (--all-sensors, encoded as an empty list), or
+           sensor 0 by default */
+        std::vector<size_t> sensor_indices;
+        if (*arg_sensor_i) {
+            for (const std::string &token :
+                 string::tokenize(arg_sensor_i->as_string(), ","))
+                sensor_indices.push_back((size_t) std::stoul(token));
+        }
+        if (*arg_all_sens)
+            sensor_indices.clear();
+        else if (sensor_indices.empty())
+            sensor_indices.push_back(0);
+
+        fs::path checkpoint_file =
+            *arg_checkpt ? fs::path(arg_checkpt->as_string()) : fs::path();
+        bool resume = (bool) *arg_resume;
+
+        std::vector<std::string> workers;
+#if defined(MTS_ENABLE_DISTRIBUTED)
+        if (*arg_workers)
+            workers = string::tokenize(arg_workers->as_string(), ",");
+#endif
 
         // Initialize Intel Thread Building Blocks with the requested number of threads
         if (*arg_threads)
             __global_thread_count = arg_threads->as_int();
         if (__global_thread_count < 1)
             Throw("Thread count must be >= 1!");
+
+        /* Must be enabled before the scheduler spawns its workers so that
+           they pin themselves upon first entry */
+        if (*arg_numa)
+            Thread::set_numa_pinning(true);
+
         tbb::task_scheduler_init init((int) __global_thread_count);
 
         // Append the mitsuba directory to the FileResolver search path list
@@ -188,7 +374,13 @@ int main(int argc, char *argv[]) {
         if (!fr->contains(base_path))
             fr->append(base_path);
 
-        if (!*arg_extra || *arg_help) {
+#if defined(MTS_ENABLE_DISTRIBUTED)
+        bool serve_mode = (bool) *arg_serve;
+#else
+        bool serve_mode = false;
+#endif
+
+        if ((!*arg_extra && !*arg_interact && !serve_mode) || *arg_help) {
             help((int) __global_thread_count);
         } else {
             Log(Info, "%s", util::info_build((int) __global_thread_count));
@@ -201,8 +393,119 @@ int main(int argc, char *argv[]) {
 #endif
         }
 
-        while (arg_extra && *arg_extra) {
+#if defined(MTS_ENABLE_DISTRIBUTED)
+        if (serve_mode) {
+            /* Worker mode: serve block rendering requests issued by a
+               coordinator (--workers) until the process is interrupted */
+            MTS_INVOKE_VARIANT(mode, serve, arg_serve->as_string(), mode);
+        } else
+#endif
+        if (*arg_interact) {
+            /* Interactive mode: keep the process (and thus the plugin
+               registry, thread pool and most recently loaded scene)
+               resident, and accept commands on the standard input. This
+               avoids re-paying the per-process startup and scene loading
+               costs for every frame of an animation. */
+            ref<Object> scene;
+            fs::path scene_file, output_file;
+
+            auto load_scene = [&](const fs::path &file) {
+                ref<FileResolver> fr2 = new FileResolver(*fr);
+                thread->set_file_resolver(fr2);
+
+                // Add the scene file's directory to the search path.
+                fs::path scene_dir = file.parent_path();
+                if (!fr2->contains(scene_dir))
+                    fr2->append(scene_dir);
+
+                Timer timer;
+                scene = xml::load_file(file.string(), mode, params, *arg_update);
+                scene_file = file;
+                Log(Info, "Scene \"%s\" is now resident. (took %s)",
+                    file.string(), util::time_string(timer.value()));
+            };
+
+            if (*arg_extra)
+                load_scene(arg_extra->as_string());
+            if (*arg_output)
+                output_file = arg_output->as_string();
+
+            Log(Info, "Entering interactive mode -- type \"help\" for the "
+                      "list of commands.");
+
+            std::string line;
+            while (std::getline(std::cin, line)) {
+                line = string::trim(line);
+                if (line.empty())
+                    continue;
+
+                auto pos = line.find(' ');
+                std::string command = string::to_lower(line.substr(0, pos)),
+                            payload = pos == std::string::npos
+                                ? std::string()
+                                : string::trim(line.substr(pos + 1));
+
+                try {
+                    if (command == "quit" || command == "exit") {
+                        break;
+                    } else if (command == "help") {
+                        interactive_help();
+                    } else if (command == "load") {
+                        if (payload.empty())
+                            Throw("load: expected a scene filename!");
+                        load_scene(payload);
+                    } else if (command == "set") {
+                        auto sep = payload.find('=');
+                        if (sep == std::string::npos)
+                            Throw("set: expect key=value pair!");
+                        std::string key   = string::trim(payload.substr(0, sep)),
+                                    value = string::trim(payload.substr(sep + 1));
+                        bool found = false;
+                        for (auto &kv : params) {
+                            if (kv.first == key) {
+                                kv.second = value;
+                                found = true;
+                                break;
+                            }
+                        }
+                        if (!found)
+                            params.push_back(std::make_pair(key, value));
+                        Log(Info, "Set $%s = \"%s\" -- reload the scene for "
+                            "this to take effect.", key, value);
+                    } else if (command == "reload") {
+                        if (scene_file.empty())
+                            Throw("reload: no scene has been loaded yet!");
+                        load_scene(scene_file);
+                    } else if (command == "render") {
+                        if (!scene)
+                            Throw("render: no scene has been loaded yet!");
+                        fs::path filename =
+                            !payload.empty()
+                                ? fs::path(payload)
+                                : (!output_file.empty() ? output_file
+                                                        : scene_file);
+                        Timer timer;
+                        bool success = MTS_INVOKE_VARIANT(
+                            mode, render, scene.get(), sensor_indices,
+                            filename, checkpoint_file, resume, workers,
+                            scene_file, params, mode);
+                        print_profile = print_profile || success;
+                        if (success)
+                            Log(Info, "Frame finished. (took %s)",
+                                util::time_string(timer.value()));
+                    } else {
+                        Throw("Unknown command \"%s\" -- type \"help\" for "
+                              "the list of commands.", command);
+                    }
+                } catch (const std::exception &e) {
+                    Log(Warn, "%s", e.what());
+                }
+            }
+        }
+
+        while (!serve_mode && !*arg_interact && arg_extra && *arg_extra) {
             filesystem::path filename(arg_extra->as_string());
+            fs::path scene_file(arg_extra->as_string());
             ref<FileResolver> fr2 = new FileResolver(*fr);
             thread->set_file_resolver(fr2);
 
@@ -219,7 +522,10 @@ int main(int argc, char *argv[]) {
                 xml::load_file(arg_extra->as_string(), mode, params, *arg_update);
 
             bool success = MTS_INVOKE_VARIANT(mode, render, parsed.get(),
-                                              sensor_i, filename);
+                                              sensor_indices, filename,
+                                              checkpoint_file, resume,
+                                              workers, scene_file, params,
+                                              mode);
             print_profile = print_profile || success;
             arg_extra = arg_extra->next();
         }
@@ -259,6 +565,8 @@ int main(int argc, char *argv[]) {
     Profiler::static_shutdown();
     if (print_profile)
         Profiler::print_report();
+    if (*arg_trace)
+        Profiler::write_trace(arg_trace->as_string());
     Bitmap::static_shutdown();
     Logger::static_shutdown();
     Thread::static_shutdown();
@@ -135,7 +135,7 @@ int main(int argc, char *argv[]) {
                     MitsubaViewer::Tab *tab = viewer->append_tab(filename.filename().string());
 
                     group.run(
-                        [&env, fr, filename, tab, viewer]() {
+                        [&env, fr, filename, tab, viewer, params]() {
                             ScopedSetThreadEnvironment set_env(env);
 
                             // Add the scene file's directory to the search path.
@@ -146,7 +146,7 @@ int main(int argc, char *argv[]) {
 
                             Thread *thread = Thread::thread();
                             thread->set_file_resolver(fr2);
-                            ((MitsubaViewer *) viewer.get())->load(tab, fr2->resolve(filename));
+                            ((MitsubaViewer *) viewer.get())->load(tab, fr2->resolve(filename), params);
                         }
                     );
 
@@ -1,6 +1,10 @@
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/warp.h>
 #include <mitsuba/render/phase.h>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -45,12 +49,22 @@ public:
         if (m_g >= 1 || m_g <= -1)
             Log(Error, "The asymmetry parameter must lie in the interval (-1, 1)!");
 
+        update_constants();
+
+        if constexpr (!is_cuda_array_v<Float> && !is_diff_array_v<Float>) {
+            if (std::abs(m_g) >= math::Epsilon<ScalarFloat>)
+                m_inv_cdf = inv_cdf_table(m_g);
+        }
+
         m_flags = +PhaseFunctionFlags::Anisotropic;
     }
 
     MTS_INLINE Float eval_hg(Float cos_theta) const {
-        Float temp = 1.0f + m_g * m_g + 2.0f * m_g * cos_theta;
-        return math::InvFourPi<ScalarFloat> * (1 - m_g * m_g) / (temp * enoki::sqrt(temp));
+        /* The g-dependent numerator is hoisted into \c m_scale so that \ref
+           eval() and the density returned by \ref sample() only evaluate the
+           varying denominator */
+        Float temp = 1.f + m_g2 + 2.f * m_g * cos_theta;
+        return m_scale / (temp * enoki::sqrt(temp));
     }
 
     std::pair<Vector3f, Float> sample(const PhaseFunctionContext & /* ctx */,
@@ -61,9 +75,19 @@ public:
         Float cos_theta;
         if (std::abs(m_g) < math::Epsilon<ScalarFloat>) {
             cos_theta = 1 - 2 * sample.x();
+        } else if constexpr (!is_cuda_array_v<Float> && !is_diff_array_v<Float>) {
+            /* Invert the HG CDF by interpolating the precomputed table --
+               the table stores the exact inversion at the knots, so only the
+               interpolation within one of the 1024 cells is approximate */
+            Float pos = sample.x() * ScalarFloat(InvCDFSize - 1);
+            UInt32 idx = min(UInt32(pos), uint32_t(InvCDFSize - 2));
+            Float w1 = pos - Float(idx),
+                  v0 = gather<Float>(m_inv_cdf->data(), idx, active),
+                  v1 = gather<Float>(m_inv_cdf->data(), idx + 1u, active);
+            cos_theta = fmadd(w1, v1 - v0, v0);
         } else {
-            Float sqr_term = (1 - m_g * m_g) / (1 - m_g + 2 * m_g * sample.x());
-            cos_theta = (1 + m_g * m_g - sqr_term * sqr_term) / (2 * m_g);
+            Float sqr_term = (1 - m_g2) / (1 - m_g + 2 * m_g * sample.x());
+            cos_theta = (1 + m_g2 - sqr_term * sqr_term) / (2 * m_g);
         }
 
         Float sin_theta = enoki::safe_sqrt(1.0f - cos_theta * cos_theta);
@@ -84,6 +108,18 @@ public:
         callback->put_parameter("g", m_g);
     }
 
+    void parameters_changed() override {
+        if (m_g >= 1 || m_g <= -1)
+            Log(Error, "The asymmetry parameter must lie in the interval (-1, 1)!");
+
+        update_constants();
+
+        if constexpr (!is_cuda_array_v<Float> && !is_diff_array_v<Float>) {
+            m_inv_cdf = std::abs(m_g) >= math::Epsilon<ScalarFloat>
+                ? inv_cdf_table(m_g) : nullptr;
+        }
+    }
+
     std::string to_string() const override {
         std::ostringstream oss;
         oss << "HGPhaseFunction[" << std::endl
@@ -94,8 +130,51 @@ public:
 
     MTS_DECLARE_CLASS()
 private:
-    ScalarFloat m_g;
+    /// Resolution of the tabulated inverse CDF used by \ref sample()
+    static constexpr size_t InvCDFSize = 1024;
+
+    using InvCDFTable = std::vector<ScalarFloat>;
 
+    void update_constants() {
+        m_g2 = m_g * m_g;
+        m_scale = math::InvFourPi<ScalarFloat> * (1 - m_g2);
+    }
+
+    /**
+     * \brief Return the tabulated inverse CDF for the given asymmetry
+     * parameter
+     *
+     * Volumetric scenes commonly instantiate thousands of media that all use
+     * the same \c g, so the tables are shared through a process-wide cache
+     * and released once the last phase function referencing them is
+     * destroyed.
+     */
+    static std::shared_ptr<InvCDFTable> inv_cdf_table(ScalarFloat g) {
+        static std::mutex cache_mutex;
+        static std::unordered_map<ScalarFloat, std::weak_ptr<InvCDFTable>> cache;
+
+        std::lock_guard<std::mutex> guard(cache_mutex);
+        std::weak_ptr<InvCDFTable> &entry = cache[g];
+        std::shared_ptr<InvCDFTable> table = entry.lock();
+
+        if (!table) {
+            table = std::make_shared<InvCDFTable>(InvCDFSize);
+            double g_d = (double) g;
+            for (size_t i = 0; i < InvCDFSize; ++i) {
+                double xi = (double) i / (double) (InvCDFSize - 1),
+                       sqr_term = (1.0 - g_d * g_d) / (1.0 - g_d + 2.0 * g_d * xi),
+                       cos_theta = (1.0 + g_d * g_d - sqr_term * sqr_term) / (2.0 * g_d);
+                (*table)[i] = (ScalarFloat) cos_theta;
+            }
+            entry = table;
+        }
+
+        return table;
+    }
+
+    ScalarFloat m_g;
+    ScalarFloat m_g2, m_scale;
+    std::shared_ptr<InvCDFTable> m_inv_cdf;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(HGPhaseFunction, PhaseFunction)
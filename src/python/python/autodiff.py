@@ -3,10 +3,14 @@ from typing import Union, Tuple
 import enoki as ek
 
 
-def _render_helper(scene, spp=None, sensor_index=0):
+def _render_helper(scene, spp=None, sensor_index=0, seed=None):
     """
     Internally used function: render the specified Mitsuba scene and return a
-    floating point array containing RGB values and AOVs, if applicable
+    floating point array containing RGB values and AOVs, if applicable.
+
+    When ``seed`` is specified, the sampler is deterministically re-seeded
+    based on its value, so that a render can be reproduced exactly later on
+    (used by the checkpointed differentiation mode of ``render_torch()``).
     """
     from mitsuba.core import (Float, UInt32, UInt64, Vector2f,
                               is_monochromatic, is_rgb, is_polarized)
@@ -21,7 +25,10 @@ def _render_helper(scene, spp=None, sensor_index=0):
 
     total_sample_count = ek.hprod(film_size) * spp
 
-    if sampler.wavefront_size() != total_sample_count:
+    if seed is not None:
+        sampler.seed(ek.arange(UInt64, total_sample_count) +
+                     seed * total_sample_count)
+    elif sampler.wavefront_size() != total_sample_count:
         sampler.seed(ek.arange(UInt64, total_sample_count))
 
     pos = ek.arange(UInt32, total_sample_count)
@@ -194,6 +201,66 @@ def render(scene,
     return image
 
 
+def render_adjoint(scene, grad_image, spp=None, sensor_index=0):
+    """
+    Propagate the gradient image ``grad_image`` -- the derivative of an
+    objective with respect to the rendered image, linearized like the output
+    of :py:func:`render()` -- towards the differentiable scene parameters.
+
+    This drives the adjoint phase of a radiative-backpropagation style
+    integrator (see the ``rb`` plugin): no transcript of the forward
+    computation is required, hence the memory usage is independent of the
+    sample count. The scene's integrator must implement
+    ``sample_adjoint()``, and a box reconstruction filter is assumed.
+    Parameter gradients are accumulated in place and can be queried via
+    ``enoki.gradient()`` afterwards.
+    """
+    from mitsuba.core import (Float, UInt32, UInt64, Vector2f, Vector3f,
+                              is_monochromatic, is_rgb)
+
+    if not (is_monochromatic or is_rgb):
+        raise Exception('render_adjoint(): only the monochromatic and RGB '
+                        'variants are supported!')
+
+    sensor = scene.sensors()[sensor_index]
+    film = sensor.film()
+    sampler = sensor.sampler()
+    film_size = film.crop_size()
+    if spp is None:
+        spp = sampler.sample_count()
+
+    total_sample_count = ek.hprod(film_size) * spp
+
+    if sampler.wavefront_size() != total_sample_count:
+        sampler.seed(ek.arange(UInt64, total_sample_count))
+
+    pixel_index = ek.arange(UInt32, total_sample_count) // spp
+    scale = Vector2f(1.0 / film_size[0], 1.0 / film_size[1])
+    pos = Vector2f(Float(pixel_index % int(film_size[0])),
+                   Float(pixel_index // int(film_size[0])))
+
+    pos += sampler.next_2d()
+
+    rays, weights = sensor.sample_ray_differential(
+        time=0,
+        sample1=sampler.next_1d(),
+        sample2=pos * scale,
+        sample3=0
+    )
+
+    # Each camera sample contributes 1/spp of its pixel's value
+    grad_image = ek.detach(grad_image)
+    if is_monochromatic:
+        adjoint = ek.gather(grad_image, pixel_index) / spp
+    else:
+        adjoint = Vector3f(ek.gather(grad_image, pixel_index * 3),
+                           ek.gather(grad_image, pixel_index * 3 + 1),
+                           ek.gather(grad_image, pixel_index * 3 + 2)) / spp
+    adjoint *= weights
+
+    scene.integrator().sample_adjoint(scene, sampler, rays, adjoint)
+
+
 class Optimizer:
     """
     Base class of all gradient-based optimizers (currently SGD and Adam)
@@ -378,6 +445,20 @@ class Adam(Optimizer):
 
 
 def render_torch(scene, params=None, **kwargs):
+    """
+    Perform a differentiable rendering of the scene `scene` as a PyTorch
+    autograd operation, with scene parameters exposed via `params`.
+
+    In addition to the keyword arguments understood by :py:func:`render()`
+    (``spp``, ``unbiased``, ``sensor_index``), this function accepts a
+    ``passes`` argument: when ``passes=N > 1``, the sample budget is split
+    into ``N`` chunks that are rendered without recording an autodiff
+    transcript, and the adjoint pass re-renders and differentiates the
+    chunks one at a time (gradient checkpointing). This reduces peak device
+    memory by roughly a factor of ``N`` at the cost of one extra forward
+    rendering, and implies unbiased gradients since the primal and
+    derivative estimates never share a transcript.
+    """
     from mitsuba.core import Float
     # Delayed import of PyTorch dependency
     ns = globals()
@@ -396,6 +477,7 @@ def render_torch(scene, params=None, **kwargs):
                     spp = None
                     sensor_index = 0
                     unbiased = True
+                    passes = 1
 
                     ctx.inputs = [None, None]
                     for k, v in args.items():
@@ -405,11 +487,14 @@ def render_torch(scene, params=None, **kwargs):
                             sensor_index = v
                         elif k == 'unbiased':
                             unbiased = v
+                        elif k == 'passes':
+                            passes = v
                         elif params is not None:
                             params[k] = type(params[k])(v)
                             ctx.inputs.append(None)
                             ctx.inputs.append(params[k] if v.requires_grad
                                               else None)
+                            continue
 
                         ctx.inputs.append(None)
                         ctx.inputs.append(None)
@@ -421,9 +506,39 @@ def render_torch(scene, params=None, **kwargs):
                     if params is not None:
                         params.update()
 
-                        if unbiased:
-                            result = render(scene, spp=spp[0],
-                                            sensor_index=sensor_index).torch()
+                    if passes > 1:
+                        # Gradient checkpointing: the autodiff transcript of a
+                        # full render grows with the sample count and easily
+                        # exhausts device memory. Render the primal image in
+                        # detached per-pass chunks with known sampler seeds,
+                        # and defer all transcript recording to backward(),
+                        # which replays and differentiates the passes one at a
+                        # time so that only a single chunk is ever resident.
+                        spp_total = spp[1]
+                        if spp_total is None:
+                            spp_total = scene.sensors()[sensor_index] \
+                                .sampler().sample_count()
+                        spp_pass = max(1, spp_total // passes)
+
+                        for i in range(passes):
+                            image = _render_helper(
+                                scene, spp=spp_pass,
+                                sensor_index=sensor_index, seed=i).torch()
+                            result = image if result is None \
+                                else result + image
+                            ek.cuda_malloc_trim()
+                        result /= passes
+
+                        ctx.scene = scene
+                        ctx.spp_pass = spp_pass
+                        ctx.passes = passes
+                        ctx.sensor_index = sensor_index
+                        ctx.output = None
+                        return result
+
+                    if params is not None and unbiased:
+                        result = render(scene, spp=spp[0],
+                                        sensor_index=sensor_index).torch()
 
                     for v in ctx.inputs:
                         if v is not None:
@@ -445,8 +560,30 @@ def render_torch(scene, params=None, **kwargs):
             @staticmethod
             def backward(ctx, grad_output):
                 try:
-                    ek.set_gradient(ctx.output, ek.detach(Float(grad_output)))
-                    Float.backward()
+                    if getattr(ctx, 'passes', 1) > 1:
+                        # Checkpointed adjoint: re-render each pass with the
+                        # seed stored during forward() and backpropagate it
+                        # immediately. The image is the average of the passes,
+                        # hence each one receives 1/passes of the output
+                        # gradient; parameter gradients accumulate across the
+                        # per-pass backward() calls.
+                        for v in ctx.inputs:
+                            if v is not None:
+                                ek.set_requires_gradient(v)
+
+                        grad_weight = ek.detach(Float(grad_output)) / ctx.passes
+                        for i in range(ctx.passes):
+                            output = _render_helper(
+                                ctx.scene, spp=ctx.spp_pass,
+                                sensor_index=ctx.sensor_index, seed=i)
+                            ek.set_gradient(output, grad_weight)
+                            Float.backward()
+                            del output
+                            ek.cuda_malloc_trim()
+                    else:
+                        ek.set_gradient(ctx.output,
+                                        ek.detach(Float(grad_output)))
+                        Float.backward()
                     result = tuple(ek.gradient(i).torch() if i is not None
                                    else None
                                    for i in ctx.inputs)
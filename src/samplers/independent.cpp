@@ -17,6 +17,12 @@ Independent sampler (:monosp:`independent`)
  * - sample_count
    - |int|
    - Number of samples per pixel (Default: 4)
+ * - counter_based
+   - |bool|
+   - Draw numbers by hashing a (seed, lane, counter) triple instead of
+     advancing PCG32 state. This makes :monosp:`seed()` free, which pays off
+     when blocks are re-seeded frequently (adaptive refinement or
+     checkpoint/resume passes). (Default: false)
 
 The independent sampler produces a stream of independent and uniformly
 distributed pseudorandom numbers. Internally, it relies on the
@@ -40,7 +46,18 @@ public:
 
     using PCG32 = mitsuba::PCG32<UInt32>;
 
+    /**
+     * PCG32 state padded out to its own set of cache lines: the per-thread
+     * sampler clones otherwise end up in adjacent heap allocations whose
+     * frequently mutated state falsely shares a line across threads.
+     */
+    struct alignas(64) AlignedPCG32 : PCG32 {
+        using PCG32::PCG32;
+    };
+
     IndependentSampler(const Properties &props = Properties()) : Base(props) {
+        m_counter_based = props.bool_("counter_based", false);
+
         /* Can't seed yet on the GPU because we don't know yet
            how many entries will be needed. */
         if (!is_dynamic_array_v<Float>)
@@ -49,14 +66,24 @@ public:
 
     ref<Base> clone() override {
         IndependentSampler *sampler = new IndependentSampler();
-        sampler->m_sample_count = m_sample_count;
+        sampler->m_sample_count  = m_sample_count;
+        sampler->m_counter_based = m_counter_based;
         return sampler;
     }
 
     /// Seeds the RNG with the specified size, if applicable
     void seed(UInt64 seed_value) override {
+        if (m_counter_based) {
+            /* Counter-based mode: the RNG "state" is the seed itself, hence
+               re-seeding (e.g. when a block is restarted for an adaptive or
+               resumed pass) costs nothing */
+            m_seed    = seed_value;
+            m_counter = 0;
+            return;
+        }
+
         if (!m_rng)
-            m_rng = std::make_unique<PCG32>();
+            m_rng = std::make_unique<AlignedPCG32>();
 
         if constexpr (is_dynamic_array_v<Float>) {
             UInt64 idx = arange<UInt64>(seed_value.size());
@@ -68,6 +95,23 @@ public:
     }
 
     Float next_1d(Mask active = true) override {
+        if (m_counter_based) {
+            ENOKI_MARK_USED(active);
+            /* Stateless draw: hash the (seed, lane, counter) triple. Each
+               lane uses a distinct stream, mirroring the per-lane sequence
+               numbers of the PCG32 mode. */
+            UInt32 v0;
+            if constexpr (is_dynamic_array_v<Float>)
+                v0 = UInt32(m_seed); // the wavefront seed already varies per lane
+            else
+                v0 = UInt32(m_seed) + arange<UInt32>();
+            UInt32 v1 = UInt32(sr<32>(m_seed)) ^ UInt32(m_counter++);
+            if constexpr (is_double_v<ScalarFloat>)
+                return sample_tea_float64(v0, v1);
+            else
+                return sample_tea_float32(v0, v1);
+        }
+
         if constexpr (is_dynamic_array_v<Float>) {
             if (m_rng == nullptr)
                 Throw("Sampler::seed() must be invoked before using this sampler!");
@@ -89,6 +133,8 @@ public:
 
     /// Return the size of the wavefront (or 0, if not seeded)
     size_t wavefront_size() const override {
+        if (m_counter_based)
+            return enoki::slices(m_seed);
         if (m_rng == nullptr)
             return 0;
         else
@@ -98,14 +144,18 @@ public:
     std::string to_string() const override {
         std::ostringstream oss;
         oss << "IndependentSampler[" << std::endl
-            << "  sample_count = " << m_sample_count << std::endl
+            << "  sample_count = " << m_sample_count << "," << std::endl
+            << "  counter_based = " << m_counter_based << std::endl
             << "]";
         return oss.str();
     }
 
     MTS_DECLARE_CLASS()
 protected:
-    std::unique_ptr<PCG32> m_rng;
+    std::unique_ptr<AlignedPCG32> m_rng;
+    bool m_counter_based;
+    UInt64 m_seed = 0;
+    uint32_t m_counter = 0;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(IndependentSampler, Sampler)
@@ -0,0 +1,227 @@
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/random.h>
+#include <mitsuba/core/spectrum.h>
+#include <mitsuba/render/sampler.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _sampler-sobol:
+
+Sobol' sampler (:monosp:`sobol`)
+--------------------------------
+
+.. pluginparameters::
+
+ * - sample_count
+   - |int|
+   - Number of samples per pixel. Rounded up to the next power of two
+     to preserve the stratification of the underlying sequence. (Default: 4)
+
+This plugin generates stratified samples based on the first two dimensions of
+the Sobol' sequence, which jointly form a (0, 2)-sequence in base 2: every
+prefix of :math:`2^m` samples covers all base-2 elementary intervals of the
+pixel's sample domain exactly once. Successive dimension requests are served
+from freshly scrambled copies of this 2D pair, with the sample index shuffled
+per pair so that the pairs are mutually decorrelated.
+
+Neighboring pixels are decorrelated using the blue-noise dithering approach of
+Georgiev and Fajardo, "Blue-noise dithered sampling" (2016): all pixels share
+one globally scrambled sequence, and each pixel applies a toroidal shift drawn
+from a tileable 256x256 blue-noise dither matrix. The residual estimation
+error then inherits the high-frequency spectrum of the matrix, which is
+considerably less objectionable to the eye than the white noise produced by
+independent per-pixel scrambling at equal sample counts. In the wavefront
+GPU variants, where no per-pixel state is available, the sampler falls back
+to a per-pixel XOR scramble.
+
+Compared to the :ref:`independent sampler <sampler-independent>`, the
+stratification substantially reduces variance for direct illumination and
+other low-dimensional integrands at equal sample counts. All computations are
+carried out with bitwise arithmetic on the sample index and therefore
+vectorize across SIMD lanes without serialization in the packet variants.
+
+ */
+
+/// First dimension of the Sobol' (0, 2)-sequence (van der Corput, bit reversal)
+template <typename UInt32> UInt32 sobol_02_first(UInt32 v) {
+    v = (v << 16) | (v >> 16);
+    v = ((v & 0x00ff00ffu) << 8) | ((v & 0xff00ff00u) >> 8);
+    v = ((v & 0x0f0f0f0fu) << 4) | ((v & 0xf0f0f0f0u) >> 4);
+    v = ((v & 0x33333333u) << 2) | ((v & 0xccccccccu) >> 2);
+    v = ((v & 0x55555555u) << 1) | ((v & 0xaaaaaaaau) >> 1);
+    return v;
+}
+
+/// Second dimension of the Sobol' (0, 2)-sequence
+template <typename UInt32> UInt32 sobol_02_second(UInt32 index) {
+    UInt32 result = zero<UInt32>();
+    uint32_t v = 1u << 31;
+    for (uint32_t i = 0; i < 32; ++i) {
+        result ^= select(neq(index & (1u << i), 0u), UInt32(v), UInt32(0));
+        v ^= v >> 1;
+    }
+    return result;
+}
+
+template <typename Float, typename Spectrum>
+class SobolSampler final : public Sampler<Float, Spectrum> {
+public:
+    MTS_IMPORT_BASE(Sampler, m_sample_count)
+    MTS_IMPORT_TYPES()
+
+    SobolSampler(const Properties &props = Properties()) : Base(props) {
+        uint32_t sample_count = math::round_to_power_of_two((uint32_t) m_sample_count);
+        if (sample_count != m_sample_count) {
+            Log(Warn, "Sample count should be a power of two, rounding up to %i",
+                sample_count);
+            m_sample_count = sample_count;
+        }
+        m_block_seed = 0;
+        m_counter = 0;
+        m_dimension = 0;
+        m_pixel_shift = 0.f;
+        m_have_pixel = false;
+    }
+
+    ref<Base> clone() override {
+        SobolSampler *sampler = new SobolSampler();
+        sampler->m_sample_count = m_sample_count;
+        return sampler;
+    }
+
+    void seed(UInt64 seed_value) override {
+        if constexpr (is_dynamic_array_v<Float>) {
+            // Each lane is an independent global pixel sample index
+            m_ids = UInt32(seed_value);
+        } else {
+            // The seed identifies the image block being rendered
+            m_block_seed = (uint32_t) seed_value;
+            ENOKI_MARK_USED(seed_value);
+        }
+        m_counter = 0;
+        m_dimension = 0;
+        m_have_pixel = false;
+    }
+
+    void set_pixel(const Point2u &pos) override {
+        if constexpr (!is_dynamic_array_v<Float>) {
+            /* Look up the pixel's blue-noise rank in the tileable dither
+               matrix (entries lie in [-0.5, 0.5)) and use it as a toroidal
+               shift in \ref eval() */
+            UInt32 index = (pos.y() & 255u) * 256u + (pos.x() & 255u);
+            m_pixel_shift =
+                Float(gather<float32_array_t<Float>>(dither_matrix256, index)) + .5f;
+            m_have_pixel = true;
+        } else {
+            ENOKI_MARK_USED(pos);
+        }
+    }
+
+    void advance() override {
+        m_counter++;
+        m_dimension = 0;
+    }
+
+    Float next_1d(Mask active = true) override {
+        ENOKI_MARK_USED(active);
+        return eval(m_dimension++);
+    }
+
+    Point2f next_2d(Mask active = true) override {
+        ENOKI_MARK_USED(active);
+        if (m_dimension & 1)
+            ++m_dimension; // Align to a fresh 2D pair
+        Float f1 = eval(m_dimension),
+              f2 = eval(m_dimension + 1);
+        m_dimension += 2;
+        return Point2f(f1, f2);
+    }
+
+    size_t wavefront_size() const override {
+        if constexpr (is_dynamic_array_v<Float>)
+            return slices(m_ids);
+        else
+            return array_size_v<Float>;
+    }
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "SobolSampler[" << std::endl
+            << "  sample_count = " << m_sample_count << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MTS_DECLARE_CLASS()
+protected:
+    /// Per-lane global sample indices and per-pixel scramble keys
+    MTS_INLINE std::pair<UInt32, UInt32> sample_state() const {
+        UInt32 ids;
+        if constexpr (is_dynamic_array_v<Float>)
+            ids = m_ids;
+        else
+            ids = UInt32(m_counter * (uint32_t) array_size_v<Float>) + arange<UInt32>();
+
+        uint32_t spp = (uint32_t) m_sample_count;
+        UInt32 pixel = ids / spp,
+               index = ids - pixel * spp,
+               key   = sample_tea_32(pixel, UInt32(m_block_seed));
+
+        return { index, key };
+    }
+
+    /// Evaluate one component of the scrambled (0, 2)-sequence
+    Float eval(uint32_t dim) const {
+        auto [index, key] = sample_state();
+        uint32_t pair = dim >> 1;
+
+        /* Decorrelate successive 2D pairs by shuffling the sample index
+           within the pixel (the XOR keeps the prefix net property intact) */
+        index ^= sample_tea_32(key, UInt32(pair)) &
+                 UInt32((uint32_t) m_sample_count - 1);
+
+        UInt32 result = (dim & 1) ? sobol_02_second(index)
+                                  : sobol_02_first(index);
+
+        Float value;
+        if (m_have_pixel) {
+            /* Blue-noise mode: all pixels evaluate the same globally
+               scrambled sequence and are decorrelated by a toroidal
+               Cranley-Patterson rotation drawn from the dither matrix, so
+               that the screen-space error inherits its blue-noise spectrum.
+               The block-dependent term decorrelates successive render passes
+               without disturbing the relative shifts between neighbors. */
+            result ^= sample_tea_32(0x51633e2du, (uint32_t) dim);
+            value = Float(result) * Float(2.3283064365386963e-10 /* 2^-32 */);
+            value += m_pixel_shift +
+                     Float(sample_tea_float32(m_block_seed, (uint32_t) dim));
+            value -= floor(value);
+        } else {
+            // Per-(pixel, dimension) XOR scramble
+            result ^= sample_tea_32(key ^ 0x51633e2du, UInt32(dim));
+            value = Float(result) * Float(2.3283064365386963e-10 /* 2^-32 */);
+        }
+
+        return min(value, math::OneMinusEpsilon<Float>);
+    }
+
+protected:
+    /// Per-lane global sample indices (dynamic/GPU modes only)
+    UInt32 m_ids;
+    /// Seed of the image block being rendered (scalar & packet modes)
+    uint32_t m_block_seed;
+    /// Number of \ref advance() calls since the last \ref seed()
+    uint32_t m_counter;
+    /// Current dimension of the current sample
+    uint32_t m_dimension;
+    /// Blue-noise toroidal shift of the current pixel (scalar & packet modes)
+    Float m_pixel_shift;
+    /// Was \ref set_pixel() invoked since the last \ref seed()?
+    bool m_have_pixel;
+};
+
+MTS_IMPLEMENT_CLASS_VARIANT(SobolSampler, Sampler)
+MTS_EXPORT_PLUGIN(SobolSampler, "Sobol' Sampler");
+NAMESPACE_END(mitsuba)
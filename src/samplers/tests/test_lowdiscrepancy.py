@@ -0,0 +1,79 @@
+import mitsuba
+import pytest
+import enoki as ek
+
+import numpy as np
+
+
+def make_sampler(plugin, sample_count=16):
+    from mitsuba.core.xml import load_string
+    s = load_string("""<sampler version="2.0.0" type="%s">
+            <integer name="sample_count" value="%d"/>
+        </sampler>""" % (plugin, sample_count))
+    assert s is not None
+    return s
+
+
+@pytest.mark.parametrize('plugin', ['sobol', 'pmj02'])
+def test01_construct(variant_scalar_rgb, plugin):
+    s = make_sampler(plugin, sample_count=16)
+    assert s.sample_count() == 16
+
+    # Non-power-of-two sample counts are rounded up
+    s = make_sampler(plugin, sample_count=12)
+    assert s.sample_count() == 16
+
+
+@pytest.mark.parametrize('plugin', ['sobol', 'pmj02'])
+def test02_range_and_determinism(variant_scalar_rgb, plugin):
+    s = make_sampler(plugin)
+    s.seed(0)
+    values = [s.next_1d() for _ in range(32)]
+    assert all(0.0 <= v < 1.0 for v in values)
+
+    s.seed(0)
+    assert values == [s.next_1d() for _ in range(32)]
+
+
+@pytest.mark.parametrize('plugin', ['sobol', 'pmj02'])
+def test03_stratification(variant_scalar_rgb, plugin):
+    """Each power-of-two prefix of the first 2D pair of a pixel must place
+    exactly one sample in every elementary stratum (the (0, 2)-net property)."""
+    n = 16
+    s = make_sampler(plugin, sample_count=n)
+    s.seed(0)
+
+    points = []
+    for _ in range(n):
+        points.append(s.next_2d())
+        s.advance()
+    points = np.array(points)
+
+    # 1D stratification of each component over n strata
+    for c in range(2):
+        occupied = np.floor(points[:, c] * n).astype(int)
+        assert set(occupied) == set(range(n)), \
+            "Component %d is not stratified: %s" % (c, occupied)
+
+    # 2D stratification over a sqrt(n) x sqrt(n) grid
+    m = int(np.sqrt(n))
+    cells = np.floor(points[:, 0] * m).astype(int) * m + \
+            np.floor(points[:, 1] * m).astype(int)
+    assert set(cells) == set(range(n))
+
+
+@pytest.mark.parametrize('plugin', ['sobol', 'pmj02'])
+def test04_pixel_decorrelation(variant_scalar_rgb, plugin):
+    """Consecutive pixels of a block must receive different sequences."""
+    spp = 4
+    s = make_sampler(plugin, sample_count=spp)
+    s.seed(0)
+
+    first_pixel = [s.next_1d()]
+    s.advance()
+    for _ in range(spp - 1):  # Skip the remaining samples of the pixel
+        s.next_1d()
+        s.advance()
+    second_pixel = [s.next_1d()]
+
+    assert first_pixel != second_pixel
@@ -88,6 +88,8 @@ public:
                     m_far_clip, m_focus_distance)
     MTS_IMPORT_TYPES()
 
+    using RayBatch = typename Base::RayBatch;
+
     // =============================================================
     //! @{ \name Constructors
     // =============================================================
@@ -148,6 +150,18 @@ public:
         m_image_rect.expand(ScalarPoint2f(pmax.x(), pmax.y()) / pmax.z());
         m_normalization = 1.f / m_image_rect.volume();
         m_needs_sample_3 = false;
+
+        /* Without keyframes, the camera-to-world transformation is a
+           constant: precompose it with the sample-to-camera mapping so that
+           ray generation needs a single matrix-vector product per sample. */
+        m_static = m_world_transform->size() <= 1;
+        if (m_static) {
+            ScalarTransform4f trafo = m_world_transform->eval(0.f);
+            m_sample_to_world = trafo * m_sample_to_camera;
+            m_static_origin   = trafo * ScalarPoint3f(0.f);
+            m_dx_world        = trafo * m_dx;
+            m_dy_world        = trafo * m_dy;
+        }
     }
 
     //! @}
@@ -168,6 +182,26 @@ public:
         ray.time = time;
         ray.wavelengths = wavelengths;
 
+        if (m_static) {
+            // Map the sample directly onto the near plane in world space
+            Point3f near_p = m_sample_to_world *
+                             Point3f(position_sample.x(), position_sample.y(), 0.f);
+
+            /* The unnormalized direction has camera-space z-coordinate
+               'near_clip', hence its norm determines the clip distances
+               along the normalized ray. */
+            Vector3f v = near_p - m_static_origin;
+            Float n = norm(v);
+
+            ray.o = m_static_origin;
+            ray.d = v / n;
+            ray.mint = n;
+            ray.maxt = n * (m_far_clip / m_near_clip);
+            ray.update();
+
+            return std::make_pair(ray, wav_weight);
+        }
+
         // Compute the sample position on the near plane (local camera space).
         Point3f near_p = m_sample_to_camera *
                          Point3f(position_sample.x(), position_sample.y(), 0.f);
@@ -179,7 +213,7 @@ public:
         ray.mint = m_near_clip * inv_z;
         ray.maxt = m_far_clip * inv_z;
 
-        auto trafo = m_world_transform->eval(ray.time, active);
+        auto trafo = m_world_transform->eval_coherent(ray.time, active);
         ray.o = trafo.translation();
         ray.d = trafo * d;
         ray.update();
@@ -197,6 +231,28 @@ public:
         ray.time = time;
         ray.wavelengths = wavelengths;
 
+        if (m_static) {
+            // Map the sample directly onto the near plane in world space
+            Point3f near_p = m_sample_to_world *
+                             Point3f(position_sample.x(), position_sample.y(), 0.f);
+
+            Vector3f v = near_p - m_static_origin;
+            Float n = norm(v);
+
+            ray.o = m_static_origin;
+            ray.d = v / n;
+            ray.mint = n;
+            ray.maxt = n * (m_far_clip / m_near_clip);
+            ray.update();
+
+            ray.o_x = ray.o_y = ray.o;
+            ray.d_x = normalize(v + m_dx_world);
+            ray.d_y = normalize(v + m_dy_world);
+            ray.has_differentials = true;
+
+            return std::make_pair(ray, wav_weight);
+        }
+
         // Compute the sample position on the near plane (local camera space).
         Point3f near_p = m_sample_to_camera *
                          Point3f(position_sample.x(), position_sample.y(), 0.f);
@@ -207,7 +263,7 @@ public:
         ray.mint = m_near_clip * inv_z;
         ray.maxt = m_far_clip * inv_z;
 
-        auto trafo = m_world_transform->eval(ray.time, active);
+        auto trafo = m_world_transform->eval_coherent(ray.time, active);
         ray.o = trafo.transform_affine(Point3f(0.f));
         ray.d = trafo * d;
         ray.update();
@@ -221,6 +277,133 @@ public:
         return std::make_pair(ray, wav_weight);
     }
 
+    void sample_ray_differential_batch(
+            const std::vector<Float> &time, const std::vector<Float> &sample1,
+            const std::vector<Point2f> &sample2, const std::vector<Point2f> &sample3,
+            RayBatch &batch, Mask active) const override {
+        if (!m_static) {
+            /* Animated cameras must re-evaluate the world transform per
+               sample -- there are no invariants left to hoist */
+            Base::sample_ray_differential_batch(time, sample1, sample2,
+                                                sample3, batch, active);
+            return;
+        }
+
+        MTS_MASKED_FUNCTION(ProfilerPhase::EndpointSampleRay, active);
+
+        size_t count = sample2.size();
+        batch.resize(count);
+
+        /* Hoist the loop-invariant parts of ray generation: the precomposed
+           sample-to-world mapping, the (shared) ray origin and the
+           differential basis on the near plane */
+        const ScalarTransform4f sample_to_world = m_sample_to_world;
+        const ScalarPoint3f     origin          = m_static_origin;
+        const ScalarVector3f    dx              = m_dx_world,
+                                dy              = m_dy_world;
+        const ScalarFloat       clip_scale      = m_far_clip / m_near_clip;
+
+        for (size_t i = 0; i < count; ++i) {
+            auto [wavelengths, wav_weight] =
+                sample_wavelength<Float, Spectrum>(sample1[i]);
+
+            RayDifferential3f ray;
+            ray.time = time[i];
+            ray.wavelengths = wavelengths;
+
+            // Map the sample directly onto the near plane in world space
+            Point3f near_p = sample_to_world *
+                             Point3f(sample2[i].x(), sample2[i].y(), 0.f);
+
+            Vector3f v = near_p - origin;
+            Float n = norm(v);
+
+            ray.o = origin;
+            ray.d = v / n;
+            ray.mint = n;
+            ray.maxt = n * clip_scale;
+            ray.update();
+
+            ray.o_x = ray.o_y = ray.o;
+            ray.d_x = normalize(v + dx);
+            ray.d_y = normalize(v + dy);
+            ray.has_differentials = true;
+
+            batch.set(i, ray, wav_weight);
+        }
+    }
+
+    std::pair<DirectionSample3f, Spectrum>
+    sample_direction(const Interaction3f &it, const Point2f & /*sample*/,
+                     Mask active) const override {
+        MTS_MASKED_FUNCTION(ProfilerPhase::EndpointSampleDirection, active);
+
+        auto trafo = m_world_transform->eval(it.time, active);
+
+        /* Transform the reference point into the local coordinate system
+           and check that it lies within the clip range */
+        Point3f ref_p = trafo.inverse().transform_affine(it.p);
+        active &= ref_p.z() >= m_near_clip && ref_p.z() <= m_far_clip;
+
+        // Project onto the film and check that the point is visible
+        Point3f screen = m_camera_to_sample * ref_p;
+        Point2f uv(screen.x(), screen.y());
+        active &= uv.x() >= 0.f && uv.x() <= 1.f &&
+                  uv.y() >= 0.f && uv.y() <= 1.f;
+
+        Vector3f local_d(ref_p);
+        Float dist     = norm(local_d),
+              inv_dist = rcp(dist);
+        local_d *= inv_dist;
+
+        /* The aperture of an ideal pinhole camera is a point: the sample is
+           deterministic and its (discrete) probability equals one */
+        DirectionSample3f ds = zero<DirectionSample3f>();
+        ds.uv    = uv * ScalarVector2f(m_film->crop_size()) +
+                   ScalarPoint2f(m_film->crop_offset());
+        ds.p     = trafo.transform_affine(Point3f(0.f));
+        ds.d     = (ds.p - it.p) * inv_dist;
+        ds.dist  = dist;
+        ds.n     = trafo * Vector3f(0.f, 0.f, 1.f);
+        ds.time  = it.time;
+        ds.pdf   = select(active, Float(1.f), Float(0.f));
+        ds.delta = true;
+
+        /* Directional importance of an ideal pinhole camera:
+           1 / (A * cos^3 theta), where A is the area of the image rectangle
+           on the z=1 plane; the square of the reciprocal distance converts
+           it into the area measure at the reference point */
+        Float ct     = local_d.z(),
+              inv_ct = rcp(ct),
+              value  = m_normalization * inv_ct * sqr(inv_ct * inv_dist);
+
+        return { ds, select(active, Spectrum(value), Spectrum(0.f)) };
+    }
+
+    std::pair<Float, Float> pdf_ray(const Ray3f &ray, const Vector3f & /*n*/,
+                                    Mask active) const override {
+        MTS_MASKED_FUNCTION(ProfilerPhase::EndpointEvaluate, active);
+
+        auto trafo = m_world_transform->eval(ray.time, active);
+        Vector3f local_d = trafo.inverse() * ray.d;
+
+        Float ct     = local_d.z(),
+              inv_ct = rcp(ct);
+        active &= ct > 0.f;
+
+        // Check that the direction points through the image rectangle
+        Point2f p = Point2f(local_d.x(), local_d.y()) * inv_ct;
+        active &= m_image_rect.contains(p);
+
+        /* The pixel position was sampled uniformly over the image rectangle
+           on the z=1 plane, whose differential area subtends a solid angle
+           of cos^3 theta at the aperture */
+        Float dir_pdf = m_normalization * inv_ct * sqr(inv_ct);
+
+        return { select(active, Float(1.f), Float(0.f)),
+                 select(active, dir_pdf, Float(0.f)) };
+    }
+
     ScalarBoundingBox3f bbox() const override {
         return m_world_transform->translation_bounds();
     }
@@ -272,6 +455,12 @@ private:
     ScalarFloat m_normalization;
     ScalarFloat m_x_fov;
     ScalarVector3f m_dx, m_dy;
+
+    /// Precomposed sample-to-world mapping (only valid when \c m_static is set)
+    bool m_static = false;
+    ScalarTransform4f m_sample_to_world;
+    ScalarPoint3f m_static_origin;
+    ScalarVector3f m_dx_world, m_dy_world;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(PerspectiveCamera, ProjectiveCamera)
@@ -201,7 +201,7 @@ public:
         ray.mint = m_near_clip * inv_z;
         ray.maxt = m_far_clip * inv_z;
 
-        auto trafo = m_world_transform->eval(ray.time, active);
+        auto trafo = m_world_transform->eval_coherent(ray.time, active);
         ray.o = trafo.transform_affine(aperture_p);
         ray.d = trafo * d;
         ray.update();
@@ -240,7 +240,7 @@ public:
         ray.mint = m_near_clip * inv_z;
         ray.maxt = m_far_clip * inv_z;
 
-        auto trafo = m_world_transform->eval(ray.time, active);
+        auto trafo = m_world_transform->eval_coherent(ray.time, active);
         ray.o = trafo.transform_affine(aperture_p);
         ray.d = trafo * d;
         ray.update();
@@ -0,0 +1,474 @@
+#include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/fwd.h>
+#include <mitsuba/core/math.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/transform.h>
+#include <mitsuba/core/util.h>
+#include <mitsuba/render/bsdf.h>
+#include <mitsuba/render/emitter.h>
+#include <mitsuba/render/fwd.h>
+#include <mitsuba/render/interaction.h>
+#include <mitsuba/render/shape.h>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#if defined(MTS_ENABLE_EMBREE)
+    #include <embree3/rtcore.h>
+#endif
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _shape-bsplinecurve:
+
+B-spline curve (:monosp:`bsplinecurve`)
+----------------------------------------------------
+
+.. pluginparameters::
+
+ * - filename
+   - |string|
+   - Filename of the curve file that should be loaded
+ * - radius
+   - |float|
+   - Default radius (in object-space units) used for control points whose
+     radius is not specified in the file (Default: 0.01)
+ * - to_world
+   - |transform|
+   - Specifies an optional linear object-to-world transformation. Note that
+     non-uniform scales are not permitted! (Default: none, i.e. object space
+     = world space)
+
+This shape plugin describes swept cubic B-spline curves, which are the
+natural representation for hair, fur, and grass. Compared to approximating
+each hair segment with tessellated cylinders, the curve representation
+stores just four floats per control point (position and radius) and is
+intersected directly, which reduces the memory footprint of dense fur
+assets by more than an order of magnitude.
+
+The input file is a plain text format with one control point per line
+given as ``x y z`` or ``x y z radius``; blank lines (or lines starting
+with ``#``) separate individual strands. Each strand must contain at least
+two control points. Phantom control points are added automatically at both
+ends so that the spline interpolates the first and last point of every
+strand.
+
+Each curve segment (four consecutive control points) acts as a separate
+primitive during acceleration structure construction, so strands are split
+up finely and culled efficiently. When Mitsuba is compiled with Embree
+support, the shape maps onto Embree's native round B-spline curve
+geometry; the builtin kd-tree uses a ray-centric ribbon intersector
+instead.
+
+A simple example for instantiating a curve shape:
+
+.. code-block:: xml
+
+    <shape type="bsplinecurve">
+        <string name="filename" value="fur.txt"/>
+        <float name="radius" value="0.005"/>
+    </shape>
+
+.. warning:: This plugin is currently not supported by the OptiX raytracing backend.
+
+ */
+
+template <typename Float, typename Spectrum>
+class BSplineCurve final : public Shape<Float, Spectrum> {
+public:
+    MTS_IMPORT_BASE(Shape, bsdf, emitter, is_emitter)
+    MTS_IMPORT_TYPES()
+
+    using typename Base::ScalarIndex;
+    using typename Base::ScalarSize;
+
+    /// Number of uniform samples used to linearize a segment in the kd-tree intersector
+    static constexpr int SegmentSamples = 8;
+
+    BSplineCurve(const Properties &props) : Base(props) {
+        auto fs = Thread::thread()->file_resolver();
+        fs::path file_path = fs->resolve(props.string("filename"));
+        m_name = file_path.filename().string();
+
+        ScalarFloat default_radius = props.float_("radius", 0.01f);
+
+        ScalarTransform4f to_world = props.transform("to_world", ScalarTransform4f());
+        ScalarFloat radius_scale = norm(to_world * ScalarVector3f(1.f, 0.f, 0.f));
+
+        Timer timer;
+        std::ifstream is(file_path.string());
+        if (is.fail())
+            Throw("Could not open \"%s\"!", file_path.string());
+
+        std::vector<ScalarPoint3f> strand_p;
+        std::vector<ScalarFloat> strand_r;
+        size_t strand_count = 0;
+
+        auto flush_strand = [&]() {
+            size_t n = strand_p.size();
+            if (n == 0)
+                return;
+            if (n < 2)
+                Throw("\"%s\": strand %i consists of a single control point!",
+                      m_name, strand_count);
+
+            /* Phantom control points obtained by reflecting the second
+               (resp. second-to-last) point make the cubic B-spline pass
+               through the strand endpoints with a natural tangent */
+            append_point(2.f * strand_p[0] - strand_p[1], strand_r[0]);
+            for (size_t i = 0; i < n; ++i)
+                append_point(strand_p[i], strand_r[i]);
+            append_point(2.f * strand_p[n - 1] - strand_p[n - 2],
+                         strand_r[n - 1]);
+
+            /* k control points define k - 3 cubic segments */
+            ScalarIndex first = (ScalarIndex) (m_px.size() - (n + 2));
+            for (size_t i = 0; i + 3 < n + 2; ++i)
+                m_seg_index.push_back(first + (ScalarIndex) i);
+
+            strand_p.clear();
+            strand_r.clear();
+            strand_count++;
+        };
+
+        std::string line;
+        while (std::getline(is, line)) {
+            if (line.empty() || line[0] == '#') {
+                flush_strand();
+                continue;
+            }
+            std::istringstream iss(line);
+            ScalarPoint3f p;
+            ScalarFloat r = default_radius;
+            if (!(iss >> p.x() >> p.y() >> p.z()))
+                Throw("\"%s\": unable to parse line \"%s\"!", m_name, line);
+            iss >> r;
+            strand_p.push_back(to_world.transform_affine(p));
+            strand_r.push_back(r * radius_scale);
+        }
+        flush_strand();
+
+        if (m_seg_index.empty())
+            Throw("\"%s\": file does not contain any curve segments!", m_name);
+
+        // Bounding box and (approximate) surface area of the swept curves
+        m_surface_area = 0.f;
+        for (ScalarIndex seg : m_seg_index) {
+            ScalarPoint3f p1 = control_point(seg + 1),
+                          p2 = control_point(seg + 2);
+            ScalarFloat mean_radius =
+                .5f * (m_radius[seg + 1] + m_radius[seg + 2]);
+            m_surface_area +=
+                2.f * math::Pi<ScalarFloat> * mean_radius * norm(p2 - p1);
+        }
+        for (size_t i = 0; i < m_px.size(); ++i) {
+            ScalarPoint3f p = control_point((ScalarIndex) i);
+            m_bbox.expand(p - ScalarVector3f(m_radius[i]));
+            m_bbox.expand(p + ScalarVector3f(m_radius[i]));
+        }
+
+        Log(Debug, "\"%s\": read %i strands, %i control points, %i segments (%s)",
+            m_name, strand_count, m_px.size(), m_seg_index.size(),
+            util::time_string(timer.value()));
+
+        if (is_emitter())
+            emitter()->set_shape(this);
+    }
+
+    // =============================================================
+    //! @{ \name Query routines
+    // =============================================================
+
+    ScalarBoundingBox3f bbox() const override { return m_bbox; }
+
+    ScalarBoundingBox3f bbox(ScalarIndex index) const override {
+        ScalarIndex first = m_seg_index[index];
+
+        /* The curve lies within the convex hull of its control points,
+           padded by the largest control point radius */
+        ScalarBoundingBox3f result;
+        ScalarFloat radius = 0.f;
+        for (ScalarIndex k = 0; k < 4; ++k) {
+            result.expand(control_point(first + k));
+            radius = std::max(radius, m_radius[first + k]);
+        }
+        result.min -= radius;
+        result.max += radius;
+        return result;
+    }
+
+    ScalarFloat surface_area() const override { return m_surface_area; }
+
+    ScalarSize primitive_count() const override {
+        return (ScalarSize) m_seg_index.size();
+    }
+
+    ScalarSize effective_primitive_count() const override {
+        return primitive_count();
+    }
+
+    //! @}
+    // =============================================================
+
+    // =============================================================
+    //! @{ \name Ray tracing routines
+    // =============================================================
+
+    std::pair<Mask, Float> ray_intersect(ScalarIndex prim_index, const Ray3f &ray,
+                                         Float *cache, Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+
+        ScalarIndex first = m_seg_index[prim_index];
+
+        /* Set up a ray-centric coordinate frame: rays become the z-axis,
+           and the intersection problem reduces to a 2D distance test
+           against the projected curve */
+        Float inv_norm_d = rsqrt(squared_norm(ray.d));
+        Vector3f dz = ray.d * inv_norm_d;
+        auto [dx, dy] = coordinate_system(dz);
+
+        /* Evaluate the spline at uniformly spaced parameter values and
+           project the samples into the ray-centric frame. The control
+           points are scalar; only the projection is lane-dependent. */
+        Float px[SegmentSamples + 1], py[SegmentSamples + 1],
+              pz[SegmentSamples + 1], pr[SegmentSamples + 1];
+        for (int j = 0; j <= SegmentSamples; ++j) {
+            auto [p, r] = eval_spline(first, j / (ScalarFloat) SegmentSamples);
+            Vector3f q = Vector3f(p) - ray.o;
+            px[j] = dot(q, dx);
+            py[j] = dot(q, dy);
+            pz[j] = dot(q, dz);
+            pr[j] = r;
+        }
+
+        /* Treat each linear piece as a capsule in the projected 2D frame
+           and keep the nearest hit */
+        Mask hit = false;
+        Float t = math::Infinity<Float>, u = 0.f;
+        for (int j = 0; j < SegmentSamples; ++j) {
+            Float ex = px[j + 1] - px[j],
+                  ey = py[j + 1] - py[j],
+                  len_2 = sqr(ex) + sqr(ey);
+
+            // Parameter of the 2D point closest to the ray (the origin)
+            Float s = clamp(-(px[j] * ex + py[j] * ey) / len_2, 0.f, 1.f);
+            masked(s, eq(len_2, 0.f)) = 0.f;
+
+            Float dist_2 = sqr(fmadd(ex, s, px[j])) + sqr(fmadd(ey, s, py[j])),
+                  radius = fmadd(pr[j + 1] - pr[j], s, pr[j]),
+                  t_cand = fmadd(pz[j + 1] - pz[j], s, pz[j]) * inv_norm_d;
+
+            Mask valid = active && dist_2 <= sqr(radius) &&
+                         t_cand >= ray.mint && t_cand <= ray.maxt &&
+                         t_cand < t;
+
+            masked(t, valid) = t_cand;
+            masked(u, valid) =
+                (j + s) * (1.f / (ScalarFloat) SegmentSamples);
+            hit |= valid;
+        }
+
+        if (cache)
+            masked(cache[0], hit) = u;
+
+        return { hit, t };
+    }
+
+    Mask ray_test(ScalarIndex prim_index, const Ray3f &ray,
+                  Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+        return ray_intersect(prim_index, ray, nullptr, active).first;
+    }
+
+    std::pair<Mask, Float> ray_intersect(const Ray3f &ray, Float *cache,
+                                         Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+
+        /* Correctness fallback that tests every segment -- acceleration
+           structures invoke the per-segment variant above instead */
+        Mask hit = false;
+        Float t = math::Infinity<Float>;
+        Ray3f ray_ = ray;
+        for (ScalarIndex i = 0; i < (ScalarIndex) m_seg_index.size(); ++i) {
+            auto [hit_i, t_i] = ray_intersect(i, ray_, cache, active);
+            masked(t, hit_i) = t_i;
+            masked(ray_.maxt, hit_i) = t_i;
+            hit |= hit_i;
+        }
+        return { hit, t };
+    }
+
+    Mask ray_test(const Ray3f &ray, Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+
+        Mask hit = false;
+        for (ScalarIndex i = 0; i < (ScalarIndex) m_seg_index.size(); ++i) {
+            hit |= ray_test(i, ray, active && !hit);
+            if (all(hit))
+                break;
+        }
+        return hit;
+    }
+
+    void fill_surface_interaction(const Ray3f &ray, const Float *cache,
+                                  SurfaceInteraction3f &si_out, Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+
+        SurfaceInteraction3f si(si_out);
+
+        /* Both the kd-tree and the Embree backend store the curve
+           parameter of the hit segment in the first cache entry and
+           identify the segment via si.prim_index */
+        UInt32 first = gather<UInt32>(m_seg_index.data(), si.prim_index, active);
+        Float u = cache[0];
+
+        Float w[4], dw[4];
+        eval_weights(u, w, dw);
+
+        Point3f c(0.f);
+        Vector3f dc_du(0.f);
+        Float radius = 0.f;
+        for (int k = 0; k < 4; ++k) {
+            Point3f p(gather<Float>(m_px.data(), first + k, active),
+                      gather<Float>(m_py.data(), first + k, active),
+                      gather<Float>(m_pz.data(), first + k, active));
+            Float r = gather<Float>(m_radius.data(), first + k, active);
+            c      += w[k] * p;
+            dc_du  += dw[k] * Vector3f(p);
+            radius += w[k] * r;
+        }
+
+        /* Ribbon shading frame: the normal is the ray direction
+           orthogonalized against the curve tangent, so the swept curve
+           always presents its full width to the ray */
+        Vector3f tangent = normalize(dc_du);
+        Vector3f n_unnorm = fnmadd(tangent, dot(ray.d, tangent), ray.d);
+        Float n_norm_2 = squared_norm(n_unnorm);
+        Normal3f n = select(
+            n_norm_2 > 0.f, Normal3f(-n_unnorm * rsqrt(n_norm_2)),
+            Normal3f(coordinate_system(tangent).first));
+
+        si.p = ray(si.t);
+        si.n = si.sh_frame.n = n;
+        si.dp_du = dc_du;
+        si.dp_dv = cross(Vector3f(n), tangent) * (2.f * radius);
+
+        // Offset across the ribbon, mapped to [0, 1]
+        Float v = dot(si.p - c, cross(Vector3f(n), tangent)) /
+                      (2.f * radius) + .5f;
+        si.uv = Point2f(u, clamp(v, 0.f, 1.f));
+        si.time = ray.time;
+
+        si_out[active] = si;
+    }
+
+    std::pair<Vector3f, Vector3f> normal_derivative(const SurfaceInteraction3f & /*si*/,
+                                                    bool /*shading_frame*/,
+                                                    Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+        return { Vector3f(0.f), Vector3f(0.f) };
+    }
+
+#if defined(MTS_ENABLE_EMBREE)
+    RTCGeometry embree_geometry(RTCDevice device) const override {
+        RTCGeometry geom =
+            rtcNewGeometry(device, RTC_GEOMETRY_TYPE_ROUND_BSPLINE_CURVE);
+
+        float *vertices = (float *) rtcSetNewGeometryBuffer(
+            geom, RTC_BUFFER_TYPE_VERTEX, 0, RTC_FORMAT_FLOAT4,
+            4 * sizeof(float), m_px.size());
+        for (size_t i = 0; i < m_px.size(); ++i) {
+            vertices[4 * i + 0] = (float) m_px[i];
+            vertices[4 * i + 1] = (float) m_py[i];
+            vertices[4 * i + 2] = (float) m_pz[i];
+            vertices[4 * i + 3] = (float) m_radius[i];
+        }
+
+        unsigned int *indices = (unsigned int *) rtcSetNewGeometryBuffer(
+            geom, RTC_BUFFER_TYPE_INDEX, 0, RTC_FORMAT_UINT,
+            sizeof(unsigned int), m_seg_index.size());
+        for (size_t i = 0; i < m_seg_index.size(); ++i)
+            indices[i] = (unsigned int) m_seg_index[i];
+
+        rtcCommitGeometry(geom);
+        return geom;
+    }
+#endif
+
+    //! @}
+    // =============================================================
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "BSplineCurve[" << std::endl
+            << "  name = \"" << m_name << "\"," << std::endl
+            << "  control_point_count = " << m_px.size() << "," << std::endl
+            << "  segment_count = " << m_seg_index.size() << "," << std::endl
+            << "  surface_area = " << m_surface_area << "," << std::endl
+            << "  bsdf = " << string::indent(bsdf()->to_string()) << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MTS_DECLARE_CLASS()
+private:
+    void append_point(const ScalarPoint3f &p, ScalarFloat r) {
+        m_px.push_back(p.x());
+        m_py.push_back(p.y());
+        m_pz.push_back(p.z());
+        m_radius.push_back(r);
+    }
+
+    ScalarPoint3f control_point(ScalarIndex index) const {
+        return ScalarPoint3f(m_px[index], m_py[index], m_pz[index]);
+    }
+
+    /// Cubic uniform B-spline basis functions and their derivatives
+    template <typename Value>
+    static MTS_INLINE void eval_weights(const Value &t, Value *w, Value *dw) {
+        Value t2 = sqr(t), t3 = t2 * t;
+        w[0] = (1.f / 6.f) * (1.f - 3.f * t + 3.f * t2 - t3);
+        w[1] = (1.f / 6.f) * (3.f * t3 - 6.f * t2 + 4.f);
+        w[2] = (1.f / 6.f) * (-3.f * t3 + 3.f * t2 + 3.f * t + 1.f);
+        w[3] = (1.f / 6.f) * t3;
+        if (dw) {
+            dw[0] = -.5f * sqr(1.f - t);
+            dw[1] = .5f * (3.f * t2 - 4.f * t);
+            dw[2] = .5f * (-3.f * t2 + 2.f * t + 1.f);
+            dw[3] = .5f * t2;
+        }
+    }
+
+    /// Evaluate position and radius of segment \c first at parameter \c t
+    std::pair<ScalarPoint3f, ScalarFloat>
+    eval_spline(ScalarIndex first, ScalarFloat t) const {
+        ScalarFloat w[4];
+        eval_weights(t, w, (ScalarFloat *) nullptr);
+
+        ScalarPoint3f p(0.f);
+        ScalarFloat r = 0.f;
+        for (int k = 0; k < 4; ++k) {
+            p += w[k] * control_point(first + k);
+            r += w[k] * m_radius[first + k];
+        }
+        return { p, r };
+    }
+
+private:
+    std::string m_name;
+    ScalarBoundingBox3f m_bbox;
+    ScalarFloat m_surface_area;
+
+    /// Control point data in SoA layout (enables gathers in packet modes)
+    std::vector<ScalarFloat> m_px, m_py, m_pz, m_radius;
+
+    /// Index of the first control point of each cubic segment
+    std::vector<ScalarIndex> m_seg_index;
+};
+
+MTS_IMPLEMENT_CLASS_VARIANT(BSplineCurve, Shape)
+MTS_EXPORT_PLUGIN(BSplineCurve, "B-spline curve intersection primitive");
+NAMESPACE_END(mitsuba)
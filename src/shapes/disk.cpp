@@ -11,6 +11,10 @@
 #include <mitsuba/render/interaction.h>
 #include <mitsuba/render/shape.h>
 
+#if defined(MTS_ENABLE_EMBREE)
+#  include <embree3/rtcore.h>
+#endif
+
 NAMESPACE_BEGIN(mitsuba)
 
 
@@ -61,7 +65,9 @@ The following XML snippet instantiates an example of a textured disk shape:
         </bsdf>
     </shape>
 
-.. warning:: This plugin is currently not supported by the Embree and OptiX raytracing backend.
+.. warning:: This plugin is currently not supported by the OptiX raytracing backend.
+   Elliptical disks (i.e. constructed with a non-uniform scale) additionally
+   remain unsupported by the Embree backend.
 
  */
 
@@ -96,6 +102,10 @@ public:
             Throw("The `to_world` transformation contains shear, which is not"
                   " supported by the Disk shape.");
 
+#if defined(MTS_ENABLE_EMBREE)
+        update_embree_data();
+#endif
+
         if (is_emitter())
             emitter()->set_shape(this);
     }
@@ -123,10 +133,14 @@ public:
 
         Point2f p = warp::square_to_uniform_disk_concentric(sample);
 
+        Float v = atan2(p.y(), p.x()) * math::InvTwoPi<Float>;
+        masked(v, v < 0.f) += 1.f;
+
         PositionSample3f ps;
         ps.p    = m_object_to_world.transform_affine(Point3f(p.x(), p.y(), 0.f));
         ps.n    = m_frame.n;
         ps.pdf  = m_inv_surface_area;
+        ps.uv   = Point2f(norm(p), v);
         ps.time = time;
         ps.delta = false;
 
@@ -138,6 +152,33 @@ public:
         return m_inv_surface_area;
     }
 
+    DirectionSample3f sample_direction(const Interaction3f &it, const Point2f &sample,
+                                       Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+
+        DirectionSample3f ds = sample_position(it.time, sample, active);
+        ds.d = ds.p - it.p;
+
+        Float dist_squared = squared_norm(ds.d);
+        ds.dist  = sqrt(dist_squared);
+        ds.d    /= ds.dist;
+
+        Float dp = abs_dot(ds.d, ds.n);
+        ds.pdf *= select(neq(dp, 0.f), dist_squared / dp, Float(0.f));
+
+        return ds;
+    }
+
+    Float pdf_direction(const Interaction3f & /*it*/, const DirectionSample3f &ds,
+                        Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+
+        Float dp = abs_dot(ds.d, ds.n);
+
+        return m_inv_surface_area *
+               select(neq(dp, 0.f), (ds.dist * ds.dist) / dp, 0.f);
+    }
+
     //! @}
     // =============================================================
 
@@ -145,7 +186,7 @@ public:
     //! @{ \name Ray tracing routines
     // =============================================================
 
-    std::pair<Mask, Float> ray_intersect(const Ray3f &ray_, Float *cache,
+    std::pair<Mask, Float> ray_intersect(const Ray3f &ray_, Float * /*cache*/,
                                          Mask active) const override {
         MTS_MASK_ARGUMENT(active);
 
@@ -158,11 +199,6 @@ public:
                         && t <= ray.maxt
                         && local.x()*local.x() + local.y()*local.y() <= 1;
 
-        if (cache) {
-            masked(cache[0], active) = local.x();
-            masked(cache[1], active) = local.y();
-        }
-
         return { active, t };
     }
 
@@ -179,20 +215,25 @@ public:
                       && local.x()*local.x() + local.y()*local.y() <= 1;
     }
 
-    void fill_surface_interaction(const Ray3f &ray, const Float *cache,
+    void fill_surface_interaction(const Ray3f &ray, const Float * /*cache*/,
                                   SurfaceInteraction3f &si_out, Mask active) const override {
         MTS_MASK_ARGUMENT(active);
 
         SurfaceInteraction3f si(si_out);
 
-        Float r = norm(Point2f(cache[0], cache[1])),
+        /* Recompute the local hit coordinates from the hit position -- the
+           various intersection backends do not report them in a common
+           format */
+        Point3f local = m_world_to_object.transform_affine(ray(si.t));
+
+        Float r = norm(Point2f(local.x(), local.y())),
               inv_r = rcp(r);
 
-        Float v = atan2(cache[1], cache[0]) * math::InvTwoPi<Float>;
+        Float v = atan2(local.y(), local.x()) * math::InvTwoPi<Float>;
         masked(v, v < 0.f) += 1.f;
 
-        Float cos_phi = select(neq(r, 0.f), cache[0] * inv_r, 1.f),
-              sin_phi = select(neq(r, 0.f), cache[1] * inv_r, 0.f);
+        Float cos_phi = select(neq(r, 0.f), local.x() * inv_r, 1.f),
+              sin_phi = select(neq(r, 0.f), local.y() * inv_r, 0.f);
 
         si.dp_du      = m_object_to_world * Vector3f( cos_phi, sin_phi, 0.f);
         si.dp_dv      = m_object_to_world * Vector3f(-sin_phi, cos_phi, 0.f);
@@ -212,6 +253,25 @@ public:
         return { Vector3f(0.f), Vector3f(0.f) };
     }
 
+#if defined(MTS_ENABLE_EMBREE)
+    RTCGeometry embree_geometry(RTCDevice device) const override {
+        // Elliptical disks cannot be expressed as an oriented disc primitive
+        if (m_du != m_dv)
+            return Base::embree_geometry(device);
+
+        RTCGeometry geom =
+            rtcNewGeometry(device, RTC_GEOMETRY_TYPE_ORIENTED_DISC_POINT);
+        rtcSetSharedGeometryBuffer(geom, RTC_BUFFER_TYPE_VERTEX, 0,
+                                   RTC_FORMAT_FLOAT4, m_embree_disc, 0,
+                                   4 * sizeof(float), 1);
+        rtcSetSharedGeometryBuffer(geom, RTC_BUFFER_TYPE_NORMAL, 0,
+                                   RTC_FORMAT_FLOAT3, m_embree_normal, 0,
+                                   3 * sizeof(float), 1);
+        rtcCommitGeometry(geom);
+        return geom;
+    }
+#endif
+
     ScalarSize primitive_count() const override { return 1; }
 
     ScalarSize effective_primitive_count() const override { return 1; }
@@ -229,6 +289,9 @@ public:
                             * ScalarTransform4f::scale(ScalarVector3f(m_du, m_dv, 1.f));
         m_world_to_object = m_object_to_world.inverse();
         m_inv_surface_area = 1.f / surface_area();
+#if defined(MTS_ENABLE_EMBREE)
+        update_embree_data();
+#endif
     }
 
     std::string to_string() const override {
@@ -245,11 +308,28 @@ public:
 
     MTS_DECLARE_CLASS()
 private:
+#if defined(MTS_ENABLE_EMBREE)
+    void update_embree_data() {
+        ScalarPoint3f center =
+            m_object_to_world.transform_affine(ScalarPoint3f(0.f, 0.f, 0.f));
+        for (int i = 0; i < 3; ++i) {
+            m_embree_disc[i]   = (float) center[i];
+            m_embree_normal[i] = (float) m_frame.n[i];
+        }
+        m_embree_disc[3] = (float) m_du;
+    }
+#endif
+
     ScalarTransform4f m_object_to_world;
     ScalarTransform4f m_world_to_object;
     ScalarFrame3f m_frame;
     ScalarFloat m_du, m_dv;
     ScalarFloat m_inv_surface_area;
+
+#if defined(MTS_ENABLE_EMBREE)
+    /// Disc data (center, radius and normal) shared with the Embree BVH
+    float m_embree_disc[4], m_embree_normal[4];
+#endif
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(Disk, Shape)
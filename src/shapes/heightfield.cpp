@@ -0,0 +1,608 @@
+#include <mitsuba/core/bitmap.h>
+#include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/fwd.h>
+#include <mitsuba/core/math.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/string.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/transform.h>
+#include <mitsuba/core/util.h>
+#include <mitsuba/render/bsdf.h>
+#include <mitsuba/render/emitter.h>
+#include <mitsuba/render/fwd.h>
+#include <mitsuba/render/interaction.h>
+#include <mitsuba/render/shape.h>
+#include <vector>
+
+#if defined(MTS_ENABLE_EMBREE)
+#  include <embree3/rtcore.h>
+#endif
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _shape-heightfield:
+
+Heightfield (:monosp:`heightfield`)
+-------------------------------------------------
+
+.. pluginparameters::
+
+ * - filename
+   - |string|
+   - Filename of the elevation bitmap to be loaded. The image is converted
+     to a single-channel floating point raster; pixel values become surface
+     elevations.
+ * - to_world
+   - |transform|
+   - Specifies a linear object-to-world transformation. (Default: none
+     (i.e. object space = world space))
+
+This shape plugin represents terrain and other displaced grids directly as
+an elevation raster instead of a triangle mesh. In the local coordinate
+system, the surface covers the XY-range :math:`[0,1]\times[0,1]`; a raster
+of :math:`W\times H` pixels defines a grid of
+:math:`(W-1)\times(H-1)` bilinear cells whose corner elevations are the
+pixel values. Since typical elevation data is normalized to :math:`[0,1]`,
+the :monosp:`to_world` parameter is also the natural place to set the
+horizontal extent and vertical relief of the terrain.
+
+Rays are intersected against the raster directly: a min-max mip pyramid
+over the cells is built at load time and traversed front to back, so entire
+regions of the terrain that the ray passes above or below are skipped
+without ever being expanded into triangles. Within a cell, the exact
+intersection with the bilinear interpolant is computed analytically, and
+normals are derived from the height raster at hit time. Compared to
+exporting the same terrain as a mesh, the memory footprint shrinks from
+gigabytes of triangles and acceleration data structures to the raster
+itself, and there is no tessellation or tree construction step at load
+time.
+
+The surface is parameterized by its local XY coordinates, i.e. a texture
+applied to the heightfield stretches across the entire grid.
+
+.. warning:: This plugin is currently not supported by the OptiX raytracing backend.
+
+ */
+
+template <typename Float, typename Spectrum>
+class Heightfield final : public Shape<Float, Spectrum> {
+public:
+    MTS_IMPORT_BASE(Shape, bsdf, emitter, is_emitter)
+    MTS_IMPORT_TYPES()
+
+    using typename Base::ScalarSize;
+
+    Heightfield(const Properties &props) : Base(props) {
+        if constexpr (is_cuda_array_v<Float>)
+            Throw("The heightfield shape is not supported in GPU modes!");
+
+        m_object_to_world = props.transform("to_world", ScalarTransform4f());
+        m_world_to_object = m_object_to_world.inverse();
+
+        FileResolver *fs = Thread::thread()->file_resolver();
+        fs::path file_path = fs->resolve(props.string("filename"));
+        m_name = file_path.filename().string();
+
+        Timer timer;
+        ref<Bitmap> bitmap = new Bitmap(file_path);
+        m_data = bitmap->convert(Bitmap::PixelFormat::Y,
+                                 Struct::Type::Float32, false);
+
+        if (m_data->size().x() < 2 || m_data->size().y() < 2)
+            Throw("\"%s\": heightfields require an elevation raster with at "
+                  "least 2x2 pixels!", m_name);
+
+        m_size  = ScalarVector2u(m_data->size());
+        m_cells = m_size - 1u;
+
+        build_pyramid();
+        compute_surface_area();
+
+        Log(Debug, "\"%s\": %ix%i heightfield, %i pyramid levels (%s in %s)",
+            m_name, m_size.x(), m_size.y(), (int) m_levels.size(),
+            util::mem_string(m_data->buffer_size() + pyramid_size()),
+            util::time_string(timer.value()));
+
+        if (is_emitter())
+            emitter()->set_shape(this);
+    }
+
+    ScalarBoundingBox3f bbox() const override {
+        const MinMaxLevel &root = m_levels.back();
+        ScalarBoundingBox3f bbox;
+        for (int i = 0; i < 8; ++i)
+            bbox.expand(m_object_to_world.transform_affine(ScalarPoint3f(
+                (i & 1) ? 1.f : 0.f, (i & 2) ? 1.f : 0.f,
+                (i & 4) ? root.data[0].max : root.data[0].min)));
+        return bbox;
+    }
+
+    ScalarFloat surface_area() const override { return m_surface_area; }
+
+    // =============================================================
+    //! @{ \name Ray tracing routines
+    // =============================================================
+
+    std::pair<Mask, Float> ray_intersect(const Ray3f &ray_, Float * /*cache*/,
+                                         Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+
+        if constexpr (is_cuda_array_v<Float>) {
+            return { Mask(false), Float(math::Infinity<Float>) };
+        } else {
+            Ray3f ray = m_world_to_object.transform_affine(ray_);
+
+            /* The pyramid traversal is irreducibly scalar control flow --
+               in packet modes, each lane performs its own descent */
+            Mask hit = false;
+            Float t = math::Infinity<Float>;
+            for (size_t i = 0; i < slices(ray.o); ++i) {
+                if (!slice(active, i))
+                    continue;
+
+                ScalarFloat t_i;
+                if (traverse_pyramid(slice(ray.o, i), slice(ray.d, i),
+                                     (ScalarFloat) slice(ray.mint, i),
+                                     (ScalarFloat) slice(ray.maxt, i), &t_i)) {
+                    slice(hit, i) = true;
+                    slice(t, i)   = t_i;
+                }
+            }
+
+            return { hit, t };
+        }
+    }
+
+    Mask ray_test(const Ray3f &ray_, Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+
+        if constexpr (is_cuda_array_v<Float>) {
+            return Mask(false);
+        } else {
+            Ray3f ray = m_world_to_object.transform_affine(ray_);
+
+            Mask hit = false;
+            for (size_t i = 0; i < slices(ray.o); ++i) {
+                if (!slice(active, i))
+                    continue;
+
+                if (traverse_pyramid(slice(ray.o, i), slice(ray.d, i),
+                                     (ScalarFloat) slice(ray.mint, i),
+                                     (ScalarFloat) slice(ray.maxt, i), nullptr))
+                    slice(hit, i) = true;
+            }
+
+            return hit;
+        }
+    }
+
+    void fill_surface_interaction(const Ray3f &ray, const Float * /*cache*/,
+                                  SurfaceInteraction3f &si_out, Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+
+        using Float32 = float32_array_t<Float>;
+
+        SurfaceInteraction3f si(si_out);
+
+        si.p = ray(si.t);
+        Point3f local = m_world_to_object.transform_affine(si.p);
+
+        /* Locate the cell underneath the hit point and gather its corner
+           elevations */
+        Float x = local.x() * (ScalarFloat) m_cells.x(),
+              y = local.y() * (ScalarFloat) m_cells.y();
+
+        UInt32 ix = min(UInt32(max(x, Float(0.f))), UInt32(m_cells.x() - 1)),
+               iy = min(UInt32(max(y, Float(0.f))), UInt32(m_cells.y() - 1));
+
+        const float *heights = (const float *) m_data->data();
+        UInt32 index = iy * m_size.x() + ix;
+
+        Float h00 = Float(gather<Float32>(heights, index, active)),
+              h10 = Float(gather<Float32>(heights, index + 1u, active)),
+              h01 = Float(gather<Float32>(heights, index + m_size.x(), active)),
+              h11 = Float(gather<Float32>(heights, index + m_size.x() + 1u, active));
+
+        Float b = h10 - h00, c = h01 - h00,
+              d = h11 - h10 - h01 + h00,
+              u = x - Float(ix), v = y - Float(iy);
+
+        /* Partial derivatives of the elevation w.r.t. the local XY (= uv)
+           parameterization of the bilinear interpolant */
+        Float dh_du = (b + d * v) * (ScalarFloat) m_cells.x(),
+              dh_dv = (c + d * u) * (ScalarFloat) m_cells.y();
+
+        si.dp_du = m_object_to_world * Vector3f(1.f, 0.f, dh_du);
+        si.dp_dv = m_object_to_world * Vector3f(0.f, 1.f, dh_dv);
+
+        si.n          = normalize(cross(si.dp_du, si.dp_dv));
+        si.sh_frame.n = si.n;
+        si.uv         = Point2f(local.x(), local.y());
+        si.time       = ray.time;
+
+        si_out[active] = si;
+    }
+
+    std::pair<Vector3f, Vector3f> normal_derivative(const SurfaceInteraction3f & /*si*/,
+                                                    bool /*shading_frame*/,
+                                                    Mask /*active*/) const override {
+        return { Vector3f(0.f), Vector3f(0.f) };
+    }
+
+#if defined(MTS_ENABLE_EMBREE)
+    RTCGeometry embree_geometry(RTCDevice device) const override {
+        RTCGeometry geom = rtcNewGeometry(device, RTC_GEOMETRY_TYPE_USER);
+        rtcSetGeometryUserPrimitiveCount(geom, 1);
+        rtcSetGeometryUserData(geom, (void *) this);
+        rtcSetGeometryBoundsFunction(geom, embree_bounds, nullptr);
+        rtcSetGeometryIntersectFunction(geom, embree_intersect);
+        rtcSetGeometryOccludedFunction(geom, embree_occluded);
+        rtcCommitGeometry(geom);
+        return geom;
+    }
+#endif
+
+    ScalarSize primitive_count() const override { return 1; }
+
+    ScalarSize effective_primitive_count() const override { return 1; }
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "Heightfield[" << std::endl
+            << "  name = \"" << m_name << "\"," << std::endl
+            << "  size = " << m_size << "," << std::endl
+            << "  levels = " << m_levels.size() << "," << std::endl
+            << "  object_to_world = " << string::indent(m_object_to_world) << "," << std::endl
+            << "  surface_area = " << m_surface_area << "," << std::endl
+            << "  bsdf = " << string::indent(bsdf()->to_string()) << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    //! @}
+    // =============================================================
+
+    MTS_DECLARE_CLASS()
+private:
+    /// One level of the min-max mip pyramid over the cell grid
+    struct MinMaxEntry { float min, max; };
+    struct MinMaxLevel {
+        uint32_t width, height;
+        std::vector<MinMaxEntry> data;
+    };
+
+    MTS_INLINE float height(uint32_t ix, uint32_t iy) const {
+        return ((const float *) m_data->data())[iy * m_size.x() + ix];
+    }
+
+    /**
+     * \brief Build the min-max mip pyramid over the cell grid
+     *
+     * Level zero stores the elevation range of each bilinear cell; every
+     * further level halves the resolution (rounding up) and takes the
+     * range over up to four children, so a node conservatively bounds all
+     * cells underneath it.
+     */
+    void build_pyramid() {
+        MinMaxLevel level;
+        level.width  = m_cells.x();
+        level.height = m_cells.y();
+        level.data.resize((size_t) level.width * level.height);
+
+        for (uint32_t y = 0; y < level.height; ++y) {
+            for (uint32_t x = 0; x < level.width; ++x) {
+                float h00 = height(x, y),     h10 = height(x + 1, y),
+                      h01 = height(x, y + 1), h11 = height(x + 1, y + 1);
+                MinMaxEntry &e = level.data[(size_t) y * level.width + x];
+                e.min = std::min(std::min(h00, h10), std::min(h01, h11));
+                e.max = std::max(std::max(h00, h10), std::max(h01, h11));
+            }
+        }
+        m_levels.push_back(std::move(level));
+
+        while (m_levels.back().width > 1 || m_levels.back().height > 1) {
+            const MinMaxLevel &prev = m_levels.back();
+            MinMaxLevel next;
+            next.width  = (prev.width + 1) / 2;
+            next.height = (prev.height + 1) / 2;
+            next.data.resize((size_t) next.width * next.height);
+
+            for (uint32_t y = 0; y < next.height; ++y) {
+                for (uint32_t x = 0; x < next.width; ++x) {
+                    MinMaxEntry e { math::Infinity<float>, -math::Infinity<float> };
+                    for (uint32_t cy = 2 * y; cy < std::min(2 * y + 2, prev.height); ++cy) {
+                        for (uint32_t cx = 2 * x; cx < std::min(2 * x + 2, prev.width); ++cx) {
+                            const MinMaxEntry &c = prev.data[(size_t) cy * prev.width + cx];
+                            e.min = std::min(e.min, c.min);
+                            e.max = std::max(e.max, c.max);
+                        }
+                    }
+                    next.data[(size_t) y * next.width + x] = e;
+                }
+            }
+            m_levels.push_back(std::move(next));
+        }
+    }
+
+    size_t pyramid_size() const {
+        size_t size = 0;
+        for (const MinMaxLevel &level : m_levels)
+            size += level.data.size() * sizeof(MinMaxEntry);
+        return size;
+    }
+
+    /// Sum of the world-space areas of the two triangles of each cell
+    void compute_surface_area() {
+        double area = 0.0;
+        for (uint32_t y = 0; y < m_cells.y(); ++y) {
+            for (uint32_t x = 0; x < m_cells.x(); ++x) {
+                ScalarFloat x0 = x / (ScalarFloat) m_cells.x(),
+                            x1 = (x + 1) / (ScalarFloat) m_cells.x(),
+                            y0 = y / (ScalarFloat) m_cells.y(),
+                            y1 = (y + 1) / (ScalarFloat) m_cells.y();
+
+                ScalarPoint3f p00 = m_object_to_world.transform_affine(
+                                  ScalarPoint3f(x0, y0, height(x, y))),
+                              p10 = m_object_to_world.transform_affine(
+                                  ScalarPoint3f(x1, y0, height(x + 1, y))),
+                              p01 = m_object_to_world.transform_affine(
+                                  ScalarPoint3f(x0, y1, height(x, y + 1))),
+                              p11 = m_object_to_world.transform_affine(
+                                  ScalarPoint3f(x1, y1, height(x + 1, y + 1)));
+
+                area += .5 * (double) (norm(cross(p10 - p00, p01 - p00)) +
+                                       norm(cross(p10 - p11, p01 - p11)));
+            }
+        }
+        m_surface_area = (ScalarFloat) area;
+    }
+
+    /**
+     * \brief Exact intersection against the bilinear interpolant of one cell
+     *
+     * Along the ray, the height difference to the interpolant is a
+     * quadratic polynomial in <tt>t</tt>; its roots are tested against the
+     * current ray segment and the cell extents. On success, \c maxt is
+     * shrunk to the intersection distance.
+     */
+    MTS_INLINE bool intersect_cell(uint32_t ix, uint32_t iy,
+                                   const ScalarPoint3f &o, const ScalarVector3f &d,
+                                   ScalarFloat mint, ScalarFloat &maxt) const {
+        ScalarFloat h00 = height(ix, iy),     h10 = height(ix + 1, iy),
+                    h01 = height(ix, iy + 1), h11 = height(ix + 1, iy + 1);
+
+        // Ray expressed in cell-local coordinates u, v in [0, 1]
+        ScalarFloat u0 = o.x() * m_cells.x() - ix, du = d.x() * m_cells.x(),
+                    v0 = o.y() * m_cells.y() - iy, dv = d.y() * m_cells.y();
+
+        ScalarFloat b = h10 - h00, c = h01 - h00,
+                    k = h11 - h10 - h01 + h00;
+
+        ScalarFloat A = -k * du * dv,
+                    B = d.z() - b * du - c * dv - k * (u0 * dv + v0 * du),
+                    C = o.z() - (h00 + b * u0 + c * v0 + k * u0 * v0);
+
+        ScalarFloat t0, t1;
+        if (std::abs(A) < math::Epsilon<ScalarFloat>) {
+            // The interpolant degenerates to a plane along this ray
+            if (std::abs(B) < math::Epsilon<ScalarFloat>)
+                return false;
+            t0 = t1 = -C / B;
+        } else {
+            auto [valid, near_t, far_t] = math::solve_quadratic(A, B, C);
+            if (!valid)
+                return false;
+            t0 = near_t; t1 = far_t;
+        }
+
+        for (ScalarFloat t : { t0, t1 }) {
+            if (t < mint || t > maxt)
+                continue;
+            ScalarFloat u = u0 + t * du, v = v0 + t * dv;
+            const ScalarFloat eps = math::RayEpsilon<ScalarFloat>;
+            if (u < -eps || u > 1.f + eps || v < -eps || v > 1.f + eps)
+                continue;
+            maxt = t;
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * \brief Traverse the min-max pyramid along a ray given in the local
+     * coordinate system
+     *
+     * Nodes are visited front to back using an explicit stack; a node is
+     * expanded only if the ray segment passes through its elevation bounds,
+     * which prunes the terrain regions that the ray passes above or below.
+     * When \c t_out is \c nullptr (shadow rays), the traversal returns on
+     * the first intersected cell.
+     */
+    bool traverse_pyramid(ScalarPoint3f o, ScalarVector3f d,
+                          ScalarFloat mint, ScalarFloat maxt,
+                          ScalarFloat *t_out) const {
+        /* Nudge direction components away from zero so that the slab tests
+           below remain free of 0 * inf products */
+        for (int i = 0; i < 3; ++i) {
+            if (std::abs(d[i]) < math::Epsilon<ScalarFloat>)
+                d[i] = std::copysign(math::Epsilon<ScalarFloat>, d[i]);
+        }
+        ScalarVector3f d_rcp = rcp(d);
+
+        ScalarFloat inv_w = rcp((ScalarFloat) m_cells.x()),
+                    inv_h = rcp((ScalarFloat) m_cells.y());
+
+        struct StackEntry {
+            ScalarFloat t;
+            uint32_t level, x, y;
+        };
+        StackEntry stack[4 * 32];
+        int stack_size = 0;
+
+        /* Entry distance of the ray segment [mint, maxt] into the node
+           (level, x, y), or infinity if it is missed */
+        auto entry_distance = [&](uint32_t level, uint32_t x, uint32_t y) {
+            const MinMaxLevel &l = m_levels[level];
+            const MinMaxEntry &e = l.data[(size_t) y * l.width + x];
+
+            ScalarFloat x0 = ScalarFloat(std::min(x << level, m_cells.x())) * inv_w,
+                        x1 = ScalarFloat(std::min((x + 1) << level, m_cells.x())) * inv_w,
+                        y0 = ScalarFloat(std::min(y << level, m_cells.y())) * inv_h,
+                        y1 = ScalarFloat(std::min((y + 1) << level, m_cells.y())) * inv_h;
+
+            ScalarFloat tx0 = (x0 - o.x()) * d_rcp.x(), tx1 = (x1 - o.x()) * d_rcp.x(),
+                        ty0 = (y0 - o.y()) * d_rcp.y(), ty1 = (y1 - o.y()) * d_rcp.y(),
+                        tz0 = (e.min - o.z()) * d_rcp.z(), tz1 = (e.max - o.z()) * d_rcp.z();
+
+            ScalarFloat t_near = std::max(std::max(std::min(tx0, tx1), std::min(ty0, ty1)),
+                                          std::max(std::min(tz0, tz1), mint)),
+                        t_far  = std::min(std::min(std::max(tx0, tx1), std::max(ty0, ty1)),
+                                          std::min(std::max(tz0, tz1), maxt));
+
+            return t_near <= t_far ? t_near : math::Infinity<ScalarFloat>;
+        };
+
+        uint32_t root = (uint32_t) m_levels.size() - 1;
+        ScalarFloat t_root = entry_distance(root, 0, 0);
+        if (t_root == math::Infinity<ScalarFloat>)
+            return false;
+        stack[stack_size++] = StackEntry { t_root, root, 0, 0 };
+
+        bool found = false;
+        while (stack_size > 0) {
+            StackEntry entry = stack[--stack_size];
+            if (entry.t > maxt)
+                continue;
+
+            if (entry.level == 0) {
+                if (intersect_cell(entry.x, entry.y, o, d, mint, maxt)) {
+                    found = true;
+                    if (!t_out)
+                        return true;
+                }
+                continue;
+            }
+
+            /* Collect the intersected children and push them in back-to-front
+               order, so that the nearest is expanded first */
+            const MinMaxLevel &child_level = m_levels[entry.level - 1];
+            StackEntry children[4];
+            int child_count = 0;
+            for (uint32_t cy = 2 * entry.y; cy < std::min(2 * entry.y + 2, child_level.height); ++cy) {
+                for (uint32_t cx = 2 * entry.x; cx < std::min(2 * entry.x + 2, child_level.width); ++cx) {
+                    ScalarFloat t = entry_distance(entry.level - 1, cx, cy);
+                    if (t == math::Infinity<ScalarFloat>)
+                        continue;
+                    children[child_count++] = StackEntry { t, entry.level - 1, cx, cy };
+                }
+            }
+
+            for (int i = 1; i < child_count; ++i) {
+                StackEntry key = children[i];
+                int j = i - 1;
+                while (j >= 0 && children[j].t < key.t) {
+                    children[j + 1] = children[j];
+                    j--;
+                }
+                children[j + 1] = key;
+            }
+
+            for (int i = 0; i < child_count; ++i)
+                stack[stack_size++] = children[i];
+        }
+
+        if (found && t_out)
+            *t_out = maxt;
+        return found;
+    }
+
+#if defined(MTS_ENABLE_EMBREE)
+    static void embree_bounds(const RTCBoundsFunctionArguments *args) {
+        const Heightfield *shape = (const Heightfield *) args->geometryUserPtr;
+        ScalarBoundingBox3f bbox = shape->bbox();
+        RTCBounds *bounds = args->bounds_o;
+        bounds->lower_x = (float) bbox.min.x();
+        bounds->lower_y = (float) bbox.min.y();
+        bounds->lower_z = (float) bbox.min.z();
+        bounds->upper_x = (float) bbox.max.x();
+        bounds->upper_y = (float) bbox.max.y();
+        bounds->upper_z = (float) bbox.max.z();
+    }
+
+    static void embree_intersect(const RTCIntersectFunctionNArguments *args) {
+        const Heightfield *shape = (const Heightfield *) args->geometryUserPtr;
+        unsigned int N = args->N;
+        RTCRayN *rays = RTCRayHitN_RayN(args->rayhit, N);
+        RTCHitN *hits = RTCRayHitN_HitN(args->rayhit, N);
+
+        for (unsigned int i = 0; i < N; ++i) {
+            if (args->valid[i] == 0)
+                continue;
+
+            ScalarPoint3f o(RTCRayN_org_x(rays, N, i), RTCRayN_org_y(rays, N, i),
+                            RTCRayN_org_z(rays, N, i));
+            ScalarVector3f d(RTCRayN_dir_x(rays, N, i), RTCRayN_dir_y(rays, N, i),
+                             RTCRayN_dir_z(rays, N, i));
+
+            o = shape->m_world_to_object.transform_affine(o);
+            d = shape->m_world_to_object.transform_affine(d);
+
+            ScalarFloat t;
+            if (shape->traverse_pyramid(o, d, RTCRayN_tnear(rays, N, i),
+                                        RTCRayN_tfar(rays, N, i), &t)) {
+                RTCRayN_tfar(rays, N, i) = (float) t;
+
+                ScalarPoint3f local = o + d * t;
+                RTCHitN_u(hits, N, i)         = (float) local.x();
+                RTCHitN_v(hits, N, i)         = (float) local.y();
+                RTCHitN_primID(hits, N, i)    = 0;
+                RTCHitN_geomID(hits, N, i)    = args->geomID;
+                RTCHitN_instID(hits, N, i, 0) = args->context->instID[0];
+            }
+        }
+    }
+
+    static void embree_occluded(const RTCOccludedFunctionNArguments *args) {
+        const Heightfield *shape = (const Heightfield *) args->geometryUserPtr;
+        unsigned int N = args->N;
+        RTCRayN *rays = args->ray;
+
+        for (unsigned int i = 0; i < N; ++i) {
+            if (args->valid[i] == 0)
+                continue;
+
+            ScalarPoint3f o(RTCRayN_org_x(rays, N, i), RTCRayN_org_y(rays, N, i),
+                            RTCRayN_org_z(rays, N, i));
+            ScalarVector3f d(RTCRayN_dir_x(rays, N, i), RTCRayN_dir_y(rays, N, i),
+                             RTCRayN_dir_z(rays, N, i));
+
+            o = shape->m_world_to_object.transform_affine(o);
+            d = shape->m_world_to_object.transform_affine(d);
+
+            if (shape->traverse_pyramid(o, d, RTCRayN_tnear(rays, N, i),
+                                        RTCRayN_tfar(rays, N, i), nullptr))
+                RTCRayN_tfar(rays, N, i) = -math::Infinity<float>;
+        }
+    }
+#endif
+
+    std::string m_name;
+    ScalarTransform4f m_object_to_world;
+    ScalarTransform4f m_world_to_object;
+
+    /// Single-channel float32 elevation raster
+    ref<Bitmap> m_data;
+    ScalarVector2u m_size;  ///< Raster resolution
+    ScalarVector2u m_cells; ///< Cell grid resolution (raster resolution - 1)
+
+    /// Min-max mip pyramid over the cell grid, finest level first
+    std::vector<MinMaxLevel> m_levels;
+
+    ScalarFloat m_surface_area;
+};
+
+MTS_IMPLEMENT_CLASS_VARIANT(Heightfield, Shape)
+MTS_EXPORT_PLUGIN(Heightfield, "Heightfield intersection primitive");
+NAMESPACE_END(mitsuba)
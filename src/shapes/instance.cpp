@@ -0,0 +1,194 @@
+#include <mitsuba/core/fwd.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/string.h>
+#include <mitsuba/core/transform.h>
+#include <mitsuba/render/fwd.h>
+#include <mitsuba/render/interaction.h>
+#include <mitsuba/render/shape.h>
+
+#if defined(MTS_ENABLE_EMBREE)
+#  include <embree3/rtcore.h>
+#endif
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _shape-instance:
+
+Instance (:monosp:`instance`)
+-------------------------------------------------
+
+.. pluginparameters::
+
+ * - (Nested plugin)
+   - |shape|
+   - A reference to a shape group that should be instantiated
+ * - to_world
+   - |transform|
+   - Specifies a linear object-to-world transformation. (Default: none
+     (i.e. object space = world space))
+
+This plugin implements a geometry instance used to efficiently replicate
+geometry many times. For details on how to create instances, refer to the
+:ref:`shapegroup <shape-shapegroup>` plugin.
+
+.. warning::
+
+    - Note that it is not possible to assign a different material to each
+      instance---the material assignment specified within the shape group is
+      the one that matters.
+    - Shape groups cannot be used to replicate shapes with attached emitters,
+      sensors, or subsurface scattering models.
+    - This plugin is currently not supported by the OptiX raytracing backend.
+
+ */
+
+template <typename Float, typename Spectrum>
+class Instance final : public Shape<Float, Spectrum> {
+public:
+    MTS_IMPORT_BASE(Shape, m_id)
+    MTS_IMPORT_TYPES()
+
+    using typename Base::ScalarIndex;
+    using typename Base::ScalarSize;
+
+    Instance(const Properties &props) : Base(Properties()) {
+        m_id = props.id();
+        m_object_to_world = props.transform("to_world", ScalarTransform4f());
+        m_world_to_object = m_object_to_world.inverse();
+
+        for (auto &kv : props.objects()) {
+            Base *shape = dynamic_cast<Base *>(kv.second.get());
+            if (shape && shape->class_()->name() == "ShapeGroup") {
+                if (m_shapegroup)
+                    Throw("Only a single shape group can be specified per instance.");
+                m_shapegroup = shape;
+            } else {
+                Throw("Only a reference to a \"shapegroup\" plugin can be "
+                      "specified in an instance.");
+            }
+        }
+
+        if (!m_shapegroup)
+            Throw("A reference to a \"shapegroup\" plugin must be specified!");
+    }
+
+    ScalarBoundingBox3f bbox() const override {
+        /* The shape group reports the bounds of the entire (untransformed)
+           group via the per-primitive bounding box query */
+        const ScalarBoundingBox3f &group_bbox = m_shapegroup->bbox((ScalarIndex) 0);
+
+        ScalarBoundingBox3f result;
+        for (size_t i = 0; i < 8; ++i)
+            result.expand(m_object_to_world.transform_affine(group_bbox.corner(i)));
+        return result;
+    }
+
+    ScalarSize primitive_count() const override { return 1; }
+
+    ScalarSize effective_primitive_count() const override {
+        return m_shapegroup->effective_primitive_count();
+    }
+
+    // =============================================================
+    //! @{ \name Ray tracing routines
+    // =============================================================
+
+#if defined(MTS_ENABLE_EMBREE)
+    RTCGeometry embree_geometry(RTCDevice device) const override {
+        RTCGeometry geom = rtcNewGeometry(device, RTC_GEOMETRY_TYPE_INSTANCE);
+        rtcSetGeometryInstancedScene(geom, m_shapegroup->embree_scene(device));
+        rtcSetGeometryTimeStepCount(geom, 1);
+
+        float data[16];
+        for (size_t c = 0; c < 4; ++c)
+            for (size_t r = 0; r < 4; ++r)
+                data[c * 4 + r] = (float) m_object_to_world.matrix.coeff(c).coeff(r);
+        rtcSetGeometryTransform(geom, 0, RTC_FORMAT_FLOAT4X4_COLUMN_MAJOR, data);
+
+        rtcCommitGeometry(geom);
+        return geom;
+    }
+#else
+    std::pair<Mask, Float> ray_intersect(const Ray3f &ray_, Float *cache,
+                                         Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+
+        /* The ray direction is transformed without renormalization, hence
+           distances along the ray remain valid in both coordinate systems */
+        Ray3f ray = m_world_to_object.transform_affine(ray_);
+        return m_shapegroup->ray_intersect(ray, cache, active);
+    }
+
+    Mask ray_test(const Ray3f &ray_, Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+
+        Ray3f ray = m_world_to_object.transform_affine(ray_);
+        return m_shapegroup->ray_test(ray, active);
+    }
+#endif
+
+    void fill_surface_interaction(const Ray3f &ray_, const Float *cache,
+                                  SurfaceInteraction3f &si_out, Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+
+        SurfaceInteraction3f si(si_out);
+
+        // Resolve the intersection in the coordinate system of the group
+        Ray3f ray = m_world_to_object.transform_affine(ray_);
+        m_shapegroup->fill_surface_interaction(ray, cache, si, active);
+
+        si.p          = m_object_to_world.transform_affine(si.p);
+        si.n          = normalize(m_object_to_world * si.n);
+        si.sh_frame.n = normalize(m_object_to_world * si.sh_frame.n);
+        si.dp_du      = m_object_to_world * si.dp_du;
+        si.dp_dv      = m_object_to_world * si.dp_dv;
+        si.instance   = this;
+
+        si_out[active] = si;
+    }
+
+    std::pair<Vector3f, Vector3f> normal_derivative(const SurfaceInteraction3f &si,
+                                                    bool shading_frame,
+                                                    Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+
+        // Map the query into the coordinate system of the instanced geometry
+        SurfaceInteraction3f temp(si);
+        temp.p          = m_world_to_object.transform_affine(si.p);
+        temp.n          = normalize(m_world_to_object * si.n);
+        temp.sh_frame.n = normalize(m_world_to_object * si.sh_frame.n);
+        temp.dp_du      = m_world_to_object * si.dp_du;
+        temp.dp_dv      = m_world_to_object * si.dp_dv;
+
+        auto [dn_du, dn_dv] = si.shape->normal_derivative(temp, shading_frame, active);
+
+        /* Normals (and hence their derivatives) transform using the inverse
+           transpose; the result is only approximate under non-uniform scaling */
+        return { m_object_to_world * Normal3f(dn_du),
+                 m_object_to_world * Normal3f(dn_dv) };
+    }
+
+    //! @}
+    // =============================================================
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "Instance[" << std::endl
+            << "  shapegroup = \"" << m_shapegroup->id() << "\"," << std::endl
+            << "  object_to_world = " << string::indent(m_object_to_world) << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MTS_DECLARE_CLASS()
+private:
+    ref<Base> m_shapegroup;
+    ScalarTransform4f m_object_to_world;
+    ScalarTransform4f m_world_to_object;
+};
+
+MTS_IMPLEMENT_CLASS_VARIANT(Instance, Shape)
+MTS_EXPORT_PLUGIN(Instance, "Instanced geometry");
+NAMESPACE_END(mitsuba)
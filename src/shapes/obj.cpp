@@ -1,10 +1,14 @@
 #include <mitsuba/render/mesh.h>
 #include <mitsuba/render/emitter.h>
 #include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/hash.h>
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/mmap.h>
 #include <mitsuba/core/util.h>
 #include <mitsuba/core/timer.h>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include <cstring>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -28,6 +32,24 @@ Wavefront OBJ mesh loader (:monosp:`obj`)
  * - flip_tex_coords
    - |bool|
    - Treat the vertical component of the texture as inverted? Most OBJ files use this convention. (Default: |true|)
+ * - cache
+   - |bool|
+   - When set to |true|, a binary snapshot of the parsed mesh is stored next
+     to the source file after the first load and reused by later invocations,
+     skipping OBJ parsing entirely. The cache is invalidated automatically
+     when the source file or any relevant setting changes. (Default: |false|)
+ * - out_of_core
+   - |bool|
+   - When set to |true| (requires :monosp:`cache`), the vertex and face
+     buffers alias a read-only memory mapping of the binary cache file
+     instead of residing in RAM. Geometry pages in on first intersection
+     and can be reclaimed by the OS under memory pressure, which permits
+     scenes whose geometry exceeds main memory. (Default: |false|)
+ * - compress_attributes
+   - |bool|
+   - When set to |true|, vertex normals are stored octahedral-encoded in two
+     16-bit integers and texture coordinates in half precision, reducing the
+     memory footprint of large meshes. (Default: |false|)
  * - to_world
    - |transform|
    - Specifies an optional linear object-to-world transformation.
@@ -53,21 +75,342 @@ Loading an ordinary OBJ file is as simple as writing:
 
  */
 
-template <bool Negate, size_t N>
-void advance(const char **start_, const char *end, const char (&delim)[N]) {
-    const char *start = *start_;
-
-    while (true) {
-        bool is_delim = false;
-        for (size_t i = 0; i < N; ++i)
-            if (*start == delim[i])
-                is_delim = true;
-        if ((is_delim ^ Negate) || start == end)
-            break;
-        ++start;
+/**
+ * Fast in-place substitute for strtof(): parses directly from the memory
+ * mapping (no copy into a 0-terminated buffer, no locale machinery). The
+ * mantissa is accumulated in double precision, which is exact for the
+ * number of digits that occur in OBJ files.
+ */
+template <typename Value>
+Value parse_float(const char **start_, const char *end, bool &parse_error) {
+    const char *cur = *start_;
+    while (cur < end && (*cur == ' ' || *cur == '\t'))
+        ++cur;
+
+    const char *orig = cur;
+    bool negate = false;
+    if (cur < end && (*cur == '-' || *cur == '+')) {
+        negate = *cur == '-';
+        ++cur;
+    }
+    const char *digits = cur;
+
+    double value = 0.0;
+    while (cur < end && *cur >= '0' && *cur <= '9')
+        value = value * 10.0 + (*cur++ - '0');
+
+    if (cur < end && *cur == '.') {
+        ++cur;
+        double frac = 0.0, scale = 1.0;
+        while (cur < end && *cur >= '0' && *cur <= '9') {
+            frac = frac * 10.0 + (*cur - '0');
+            scale *= 10.0;
+            ++cur;
+        }
+        value += frac / scale;
+    }
+
+    if (cur > digits && cur < end && (*cur == 'e' || *cur == 'E')) {
+        ++cur;
+        bool exp_negate = false;
+        if (cur < end && (*cur == '-' || *cur == '+')) {
+            exp_negate = *cur == '-';
+            ++cur;
+        }
+        int exponent = 0;
+        while (cur < end && *cur >= '0' && *cur <= '9')
+            exponent = exponent * 10 + (*cur++ - '0');
+        value *= std::pow(10.0, exp_negate ? -exponent : exponent);
     }
 
-    *start_ = start;
+    parse_error |= cur == orig || cur == digits;
+    *start_ = cur;
+    return Value(negate ? -value : value);
+}
+
+/// In-place substitute for strtoul(); \c found indicates whether any digits were consumed
+template <typename Index>
+Index parse_index(const char **start_, const char *end, bool &found) {
+    const char *cur = *start_;
+    while (cur < end && (*cur == ' ' || *cur == '\t'))
+        ++cur;
+
+    Index value = 0;
+    const char *digits = cur;
+    while (cur < end && *cur >= '0' && *cur <= '9')
+        value = value * 10 + (*cur++ - '0');
+
+    found = cur != digits;
+    *start_ = cur;
+    return value;
+}
+
+// Enables Throw in the non-member parsing code below
+static const Class *m_class = nullptr;
+
+/**
+ * \brief Variant-independent result of parsing an OBJ file
+ *
+ * \ref parse_obj() below is deliberately a non-template function: the plugin
+ * class is instantiated once per variant, but the parse operates entirely on
+ * the single-precision input types that all variants share, so one compiled
+ * copy serves every instantiation and only the (thin) member bookkeeping in
+ * \ref OBJMesh is duplicated per variant.
+ */
+struct OBJParseResult {
+    using Index3 = std::array<uint32_t, 3>;
+
+    /// Chained record of the vertex deduplication table (see \ref vertex_map)
+    struct VertexBinding {
+        Index3 key {{ 0, 0, 0 }};
+        uint32_t value { 0 };
+        VertexBinding *next { nullptr };
+    };
+
+    std::vector<Vector<float, 3>> vertices;
+    std::vector<Normal<float, 3>> normals;
+    std::vector<Vector<float, 2>> texcoords;
+    std::vector<Index3> triangles;
+    /// Maps file-order position indices to deduplicated output vertices
+    std::vector<VertexBinding> vertex_map;
+    /// Number of deduplicated output vertices
+    uint32_t vertex_count = 0;
+    BoundingBox<Point<float, 3>> bbox;
+};
+
+/// Parse an OBJ file from a memory mapping (see \ref OBJParseResult)
+static OBJParseResult parse_obj(const MemoryMappedFile *mmap,
+                                const Transform<Point<float, 4>> &to_world,
+                                bool flip_tex_coords,
+                                const std::string &name) {
+    using Index3        = OBJParseResult::Index3;
+    using VertexBinding = OBJParseResult::VertexBinding;
+    using InputPoint3f  = Point<float, 3>;
+    using InputVector2f = Vector<float, 2>;
+    using InputVector3f = Vector<float, 3>;
+    using InputNormal3f = Normal<float, 3>;
+
+    auto fail = [&](const char *descr, auto... args) {
+        Throw(("Error while loading OBJ file \"%s\": " + std::string(descr))
+                  .c_str(), name, args...);
+    };
+
+    /* Temporary per-chunk buffers: vertex data is parsed in parallel
+       (the declarations are independent of each other), while face
+       definitions reference global indices and are therefore only
+       located here and resolved in a serial second phase below. */
+    struct ChunkData {
+        std::vector<InputVector3f> vertices;
+        std::vector<InputNormal3f> normals;
+        std::vector<InputVector2f> texcoords;
+        std::vector<std::pair<const char *, const char *>> face_lines;
+        BoundingBox<InputPoint3f> bbox;
+    };
+
+    const char *data_begin = (const char *) mmap->data(),
+               *eof        = data_begin + mmap->size();
+
+    /* Split the mapping into chunks of roughly equal size whose
+       boundaries coincide with newlines */
+    size_t target_size = 4 * 1024 * 1024,
+           chunk_count = std::max((size_t) 1,
+               std::min((mmap->size() + target_size - 1) / target_size,
+                        (size_t) util::core_count()));
+
+    std::vector<std::pair<const char *, const char *>> chunks;
+    chunks.reserve(chunk_count);
+    const char *chunk_start = data_begin;
+    for (size_t i = 0; i < chunk_count; ++i) {
+        const char *chunk_end;
+        if (i + 1 == chunk_count) {
+            chunk_end = eof;
+        } else {
+            chunk_end = data_begin + (mmap->size() * (i + 1)) / chunk_count;
+            chunk_end = (const char *) memchr(chunk_end, '\n', eof - chunk_end);
+            chunk_end = chunk_end ? chunk_end + 1 : eof;
+        }
+        if (chunk_end > chunk_start)
+            chunks.emplace_back(chunk_start, chunk_end);
+        chunk_start = chunk_end;
+    }
+
+    std::vector<ChunkData> chunk_data(chunks.size());
+
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, chunks.size(), 1),
+        [&](const tbb::blocked_range<size_t> &range) {
+            for (size_t ci = range.begin(); ci != range.end(); ++ci) {
+                ChunkData &cd  = chunk_data[ci];
+                const char *ptr  = chunks[ci].first,
+                           *cend = chunks[ci].second;
+
+                size_t vertex_guess = (cend - ptr) / 100;
+                cd.vertices.reserve(vertex_guess);
+                cd.face_lines.reserve(vertex_guess * 2);
+
+                while (ptr < cend) {
+                    const char *eol = (const char *) memchr(ptr, '\n', cend - ptr);
+                    if (!eol)
+                        eol = cend;
+
+                    // Skip whitespace
+                    const char *cur = ptr;
+                    while (cur < eol && (*cur == ' ' || *cur == '\t' || *cur == '\r'))
+                        ++cur;
+
+                    bool parse_error = false;
+                    if (cur + 1 < eol && cur[0] == 'v' && (cur[1] == ' ' || cur[1] == '\t')) {
+                        // Vertex position
+                        InputPoint3f p;
+                        cur += 2;
+                        for (size_t i = 0; i < 3; ++i)
+                            p[i] = parse_float<float>(&cur, eol, parse_error);
+                        p = to_world.transform_affine(p);
+                        if (unlikely(!all(enoki::isfinite(p))))
+                            fail("mesh contains invalid vertex position data");
+                        cd.bbox.expand(p);
+                        cd.vertices.push_back(p);
+                    } else if (cur + 2 < eol && cur[0] == 'v' && cur[1] == 'n' &&
+                               (cur[2] == ' ' || cur[2] == '\t')) {
+                        // Vertex normal
+                        InputNormal3f n;
+                        cur += 3;
+                        for (size_t i = 0; i < 3; ++i)
+                            n[i] = parse_float<float>(&cur, eol, parse_error);
+                        n = normalize(to_world.transform_affine(n));
+                        if (unlikely(!all(enoki::isfinite(n))))
+                            fail("mesh contains invalid vertex normal data");
+                        cd.normals.push_back(n);
+                    } else if (cur + 2 < eol && cur[0] == 'v' && cur[1] == 't' &&
+                               (cur[2] == ' ' || cur[2] == '\t')) {
+                        // Texture coordinate
+                        InputVector2f uv;
+                        cur += 3;
+                        for (size_t i = 0; i < 2; ++i)
+                            uv[i] = parse_float<float>(&cur, eol, parse_error);
+                        if (flip_tex_coords)
+                            uv.y() = 1.f - uv.y();
+
+                        cd.texcoords.push_back(uv);
+                    } else if (cur + 1 < eol && cur[0] == 'f' && (cur[1] == ' ' || cur[1] == '\t')) {
+                        // Face specification: resolved in the second phase
+                        cd.face_lines.emplace_back(cur + 2, eol);
+                    }
+
+                    if (unlikely(parse_error))
+                        fail("could not parse line \"%s\"", std::string(ptr, eol));
+                    ptr = eol + 1;
+                }
+            }
+        });
+
+    /// Merge the per-chunk vertex data (in file order)
+    OBJParseResult result;
+
+    size_t vertex_count = 0, normal_count = 0, texcoord_count = 0,
+           face_line_count = 0;
+    for (const ChunkData &cd : chunk_data) {
+        vertex_count    += cd.vertices.size();
+        normal_count    += cd.normals.size();
+        texcoord_count  += cd.texcoords.size();
+        face_line_count += cd.face_lines.size();
+    }
+
+    result.vertices.reserve(vertex_count);
+    result.normals.reserve(normal_count);
+    result.texcoords.reserve(texcoord_count);
+    result.triangles.reserve(face_line_count);
+    result.vertex_map.resize(vertex_count);
+
+    for (const ChunkData &cd : chunk_data) {
+        result.vertices.insert(result.vertices.end(),
+                               cd.vertices.begin(), cd.vertices.end());
+        result.normals.insert(result.normals.end(),
+                              cd.normals.begin(), cd.normals.end());
+        result.texcoords.insert(result.texcoords.end(),
+                                cd.texcoords.begin(), cd.texcoords.end());
+        if (cd.bbox.valid()) {
+            result.bbox.expand(cd.bbox.min);
+            result.bbox.expand(cd.bbox.max);
+        }
+    }
+
+    /* Second phase: resolve face definitions. This is serial since the
+       vertex deduplication must assign globally consistent indices. */
+    uint32_t vertex_ctr = 0;
+
+    for (const ChunkData &cd : chunk_data) {
+        for (auto [cur, eol] : cd.face_lines) {
+            size_t vertex_index = 0;
+            size_t type_index = 0;
+            Index3 key {{ 0, 0, 0 }};
+            Index3 tri;
+            bool parse_error = false;
+
+            while (true) {
+                bool found = false;
+                uint32_t value = parse_index<uint32_t>(&cur, eol, found);
+                if (!found)
+                    break;
+
+                if (type_index < 3) {
+                    key[type_index] = value;
+                } else {
+                    parse_error = true;
+                    break;
+                }
+
+                while (cur < eol && *cur == '/') {
+                    type_index++;
+                    cur++;
+                }
+
+                if (cur == eol || *cur == ' ' || *cur == '\t' || *cur == '\r') {
+                    type_index = 0;
+                    size_t map_index = key[0] - 1;
+
+                    if (unlikely(map_index >= result.vertices.size()))
+                        fail("reference to invalid vertex %i!", key[0]);
+
+                    // Hash table lookup
+                    VertexBinding *entry = &result.vertex_map[map_index];
+                    while (entry->key != key && entry->next != nullptr)
+                        entry = entry->next;
+
+                    uint32_t id;
+                    if (entry->key == key) {
+                        // Hit
+                        id = entry->value;
+                    } else {
+                        // Miss
+                        if (entry->key != Index3{{0, 0, 0}}) {
+                            entry->next = new VertexBinding();
+                            entry = entry->next;
+                        }
+                        entry->key = key;
+                        id = entry->value = vertex_ctr++;
+                    }
+
+                    if (vertex_index < 3) {
+                        tri[vertex_index] = id;
+                    } else {
+                        tri[1] = tri[2];
+                        tri[2] = id;
+                    }
+                    vertex_index++;
+
+                    if (vertex_index >= 3)
+                        result.triangles.push_back(tri);
+                }
+            }
+
+            if (unlikely(parse_error))
+                fail("could not parse face \"%s\"", std::string(cur, eol));
+        }
+    }
+
+    result.vertex_count = vertex_ctr;
+    return result;
 }
 
 template <typename Float, typename Spectrum>
@@ -76,7 +419,9 @@ public:
     MTS_IMPORT_BASE(Mesh, m_vertices, m_faces, m_normal_offset, m_vertex_size, m_face_size,
                     m_texcoord_offset, m_color_offset, m_name, m_bbox, m_to_world, m_vertex_count,
                     m_face_count, m_vertex_struct, m_face_struct, m_disable_vertex_normals,
-                    recompute_vertex_normals, is_emitter, emitter, has_vertex_normals, vertex)
+                    recompute_vertex_normals, is_emitter, emitter, has_vertex_normals, vertex,
+                    read_cache, write_cache, cache_hash, compress_vertex_attributes,
+                    m_compress_attributes, m_out_of_core)
     MTS_IMPORT_TYPES()
 
     using typename Base::ScalarSize;
@@ -89,10 +434,6 @@ public:
     using typename Base::InputVector3f;
     using typename Base::InputNormal3f;
 
-    InputFloat strtof(const char *nptr, char **endptr) {
-            return std::strtof(nptr, endptr);
-    }
-
     OBJMesh(const Properties &props) : Base(props) {
         /* Causes all texture coordinates to be vertically flipped.
            Enabled by default, for consistence with the Mitsuba 1 behavior. */
@@ -114,169 +455,50 @@ public:
 
         ref<MemoryMappedFile> mmap = new MemoryMappedFile(file_path);
 
-        using ScalarIndex3 = std::array<ScalarIndex, 3>;
-
-        struct VertexBinding {
-            ScalarIndex3 key {{ 0, 0, 0 }};
-            ScalarIndex value { 0 };
-            VertexBinding *next { nullptr };
-        };
-
-        /// Temporary buffers for vertices, normals, and texture coordinates
-        std::vector<InputVector3f> vertices;
-        std::vector<InputNormal3f> normals;
-        std::vector<InputVector2f> texcoords;
-        std::vector<ScalarIndex3> triangles;
-        std::vector<VertexBinding> vertex_map;
-
-        size_t vertex_guess = mmap->size() / 100;
-        vertices.reserve(vertex_guess);
-        normals.reserve(vertex_guess);
-        texcoords.reserve(vertex_guess);
-        triangles.reserve(vertex_guess * 2);
-        vertex_map.resize(vertex_guess);
-
-        ScalarIndex vertex_ctr = 0;
+        /* Optionally maintain a binary snapshot of the parsed mesh, keyed by
+           the source file contents and all settings that affect the layout */
+        bool use_cache = props.bool_("cache", false);
+        fs::path cache_path = fs::path(file_path.string() + ".mtscache");
+        size_t source_hash = 0;
+
+        if (use_cache) {
+            source_hash = Base::cache_hash((const uint8_t *) mmap->data(), mmap->size());
+            source_hash = hash_combine(source_hash,
+                Base::cache_hash((const uint8_t *) &m_to_world, sizeof(m_to_world)));
+            source_hash = hash_combine(source_hash, hash(flip_tex_coords));
+            source_hash = hash_combine(source_hash, hash(m_disable_vertex_normals));
+            source_hash = hash_combine(source_hash, hash(m_reorder));
+
+            if (read_cache(cache_path, source_hash)) {
+                Log(Debug, "\"%s\": loaded binary mesh cache (%i faces, %i vertices)",
+                    m_name, m_face_count, m_vertex_count);
+                if (m_compress_attributes)
+                    compress_vertex_attributes();
+                if (is_emitter())
+                    emitter()->set_shape(this);
+                return;
+            }
+        }
 
-        const char *ptr = (const char *) mmap->data();
-        const char *eof = ptr + mmap->size();
-        char buf[1025];
         Timer timer;
 
-        while (ptr < eof) {
-            // Determine the offset of the next newline
-            const char *next = ptr;
-            advance<false>(&next, eof, "\n");
-
-            // Copy buf into a 0-terminated buffer
-            size_t size = next - ptr;
-            if (size >= sizeof(buf) - 1)
-                fail("file contains an excessively long line! (%i characters)", size);
-            memcpy(buf, ptr, size);
-            buf[size] = '\0';
+        /* The parse runs entirely in the variant-independent input
+           precision; only the member bookkeeping below is variant-typed */
+        using InputMatrix4f    = Matrix<InputFloat, 4>;
+        using InputTransform4f = Transform<Point<InputFloat, 4>>;
 
-            // Skip whitespace
-            const char *cur = buf, *eol = buf + size;
-            advance<true>(&cur, eol, " \t\r");
+        OBJParseResult parsed =
+            parse_obj(mmap.get(),
+                      InputTransform4f(InputMatrix4f(m_to_world.matrix)),
+                      flip_tex_coords, m_name);
 
-            bool parse_error = false;
-            if (cur[0] == 'v' && (cur[1] == ' ' || cur[1] == '\t')) {
-                // Vertex position
-                InputPoint3f p;
-                cur += 2;
-                for (size_t i = 0; i < 3; ++i) {
-                    const char *orig = cur;
-                    p[i] = strtof(cur, (char **) &cur);
-                    parse_error |= cur == orig;
-                }
-                p = m_to_world.transform_affine(p);
-                if (unlikely(!all(enoki::isfinite(p))))
-                    fail("mesh contains invalid vertex position data");
-                m_bbox.expand(p);
-                vertices.push_back(p);
-            } else if (cur[0] == 'v' && cur[1] == 'n' && (cur[2] == ' ' || cur[2] == '\t')) {
-                // Vertex normal
-                InputNormal3f n;
-                cur += 3;
-                for (size_t i = 0; i < 3; ++i) {
-                    const char *orig = cur;
-                    n[i] = strtof(cur, (char **) &cur);
-                    parse_error |= cur == orig;
-                }
-                n = normalize(m_to_world.transform_affine(n));
-                if (unlikely(!all(enoki::isfinite(n))))
-                    fail("mesh contains invalid vertex normal data");
-                normals.push_back(n);
-            } else if (cur[0] == 'v' && cur[1] == 't' && (cur[2] == ' ' || cur[2] == '\t')) {
-                // Texture coordinate
-                InputVector2f uv;
-                cur += 3;
-                for (size_t i = 0; i < 2; ++i) {
-                    const char *orig = cur;
-                    uv[i] = strtof(cur, (char **) &cur);
-                    parse_error |= cur == orig;
-                }
-                if (flip_tex_coords)
-                    uv.y() = 1.f - uv.y();
-
-                texcoords.push_back(uv);
-            } else if (cur[0] == 'f' && (cur[1] == ' ' || cur[1] == '\t')) {
-                // Face specification
-                cur += 2;
-                size_t vertex_index = 0;
-                size_t type_index = 0;
-                ScalarIndex3 key {{ (ScalarIndex) 0, (ScalarIndex) 0, (ScalarIndex) 0 }};
-                ScalarIndex3 tri;
-
-                while (true) {
-                    const char *next2;
-                    ScalarIndex value = (ScalarIndex) strtoul(cur, (char **) &next2, 10);
-                    if (cur == next2)
-                        break;
-
-                    if (type_index < 3) {
-                        key[type_index] = value;
-                    } else {
-                        parse_error = true;
-                        break;
-                    }
-
-                    while (*next2 == '/') {
-                        type_index++;
-                        next2++;
-                    }
-
-                    if (*next2 == ' ' || *next2 == '\t' || *next2 == '\0' || *next2 == '\r') {
-                        type_index = 0;
-                        size_t map_index = key[0] - 1;
-
-                        if (unlikely(map_index >= vertices.size()))
-                            fail("reference to invalid vertex %i!", key[0]);
-                        if (unlikely(vertex_map.size() < vertices.size()))
-                            vertex_map.resize(vertices.size());
-
-                        // Hash table lookup
-                        VertexBinding *entry = &vertex_map[map_index];
-                        while (entry->key != key && entry->next != nullptr)
-                            entry = entry->next;
-
-                        ScalarIndex id;
-                        if (entry->key == key) {
-                            // Hit
-                            id = entry->value;
-                        } else {
-                            // Miss
-                            if (entry->key != ScalarIndex3{{0, 0, 0}}) {
-                                entry->next = new VertexBinding();
-                                entry = entry->next;
-                            }
-                            entry->key = key;
-                            id = entry->value = vertex_ctr++;
-                        }
-
-                        if (vertex_index < 3) {
-                            tri[vertex_index] = id;
-                        } else {
-                            tri[1] = tri[2];
-                            tri[2] = id;
-                        }
-                        vertex_index++;
-
-                        if (vertex_index >= 3)
-                            triangles.push_back(tri);
-                    }
-
-                    cur = next2;
-                }
-            }
-
-            if (unlikely(parse_error))
-                fail("could not parse line \"%s\"", buf);
-            ptr = next + 1;
+        if (parsed.bbox.valid()) {
+            m_bbox.expand(parsed.bbox.min);
+            m_bbox.expand(parsed.bbox.max);
         }
 
-        m_vertex_count = vertex_ctr;
-        m_face_count = (ScalarSize) triangles.size();
+        m_vertex_count = (ScalarSize) parsed.vertex_count;
+        m_face_count   = (ScalarSize) parsed.triangles.size();
         m_vertex_struct = new Struct();
         for (auto name : { "x", "y", "z" })
             m_vertex_struct->append(name, struct_type_v<InputFloat>);
@@ -287,7 +509,7 @@ public:
             m_normal_offset = (ScalarIndex) m_vertex_struct->offset("nx");
         }
 
-        if (!texcoords.empty()) {
+        if (!parsed.texcoords.empty()) {
             for (auto name : { "u", "v" })
                 m_vertex_struct->append(name, struct_type_v<InputFloat>);
             m_texcoord_offset = (ScalarIndex) m_vertex_struct->offset("u");
@@ -299,32 +521,34 @@ public:
 
         m_vertex_size = (ScalarSize) m_vertex_struct->size();
         m_face_size   = (ScalarSize) m_face_struct->size();
-        m_vertices    = VertexHolder(new uint8_t[(m_vertex_count + 1) * m_vertex_size]);
-        m_faces       = FaceHolder(new uint8_t[(m_face_count + 1) * m_face_size]);
-        memcpy(m_faces.get(), triangles.data(), m_face_count * m_face_size);
+        m_vertices    = detail::alloc_mesh_buffer((m_vertex_count + 1) * (size_t) m_vertex_size);
+        m_faces       = detail::alloc_mesh_buffer((m_face_count + 1) * (size_t) m_face_size);
+        memcpy(m_faces.get(), parsed.triangles.data(), m_face_count * m_face_size);
 
-        for (const auto& v_ : vertex_map) {
-            const VertexBinding *v = &v_;
+        using Index3 = OBJParseResult::Index3;
+        for (const auto& v_ : parsed.vertex_map) {
+            const OBJParseResult::VertexBinding *v = &v_;
 
-            while (v && v->key != ScalarIndex3{{0, 0, 0}}) {
+            while (v && v->key != Index3{{0, 0, 0}}) {
                 uint8_t *vertex_ptr = vertex(v->value);
                 auto key = v->key;
 
-                store_unaligned(vertex_ptr, vertices[key[0] - 1]);
+                store_unaligned(vertex_ptr, parsed.vertices[key[0] - 1]);
 
                 if (key[1]) {
                     size_t map_index = key[1] - 1;
-                    if (unlikely(map_index >= texcoords.size()))
+                    if (unlikely(map_index >= parsed.texcoords.size()))
                         fail("reference to invalid texture coordinate %i!", key[1]);
                     store_unaligned(vertex_ptr + m_texcoord_offset,
-                                    texcoords[map_index]);
+                                    parsed.texcoords[map_index]);
                 }
 
                 if (has_vertex_normals() && key[2]) {
                     size_t map_index = key[2] - 1;
-                    if (unlikely(map_index >= normals.size()))
+                    if (unlikely(map_index >= parsed.normals.size()))
                         fail("reference to invalid normal %i!", key[2]);
-                    store_unaligned(vertex_ptr + m_normal_offset, normals[key[2] - 1]);
+                    store_unaligned(vertex_ptr + m_normal_offset,
+                                    parsed.normals[key[2] - 1]);
                 }
 
                 v = v->next;
@@ -338,9 +562,25 @@ public:
             util::time_string(timer.value())
         );
 
-        if (!m_disable_vertex_normals && normals.empty())
+        if (!m_disable_vertex_normals && parsed.normals.empty())
             recompute_vertex_normals();
 
+        /* Reorder before the cache is written so that subsequent runs load
+           the optimized layout directly */
+        if (m_reorder)
+            reorder_layout();
+
+        if (use_cache) {
+            write_cache(cache_path, source_hash);
+            /* When loading out of core, immediately swap the heap buffers
+               for file-backed ones so this first run also sheds memory */
+            if (m_out_of_core)
+                read_cache(cache_path, source_hash);
+        }
+
+        if (m_compress_attributes)
+            compress_vertex_attributes();
+
         if (is_emitter())
             emitter()->set_shape(this);
     }
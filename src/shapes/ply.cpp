@@ -3,10 +3,16 @@
 #include <mitsuba/core/fstream.h>
 #include <mitsuba/core/mstream.h>
 #include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/hash.h>
+#include <mitsuba/core/mmap.h>
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/util.h>
 #include <mitsuba/core/timer.h>
 #include <enoki/half.h>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include <atomic>
+#include <mutex>
 #include <unordered_map>
 #include <fstream>
 
@@ -29,10 +35,38 @@ PLY (Stanford Triangle Format) mesh loader (:monosp:`ply`)
    - When set to |true|, any existing or computed vertex normals are
      discarded and *face normals* will instead be used during rendering.
      This gives the rendered object a faceted appearance. (Default: |false|)
+ * - compress_attributes
+   - |bool|
+   - When set to |true|, vertex normals are stored octahedral-encoded in two
+     16-bit integers and texture coordinates in half precision, reducing the
+     memory footprint of large meshes. (Default: |false|)
  * - to_world
    - |transform|
    - Specifies an optional linear object-to-world transformation.
      (Default: none, i.e. object space = world space)
+ * - cache
+   - |bool|
+   - When set to |true|, a binary snapshot of the parsed mesh is stored next
+     to the source file after the first load and reused by later invocations,
+     skipping PLY parsing entirely. The cache is invalidated automatically
+     when the source file or any relevant setting changes. (Default: |false|)
+ * - filename_end
+   - |string|
+   - Optional filename of a second PLY file with identical connectivity that
+     holds the vertex positions at shutter close. When specified, rays
+     intersect the mesh at their associated time by linearly interpolating
+     the two position samples (*deformation motion blur*).
+ * - motion_time_begin, motion_time_end
+   - |float|
+   - Times associated with the two vertex position samples; ray times
+     outside of this interval are clamped. (Default: 0 and 1)
+ * - out_of_core
+   - |bool|
+   - When set to |true| (requires :monosp:`cache`), the vertex and face
+     buffers alias a read-only memory mapping of the binary cache file
+     instead of residing in RAM. Geometry pages in on first intersection
+     and can be reclaimed by the OS under memory pressure, which permits
+     scenes whose geometry exceeds main memory. (Default: |false|)
 
 .. subfigstart::
 .. subfigure:: ../../resources/data/docs/images/render/shape_ply_bunny.jpg
@@ -50,13 +84,274 @@ UV coordinates and vertex normals.
 
  */
 
+// Enables Throw in the non-member parsing code below
+static const Class *m_class = nullptr;
+
+/* The PLY header and ASCII-to-binary conversion code below deliberately
+   consists of non-template functions: the plugin class is instantiated once
+   per variant, but this logic is variant-independent, so a single compiled
+   copy serves every instantiation. */
+
+struct PLYElement {
+    std::string name;
+    size_t count;
+    ref<Struct> struct_;
+};
+
+struct PLYHeader {
+    bool ascii = false;
+    std::vector<std::string> comments;
+    std::vector<PLYElement> elements;
+};
+
+static PLYHeader parse_ply_header(Stream *stream) {
+    Struct::ByteOrder byte_order = Struct::host_byte_order();
+    bool ply_tag_seen = false;
+    bool header_processed = false;
+    PLYHeader header;
+
+    std::unordered_map<std::string, Struct::Type> fmt_map;
+    fmt_map["char"]   = Struct::Type::Int8;
+    fmt_map["uchar"]  = Struct::Type::UInt8;
+    fmt_map["short"]  = Struct::Type::Int16;
+    fmt_map["ushort"] = Struct::Type::UInt16;
+    fmt_map["int"]    = Struct::Type::Int32;
+    fmt_map["uint"]   = Struct::Type::UInt32;
+    fmt_map["float"]  = Struct::Type::Float32;
+    fmt_map["double"] = Struct::Type::Float64;
+
+    /* Unofficial extensions :) */
+    fmt_map["uint8"]   = Struct::Type::UInt8;
+    fmt_map["uint16"]  = Struct::Type::UInt16;
+    fmt_map["uint32"]  = Struct::Type::UInt32;
+    fmt_map["int8"]    = Struct::Type::Int8;
+    fmt_map["int16"]   = Struct::Type::Int16;
+    fmt_map["int32"]   = Struct::Type::Int32;
+    fmt_map["long"]    = Struct::Type::Int64;
+    fmt_map["ulong"]   = Struct::Type::UInt64;
+    fmt_map["half"]    = Struct::Type::Float16;
+    fmt_map["float16"] = Struct::Type::Float16;
+    fmt_map["float32"] = Struct::Type::Float32;
+    fmt_map["float64"] = Struct::Type::Float64;
+
+    ref<Struct> struct_;
+
+    while (true) {
+        std::string line = stream->read_line();
+        std::istringstream iss(line);
+        std::string token;
+        if (!(iss >> token))
+            continue;
+
+        if (token == "comment") {
+            std::getline(iss, line);
+            header.comments.push_back(string::trim(line));
+            continue;
+        } else if (token == "ply") {
+            if (ply_tag_seen)
+                Throw("invalid PLY header: duplicate \"ply\" tag");
+            ply_tag_seen = true;
+            if (iss >> token)
+                Throw("invalid PLY header: excess tokens after \"ply\"");
+        } else if (token == "format") {
+            if (!ply_tag_seen)
+                Throw("invalid PLY header: \"format\" before \"ply\" tag");
+            if (header_processed)
+                Throw("invalid PLY header: duplicate \"format\" tag");
+            if (!(iss >> token))
+                Throw("invalid PLY header: missing token after \"format\"");
+            if (token == "ascii")
+                header.ascii = true;
+            else if (token == "binary_little_endian")
+                byte_order = Struct::ByteOrder::LittleEndian;
+            else if (token == "binary_big_endian")
+                byte_order = Struct::ByteOrder::BigEndian;
+            else
+                Throw("invalid PLY header: invalid token after \"format\"");
+            if (!(iss >> token))
+                Throw("invalid PLY header: missing version number after \"format\"");
+            if (token != "1.0")
+                Throw("PLY file has unknown version number \"%s\"", token);
+            if (iss >> token)
+                Throw("invalid PLY header: excess tokens after \"format\"");
+            header_processed = true;
+        } else if (token == "element") {
+            if (!(iss >> token))
+                Throw("invalid PLY header: missing token after \"element\"");
+            header.elements.emplace_back();
+            auto &element = header.elements.back();
+            element.name = token;
+            if (!(iss >> token))
+                Throw("invalid PLY header: missing token after \"element\"");
+            element.count = (size_t) stoull(token);
+            struct_ = element.struct_ = new Struct(true, byte_order);
+        } else if (token == "property") {
+            if (!header_processed)
+                Throw("invalid PLY header: encountered \"property\" before \"format\"");
+            if (header.elements.empty())
+                Throw("invalid PLY header: encountered \"property\" before \"element\"");
+            if (!(iss >> token))
+                Throw("invalid PLY header: missing token after \"property\"");
+
+            if (token == "list") {
+                if (!(iss >> token))
+                    Throw("invalid PLY header: missing token after \"property list\"");
+                auto it1 = fmt_map.find(token);
+                if (it1 == fmt_map.end())
+                    Throw("invalid PLY header: unknown format type \"%s\"", token);
+
+                if (!(iss >> token))
+                    Throw("invalid PLY header: missing token after \"property list\"");
+                auto it2 = fmt_map.find(token);
+                if (it2 == fmt_map.end())
+                    Throw("invalid PLY header: unknown format type \"%s\"", token);
+
+                if (!(iss >> token))
+                    Throw("invalid PLY header: missing token after \"property list\"");
+
+                struct_->append(token + ".count", it1->second, +Struct::Flags::Assert, 3);
+                for (int i = 0; i<3; ++i)
+                    struct_->append(tfm::format("i%i", i), it2->second);
+            } else {
+                auto it = fmt_map.find(token);
+                if (it == fmt_map.end())
+                    Throw("invalid PLY header: unknown format type \"%s\"", token);
+                if (!(iss >> token))
+                    Throw("invalid PLY header: missing token after \"property\"");
+                uint32_t flags = +Struct::Flags::None;
+                if (it->second >= Struct::Type::Int8 &&
+                    it->second <= Struct::Type::UInt64)
+                    flags = Struct::Flags::Normalized | Struct::Flags::Gamma;
+                struct_->append(token, it->second, flags);
+            }
+
+            if (iss >> token)
+                Throw("invalid PLY header: excess tokens after \"property\"");
+        } else if (token == "end_header") {
+            if (iss >> token)
+                Throw("invalid PLY header: excess tokens after \"end_header\"");
+            break;
+        } else {
+            Throw("invalid PLY header: unknown token \"%s\"", token);
+        }
+    }
+    if (!header_processed)
+        Throw("invalid PLY file: no header information");
+    return header;
+}
+
+static ref<Stream> parse_ascii(FileStream *in,
+                               const std::vector<PLYElement> &elements) {
+    ref<Stream> out = new MemoryStream();
+    std::fstream &is = *in->native();
+    for (auto const &el : elements) {
+        for (size_t i = 0; i < el.count; ++i) {
+            for (auto const &field : *(el.struct_)) {
+                switch (field.type) {
+                    case Struct::Type::Int8: {
+                            int value;
+                            if (!(is >> value)) Throw("Could not parse \"char\" value for field %s", field.name);
+                            if (value < -128 || value > 127)
+                                Throw("Could not parse \"char\" value for field %s", field.name);
+                            out->write((int8_t) value);
+                        }
+                        break;
+
+                    case Struct::Type::UInt8: {
+                            int value;
+                            if (!(is >> value))
+                                Throw("Could not parse \"uchar\" value for field %s (may be due to non-triangular faces)", field.name);
+                            if (value < 0 || value > 255)
+                                Throw("Could not parse \"uchar\" value for field %s (may be due to non-triangular faces)", field.name);
+                            out->write((uint8_t) value);
+                        }
+                        break;
+
+                    case Struct::Type::Int16: {
+                            int16_t value;
+                            if (!(is >> value)) Throw("Could not parse \"short\" value for field %s", field.name);
+                            out->write(value);
+                        }
+                        break;
+
+                    case Struct::Type::UInt16: {
+                            uint16_t value;
+                            if (!(is >> value)) Throw("Could not parse \"ushort\" value for field %s", field.name);
+                            out->write(value);
+                        }
+                        break;
+
+                    case Struct::Type::Int32: {
+                            int32_t value;
+                            if (!(is >> value)) Throw("Could not parse \"int\" value for field %s", field.name);
+                            out->write(value);
+                        }
+                        break;
+
+                    case Struct::Type::UInt32: {
+                            uint32_t value;
+                            if (!(is >> value)) Throw("Could not parse \"uint\" value for field %s", field.name);
+                            out->write(value);
+                        }
+                        break;
+
+                    case Struct::Type::Int64: {
+                            int64_t value;
+                            if (!(is >> value)) Throw("Could not parse \"long\" value for field %s", field.name);
+                            out->write(value);
+                        }
+                        break;
+
+                    case Struct::Type::UInt64: {
+                            uint64_t value;
+                            if (!(is >> value)) Throw("Could not parse \"ulong\" value for field %s", field.name);
+                            out->write(value);
+                        }
+                        break;
+
+                    case Struct::Type::Float16: {
+                            float value;
+                            if (!(is >> value)) Throw("Could not parse \"half\" value for field %s", field.name);
+                            out->write(enoki::half::float32_to_float16(value));
+                        }
+                        break;
+
+                    case Struct::Type::Float32: {
+                            float value;
+                            if (!(is >> value)) Throw("Could not parse \"float\" value for field %s", field.name);
+                            out->write(value);
+                        }
+                        break;
+
+                    case Struct::Type::Float64: {
+                            double value;
+                            if (!(is >> value)) Throw("Could not parse \"double\" value for field %s", field.name);
+                            out->write(value);
+                        }
+                        break;
+
+                    default:
+                        Throw("internal error");
+                }
+            }
+        }
+    }
+    std::string token;
+    if (is >> token)
+        Throw("Trailing tokens after end of PLY file");
+    out->seek(0);
+    return out;
+}
+
 template <typename Float, typename Spectrum>
 class PLYMesh final : public Mesh<Float, Spectrum> {
 public:
     MTS_IMPORT_BASE(Mesh, m_vertices, m_faces, m_normal_offset, m_vertex_size, m_face_size,
                     m_texcoord_offset, m_color_offset, m_name, m_bbox, m_to_world, m_vertex_count,
                     m_face_count, m_vertex_struct, m_face_struct, m_disable_vertex_normals,
-                    recompute_vertex_normals, is_emitter, emitter)
+                    recompute_vertex_normals, is_emitter, emitter,
+                    read_cache, write_cache, cache_hash, compress_vertex_attributes,
+                    m_compress_attributes, m_out_of_core, load_vertex_motion)
     MTS_IMPORT_TYPES()
 
     using typename Base::ScalarSize;
@@ -67,21 +362,11 @@ public:
     using typename Base::InputPoint3f ;
     using typename Base::InputNormal3f;
 
-    struct PLYElement {
-        std::string name;
-        size_t count;
-        ref<Struct> struct_;
-    };
-
-    struct PLYHeader {
-        bool ascii = false;
-        std::vector<std::string> comments;
-        std::vector<PLYElement> elements;
-    };
-
     PLYMesh(const Properties &props) : Base(props) {
-        /// Process vertex/index records in large batches
+        /// Process vertex/index records in large batches (streaming fallback)
         constexpr size_t elements_per_packet = 1024;
+        /// Work granularity when converting memory-mapped files in parallel
+        constexpr size_t elements_per_task = 65536;
 
         auto fs = Thread::thread()->file_resolver();
         fs::path file_path = fs->resolve(props.string("filename"));
@@ -95,6 +380,32 @@ public:
         if (!fs::exists(file_path))
             fail("file not found");
 
+        /* Optionally maintain a binary snapshot of the parsed mesh, keyed by
+           the source file contents and all settings that affect the layout */
+        bool use_cache = props.bool_("cache", false);
+        fs::path cache_path = fs::path(file_path.string() + ".mtscache");
+        size_t source_hash = 0;
+
+        if (use_cache) {
+            ref<MemoryMappedFile> mmap = new MemoryMappedFile(file_path);
+            source_hash = Base::cache_hash((const uint8_t *) mmap->data(), mmap->size());
+            source_hash = hash_combine(source_hash,
+                Base::cache_hash((const uint8_t *) &m_to_world, sizeof(m_to_world)));
+            source_hash = hash_combine(source_hash, hash(m_disable_vertex_normals));
+            source_hash = hash_combine(source_hash, hash(m_reorder));
+
+            if (read_cache(cache_path, source_hash)) {
+                Log(Debug, "\"%s\": loaded binary mesh cache (%i faces, %i vertices)",
+                    m_name, m_face_count, m_vertex_count);
+                if (m_compress_attributes)
+                    compress_vertex_attributes();
+                load_vertex_motion(props);
+                if (is_emitter())
+                    emitter()->set_shape(this);
+                return;
+            }
+        }
+
         ref<Stream> stream = new FileStream(file_path);
         Timer timer;
 
@@ -115,6 +426,38 @@ public:
 
         // TODO check header float type (32 vs 64)
 
+        /* Binary files bypass the Stream abstraction entirely: the element
+           data is accessed directly through a memory mapping, which avoids
+           per-packet reads and enables parallel conversion */
+        ref<MemoryMappedFile> mmap_file;
+        const uint8_t *body = nullptr;
+        size_t body_remaining = 0;
+        if (!header.ascii) {
+            mmap_file = new MemoryMappedFile(file_path);
+            size_t body_offset = (size_t) stream->tell();
+            body = (const uint8_t *) mmap_file->data() + body_offset;
+            body_remaining = mmap_file->size() - body_offset;
+        }
+
+        /* Check whether two structures are bitwise identical (ignoring
+           default-value annotations), in which case records can be copied
+           verbatim without running the converter */
+        auto layout_matches = [](const Struct *src, const Struct *dst) {
+            if (src->byte_order() != Struct::host_byte_order() ||
+                src->size() != dst->size() ||
+                src->field_count() != dst->field_count())
+                return false;
+            for (size_t i = 0; i < src->field_count(); ++i) {
+                const Struct::Field &fs = (*src)[i], &fd = (*dst)[i];
+                if (fs.name != fd.name || fs.type != fd.type ||
+                    fs.offset != fd.offset ||
+                    (fs.flags & ~Struct::Flags::Default) != 0u ||
+                    (fd.flags & ~Struct::Flags::Default) != 0u)
+                    return false;
+            }
+            return true;
+        };
+
         bool has_vertex_normals = false;
         for (auto &el : header.elements) {
             size_t size = el.struct_->size();
@@ -166,54 +509,95 @@ public:
                 }
 
                 /* Allocate memory for vertices (+1 unused entry) */
-                m_vertices = VertexHolder(new uint8_t[(el.count + 1) * o_struct_size]);
+                m_vertices = detail::alloc_mesh_buffer((el.count + 1) * o_struct_size);
 
                 /* Clear unused entry */
                 memset(m_vertices.get() + o_struct_size * el.count, 0, o_struct_size);
 
-                size_t packet_count     = el.count / elements_per_packet;
-                size_t remainder_count  = el.count % elements_per_packet;
-                size_t i_packet_size    = i_struct_size * elements_per_packet;
-                size_t i_remainder_size = i_struct_size * remainder_count;
-
-                std::unique_ptr<uint8_t[]> buf(new uint8_t[i_packet_size]);
                 uint8_t *target = (uint8_t *) m_vertices.get();
 
-                for (size_t i = 0; i <= packet_count; ++i) {
-                    size_t psize = (i != packet_count) ? i_packet_size : i_remainder_size;
-                    size_t count = (i != packet_count) ? elements_per_packet : remainder_count;
-
-                    stream->read(buf.get(), psize);
-                    if (unlikely(!conv->convert(count, buf.get(), target)))
+                if (mmap_file) {
+                    size_t i_total_size = i_struct_size * el.count;
+                    if (unlikely(i_total_size > body_remaining))
+                        fail("file is too small -- truncated vertex data?");
+
+                    if (layout_matches(el.struct_, m_vertex_struct)) {
+                        /* The file layout matches the in-memory layout --
+                           ingest all records with a single copy */
+                        memcpy(target, body, i_total_size);
+                    } else if (unlikely(!conv->convert_parallel(el.count,
+                                                                body, target))) {
                         fail("incompatible contents -- is this a triangle mesh?");
+                    }
 
-                    if (!has_vertex_normals) {
-                        for (size_t j = 0; j < count; ++j) {
-                            InputPoint3f p = enoki::load<InputPoint3f>(target);
-                            p = m_to_world.transform_affine(p);
-                            if (unlikely(!all(enoki::isfinite(p))))
-                                fail("mesh contains invalid vertex positions/normal data");
-                            m_bbox.expand(p);
-                            enoki::store_unaligned(target, p);
-                            target += o_struct_size;
-                        }
-                    } else {
-                        for (size_t j = 0; j < count; ++j) {
-                            InputPoint3f p = enoki::load<InputPoint3f>(target);
-                            InputNormal3f n =
-                                enoki::load<InputNormal3f>(target + sizeof(InputFloat) * 3);
-                            n = normalize(m_to_world.transform_affine(n));
-                            p = m_to_world.transform_affine(p);
-                            if (unlikely(!all(enoki::isfinite(p) && enoki::isfinite(n))))
-                                fail("mesh contains invalid vertex positions/normal data");
-                            m_bbox.expand(p);
-                            enoki::store_unaligned(target, p);
-                            enoki::store_unaligned(target + sizeof(InputFloat) * 3, n);
-                            target += o_struct_size;
-                        }
+                    body += i_total_size;
+                    body_remaining -= i_total_size;
+                } else {
+                    size_t packet_count     = el.count / elements_per_packet;
+                    size_t remainder_count  = el.count % elements_per_packet;
+                    size_t i_packet_size    = i_struct_size * elements_per_packet;
+                    size_t o_packet_size    = o_struct_size * elements_per_packet;
+                    size_t i_remainder_size = i_struct_size * remainder_count;
+
+                    std::unique_ptr<uint8_t[]> buf(new uint8_t[i_packet_size]);
+                    uint8_t *out = target;
+
+                    for (size_t i = 0; i <= packet_count; ++i) {
+                        size_t psize = (i != packet_count) ? i_packet_size : i_remainder_size;
+                        size_t count = (i != packet_count) ? elements_per_packet : remainder_count;
+
+                        stream->read(buf.get(), psize);
+                        if (unlikely(!conv->convert(count, buf.get(), out)))
+                            fail("incompatible contents -- is this a triangle mesh?");
+
+                        out += o_packet_size;
                     }
                 }
 
+                /* Apply the object-to-world transformation and compute the
+                   bounding box, processing disjoint ranges in parallel */
+                std::mutex bbox_mutex;
+                std::atomic<bool> values_valid(true);
+                tbb::parallel_for(
+                    tbb::blocked_range<size_t>(0, el.count, elements_per_task),
+                    [&](const tbb::blocked_range<size_t> &range) {
+                        BoundingBox<InputPoint3f> bbox;
+                        uint8_t *t = target + range.begin() * o_struct_size;
+
+                        if (!has_vertex_normals) {
+                            for (size_t j = range.begin(); j != range.end(); ++j) {
+                                InputPoint3f p = enoki::load<InputPoint3f>(t);
+                                p = m_to_world.transform_affine(p);
+                                if (unlikely(!all(enoki::isfinite(p))))
+                                    values_valid = false;
+                                bbox.expand(p);
+                                enoki::store_unaligned(t, p);
+                                t += o_struct_size;
+                            }
+                        } else {
+                            for (size_t j = range.begin(); j != range.end(); ++j) {
+                                InputPoint3f p = enoki::load<InputPoint3f>(t);
+                                InputNormal3f n =
+                                    enoki::load<InputNormal3f>(t + sizeof(InputFloat) * 3);
+                                n = normalize(m_to_world.transform_affine(n));
+                                p = m_to_world.transform_affine(p);
+                                if (unlikely(!all(enoki::isfinite(p) && enoki::isfinite(n))))
+                                    values_valid = false;
+                                bbox.expand(p);
+                                enoki::store_unaligned(t, p);
+                                enoki::store_unaligned(t + sizeof(InputFloat) * 3, n);
+                                t += o_struct_size;
+                            }
+                        }
+
+                        std::lock_guard<std::mutex> guard(bbox_mutex);
+                        m_bbox.expand(bbox.min);
+                        m_bbox.expand(bbox.max);
+                    });
+
+                if (unlikely(!values_valid))
+                    fail("mesh contains invalid vertex positions/normal data");
+
                 m_vertex_count = (ScalarSize) el.count;
                 m_vertex_size = (ScalarSize) o_struct_size;
             } else if (el.name == "face") {
@@ -240,37 +624,61 @@ public:
                     fail(e.what());
                 }
 
-                m_faces = FaceHolder(new uint8_t[(el.count + 1) * o_struct_size]);
-
-                size_t packet_count     = el.count / elements_per_packet;
-                size_t remainder_count  = el.count % elements_per_packet;
-                size_t i_packet_size    = i_struct_size * elements_per_packet;
-                size_t o_packet_size    = o_struct_size * elements_per_packet;
-                size_t i_remainder_size = i_struct_size * remainder_count;
-
-                std::unique_ptr<uint8_t[]> buf(new uint8_t[i_packet_size]);
+                m_faces = detail::alloc_mesh_buffer((el.count + 1) * o_struct_size);
                 uint8_t *target = (uint8_t *) m_faces.get();
 
-                for (size_t i = 0; i <= packet_count; ++i) {
-                    size_t psize = (i != packet_count) ? i_packet_size : i_remainder_size;
-                    size_t count = (i != packet_count) ? elements_per_packet : remainder_count;
+                if (mmap_file) {
+                    size_t i_total_size = i_struct_size * el.count;
+                    if (unlikely(i_total_size > body_remaining))
+                        fail("file is too small -- truncated face data?");
 
-                    stream->read(buf.get(), psize);
-                    if (unlikely(!conv->convert(count, buf.get(), target)))
+                    /* A verbatim copy is never possible here (the list count
+                       field must be stripped), but the conversion can still
+                       run in parallel on the mapped data */
+                    if (unlikely(!conv->convert_parallel(el.count, body, target)))
                         fail("incompatible contents -- is this a triangle mesh?");
 
-                    target += o_packet_size;
+                    body += i_total_size;
+                    body_remaining -= i_total_size;
+                } else {
+                    size_t packet_count     = el.count / elements_per_packet;
+                    size_t remainder_count  = el.count % elements_per_packet;
+                    size_t i_packet_size    = i_struct_size * elements_per_packet;
+                    size_t o_packet_size    = o_struct_size * elements_per_packet;
+                    size_t i_remainder_size = i_struct_size * remainder_count;
+
+                    std::unique_ptr<uint8_t[]> buf(new uint8_t[i_packet_size]);
+
+                    for (size_t i = 0; i <= packet_count; ++i) {
+                        size_t psize = (i != packet_count) ? i_packet_size : i_remainder_size;
+                        size_t count = (i != packet_count) ? elements_per_packet : remainder_count;
+
+                        stream->read(buf.get(), psize);
+                        if (unlikely(!conv->convert(count, buf.get(), target)))
+                            fail("incompatible contents -- is this a triangle mesh?");
+
+                        target += o_packet_size;
+                    }
                 }
 
                 m_face_count = (ScalarSize) el.count;
                 m_face_size = (ScalarSize) o_struct_size;
             } else {
                 Log(Warn, "\"%s\": Skipping unknown element \"%s\"", m_name, el.name);
-                stream->seek(stream->tell() + size * el.count);
+                if (mmap_file) {
+                    size_t skip = size * el.count;
+                    if (unlikely(skip > body_remaining))
+                        fail("file is too small -- truncated element data?");
+                    body += skip;
+                    body_remaining -= skip;
+                } else {
+                    stream->seek(stream->tell() + size * el.count);
+                }
             }
         }
 
-        if (stream->tell() != stream->size())
+        if (mmap_file ? (body_remaining != 0)
+                      : (stream->tell() != stream->size()))
             fail("invalid file -- trailing content");
 
         Log(Debug, "\"%s\": read %i faces, %i vertices (%s in %s)",
@@ -283,6 +691,24 @@ public:
         if (!m_disable_vertex_normals && !has_vertex_normals)
             recompute_vertex_normals();
 
+        /* Reorder before the cache is written so that subsequent runs load
+           the optimized layout directly */
+        if (m_reorder)
+            reorder_layout();
+
+        if (use_cache) {
+            write_cache(cache_path, source_hash);
+            /* When loading out of core, immediately swap the heap buffers
+               for file-backed ones so this first run also sheds memory */
+            if (m_out_of_core)
+                read_cache(cache_path, source_hash);
+        }
+
+        if (m_compress_attributes)
+            compress_vertex_attributes();
+
+        load_vertex_motion(props);
+
         if (is_emitter())
             emitter()->set_shape(this);
     }
@@ -370,245 +796,6 @@ public:
         );
     }
 
-private:
-    PLYHeader parse_ply_header(Stream *stream) {
-        Struct::ByteOrder byte_order = Struct::host_byte_order();
-        bool ply_tag_seen = false;
-        bool header_processed = false;
-        PLYHeader header;
-
-        std::unordered_map<std::string, Struct::Type> fmt_map;
-        fmt_map["char"]   = Struct::Type::Int8;
-        fmt_map["uchar"]  = Struct::Type::UInt8;
-        fmt_map["short"]  = Struct::Type::Int16;
-        fmt_map["ushort"] = Struct::Type::UInt16;
-        fmt_map["int"]    = Struct::Type::Int32;
-        fmt_map["uint"]   = Struct::Type::UInt32;
-        fmt_map["float"]  = Struct::Type::Float32;
-        fmt_map["double"] = Struct::Type::Float64;
-
-        /* Unofficial extensions :) */
-        fmt_map["uint8"]   = Struct::Type::UInt8;
-        fmt_map["uint16"]  = Struct::Type::UInt16;
-        fmt_map["uint32"]  = Struct::Type::UInt32;
-        fmt_map["int8"]    = Struct::Type::Int8;
-        fmt_map["int16"]   = Struct::Type::Int16;
-        fmt_map["int32"]   = Struct::Type::Int32;
-        fmt_map["long"]    = Struct::Type::Int64;
-        fmt_map["ulong"]   = Struct::Type::UInt64;
-        fmt_map["half"]    = Struct::Type::Float16;
-        fmt_map["float16"] = Struct::Type::Float16;
-        fmt_map["float32"] = Struct::Type::Float32;
-        fmt_map["float64"] = Struct::Type::Float64;
-
-        ref<Struct> struct_;
-
-        while (true) {
-            std::string line = stream->read_line();
-            std::istringstream iss(line);
-            std::string token;
-            if (!(iss >> token))
-                continue;
-
-            if (token == "comment") {
-                std::getline(iss, line);
-                header.comments.push_back(string::trim(line));
-                continue;
-            } else if (token == "ply") {
-                if (ply_tag_seen)
-                    Throw("invalid PLY header: duplicate \"ply\" tag");
-                ply_tag_seen = true;
-                if (iss >> token)
-                    Throw("invalid PLY header: excess tokens after \"ply\"");
-            } else if (token == "format") {
-                if (!ply_tag_seen)
-                    Throw("invalid PLY header: \"format\" before \"ply\" tag");
-                if (header_processed)
-                    Throw("invalid PLY header: duplicate \"format\" tag");
-                if (!(iss >> token))
-                    Throw("invalid PLY header: missing token after \"format\"");
-                if (token == "ascii")
-                    header.ascii = true;
-                else if (token == "binary_little_endian")
-                    byte_order = Struct::ByteOrder::LittleEndian;
-                else if (token == "binary_big_endian")
-                    byte_order = Struct::ByteOrder::BigEndian;
-                else
-                    Throw("invalid PLY header: invalid token after \"format\"");
-                if (!(iss >> token))
-                    Throw("invalid PLY header: missing version number after \"format\"");
-                if (token != "1.0")
-                    Throw("PLY file has unknown version number \"%s\"", token);
-                if (iss >> token)
-                    Throw("invalid PLY header: excess tokens after \"format\"");
-                header_processed = true;
-            } else if (token == "element") {
-                if (!(iss >> token))
-                    Throw("invalid PLY header: missing token after \"element\"");
-                header.elements.emplace_back();
-                auto &element = header.elements.back();
-                element.name = token;
-                if (!(iss >> token))
-                    Throw("invalid PLY header: missing token after \"element\"");
-                element.count = (size_t) stoull(token);
-                struct_ = element.struct_ = new Struct(true, byte_order);
-            } else if (token == "property") {
-                if (!header_processed)
-                    Throw("invalid PLY header: encountered \"property\" before \"format\"");
-                if (header.elements.empty())
-                    Throw("invalid PLY header: encountered \"property\" before \"element\"");
-                if (!(iss >> token))
-                    Throw("invalid PLY header: missing token after \"property\"");
-
-                if (token == "list") {
-                    if (!(iss >> token))
-                        Throw("invalid PLY header: missing token after \"property list\"");
-                    auto it1 = fmt_map.find(token);
-                    if (it1 == fmt_map.end())
-                        Throw("invalid PLY header: unknown format type \"%s\"", token);
-
-                    if (!(iss >> token))
-                        Throw("invalid PLY header: missing token after \"property list\"");
-                    auto it2 = fmt_map.find(token);
-                    if (it2 == fmt_map.end())
-                        Throw("invalid PLY header: unknown format type \"%s\"", token);
-
-                    if (!(iss >> token))
-                        Throw("invalid PLY header: missing token after \"property list\"");
-
-                    struct_->append(token + ".count", it1->second, +Struct::Flags::Assert, 3);
-                    for (int i = 0; i<3; ++i)
-                        struct_->append(tfm::format("i%i", i), it2->second);
-                } else {
-                    auto it = fmt_map.find(token);
-                    if (it == fmt_map.end())
-                        Throw("invalid PLY header: unknown format type \"%s\"", token);
-                    if (!(iss >> token))
-                        Throw("invalid PLY header: missing token after \"property\"");
-                    uint32_t flags = +Struct::Flags::None;
-                    if (it->second >= Struct::Type::Int8 &&
-                        it->second <= Struct::Type::UInt64)
-                        flags = Struct::Flags::Normalized | Struct::Flags::Gamma;
-                    struct_->append(token, it->second, flags);
-                }
-
-                if (iss >> token)
-                    Throw("invalid PLY header: excess tokens after \"property\"");
-            } else if (token == "end_header") {
-                if (iss >> token)
-                    Throw("invalid PLY header: excess tokens after \"end_header\"");
-                break;
-            } else {
-                Throw("invalid PLY header: unknown token \"%s\"", token);
-            }
-        }
-        if (!header_processed)
-            Throw("invalid PLY file: no header information");
-        return header;
-    }
-
-    ref<Stream> parse_ascii(FileStream *in, const std::vector<PLYElement> &elements) {
-        ref<Stream> out = new MemoryStream();
-        std::fstream &is = *in->native();
-        for (auto const &el : elements) {
-            for (size_t i = 0; i < el.count; ++i) {
-                for (auto const &field : *(el.struct_)) {
-                    switch (field.type) {
-                        case Struct::Type::Int8: {
-                                int value;
-                                if (!(is >> value)) Throw("Could not parse \"char\" value for field %s", field.name);
-                                if (value < -128 || value > 127)
-                                    Throw("Could not parse \"char\" value for field %s", field.name);
-                                out->write((int8_t) value);
-                            }
-                            break;
-
-                        case Struct::Type::UInt8: {
-                                int value;
-                                if (!(is >> value))
-                                    Throw("Could not parse \"uchar\" value for field %s (may be due to non-triangular faces)", field.name);
-                                if (value < 0 || value > 255)
-                                    Throw("Could not parse \"uchar\" value for field %s (may be due to non-triangular faces)", field.name);
-                                out->write((uint8_t) value);
-                            }
-                            break;
-
-                        case Struct::Type::Int16: {
-                                int16_t value;
-                                if (!(is >> value)) Throw("Could not parse \"short\" value for field %s", field.name);
-                                out->write(value);
-                            }
-                            break;
-
-                        case Struct::Type::UInt16: {
-                                uint16_t value;
-                                if (!(is >> value)) Throw("Could not parse \"ushort\" value for field %s", field.name);
-                                out->write(value);
-                            }
-                            break;
-
-                        case Struct::Type::Int32: {
-                                int32_t value;
-                                if (!(is >> value)) Throw("Could not parse \"int\" value for field %s", field.name);
-                                out->write(value);
-                            }
-                            break;
-
-                        case Struct::Type::UInt32: {
-                                uint32_t value;
-                                if (!(is >> value)) Throw("Could not parse \"uint\" value for field %s", field.name);
-                                out->write(value);
-                            }
-                            break;
-
-                        case Struct::Type::Int64: {
-                                int64_t value;
-                                if (!(is >> value)) Throw("Could not parse \"long\" value for field %s", field.name);
-                                out->write(value);
-                            }
-                            break;
-
-                        case Struct::Type::UInt64: {
-                                uint64_t value;
-                                if (!(is >> value)) Throw("Could not parse \"ulong\" value for field %s", field.name);
-                                out->write(value);
-                            }
-                            break;
-
-                        case Struct::Type::Float16: {
-                                float value;
-                                if (!(is >> value)) Throw("Could not parse \"half\" value for field %s", field.name);
-                                out->write(enoki::half::float32_to_float16(value));
-                            }
-                            break;
-
-                        case Struct::Type::Float32: {
-                                float value;
-                                if (!(is >> value)) Throw("Could not parse \"float\" value for field %s", field.name);
-                                out->write(value);
-                            }
-                            break;
-
-                        case Struct::Type::Float64: {
-                                double value;
-                                if (!(is >> value)) Throw("Could not parse \"double\" value for field %s", field.name);
-                                out->write(value);
-                            }
-                            break;
-
-                        default:
-                            Throw("internal error");
-                    }
-                }
-            }
-        }
-        std::string token;
-        if (is >> token)
-            Throw("Trailing tokens after end of PLY file");
-        out->seek(0);
-        return out;
-    }
-
     MTS_DECLARE_CLASS()
 };
 
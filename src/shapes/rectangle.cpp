@@ -10,6 +10,10 @@
 #include <mitsuba/render/interaction.h>
 #include <mitsuba/render/shape.h>
 
+#if defined(MTS_ENABLE_EMBREE)
+#  include <embree3/rtcore.h>
+#endif
+
 NAMESPACE_BEGIN(mitsuba)
 
 /**!
@@ -24,6 +28,13 @@ Rectangle (:monosp:`rectangle`)
  * - flip_normals
    - |bool|
    - Is the rectangle inverted, i.e. should the normal vectors be flipped? (Default: |false|)
+ * - portal
+   - |bool|
+   - Mark the rectangle as an emitter portal, i.e. an opening through which an
+     :ref:`environment emitter <emitter-envmap>` illuminates an otherwise enclosed
+     scene. Environment direction sampling is then restricted to the portal
+     geometry. Combine with a :monosp:`null` BSDF if the portal should not block
+     light itself. (Default: |false|)
  * - to_world
    - |transform|
    - Specifies a linear object-to-world transformation. It is allowed to use non-uniform scaling,
@@ -61,7 +72,7 @@ The following XML snippet showcases a simple example of a textured rectangle:
         </bsdf>
     </shape>
 
-.. warning:: This plugin is currently not supported by the Embree and OptiX raytracing backend.
+.. warning:: This plugin is currently not supported by the OptiX raytracing backend.
 
  */
 
@@ -95,6 +106,10 @@ public:
             Throw("The `to_world` transformation contains shear, which is not"
                   " supported by the Rectangle shape.");
 
+#if defined(MTS_ENABLE_EMBREE)
+        update_embree_data();
+#endif
+
         if (is_emitter())
             emitter()->set_shape(this);
     }
@@ -136,31 +151,144 @@ public:
         return m_inv_surface_area;
     }
 
+    /**
+     * \brief Precomputed quantities for the area-preserving spherical
+     * rectangle parameterization of Urena et al., "An Area-Preserving
+     * Parametrization for Spherical Rectangles" (EGSR 2013)
+     *
+     * All quantities are expressed in a local frame that is aligned with the
+     * rectangle's edges and oriented so that the rectangle lies on the
+     * negative Z side of the reference point.
+     */
+    struct SphericalRectangle {
+        Float x0, x1, y0, y1;       ///< Rectangle extents in the local frame
+        Float z0, z0_2, y0_2, y1_2; ///< Plane offset and squared terms
+        Float z_off;                ///< Signed plane offset in the world frame
+        Float b0, b1, b0_2, k;      ///< Sampling constants
+        Float solid_angle;          ///< Solid angle subtended by the rectangle
+    };
+
+    SphericalRectangle spherical_rectangle(const Point3f &ref) const {
+        SphericalRectangle sr;
+
+        ScalarPoint3f corner =
+            m_object_to_world.transform_affine(ScalarPoint3f(-1.f, -1.f, 0.f));
+        Vector3f d = Point3f(corner) - ref;
+
+        sr.x0 = dot(d, Vector3f(m_frame.s));
+        sr.y0 = dot(d, Vector3f(m_frame.t));
+        sr.x1 = sr.x0 + m_du;
+        sr.y1 = sr.y0 + m_dv;
+
+        // Orient the local frame so that the plane lies below the reference point
+        sr.z_off = dot(d, Vector3f(m_frame.n));
+        sr.z0   = -abs(sr.z_off);
+        sr.z0_2 = sqr(sr.z0);
+        sr.y0_2 = sqr(sr.y0);
+        sr.y1_2 = sqr(sr.y1);
+
+        Vector3f v00(sr.x0, sr.y0, sr.z0), v01(sr.x0, sr.y1, sr.z0),
+                 v10(sr.x1, sr.y0, sr.z0), v11(sr.x1, sr.y1, sr.z0);
+
+        // Normals of the planes through the reference point and each edge
+        Vector3f n0 = normalize(cross(v00, v10)), n1 = normalize(cross(v10, v11)),
+                 n2 = normalize(cross(v11, v01)), n3 = normalize(cross(v01, v00));
+
+        // Interior dihedral angles of the spherical rectangle
+        Float g0 = safe_acos(-dot(n0, n1)), g1 = safe_acos(-dot(n1, n2)),
+              g2 = safe_acos(-dot(n2, n3)), g3 = safe_acos(-dot(n3, n0));
+
+        sr.b0   = n0.z();
+        sr.b1   = n2.z();
+        sr.b0_2 = sqr(sr.b0);
+        sr.k    = 2.f * math::Pi<Float> - g2 - g3;
+        sr.solid_angle = g0 + g1 - sr.k;
+
+        return sr;
+    }
+
     DirectionSample3f sample_direction(const Interaction3f &it, const Point2f &sample,
                                        Mask active) const override {
         MTS_MASK_ARGUMENT(active);
 
-        DirectionSample3f ds = sample_position(it.time, sample, active);
-        ds.d = ds.p - it.p;
+        SphericalRectangle sr = spherical_rectangle(it.p);
+
+        /* The parameterization degenerates for reference points that are
+           (nearly) in the plane of the rectangle -- fall back to area
+           sampling reweighted by the distance there. */
+        Mask valid = active && sr.solid_angle > math::RayEpsilon<Float> &&
+                     enoki::isfinite(sr.solid_angle);
+
+        DirectionSample3f result = zero<DirectionSample3f>();
+
+        if (likely(any(valid))) {
+            // Sample the longitudinal arc, then invert the CDF along 'x'
+            Float au = fmadd(sample.x(), sr.solid_angle, sr.k);
+            auto [sin_au, cos_au] = sincos(au);
+            Float fu = (cos_au * sr.b0 - sr.b1) / sin_au,
+                  cu = clamp(mulsign(rsqrt(sqr(fu) + sr.b0_2), fu), -1.f, 1.f),
+                  xu = clamp(-cu * sr.z0 * rsqrt(fnmadd(cu, cu, 1.f)),
+                             sr.x0, sr.x1);
+
+            // Sample the latitudinal arc conditioned on 'xu'
+            Float d2 = sqr(xu) + sr.z0_2,
+                  h0 = sr.y0 * rsqrt(d2 + sr.y0_2),
+                  h1 = sr.y1 * rsqrt(d2 + sr.y1_2),
+                  hv = fmadd(sample.y(), h1 - h0, h0),
+                  yv = select(sqr(hv) < math::OneMinusEpsilon<Float>,
+                              hv * sqrt(d2) * rsqrt(fnmadd(hv, hv, 1.f)),
+                              sr.y1);
+
+            DirectionSample3f ds = zero<DirectionSample3f>();
+            ds.p   = it.p + Vector3f(m_frame.s) * xu + Vector3f(m_frame.t) * yv +
+                     Vector3f(m_frame.n) * sr.z_off;
+            ds.n   = m_frame.n;
+            ds.uv  = Point2f((xu - sr.x0) / m_du, (yv - sr.y0) / m_dv);
+            ds.d   = ds.p - it.p;
+
+            Float dist_squared = squared_norm(ds.d);
+            ds.dist = sqrt(dist_squared);
+            ds.d   /= ds.dist;
+            ds.pdf  = rcp(sr.solid_angle);
+            masked(ds.pdf, ds.dist == 0.f) = 0.f;
+
+            result[valid] = ds;
+        }
+
+        Mask fallback = andnot(active, valid);
+        if (unlikely(any(fallback))) {
+            DirectionSample3f ds = sample_position(it.time, sample, fallback);
+            ds.d = ds.p - it.p;
+
+            Float dist_squared = squared_norm(ds.d);
+            ds.dist  = sqrt(dist_squared);
+            ds.d    /= ds.dist;
 
-        Float dist_squared = squared_norm(ds.d);
-        ds.dist  = sqrt(dist_squared);
-        ds.d    /= ds.dist;
+            Float dp = abs_dot(ds.d, ds.n);
+            ds.pdf *= select(neq(dp, 0.f), dist_squared / dp, Float(0.f));
+
+            result[fallback] = ds;
+        }
 
-        Float dp = abs_dot(ds.d, ds.n);
-        ds.pdf *= select(neq(dp, 0.f), dist_squared / dp, Float(0.f));
+        result.time = it.time;
+        result.delta = false;
 
-        return ds;
+        return result;
     }
 
-    Float pdf_direction(const Interaction3f & /*it*/, const DirectionSample3f &ds,
+    Float pdf_direction(const Interaction3f &it, const DirectionSample3f &ds,
                         Mask active) const override {
         MTS_MASK_ARGUMENT(active);
 
-        Float pdf = pdf_position(ds, active),
-              dp  = abs_dot(ds.d, ds.n);
+        SphericalRectangle sr = spherical_rectangle(it.p);
+        Mask valid = sr.solid_angle > math::RayEpsilon<Float> &&
+                     enoki::isfinite(sr.solid_angle);
 
-        return pdf * select(neq(dp, 0.f), (ds.dist * ds.dist) / dp, 0.f);
+        Float dp = abs_dot(ds.d, ds.n),
+              area_pdf = m_inv_surface_area *
+                         select(neq(dp, 0.f), (ds.dist * ds.dist) / dp, 0.f);
+
+        return select(valid, rcp(sr.solid_angle), area_pdf);
     }
 
     //! @}
@@ -170,7 +298,7 @@ public:
     //! @{ \name Ray tracing routines
     // =============================================================
 
-    std::pair<Mask, Float> ray_intersect(const Ray3f &ray_, Float *cache,
+    std::pair<Mask, Float> ray_intersect(const Ray3f &ray_, Float * /*cache*/,
                                          Mask active) const override {
         MTS_MASK_ARGUMENT(active);
 
@@ -186,11 +314,6 @@ public:
 
         t = select(active, t, Float(math::Infinity<Float>));
 
-        if (cache) {
-            masked(cache[0], active) = local.x();
-            masked(cache[1], active) = local.y();
-        }
-
         return { active, t };
     }
 
@@ -208,7 +331,7 @@ public:
                       && abs(local.y()) <= 1.f;
     }
 
-    void fill_surface_interaction(const Ray3f &ray, const Float *cache,
+    void fill_surface_interaction(const Ray3f &ray, const Float * /*cache*/,
                                   SurfaceInteraction3f &si_out, Mask active) const override {
         MTS_MASK_ARGUMENT(active);
 
@@ -220,8 +343,13 @@ public:
         si.dp_dv      = m_dv * m_frame.t;
         si.p          = ray(si.t);
         si.time       = ray.time;
-        si.uv         = Point2f(fmadd(cache[0], .5f, .5f),
-                                fmadd(cache[1], .5f, .5f));
+
+        /* Recompute the local hit coordinates from the hit position -- the
+           various intersection backends do not report them in a common
+           format */
+        Point3f local = m_world_to_object.transform_affine(si.p);
+        si.uv         = Point2f(fmadd(local.x(), .5f, .5f),
+                                fmadd(local.y(), .5f, .5f));
 
         si_out[active] = si;
     }
@@ -232,6 +360,20 @@ public:
         return { Vector3f(0.f), Vector3f(0.f) };
     }
 
+#if defined(MTS_ENABLE_EMBREE)
+    RTCGeometry embree_geometry(RTCDevice device) const override {
+        RTCGeometry geom = rtcNewGeometry(device, RTC_GEOMETRY_TYPE_QUAD);
+        rtcSetSharedGeometryBuffer(geom, RTC_BUFFER_TYPE_VERTEX, 0,
+                                   RTC_FORMAT_FLOAT3, m_embree_vertices, 0,
+                                   4 * sizeof(float), 4);
+        rtcSetSharedGeometryBuffer(geom, RTC_BUFFER_TYPE_INDEX, 0,
+                                   RTC_FORMAT_UINT4, m_embree_indices, 0,
+                                   4 * sizeof(uint32_t), 1);
+        rtcCommitGeometry(geom);
+        return geom;
+    }
+#endif
+
     ScalarSize primitive_count() const override { return 1; }
 
     ScalarSize effective_primitive_count() const override { return 1; }
@@ -249,6 +391,9 @@ public:
                             ScalarTransform4f::scale(ScalarVector3f(0.5f * m_du, 0.5f * m_dv, 1.f));
         m_world_to_object = m_object_to_world.inverse();
         m_inv_surface_area = 1.f / surface_area();
+#if defined(MTS_ENABLE_EMBREE)
+        update_embree_data();
+#endif
     }
 
     std::string to_string() const override {
@@ -264,11 +409,33 @@ public:
 
     MTS_DECLARE_CLASS()
 private:
+#if defined(MTS_ENABLE_EMBREE)
+    void update_embree_data() {
+        ScalarPoint3f corners[4] = {
+            m_object_to_world.transform_affine(ScalarPoint3f(-1.f, -1.f, 0.f)),
+            m_object_to_world.transform_affine(ScalarPoint3f( 1.f, -1.f, 0.f)),
+            m_object_to_world.transform_affine(ScalarPoint3f( 1.f,  1.f, 0.f)),
+            m_object_to_world.transform_affine(ScalarPoint3f(-1.f,  1.f, 0.f))
+        };
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 3; ++j)
+                m_embree_vertices[i][j] = (float) corners[i][j];
+            m_embree_vertices[i][3] = 0.f; // Padding for 16-byte SSE loads
+        }
+    }
+#endif
+
     ScalarTransform4f m_object_to_world;
     ScalarTransform4f m_world_to_object;
     ScalarFrame3f m_frame;
     ScalarFloat m_du, m_dv;
     ScalarFloat m_inv_surface_area;
+
+#if defined(MTS_ENABLE_EMBREE)
+    /// Quad data shared with the Embree BVH
+    float m_embree_vertices[4][4];
+    uint32_t m_embree_indices[4] = { 0, 1, 2, 3 };
+#endif
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(Rectangle, Shape)
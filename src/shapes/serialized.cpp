@@ -5,6 +5,7 @@
 #include <mitsuba/core/fresolver.h>
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/timer.h>
+#include <algorithm>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -24,11 +25,26 @@ Serialized mesh loader (:monosp:`serialized`)
    - |int|
    - A :monosp:`.serialized` file may contain several separate meshes. This parameter
      specifies which one should be loaded. (Default: 0, i.e. the first one)
+ * - filename_end
+   - |string|
+   - Optional filename of a second :monosp:`.serialized` file with identical
+     connectivity that holds the vertex positions at shutter close. When
+     specified, rays intersect the mesh at their associated time by linearly
+     interpolating the two position samples (*deformation motion blur*).
+ * - motion_time_begin, motion_time_end
+   - |float|
+   - Times associated with the two vertex position samples; ray times
+     outside of this interval are clamped. (Default: 0 and 1)
  * - face_normals
    - |bool|
    - When set to |true|, any existing or computed vertex normals are
      discarded and \emph{face normals} will instead be used during rendering.
      This gives the rendered object a faceted appearance.(Default: |false|)
+ * - compress_attributes
+   - |bool|
+   - When set to |true|, vertex normals are stored octahedral-encoded in two
+     16-bit integers and texture coordinates in half precision, reducing the
+     memory footprint of large meshes. (Default: |false|)
  * - to_world
    - |transform|
    - Specifies an optional linear object-to-world transformation.
@@ -60,11 +76,14 @@ follows:
         * - :monosp:`uint16`
           - File format identifier: :code:`0x041C`
         * - :monosp:`uint16`
-          - File version identifier. Currently set to :code:`0x0004`
+          - File version identifier. Currently set to :code:`0x0004`. A value of :code:`0x0005`
+            denotes the same layout, but with :monosp:`zstd`-compressed payloads (see below).
         * - :math:`\rightarrow`
-          - From this point on, the stream is compressed by the :monosp:`DEFLATE` algorithm.
+          - From this point on, the stream is compressed by the :monosp:`DEFLATE` algorithm
+            (version :code:`0x0004` and earlier) or by :monosp:`zstd` (version :code:`0x0005`,
+            which decompresses several times faster on large meshes).
         * - :math:`\rightarrow`
-          - The used encoding is that of the :monosp:`zlib` library.
+          - For :monosp:`DEFLATE`, the used encoding is that of the :monosp:`zlib` library.
         * - :monosp:`uint32`
           - An 32-bit integer whose bits can be used to specify the following flags:
 
@@ -138,6 +157,9 @@ at the end of the file, which specifies the starting position of each sub-mesh:
 #define MTS_FILEFORMAT_HEADER     0x041C
 #define MTS_FILEFORMAT_VERSION_V3 0x0003
 #define MTS_FILEFORMAT_VERSION_V4 0x0004
+/* Identical layout to V4, but the per-mesh payloads are compressed with
+   zstd instead of zlib's deflate (requires MTS_ENABLE_ZSTD) */
+#define MTS_FILEFORMAT_VERSION_V5 0x0005
 
 template <typename Float, typename Spectrum>
 class SerializedMesh final : public Mesh<Float, Spectrum> {
@@ -146,7 +168,8 @@ public:
                     m_texcoord_offset, m_color_offset, m_name, m_bbox, m_to_world, m_vertex_count,
                     m_face_count, m_vertex_struct, m_face_struct, m_disable_vertex_normals,
                     recompute_vertex_normals, is_emitter, emitter, vertex, has_vertex_normals,
-                    has_vertex_texcoords, vertex_texcoord, vertex_normal, vertex_position)
+                    has_vertex_texcoords, vertex_texcoord, vertex_normal, vertex_position,
+                    compress_vertex_attributes, m_compress_attributes, load_vertex_motion)
     MTS_IMPORT_TYPES()
 
     using typename Base::ScalarSize;
@@ -206,7 +229,8 @@ public:
             fail("encountered an invalid file format!");
 
         if (version != MTS_FILEFORMAT_VERSION_V3 &&
-            version != MTS_FILEFORMAT_VERSION_V4)
+            version != MTS_FILEFORMAT_VERSION_V4 &&
+            version != MTS_FILEFORMAT_VERSION_V5)
             fail("encountered an incompatible file version!");
 
         if (shape_index != 0) {
@@ -225,7 +249,7 @@ public:
                                  shape_index, count - 1));
 
             // Seek to the correct position
-            if (version == MTS_FILEFORMAT_VERSION_V4) {
+            if (version >= MTS_FILEFORMAT_VERSION_V4) {
                 stream->seek(file_size -
                              sizeof(uint64_t) * (count - shape_index) -
                              sizeof(uint32_t));
@@ -243,12 +267,14 @@ public:
             stream->skip(sizeof(short) * 2); // Skip the header
         }
 
-        stream = new ZStream(stream);
+        stream = new ZStream(stream, version >= MTS_FILEFORMAT_VERSION_V5
+                                         ? ZStream::EZstdStream
+                                         : ZStream::EDeflateStream);
         stream->set_byte_order(Stream::ELittleEndian);
 
         uint32_t flags = 0;
         stream->read(flags);
-        if (version == MTS_FILEFORMAT_VERSION_V4) {
+        if (version >= MTS_FILEFORMAT_VERSION_V4) {
             char ch = 0;
             m_name = "";
             do {
@@ -291,11 +317,11 @@ public:
 
         m_vertex_size = (ScalarSize) m_vertex_struct->size();
         m_vertex_count = (ScalarSize) vertex_count;
-        m_vertices = VertexHolder(new uint8_t[(m_vertex_count + 1) * m_vertex_size]);
+        m_vertices = detail::alloc_mesh_buffer((m_vertex_count + 1) * (size_t) m_vertex_size);
 
         m_face_size = (ScalarSize) m_face_struct->size();
         m_face_count = (ScalarSize) face_count;
-        m_faces = FaceHolder(new uint8_t[(m_face_count + 1) * m_face_size]);
+        m_faces = detail::alloc_mesh_buffer((m_face_count + 1) * (size_t) m_face_size);
 
         bool double_precision = has_flag(flags, TriMeshFlags::DoublePrecision);
         read_helper(stream, double_precision, m_vertex_struct->offset("x"), 3);
@@ -344,45 +370,77 @@ public:
         if (!m_disable_vertex_normals && !has_flag(flags, TriMeshFlags::HasNormals))
             recompute_vertex_normals();
 
+        if (m_reorder)
+            reorder_layout();
+
+        if (m_compress_attributes)
+            compress_vertex_attributes();
+
+        load_vertex_motion(props);
+
         if (is_emitter())
             emitter()->set_shape(this);
     }
 
+    /**
+     * Number of vertices decompressed per window in \ref read_helper() and
+     * \ref advance_helper(). The vertex buffer is allocated once from the
+     * header counts; attribute streams are then inflated in windows of this
+     * size directly into the interleaved records, which keeps the peak
+     * memory usage during loading bounded by the final mesh footprint
+     * instead of staging each whole attribute array in RAM.
+     */
+    static constexpr size_t elements_per_window = 16384;
+
     void read_helper(Stream *stream, bool dp, size_t offset, size_t dim) {
         if (dp) {
-            std::unique_ptr<double[]> values(new double[m_vertex_count * dim]);
-            stream->read_array(values.get(), m_vertex_count * dim);
-
-            if constexpr (std::is_same_v<ScalarFloat, double>) {
-                for (size_t i = 0; i < m_vertex_count; ++i) {
-                    const double *src = values.get() + dim * i;
-                    double *dst = (double *) (vertex(i) + offset);
-                    memcpy(dst, src, sizeof(double) * dim);
-                }
-            } else {
-                for (size_t i = 0; i < m_vertex_count; ++i) {
-                    const double *src = values.get() + dim * i;
-                    float *dst = (float *) (vertex(i) + offset);
-                    for (size_t d = 0; d < dim; ++d)
-                        dst[d] = (float) src[d];
+            std::unique_ptr<double[]> values(
+                new double[elements_per_window * dim]);
+
+            for (size_t start = 0; start < m_vertex_count;
+                 start += elements_per_window) {
+                size_t count = std::min((size_t) m_vertex_count - start,
+                                        elements_per_window);
+                stream->read_array(values.get(), count * dim);
+
+                if constexpr (std::is_same_v<ScalarFloat, double>) {
+                    for (size_t i = 0; i < count; ++i) {
+                        const double *src = values.get() + dim * i;
+                        double *dst = (double *) (vertex(start + i) + offset);
+                        memcpy(dst, src, sizeof(double) * dim);
+                    }
+                } else {
+                    for (size_t i = 0; i < count; ++i) {
+                        const double *src = values.get() + dim * i;
+                        float *dst = (float *) (vertex(start + i) + offset);
+                        for (size_t d = 0; d < dim; ++d)
+                            dst[d] = (float) src[d];
+                    }
                 }
             }
         } else {
-            std::unique_ptr<float[]> values(new float[m_vertex_count * dim]);
-            stream->read_array(values.get(), m_vertex_count * dim);
-
-            if constexpr (std::is_same_v<ScalarFloat, float>) {
-                for (size_t i = 0; i < m_vertex_count; ++i) {
-                    const float *src = values.get() + dim * i;
-                    void *dst = vertex(i) + offset;
-                    memcpy(dst, src, sizeof(float) * dim);
-                }
-            } else {
-                for (size_t i = 0; i < m_vertex_count; ++i) {
-                    const float *src = values.get() + dim * i;
-                    double *dst = (double *) (vertex(i) + offset);
-                    for (size_t d = 0; d < dim; ++d)
-                        dst[d] = (double) src[d];
+            std::unique_ptr<float[]> values(
+                new float[elements_per_window * dim]);
+
+            for (size_t start = 0; start < m_vertex_count;
+                 start += elements_per_window) {
+                size_t count = std::min((size_t) m_vertex_count - start,
+                                        elements_per_window);
+                stream->read_array(values.get(), count * dim);
+
+                if constexpr (std::is_same_v<ScalarFloat, float>) {
+                    for (size_t i = 0; i < count; ++i) {
+                        const float *src = values.get() + dim * i;
+                        void *dst = vertex(start + i) + offset;
+                        memcpy(dst, src, sizeof(float) * dim);
+                    }
+                } else {
+                    for (size_t i = 0; i < count; ++i) {
+                        const float *src = values.get() + dim * i;
+                        double *dst = (double *) (vertex(start + i) + offset);
+                        for (size_t d = 0; d < dim; ++d)
+                            dst[d] = (double) src[d];
+                    }
                 }
             }
         }
@@ -394,12 +452,23 @@ public:
      * implementations, we have to read and discard the data.
      */
     void advance_helper(Stream *stream, bool dp, size_t dim) {
+        size_t remaining = m_vertex_count * dim;
         if (dp) {
-            std::unique_ptr<double[]> values(new double[m_vertex_count * dim]);
-            stream->read_array(values.get(), m_vertex_count * dim);
+            std::unique_ptr<double[]> values(
+                new double[elements_per_window * dim]);
+            while (remaining > 0) {
+                size_t count = std::min(remaining, elements_per_window * dim);
+                stream->read_array(values.get(), count);
+                remaining -= count;
+            }
         } else {
-            std::unique_ptr<float[]> values(new float[m_vertex_count * dim]);
-            stream->read_array(values.get(), m_vertex_count * dim);
+            std::unique_ptr<float[]> values(
+                new float[elements_per_window * dim]);
+            while (remaining > 0) {
+                size_t count = std::min(remaining, elements_per_window * dim);
+                stream->read_array(values.get(), count);
+                remaining -= count;
+            }
         }
     }
 
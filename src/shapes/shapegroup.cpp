@@ -0,0 +1,214 @@
+#include <mitsuba/core/fwd.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/string.h>
+#include <mitsuba/render/fwd.h>
+#include <mitsuba/render/interaction.h>
+#include <mitsuba/render/kdtree.h>
+#include <mitsuba/render/shape.h>
+
+#if defined(MTS_ENABLE_EMBREE)
+#  include <embree3/rtcore.h>
+#endif
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _shape-shapegroup:
+
+Shape group (:monosp:`shapegroup`)
+-------------------------------------------------
+
+.. pluginparameters::
+
+ * - (Nested plugin)
+   - |shape|
+   - One or more shapes that should be made available for geometry instancing
+
+This plugin implements a container for shapes that should be made available
+for geometry instancing. Any shapes placed in a shapegroup will not be visible
+on their own---instead, the renderer will precompute ray intersection
+acceleration data structures so that they can efficiently be referenced many
+times using the :ref:`instance <shape-instance>` plugin. This is useful for
+rendering things like forests, where only a few distinct types of trees have
+to be kept in memory. An example is given below:
+
+.. code-block:: xml
+
+    <!-- Declare a named shape group containing two objects -->
+    <shape type="shapegroup" id="my_shape_group">
+        <shape type="ply">
+            <string name="filename" value="data.ply"/>
+        </shape>
+        <shape type="sphere"/>
+    </shape>
+
+    <!-- Instantiate the shape group without any kind of transformation -->
+    <shape type="instance">
+        <ref id="my_shape_group"/>
+    </shape>
+
+.. warning:: This plugin is currently not supported by the OptiX raytracing backend.
+
+ */
+
+template <typename Float, typename Spectrum>
+class ShapeGroup final : public Shape<Float, Spectrum> {
+public:
+    MTS_IMPORT_BASE(Shape, m_id)
+    MTS_IMPORT_TYPES(ShapeKDTree)
+
+    using typename Base::ScalarIndex;
+    using typename Base::ScalarSize;
+
+    ShapeGroup(const Properties &props) : Base(Properties()) {
+        m_id = props.id();
+#if !defined(MTS_ENABLE_EMBREE)
+        m_kdtree = new ShapeKDTree(props);
+#endif
+
+        // Add children to the underlying data structure
+        for (auto &kv : props.objects()) {
+            Base *shape = dynamic_cast<Base *>(kv.second.get());
+
+            if (!shape)
+                Throw("Tried to add an unsupported object of type \"%s\"", kv.second);
+
+            const std::string &name = shape->class_()->name();
+            if (name == "Instance" || name == "ShapeGroup")
+                Throw("Nested instancing is not permitted!");
+            if (shape->is_emitter() || shape->is_sensor())
+                Throw("Instancing of emitters and sensors is not supported!");
+
+            m_bbox.expand(shape->bbox());
+            m_shapes.push_back(shape);
+#if !defined(MTS_ENABLE_EMBREE)
+            m_kdtree->add_shape(shape);
+#endif
+        }
+
+        if (m_shapes.empty())
+            Throw("The shape group must contain at least one shape!");
+
+#if !defined(MTS_ENABLE_EMBREE)
+        if (!m_kdtree->ready())
+            m_kdtree->build();
+#endif
+    }
+
+#if defined(MTS_ENABLE_EMBREE)
+    ~ShapeGroup() {
+        if (m_embree_scene)
+            rtcReleaseScene(m_embree_scene);
+    }
+#endif
+
+    // =============================================================
+    //! @{ \name Ray tracing routines
+    // =============================================================
+
+#if defined(MTS_ENABLE_EMBREE)
+    RTCScene embree_scene(RTCDevice device) const override {
+        if (!m_embree_scene) {
+            /* The nested scene is shared by all instances referencing this
+               group; attachment order matches \ref m_shapes, so Embree's
+               geomID directly indexes into that array */
+            m_embree_scene = rtcNewScene(device);
+            for (auto &shape : m_shapes)
+                rtcAttachGeometry(m_embree_scene, shape->embree_geometry(device));
+            rtcCommitScene(m_embree_scene);
+        }
+        return m_embree_scene;
+    }
+
+    RTCGeometry embree_geometry(RTCDevice device) const override {
+        /* The group itself is invisible; an empty placeholder keeps the
+           geomID <-> shape index correspondence of the top-level scene intact */
+        RTCGeometry geom = rtcNewGeometry(device, RTC_GEOMETRY_TYPE_USER);
+        rtcSetGeometryUserPrimitiveCount(geom, 0);
+        rtcCommitGeometry(geom);
+        return geom;
+    }
+#else
+    std::pair<Mask, Float> ray_intersect(const Ray3f &ray, Float *cache,
+                                         Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+        return m_kdtree->template ray_intersect<false>(ray, cache, active);
+    }
+
+    Mask ray_test(const Ray3f &ray, Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+        return m_kdtree->ray_test(ray, active);
+    }
+#endif
+
+    void fill_surface_interaction(const Ray3f &ray, const Float *cache,
+                                  SurfaceInteraction3f &si_out, Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+
+#if defined(MTS_ENABLE_EMBREE)
+        using ShapePtr = replace_scalar_t<Float, const Base *>;
+
+        /* Cache layout (see Scene::ray_intersect_cpu): barycentric/local
+           coordinates first, then the geomID within the nested scene */
+        UInt32 shape_index = reinterpret_array<UInt32>(cache[2]);
+
+        SurfaceInteraction3f si(si_out);
+        si.shape = gather<ShapePtr>(m_shapes.data(), shape_index, active);
+        si.shape->fill_surface_interaction(ray, cache, si, active);
+        si_out[active] = si;
+#else
+        /* The cache was written by the nested kd-tree and can simply be
+           expanded again (prim/shape indices followed by local coordinates) */
+        SurfaceInteraction3f si =
+            m_kdtree->create_surface_interaction(ray, si_out.t, cache, active);
+        si_out[active] = si;
+#endif
+    }
+
+    //! @}
+    // =============================================================
+
+    /// The group is not a part of the visible scene geometry
+    ScalarBoundingBox3f bbox() const override { return ScalarBoundingBox3f(); }
+
+    /**
+     * The shape group has no primitives of its own; this query instead
+     * returns the bounds of the entire (untransformed) group so that
+     * instances can compute their world-space extents.
+     */
+    ScalarBoundingBox3f bbox(ScalarIndex /*index*/) const override { return m_bbox; }
+
+    ScalarSize primitive_count() const override { return 0; }
+
+    ScalarSize effective_primitive_count() const override {
+        ScalarSize count = 0;
+        for (auto &shape : m_shapes)
+            count += shape->primitive_count();
+        return count;
+    }
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "ShapeGroup[" << std::endl
+            << "  id = \"" << m_id << "\"," << std::endl
+            << "  shape_count = " << m_shapes.size() << "," << std::endl
+            << "  bbox = " << string::indent(m_bbox, 9) << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MTS_DECLARE_CLASS()
+private:
+    std::vector<ref<Base>> m_shapes;
+    ScalarBoundingBox3f m_bbox;
+#if defined(MTS_ENABLE_EMBREE)
+    mutable RTCScene m_embree_scene = nullptr;
+#else
+    ref<ShapeKDTree> m_kdtree;
+#endif
+};
+
+MTS_IMPLEMENT_CLASS_VARIANT(ShapeGroup, Shape)
+MTS_EXPORT_PLUGIN(ShapeGroup, "Shape group for geometry instancing");
+NAMESPACE_END(mitsuba)
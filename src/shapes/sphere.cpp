@@ -11,6 +11,10 @@
 #include <mitsuba/render/sensor.h>
 #include <mitsuba/render/shape.h>
 
+#if defined(MTS_ENABLE_EMBREE)
+#  include <embree3/rtcore.h>
+#endif
+
 NAMESPACE_BEGIN(mitsuba)
 
 /**!
@@ -83,7 +87,7 @@ This makes it a good default choice for lighting new scenes.
    :label: fig-sphere-light
 
 
-.. warning:: This plugin is currently not supported by the Embree and OptiX raytracing backend.
+.. warning:: This plugin is currently not supported by the OptiX raytracing backend.
 
  */
 
@@ -122,6 +126,10 @@ public:
             m_flip_normals = !m_flip_normals;
         }
 
+#if defined(MTS_ENABLE_EMBREE)
+        update_embree_data();
+#endif
+
         if (is_emitter())
             emitter()->set_shape(this);
     }
@@ -170,77 +178,71 @@ public:
                                        Mask active) const override {
         MTS_MASK_ARGUMENT(active);
 
-        DirectionSample3f result = zero<DirectionSample3f>();
-
         Vector3f dc_v = m_center - it.p;
-        Float dc_2 = squared_norm(dc_v);
+        Float dc_2   = squared_norm(dc_v),
+              inv_dc = rsqrt(dc_2);
 
         Float radius_adj = m_radius * (m_flip_normals ? (1.f + math::RayEpsilon<Float>) :
                                                         (1.f - math::RayEpsilon<Float>));
-        Mask outside_mask = active && dc_2 > sqr(radius_adj);
-        if (likely(any(outside_mask))) {
-            Float inv_dc            = rsqrt(dc_2),
-                  sin_theta_max     = m_radius * inv_dc,
-                  sin_theta_max_2   = sqr(sin_theta_max),
-                  inv_sin_theta_max = rcp(sin_theta_max),
-                  cos_theta_max     = safe_sqrt(1.f - sin_theta_max_2);
-
-            /* Fall back to a Taylor series expansion for small angles, where
-               the standard approach suffers from severe cancellation errors */
-            Float sin_theta_2 = select(sin_theta_max_2 > 0.00068523f, /* sin^2(1.5 deg) */
-                                       1.f - sqr(fmadd(cos_theta_max - 1.f, sample.x(), 1.f)),
-                                       sin_theta_max_2 * sample.x()),
-                  cos_theta = safe_sqrt(1.f - sin_theta_2);
-
+        Mask outside_mask = dc_2 > sqr(radius_adj);
+
+        /* Both the cone sampling strategy used outside the sphere and the
+           uniform area sampling strategy used inside pick an angle 'alpha'
+           at the sphere's center and a uniform azimuth in a frame aligned
+           with the center-to-reference axis, so the two cases reduce to a
+           blend of the respective angle and density terms. This avoids
+           per-lane branches in the packet variants. */
+        Float sin_theta_max     = m_radius * inv_dc,
+              sin_theta_max_2   = sqr(sin_theta_max),
+              inv_sin_theta_max = rcp(sin_theta_max),
+              cos_theta_max     = safe_sqrt(1.f - sin_theta_max_2);
+
+        /* Fall back to a Taylor series expansion for small angles, where
+           the standard approach suffers from severe cancellation errors */
+        Float sin_theta_2 = select(sin_theta_max_2 > 0.00068523f, /* sin^2(1.5 deg) */
+                                   1.f - sqr(fmadd(cos_theta_max - 1.f, sample.x(), 1.f)),
+                                   sin_theta_max_2 * sample.x()),
+              cos_theta = safe_sqrt(1.f - sin_theta_2);
+
+        Float cos_alpha = select(outside_mask,
             // Based on https://www.akalin.com/sampling-visible-sphere
-            Float cos_alpha = sin_theta_2 * inv_sin_theta_max +
-                              cos_theta * safe_sqrt(fnmadd(sin_theta_2, sqr(inv_sin_theta_max), 1.f)),
-                  sin_alpha = safe_sqrt(fnmadd(cos_alpha, cos_alpha, 1.f));
+            sin_theta_2 * inv_sin_theta_max +
+                cos_theta * safe_sqrt(fnmadd(sin_theta_2, sqr(inv_sin_theta_max), 1.f)),
+            // Uniform sphere sampling, expressed in the same frame
+            fnmadd(2.f, sample.x(), 1.f));
 
-            auto [sin_phi, cos_phi] = sincos(sample.y() * (2.f * math::Pi<Float>));
+        Float sin_alpha = safe_sqrt(fnmadd(cos_alpha, cos_alpha, 1.f));
 
-            Vector3f d = Frame3f(dc_v * -inv_dc).to_world(Vector3f(
-                cos_phi * sin_alpha,
-                sin_phi * sin_alpha,
-                cos_alpha));
+        auto [sin_phi, cos_phi] = sincos(sample.y() * (2.f * math::Pi<Float>));
 
-            DirectionSample3f ds = zero<DirectionSample3f>();
-            ds.p        = fmadd(d, m_radius, m_center);
-            ds.n        = d;
-            ds.d        = ds.p - it.p;
+        Vector3f axis = select(neq(dc_2, 0.f), dc_v * -inv_dc,
+                               Vector3f(0.f, 0.f, 1.f));
+        Vector3f d = Frame3f(axis).to_world(Vector3f(
+            cos_phi * sin_alpha,
+            sin_phi * sin_alpha,
+            cos_alpha));
 
-            Float dist2 = squared_norm(ds.d);
-            ds.dist     = sqrt(dist2);
-            ds.d        = ds.d / ds.dist;
-            ds.pdf      = warp::square_to_uniform_cone_pdf(zero<Vector3f>(), cos_theta_max);
-            masked(ds.pdf, ds.dist == 0.f) = 0.f;
+        DirectionSample3f ds = zero<DirectionSample3f>();
+        ds.p        = fmadd(d, m_radius, m_center);
+        ds.n        = d;
+        ds.d        = ds.p - it.p;
 
-            result[outside_mask] = ds;
-        }
-
-        Mask inside_mask = andnot(active, outside_mask);
-        if (unlikely(any(inside_mask))) {
-            Vector3f d = warp::square_to_uniform_sphere(sample);
-            DirectionSample3f ds = zero<DirectionSample3f>();
-            ds.p        = fmadd(d, m_radius, m_center);
-            ds.n        = d;
-            ds.d        = ds.p - it.p;
+        Float dist2 = squared_norm(ds.d);
+        ds.dist     = sqrt(dist2);
+        ds.d        = ds.d / ds.dist;
 
-            Float dist2 = squared_norm(ds.d);
-            ds.dist     = sqrt(dist2);
-            ds.d        = ds.d / ds.dist;
-            ds.pdf      = m_inv_surface_area * dist2 / abs_dot(ds.d, ds.n);
+        ds.pdf = select(outside_mask,
+                        warp::square_to_uniform_cone_pdf(zero<Vector3f>(), cos_theta_max),
+                        m_inv_surface_area * dist2 / abs_dot(ds.d, ds.n));
+        masked(ds.pdf, ds.dist == 0.f) = 0.f;
 
-            result[inside_mask] = ds;
-        }
-
-        result.time = it.time;
-        result.delta = m_radius == 0.f;
+        ds.time = it.time;
+        ds.delta = m_radius == 0.f;
 
         if (m_flip_normals)
-            result.n = -result.n;
+            ds.n = -ds.n;
 
-        return result;
+        return ds;
     }
 
     Float pdf_direction(const Interaction3f &it, const DirectionSample3f &ds,
@@ -402,6 +404,17 @@ public:
     //! @}
     // =============================================================
 
+#if defined(MTS_ENABLE_EMBREE)
+    RTCGeometry embree_geometry(RTCDevice device) const override {
+        RTCGeometry geom = rtcNewGeometry(device, RTC_GEOMETRY_TYPE_SPHERE_POINT);
+        rtcSetSharedGeometryBuffer(geom, RTC_BUFFER_TYPE_VERTEX, 0,
+                                   RTC_FORMAT_FLOAT4, m_embree_sphere, 0,
+                                   4 * sizeof(float), 1);
+        rtcCommitGeometry(geom);
+        return geom;
+    }
+#endif
+
     ScalarSize primitive_count() const override { return 1; }
 
     ScalarSize effective_primitive_count() const override { return 1; }
@@ -417,6 +430,9 @@ public:
         m_object_to_world = ScalarTransform4f::translate(m_center);
         m_world_to_object = m_object_to_world.inverse();
         m_inv_surface_area = 1.f / surface_area();
+#if defined(MTS_ENABLE_EMBREE)
+        update_embree_data();
+#endif
     }
 
     std::string to_string() const override {
@@ -430,12 +446,26 @@ public:
 
     MTS_DECLARE_CLASS()
 private:
+#if defined(MTS_ENABLE_EMBREE)
+    void update_embree_data() {
+        m_embree_sphere[0] = (float) m_center.x();
+        m_embree_sphere[1] = (float) m_center.y();
+        m_embree_sphere[2] = (float) m_center.z();
+        m_embree_sphere[3] = (float) m_radius;
+    }
+#endif
+
     ScalarTransform4f m_object_to_world;
     ScalarTransform4f m_world_to_object;
     ScalarPoint3f m_center;
     ScalarFloat m_radius;
     ScalarFloat m_inv_surface_area;
     bool m_flip_normals;
+
+#if defined(MTS_ENABLE_EMBREE)
+    /// Sphere data (center and radius) shared with the Embree BVH
+    float m_embree_sphere[4];
+#endif
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(Sphere, Shape)
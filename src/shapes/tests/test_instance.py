@@ -0,0 +1,89 @@
+import mitsuba
+import pytest
+import enoki as ek
+from enoki.dynamic import Float32 as Float
+
+
+def example_scene(translate = (0, 0, 0), scale = 1.0):
+    from mitsuba.core.xml import load_string
+
+    return load_string("""<scene version="2.0.0">
+        <shape type="shapegroup" id="group">
+            <shape type="sphere"/>
+        </shape>
+        <shape type="instance">
+            <ref id="group"/>
+            <transform name="to_world">
+                <scale value="{}"/>
+                <translate x="{}" y="{}" z="{}"/>
+            </transform>
+        </shape>
+    </scene>""".format(scale, translate[0], translate[1], translate[2]))
+
+
+def test01_create(variant_scalar_rgb):
+    if mitsuba.core.MTS_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    s = example_scene()
+    assert s is not None
+
+
+def test02_bbox(variant_scalar_rgb):
+    from mitsuba.core import Vector3f
+
+    if mitsuba.core.MTS_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    for scale in [1, 4]:
+        for translate in [Vector3f([1.3, -3.0, 5]),
+                          Vector3f([-10000, 3.0, 31])]:
+            s = example_scene(translate, scale)
+            b = s.bbox()
+
+            assert b.valid()
+            assert ek.allclose(b.center(), translate)
+            assert ek.allclose(b.min, translate - scale)
+            assert ek.allclose(b.max, translate + scale)
+
+
+def test03_ray_intersect(variant_scalar_rgb):
+    if mitsuba.core.MTS_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    from mitsuba.core import Ray3f
+
+    # The instanced sphere must behave like one placed directly at (2, 0, 0)
+    scene = example_scene(translate = (2, 0, 0))
+
+    ray = Ray3f(o=[2, 0, 5], d=[0, 0, -1], time=0.0, wavelengths=[])
+    assert scene.ray_test(ray)
+
+    si = scene.ray_intersect(ray)
+    assert si.is_valid()
+    assert ek.allclose(si.t, 4.0)
+    assert ek.allclose(si.p, [2, 0, 1])
+    assert ek.allclose(si.n, [0, 0, 1])
+
+    # A ray that misses the instance but would hit the original group
+    ray = Ray3f(o=[0, 0, 5], d=[0, 0, -1], time=0.0, wavelengths=[])
+    assert not scene.ray_test(ray)
+    assert not scene.ray_intersect(ray).is_valid()
+
+
+def test04_ray_intersect_scaled(variant_scalar_rgb):
+    if mitsuba.core.MTS_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    from mitsuba.core import Ray3f
+
+    # Non-uniform ray parameterization: distances must stay in world units
+    scene = example_scene(scale = 2.0)
+
+    ray = Ray3f(o=[0, 0, 5], d=[0, 0, -1], time=0.0, wavelengths=[])
+    si = scene.ray_intersect(ray)
+
+    assert si.is_valid()
+    assert ek.allclose(si.t, 3.0)
+    assert ek.allclose(si.p, [0, 0, 2])
+    assert ek.allclose(si.n, [0, 0, 1])
@@ -54,6 +54,11 @@ public:
                 wavelength_range, values, size
             );
         }
+
+        /* Wavelength sampling runs on every camera ray in spectral
+           variants -- use the O(1) alias representation in place of a
+           binary search over the CDF */
+        m_distr.set_alias_table(true);
     }
 
     void traverse(TraversalCallback *callback) override {
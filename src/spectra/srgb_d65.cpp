@@ -1,7 +1,8 @@
 #include <mitsuba/render/texture.h>
 #include <mitsuba/render/srgb.h>
-#include <mitsuba/core/plugin.h>
+#include <mitsuba/core/distr_1d.h>
 #include <mitsuba/core/properties.h>
+#include <mitsuba/core/spectrum.h>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -38,10 +39,20 @@ public:
 
             m_value = srgb_model_fetch(color);
 
-            Properties props2("d65");
-            props2.set_float("scale", props.float_("scale", 1.f) * scale);
-            PluginManager *pmgr = PluginManager::instance();
-            m_d65 = (Texture *) pmgr->create_object<Texture>(props2)->expand().at(0).get();
+            /* Constant-fold the product of the D65 table with the overall
+               scale factor at load time, rather than instantiating a nested
+               'd65' plugin whose evaluation would go through a virtual call
+               for every sample */
+            ScalarFloat d65_scale = props.float_("scale", 1.f) * scale *
+                                    MTS_D65_NORMALIZATION;
+            ScalarFloat values[MTS_CIE_SAMPLES];
+            for (size_t i = 0; i < MTS_CIE_SAMPLES; ++i)
+                values[i] = d65_table[i] * d65_scale;
+
+            m_d65 = ContinuousDistribution<Wavelength>(
+                ScalarVector2f(MTS_CIE_MIN, MTS_CIE_MAX),
+                values, MTS_CIE_SAMPLES
+            );
         } else if constexpr (is_rgb_v<Spectrum>) {
             m_value = color;
         } else {
@@ -54,7 +65,7 @@ public:
         MTS_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
 
         if constexpr (is_spectral_v<Spectrum>)
-            return m_d65->eval(si, active) *
+            return m_d65.eval_pdf(si.wavelengths, active) *
                    srgb_model_eval<UnpolarizedSpectrum>(m_value, si.wavelengths);
         else
             return m_value;
@@ -73,7 +84,8 @@ private:
     static constexpr size_t ChannelCount = is_monochromatic_v<Spectrum> ? 1 : 3;
 
     Color<Float, ChannelCount> m_value;
-    ref<Texture> m_d65;
+    /// Scaled copy of the D65 spectrum (only used in spectral variants)
+    ContinuousDistribution<Wavelength> m_d65;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(SRGBEmitterSpectrum, Texture)
@@ -1,11 +1,20 @@
 #include <mitsuba/core/bitmap.h>
 #include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/hash.h>
+#include <mitsuba/core/math.h>
+#include <mitsuba/core/mmap.h>
 #include <mitsuba/core/plugin.h>
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/spectrum.h>
+#include <mitsuba/core/util.h>
 #include <mitsuba/render/interaction.h>
 #include <mitsuba/render/texture.h>
 #include <mitsuba/render/srgb.h>
+#include <enoki/half.h>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include <chrono>
+#include <mutex>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -28,6 +37,60 @@ Bitmap texture (:monosp:`bitmap`)
  * - to_uv
    - |transform|
    - Specifies an optional uv transformation.  (Default: none, i.e. emitter space = world space)
+ * - mipmap
+   - |bool|
+   - Should a mip hierarchy be built at load time so that minified lookups are
+     trilinearly filtered across pyramid levels? The level is selected from the
+     UV-space ray differentials of the query. Besides reducing aliasing, this
+     significantly improves the cache behavior of lookups into large, heavily
+     minified textures. Currently ignored in the GPU modes. (Default: false)
+ * - half_precision
+   - |bool|
+   - Store the texture data (including spectral upsampling coefficients) in
+     half instead of single precision, halving the memory footprint at the
+     cost of some accuracy. Only supported in the single-precision CPU
+     modes, where the data is expanded during each lookup; the texture
+     then also can no longer be updated through the differentiable parameter
+     interface. (Default: false)
+ * - tiled
+   - |bool|
+   - Store the texel data in small square tiles instead of scanline order.
+     A bilinear tap then touches one tile rather than two distant rows,
+     which noticeably reduces cache misses for large (8k+) textures that
+     are sampled incoherently, e.g. during glossy or diffuse interreflection.
+     The address swizzle is folded into the lookup arithmetic; the layout
+     conversion happens once at load time. Only affects the CPU modes.
+     A tiled texture holds a private swizzled copy of the texel data, so
+     combining this flag with :paramtype:`cache` still skips the decode
+     step but forgoes the shared file mapping, and the texture can no
+     longer be updated through the differentiable parameter interface.
+     (Default: false)
+ * - compressed
+   - |bool|
+   - Store RGB texel data as BC1-compressed 4x4 blocks (two RGB565
+     endpoints plus 2-bit interpolation indices per texel), shrinking the
+     footprint by 24x relative to float32 RGB at the cost of the usual
+     block-compression artifacts. The blocks are decoded directly in the
+     vectorized fetch path, so smaller storage also means fewer cache
+     misses for incoherently sampled textures. Intended for LDR input
+     such as albedo maps: images containing values outside [0, 1],
+     single-channel images, and the coefficient representation used by
+     the spectral non-:paramtype:`raw` mode fall back to the uncompressed
+     representation with a warning. Only affects the CPU modes, cannot be
+     combined with :paramtype:`half_precision` or :paramtype:`tiled`, and
+     the texture can no longer be updated through the differentiable
+     parameter interface. (Default: false)
+ * - cache
+   - |bool|
+   - Cache the converted texture data (including spectral upsampling
+     coefficients and mip levels) in a file next to the source image and
+     memory-map it read-only on subsequent loads. Concurrent renderers on the
+     same machine then skip the decode step and share a single copy of the
+     texel data instead of each holding its own. The cache is keyed on the
+     image contents and the conversion parameters and is rebuilt
+     automatically when either changes. Like :paramtype:`half_precision`,
+     a mapped texture can no longer be updated through the differentiable
+     parameter interface. (Default: false)
 
 This plugin provides a bitmap texture source that performs bilinearly interpolated
 lookups on JPEG, PNG, OpenEXR, RGBE, TGA, and BMP files.
@@ -51,6 +114,187 @@ at all.
 template <typename Float, typename Spectrum, uint32_t Channels, bool Raw>
 class BitmapTextureImpl;
 
+// Enables Log/Throw in the non-member helpers below
+static const Class *m_class = nullptr;
+
+/**
+ * On-disk layout of a converted-texel cache file. The header is followed by
+ * 'level_count' pairs of 32-bit level resolutions and then by the texel data
+ * of all pyramid levels, stored contiguously in coarsening order.
+ */
+struct TextureCacheHeader {
+    uint64_t key;           ///< Hash of the source image and conversion parameters
+    double mean;            ///< Precomputed mean value of the finest level
+    uint32_t magic;         ///< Equal to \ref TextureCacheMagic
+    uint32_t channel_count; ///< Number of texel channels (1 or 3)
+    uint32_t level_count;   ///< Number of pyramid levels
+    uint32_t padding;       ///< Unused, set to zero
+};
+
+constexpr uint32_t TextureCacheMagic = 0x4358544d; // 'MTXC'
+
+/* The cache machinery below consists of deliberately non-template functions:
+   the plugin is instantiated once per variant, but this logic only depends
+   on runtime parameters (texel type and the conversion settings), so a
+   single compiled copy serves every variant. */
+
+/**
+ * \brief Compute the cache key of a texture
+ *
+ * The key hashes the raw (encoded) image file together with every parameter
+ * that affects the converted in-memory representation, so that a stale cache
+ * file is detected and rebuilt automatically.
+ */
+static size_t texture_cache_key(const fs::path &file_path, bool raw, bool mipmap,
+                                bool spectral, size_t scalar_size) {
+    ref<MemoryMappedFile> source = new MemoryMappedFile(file_path);
+
+    const size_t *words = (const size_t *) source->data();
+    size_t word_count = source->size() / sizeof(size_t),
+           key = hash(std::make_tuple(raw, mipmap, spectral, scalar_size));
+
+    for (size_t i = 0; i < word_count; ++i)
+        key = hash_combine(key, words[i]);
+
+    const uint8_t *tail = (const uint8_t *) (words + word_count);
+    for (size_t i = word_count * sizeof(size_t); i < source->size(); ++i)
+        key = hash_combine(key, (size_t) *tail++);
+
+    return key;
+}
+
+/**
+ * \brief Attempt to reuse converted texel data from a cache file
+ *
+ * On success, the pyramid levels in \c levels reference a shared read-only
+ * mapping of \c cache_path that is returned via \c cache and must stay alive
+ * for the lifetime of the texture.
+ */
+static bool texture_cache_load(const fs::path &cache_path, size_t key,
+                               Struct::Type texel_type, size_t scalar_size,
+                               const std::string &name,
+                               std::vector<ref<Bitmap>> &levels, double &mean,
+                               ref<MemoryMappedFile> &cache) {
+    if (!fs::exists(cache_path))
+        return false;
+
+    try {
+        ref<MemoryMappedFile> mmap = new MemoryMappedFile(cache_path);
+        const uint8_t *ptr = (const uint8_t *) mmap->data();
+
+        TextureCacheHeader header;
+        if (mmap->size() < sizeof(TextureCacheHeader))
+            return false;
+        memcpy(&header, ptr, sizeof(TextureCacheHeader));
+
+        if (header.magic != TextureCacheMagic ||
+            header.key != (uint64_t) key ||
+            (header.channel_count != 1 && header.channel_count != 3) ||
+            header.level_count == 0)
+            return false;
+
+        size_t offset = sizeof(TextureCacheHeader) +
+                        2 * sizeof(uint32_t) * header.level_count;
+        if (mmap->size() < offset)
+            return false;
+
+        const uint32_t *res =
+            (const uint32_t *) (ptr + sizeof(TextureCacheHeader));
+
+        size_t total = 0;
+        for (uint32_t l = 0; l < header.level_count; ++l)
+            total += (size_t) res[2 * l] * res[2 * l + 1] *
+                     header.channel_count;
+        if (mmap->size() != offset + total * scalar_size)
+            return false;
+
+        Bitmap::PixelFormat pixel_format = header.channel_count == 1
+            ? Bitmap::PixelFormat::Y : Bitmap::PixelFormat::RGB;
+
+        // The resulting bitmaps reference the mapping without owning it
+        uint8_t *data = (uint8_t *) mmap->data() + offset;
+        levels.clear();
+        for (uint32_t l = 0; l < header.level_count; ++l) {
+            Vector<uint32_t, 2> size(res[2 * l], res[2 * l + 1]);
+            levels.push_back(new Bitmap(
+                pixel_format, texel_type, size, 0, data));
+            data += hprod(size) * header.channel_count * scalar_size;
+        }
+
+        mean = header.mean;
+        cache = mmap;
+
+        Log(Debug, "Mapped cached texture data for \"%s\" ..", name);
+        return true;
+    } catch (const std::exception &e) {
+        Log(Warn, "Could not map texture cache \"%s\": %s",
+            cache_path.string(), e.what());
+        return false;
+    }
+}
+
+/**
+ * \brief Atomically publish the converted texel data to \c cache_path
+ *
+ * The data is written to a uniquely named temporary file that is then
+ * renamed into place, so that concurrent processes converting the same
+ * texture never observe a partially written cache. Failures merely cost
+ * the caching opportunity and are therefore demoted to warnings.
+ */
+static void texture_cache_write(const fs::path &cache_path, size_t key,
+                                const std::vector<ref<Bitmap>> &levels,
+                                double mean, const void *unique) {
+    fs::path tmp_path(cache_path.string() + "." + std::to_string(
+        hash_combine((size_t) unique,
+                     (size_t) std::chrono::high_resolution_clock::now()
+                         .time_since_epoch().count())));
+
+    try {
+        size_t header_size = sizeof(TextureCacheHeader) +
+                             2 * sizeof(uint32_t) * levels.size(),
+               total = 0;
+        for (const auto &level : levels)
+            total += level->buffer_size();
+
+        {
+            ref<MemoryMappedFile> mmap =
+                new MemoryMappedFile(tmp_path, header_size + total);
+            uint8_t *ptr = (uint8_t *) mmap->data();
+
+            TextureCacheHeader header;
+            header.key = (uint64_t) key;
+            header.mean = mean;
+            header.magic = TextureCacheMagic;
+            header.channel_count = (uint32_t) levels[0]->channel_count();
+            header.level_count = (uint32_t) levels.size();
+            header.padding = 0;
+            memcpy(ptr, &header, sizeof(TextureCacheHeader));
+            ptr += sizeof(TextureCacheHeader);
+
+            for (const auto &level : levels) {
+                uint32_t size[2] = { level->size().x(), level->size().y() };
+                memcpy(ptr, size, sizeof(size));
+                ptr += sizeof(size);
+            }
+
+            for (const auto &level : levels) {
+                memcpy(ptr, level->data(), level->buffer_size());
+                ptr += level->buffer_size();
+            }
+        }
+
+        if (!fs::rename(tmp_path, cache_path)) {
+            fs::remove(tmp_path);
+            Log(Warn, "Could not publish texture cache \"%s\"",
+                cache_path.string());
+        }
+    } catch (const std::exception &e) {
+        fs::remove(tmp_path);
+        Log(Warn, "Could not write texture cache \"%s\": %s",
+            cache_path.string(), e.what());
+    }
+}
+
 /// Bilinearly interpolated bitmap texture.
 template <typename Float, typename Spectrum>
 class BitmapTexture final : public Texture<Float, Spectrum> {
@@ -63,6 +307,52 @@ public:
         FileResolver* fs = Thread::thread()->file_resolver();
         fs::path file_path = fs->resolve(props.string("filename"));
         m_name = file_path.filename().string();
+
+        /* Should Mitsuba disable transformations to the stored color data? (e.g.
+           sRGB to linear, spectral upsampling, etc.) */
+        m_raw = props.bool_("raw", false);
+        m_mipmap = props.bool_("mipmap", false);
+        m_half = props.bool_("half_precision", false);
+        m_tiled = props.bool_("tiled", false);
+        m_compressed = props.bool_("compressed", false);
+        m_use_cache = props.bool_("cache", false);
+
+        if (m_compressed && (m_half || m_tiled))
+            Throw("The 'compressed' flag selects its own storage layout and "
+                  "cannot be combined with 'half_precision' or 'tiled'!");
+
+        if (m_use_cache) {
+            fs::path cache_path(file_path.string() + ".texcache");
+            size_t key = texture_cache_key(file_path, m_raw, m_mipmap,
+                                           is_spectral_v<Spectrum> && !m_raw,
+                                           sizeof(ScalarFloat));
+            if (!load_cache(cache_path, key)) {
+                load_bitmap(file_path);
+                texture_cache_write(cache_path, key, m_levels,
+                                    (double) m_mean, this);
+                /* Map the freshly written file so that this process also
+                   shares the texel data instead of keeping a private copy */
+                load_cache(cache_path, key);
+            }
+        } else {
+            load_bitmap(file_path);
+        }
+    }
+
+    /// Thin variant-typed wrapper around \ref texture_cache_load()
+    bool load_cache(const fs::path &cache_path, size_t key) {
+        double mean;
+        if (!texture_cache_load(cache_path, key, struct_type_v<ScalarFloat>,
+                                sizeof(ScalarFloat), m_name, m_levels, mean,
+                                m_cache))
+            return false;
+        m_bitmap = m_levels[0];
+        m_mean = ScalarFloat(mean);
+        return true;
+    }
+
+    /// Decode the source image and convert it into the in-memory representation
+    void load_bitmap(const fs::path &file_path) {
         Log(Debug, "Loading bitmap texture from \"%s\" ..", m_name);
 
         m_bitmap = new Bitmap(file_path);
@@ -88,9 +378,6 @@ public:
                       "format (Y[A], RGB[A], XYZ[A])");
         }
 
-        /* Should Mitsuba disable transformations to the stored color data? (e.g.
-           sRGB to linear, spectral upsampling, etc.) */
-        m_raw = props.bool_("raw", false);
         if (m_raw) {
             /* Don't undo gamma correction in the conversion below.
                This is needed, e.g., for normal maps. */
@@ -108,28 +395,59 @@ public:
             m_bitmap = m_bitmap->resample(max(m_bitmap->size(), 2), rfilter);
         }
 
-        ScalarFloat *ptr = (ScalarFloat *) m_bitmap->data();
+        /* Build a mip hierarchy for filtered minified lookups by repeatedly
+           halving the linear image before any spectral upsampling below */
+        m_levels.push_back(m_bitmap);
+        if (m_mipmap) {
+            using ReconstructionFilter = Bitmap::ReconstructionFilter;
+            ref<ReconstructionFilter> rfilter =
+                PluginManager::instance()->create_object<ReconstructionFilter>(Properties("box"));
+            while (any(m_levels.back()->size() > 2u))
+                m_levels.push_back(m_levels.back()->resample(
+                    max(m_levels.back()->size() / 2u, 2u), rfilter));
+        }
 
         double mean = 0.0;
-        if (m_bitmap->channel_count() == 3) {
-            if (is_spectral_v<Spectrum> && !m_raw) {
-                for (size_t i = 0; i < m_bitmap->pixel_count(); ++i) {
-                    ScalarColor3f value = load_unaligned<ScalarColor3f>(ptr);
-                    value = srgb_model_fetch(value);
-                    mean += (double) srgb_model_mean(value);
-                    store_unaligned(ptr, value);
-                    ptr += 3;
-                }
-            } else {
-                for (size_t i = 0; i < m_bitmap->pixel_count(); ++i) {
-                    ScalarColor3f value = load_unaligned<ScalarColor3f>(ptr);
-                    mean += (double) luminance(value);
-                    ptr += 3;
+        for (size_t l = 0; l < m_levels.size(); ++l) {
+            Bitmap *level = m_levels[l];
+            ScalarFloat *ptr = (ScalarFloat *) level->data();
+
+            if (level->channel_count() == 3) {
+                if (is_spectral_v<Spectrum> && !m_raw) {
+                    /* Convert to the coefficient representation of the
+                       spectral upsampling model. The per-texel table lookup
+                       dominates load time for large textures, so distribute
+                       the texels across the available cores */
+                    std::mutex mean_mutex;
+                    tbb::parallel_for(
+                        tbb::blocked_range<size_t>(0, level->pixel_count(), 16384),
+                        [&](const tbb::blocked_range<size_t> &range) {
+                            double mean_local = 0.0;
+                            ScalarFloat *p = ptr + 3 * range.begin();
+                            for (size_t i = range.begin(); i != range.end(); ++i) {
+                                ScalarColor3f value = load_unaligned<ScalarColor3f>(p);
+                                value = srgb_model_fetch(value);
+                                if (l == 0)
+                                    mean_local += (double) srgb_model_mean(value);
+                                store_unaligned(p, value);
+                                p += 3;
+                            }
+                            if (l == 0) {
+                                std::lock_guard<std::mutex> guard(mean_mutex);
+                                mean += mean_local;
+                            }
+                        });
+                } else if (l == 0) {
+                    for (size_t i = 0; i < level->pixel_count(); ++i) {
+                        ScalarColor3f value = load_unaligned<ScalarColor3f>(ptr);
+                        mean += (double) luminance(value);
+                        ptr += 3;
+                    }
                 }
+            } else if (l == 0) {
+                for (size_t i = 0; i < level->pixel_count(); ++i)
+                    mean += (double) ptr[i];
             }
-        } else {
-            for (size_t i = 0; i < m_bitmap->pixel_count(); ++i)
-                mean += (double) ptr[i];
         }
 
         m_mean = ScalarFloat(mean / m_bitmap->pixel_count());
@@ -150,14 +468,14 @@ public:
         switch (m_bitmap->channel_count()) {
             case 1:
                 result = m_raw
-                  ? (Object *) new Impl<1, true >(props, m_bitmap, m_name, m_transform, m_mean)
-                  : (Object *) new Impl<1, false>(props, m_bitmap, m_name, m_transform, m_mean);
+                  ? (Object *) new Impl<1, true >(props, m_levels, m_name, m_transform, m_mean, m_half, m_tiled, m_compressed, m_cache)
+                  : (Object *) new Impl<1, false>(props, m_levels, m_name, m_transform, m_mean, m_half, m_tiled, m_compressed, m_cache);
                 break;
 
             case 3:
                 result = m_raw
-                  ? (Object *) new Impl<3, true >(props, m_bitmap, m_name, m_transform, m_mean)
-                  : (Object *) new Impl<3, false>(props, m_bitmap, m_name, m_transform, m_mean);
+                  ? (Object *) new Impl<3, true >(props, m_levels, m_name, m_transform, m_mean, m_half, m_tiled, m_compressed, m_cache)
+                  : (Object *) new Impl<3, false>(props, m_levels, m_name, m_transform, m_mean, m_half, m_tiled, m_compressed, m_cache);
                 break;
 
             default:
@@ -171,9 +489,17 @@ public:
     MTS_DECLARE_CLASS()
 protected:
     ref<Bitmap> m_bitmap;
+    std::vector<ref<Bitmap>> m_levels;
+    /// Shared mapping of the cache file referenced by \ref m_levels (if any)
+    ref<MemoryMappedFile> m_cache;
     std::string m_name;
     ScalarTransform3f m_transform;
     bool m_raw;
+    bool m_mipmap;
+    bool m_half;
+    bool m_tiled;
+    bool m_compressed;
+    bool m_use_cache;
     ScalarFloat m_mean;
 };
 
@@ -183,18 +509,188 @@ public:
     MTS_IMPORT_TYPES(Texture)
 
     BitmapTextureImpl(const Properties &props,
-                      const Bitmap *bitmap,
+                      const std::vector<ref<Bitmap>> &levels,
                       const std::string &name,
                       const ScalarTransform3f &transform,
-                      ScalarFloat mean)
-        : Texture(props), m_resolution(bitmap->size()),
+                      ScalarFloat mean,
+                      bool half_precision = false,
+                      bool tiled = false,
+                      bool compressed = false,
+                      ref<MemoryMappedFile> cache = nullptr)
+        : Texture(props), m_resolution(levels[0]->size()),
           m_name(name), m_transform(transform), m_mean(mean) {
-        m_data = DynamicBuffer<Float>::copy(bitmap->data(),
-            hprod(m_resolution) * Channels);
+        if constexpr (is_cuda_array_v<Float> || is_diff_array_v<Float>) {
+            if (tiled) {
+                Log(Warn, "BitmapTexture: the tiled texel layout only affects "
+                          "the CPU gather path, ignoring it in this variant.");
+                tiled = false;
+            }
+            if (compressed) {
+                Log(Warn, "BitmapTexture: BC1 compression is only supported "
+                          "in the CPU modes, falling back to the native "
+                          "representation.");
+                compressed = false;
+            }
+        }
+
+        if (compressed && Channels != 3) {
+            Log(Warn, "BitmapTexture: BC1 compression requires RGB content; "
+                      "\"%s\" is monochromatic, falling back to the native "
+                      "representation.", name);
+            compressed = false;
+        }
+
+        if (compressed && Channels == 3 && is_spectral_v<Spectrum> && !Raw) {
+            Log(Warn, "BitmapTexture: BC1 compression stores RGB values, not "
+                      "the coefficients of the spectral upsampling model; "
+                      "falling back to the native representation for \"%s\". "
+                      "(consider raw=true for data textures)", name);
+            compressed = false;
+        }
+
+        if (compressed) {
+            /* The RGB565 endpoint encoding cannot represent HDR content --
+               verify that the finest level (a superset of the range of the
+               coarser averages) is within [0, 1] */
+            const ScalarFloat *p = (const ScalarFloat *) levels[0]->data();
+            size_t count = hprod(levels[0]->size()) * Channels;
+            for (size_t i = 0; i < count; ++i) {
+                if (!(p[i] >= 0.f && p[i] <= 1.f + ScalarFloat(1e-3))) {
+                    Log(Warn, "BitmapTexture: \"%s\" contains values outside "
+                              "[0, 1]; BC1 compression requires LDR content, "
+                              "falling back to the native representation.",
+                        name);
+                    compressed = false;
+                    break;
+                }
+            }
+        }
+
+        m_tiled = tiled;
+        m_compressed = compressed;
+
+        size_t total = 0;
+        for (const auto &level : levels) {
+            m_level_offset.push_back((uint32_t) total);
+            m_level_res.push_back(ScalarVector2u(level->size()));
+            if (m_compressed)
+                total += bc1_word_count(ScalarVector2u(level->size()));
+            else if (m_tiled)
+                total += tiled_texel_count(ScalarVector2u(level->size())) * Channels;
+            else
+                total += hprod(level->size()) * Channels;
+        }
+
+        if constexpr (is_cuda_array_v<Float> || is_diff_array_v<Float> ||
+                      !std::is_same_v<ScalarFloat, float>) {
+            if (half_precision) {
+                Log(Warn, "BitmapTexture: half-precision storage is only "
+                          "supported in the single-precision CPU modes, "
+                          "falling back to the native representation.");
+                half_precision = false;
+            }
+        }
+
+        bool mapped = false;
+        if constexpr (!is_cuda_array_v<Float> && !is_diff_array_v<Float>) {
+            /* The levels of a cached texture reference one contiguous
+               read-only file mapping that is shared with every other process
+               rendering on this machine -- alias it instead of making a
+               private copy */
+            if (cache && !half_precision && !m_tiled && !m_compressed) {
+                m_data = DynamicBuffer<Float>::map(
+                    (ScalarFloat *) levels[0]->data(), total);
+                m_cache = cache;
+                mapped = true;
+            }
+        }
+
+        if (m_compressed) {
+            if constexpr (Channels == 3) {
+                m_data_bc.resize(total);
+                for (size_t l = 0; l < levels.size(); ++l)
+                    compress_bc1_level((const ScalarFloat *) levels[l]->data(),
+                                       ScalarVector2u(levels[l]->size()),
+                                       m_data_bc.data() + m_level_offset[l]);
+            }
+        } else if (m_tiled) {
+            /* Re-pack every level into square tiles; padding texels of
+               partial edge tiles exist in the address space but are never
+               referenced by a lookup */
+            std::unique_ptr<ScalarFloat[]> tmp(new ScalarFloat[total]());
+            for (size_t l = 0; l < levels.size(); ++l) {
+                const ScalarFloat *src = (const ScalarFloat *) levels[l]->data();
+                ScalarFloat *dst = tmp.get() + m_level_offset[l];
+                ScalarVector2u res(levels[l]->size());
+                uint32_t tiles_x = (res.x() + TileMask) >> TileShift;
+                for (uint32_t y = 0; y < res.y(); ++y) {
+                    for (uint32_t x = 0; x < res.x(); ++x) {
+                        size_t t = texel_index(x, y, tiles_x) * Channels,
+                               s = ((size_t) y * res.x() + x) * Channels;
+                        for (uint32_t ch = 0; ch < Channels; ++ch)
+                            dst[t + ch] = src[s + ch];
+                    }
+                }
+            }
+
+            if (half_precision) {
+                m_data_half.resize(total);
+                for (size_t i = 0; i < total; ++i)
+                    m_data_half[i] =
+                        enoki::half::float32_to_float16((float) tmp[i]);
+            } else {
+                m_data = DynamicBuffer<Float>::copy(tmp.get(), total);
+            }
+        } else if (half_precision) {
+            // Compact the texture data into a half-precision buffer
+            m_data_half.resize(total);
+            size_t pos = 0;
+            for (const auto &level : levels) {
+                const ScalarFloat *p = (const ScalarFloat *) level->data();
+                size_t count = hprod(level->size()) * Channels;
+                for (size_t i = 0; i < count; ++i)
+                    m_data_half[pos++] =
+                        enoki::half::float32_to_float16((float) p[i]);
+            }
+        } else if (mapped) {
+            ; // Handled above
+        } else {
+            const ScalarFloat *src = (const ScalarFloat *) levels[0]->data();
+            std::unique_ptr<ScalarFloat[]> tmp;
+            if (levels.size() > 1) {
+                // Concatenate the pyramid levels into a single buffer
+                tmp.reset(new ScalarFloat[total]);
+                for (size_t i = 0; i < levels.size(); ++i)
+                    memcpy(tmp.get() + m_level_offset[i], levels[i]->data(),
+                           hprod(levels[i]->size()) * Channels * sizeof(ScalarFloat));
+                src = tmp.get();
+            }
+
+            bool uploaded = false;
+            if constexpr (is_cuda_array_v<Float>) {
+                /* Scenes that outgrow the device keep their textures in
+                   managed memory (see \ref util::cuda_prefer_managed()); the
+                   driver then pages in only the pyramid levels that lookups
+                   actually touch, and rarely sampled textures never occupy
+                   device memory at all. */
+                size_t bytes = total * sizeof(ScalarFloat);
+                if (util::cuda_prefer_managed(bytes)) {
+                    ScalarFloat *dst = (ScalarFloat *) cuda_managed_malloc(bytes);
+                    memcpy(dst, src, bytes);
+                    m_data = DynamicBuffer<Float>::map(dst, total, true);
+                    uploaded = true;
+                }
+            }
+            if (!uploaded)
+                m_data = DynamicBuffer<Float>::copy(src, total);
+        }
     }
 
     void traverse(TraversalCallback *callback) override {
-        callback->put_parameter("data", m_data);
+        /* Half-precision, tiled, compressed and memory-mapped textures cannot
+           be updated through the differentiable parameter interface */
+        if (m_data_half.empty() && m_data_bc.empty() && !m_cache && !m_tiled)
+            callback->put_parameter("data", m_data);
         callback->put_parameter("resolution", m_resolution);
         callback->put_parameter("transform", m_transform);
     }
@@ -235,6 +731,55 @@ public:
         }
     }
 
+    void eval_n(const SurfaceInteraction3f *si, size_t count,
+                UnpolarizedSpectrum *out, Mask active = true) const override {
+        MTS_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+
+        if constexpr (Channels == 3 && is_spectral_v<Spectrum> && Raw) {
+            ENOKI_MARK_USED(si);
+            ENOKI_MARK_USED(count);
+            ENOKI_MARK_USED(out);
+            Throw("The bitmap texture %s was queried for a spectrum, but texture conversion "
+                  "into spectra was explicitly disabled! (raw=true)",
+                  to_string());
+        } else {
+            /* A single virtual call and profiler scope covers the whole
+               batch; the transform and image metadata loads in interpolate()
+               stay in registers across iterations */
+            for (size_t i = 0; i < count; ++i) {
+                auto result = interpolate(si[i], active);
+
+                if constexpr (Channels == 3 && is_monochromatic_v<Spectrum>)
+                    out[i] = luminance(result);
+                else
+                    out[i] = result;
+            }
+        }
+    }
+
+    void eval_1_n(const SurfaceInteraction3f *si, size_t count,
+                  Float *out, Mask active = true) const override {
+        MTS_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+
+        if constexpr (Channels == 3 && is_spectral_v<Spectrum> && !Raw) {
+            ENOKI_MARK_USED(si);
+            ENOKI_MARK_USED(count);
+            ENOKI_MARK_USED(out);
+            Throw("eval_1_n(): The bitmap texture %s was queried for a scalar value, but texture "
+                  "conversion into spectra was requested! (raw=false)",
+                  to_string());
+        } else {
+            for (size_t i = 0; i < count; ++i) {
+                auto result = interpolate(si[i], active);
+
+                if constexpr (Channels == 3)
+                    out[i] = luminance(result);
+                else
+                    out[i] = result;
+            }
+        }
+    }
+
     Color3f eval_3(const SurfaceInteraction3f &si, Mask active = true) const override {
         MTS_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
 
@@ -252,38 +797,311 @@ public:
         }
     }
 
-    MTS_INLINE auto interpolate(const SurfaceInteraction3f &si, Mask active) const {
-        if constexpr (!is_array_v<Mask>)
-            active = true;
+    /**
+     * \brief Expand an array of raw 16-bit half-precision values (passed as
+     * zero-extended 32-bit integers) into single precision
+     *
+     * Subnormals are handled exactly, and infinities -- which the spectral
+     * upsampling model uses to encode pure black/white texels -- are
+     * preserved.
+     */
+    template <typename Value, typename UInt = uint32_array_t<Value>>
+    MTS_INLINE static Value half_to_single(const UInt &h) {
+        UInt shifted = (h & 0x7fffu) << 13;
+        Value f = reinterpret_array<Value>(shifted) * Value(0x1p+112f);
+        masked(f, eq(h & 0x7c00u, 0x7c00u)) =
+            reinterpret_array<Value>(shifted | 0x7f800000u);
+        return reinterpret_array<Value>(reinterpret_array<UInt>(f) |
+                                        ((h & 0x8000u) << 16));
+    }
 
-        Point2f uv = m_transform.transform_affine(si.uv);
-        uv -= floor(uv);
-        uv *= Vector2f(m_resolution - 1u);
+    /// Texels are grouped into square tiles when the tiled layout is enabled
+    static constexpr uint32_t TileShift = 3,
+                              TileSize  = 1u << TileShift,
+                              TileMask  = TileSize - 1;
+
+    /// Number of texels a level occupies in the tiled layout (incl. padding)
+    static size_t tiled_texel_count(const ScalarVector2u &res) {
+        return (size_t) ((res.x() + TileMask) >> TileShift) *
+               ((res.y() + TileMask) >> TileShift) * (TileSize * TileSize);
+    }
+
+    /// Offset of texel (x, y) within a tiled level with \c tiles_x tile columns
+    static size_t texel_index(uint32_t x, uint32_t y, uint32_t tiles_x) {
+        return ((size_t) ((y >> TileShift) * tiles_x + (x >> TileShift))
+                    << (2 * TileShift)) |
+               ((y & TileMask) << TileShift) | (x & TileMask);
+    }
 
-        Point2u pos = min(Point2u(uv), m_resolution - 2u);
+    /// Number of 32-bit words a level occupies in the BC1 representation
+    static size_t bc1_word_count(const ScalarVector2u &res) {
+        return (size_t) ((res.x() + 3u) >> 2) * ((res.y() + 3u) >> 2) * 2;
+    }
+
+    /// Expand a packed RGB565 endpoint into floating point
+    static ScalarColor3f bc1_expand565(uint32_t c) {
+        return ScalarColor3f(((c >> 11) & 0x1fu) * (1.f / 31.f),
+                             ((c >> 5)  & 0x3fu) * (1.f / 63.f),
+                             (c & 0x1fu)         * (1.f / 31.f));
+    }
+
+    /**
+     * \brief Compress one pyramid level into 4x4 BC1 blocks
+     *
+     * A bounding-box encoder: the endpoints are the per-channel minimum and
+     * maximum of the block, and each texel selects the nearest of the four
+     * colors on the segment between them. Partial edge blocks replicate the
+     * border texels, mirroring the clamped addressing of the lookup path.
+     */
+    static void compress_bc1_level(const ScalarFloat *src,
+                                   const ScalarVector2u &res, uint32_t *dst) {
+        uint32_t bw = (res.x() + 3u) >> 2,
+                 bh = (res.y() + 3u) >> 2;
+
+        for (uint32_t by = 0; by < bh; ++by) {
+            for (uint32_t bx = 0; bx < bw; ++bx) {
+                ScalarColor3f texel[16],
+                              lo( math::Infinity<ScalarFloat>),
+                              hi(-math::Infinity<ScalarFloat>);
+
+                for (uint32_t j = 0; j < 4; ++j) {
+                    uint32_t y = std::min(by * 4 + j, res.y() - 1);
+                    for (uint32_t i = 0; i < 4; ++i) {
+                        uint32_t x = std::min(bx * 4 + i, res.x() - 1);
+                        ScalarColor3f c = load_unaligned<ScalarColor3f>(
+                            src + ((size_t) y * res.x() + x) * 3);
+                        texel[j * 4 + i] = c;
+                        lo = min(lo, c);
+                        hi = max(hi, c);
+                    }
+                }
+
+                auto quant565 = [](const ScalarColor3f &c) -> uint32_t {
+                    ScalarColor3f q = clamp(c, 0.f, 1.f);
+                    return ((uint32_t) std::round(q.x() * 31.f) << 11) |
+                           ((uint32_t) std::round(q.y() * 63.f) << 5) |
+                            (uint32_t) std::round(q.z() * 31.f);
+                };
+
+                /* BC1 interprets 'e0 > e1' as the four-color mode used here;
+                   equal endpoints encode a constant block (all selectors 0) */
+                uint32_t e0 = quant565(hi),
+                         e1 = quant565(lo);
+                if (e0 < e1)
+                    std::swap(e0, e1);
+
+                uint32_t bits = 0;
+                if (e0 != e1) {
+                    /* Pick selectors against the quantized endpoints so that
+                       the encoding error of the endpoints is absorbed */
+                    ScalarColor3f c0 = bc1_expand565(e0),
+                                  c1 = bc1_expand565(e1),
+                                  d  = c1 - c0;
+                    ScalarFloat inv = 1.f / squared_norm(d);
+
+                    for (uint32_t t = 0; t < 16; ++t) {
+                        ScalarFloat proj =
+                            clamp(dot(texel[t] - c0, d) * inv, 0.f, 1.f);
+                        uint32_t q = (uint32_t) std::round(proj * 3.f);
+                        /* Selector semantics: 0 = c0, 1 = c1, 2 = 2/3 c0 +
+                           1/3 c1, 3 = 1/3 c0 + 2/3 c1 */
+                        uint32_t sel = q == 0 ? 0u : (q == 3 ? 1u : q + 1u);
+                        bits |= sel << (2 * t);
+                    }
+                }
+
+                *dst++ = e0 | (e1 << 16);
+                *dst++ = bits;
+            }
+        }
+    }
+
+    /**
+     * \brief Bilinear lookup within one pyramid level
+     *
+     * The level is described by its base offset into \ref m_data and its
+     * resolution, both of which may vary per lane.
+     */
+    MTS_INLINE auto interpolate_bilinear(Point2f uv, const UInt32 &base,
+                                         const Vector2u &res,
+                                         const Wavelength &wavelengths,
+                                         Mask active) const {
+        uv *= Vector2f(res - 1u);
+
+        Point2u pos = min(Point2u(uv), res - 2u);
 
         Point2f w1 = uv - Point2f(pos),
                 w0 = 1.f - w1;
 
-        UInt32 index = pos.x() + pos.y() * m_resolution.x();
-        uint32_t width = m_resolution.x();
+        UInt32 width = res.x(),
+               index = base + pos.x() + pos.y() * width;
 
         using StorageType = std::conditional_t<Channels == 1, Float, Color3f>;
+        StorageType v00, v10, v01, v11;
+
+        if constexpr (!is_cuda_array_v<Float> && !is_diff_array_v<Float>) {
+            if constexpr (Channels == 3) {
+                if (unlikely(!m_data_bc.empty())) {
+                    /* Decode the BC1 blocks directly in the gather path: each
+                       texel costs two 32-bit gathers (endpoints + selector
+                       word) and a short dequantization sequence */
+                    UInt32 blocks_x = (width + 3u) >> 2;
+
+                    auto fetch_bc = [&](const UInt32 &x, const UInt32 &y) {
+                        UInt32 block = base +
+                            ((y >> 2) * blocks_x + (x >> 2)) * 2u;
+                        UInt32 e    = gather<UInt32>(m_data_bc.data(), block,
+                                                     active),
+                               bits = gather<UInt32>(m_data_bc.data(),
+                                                     block + 1u, active);
+
+                        auto expand = [](const UInt32 &c) {
+                            return Color3f(
+                                Float((c >> 11) & 0x1fu) * (1.f / 31.f),
+                                Float((c >> 5)  & 0x3fu) * (1.f / 63.f),
+                                Float(c & 0x1fu)         * (1.f / 31.f));
+                        };
+                        Color3f c0 = expand(e & 0xffffu),
+                                c1 = expand(e >> 16);
+
+                        /* Selector semantics: 0 = c0, 1 = c1, 2 and 3 the
+                           two interior points of the segment */
+                        UInt32 shift = (((y & 3u) << 2) | (x & 3u)) << 1,
+                               sel   = (bits >> shift) & 3u;
+                        Float t = select(sel >= 2u,
+                                         Float(sel - 1u) * (1.f / 3.f),
+                                         Float(sel));
+                        return fmadd(t, c1 - c0, c0);
+                    };
+
+                    v00 = fetch_bc(pos.x(),      pos.y());
+                    v10 = fetch_bc(pos.x() + 1u, pos.y());
+                    v01 = fetch_bc(pos.x(),      pos.y() + 1u);
+                    v11 = fetch_bc(pos.x() + 1u, pos.y() + 1u);
+
+                    return interpolate_weighted(v00, v10, v01, v11, w0, w1,
+                                                wavelengths);
+                }
+            }
+
+            if (unlikely(m_tiled)) {
+                /* The tile swizzle breaks the horizontal pair-gather below
+                   (the right neighbor of a tile-edge texel lives in another
+                   tile), so fetch the four corners independently with the
+                   address swizzle fused into the gather index arithmetic */
+                UInt32 tiles_x = (width + TileMask) >> TileShift;
+
+                auto tiled_index = [&](const UInt32 &x, const UInt32 &y) {
+                    return base + ((((y >> TileShift) * tiles_x +
+                                     (x >> TileShift)) << (2 * TileShift)) |
+                                   ((y & TileMask) << TileShift) |
+                                   (x & TileMask));
+                };
+
+                UInt32 i00 = tiled_index(pos.x(),      pos.y()),
+                       i10 = tiled_index(pos.x() + 1u, pos.y()),
+                       i01 = tiled_index(pos.x(),      pos.y() + 1u),
+                       i11 = tiled_index(pos.x() + 1u, pos.y() + 1u);
+
+                bool half = false;
+                if constexpr (std::is_same_v<ScalarFloat, float>) {
+                    if (unlikely(!m_data_half.empty())) {
+                        using StorageU16 = std::conditional_t<Channels == 1,
+                            uint16_array_t<Float>,
+                            Array<uint16_array_t<Float>, 3>>;
+                        using StorageU32 = uint32_array_t<StorageType>;
+                        constexpr size_t Stride = Channels * sizeof(uint16_t);
+
+                        auto fetch = [&](const UInt32 &i) {
+                            StorageU16 q = gather<StorageU16, Stride>(
+                                m_data_half.data(), i, active);
+                            return half_to_single<StorageType>(StorageU32(q));
+                        };
+
+                        v00 = fetch(i00); v10 = fetch(i10);
+                        v01 = fetch(i01); v11 = fetch(i11);
+                        half = true;
+                    }
+                }
+
+                if (!half) {
+                    constexpr size_t Stride = Channels * sizeof(ScalarFloat);
+                    v00 = gather<StorageType, Stride>(m_data.data(), i00, active);
+                    v10 = gather<StorageType, Stride>(m_data.data(), i10, active);
+                    v01 = gather<StorageType, Stride>(m_data.data(), i01, active);
+                    v11 = gather<StorageType, Stride>(m_data.data(), i11, active);
+                }
+
+                return interpolate_weighted(v00, v10, v01, v11, w0, w1,
+                                            wavelengths);
+            }
+
+            /* Fetch each horizontally adjacent texel pair with a single
+               strided gather: the components of the right texel turn into
+               constant address displacements rather than separate index
+               arithmetic and gather calls */
+            using TexelPair = Array<Float, 2 * Channels>;
+
+            TexelPair p0, p1;
+
+            auto gather_single = [&]() {
+                constexpr size_t Stride = Channels * sizeof(ScalarFloat);
+                p0 = gather<TexelPair, Stride>(m_data.data(), index, active);
+                p1 = gather<TexelPair, Stride>(m_data.data(), index + width, active);
+            };
+
+            if constexpr (std::is_same_v<ScalarFloat, float>) {
+                if (unlikely(!m_data_half.empty())) {
+                    // Gather the packed 16-bit texels and expand them
+                    using TexelPairU16 = Array<uint16_array_t<Float>, 2 * Channels>;
+                    using TexelPairU32 = uint32_array_t<TexelPair>;
+                    constexpr size_t Stride = Channels * sizeof(uint16_t);
+
+                    TexelPairU16 q0 = gather<TexelPairU16, Stride>(m_data_half.data(), index, active),
+                                 q1 = gather<TexelPairU16, Stride>(m_data_half.data(), index + width, active);
+
+                    p0 = half_to_single<TexelPair>(TexelPairU32(q0));
+                    p1 = half_to_single<TexelPair>(TexelPairU32(q1));
+                } else {
+                    gather_single();
+                }
+            } else {
+                gather_single();
+            }
+
+            if constexpr (Channels == 1) {
+                v00 = p0.x(); v10 = p0.y();
+                v01 = p1.x(); v11 = p1.y();
+            } else {
+                v00 = head<3>(p0); v10 = tail<3>(p0);
+                v01 = head<3>(p1); v11 = tail<3>(p1);
+            }
+        } else {
+            v00 = gather<StorageType>(m_data, index, active);
+            v10 = gather<StorageType>(m_data, index + 1, active);
+            v01 = gather<StorageType>(m_data, index + width, active);
+            v11 = gather<StorageType>(m_data, index + width + 1, active);
+        }
 
-        StorageType v00 = gather<StorageType>(m_data, index, active),
-                    v10 = gather<StorageType>(m_data, index + 1, active),
-                    v01 = gather<StorageType>(m_data, index + width, active),
-                    v11 = gather<StorageType>(m_data, index + width + 1, active);
+        return interpolate_weighted(v00, v10, v01, v11, w0, w1, wavelengths);
+    }
 
-        // Bilinear interpolation
+    /// Weighting step of \ref interpolate_bilinear, shared by both layouts
+    template <typename StorageType>
+    MTS_INLINE auto interpolate_weighted(const StorageType &v00,
+                                         const StorageType &v10,
+                                         const StorageType &v01,
+                                         const StorageType &v11,
+                                         const Point2f &w0, const Point2f &w1,
+                                         const Wavelength &wavelengths) const {
         if constexpr (is_spectral_v<Spectrum> && !Raw && Channels == 3) {
             // Evaluate spectral upsampling model from stored coefficients
             UnpolarizedSpectrum c00, c10, c01, c11, c0, c1;
 
-            c00 = srgb_model_eval<UnpolarizedSpectrum>(v00, si.wavelengths);
-            c10 = srgb_model_eval<UnpolarizedSpectrum>(v10, si.wavelengths);
-            c01 = srgb_model_eval<UnpolarizedSpectrum>(v01, si.wavelengths);
-            c11 = srgb_model_eval<UnpolarizedSpectrum>(v11, si.wavelengths);
+            c00 = srgb_model_eval<UnpolarizedSpectrum>(v00, wavelengths);
+            c10 = srgb_model_eval<UnpolarizedSpectrum>(v10, wavelengths);
+            c01 = srgb_model_eval<UnpolarizedSpectrum>(v01, wavelengths);
+            c11 = srgb_model_eval<UnpolarizedSpectrum>(v11, wavelengths);
 
             c0 = fmadd(w0.x(), c00, w1.x() * c10);
             c1 = fmadd(w0.x(), c01, w1.x() * c11);
@@ -297,33 +1115,101 @@ public:
         }
     }
 
+    MTS_INLINE auto interpolate(const SurfaceInteraction3f &si, Mask active) const {
+        if constexpr (!is_array_v<Mask>)
+            active = true;
+
+        Point2f uv = m_transform.transform_affine(si.uv);
+        uv -= floor(uv);
+
+        if constexpr (is_cuda_array_v<Float> || is_diff_array_v<Float>) {
+            return interpolate_bilinear(uv, 0u, Vector2u(m_resolution),
+                                        si.wavelengths, active);
+        } else {
+            uint32_t level_count = (uint32_t) m_level_offset.size();
+            if (level_count == 1)
+                return interpolate_bilinear(uv, 0u, Vector2u(m_resolution),
+                                            si.wavelengths, active);
+
+            /* Select the pyramid levels whose texel pitch brackets the
+               UV-space footprint given by the ray differentials. Lanes
+               without differentials have a zero footprint and sample the
+               finest level. */
+            Vector2f duv_dx = m_transform * si.duv_dx,
+                     duv_dy = m_transform * si.duv_dy;
+
+            Float footprint = max(norm(duv_dx), norm(duv_dy)) *
+                              ScalarFloat(hmax(m_resolution));
+
+            Float lod = clamp(log2(max(footprint, 1e-6f)), 0.f,
+                              ScalarFloat(level_count - 1));
+
+            UInt32 l0 = UInt32(lod),
+                   l1 = min(l0 + 1u, UInt32(level_count - 1));
+            Float a = lod - Float(l0);
+
+            auto fetch = [&](const UInt32 &l) {
+                constexpr size_t Stride = sizeof(ScalarVector2u);
+                UInt32 base = gather<UInt32>(m_level_offset.data(), l, active);
+                Vector2u res(
+                    gather<UInt32, Stride>((const uint32_t *) m_level_res.data(),     l, active),
+                    gather<UInt32, Stride>((const uint32_t *) m_level_res.data() + 1, l, active));
+                return interpolate_bilinear(uv, base, res, si.wavelengths, active);
+            };
+
+            // Trilinear interpolation across the two bracketing levels
+            auto r0 = fetch(l0),
+                 r1 = fetch(l1);
+            return fmadd(r1 - r0, a, r0);
+        }
+    }
+
     void parameters_changed() override {
+        /* The compressed representation is not exposed through traverse(),
+           hence the texel data cannot have changed */
+        if (m_compressed)
+            return;
+
         /// Convert m_data into a managed array (available in CPU/GPU address space)
         if constexpr (is_cuda_array_v<Float>)
             m_data = m_data.managed();
 
+        if (m_level_offset.size() > 1)
+            Log(Warn, "BitmapTexture: the mip hierarchy is not rebuilt after a "
+                      "parameter update; minified lookups will keep filtering "
+                      "the original image content.");
+
         // Recompute the mean texture value following an update
-        ScalarFloat *ptr = m_data.data();
+        bool half = !m_data_half.empty();
+        const ScalarFloat *ptr = m_data.data();
+
+        auto fetch = [&](size_t i) -> ScalarFloat {
+            return half ? (ScalarFloat) enoki::half::float16_to_float32(m_data_half[i])
+                        : ptr[i];
+        };
+
+        uint32_t tiles_x = (m_resolution.x() + TileMask) >> TileShift;
+        auto texel = [&](size_t i) -> size_t {
+            return m_tiled ? texel_index((uint32_t) (i % m_resolution.x()),
+                                         (uint32_t) (i / m_resolution.x()),
+                                         tiles_x)
+                           : i;
+        };
 
         double mean = 0.0;
         size_t pixel_count = hprod(m_resolution);
         if (Channels == 3) {
-            if (is_spectral_v<Spectrum> && !Raw) {
-                for (size_t i = 0; i < pixel_count; ++i) {
-                    ScalarColor3f value = load_unaligned<ScalarColor3f>(ptr);
+            for (size_t i = 0; i < pixel_count; ++i) {
+                size_t t = 3 * texel(i);
+                ScalarColor3f value(fetch(t), fetch(t + 1), fetch(t + 2));
+                if (is_spectral_v<Spectrum> && !Raw)
                     mean += (double) srgb_model_mean(value);
-                    ptr += 3;
-                }
-            } else {
-                for (size_t i = 0; i < pixel_count; ++i) {
-                    ScalarColor3f value = load_unaligned<ScalarColor3f>(ptr);
+                else
                     mean += (double) luminance(value);
-                    ptr += 3;
-                }
             }
         } else {
             for (size_t i = 0; i < pixel_count; ++i)
-                mean += (double) ptr[i];
+                mean += (double) fetch(texel(i));
         }
 
         m_mean = ScalarFloat(mean / pixel_count);
@@ -331,12 +1217,18 @@ public:
 
     ScalarFloat mean() const override { return m_mean; }
 
+    bool is_spatially_varying() const override { return true; }
+
     std::string to_string() const override {
         std::ostringstream oss;
         oss << "BitmapTextureImpl[" << std::endl
             << "  name = \"" << m_name << "\"," << std::endl
             << "  resolution = \"" << m_resolution << "\"," << std::endl
+            << "  levels = " << m_level_offset.size() << "," << std::endl
             << "  raw = " << (int) Raw << "," << std::endl
+            << "  half_precision = " << (int) !m_data_half.empty() << "," << std::endl
+            << "  tiled = " << (int) m_tiled << "," << std::endl
+            << "  compressed = " << (int) m_compressed << "," << std::endl
             << "  mean = " << m_mean << "," << std::endl
             << "  transform = " << string::indent(m_transform) << std::endl
             << "]";
@@ -346,7 +1238,20 @@ public:
     MTS_DECLARE_CLASS()
 protected:
     DynamicBuffer<Float> m_data;
+    /// Optional compact storage (single-precision CPU modes only)
+    std::vector<uint16_t> m_data_half;
+    /// Optional BC1 block-compressed storage (RGB CPU modes only)
+    std::vector<uint32_t> m_data_bc;
+    /// Shared mapping of the cache file aliased by \ref m_data (if any)
+    ref<MemoryMappedFile> m_cache;
+    /// Tiled texel layout (CPU modes only)
+    bool m_tiled;
+    /// BC1 block-compressed storage in use (see \ref m_data_bc)
+    bool m_compressed;
     ScalarVector2u m_resolution;
+    /// Base texel offset and resolution of each pyramid level within \ref m_data
+    std::vector<uint32_t> m_level_offset;
+    std::vector<ScalarVector2u> m_level_res;
     std::string m_name;
     ScalarTransform3f m_transform;
     ScalarFloat m_mean;
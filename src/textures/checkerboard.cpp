@@ -84,6 +84,62 @@ public:
         return result;
     }
 
+    void eval_n(const SurfaceInteraction3f *si, size_t count,
+                UnpolarizedSpectrum *out, Mask active = true) const override {
+        MTS_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+
+        /* One virtual call and profiler scope per batch; the UV transform
+           and nested texture pointers stay in registers across iterations */
+        for (size_t i = 0; i < count; ++i) {
+            const SurfaceInteraction3f &it = si[i];
+
+            Point2f uv = m_transform.transform_affine(it.uv);
+            mask_t<Point2f> mask = uv - floor(uv) > .5f;
+            UnpolarizedSpectrum result = zero<UnpolarizedSpectrum>();
+
+            Mask m0 = eq(mask.x(), mask.y()),
+                 m1 = !m0;
+
+            m0 &= active; m1 &= active;
+
+            if (any_or<true>(m0))
+                result[m0] = m_color0->eval(it, m0);
+
+            if (any_or<true>(m1))
+                result[m1] = m_color1->eval(it, m1);
+
+            out[i] = result;
+        }
+    }
+
+    void eval_1_n(const SurfaceInteraction3f *si, size_t count,
+                  Float *out, Mask active = true) const override {
+        MTS_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+
+        for (size_t i = 0; i < count; ++i) {
+            const SurfaceInteraction3f &it = si[i];
+
+            Point2f uv = m_transform.transform_affine(it.uv);
+            mask_t<Point2f> mask = (uv - floor(uv)) > .5f;
+            Float result = 0.f;
+
+            Mask m0 = neq(mask.x(), mask.y()),
+                 m1 = !m0;
+
+            m0 &= active; m1 &= active;
+
+            if (any_or<true>(m0))
+                masked(result, m0) = m_color0->eval_1(it, m0);
+
+            if (any_or<true>(m1))
+                masked(result, m1) = m_color1->eval_1(it, m1);
+
+            out[i] = result;
+        }
+    }
+
+    bool is_spatially_varying() const override { return true; }
+
     ScalarFloat mean() const override {
         return .5f * (m_color0->mean() + m_color1->mean());
     }
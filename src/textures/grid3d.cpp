@@ -4,6 +4,7 @@
 #include <mitsuba/core/spectrum.h>
 #include <mitsuba/core/string.h>
 #include <mitsuba/core/transform.h>
+#include <mitsuba/core/util.h>
 #include <mitsuba/render/srgb.h>
 #include <mitsuba/render/texture.h>
 #include <mitsuba/render/volume_texture.h>
@@ -62,9 +63,9 @@ public:
             }
             m_metadata.mean = mean;
             m_metadata.max = max;
-            m_data = DynamicBuffer<Float>::copy(scaled_data.get(), size * 4);
+            m_data = upload(scaled_data.get(), size * 4);
         } else {
-            m_data = DynamicBuffer<Float>::copy(raw_data.get(), size * m_metadata.channel_count);
+            m_data = upload(raw_data.get(), size * m_metadata.channel_count);
         }
 
         // Mark values which are only used in the implementation class as queried
@@ -76,6 +77,27 @@ public:
        return true; // dummy implementation
     }
 
+    /**
+     * \brief Transfer the loaded grid into a device-visible buffer
+     *
+     * Volume grids routinely dwarf image textures, so the GPU variants
+     * apply the same policy as the bitmap texture plugin (see \ref
+     * util::cuda_prefer_managed()): once the device fills up, further
+     * grids are placed in CUDA managed memory, where the driver pages in
+     * only the bricks that lookups actually touch.
+     */
+    static DynamicBuffer<Float> upload(const ScalarFloat *ptr, size_t count) {
+        if constexpr (is_cuda_array_v<Float>) {
+            size_t bytes = count * sizeof(ScalarFloat);
+            if (util::cuda_prefer_managed(bytes)) {
+                ScalarFloat *dst = (ScalarFloat *) cuda_managed_malloc(bytes);
+                memcpy(dst, ptr, bytes);
+                return DynamicBuffer<Float>::map(dst, count, true);
+            }
+        }
+        return DynamicBuffer<Float>::copy(ptr, count);
+    }
+
     template <uint32_t Channels, bool Raw> using Impl = GridVolumeImpl<Float, Spectrum, Channels, Raw>;
 
     /**
@@ -341,6 +363,86 @@ public:
     }
 
     ScalarFloat max() const override { return m_metadata.max; }
+
+    ScalarFloat max_over(const ScalarBoundingBox3f &bbox) const override {
+        if constexpr (is_cuda_array_v<Float> || is_diff_array_v<Float>) {
+            return max();
+        } else {
+            // Only single-channel (density) grids benefit from a local bound
+            if (Channels != 1 || m_fixed_max)
+                return max();
+
+            /* Conservative local-space bounds of the queried region */
+            ScalarBoundingBox3f local;
+            for (size_t i = 0; i < 8; ++i)
+                local.expand(m_world_to_local * bbox.corner(i));
+
+            const uint32_t nx = m_metadata.shape.x(),
+                           ny = m_metadata.shape.y(),
+                           nz = m_metadata.shape.z();
+
+            /* Grid nodes whose trilinear interpolants overlap the region */
+            ScalarVector3f scale(nx - 1.f, ny - 1.f, nz - 1.f);
+            ScalarPoint3i lo = max(ScalarPoint3i(floor(local.min * scale)),
+                                   ScalarPoint3i(0)),
+                          hi = min(ScalarPoint3i(ceil(local.max * scale)),
+                                   ScalarPoint3i(nx - 1, ny - 1, nz - 1));
+
+            if (any(hi < lo))
+                return 0.f;
+
+            const ScalarFloat *ptr = m_data.data();
+            ScalarFloat result = 0.f;
+            for (int z = lo.z(); z <= hi.z(); ++z)
+                for (int y = lo.y(); y <= hi.y(); ++y)
+                    for (int x = lo.x(); x <= hi.x(); ++x)
+                        result = std::max(
+                            result, ptr[(z * ny + y) * (size_t) nx + x]);
+            return result;
+        }
+    }
+
+    ScalarFloat mean_over(const ScalarBoundingBox3f &bbox) const override {
+        if constexpr (is_cuda_array_v<Float> || is_diff_array_v<Float>) {
+            return Base::mean_over(bbox);
+        } else {
+            if (Channels != 1 || m_fixed_max)
+                return Base::mean_over(bbox);
+
+            /* Conservative local-space bounds of the queried region */
+            ScalarBoundingBox3f local;
+            for (size_t i = 0; i < 8; ++i)
+                local.expand(m_world_to_local * bbox.corner(i));
+
+            const uint32_t nx = m_metadata.shape.x(),
+                           ny = m_metadata.shape.y(),
+                           nz = m_metadata.shape.z();
+
+            /* Average of the grid nodes whose trilinear interpolants overlap
+               the region (an estimate suffices, see Volume::mean_over()) */
+            ScalarVector3f scale(nx - 1.f, ny - 1.f, nz - 1.f);
+            ScalarPoint3i lo = max(ScalarPoint3i(floor(local.min * scale)),
+                                   ScalarPoint3i(0)),
+                          hi = min(ScalarPoint3i(ceil(local.max * scale)),
+                                   ScalarPoint3i(nx - 1, ny - 1, nz - 1));
+
+            if (any(hi < lo))
+                return 0.f;
+
+            const ScalarFloat *ptr = m_data.data();
+            double sum = 0.0;
+            for (int z = lo.z(); z <= hi.z(); ++z)
+                for (int y = lo.y(); y <= hi.y(); ++y)
+                    for (int x = lo.x(); x <= hi.x(); ++x)
+                        sum += ptr[(z * ny + y) * (size_t) nx + x];
+
+            size_t count = (size_t) (hi.x() - lo.x() + 1) *
+                           (size_t) (hi.y() - lo.y() + 1) *
+                           (size_t) (hi.z() - lo.z() + 1);
+            return (ScalarFloat) (sum / count);
+        }
+    }
+
     ScalarVector3i resolution() const override { return m_metadata.shape; };
     size_t data_size() const { return m_data.size(); }
 
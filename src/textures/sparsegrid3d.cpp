@@ -0,0 +1,550 @@
+#include <enoki/stl.h>
+
+#include <mitsuba/core/mmap.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/spectrum.h>
+#include <mitsuba/core/string.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/transform.h>
+#include <mitsuba/core/util.h>
+#include <mitsuba/render/texture.h>
+#include <mitsuba/render/volume_texture.h>
+
+#include "volume_data.h"
+
+NAMESPACE_BEGIN(mitsuba)
+
+NAMESPACE_BEGIN(detail)
+
+#pragma pack(push, 1)
+/// On-disk header of the sparse brick volume format (little-endian)
+struct SparseVolumeHeader {
+    char magic[3];         ///< 'S', 'V', 'L'
+    uint8_t version;       ///< Currently 1
+    int32_t data_type;     ///< 1 = Float32 (matching the dense format)
+    int32_t shape[3];      ///< Voxel resolution of the full grid
+    int32_t channel_count; ///< 1 or 3
+    float bbox[6];         ///< Axis-aligned bounding box (min, max)
+    int32_t brick_size;    ///< Brick edge length in cells (power of two)
+    double mean;           ///< Mean value over the full grid
+    float max;             ///< Maximum value over the full grid
+    int32_t slot_count;    ///< Number of stored bricks, incl. the zero brick
+};
+#pragma pack(pop)
+
+static_assert(sizeof(SparseVolumeHeader) == 68,
+              "SparseVolumeHeader must remain tightly packed");
+
+/**
+ * Converts a dense Mitsuba binary volume into the sparse brick format and
+ * writes the result to \c target. Bricks whose values all lie below
+ * \c threshold are dropped and remapped to a shared all-zero brick.
+ */
+template <typename Float>
+void write_sparse_volume_cache(const std::string &filename,
+                               const fs::path &target, uint32_t brick_size,
+                               scalar_t<Float> threshold) {
+    MTS_IMPORT_CORE_TYPES()
+
+    Timer timer;
+    auto [meta, data] = read_binary_volume_data<Float>(filename);
+    if (meta.channel_count != 1 && meta.channel_count != 3)
+        Throw("Unsupported channel count: %d (expected 1 or 3)",
+              meta.channel_count);
+
+    const uint32_t ch    = (uint32_t) meta.channel_count,
+                   apron = brick_size + 1;
+    const ScalarVector3i shape = meta.shape;
+    // Number of cell bricks per axis: ceil((shape - 1) / brick_size)
+    const ScalarVector3i nb((shape.x() + brick_size - 2) / brick_size,
+                            (shape.y() + brick_size - 2) / brick_size,
+                            (shape.z() + brick_size - 2) / brick_size);
+
+    size_t brick_count  = (size_t) nb.x() * nb.y() * nb.z(),
+           brick_floats = (size_t) apron * apron * apron * ch;
+
+    std::vector<int32_t> index(brick_count, 0);
+    std::vector<float> brick_max(brick_count, 0.f);
+    // Slot 0 is reserved for the shared all-zero brick
+    std::vector<float> voxels(brick_floats, 0.f);
+    std::vector<float> brick(brick_floats);
+
+    const ScalarFloat *src = data.get();
+    int32_t slot = 1;
+    size_t b = 0;
+    for (int32_t bz = 0; bz < nb.z(); ++bz) {
+        for (int32_t by = 0; by < nb.y(); ++by) {
+            for (int32_t bx = 0; bx < nb.x(); ++bx, ++b) {
+                /* Copy the brick including a one-voxel apron so that all
+                   eight corners of any cell live in the same brick. Voxels
+                   past the grid boundary repeat the boundary value. */
+                float vmax = 0.f;
+                size_t k = 0;
+                for (uint32_t lz = 0; lz < apron; ++lz) {
+                    int32_t z = std::min((int32_t) (bz * brick_size + lz), shape.z() - 1);
+                    for (uint32_t ly = 0; ly < apron; ++ly) {
+                        int32_t y = std::min((int32_t) (by * brick_size + ly), shape.y() - 1);
+                        for (uint32_t lx = 0; lx < apron; ++lx) {
+                            int32_t x = std::min((int32_t) (bx * brick_size + lx), shape.x() - 1);
+                            size_t voxel = (((size_t) z * shape.y() + y) * shape.x() + x) * ch;
+                            for (uint32_t c = 0; c < ch; ++c) {
+                                float v = (float) src[voxel + c];
+                                brick[k++] = v;
+                                vmax = std::max(vmax, v);
+                            }
+                        }
+                    }
+                }
+
+                if (vmax > threshold) {
+                    index[b]     = slot++;
+                    brick_max[b] = vmax;
+                    voxels.insert(voxels.end(), brick.begin(), brick.end());
+                }
+            }
+        }
+    }
+
+    SparseVolumeHeader header;
+    header.magic[0]      = 'S';
+    header.magic[1]      = 'V';
+    header.magic[2]      = 'L';
+    header.version       = 1;
+    header.data_type     = 1;
+    header.shape[0]      = shape.x();
+    header.shape[1]      = shape.y();
+    header.shape[2]      = shape.z();
+    header.channel_count = (int32_t) ch;
+    for (size_t i = 0; i < 3; ++i) {
+        header.bbox[i]     = (float) meta.bbox.min[i];
+        header.bbox[i + 3] = (float) meta.bbox.max[i];
+    }
+    header.brick_size = (int32_t) brick_size;
+    header.mean       = meta.mean;
+    header.max        = (float) meta.max;
+    header.slot_count = slot;
+
+    std::ofstream f(target.string(), std::ios::binary | std::ios::trunc);
+    if (!f.good())
+        Throw("Unable to open sparse volume cache \"%s\" for writing!",
+              target.string());
+    f.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    f.write(reinterpret_cast<const char *>(index.data()),
+            index.size() * sizeof(int32_t));
+    f.write(reinterpret_cast<const char *>(brick_max.data()),
+            brick_max.size() * sizeof(float));
+    f.write(reinterpret_cast<const char *>(voxels.data()),
+            voxels.size() * sizeof(float));
+    f.close();
+
+    Log(Info, "Wrote sparse volume cache \"%s\": %d/%d non-empty bricks "
+        "(%.1f%% occupancy, took %s)", target.string(), slot - 1, brick_count,
+        brick_count > 0 ? 100.f * (float) (slot - 1) / (float) brick_count : 0.f,
+        util::time_string(timer.value()));
+}
+
+NAMESPACE_END(detail)
+
+// Forward declaration of specialized SparseGridVolume
+template <typename Float, typename Spectrum, uint32_t Channels>
+class SparseGridVolumeImpl;
+
+/**
+ * Sparse brick-based 3D grid texture of scalar or color values.
+ *
+ * Unlike the dense \ref GridVolume plugin, the voxel data is stored as a flat
+ * list of dense bricks (edge length \c brick_size cells, plus a one-voxel
+ * apron so that trilinear interpolation never crosses brick boundaries) and a
+ * top-level index mapping each brick position to a storage slot. Bricks whose
+ * values all lie below \c sparse_threshold are not stored at all -- they map
+ * to a shared zero brick -- which reduces mostly-empty production volumes to
+ * a small fraction of their dense footprint.
+ *
+ * The file is accessed through a memory mapping rather than being copied into
+ * RAM, so concurrent jobs rendering the same volume on one node share the
+ * physical pages. When given a dense .vol file, the plugin converts it once
+ * and caches the result as a sibling .svol file that later runs (and other
+ * processes) reuse; delete the cache to force a rebuild.
+ *
+ * Data layout of the .svol format (little-endian):
+ *     header (see detail::SparseVolumeHeader),
+ *     int32   index[num_bricks]      (storage slot, 0 = shared zero brick)
+ *     float32 brick_max[num_bricks]  (upper bound of each brick's values)
+ *     float32 data[slot_count * (brick_size+1)^3 * channels]
+ * where num_bricks = prod(ceil((shape - 1) / brick_size)) and bricks are
+ * ordered as data[((zpos*nby + ypos)*nbx + xpos)].
+ *
+ * Only available in single-precision CPU variants: the mapped data is read
+ * in place as float32, and spectral upsampling of RGB data (which rewrites
+ * the voxel values in the dense plugin) is not supported.
+ */
+template <typename Float, typename Spectrum>
+class SparseGridVolume final : public Volume<Float, Spectrum> {
+public:
+    MTS_IMPORT_BASE(Volume, m_world_to_local)
+    MTS_IMPORT_TYPES()
+
+    SparseGridVolume(const Properties &props) : Base(props), m_props(props) {
+        if constexpr (is_cuda_array_v<Float> || is_diff_array_v<Float> ||
+                      !std::is_same_v<ScalarFloat, float>) {
+            Throw("The sparse grid volume is only available in "
+                  "single-precision CPU variants -- use 'gridvolume' instead.");
+        } else {
+            auto fs = Thread::thread()->file_resolver();
+            fs::path path = fs->resolve(props.string("filename"));
+
+            uint32_t brick_size = (uint32_t) props.size_("brick_size", 16);
+            if (brick_size < 2 || !math::is_power_of_two(brick_size))
+                Throw("Invalid brick size %d: must be a power of two >= 2!",
+                      brick_size);
+            ScalarFloat threshold = props.float_("sparse_threshold", 0.f);
+
+            if (string::to_lower(path.extension().string()) != ".svol") {
+                fs::path cache = path;
+                cache.replace_extension(".svol");
+                if (!fs::exists(cache))
+                    detail::write_sparse_volume_cache<Float>(
+                        path.string(), cache, brick_size, threshold);
+                else
+                    Log(Info, "Reusing existing sparse volume cache \"%s\"",
+                        cache.string());
+                path = cache;
+            }
+
+            m_mmap = new MemoryMappedFile(path);
+            if (m_mmap->size() < sizeof(detail::SparseVolumeHeader))
+                Throw("Invalid sparse volume file \"%s\": too small!",
+                      path.string());
+            auto *header = (const detail::SparseVolumeHeader *) m_mmap->data();
+            if (header->magic[0] != 'S' || header->magic[1] != 'V' ||
+                header->magic[2] != 'L')
+                Throw("Invalid sparse volume file \"%s\"", path.string());
+            if (header->version != 1)
+                Throw("Invalid version, currently only version 1 is "
+                      "supported (found %d)", header->version);
+            if (header->data_type != 1)
+                Throw("Wrong type, currently only type == 1 (Float32) data "
+                      "is supported (found type = %d)", header->data_type);
+            if (header->brick_size < 2 ||
+                !math::is_power_of_two(header->brick_size))
+                Throw("Invalid brick size %d in \"%s\": must be a power of "
+                      "two >= 2!", header->brick_size, path.string());
+
+            m_metadata.filename      = path.string();
+            m_metadata.version       = header->version;
+            m_metadata.data_type     = header->data_type;
+            m_metadata.shape         = ScalarVector3i(
+                header->shape[0], header->shape[1], header->shape[2]);
+            m_metadata.channel_count = (size_t) header->channel_count;
+            m_metadata.bbox          = ScalarBoundingBox3f(
+                ScalarPoint3f(header->bbox[0], header->bbox[1], header->bbox[2]),
+                ScalarPoint3f(header->bbox[3], header->bbox[4], header->bbox[5]));
+            m_metadata.transform     = detail::bbox_transform(m_metadata.bbox);
+            m_metadata.mean          = header->mean;
+            m_metadata.max           = header->max;
+
+            // Mark values which are only used in the implementation class as queried
+            props.mark_queried("use_grid_bbox");
+            props.mark_queried("max_value");
+        }
+    }
+
+    Mask is_inside(const Interaction3f & /* it */, Mask /*active*/) const override {
+        return true; // dummy implementation
+    }
+
+    template <uint32_t Channels>
+    using Impl = SparseGridVolumeImpl<Float, Spectrum, Channels>;
+
+    /**
+     * Recursively expand into an implementation specialized to the actual loaded grid.
+     */
+    std::vector<ref<Object>> expand() const override {
+        ref<Object> result;
+        switch (m_metadata.channel_count) {
+            case 1:
+                result = (Object *) new Impl<1>(m_props, m_metadata, m_mmap);
+                break;
+            case 3:
+                result = (Object *) new Impl<3>(m_props, m_metadata, m_mmap);
+                break;
+            default:
+                Throw("Unsupported channel count: %d (expected 1 or 3)",
+                      m_metadata.channel_count);
+        }
+        return { result };
+    }
+
+    MTS_DECLARE_CLASS()
+protected:
+    ref<MemoryMappedFile> m_mmap;
+    VolumeMetadata m_metadata;
+    Properties m_props;
+};
+
+template <typename Float, typename Spectrum, uint32_t Channels>
+class SparseGridVolumeImpl final : public Volume<Float, Spectrum> {
+public:
+    MTS_IMPORT_BASE(Volume, is_inside, update_bbox, m_world_to_local)
+    MTS_IMPORT_TYPES()
+
+    SparseGridVolumeImpl(const Properties &props, const VolumeMetadata &meta,
+                         MemoryMappedFile *mmap)
+        : Base(props) {
+
+        m_mmap     = mmap;
+        m_metadata = meta;
+
+        auto *header = (const detail::SparseVolumeHeader *) mmap->data();
+        m_brick_size  = (uint32_t) header->brick_size;
+        m_brick_shift = (uint32_t) enoki::log2i(m_brick_size);
+        m_brick_mask  = m_brick_size - 1;
+        m_apron       = m_brick_size + 1;
+        m_apron2      = m_apron * m_apron;
+        m_brick_voxels = m_apron * m_apron2;
+        m_bricks = ScalarVector3i(
+            (m_metadata.shape.x() + m_brick_size - 2) / m_brick_size,
+            (m_metadata.shape.y() + m_brick_size - 2) / m_brick_size,
+            (m_metadata.shape.z() + m_brick_size - 2) / m_brick_size);
+
+        size_t brick_count = (size_t) m_bricks.x() * m_bricks.y() * m_bricks.z(),
+               expected    = sizeof(detail::SparseVolumeHeader) +
+                             brick_count * (sizeof(int32_t) + sizeof(float)) +
+                             (size_t) header->slot_count * m_brick_voxels *
+                                 Channels * sizeof(float);
+        if (mmap->size() < expected)
+            Throw("Truncated sparse volume file \"%s\": expected %d bytes, "
+                  "found %d!", meta.filename, expected, mmap->size());
+
+        auto *base  = (const uint8_t *) mmap->data() +
+                      sizeof(detail::SparseVolumeHeader);
+        m_index     = (const uint32_t *) base;
+        m_brick_max = (const float *) (base + brick_count * sizeof(int32_t));
+        m_voxels    = (const float *) (m_brick_max + brick_count);
+
+        if (props.bool_("use_grid_bbox", false)) {
+            m_world_to_local = m_metadata.transform * m_world_to_local;
+            update_bbox();
+        }
+
+        if (props.has_property("max_value")) {
+            m_fixed_max    = true;
+            m_metadata.max = props.float_("max_value");
+        }
+    }
+
+    UnpolarizedSpectrum eval(const Interaction3f &it, Mask active) const override {
+        ENOKI_MARK_USED(it);
+        ENOKI_MARK_USED(active);
+
+        if constexpr (Channels == 3 && is_spectral_v<Spectrum>) {
+            Throw("The SparseGridVolume texture %s was queried for a spectrum, but "
+                  "spectral conversion of memory-mapped data is not supported!",
+                  to_string());
+        } else {
+            auto result = eval_impl(it, active);
+
+            if constexpr (Channels == 3 && is_monochromatic_v<Spectrum>)
+                return mitsuba::luminance(Color3f(result));
+            else if constexpr (Channels == 1)
+                return result.x();
+            else
+                return result;
+        }
+    }
+
+    Float eval_1(const Interaction3f &it, Mask active = true) const override {
+        auto result = eval_impl(it, active);
+        if constexpr (Channels == 3)
+            return mitsuba::luminance(Color3f(result));
+        else
+            return hmean(result);
+    }
+
+    Vector3f eval_3(const Interaction3f &it, Mask active = true) const override {
+        ENOKI_MARK_USED(it);
+        ENOKI_MARK_USED(active);
+
+        if constexpr (Channels != 3) {
+            Throw("eval_3(): The SparseGridVolume texture %s was queried for a 3D "
+                  "vector, but it has only a single channel!", to_string());
+        } else {
+            return eval_impl(it, active);
+        }
+    }
+
+    MTS_INLINE auto eval_impl(const Interaction3f &it, Mask active) const {
+        MTS_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+
+        using StorageType = Array<Float, Channels>;
+
+        auto p = m_world_to_local * it.p;
+        active &= all((p >= 0) && (p <= 1));
+
+        if (none_or<false>(active))
+            return zero<StorageType>();
+        StorageType result = interpolate(p, active);
+        return select(active, result, zero<StorageType>());
+    }
+
+    Mask is_inside(const Interaction3f &it, Mask /*active*/) const override {
+        auto p = m_world_to_local * it.p;
+        return all((p >= 0) && (p <= 1));
+    }
+
+    /**
+     * Taking a 3D point in [0, 1)^3, estimates the grid's value at that
+     * point using trilinear interpolation.
+     *
+     * The brick and in-brick voxel of each lane are resolved with shifts,
+     * masks and a gather from the top-level index -- there is no per-lane
+     * branching, and lanes in empty bricks read the shared zero brick. The
+     * one-voxel apron guarantees that all eight interpolation corners lie
+     * within a single brick.
+     */
+    MTS_INLINE Array<Float, Channels> interpolate(Point3f p, Mask active) const {
+        using Index       = uint32_array_t<Float>;
+        using Index3      = uint32_array_t<Point3f>;
+        using StorageType = Array<Float, Channels>;
+
+        const uint32_t nx = m_metadata.shape.x();
+        const uint32_t ny = m_metadata.shape.y();
+        const uint32_t nz = m_metadata.shape.z();
+
+        Point3f max_coordinates(nx - 1.f, ny - 1.f, nz - 1.f);
+        p *= max_coordinates;
+
+        // Integer part (clamped to include the upper bound)
+        Index3 pi  = enoki::floor2int<Index3>(p);
+        pi[active] = clamp(pi, 0, max_coordinates - 1);
+
+        // Fractional part
+        Point3f f = p - Point3f(pi), rf = 1.f - f;
+        active &= all(pi >= 0u && (pi + 1u) < Index3(nx, ny, nz));
+
+        // Brick position and in-brick voxel
+        Index3 bi = pi >> m_brick_shift,
+               li = pi & m_brick_mask;
+
+        Index brick = fmadd(fmadd(bi.z(), (uint32_t) m_bricks.y(), bi.y()),
+                            (uint32_t) m_bricks.x(), bi.x());
+        Index slot  = gather<Index>(m_index, brick, active);
+        Index index = fmadd(fmadd(li.z(), m_apron, li.y()), m_apron, li.x()) +
+                      slot * m_brick_voxels;
+
+        // Load 8 grid positions to perform trilinear interpolation
+        auto raw_data = m_voxels;
+        auto d000 = gather<StorageType>(raw_data, index, active),
+             d001 = gather<StorageType>(raw_data, index + 1, active),
+             d010 = gather<StorageType>(raw_data, index + m_apron, active),
+             d011 = gather<StorageType>(raw_data, index + m_apron + 1, active),
+             d100 = gather<StorageType>(raw_data, index + m_apron2, active),
+             d101 = gather<StorageType>(raw_data, index + m_apron2 + 1, active),
+             d110 = gather<StorageType>(raw_data, index + m_apron2 + m_apron, active),
+             d111 = gather<StorageType>(raw_data, index + m_apron2 + m_apron + 1, active);
+
+        // Trilinear interpolation
+        StorageType v00 = fmadd(d000, rf.x(), d001 * f.x()),
+                    v01 = fmadd(d010, rf.x(), d011 * f.x()),
+                    v10 = fmadd(d100, rf.x(), d101 * f.x()),
+                    v11 = fmadd(d110, rf.x(), d111 * f.x());
+        StorageType v0  = fmadd(v00, rf.y(), v01 * f.y()),
+                    v1  = fmadd(v10, rf.y(), v11 * f.y());
+        return fmadd(v0, rf.z(), v1 * f.z());
+    }
+
+    ScalarFloat max() const override { return m_metadata.max; }
+
+    ScalarFloat max_over(const ScalarBoundingBox3f &bbox) const override {
+        if (m_fixed_max)
+            return max();
+
+        /* Conservative local-space bounds of the queried region */
+        ScalarBoundingBox3f local;
+        for (size_t i = 0; i < 8; ++i)
+            local.expand(m_world_to_local * bbox.corner(i));
+
+        const uint32_t nx = m_metadata.shape.x(),
+                       ny = m_metadata.shape.y(),
+                       nz = m_metadata.shape.z();
+
+        /* Grid nodes whose trilinear interpolants overlap the region,
+           then the bricks containing those nodes */
+        ScalarVector3f scale(nx - 1.f, ny - 1.f, nz - 1.f);
+        ScalarPoint3i lo = max(ScalarPoint3i(floor(local.min * scale)),
+                               ScalarPoint3i(0)),
+                      hi = min(ScalarPoint3i(ceil(local.max * scale)),
+                               ScalarPoint3i(nx - 1, ny - 1, nz - 1));
+
+        if (any(hi < lo))
+            return 0.f;
+
+        lo = min(lo >> (int32_t) m_brick_shift, m_bricks - 1);
+        hi = min(hi >> (int32_t) m_brick_shift, m_bricks - 1);
+
+        ScalarFloat result = 0.f;
+        for (int z = lo.z(); z <= hi.z(); ++z)
+            for (int y = lo.y(); y <= hi.y(); ++y)
+                for (int x = lo.x(); x <= hi.x(); ++x)
+                    result = std::max(
+                        result,
+                        m_brick_max[(z * m_bricks.y() + y) *
+                                    (size_t) m_bricks.x() + x]);
+        return result;
+    }
+
+    ScalarVector3i resolution() const override { return m_metadata.shape; };
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "SparseGridVolume[" << std::endl
+            << "  world_to_local = " << m_world_to_local << "," << std::endl
+            << "  dimensions = " << m_metadata.shape << "," << std::endl
+            << "  bricks = " << m_bricks << " (size " << m_brick_size << ")," << std::endl
+            << "  mean = " << m_metadata.mean << "," << std::endl
+            << "  max = " << m_metadata.max << "," << std::endl
+            << "  channels = " << m_metadata.channel_count << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MTS_DECLARE_CLASS()
+protected:
+    ref<MemoryMappedFile> m_mmap;
+    bool m_fixed_max = false;
+    VolumeMetadata m_metadata;
+
+    uint32_t m_brick_size, m_brick_shift, m_brick_mask;
+    uint32_t m_apron, m_apron2, m_brick_voxels;
+    ScalarVector3i m_bricks;
+
+    // Pointers into the memory mapping
+    const uint32_t *m_index;
+    const float *m_brick_max;
+    const float *m_voxels;
+};
+
+MTS_IMPLEMENT_CLASS_VARIANT(SparseGridVolume, Volume)
+MTS_EXPORT_PLUGIN(SparseGridVolume, "SparseGridVolume texture")
+
+NAMESPACE_BEGIN(detail)
+template <uint32_t Channels>
+constexpr const char * sparsegridvolume_class_name() {
+    if constexpr (Channels == 1)
+        return "SparseGridVolumeImpl_1";
+    else
+        return "SparseGridVolumeImpl_3";
+}
+NAMESPACE_END(detail)
+
+template <typename Float, typename Spectrum, uint32_t Channels>
+Class *SparseGridVolumeImpl<Float, Spectrum, Channels>::m_class
+    = new Class(detail::sparsegridvolume_class_name<Channels>(), "Volume",
+                ::mitsuba::detail::get_variant<Float, Spectrum>(), nullptr, nullptr);
+
+template <typename Float, typename Spectrum, uint32_t Channels>
+const Class* SparseGridVolumeImpl<Float, Spectrum, Channels>::class_() const {
+    return m_class;
+}
+
+NAMESPACE_END(mitsuba)
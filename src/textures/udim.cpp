@@ -0,0 +1,300 @@
+#include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/plugin.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/transform.h>
+#include <mitsuba/render/interaction.h>
+#include <mitsuba/render/texture.h>
+#include <atomic>
+#include <mutex>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _texture-udim:
+
+UDIM texture set (:monosp:`udim`)
+---------------------------------
+
+.. pluginparameters::
+
+ * - filename
+   - |string|
+   - Filename pattern of the tile set, containing the literal token
+     :monosp:`<UDIM>` that is substituted by the tile number
+     (e.g. :monosp:`character_color.<UDIM>.exr`)
+ * - raw
+   - |bool|
+   - Should the transformation to the stored color data
+     (e.g. sRGB to linear, spectral upsampling) be disabled? (Default: false)
+ * - to_uv
+   - |transform|
+   - Specifies an optional uv transformation that is applied before the
+     tile lookup. (Default: none)
+ * - mipmap
+   - |bool|
+   - Build a mip hierarchy for each tile at load time (see the
+     :ref:`bitmap <texture-bitmap>` texture). (Default: false)
+ * - half_precision
+   - |bool|
+   - Store the tile data in half precision (see the
+     :ref:`bitmap <texture-bitmap>` texture). (Default: false)
+ * - cache
+   - |bool|
+   - Cache the converted tile data on disk and memory-map it read-only (see
+     the :ref:`bitmap <texture-bitmap>` texture). Strongly recommended for
+     UDIM sets: mapped tiles are backed by the operating system's page
+     cache, so tiles that fall out of the working set are evicted under
+     memory pressure and reloading one later merely faults its pages back
+     in. (Default: false)
+
+This plugin provides lookups into a UDIM texture set: a grid of up to 10x10
+image tiles following the usual numbering convention, where tile
+:math:`1001 + u + 10\,v` covers the unit square with corner :math:`(u, v)`
+in UV space. Assets textured across many tiles (e.g. film characters) can
+then be rendered without stitching the set into one monolithic image.
+
+The constructor merely scans which tiles of the set exist on disk; each
+tile is decoded on the first texture evaluation that touches its UV region.
+A close-up shot therefore loads the one or two tiles that are actually
+visible rather than the entire set. Lookups into missing tiles evaluate to
+zero (reported once per tile). Texture filtering never crosses tile
+boundaries, matching the usual convention that UDIM tiles are laid out with
+their seams along UV integer lines.
+
+Only the CPU modes are supported -- lazy tile loading is incompatible with
+the ahead-of-time kernel compilation of the GPU backend. The value reported
+by :monosp:`mean()` reflects the tiles loaded so far, which suffices for
+the heuristics (e.g. sampling weights) that consume it.
+
+ */
+
+template <typename Float, typename Spectrum>
+class UDIMTexture final : public Texture<Float, Spectrum> {
+public:
+    MTS_IMPORT_TYPES(Texture)
+
+    UDIMTexture(const Properties &props) : Texture(props) {
+        if constexpr (is_cuda_array_v<Float>)
+            Throw("The UDIM texture set is not supported in GPU modes!");
+
+        m_transform = props.transform("to_uv", ScalarTransform4f()).extract();
+
+        std::string pattern = props.string("filename");
+        size_t token = pattern.find("<UDIM>");
+        if (token == std::string::npos)
+            Throw("UDIM filename pattern \"%s\" does not contain the "
+                  "\"<UDIM>\" token!", pattern);
+
+        /* Forwarded verbatim to the per-tile bitmap textures; the to_uv
+           transform is applied here, before the tile lookup. */
+        m_tile_props = Properties("bitmap");
+        m_tile_props.set_bool("raw", props.bool_("raw", false));
+        m_tile_props.set_bool("mipmap", props.bool_("mipmap", false));
+        m_tile_props.set_bool("half_precision",
+                              props.bool_("half_precision", false));
+        m_tile_props.set_bool("cache", props.bool_("cache", false));
+
+        /* Scan which tiles exist on disk without decoding any of them.
+           The UDIM convention addresses a 10x10 grid (tiles 1001-1100). */
+        FileResolver *fs = Thread::thread()->file_resolver();
+        m_tiles.reset(new Tile[GridSize * GridSize]);
+        m_rows = 0;
+
+        size_t tile_count = 0;
+        for (uint32_t v = 0; v < GridSize; ++v) {
+            for (uint32_t u = 0; u < GridSize; ++u) {
+                std::string name = pattern.substr(0, token) +
+                                   std::to_string(1001 + u + 10 * v) +
+                                   pattern.substr(token + 6);
+                fs::path path = fs->resolve(name);
+                if (!fs::exists(path))
+                    continue;
+
+                Tile &tile = m_tiles[u + v * GridSize];
+                tile.path = path;
+                tile.exists = true;
+                m_rows = v + 1;
+                tile_count++;
+            }
+        }
+
+        if (tile_count == 0)
+            Throw("UDIM filename pattern \"%s\" did not match any tiles!",
+                  pattern);
+
+        Log(Info, "UDIM texture set \"%s\": found %i tiles (loaded on demand).",
+            pattern, tile_count);
+    }
+
+    UnpolarizedSpectrum eval(const SurfaceInteraction3f &si, Mask active) const override {
+        MTS_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+        return dispatch<UnpolarizedSpectrum>(
+            si, active, [](const Texture *tex, const SurfaceInteraction3f &si2,
+                           Mask m) { return tex->eval(si2, m); });
+    }
+
+    Float eval_1(const SurfaceInteraction3f &si, Mask active = true) const override {
+        MTS_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+        return dispatch<Float>(
+            si, active, [](const Texture *tex, const SurfaceInteraction3f &si2,
+                           Mask m) { return tex->eval_1(si2, m); });
+    }
+
+    Color3f eval_3(const SurfaceInteraction3f &si, Mask active = true) const override {
+        MTS_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+        return dispatch<Color3f>(
+            si, active, [](const Texture *tex, const SurfaceInteraction3f &si2,
+                           Mask m) { return tex->eval_3(si2, m); });
+    }
+
+    ScalarFloat mean() const override {
+        /* Computed over the tiles loaded so far -- loading the entire set
+           here would defeat the purpose of the lazy representation */
+        double mean = 0.0;
+        size_t loaded = 0;
+        for (uint32_t i = 0; i < GridSize * GridSize; ++i) {
+            const Texture *tex =
+                m_tiles[i].texture.load(std::memory_order_acquire);
+            if (!tex)
+                continue;
+            mean += (double) tex->mean();
+            loaded++;
+        }
+        return loaded > 0 ? ScalarFloat(mean / loaded) : ScalarFloat(0.5f);
+    }
+
+    bool is_spatially_varying() const override { return true; }
+
+    std::string to_string() const override {
+        size_t exists = 0, loaded = 0;
+        for (uint32_t i = 0; i < GridSize * GridSize; ++i) {
+            exists += m_tiles[i].exists ? 1 : 0;
+            loaded += m_tiles[i].texture.load(std::memory_order_relaxed) ? 1 : 0;
+        }
+
+        std::ostringstream oss;
+        oss << "UDIMTexture[" << std::endl
+            << "  tiles = " << exists << " (" << loaded << " loaded)," << std::endl
+            << "  transform = " << string::indent(m_transform) << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MTS_DECLARE_CLASS()
+protected:
+    /// Extent of the UDIM tile grid along each axis
+    static constexpr uint32_t GridSize = 10;
+
+    struct Tile {
+        fs::path path;
+        bool exists = false;
+        /// Published via release store once fully constructed
+        std::atomic<const Texture *> texture { nullptr };
+        /// Holds the reference backing \ref texture
+        ref<Texture> holder;
+        /// Nonzero once a lookup into a missing tile has been reported
+        std::atomic<uint8_t> warned { 0 };
+    };
+
+    /**
+     * \brief Return the texture of the given tile, decoding it on first use
+     *
+     * The fast path is a single acquire load; the first thread to touch a
+     * tile constructs its bitmap texture under \ref m_mutex while concurrent
+     * lookups into other (already loaded) tiles proceed unhindered.
+     * Returns \c nullptr for tiles that do not exist on disk.
+     */
+    const Texture *tile_texture(uint32_t index) const {
+        Tile &tile = m_tiles[index];
+
+        const Texture *tex = tile.texture.load(std::memory_order_acquire);
+        if (likely(tex))
+            return tex;
+
+        if (!tile.exists) {
+            if (tile.warned.exchange(1, std::memory_order_relaxed) == 0)
+                Log(Warn, "UDIM lookup into missing tile %i -- evaluating "
+                          "to zero.", 1001 + index % GridSize +
+                          10 * (index / GridSize));
+            return nullptr;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        tex = tile.texture.load(std::memory_order_relaxed);
+        if (tex) // Another thread finished the load in the meantime
+            return tex;
+
+        Properties props(m_tile_props);
+        props.set_string("filename", tile.path.string());
+
+        ref<Object> obj = PluginManager::instance()->create_object(
+            props, Class::for_name("Texture",
+                                   ::mitsuba::detail::get_variant<Float, Spectrum>()));
+        auto expanded = obj->expand();
+        Assert(expanded.size() <= 1);
+        if (!expanded.empty())
+            obj = expanded[0];
+
+        tile.holder = dynamic_cast<Texture *>(obj.get());
+        Assert(tile.holder);
+        tile.texture.store(tile.holder.get(), std::memory_order_release);
+        return tile.holder.get();
+    }
+
+    /// Group the active lanes by tile and delegate to the tile textures
+    template <typename Result, typename Func>
+    Result dispatch(const SurfaceInteraction3f &si, Mask active,
+                    Func &&func) const {
+        Point2f uv = m_transform.transform_affine(si.uv);
+        Point2f tile_f = floor(uv);
+
+        Mask valid = active &&
+                     tile_f.x() >= 0.f && tile_f.x() < (ScalarFloat) GridSize &&
+                     tile_f.y() >= 0.f && tile_f.y() < (ScalarFloat) m_rows;
+
+        UInt32 tile = UInt32(max(tile_f.x(), 0.f)) +
+                      UInt32(max(tile_f.y(), 0.f)) * GridSize;
+
+        SurfaceInteraction3f si2(si);
+        si2.uv     = uv - tile_f;
+        si2.duv_dx = m_transform * si.duv_dx;
+        si2.duv_dy = m_transform * si.duv_dy;
+
+        Result result = zero<Result>();
+
+        Mask todo = valid;
+        while (any(todo)) {
+            // Process all lanes that fall into the first remaining tile
+            uint32_t t = 0;
+            for (size_t l = 0; l < slices(todo); ++l) {
+                if (slice(todo, l)) {
+                    t = (uint32_t) slice(tile, l);
+                    break;
+                }
+            }
+
+            Mask m = todo && eq(tile, t);
+            const Texture *tex = tile_texture(t);
+            if (tex)
+                masked(result, m) = func(tex, si2, m);
+            todo = andnot(todo, m);
+        }
+
+        return result;
+    }
+
+    mutable std::unique_ptr<Tile[]> m_tiles;
+    /// Serializes tile loads (never held on the lookup fast path)
+    mutable std::mutex m_mutex;
+    /// Properties forwarded to each per-tile bitmap texture
+    Properties m_tile_props;
+    ScalarTransform3f m_transform;
+    /// Number of occupied tile rows (bounds the valid UV region)
+    uint32_t m_rows;
+};
+
+MTS_IMPLEMENT_CLASS_VARIANT(UDIMTexture, Texture)
+MTS_EXPORT_PLUGIN(UDIMTexture, "UDIM texture set")
+
+NAMESPACE_END(mitsuba)